@@ -18,26 +18,51 @@
 */
 
 #include <stdlib.h>
+#include <limits.h>
 #include <iostream>
 #include <math.h>
 #include <assert.h>
 #include <algorithm>
 #include <sys/time.h>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifdef _OPENMP
+   #include <omp.h>
+#endif
 
 #include "CASPT2.h"
 #include "Lapack.h"
 #include "Options.h"
 #include "ConjugateGradient.h"
+#include "Tracer.h"
 #include "Davidson.h"
 #include "Special.h"
+#include "MPIchemps2.h"
 
 using std::cout;
 using std::endl;
 using std::min;
 using std::max;
 
-CheMPS2::CASPT2::CASPT2( DMRGSCFindices * idx, DMRGSCFintegrals * ints, DMRGSCFmatrix * oei, DMRGSCFmatrix * fock_in, double * one_dm, double * two_dm, double * three_dm, double * contract_4dm, const double IPEA ){
-
+#ifdef CHEMPS2_MPI_COMPILATION
+CheMPS2::CASPT2::CASPT2( DMRGSCFindices * idx, DMRGSCFintegrals * ints, DMRGSCFmatrix * oei, DMRGSCFmatrix * fock_in, double * one_dm, double * two_dm, double * three_dm, double * contract_4dm, const double IPEA, const double maxMemMB, const string tmp_folder, const bool distributed ){
+#else
+CheMPS2::CASPT2::CASPT2( DMRGSCFindices * idx, DMRGSCFintegrals * ints, DMRGSCFmatrix * oei, DMRGSCFmatrix * fock_in, double * one_dm, double * two_dm, double * three_dm, double * contract_4dm, const double IPEA, const double maxMemMB, const string tmp_folder, const bool ){
+#endif
+
+   Tracer::Scope scope( "CASPT2 setup", "caspt2" );
+   #ifdef CHEMPS2_MPI_COMPILATION
+      mpi_distributed = (( distributed ) && ( MPIchemps2::mpi_size() > 1 ));
+      am_i_master = (( mpi_distributed == false ) || ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER ));
+   #else
+      mpi_distributed = false;
+      am_i_master = true;
+   #endif
+   max_mem_MB     = maxMemMB;
+   scratch_folder = tmp_folder;
    indices    = idx;
    fock       = fock_in;
    one_rdm    = one_dm;
@@ -45,12 +70,14 @@ CheMPS2::CASPT2::CASPT2( DMRGSCFindices * idx, DMRGSCFintegrals * ints, DMRGSCFm
    three_rdm  = three_dm;
    f_dot_4dm  = contract_4dm;
    num_irreps = indices->getNirreps();
+   ipea_shift = IPEA;
 
    struct timeval start, end;
    gettimeofday( &start, NULL );
 
    create_f_dots();
    vector_helper();
+   distribute_blocks();
 
    make_AA_CC( true, 0.0 );
    make_DD( true, 0.0 );
@@ -58,7 +85,12 @@ CheMPS2::CASPT2::CASPT2( DMRGSCFindices * idx, DMRGSCFintegrals * ints, DMRGSCFm
    make_BB_FF_singlet( true, 0.0 );
    make_BB_FF_triplet( true, 0.0 );
 
-   construct_rhs( oei, ints );
+   if ( am_i_master ){
+      construct_rhs( oei, ints );
+   } else { // The helper processes receive their segments of the RHS in solve
+      rhs_on_disk = false;
+      vector_rhs = NULL;
+   }
 
    make_AA_CC( false, IPEA );
    make_DD( false, IPEA );
@@ -78,14 +110,14 @@ CheMPS2::CASPT2::CASPT2( DMRGSCFindices * idx, DMRGSCFintegrals * ints, DMRGSCFm
 
    gettimeofday( &end, NULL );
    double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
-   cout << "CASPT2 : Wall time tensors    = " << elapsed << " seconds" << endl;
+   if ( am_i_master ){ cout << "CASPT2 : Wall time tensors    = " << elapsed << " seconds" << endl; }
    gettimeofday( &start, NULL );
 
    recreate();
 
    gettimeofday( &end, NULL );
    elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
-   cout << "CASPT2 : Wall time diag(ovlp) = " << elapsed << " seconds" << endl;
+   if ( am_i_master ){ cout << "CASPT2 : Wall time diag(ovlp) = " << elapsed << " seconds" << endl; }
 
 }
 
@@ -112,6 +144,27 @@ CheMPS2::CASPT2::~CASPT2(){
    delete [] FFF_singlet;
    delete [] FFF_triplet;
 
+   for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+      delete [] IAA[ irrep ];
+      delete [] ICC[ irrep ];
+      delete [] IDD[ irrep ];
+      delete [] IEE[ irrep ];
+      delete [] IGG[ irrep ];
+      delete [] IBB_singlet[ irrep ];
+      delete [] IBB_triplet[ irrep ];
+      delete [] IFF_singlet[ irrep ];
+      delete [] IFF_triplet[ irrep ];
+   }
+   delete [] IAA;
+   delete [] ICC;
+   delete [] IDD;
+   delete [] IEE;
+   delete [] IGG;
+   delete [] IBB_singlet;
+   delete [] IBB_triplet;
+   delete [] IFF_singlet;
+   delete [] IFF_triplet;
+
    for ( int irrep_left = 0; irrep_left < num_irreps; irrep_left++ ){
       for ( int irrep_right = 0; irrep_right < num_irreps; irrep_right++ ){
          const int irrep_w = Irreps::directProd( irrep_left, irrep_right );
@@ -198,13 +251,361 @@ CheMPS2::CASPT2::~CASPT2(){
    delete [] size_B_triplet;
    delete [] size_F_singlet;
    delete [] size_F_triplet;
+   if ( vector_rhs != NULL ){ free_vector( vector_rhs, jump[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ], rhs_on_disk ); }
    delete [] jump;
-   delete [] vector_rhs;
+   delete [] block_owner;
+
+}
+
+bool CheMPS2::CASPT2::exceeds_memory( const double num_vectors, const long long length ) const{
+
+   if ( max_mem_MB <= 0.0 ){ return false; }
+   const double required_MB = ( num_vectors * sizeof( double ) * length ) / 1048576;
+   return ( required_MB > max_mem_MB );
+
+}
+
+double * CheMPS2::CASPT2::allocate_vector( const long long length, bool & on_disk ) const{
+
+   if ( length == 0 ){ on_disk = false; } // With MPI, a process can own an empty segment, and a mapping of zero bytes is not possible
+   if ( on_disk ){
+      std::stringstream filename;
+      filename << scratch_folder << "/CheMPS2_CASPT2_" << getpid() << ".bin";
+      const size_t num_bytes = ( ( size_t ) length ) * sizeof( double );
+      const int fd = open( filename.str().c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600 );
+      if ( fd >= 0 ){
+         unlink( filename.str().c_str() ); // The disk space is freed with the mapping
+         void * mapping = MAP_FAILED;
+         if ( ftruncate( fd, num_bytes ) == 0 ){ mapping = mmap( NULL, num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ); }
+         close( fd );
+         if ( mapping != MAP_FAILED ){ return ( double * ) mapping; }
+      }
+      cout << "CASPT2 : WARNING : the memory-mapped file in " << scratch_folder << " could not be created, and the vector is kept in RAM." << endl;
+      on_disk = false;
+   }
+   return new double[ length ];
+
+}
+
+void CheMPS2::CASPT2::free_vector( double * vector, const long long length, const bool on_disk ){
+
+   if ( on_disk ){ munmap( vector, ( ( size_t ) length ) * sizeof( double ) ); }
+   else { delete [] vector; }
+
+}
+
+void CheMPS2::CASPT2::distribute_blocks(){
+
+   const int num_blocks = num_irreps * CHEMPS2_CASPT2_NUM_CASES;
+   block_owner = new int[ num_blocks ];
+   for ( int block = 0; block < num_blocks; block++ ){ block_owner[ block ] = 0; } // The master process
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){
+
+      /* The two sectors of a group get the same owner: A and C, and B and F, have their diagonal Fock blocks built together,
+         E and G share the diagonal block of the singlet and triplet sectors, and diagonal() fills the H sectors together.
+         The groups are assigned largest first to the process with the smallest load: the cost SIZE^3 of the diagonalizations,
+         and for the H groups, which have no diagonal block to diagonalize, the vector length. */
+      const int num_groups = 7;
+      const int sectors[] = { CHEMPS2_CASPT2_A,         CHEMPS2_CASPT2_C,
+                              CHEMPS2_CASPT2_D,         CHEMPS2_CASPT2_D,
+                              CHEMPS2_CASPT2_B_SINGLET, CHEMPS2_CASPT2_F_SINGLET,
+                              CHEMPS2_CASPT2_B_TRIPLET, CHEMPS2_CASPT2_F_TRIPLET,
+                              CHEMPS2_CASPT2_E_SINGLET, CHEMPS2_CASPT2_E_TRIPLET,
+                              CHEMPS2_CASPT2_G_SINGLET, CHEMPS2_CASPT2_G_TRIPLET,
+                              CHEMPS2_CASPT2_H_SINGLET, CHEMPS2_CASPT2_H_TRIPLET };
+      const int * sizes[] = { size_A, size_C, size_D, NULL, size_B_singlet, size_F_singlet, size_B_triplet, size_F_triplet, size_E, NULL, size_G, NULL, NULL, NULL };
+
+      const int num_tasks = num_groups * num_irreps;
+      double * cost = new double[ num_tasks ];
+      double * length = new double[ num_tasks ];
+      int * order = new int[ num_tasks ];
+      for ( int task = 0; task < num_tasks; task++ ){
+         const int group = task % num_groups;
+         const int irrep = task / num_groups;
+         cost[ task ] = 0.0;
+         length[ task ] = 0.0;
+         for ( int member = 0; member < 2; member++ ){
+            const int block = irrep + num_irreps * sectors[ 2 * group + member ];
+            if ( sizes[ 2 * group + member ] != NULL ){ cost[ task ] += pow( ( double ) sizes[ 2 * group + member ][ irrep ], 3 ); }
+            if (( member == 0 ) || ( sectors[ 2 * group ] != sectors[ 2 * group + 1 ] )){ length[ task ] += jump[ block + 1 ] - jump[ block ]; }
+         }
+         order[ task ] = task;
+         for ( int prev = task; ( prev > 0 ) && (( cost[ order[ prev - 1 ] ] < cost[ task ] ) || (( cost[ order[ prev - 1 ] ] == cost[ task ] ) && ( length[ order[ prev - 1 ] ] < length[ task ] ))); prev-- ){
+            order[ prev ] = order[ prev - 1 ];
+            order[ prev - 1 ] = task;
+         }
+      }
+
+      const int num_procs = MPIchemps2::mpi_size();
+      double * diag_load = new double[ num_procs ];
+      double * vec_load  = new double[ num_procs ];
+      for ( int rank = 0; rank < num_procs; rank++ ){ diag_load[ rank ] = 0.0; vec_load[ rank ] = 0.0; }
+      for ( int count = 0; count < num_tasks; count++ ){
+         const int task  = order[ count ];
+         const int group = task % num_groups;
+         const int irrep = task / num_groups;
+         const bool diagonalize = ( group < num_groups - 1 );
+         int owner = 0;
+         for ( int rank = 1; rank < num_procs; rank++ ){
+            if ( (( diagonalize ) ? diag_load[ rank ] < diag_load[ owner ] : vec_load[ rank ] < vec_load[ owner ] ) ){ owner = rank; }
+         }
+         diag_load[ owner ] += cost[ task ];
+         vec_load[ owner ]  += length[ task ];
+         block_owner[ irrep + num_irreps * sectors[ 2 * group     ] ] = owner;
+         block_owner[ irrep + num_irreps * sectors[ 2 * group + 1 ] ] = owner;
+      }
+
+      delete [] cost;
+      delete [] length;
+      delete [] order;
+      delete [] diag_load;
+      delete [] vec_load;
+
+   }
+   #endif
+
+}
+
+#ifdef CHEMPS2_MPI_COMPILATION
+bool CheMPS2::CASPT2::skip_block( const int sector, const int irrep ) const{
+#else
+bool CheMPS2::CASPT2::skip_block( const int, const int ) const{
+#endif
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){ return ( block_owner[ irrep + num_irreps * sector ] != MPIchemps2::mpi_rank() ); }
+   #endif
+   return false;
+
+}
+
+long long CheMPS2::CASPT2::segment_jumps( long long * offsets ) const{
+
+   offsets[ 0 ] = 0;
+   for ( int block = 0; block < num_irreps * CHEMPS2_CASPT2_NUM_CASES; block++ ){
+      const bool mine = ( skip_block( block / num_irreps, block % num_irreps ) == false );
+      offsets[ block + 1 ] = offsets[ block ] + (( mine ) ? jump[ block + 1 ] - jump[ block ] : 0 );
+   }
+   return offsets[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ];
+
+}
+
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::CASPT2::scatter_gather( double * full, double * segment, const long long * offsets, const bool scatter ) const{
+#else
+void CheMPS2::CASPT2::scatter_gather( double * full, double * segment, const long long *, const bool scatter ) const{
+#endif
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){
+      const int MPIRANK = MPIchemps2::mpi_rank();
+      for ( int block = 0; block < num_irreps * CHEMPS2_CASPT2_NUM_CASES; block++ ){
+         const long long size = jump[ block + 1 ] - jump[ block ];
+         const int owner = block_owner[ block ];
+         if ( size > 0 ){
+            if ( owner == MPI_CHEMPS2_MASTER ){
+               if ( MPIRANK == MPI_CHEMPS2_MASTER ){
+                  if ( scatter ){ for ( long long elem = 0; elem < size; elem++ ){ segment[ offsets[ block ] + elem ] = full[ jump[ block ] + elem ]; } }
+                  else          { for ( long long elem = 0; elem < size; elem++ ){ full[ jump[ block ] + elem ] = segment[ offsets[ block ] + elem ]; } }
+               }
+            } else {
+               const int sender   = (( scatter ) ? MPI_CHEMPS2_MASTER : owner );
+               const int receiver = (( scatter ) ? owner : MPI_CHEMPS2_MASTER );
+               if ( MPIRANK == MPI_CHEMPS2_MASTER ){ sendreceive_vector( full + jump[ block ], size, sender, receiver, block ); }
+               if ( MPIRANK == owner ){ sendreceive_vector( segment + offsets[ block ], size, sender, receiver, block ); }
+            }
+         }
+      }
+      return;
+   }
+   #endif
+
+   const long long total_size = jump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ];
+   if ( scatter ){ for ( long long elem = 0; elem < total_size; elem++ ){ segment[ elem ] = full[ elem ]; } }
+   else          { for ( long long elem = 0; elem < total_size; elem++ ){ full[ elem ] = segment[ elem ]; } }
 
 }
 
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::CASPT2::DistributedMatvec( double * vector, double * result, double * diag_fock, const long long * offsets ) const{
+#else
+void CheMPS2::CASPT2::DistributedMatvec( double * vector, double * result, double * diag_fock, const long long * ) const{
+#endif
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){
+      block_matvec( vector, result, diag_fock, offsets );
+      return;
+   }
+   #endif
+
+   matvec( vector, result, diag_fock );
+
+}
+
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::CASPT2::sendreceive_vector( double * array, const long long length, const int sender, const int receiver, const int tag ){
+
+   for ( long long start = 0; start < length; start += INT_MAX ){ // MPI counts are int
+      MPIchemps2::sendreceive_array_double( array + start, ( int )( min( length - start, ( long long ) INT_MAX ) ), sender, receiver, tag );
+   }
+
+}
+
+void CheMPS2::CASPT2::needed_blocks( const int rank, bool * needed ) const{
+
+   // The sectors of the left and right blocks of the couplings, in the order of the work units ( coupling, IL ) in matvec: FAD, FCD, FAB, FCF, FBE, FFG, FEH, FGH, FDE, FDG
+   const int num_couplings = 18;
+   const int left[]  = { CHEMPS2_CASPT2_A,         CHEMPS2_CASPT2_C,
+                         CHEMPS2_CASPT2_A,         CHEMPS2_CASPT2_A,
+                         CHEMPS2_CASPT2_C,         CHEMPS2_CASPT2_C,
+                         CHEMPS2_CASPT2_B_SINGLET, CHEMPS2_CASPT2_B_TRIPLET,
+                         CHEMPS2_CASPT2_F_SINGLET, CHEMPS2_CASPT2_F_TRIPLET,
+                         CHEMPS2_CASPT2_E_SINGLET, CHEMPS2_CASPT2_E_TRIPLET,
+                         CHEMPS2_CASPT2_G_SINGLET, CHEMPS2_CASPT2_G_TRIPLET,
+                         CHEMPS2_CASPT2_D,         CHEMPS2_CASPT2_D,
+                         CHEMPS2_CASPT2_D,         CHEMPS2_CASPT2_D };
+   const int right[] = { CHEMPS2_CASPT2_D,         CHEMPS2_CASPT2_D,
+                         CHEMPS2_CASPT2_B_SINGLET, CHEMPS2_CASPT2_B_TRIPLET,
+                         CHEMPS2_CASPT2_F_SINGLET, CHEMPS2_CASPT2_F_TRIPLET,
+                         CHEMPS2_CASPT2_E_SINGLET, CHEMPS2_CASPT2_E_TRIPLET,
+                         CHEMPS2_CASPT2_G_SINGLET, CHEMPS2_CASPT2_G_TRIPLET,
+                         CHEMPS2_CASPT2_H_SINGLET, CHEMPS2_CASPT2_H_TRIPLET,
+                         CHEMPS2_CASPT2_H_SINGLET, CHEMPS2_CASPT2_H_TRIPLET,
+                         CHEMPS2_CASPT2_E_SINGLET, CHEMPS2_CASPT2_E_TRIPLET,
+                         CHEMPS2_CASPT2_G_SINGLET, CHEMPS2_CASPT2_G_TRIPLET };
+
+   for ( int block = 0; block < num_irreps * CHEMPS2_CASPT2_NUM_CASES; block++ ){ needed[ block ] = false; }
+   for ( int coupling = 0; coupling < num_couplings; coupling++ ){
+      for ( int IL = 0; IL < num_irreps; IL++ ){
+         if ( MPIchemps2::owner_caspt2_unit( IL + num_irreps * coupling ) == rank ){
+            // The left block of irrep IL is coupled to the right blocks of (at most) all irreps
+            needed[ IL + num_irreps * left[ coupling ] ] = true;
+            for ( int IR = 0; IR < num_irreps; IR++ ){ needed[ IR + num_irreps * right[ coupling ] ] = true; }
+         }
+      }
+   }
+
+}
+
+void CheMPS2::CASPT2::block_matvec( double * vector, double * result, double * diag_fock, const long long * offsets ) const{
+
+   const int num_procs  = MPIchemps2::mpi_size();
+   const int MPIRANK    = MPIchemps2::mpi_rank();
+   const int num_blocks = num_irreps * CHEMPS2_CASPT2_NUM_CASES;
+
+   // The blocks which the work units of each process read and write
+   bool * needed = new bool[ num_blocks * num_procs ];
+   for ( int rank = 0; rank < num_procs; rank++ ){ needed_blocks( rank, needed + num_blocks * rank ); }
+
+   // The needed blocks of this process are stored consecutively; if they are exactly the owned blocks, matvec works on vector and result directly
+   long long * work_jumps = new long long[ num_blocks + 1 ];
+   work_jumps[ 0 ] = 0;
+   bool in_place = true;
+   long long max_block = 0;
+   for ( int block = 0; block < num_blocks; block++ ){
+      const long long size = jump[ block + 1 ] - jump[ block ];
+      work_jumps[ block + 1 ] = work_jumps[ block ] + (( needed[ block + num_blocks * MPIRANK ] ) ? size : 0 );
+      if ( work_jumps[ block + 1 ] != offsets[ block + 1 ] ){ in_place = false; }
+      max_block = max( max_block, size );
+   }
+   const long long work_size = work_jumps[ num_blocks ];
+   bool in_on_disk  = exceeds_memory( 2.0, work_size );
+   bool out_on_disk = in_on_disk;
+   double * work_in  = (( in_place ) ? vector : allocate_vector( work_size, in_on_disk  ));
+   double * work_out = (( in_place ) ? result : allocate_vector( work_size, out_on_disk ));
+
+   /* The point-to-point messages follow the same global order ( block, process ) on all processes, so that the blocking
+      sends and receives cannot deadlock; MPI keeps the order of the messages between two processes with the same tag */
+   for ( int block = 0; block < num_blocks; block++ ){
+      const long long size = jump[ block + 1 ] - jump[ block ];
+      const int owner = block_owner[ block ];
+      for ( int rank = 0; rank < num_procs; rank++ ){
+         if (( size > 0 ) && ( needed[ block + num_blocks * rank ] )){
+            if ( rank == owner ){
+               if (( rank == MPIRANK ) && ( !in_place )){
+                  for ( long long elem = 0; elem < size; elem++ ){ work_in[ work_jumps[ block ] + elem ] = vector[ offsets[ block ] + elem ]; }
+               }
+            } else {
+               if ( MPIRANK == owner ){ sendreceive_vector( vector  +    offsets[ block ], size, owner, rank, block ); }
+               if ( MPIRANK == rank  ){ sendreceive_vector( work_in + work_jumps[ block ], size, owner, rank, block ); }
+            }
+         }
+      }
+   }
+
+   matvec( work_in, work_out, NULL, true, work_jumps );
+
+   // The owner of each block adds the parts of the other processes which wrote to it
+   double * received = NULL;
+   for ( int block = 0; block < num_blocks; block++ ){
+      const long long size = jump[ block + 1 ] - jump[ block ];
+      const int owner = block_owner[ block ];
+      if ( size > 0 ){
+         double * target = result + offsets[ block ];
+         if ( MPIRANK == owner ){
+            if ( !needed[ block + num_blocks * owner ] ){ for ( long long elem = 0; elem < size; elem++ ){ target[ elem ] = 0.0; } }
+            else if ( !in_place ){ for ( long long elem = 0; elem < size; elem++ ){ target[ elem ] = work_out[ work_jumps[ block ] + elem ]; } }
+         }
+         for ( int rank = 0; rank < num_procs; rank++ ){
+            if (( rank != owner ) && ( needed[ block + num_blocks * rank ] )){
+               if ( MPIRANK == rank ){ sendreceive_vector( work_out + work_jumps[ block ], size, rank, owner, block ); }
+               if ( MPIRANK == owner ){
+                  if ( received == NULL ){ received = new double[ min( max_block, ( long long ) INT_MAX ) ]; }
+                  for ( long long start = 0; start < size; start += INT_MAX ){ // In the same pieces as sendreceive_vector
+                     const int piece = ( int )( min( size - start, ( long long ) INT_MAX ) );
+                     MPIchemps2::sendreceive_array_double( received, piece, rank, owner, block );
+                     for ( int elem = 0; elem < piece; elem++ ){ target[ start + elem ] += received[ elem ]; }
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   // The diagonal part of the owned blocks
+   const long long seglength = offsets[ num_blocks ];
+   for ( long long elem = 0; elem < seglength; elem++ ){ result[ elem ] += diag_fock[ elem ] * vector[ elem ]; }
+
+   if ( received != NULL ){ delete [] received; }
+   if ( !in_place ){
+      free_vector( work_in,  work_size, in_on_disk  );
+      free_vector( work_out, work_size, out_on_disk );
+   }
+   delete [] work_jumps;
+   delete [] needed;
+
+}
+#endif
+
 double CheMPS2::CASPT2::solve( const double imag_shift, const bool CONJUGATE_GRADIENT ) const{
 
+   return solve_linear( imag_shift, CONJUGATE_GRADIENT, NULL, false );
+
+}
+
+void CheMPS2::CASPT2::solve_shifts( const int num_shifts, const double * ipea_shifts, const double * imag_shifts, double * energies, const bool CONJUGATE_GRADIENT ){
+
+   const long long total_size = jump[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ];
+   bool on_disk = rhs_on_disk;
+   double * solution = (( am_i_master ) ? allocate_vector( total_size, on_disk ) : NULL ); // The MPI helper processes only hold their segments in solve_linear
+
+   for ( int shift = 0; shift < num_shifts; shift++ ){
+      if ( am_i_master ){ cout << "CASPT2 : IPEA shift           = " << ipea_shifts[ shift ] << " ; imaginary shift = " << imag_shifts[ shift ] << endl; }
+      const bool warm_start = ( shift > 0 );
+      change_ipea( ipea_shifts[ shift ], (( warm_start ) ? solution : NULL ) );
+      energies[ shift ] = solve_linear( imag_shifts[ shift ], CONJUGATE_GRADIENT, solution, warm_start );
+   }
+
+   if ( solution != NULL ){ free_vector( solution, total_size, on_disk ); }
+
+}
+
+double CheMPS2::CASPT2::solve_linear( const double imag_shift, const bool CONJUGATE_GRADIENT, double * solution, const bool warm_start ) const{
+
+   Tracer::Scope scope( "CASPT2::solve", "caspt2" );
    struct timeval start, end;
    gettimeofday( &start, NULL );
 
@@ -212,99 +613,183 @@ double CheMPS2::CASPT2::solve( const double imag_shift, const bool CONJUGATE_GRA
    const int normalizations[] = { 1, 2, 2, 1, 1, 2, 6, 2, 2, 2, 6, 4, 12 };
    const bool apply_shift = (( fabs( imag_shift ) > 0.0 ) ? true : false );
 
-   int total_size = jump[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ];
-   double * diag_fock = new double[ total_size ];
-   diagonal( diag_fock );
-   double min_eig = diag_fock[ 0 ];
-   for ( int elem = 1; elem < total_size; elem++ ){ min_eig = min( min_eig, diag_fock[ elem ] ); }
-   cout << "CASPT2 : Solution algorithm   = " << (( CONJUGATE_GRADIENT ) ? "Conjugate Gradient" : "Davidson" ) << endl;
-   cout << "CASPT2 : Minimum(diagonal)    = " << min_eig << endl;
-
-   ConjugateGradient * CG = (( CONJUGATE_GRADIENT ) ? new ConjugateGradient( total_size, CheMPS2::CONJ_GRADIENT_RTOL, CheMPS2::CONJ_GRADIENT_PRECOND_CUTOFF, false ) : NULL );
-   Davidson * DAVID = (( CONJUGATE_GRADIENT ) ? NULL : new Davidson( total_size,
-                                                                     CheMPS2::DAVIDSON_NUM_VEC,
-                                                                     CheMPS2::DAVIDSON_NUM_VEC_KEEP,
-                                                                     CheMPS2::CONJ_GRADIENT_RTOL,
-                                                                     CheMPS2::CONJ_GRADIENT_PRECOND_CUTOFF,
-                                                                     true, // debug_print
-                                                                     'L' )); // Linear problem
+   // Each process solves for its own segment of the vectors, with the blocks of which it is the owner
+   const long long total_size = jump[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ];
+   long long * offsets = new long long[ CHEMPS2_CASPT2_NUM_CASES * num_irreps + 1 ];
+   const long long seglength = segment_jumps( offsets ); // Can be zero when there are more processes than blocks
+   int use_solution = (( solution != NULL ) ? 1 : 0 );
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){ MPIchemps2::broadcast_array_int( &use_solution, 1, MPI_CHEMPS2_MASTER ); } // Only the solution of the master process is used
+   #endif
+
+   const bool USE_CG = (( CONJUGATE_GRADIENT ) || ( total_size > INT_MAX )); // Davidson indexes with int
+
+   // Besides the RHS and the diagonal, CG keeps 7 vectors and Davidson 2 * DAVIDSON_NUM_VEC + DAVIDSON_NUM_VEC_KEEP + 4 vectors
+   const double num_vectors = 2.0 + (( USE_CG ) ? 7.0 : ( 2.0 * CheMPS2::DAVIDSON_NUM_VEC + CheMPS2::DAVIDSON_NUM_VEC_KEEP + 4.0 ));
+   bool on_disk = exceeds_memory( num_vectors, seglength );
+   double * diag_fock = allocate_vector( seglength, on_disk );
+   diagonal( diag_fock, offsets );
+   bool has_eig = ( seglength > 0 );
+   double min_eig = (( has_eig ) ? diag_fock[ 0 ] : 0.0 );
+   for ( long long elem = 1; elem < seglength; elem++ ){ min_eig = min( min_eig, diag_fock[ elem ] ); }
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){ // Collect the minimum at the master process
+      for ( int rank = 0; rank < MPIchemps2::mpi_size(); rank++ ){
+         if ( rank != MPI_CHEMPS2_MASTER ){
+            double other[] = { (( has_eig ) ? 1.0 : 0.0 ), min_eig };
+            MPIchemps2::sendreceive_array_double( other, 2, rank, MPI_CHEMPS2_MASTER, 0 );
+            if (( am_i_master ) && ( other[ 0 ] > 0.5 )){
+               min_eig = (( has_eig ) ? min( min_eig, other[ 1 ] ) : other[ 1 ] );
+               has_eig = true;
+            }
+         }
+      }
+   }
+   #endif
+   if ( am_i_master ){
+      cout << "CASPT2 : Solution algorithm   = " << (( USE_CG ) ? "Conjugate Gradient" : "Davidson" ) << endl;
+      cout << "CASPT2 : Minimum(diagonal)    = " << min_eig << endl;
+   }
+
+   ConjugateGradient * CG = (( USE_CG ) ? new ConjugateGradient( seglength, CheMPS2::CONJ_GRADIENT_RTOL, CheMPS2::CONJ_GRADIENT_PRECOND_CUTOFF, false ) : NULL );
+   Davidson * DAVID = (( USE_CG ) ? NULL : new Davidson( seglength,
+                                                         CheMPS2::DAVIDSON_NUM_VEC,
+                                                         CheMPS2::DAVIDSON_NUM_VEC_KEEP,
+                                                         CheMPS2::CONJ_GRADIENT_RTOL,
+                                                         CheMPS2::CONJ_GRADIENT_PRECOND_CUTOFF,
+                                                         am_i_master, // debug_print
+                                                         'L' )); // Linear problem
+   if ( mpi_distributed ){
+      if ( USE_CG ){ CG->DistributeVectors(); }
+      else { DAVID->DistributeVectors(); }
+   }
+   if ( on_disk ){
+      std::stringstream filename;
+      filename << scratch_folder << "/CheMPS2_CASPT2_solver_" << getpid() << ".bin";
+      const bool mapped = (( USE_CG ) ? CG->StoreVectorsOnDisk( filename.str() ) : DAVID->StoreVectorsOnDisk( filename.str() ));
+      if ( am_i_master ){
+         cout << "CASPT2 : The solver vectors ( " << ( num_vectors * sizeof( double ) * seglength ) / 1048576 << " MB ) exceed " << max_mem_MB << " MB; ";
+         if ( mapped ){ cout << "they are stored in memory-mapped files in " << scratch_folder << "." << endl; }
+         else { cout << "WARNING : the memory-mapped file could not be created, and the solver vectors are kept in RAM." << endl; }
+      }
+   }
+   bool rhs_segment_on_disk = on_disk;
+   double * rhs = (( mpi_distributed ) ? allocate_vector( seglength, rhs_segment_on_disk ) : vector_rhs );
+   if ( mpi_distributed ){ scatter_gather( vector_rhs, rhs, offsets, true ); }
    double ** pointers = new double*[ 3 ];
-   char instruction = (( CONJUGATE_GRADIENT ) ? CG->step( pointers ) : DAVID->FetchInstruction( pointers ));
+   char instruction = (( USE_CG ) ? CG->step( pointers ) : DAVID->FetchInstruction( pointers ));
    assert( instruction == 'A' );
-   for ( int elem = 0; elem < total_size; elem++ ){ pointers[ 0 ][ elem ] = vector_rhs[ elem ] / diag_fock[ elem ]; } // Initial guess of F * x = V
-   for ( int elem = 0; elem < total_size; elem++ ){ pointers[ 1 ][ elem ] =  diag_fock[ elem ]; } // Diagonal of the operator F
-   for ( int elem = 0; elem < total_size; elem++ ){ pointers[ 2 ][ elem ] = vector_rhs[ elem ]; } // RHS of the linear problem F * x = V
-   int inc1 = 1;
-   const double E2_DIAGONAL = - ddot_( &total_size, pointers[ 0 ], &inc1, pointers[ 2 ], &inc1 );
-   instruction = (( CONJUGATE_GRADIENT ) ? CG->step( pointers ) : DAVID->FetchInstruction( pointers ));
+   for ( long long elem = 0; elem < seglength; elem++ ){ pointers[ 0 ][ elem ] = rhs[ elem ] / diag_fock[ elem ]; } // Initial guess of F * x = V
+   for ( long long elem = 0; elem < seglength; elem++ ){ pointers[ 1 ][ elem ] = diag_fock[ elem ]; } // Diagonal of the operator F
+   for ( long long elem = 0; elem < seglength; elem++ ){ pointers[ 2 ][ elem ] = rhs[ elem ]; } // RHS of the linear problem F * x = V
+   double E2_DIAGONAL = - inproduct( pointers[ 0 ], pointers[ 2 ], seglength );
+   sum_over_processes( E2_DIAGONAL );
+   if ( warm_start ){ scatter_gather( solution, pointers[ 0 ], offsets, true ); } // Solution of the previous shift
+   instruction = (( USE_CG ) ? CG->step( pointers ) : DAVID->FetchInstruction( pointers ));
    assert( instruction == 'B' );
    while ( instruction == 'B' ){
-      matvec( pointers[ 0 ], pointers[ 1 ], diag_fock );
-      if ( apply_shift ){ add_shift( pointers[ 0 ], pointers[ 1 ], diag_fock, imag_shift, normalizations ); }
-      instruction = (( CONJUGATE_GRADIENT ) ? CG->step( pointers ) : DAVID->FetchInstruction( pointers ));
+      DistributedMatvec( pointers[ 0 ], pointers[ 1 ], diag_fock, offsets );
+      if ( apply_shift ){ add_shift( pointers[ 0 ], pointers[ 1 ], diag_fock, imag_shift, normalizations, offsets ); }
+      instruction = (( USE_CG ) ? CG->step( pointers ) : DAVID->FetchInstruction( pointers ));
    }
    assert( instruction == 'C' );
-   const double E2_NONVARIATIONAL = - ddot_( &total_size, pointers[ 0 ], &inc1, vector_rhs, &inc1 );
-   const double rnorm = pointers[ 1 ][ 0 ];
-   cout << "CASPT2 : Number of iterations = " << (( CONJUGATE_GRADIENT ) ? CG->get_num_matvec() : DAVID->GetNumMultiplications() ) << endl;
-   cout << "CASPT2 : Residual norm        = " << rnorm << endl;
-   matvec( pointers[ 0 ], pointers[ 1 ], diag_fock ); // pointers[ 1 ] is a WORK array when instruction == 'C'
-   const double E2_VARIATIONAL = 2 * E2_NONVARIATIONAL + ddot_( &total_size, pointers[ 0 ], &inc1, pointers[ 1 ], &inc1 );
-   delete [] diag_fock;
-
-   const double inproduct = inproduct_vectors( pointers[ 0 ], pointers[ 0 ], normalizations );
+   if ( use_solution == 1 ){ scatter_gather( solution, pointers[ 0 ], offsets, false ); }
+   double E2_NONVARIATIONAL = - inproduct( pointers[ 0 ], rhs, seglength );
+   sum_over_processes( E2_NONVARIATIONAL );
+   const double rnorm = pointers[ 1 ][ 0 ]; // The same on all processes
+   if ( am_i_master ){
+      cout << "CASPT2 : Number of iterations = " << (( USE_CG ) ? CG->get_num_matvec() : DAVID->GetNumMultiplications() ) << endl;
+      cout << "CASPT2 : Residual norm        = " << rnorm << endl;
+   }
+   DistributedMatvec( pointers[ 0 ], pointers[ 1 ], diag_fock, offsets ); // pointers[ 1 ] is a WORK array when instruction == 'C'
+   double E2_VARIATIONAL = inproduct( pointers[ 0 ], pointers[ 1 ], seglength );
+   sum_over_processes( E2_VARIATIONAL );
+   E2_VARIATIONAL += 2 * E2_NONVARIATIONAL;
+   free_vector( diag_fock, seglength, on_disk );
+   if ( mpi_distributed ){ free_vector( rhs, seglength, rhs_segment_on_disk ); }
+
+   const double inproduct = inproduct_vectors( pointers[ 0 ], pointers[ 0 ], normalizations, offsets );
    const double reference_weight = 1.0 / ( 1.0 + inproduct );
-   cout << "CASPT2 : Reference weight     = " << reference_weight << endl;
+   if ( am_i_master ){ cout << "CASPT2 : Reference weight     = " << reference_weight << endl; }
    //energy_per_sector( pointers[ 0 ] );
    delete [] pointers;
+   delete [] offsets;
    if ( CG    != NULL ){ delete CG;    }
    if ( DAVID != NULL ){ delete DAVID; }
 
    gettimeofday( &end, NULL );
    double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
-   cout << "CASPT2 : Wall time solution   = " << elapsed << " seconds" << endl;
-
-   cout << "CASPT2 : E2 [DIAGONAL]        = " << E2_DIAGONAL << endl;
-   cout << "CASPT2 : E2 [NON-VARIATIONAL] = " << E2_NONVARIATIONAL << endl;
-   cout << "CASPT2 : E2 [VARIATIONAL]     = " << E2_VARIATIONAL << endl;
+   if ( am_i_master ){
+      cout << "CASPT2 : Wall time solution   = " << elapsed << " seconds" << endl;
+      cout << "CASPT2 : E2 [DIAGONAL]        = " << E2_DIAGONAL << endl;
+      cout << "CASPT2 : E2 [NON-VARIATIONAL] = " << E2_NONVARIATIONAL << endl;
+      cout << "CASPT2 : E2 [VARIATIONAL]     = " << E2_VARIATIONAL << endl;
+   }
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){ MPIchemps2::broadcast_array_double( &E2_VARIATIONAL, 1, MPI_CHEMPS2_MASTER ); } // Bitwise the same on all processes
+   #endif
    return E2_VARIATIONAL;
 
 }
 
-void CheMPS2::CASPT2::add_shift( double * vector, double * result, double * diag_fock, const double imag_shift, const int * normalizations ) const{
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::CASPT2::sum_over_processes( double & value ) const{
+#else
+void CheMPS2::CASPT2::sum_over_processes( double & ) const{
+#endif
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){
+      double total = 0.0;
+      MPIchemps2::allreduce_array_double( &value, &total, 1 );
+      value = total;
+   }
+   #endif
+
+}
+
+void CheMPS2::CASPT2::add_shift( double * vector, double * result, double * diag_fock, const double imag_shift, const int * normalizations, const long long * offsets ) const{
 
    for ( int sector = 0; sector < CHEMPS2_CASPT2_NUM_CASES; sector++ ){
-      const int start = jump[ num_irreps * sector         ];
-      const int stop  = jump[ num_irreps * ( sector + 1 ) ];
+      const long long start = offsets[ num_irreps * sector         ];
+      const long long stop  = offsets[ num_irreps * ( sector + 1 ) ];
       const double factor = imag_shift * imag_shift * normalizations[ sector ] * normalizations[ sector ];
-      for ( int elem = start; elem < stop; elem ++ ){
+      for ( long long elem = start; elem < stop; elem ++ ){
          result[ elem ] += factor * vector[ elem ] / diag_fock[ elem ];
       }
    }
 
 }
 
-double CheMPS2::CASPT2::inproduct_vectors( double * first, double * second, const int * normalizations ) const{
+double CheMPS2::CASPT2::inproduct( const double * first, const double * second, const long long length ){
+
+   double value = 0.0;
+   #pragma omp parallel for schedule(static) reduction(+:value)
+   for ( long long elem = 0; elem < length; elem++ ){ value += first[ elem ] * second[ elem ]; }
+   return value;
+
+}
+
+double CheMPS2::CASPT2::inproduct_vectors( double * first, double * second, const int * normalizations, const long long * offsets ) const{
 
-   int inc1 = 1;
    double value = 0.0;
    for ( int sector = 0; sector < CHEMPS2_CASPT2_NUM_CASES; sector++ ){
-      int pointer = jump[ num_irreps * sector         ];
-      int size    = jump[ num_irreps * ( sector + 1 ) ] - pointer;
-      value += normalizations[ sector ] * ddot_( &size, first + pointer, &inc1, second + pointer, &inc1 );
+      const long long pointer = offsets[ num_irreps * sector         ];
+      const long long size    = offsets[ num_irreps * ( sector + 1 ) ] - pointer;
+      value += normalizations[ sector ] * inproduct( first + pointer, second + pointer, size );
    }
+   sum_over_processes( value );
    return value;
 
 }
 
 void CheMPS2::CASPT2::energy_per_sector( double * solution ) const{
 
-   int inc1 = 1;
    double energies[ CHEMPS2_CASPT2_NUM_CASES ];
    for ( int sector = 0; sector < CHEMPS2_CASPT2_NUM_CASES; sector++ ){
-      int pointer = jump[ num_irreps * sector         ];
-      int size    = jump[ num_irreps * ( sector + 1 ) ] - pointer;
-      energies[ sector ] = - ddot_( &size, solution + pointer, &inc1, vector_rhs + pointer, &inc1 );
+      const long long pointer = jump[ num_irreps * sector         ];
+      const long long size    = jump[ num_irreps * ( sector + 1 ) ] - pointer;
+      energies[ sector ] = - inproduct( solution + pointer, vector_rhs + pointer, size );
    }
    cout << "************************************************" << endl;
    cout << "*   CASPT2 non-variational energy per sector   *" << endl;
@@ -416,9 +901,9 @@ void CheMPS2::CASPT2::create_f_dots(){
 
 }
 
-int CheMPS2::CASPT2::vector_helper(){
+long long CheMPS2::CASPT2::vector_helper(){
 
-   int * helper = new int[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ];
+   long long * helper = new long long[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ];
 
    /*** Type A : c_tiuv E_ti E_uv | 0 >
                  c_tiuv = vector[ jump[ irrep + num_irreps * CHEMPS2_CASPT2_A ] + count_tuv + size_A[ irrep ] * count_i ]
@@ -447,8 +932,8 @@ int CheMPS2::CASPT2::vector_helper(){
       }
       size_A[ irrep ] = linsize_AC;
       size_C[ irrep ] = linsize_AC;
-      helper[ irrep + num_irreps * CHEMPS2_CASPT2_A ] = size_A[ irrep ] * indices->getNOCC( irrep );
-      helper[ irrep + num_irreps * CHEMPS2_CASPT2_C ] = size_C[ irrep ] * indices->getNVIRT( irrep );
+      helper[ irrep + num_irreps * CHEMPS2_CASPT2_A ] = ( ( long long ) size_A[ irrep ] ) * indices->getNOCC( irrep );
+      helper[ irrep + num_irreps * CHEMPS2_CASPT2_C ] = ( ( long long ) size_C[ irrep ] ) * indices->getNVIRT( irrep );
    }
 
    /*** Type D1 : c1_aitu E_ai E_tu | 0 >
@@ -481,7 +966,7 @@ int CheMPS2::CASPT2::vector_helper(){
          jump_tu += nact_t * nact_u;
       }
       size_D[ irrep ] = 2 * jump_tu;
-      int jump_ai = 0;
+      long long jump_ai = 0;
       for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
          const int irrep_a = Irreps::directProd( irrep_i, irrep );
          const int nocc_i  = indices->getNOCC( irrep_i );
@@ -572,10 +1057,10 @@ int CheMPS2::CASPT2::vector_helper(){
       size_F_singlet[ irrep ] = jump_tu_singlet;
       size_F_triplet[ irrep ] = jump_tu_triplet;
 
-      int linsize_B_singlet = 0;
-      int linsize_B_triplet = 0;
-      int linsize_F_singlet = 0;
-      int linsize_F_triplet = 0;
+      long long linsize_B_singlet = 0;
+      long long linsize_B_triplet = 0;
+      long long linsize_F_singlet = 0;
+      long long linsize_F_triplet = 0;
       if ( irrep == 0 ){ // irrep_i == irrep_j    or    irrep_a == irrep_b
          for ( int irrep_ijab = 0; irrep_ijab < num_irreps; irrep_ijab++ ){
             const int nocc_ij = indices->getNOCC( irrep_ijab );
@@ -632,8 +1117,8 @@ int CheMPS2::CASPT2::vector_helper(){
    size_E = new int[ num_irreps ];
    for ( int irrep = 0; irrep < num_irreps; irrep++ ){
       size_E[ irrep ] = indices->getNDMRG( irrep );
-      int linsize_E_singlet = 0;
-      int linsize_E_triplet = 0;
+      long long linsize_E_singlet = 0;
+      long long linsize_E_triplet = 0;
       for ( int irrep_a = 0; irrep_a < num_irreps; irrep_a++ ){
          const int nvirt_a = indices->getNVIRT( irrep_a );
          const int irrep_occ = Irreps::directProd( irrep, irrep_a );
@@ -685,8 +1170,8 @@ int CheMPS2::CASPT2::vector_helper(){
    size_G = new int[ num_irreps ];
    for ( int irrep = 0; irrep < num_irreps; irrep++ ){
       size_G[ irrep ] = indices->getNDMRG( irrep );
-      int linsize_G_singlet = 0;
-      int linsize_G_triplet = 0;
+      long long linsize_G_singlet = 0;
+      long long linsize_G_triplet = 0;
       for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
          const int nocc_i = indices->getNOCC( irrep_i );
          const int irrep_virt = Irreps::directProd( irrep, irrep_i );
@@ -742,18 +1227,18 @@ int CheMPS2::CASPT2::vector_helper(){
    */
 
    for ( int irrep = 0; irrep < num_irreps; irrep++ ){
-      int linsize_H_singlet = 0;
-      int linsize_H_triplet = 0;
+      long long linsize_H_singlet = 0;
+      long long linsize_H_triplet = 0;
       if ( irrep == 0 ){ // irrep_i == irrep_j  and  irrep_a == irrep_b
-         int linsize_ij_singlet = 0;
-         int linsize_ij_triplet = 0;
+         long long linsize_ij_singlet = 0;
+         long long linsize_ij_triplet = 0;
          for ( int irrep_ij = 0; irrep_ij < num_irreps; irrep_ij++ ){
             const int nocc_ij = indices->getNOCC( irrep_ij );
             linsize_ij_singlet += ( nocc_ij * ( nocc_ij + 1 )) / 2;
             linsize_ij_triplet += ( nocc_ij * ( nocc_ij - 1 )) / 2;
          }
-         int linsize_ab_singlet = 0;
-         int linsize_ab_triplet = 0;
+         long long linsize_ab_singlet = 0;
+         long long linsize_ab_triplet = 0;
          for ( int irrep_ab = 0; irrep_ab < num_irreps; irrep_ab++ ){
             const int nvirt_ab = indices->getNVIRT( irrep_ab );
             linsize_ab_singlet += ( nvirt_ab * ( nvirt_ab + 1 )) / 2;
@@ -762,12 +1247,12 @@ int CheMPS2::CASPT2::vector_helper(){
          linsize_H_singlet = linsize_ij_singlet * linsize_ab_singlet;
          linsize_H_triplet = linsize_ij_triplet * linsize_ab_triplet;
       } else { // irrep_i < irrep_j = irrep_i x irrep   and   irrep_a < irrep_b = irrep_a x irrep
-         int linsize_ij = 0;
+         long long linsize_ij = 0;
          for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
             const int irrep_j = Irreps::directProd( irrep, irrep_i );
             if ( irrep_i < irrep_j ){ linsize_ij += indices->getNOCC( irrep_i ) * indices->getNOCC( irrep_j ); }
          }
-         int linsize_ab = 0;
+         long long linsize_ab = 0;
          for ( int irrep_a = 0; irrep_a < num_irreps; irrep_a++ ){
             const int irrep_b = Irreps::directProd( irrep, irrep_a );
             if ( irrep_a < irrep_b ){ linsize_ab += indices->getNVIRT( irrep_a ) * indices->getNVIRT( irrep_b ); }
@@ -779,13 +1264,13 @@ int CheMPS2::CASPT2::vector_helper(){
       helper[ irrep + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] = linsize_H_triplet;
    }
 
-   jump = new int[ CHEMPS2_CASPT2_NUM_CASES * num_irreps + 1 ];
+   jump = new long long[ CHEMPS2_CASPT2_NUM_CASES * num_irreps + 1 ];
    jump[ 0 ] = 0;
    for ( int cnt = 0; cnt < CHEMPS2_CASPT2_NUM_CASES * num_irreps; cnt++ ){ jump[ cnt+1 ] = jump[ cnt ] + helper[ cnt ]; }
    delete [] helper;
-   const int total_size = jump[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ];
+   const long long total_size = jump[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ];
    assert( total_size == vector_length( indices ) );
-   cout << "CASPT2 : Old size V_SD space  = " << total_size << endl;
+   if ( am_i_master ){ cout << "CASPT2 : Old size V_SD space  = " << total_size << endl; }
    return total_size;
 
 }
@@ -837,15 +1322,25 @@ long long CheMPS2::CASPT2::vector_length( const DMRGSCFindices * idx ){
 
 }
 
-int CheMPS2::CASPT2::recreatehelper1( double * FOCK, double * OVLP, int SIZE, double * work, double * eigs, int lwork ){
-
-   if ( SIZE == 0 ){ return SIZE; }
+void CheMPS2::CASPT2::eigensolve( double * matrix, int SIZE, double * eigs, double * work, int lwork, int * iwork, int liwork ){
 
-   // S = U_S eigs_S U_S^T
    char jobz = 'V';
    char uplo = 'U';
    int info;
-   dsyev_( &jobz, &uplo, &SIZE, OVLP, &SIZE, eigs, work, &lwork, &info ); // eigs in ascending order
+   if ( SIZE >= CheMPS2::CASPT2_LARGE_BLOCK ){
+      dsyevd_( &jobz, &uplo, &SIZE, matrix, &SIZE, eigs, work, &lwork, iwork, &liwork, &info ); // eigs in ascending order
+   } else {
+      dsyev_( &jobz, &uplo, &SIZE, matrix, &SIZE, eigs, work, &lwork, &info ); // eigs in ascending order
+   }
+
+}
+
+int CheMPS2::CASPT2::recreatehelper1( double * FOCK, double * OVLP, int SIZE, double * work, double * eigs, int lwork, int * iwork, int liwork ){
+
+   if ( SIZE == 0 ){ return SIZE; }
+
+   // S = U_S eigs_S U_S^T
+   eigensolve( OVLP, SIZE, eigs, work, lwork, iwork, liwork ); // eigs in ascending order
 
    // Discard smallest eigenvalues
    int skip = 0;
@@ -878,7 +1373,7 @@ int CheMPS2::CASPT2::recreatehelper1( double * FOCK, double * OVLP, int SIZE, do
    dgemm_( &trans,   &notrans, &NEWSIZE, &NEWSIZE, &SIZE, &one, OVLP + skip * SIZE, &SIZE, work, &SIZE, &set, FOCK, &NEWSIZE ); // FOCK = ( V * eigs^{-0.5} )^T * work
 
    // FOCK_tilde = U_F_tilde eigs_F_tilde U_F_tilde^T
-   dsyev_( &jobz, &uplo, &NEWSIZE, FOCK, &NEWSIZE, eigs, work, &lwork, &info ); // eigs in ascending order
+   eigensolve( FOCK, NEWSIZE, eigs, work, lwork, iwork, liwork ); // eigs in ascending order
 
    // OVLP  <---  U_S eigs_S^{-0.5} U_F_tilde
    dgemm_( &notrans, &notrans, &SIZE, &NEWSIZE, &NEWSIZE, &one, OVLP + skip * SIZE, &SIZE, FOCK, &NEWSIZE, &set, work, &SIZE );
@@ -916,18 +1411,69 @@ void CheMPS2::CASPT2::recreatehelper3( double * OVLP, int OLDSIZE, int NEWSIZE,
    double one = 1.0;
    char trans = 'T';
    for ( int sector = 0; sector < num_rhs; sector++ ){
-      dgemv_( &trans, &OLDSIZE, &NEWSIZE, &one, OVLP, &OLDSIZE, rhs_old + OLDSIZE * sector, &inc1, &set, rhs_new + NEWSIZE * sector, &inc1 );
+      dgemv_( &trans, &OLDSIZE, &NEWSIZE, &one, OVLP, &OLDSIZE, rhs_old + ( ( long long ) OLDSIZE ) * sector, &inc1, &set, rhs_new + ( ( long long ) NEWSIZE ) * sector, &inc1 );
    }
 
 }
 
-void CheMPS2::CASPT2::recreate(){
+void CheMPS2::CASPT2::recreatehelper4( double * OVLP, int OLDSIZE, int NEWSIZE, double *& IPEA_OP, double * work ){
+
+   // IPEA_OP  <---  OVLP^T diag( IPEA_OP ) OVLP  with  OVLP = U_S eigs_S^{-0.5} U_F_tilde
+   for ( int col = 0; col < NEWSIZE; col++ ){
+      for ( int row = 0; row < OLDSIZE; row++ ){
+         work[ row + OLDSIZE * col ] = IPEA_OP[ row ] * OVLP[ row + OLDSIZE * col ];
+      }
+   }
+   delete [] IPEA_OP;
+   IPEA_OP = new double[ NEWSIZE * NEWSIZE ];
+   if ( NEWSIZE > 0 ){
+      char trans   = 'T';
+      char notrans = 'N';
+      double one   = 1.0;
+      double set   = 0.0;
+      dgemm_( &trans, &notrans, &NEWSIZE, &NEWSIZE, &OLDSIZE, &one, OVLP, &OLDSIZE, work, &OLDSIZE, &set, IPEA_OP, &NEWSIZE );
+   }
+
+}
+
+void CheMPS2::CASPT2::change_ipea_helper( double * FOCK, double * IPEA_OP, double * ROT, int SIZE, const double delta, double * work, double * eigs, int lwork, int * iwork, int liwork ){
+
+   if ( SIZE == 0 ){ return; }
+
+   // ROT  <---  diag( FOCK ) + delta * IPEA_OP  =  U_F U_F^T
+   for ( int elem = 0; elem < SIZE * SIZE; elem++ ){ ROT[ elem ] = delta * IPEA_OP[ elem ]; }
+   for ( int diag = 0; diag < SIZE; diag++ ){ ROT[ diag * ( 1 + SIZE ) ] += FOCK[ diag ]; }
+   eigensolve( ROT, SIZE, eigs, work, lwork, iwork, liwork ); // eigs in ascending order
+
+   // IPEA_OP  <---  U_F^T IPEA_OP U_F
+   char trans   = 'T';
+   char notrans = 'N';
+   double one   = 1.0;
+   double set   = 0.0;
+   dgemm_( &notrans, &notrans, &SIZE, &SIZE, &SIZE, &one, IPEA_OP, &SIZE, ROT, &SIZE, &set, work, &SIZE );
+   dgemm_( &trans,   &notrans, &SIZE, &SIZE, &SIZE, &one, ROT, &SIZE, work, &SIZE, &set, IPEA_OP, &SIZE );
+
+   // FOCK  <---  eigs_F
+   int inc1 = 1;
+   dcopy_( &SIZE, eigs, &inc1, FOCK, &inc1 );
 
-   const int maxsize = get_maxsize(); // Minimum 3
-   const int lwork = maxsize * maxsize;
-   double * work  = new double[ lwork ];
-   double * eigs  = new double[ maxsize ];
+}
 
+void CheMPS2::CASPT2::change_ipea( const double IPEA, double * guess ){
+
+   const double delta = IPEA - ipea_shift;
+   if ( delta == 0.0 ){ return; }
+   ipea_shift = IPEA;
+
+   SAA = new double*[ num_irreps ];
+   SCC = new double*[ num_irreps ];
+   SDD = new double*[ num_irreps ];
+   SEE = new double*[ num_irreps ];
+   SGG = new double*[ num_irreps ];
+   SBB_singlet = new double*[ num_irreps ];
+   SBB_triplet = new double*[ num_irreps ];
+   SFF_singlet = new double*[ num_irreps ];
+   SFF_triplet = new double*[ num_irreps ];
    int * newsize_A = new int[ num_irreps ];
    int * newsize_C = new int[ num_irreps ];
    int * newsize_D = new int[ num_irreps ];
@@ -939,17 +1485,164 @@ void CheMPS2::CASPT2::recreate(){
    int * newsize_F_triplet = new int[ num_irreps ];
 
    for ( int irrep = 0; irrep < num_irreps; irrep++ ){
-      newsize_A[ irrep ] = recreatehelper1( FAA[ irrep ], SAA[ irrep ], size_A[ irrep ], work, eigs, lwork );
-      newsize_C[ irrep ] = recreatehelper1( FCC[ irrep ], SCC[ irrep ], size_C[ irrep ], work, eigs, lwork );
-      newsize_D[ irrep ] = recreatehelper1( FDD[ irrep ], SDD[ irrep ], size_D[ irrep ], work, eigs, lwork );
-      newsize_E[ irrep ] = recreatehelper1( FEE[ irrep ], SEE[ irrep ], size_E[ irrep ], work, eigs, lwork );
-      newsize_G[ irrep ] = recreatehelper1( FGG[ irrep ], SGG[ irrep ], size_G[ irrep ], work, eigs, lwork );
-      newsize_B_singlet[ irrep ] = recreatehelper1( FBB_singlet[ irrep ], SBB_singlet[ irrep ], size_B_singlet[ irrep ], work, eigs, lwork );
-      newsize_B_triplet[ irrep ] = recreatehelper1( FBB_triplet[ irrep ], SBB_triplet[ irrep ], size_B_triplet[ irrep ], work, eigs, lwork );
-      newsize_F_singlet[ irrep ] = recreatehelper1( FFF_singlet[ irrep ], SFF_singlet[ irrep ], size_F_singlet[ irrep ], work, eigs, lwork );
-      newsize_F_triplet[ irrep ] = recreatehelper1( FFF_triplet[ irrep ], SFF_triplet[ irrep ], size_F_triplet[ irrep ], work, eigs, lwork );
+      SAA[ irrep ] = new double[ size_A[ irrep ] * size_A[ irrep ] ];
+      SCC[ irrep ] = new double[ size_C[ irrep ] * size_C[ irrep ] ];
+      SDD[ irrep ] = new double[ size_D[ irrep ] * size_D[ irrep ] ];
+      SEE[ irrep ] = new double[ size_E[ irrep ] * size_E[ irrep ] ];
+      SGG[ irrep ] = new double[ size_G[ irrep ] * size_G[ irrep ] ];
+      SBB_singlet[ irrep ] = new double[ size_B_singlet[ irrep ] * size_B_singlet[ irrep ] ];
+      SBB_triplet[ irrep ] = new double[ size_B_triplet[ irrep ] * size_B_triplet[ irrep ] ];
+      SFF_singlet[ irrep ] = new double[ size_F_singlet[ irrep ] * size_F_singlet[ irrep ] ];
+      SFF_triplet[ irrep ] = new double[ size_F_triplet[ irrep ] * size_F_triplet[ irrep ] ];
+   }
+
+   int * newsize[] = { newsize_A, newsize_C, newsize_D, newsize_E, newsize_G, newsize_B_singlet, newsize_B_triplet, newsize_F_singlet, newsize_F_triplet };
+   recreatebatch( newsize, delta );
+
+   recreaterotate( newsize_A, newsize_C, newsize_D, newsize_E, newsize_G, newsize_B_singlet, newsize_B_triplet, newsize_F_singlet, newsize_F_triplet, guess );
+
+}
+
+void CheMPS2::CASPT2::recreatebatch( int ** newsize, const double IPEA_DELTA ){
+
+   const int num_types = 9;
+   double ** FOCK[]    = { FAA, FCC, FDD, FEE, FGG, FBB_singlet, FBB_triplet, FFF_singlet, FFF_triplet };
+   double ** OVLP[]    = { SAA, SCC, SDD, SEE, SGG, SBB_singlet, SBB_triplet, SFF_singlet, SFF_triplet };
+   double ** IPEA_OP[] = { IAA, ICC, IDD, IEE, IGG, IBB_singlet, IBB_triplet, IFF_singlet, IFF_triplet };
+   int * SIZE[]        = { size_A, size_C, size_D, size_E, size_G, size_B_singlet, size_B_triplet, size_F_singlet, size_F_triplet };
+   const int sector[]  = { CHEMPS2_CASPT2_A, CHEMPS2_CASPT2_C, CHEMPS2_CASPT2_D, CHEMPS2_CASPT2_E_SINGLET, CHEMPS2_CASPT2_G_SINGLET,
+                           CHEMPS2_CASPT2_B_SINGLET, CHEMPS2_CASPT2_B_TRIPLET, CHEMPS2_CASPT2_F_SINGLET, CHEMPS2_CASPT2_F_TRIPLET };
+
+   // Blocks sorted by decreasing size, so that the dynamic schedule starts with the most expensive ones
+   const int num_blocks = num_types * num_irreps;
+   int * order = new int[ num_blocks ];
+   for ( int block = 0; block < num_blocks; block++ ){
+      order[ block ] = block;
+      for ( int prev = block; ( prev > 0 ) && ( SIZE[ order[ prev - 1 ] % num_types ][ order[ prev - 1 ] / num_types ] < SIZE[ block % num_types ][ block / num_types ] ); prev-- ){
+         order[ prev ] = order[ prev - 1 ];
+         order[ prev - 1 ] = block;
+      }
+   }
+   int num_large = 0;
+   while (( num_large < num_blocks ) && ( SIZE[ order[ num_large ] % num_types ][ order[ num_large ] / num_types ] >= CheMPS2::CASPT2_LARGE_BLOCK )){ num_large++; }
+   const int max_large = (( num_large > 0 ) ? SIZE[ order[ 0 ] % num_types ][ order[ 0 ] / num_types ] : 0 );
+   const int max_small = max( 3, (( num_large < num_blocks ) ? SIZE[ order[ num_large ] % num_types ][ order[ num_large ] / num_types ] : 0 ));
+
+   // Large blocks: one by one, so that lapack and blas can use all threads
+   if ( num_large > 0 ){
+      const int lwork  = 1 + 6 * max_large + 2 * max_large * max_large; // dsyevd
+      const int liwork = 3 + 5 * max_large;
+      double * work = new double[ lwork ];
+      double * eigs = new double[ max_large ];
+      int * iwork   = new int[ liwork ];
+      for ( int task = 0; task < num_large; task++ ){
+         const int type  = order[ task ] % num_types;
+         const int irrep = order[ task ] / num_types;
+         if ( skip_block( sector[ type ], irrep ) ){ continue; } // Diagonalized by the owner process of the block
+         if ( IPEA_DELTA == 0.0 ){
+            newsize[ type ][ irrep ] = recreatehelper1( FOCK[ type ][ irrep ], OVLP[ type ][ irrep ], SIZE[ type ][ irrep ], work, eigs, lwork, iwork, liwork );
+            recreatehelper4( OVLP[ type ][ irrep ], SIZE[ type ][ irrep ], newsize[ type ][ irrep ], IPEA_OP[ type ][ irrep ], work );
+         } else {
+            newsize[ type ][ irrep ] = SIZE[ type ][ irrep ];
+            change_ipea_helper( FOCK[ type ][ irrep ], IPEA_OP[ type ][ irrep ], OVLP[ type ][ irrep ], SIZE[ type ][ irrep ], IPEA_DELTA, work, eigs, lwork, iwork, liwork );
+         }
+      }
+      delete [] work;
+      delete [] eigs;
+      delete [] iwork;
    }
 
+   // Small blocks: concurrently, one block per thread without nested parallelism
+   #ifdef _OPENMP
+   const int max_levels = omp_get_max_active_levels();
+   omp_set_max_active_levels( 1 );
+   #endif
+   #pragma omp parallel
+   {
+      const int lwork = max_small * max_small;
+      double * work = new double[ lwork ];
+      double * eigs = new double[ max_small ];
+
+      #pragma omp for schedule(dynamic)
+      for ( int task = num_large; task < num_blocks; task++ ){
+         const int type  = order[ task ] % num_types;
+         const int irrep = order[ task ] / num_types;
+         if ( skip_block( sector[ type ], irrep ) ){ continue; } // Diagonalized by the owner process of the block
+         if ( IPEA_DELTA == 0.0 ){
+            newsize[ type ][ irrep ] = recreatehelper1( FOCK[ type ][ irrep ], OVLP[ type ][ irrep ], SIZE[ type ][ irrep ], work, eigs, lwork, NULL, 0 );
+            recreatehelper4( OVLP[ type ][ irrep ], SIZE[ type ][ irrep ], newsize[ type ][ irrep ], IPEA_OP[ type ][ irrep ], work );
+         } else {
+            newsize[ type ][ irrep ] = SIZE[ type ][ irrep ];
+            change_ipea_helper( FOCK[ type ][ irrep ], IPEA_OP[ type ][ irrep ], OVLP[ type ][ irrep ], SIZE[ type ][ irrep ], IPEA_DELTA, work, eigs, lwork, NULL, 0 );
+         }
+      }
+
+      delete [] work;
+      delete [] eigs;
+   }
+   #ifdef _OPENMP
+   omp_set_max_active_levels( max_levels );
+   #endif
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){ // All processes receive the diagonalized blocks from their owners
+      for ( int block = 0; block < num_blocks; block++ ){
+         const int type  = block % num_types;
+         const int irrep = block / num_types;
+         broadcast_diagonal_block( FOCK[ type ][ irrep ], OVLP[ type ][ irrep ], IPEA_OP[ type ][ irrep ], SIZE[ type ][ irrep ], newsize[ type ][ irrep ],
+                                   ( IPEA_DELTA == 0.0 ), block_owner[ irrep + num_irreps * sector[ type ] ] );
+      }
+   }
+   #endif
+
+   delete [] order;
+
+}
+
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::CASPT2::broadcast_diagonal_block( double * FOCK, double * OVLP, double *& IPEA_OP, const int SIZE, int & NEWSIZE, const bool resize, const int owner ){
+
+   MPIchemps2::broadcast_array_int( &NEWSIZE, 1, owner );
+   if (( resize ) && ( MPIchemps2::mpi_rank() != owner )){ // As in recreatehelper4
+      delete [] IPEA_OP;
+      IPEA_OP = new double[ NEWSIZE * NEWSIZE ];
+   }
+   if ( NEWSIZE > 0 ){
+      MPIchemps2::broadcast_array_double( FOCK,    NEWSIZE,           owner ); // Eigenvalues
+      MPIchemps2::broadcast_array_double( OVLP,    SIZE * NEWSIZE,    owner ); // Transformation to the eigenbasis
+      MPIchemps2::broadcast_array_double( IPEA_OP, NEWSIZE * NEWSIZE, owner );
+   }
+
+}
+#endif
+
+void CheMPS2::CASPT2::recreate(){
+
+   int * newsize_A = new int[ num_irreps ];
+   int * newsize_C = new int[ num_irreps ];
+   int * newsize_D = new int[ num_irreps ];
+   int * newsize_E = new int[ num_irreps ];
+   int * newsize_G = new int[ num_irreps ];
+   int * newsize_B_singlet = new int[ num_irreps ];
+   int * newsize_B_triplet = new int[ num_irreps ];
+   int * newsize_F_singlet = new int[ num_irreps ];
+   int * newsize_F_triplet = new int[ num_irreps ];
+
+   int * newsize[] = { newsize_A, newsize_C, newsize_D, newsize_E, newsize_G, newsize_B_singlet, newsize_B_triplet, newsize_F_singlet, newsize_F_triplet };
+   recreatebatch( newsize, 0.0 );
+
+   recreaterotate( newsize_A, newsize_C, newsize_D, newsize_E, newsize_G, newsize_B_singlet, newsize_B_triplet, newsize_F_singlet, newsize_F_triplet, NULL );
+
+   const long long total_size = jump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ];
+   if ( am_i_master ){ cout << "CASPT2 : New size V_SD space  = " << total_size << endl; }
+
+}
+
+void CheMPS2::CASPT2::recreaterotate( int * newsize_A, int * newsize_C, int * newsize_D, int * newsize_E, int * newsize_G, int * newsize_B_singlet, int * newsize_B_triplet, int * newsize_F_singlet, int * newsize_F_triplet, double * guess ){
+
+   const int maxsize = get_maxsize();
+   double * work = new double[ maxsize * maxsize ];
+
    for ( int IL = 0; IL < num_irreps; IL++ ){
       for ( int IR = 0; IR < num_irreps; IR++ ){
 
@@ -1021,107 +1714,113 @@ void CheMPS2::CASPT2::recreate(){
    }
 
    delete [] work;
-   delete [] eigs;
 
-   double * tempvector_rhs = new double[ jump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ] ];
-   int * helper = new int[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ];
+   const long long old_size = jump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ];
+   bool temp_on_disk = rhs_on_disk;
+   double * tempvector_rhs = (( vector_rhs == NULL ) ? NULL : allocate_vector( old_size, temp_on_disk ));
+   bool guess_on_disk = rhs_on_disk;
+   double * tempvector_guess = (( guess == NULL ) ? NULL : allocate_vector( old_size, guess_on_disk ));
+   long long * helper = new long long[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ];
    for ( int ptr = 0; ptr < num_irreps * CHEMPS2_CASPT2_NUM_CASES; ptr++ ){ helper[ ptr ] = 0; }
 
-   for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+   for ( int vec = 0; vec < (( guess == NULL ) ? 1 : 2 ); vec++ ){ // First the RHS, then the guess
+      double * old_vector = (( vec == 0 ) ? vector_rhs : guess ); // The MPI helper processes have no RHS
+      double * new_vector = (( vec == 0 ) ? tempvector_rhs : tempvector_guess );
+      for ( int irrep = 0; irrep < num_irreps; irrep++ ){
 
-      if ( newsize_A[ irrep ] > 0 ){
-         const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_A;
-         const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_A[ irrep ];
-         assert( num_rhs * size_A[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
-         helper[ ptr ] = num_rhs * newsize_A[ irrep ];
-         recreatehelper3( SAA[ irrep ], size_A[ irrep ], newsize_A[ irrep ], vector_rhs + jump[ ptr ], tempvector_rhs + jump[ ptr ], num_rhs );
-      }
+         if ( newsize_A[ irrep ] > 0 ){
+            const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_A;
+            const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_A[ irrep ];
+            assert( ( ( long long ) num_rhs ) * size_A[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
+            helper[ ptr ] = ( ( long long ) num_rhs ) * newsize_A[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SAA[ irrep ], size_A[ irrep ], newsize_A[ irrep ], old_vector + jump[ ptr ], new_vector + jump[ ptr ], num_rhs ); }
+         }
 
-      if ( newsize_B_singlet[ irrep ] > 0 ){
-         const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_B_SINGLET;
-         const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_B_singlet[ irrep ];
-         assert( num_rhs * size_B_singlet[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
-         helper[ ptr ] = num_rhs * newsize_B_singlet[ irrep ];
-         recreatehelper3( SBB_singlet[ irrep ], size_B_singlet[ irrep ], newsize_B_singlet[ irrep ], vector_rhs + jump[ ptr ], tempvector_rhs + jump[ ptr ], num_rhs );
-      }
+         if ( newsize_B_singlet[ irrep ] > 0 ){
+            const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_B_SINGLET;
+            const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_B_singlet[ irrep ];
+            assert( ( ( long long ) num_rhs ) * size_B_singlet[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
+            helper[ ptr ] = ( ( long long ) num_rhs ) * newsize_B_singlet[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SBB_singlet[ irrep ], size_B_singlet[ irrep ], newsize_B_singlet[ irrep ], old_vector + jump[ ptr ], new_vector + jump[ ptr ], num_rhs ); }
+         }
 
-      if ( newsize_B_triplet[ irrep ] > 0 ){
-         const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_B_TRIPLET;
-         const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_B_triplet[ irrep ];
-         assert( num_rhs * size_B_triplet[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
-         helper[ ptr ] = num_rhs * newsize_B_triplet[ irrep ];
-         recreatehelper3( SBB_triplet[ irrep ], size_B_triplet[ irrep ], newsize_B_triplet[ irrep ], vector_rhs + jump[ ptr ], tempvector_rhs + jump[ ptr ], num_rhs );
-      }
+         if ( newsize_B_triplet[ irrep ] > 0 ){
+            const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_B_TRIPLET;
+            const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_B_triplet[ irrep ];
+            assert( ( ( long long ) num_rhs ) * size_B_triplet[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
+            helper[ ptr ] = ( ( long long ) num_rhs ) * newsize_B_triplet[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SBB_triplet[ irrep ], size_B_triplet[ irrep ], newsize_B_triplet[ irrep ], old_vector + jump[ ptr ], new_vector + jump[ ptr ], num_rhs ); }
+         }
 
-      if ( newsize_C[ irrep ] > 0 ){
-         const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_C;
-         const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_C[ irrep ];
-         assert( num_rhs * size_C[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
-         helper[ ptr ] = num_rhs * newsize_C[ irrep ];
-         recreatehelper3( SCC[ irrep ], size_C[ irrep ], newsize_C[ irrep ], vector_rhs + jump[ ptr ], tempvector_rhs + jump[ ptr ], num_rhs );
-      }
+         if ( newsize_C[ irrep ] > 0 ){
+            const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_C;
+            const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_C[ irrep ];
+            assert( ( ( long long ) num_rhs ) * size_C[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
+            helper[ ptr ] = ( ( long long ) num_rhs ) * newsize_C[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SCC[ irrep ], size_C[ irrep ], newsize_C[ irrep ], old_vector + jump[ ptr ], new_vector + jump[ ptr ], num_rhs ); }
+         }
 
-      if ( newsize_D[ irrep ] > 0 ){
-         const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_D;
-         const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_D[ irrep ];
-         assert( num_rhs * size_D[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
-         helper[ ptr ] = num_rhs * newsize_D[ irrep ];
-         recreatehelper3( SDD[ irrep ], size_D[ irrep ], newsize_D[ irrep ], vector_rhs + jump[ ptr ], tempvector_rhs + jump[ ptr ], num_rhs );
-      }
+         if ( newsize_D[ irrep ] > 0 ){
+            const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_D;
+            const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_D[ irrep ];
+            assert( ( ( long long ) num_rhs ) * size_D[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
+            helper[ ptr ] = ( ( long long ) num_rhs ) * newsize_D[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SDD[ irrep ], size_D[ irrep ], newsize_D[ irrep ], old_vector + jump[ ptr ], new_vector + jump[ ptr ], num_rhs ); }
+         }
 
-      if ( newsize_E[ irrep ] > 0 ){
-         const int ptr1 = irrep + num_irreps * CHEMPS2_CASPT2_E_SINGLET;
-         const int num_rhs1 = ( jump[ ptr1 + 1 ] - jump[ ptr1 ] ) / size_E[ irrep ];
-         assert( num_rhs1 * size_E[ irrep ] == jump[ ptr1 + 1 ] - jump[ ptr1 ] );
-         helper[ ptr1 ] = num_rhs1 * newsize_E[ irrep ];
-         recreatehelper3( SEE[ irrep ], size_E[ irrep ], newsize_E[ irrep ], vector_rhs + jump[ ptr1 ], tempvector_rhs + jump[ ptr1 ], num_rhs1 );
-         const int ptr2 = irrep + num_irreps * CHEMPS2_CASPT2_E_TRIPLET;
-         const int num_rhs2 = ( jump[ ptr2 + 1 ] - jump[ ptr2 ] ) / size_E[ irrep ];
-         assert( num_rhs2 * size_E[ irrep ] == jump[ ptr2 + 1 ] - jump[ ptr2 ] );
-         helper[ ptr2 ] = num_rhs2 * newsize_E[ irrep ];
-         recreatehelper3( SEE[ irrep ], size_E[ irrep ], newsize_E[ irrep ], vector_rhs + jump[ ptr2 ], tempvector_rhs + jump[ ptr2 ], num_rhs2 );
-      }
+         if ( newsize_E[ irrep ] > 0 ){
+            const int ptr1 = irrep + num_irreps * CHEMPS2_CASPT2_E_SINGLET;
+            const int num_rhs1 = ( jump[ ptr1 + 1 ] - jump[ ptr1 ] ) / size_E[ irrep ];
+            assert( ( ( long long ) num_rhs1 ) * size_E[ irrep ] == jump[ ptr1 + 1 ] - jump[ ptr1 ] );
+            helper[ ptr1 ] = ( ( long long ) num_rhs1 ) * newsize_E[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SEE[ irrep ], size_E[ irrep ], newsize_E[ irrep ], old_vector + jump[ ptr1 ], new_vector + jump[ ptr1 ], num_rhs1 ); }
+            const int ptr2 = irrep + num_irreps * CHEMPS2_CASPT2_E_TRIPLET;
+            const int num_rhs2 = ( jump[ ptr2 + 1 ] - jump[ ptr2 ] ) / size_E[ irrep ];
+            assert( ( ( long long ) num_rhs2 ) * size_E[ irrep ] == jump[ ptr2 + 1 ] - jump[ ptr2 ] );
+            helper[ ptr2 ] = ( ( long long ) num_rhs2 ) * newsize_E[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SEE[ irrep ], size_E[ irrep ], newsize_E[ irrep ], old_vector + jump[ ptr2 ], new_vector + jump[ ptr2 ], num_rhs2 ); }
+         }
 
-      if ( newsize_F_singlet[ irrep ] > 0 ){
-         const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_F_SINGLET;
-         const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_F_singlet[ irrep ];
-         assert( num_rhs * size_F_singlet[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
-         helper[ ptr ] = num_rhs * newsize_F_singlet[ irrep ];
-         recreatehelper3( SFF_singlet[ irrep ], size_F_singlet[ irrep ], newsize_F_singlet[ irrep ], vector_rhs + jump[ ptr ], tempvector_rhs + jump[ ptr ], num_rhs );
-      }
+         if ( newsize_F_singlet[ irrep ] > 0 ){
+            const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_F_SINGLET;
+            const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_F_singlet[ irrep ];
+            assert( ( ( long long ) num_rhs ) * size_F_singlet[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
+            helper[ ptr ] = ( ( long long ) num_rhs ) * newsize_F_singlet[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SFF_singlet[ irrep ], size_F_singlet[ irrep ], newsize_F_singlet[ irrep ], old_vector + jump[ ptr ], new_vector + jump[ ptr ], num_rhs ); }
+         }
 
-      if ( newsize_F_triplet[ irrep ] > 0 ){
-         const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_F_TRIPLET;
-         const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_F_triplet[ irrep ];
-         assert( num_rhs * size_F_triplet[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
-         helper[ ptr ] = num_rhs * newsize_F_triplet[ irrep ];
-         recreatehelper3( SFF_triplet[ irrep ], size_F_triplet[ irrep ], newsize_F_triplet[ irrep ], vector_rhs + jump[ ptr ], tempvector_rhs + jump[ ptr ], num_rhs );
-      }
+         if ( newsize_F_triplet[ irrep ] > 0 ){
+            const int ptr = irrep + num_irreps * CHEMPS2_CASPT2_F_TRIPLET;
+            const int num_rhs = ( jump[ ptr + 1 ] - jump[ ptr ] ) / size_F_triplet[ irrep ];
+            assert( ( ( long long ) num_rhs ) * size_F_triplet[ irrep ] == jump[ ptr + 1 ] - jump[ ptr ] );
+            helper[ ptr ] = ( ( long long ) num_rhs ) * newsize_F_triplet[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SFF_triplet[ irrep ], size_F_triplet[ irrep ], newsize_F_triplet[ irrep ], old_vector + jump[ ptr ], new_vector + jump[ ptr ], num_rhs ); }
+         }
 
-      if ( newsize_G[ irrep ] > 0 ){
-         const int ptr1 = irrep + num_irreps * CHEMPS2_CASPT2_G_SINGLET;
-         const int num_rhs1 = ( jump[ ptr1 + 1 ] - jump[ ptr1 ] ) / size_G[ irrep ];
-         assert( num_rhs1 * size_G[ irrep ] == jump[ ptr1 + 1 ] - jump[ ptr1 ] );
-         helper[ ptr1 ] = num_rhs1 * newsize_G[ irrep ];
-         recreatehelper3( SGG[ irrep ], size_G[ irrep ], newsize_G[ irrep ], vector_rhs + jump[ ptr1 ], tempvector_rhs + jump[ ptr1 ], num_rhs1 );
-         const int ptr2 = irrep + num_irreps * CHEMPS2_CASPT2_G_TRIPLET;
-         const int num_rhs2 = ( jump[ ptr2 + 1 ] - jump[ ptr2 ] ) / size_G[ irrep ];
-         assert( num_rhs2 * size_G[ irrep ] == jump[ ptr2 + 1 ] - jump[ ptr2 ] );
-         helper[ ptr2 ] = num_rhs2 * newsize_G[ irrep ];
-         recreatehelper3( SGG[ irrep ], size_G[ irrep ], newsize_G[ irrep ], vector_rhs + jump[ ptr2 ], tempvector_rhs + jump[ ptr2 ], num_rhs2 );
-      }
+         if ( newsize_G[ irrep ] > 0 ){
+            const int ptr1 = irrep + num_irreps * CHEMPS2_CASPT2_G_SINGLET;
+            const int num_rhs1 = ( jump[ ptr1 + 1 ] - jump[ ptr1 ] ) / size_G[ irrep ];
+            assert( ( ( long long ) num_rhs1 ) * size_G[ irrep ] == jump[ ptr1 + 1 ] - jump[ ptr1 ] );
+            helper[ ptr1 ] = ( ( long long ) num_rhs1 ) * newsize_G[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SGG[ irrep ], size_G[ irrep ], newsize_G[ irrep ], old_vector + jump[ ptr1 ], new_vector + jump[ ptr1 ], num_rhs1 ); }
+            const int ptr2 = irrep + num_irreps * CHEMPS2_CASPT2_G_TRIPLET;
+            const int num_rhs2 = ( jump[ ptr2 + 1 ] - jump[ ptr2 ] ) / size_G[ irrep ];
+            assert( ( ( long long ) num_rhs2 ) * size_G[ irrep ] == jump[ ptr2 + 1 ] - jump[ ptr2 ] );
+            helper[ ptr2 ] = ( ( long long ) num_rhs2 ) * newsize_G[ irrep ];
+            if ( old_vector != NULL ){ recreatehelper3( SGG[ irrep ], size_G[ irrep ], newsize_G[ irrep ], old_vector + jump[ ptr2 ], new_vector + jump[ ptr2 ], num_rhs2 ); }
+         }
 
-      const int ptr1 = irrep + num_irreps * CHEMPS2_CASPT2_H_SINGLET;
-      helper[ ptr1 ] = jump[ ptr1 + 1 ] - jump[ ptr1 ];
-      int inc1 = 1;
-      dcopy_( helper + ptr1, vector_rhs + jump[ ptr1 ], &inc1, tempvector_rhs + jump[ ptr1 ], &inc1 );
-      const int ptr2 = irrep + num_irreps * CHEMPS2_CASPT2_H_TRIPLET;
-      helper[ ptr2 ] = jump[ ptr2 + 1 ] - jump[ ptr2 ];
-      dcopy_( helper + ptr2, vector_rhs + jump[ ptr2 ], &inc1, tempvector_rhs + jump[ ptr2 ], &inc1 );
+         const int ptr1 = irrep + num_irreps * CHEMPS2_CASPT2_H_SINGLET;
+         helper[ ptr1 ] = jump[ ptr1 + 1 ] - jump[ ptr1 ];
+         if ( old_vector != NULL ){ for ( long long elem = jump[ ptr1 ]; elem < jump[ ptr1 + 1 ]; elem++ ){ new_vector[ elem ] = old_vector[ elem ]; } }
+         const int ptr2 = irrep + num_irreps * CHEMPS2_CASPT2_H_TRIPLET;
+         helper[ ptr2 ] = jump[ ptr2 + 1 ] - jump[ ptr2 ];
+         if ( old_vector != NULL ){ for ( long long elem = jump[ ptr2 ]; elem < jump[ ptr2 + 1 ]; elem++ ){ new_vector[ elem ] = old_vector[ elem ]; } }
 
+      }
    }
 
-   delete [] vector_rhs;
+   if ( vector_rhs != NULL ){ free_vector( vector_rhs, old_size, rhs_on_disk ); }
    delete [] size_A;         size_A = newsize_A;
    delete [] size_C;         size_C = newsize_C;
    delete [] size_D;         size_D = newsize_D;
@@ -1132,17 +1831,23 @@ void CheMPS2::CASPT2::recreate(){
    delete [] size_F_singlet; size_F_singlet = newsize_F_singlet;
    delete [] size_F_triplet; size_F_triplet = newsize_F_triplet;
 
-   int * newjump = new int[ num_irreps * CHEMPS2_CASPT2_NUM_CASES + 1 ];
+   long long * newjump = new long long[ num_irreps * CHEMPS2_CASPT2_NUM_CASES + 1 ];
    newjump[ 0 ] = 0;
    for ( int cnt = 0; cnt < num_irreps * CHEMPS2_CASPT2_NUM_CASES; cnt++ ){
       newjump[ cnt + 1 ] = newjump[ cnt ] + helper[ cnt ];
    }
-   vector_rhs = new double[ newjump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ] ];
-   int inc1 = 1;
-   for ( int cnt = 0; cnt < num_irreps * CHEMPS2_CASPT2_NUM_CASES; cnt++ ){
-      dcopy_( helper + cnt, tempvector_rhs + jump[ cnt ], &inc1, vector_rhs + newjump[ cnt ], &inc1 );
+   if ( tempvector_rhs != NULL ){
+      vector_rhs = allocate_vector( newjump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ], rhs_on_disk );
+      for ( int cnt = 0; cnt < num_irreps * CHEMPS2_CASPT2_NUM_CASES; cnt++ ){
+         for ( long long elem = 0; elem < helper[ cnt ]; elem++ ){ vector_rhs[ newjump[ cnt ] + elem ] = tempvector_rhs[ jump[ cnt ] + elem ]; }
+      }
+      free_vector( tempvector_rhs, old_size, temp_on_disk );
+   }
+   if ( guess != NULL ){ // Only with unchanged sizes
+      assert( jump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ] == newjump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ] );
+      for ( long long elem = 0; elem < old_size; elem++ ){ guess[ elem ] = tempvector_guess[ elem ]; }
+      free_vector( tempvector_guess, old_size, guess_on_disk );
    }
-   delete [] tempvector_rhs;
    delete [] helper;
    delete [] jump;
    jump = newjump;
@@ -1168,6 +1873,7 @@ void CheMPS2::CASPT2::recreate(){
    delete [] SFF_singlet;
    delete [] SFF_triplet;
 
+   int inc1 = 1;
    double * temp = NULL;
    for ( int irrep = 0; irrep < num_irreps; irrep++ ){
        temp = new double[ size_A[ irrep ] ]; dcopy_( size_A + irrep, FAA[ irrep ], &inc1, temp, &inc1 ); delete [] FAA[ irrep ]; FAA[ irrep ] = temp;
@@ -1181,9 +1887,6 @@ void CheMPS2::CASPT2::recreate(){
        temp = new double[ size_F_triplet[ irrep ] ]; dcopy_( size_F_triplet + irrep, FFF_triplet[ irrep ], &inc1, temp, &inc1 ); delete [] FFF_triplet[ irrep ]; FFF_triplet[ irrep ] = temp;
    }
 
-   const int total_size = jump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ];
-   cout << "CASPT2 : New size V_SD space  = " << total_size << endl;
-
 }
 
 int CheMPS2::CASPT2::get_maxsize() const{
@@ -1215,7 +1918,20 @@ void CheMPS2::CASPT2::matmat( char totrans, int rowdim, int coldim, int sumdim,
 
 }
 
-void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fock ) const{
+#ifdef CHEMPS2_MPI_COMPILATION
+bool CheMPS2::CASPT2::skip_unit( const int unit, const bool distributed ){
+#else
+bool CheMPS2::CASPT2::skip_unit( const int, const bool ){
+#endif
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( distributed ){ return ( MPIchemps2::owner_caspt2_unit( unit ) != MPIchemps2::mpi_rank() ); }
+   #endif
+   return false;
+
+}
+
+void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fock, const bool distributed, const long long * offsets ) const{
 
    /*
          FOCK  | A  Bsinglet  Btriplet  C     D1     D2    Esinglet  Etriplet  Fsinglet  Ftriplet  Gsinglet  Gtriplet  Hsinglet  Htriplet
@@ -1237,27 +1953,34 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
       
    */
 
-   const int vectorlength = jump[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ];
-   #pragma omp simd
-   for ( int elem = 0; elem < vectorlength; elem++ ){ result[ elem ] = diag_fock[ elem ] * vector[ elem ]; }
+   const long long * jumps = (( offsets == NULL ) ? jump : offsets );
+   const long long vectorlength = jumps[ CHEMPS2_CASPT2_NUM_CASES * num_irreps ];
+   if ( diag_fock != NULL ){
+      #pragma omp simd
+      for ( long long elem = 0; elem < vectorlength; elem++ ){ result[ elem ] = diag_fock[ elem ] * vector[ elem ]; }
+   } else { // A distributed product, in which each process only adds its share of the coupling blocks
+      for ( long long elem = 0; elem < vectorlength; elem++ ){ result[ elem ] = 0.0; }
+   }
    const int maxlinsize = get_maxsize();
    double * workspace = new double[ maxlinsize * maxlinsize ];
    const double SQRT2 = sqrt( 2.0 );
+   int work_unit = 0; // Each ( coupling block, IL ) is a work unit of the distributed matrix-vector product, see needed_blocks
 
    // FAD: < A(xjyz) E_wc D(aitu) > = delta_ac delta_ij FAD[ Ij ][ Ii x Ia ][ w ][ (xyz),(tu) ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ii == Ij == Ix x Iy x Iz
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_A[ IL ];
       const int nocc_ij = indices->getNOCC( IL );
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It x Iu == Ii x Ia
          const int SIZE_R = size_D[ IR ];
          const int Iw = Irreps::directProd( IL, IR ); // Ia == Ic == Iw == IL x IR
-         const int shift = shift_D_nonactive( indices, IL, Iw );
+         const long long shift = shift_D_nonactive( indices, IL, Iw );
          const int nocc_w = indices->getNOCC( Iw );
          const int nact_w = indices->getNDMRG( Iw );
          const int n_oa_w = nocc_w + nact_w;
          const int nvir_w = indices->getNVIRT( Iw );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nocc_ij * nact_w * nvir_w > 0 ){
+         if (( total_size > 0 ) && ( nocc_ij > 0 ) && ( nact_w > 0 ) && ( nvir_w > 0 )){
             for ( int ac = 0; ac < nvir_w; ac++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1265,8 +1988,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   int inc1 = 1;
                   daxpy_( &total_size, &f_wc, FAD[ IL ][ IR ][ w ], &inc1, workspace, &inc1 );
                }
-               const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_A ];
-               const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_D ] + SIZE_R * ( shift + nocc_ij * ac );
+               const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_A ];
+               const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_D ] + SIZE_R * ( shift + nocc_ij * ac );
                matmat( 'N', SIZE_L, nocc_ij, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                matmat( 'T', SIZE_R, nocc_ij, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
             }
@@ -1276,16 +1999,17 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FCD: < C(bxyz) E_kw D(aitu) > = delta_ik delta_ab FCD[ Ib ][ Ii x Ia ][ w ][ (xyz),(tu) ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ia == Ib
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_C[ IL ];
       const int nvir_ab = indices->getNVIRT( IL );
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It x Iu == Ii x Ia
          const int SIZE_R = size_D[ IR ];
          const int Iw = Irreps::directProd( IL, IR ); // Ii == Ik == Iw == IL x IR
-         const int shift = shift_D_nonactive( indices, Iw, IL );
+         const long long shift = shift_D_nonactive( indices, Iw, IL );
          const int nocc_w = indices->getNOCC( Iw );
          const int nact_w = indices->getNDMRG( Iw );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nvir_ab * nact_w * nocc_w > 0 ){
+         if (( total_size > 0 ) && ( nvir_ab > 0 ) && ( nact_w > 0 ) && ( nocc_w > 0 )){
             for ( int ik = 0; ik < nocc_w; ik++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1293,8 +2017,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   int inc1 = 1;
                   daxpy_( &total_size, &f_kw, FCD[ IL ][ IR ][ w ], &inc1, workspace, &inc1 );
                }
-               const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_C ];
-               const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_D ] + SIZE_R * ( shift + ik );
+               const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_C ];
+               const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_D ] + SIZE_R * ( shift + ik );
                const int LDA_R = SIZE_R * nocc_w;
                matmat( 'N', SIZE_L, nvir_ab, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, LDA_R,  result + ptr_L, SIZE_L );
                matmat( 'T', SIZE_R, nvir_ab, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, LDA_R  );
@@ -1305,16 +2029,17 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FAB singlet: < A(xlyz) E_kw SB_tiuj > = ( delta_ik delta_jl + delta_jk delta_il ) / sqrt( 1 + delta_ij ) * FAB_singlet[ Il ][ Ii x Ij ][ w ][ (xyz),(tu) ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Il == Ix x Iy x Iz
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_A[ IL ];
       const int nocc_l = indices->getNOCC( IL );
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It x Iu == Ii x Ij
          const int SIZE_R = size_B_singlet[ IR ];
          const int Iw = Irreps::directProd( IL, IR ); // Iw == Ik
-         const int shift = (( Iw < IL ) ? shift_B_nonactive( indices, Iw, IL, +1 ) : shift_B_nonactive( indices, IL, Iw, +1 ));
+         const long long shift = (( Iw < IL ) ? shift_B_nonactive( indices, Iw, IL, +1 ) : shift_B_nonactive( indices, IL, Iw, +1 ));
          const int nocc_w = indices->getNOCC( Iw );
          const int nact_w = indices->getNDMRG( Iw );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nocc_l * nact_w * nocc_w > 0 ){
+         if (( total_size > 0 ) && ( nocc_l > 0 ) && ( nact_w > 0 ) && ( nocc_w > 0 )){
             for ( int k = 0; k < nocc_w; k++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1324,22 +2049,22 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                }
                if ( IR == 0 ){ // Ii == Ij  and  Ik == Il
                   if ( k > 0 ){
-                     const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_A         ];
-                     const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE_R * ( shift + ( k * ( k + 1 ) ) / 2 );
+                     const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_A         ];
+                     const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE_R * ( shift + ( k * ( k + 1 ) ) / 2 );
                      matmat( 'N', SIZE_L, k, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                      matmat( 'T', SIZE_R, k, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                   }
                   #pragma omp parallel for schedule(static)
                   for ( int l = k; l < nocc_l; l++ ){
-                     const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_A         ] + SIZE_L * l;
-                     const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE_R * ( shift + k + ( l * ( l + 1 ) ) / 2 );
+                     const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_A         ] + SIZE_L * l;
+                     const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE_R * ( shift + k + ( l * ( l + 1 ) ) / 2 );
                      const double factor = (( k == l ) ? SQRT2 : 1.0 );
                      matmat( 'N', SIZE_L, 1, SIZE_R, factor, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                      matmat( 'T', SIZE_R, 1, SIZE_L, factor, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                   }
                } else {
-                  const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_A         ];
-                  const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE_R * ( shift + (( Iw < IL ) ? k : nocc_l * k ));
+                  const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_A         ];
+                  const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE_R * ( shift + (( Iw < IL ) ? k : nocc_l * k ));
                   const int LDA_R = (( Iw < IL ) ? SIZE_R * nocc_w : SIZE_R );
                   matmat( 'N', SIZE_L, nocc_l, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, LDA_R,  result + ptr_L, SIZE_L );
                   matmat( 'T', SIZE_R, nocc_l, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, LDA_R  );
@@ -1351,16 +2076,17 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FAB triplet: < A(xlyz) E_kw TB_tiuj > = ( delta_ik delta_jl - delta_jk delta_il ) * FAB_triplet[ Il ][ Ii x Ij ][ w ][ (xyz),(tu) ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Il == Ix x Iy x Iz
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_A[ IL ];
       const int nocc_l = indices->getNOCC( IL );
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It x Iu == Ii x Ij
          const int SIZE_R = size_B_triplet[ IR ];
          const int Iw = Irreps::directProd( IL, IR ); // Iw == Ik
-         const int shift = (( Iw < IL ) ? shift_B_nonactive( indices, Iw, IL, -1 ) : shift_B_nonactive( indices, IL, Iw, -1 ));
+         const long long shift = (( Iw < IL ) ? shift_B_nonactive( indices, Iw, IL, -1 ) : shift_B_nonactive( indices, IL, Iw, -1 ));
          const int nocc_w = indices->getNOCC( Iw );
          const int nact_w = indices->getNDMRG( Iw );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nocc_l * nact_w * nocc_w > 0 ){
+         if (( total_size > 0 ) && ( nocc_l > 0 ) && ( nact_w > 0 ) && ( nocc_w > 0 )){
             for ( int k = 0; k < nocc_w; k++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1370,21 +2096,21 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                }
                if ( IR == 0 ){ // Ii == Ij  and  Ik == Il
                   if ( k > 0 ){ // ( k > l  --->  - delta_jk delta_il )
-                     const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_A         ];
-                     const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE_R * ( shift + ( k * ( k - 1 ) ) / 2 );
+                     const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_A         ];
+                     const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE_R * ( shift + ( k * ( k - 1 ) ) / 2 );
                      matmat( 'N', SIZE_L, k, SIZE_R, -1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                      matmat( 'T', SIZE_R, k, SIZE_L, -1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                   }
                   #pragma omp parallel for schedule(static)
                   for ( int l = k+1; l < nocc_l; l++ ){
-                     const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_A         ] + SIZE_L * l;
-                     const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE_R * ( shift + k + ( l * ( l - 1 ) ) / 2 );
+                     const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_A         ] + SIZE_L * l;
+                     const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE_R * ( shift + k + ( l * ( l - 1 ) ) / 2 );
                      matmat( 'N', SIZE_L, 1, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L ); // ( k < l  --->  + delta_ik delta_jl )
                      matmat( 'T', SIZE_R, 1, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                   }
                } else {
-                  const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_A         ];
-                  const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE_R * ( shift + (( Iw < IL ) ? k : nocc_l * k ));
+                  const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_A         ];
+                  const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE_R * ( shift + (( Iw < IL ) ? k : nocc_l * k ));
                   const int LDA_R = (( Iw < IL ) ? SIZE_R * nocc_w : SIZE_R );
                   const double factor = (( Iw < IL ) ? 1.0 : -1.0 ); // ( k < l  --->  + delta_ik delta_jl ) and ( k > l  --->  - delta_jk delta_il )
                   matmat( 'N', SIZE_L, nocc_l, SIZE_R, factor, workspace, SIZE_L, vector + ptr_R, LDA_R,  result + ptr_L, SIZE_L );
@@ -1397,18 +2123,19 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FCF singlet: < C(dxyz) E_wc SF_atbu > = ( delta_ac delta_bd + delta_ad delta_bc ) / sqrt( 1 + delta_ab ) * FCF_singlet[ Id ][ Ia x Ib ][ w ][ (xyz),(tu) ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Id == Ix x Iy x Iz
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_C[ IL ];
       const int nvir_d = indices->getNVIRT( IL );
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It x Iu == Ia x Ib
          const int SIZE_R = size_F_singlet[ IR ];
          const int Iw = Irreps::directProd( IL, IR ); // Iw == Ic
-         const int shift = (( Iw < IL ) ? shift_F_nonactive( indices, Iw, IL, +1 ) : shift_F_nonactive( indices, IL, Iw, +1 ));
+         const long long shift = (( Iw < IL ) ? shift_F_nonactive( indices, Iw, IL, +1 ) : shift_F_nonactive( indices, IL, Iw, +1 ));
          const int nocc_w = indices->getNOCC( Iw );
          const int nact_w = indices->getNDMRG( Iw );
          const int n_oa_w = nocc_w + nact_w;
          const int nvir_w = indices->getNVIRT( Iw );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nvir_d * nact_w * nvir_w > 0 ){
+         if (( total_size > 0 ) && ( nvir_d > 0 ) && ( nact_w > 0 ) && ( nvir_w > 0 )){
             for ( int c = 0; c < nvir_w; c++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1418,22 +2145,22 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                }
                if ( IR == 0 ){ // Ia == Ib  and  Ic == Id
                   if ( c > 0 ){
-                     const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_C         ];
-                     const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE_R * ( shift + ( c * ( c + 1 ) ) / 2 );
+                     const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_C         ];
+                     const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE_R * ( shift + ( c * ( c + 1 ) ) / 2 );
                      matmat( 'N', SIZE_L, c, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                      matmat( 'T', SIZE_R, c, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                   }
                   #pragma omp parallel for schedule(static)
                   for ( int d = c; d < nvir_d; d++ ){
-                     const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_C         ] + SIZE_L * d;
-                     const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE_R * ( shift + c + ( d * ( d + 1 ) ) / 2 );
+                     const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_C         ] + SIZE_L * d;
+                     const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE_R * ( shift + c + ( d * ( d + 1 ) ) / 2 );
                      const double factor = (( c == d ) ? SQRT2 : 1.0 );
                      matmat( 'N', SIZE_L, 1, SIZE_R, factor, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                      matmat( 'T', SIZE_R, 1, SIZE_L, factor, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                   }
                } else {
-                  const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_C         ];
-                  const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE_R * ( shift + (( Iw < IL ) ? c : nvir_d * c ));
+                  const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_C         ];
+                  const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE_R * ( shift + (( Iw < IL ) ? c : nvir_d * c ));
                   const int LDA_R = (( Iw < IL ) ? SIZE_R * nvir_w : SIZE_R );
                   matmat( 'N', SIZE_L, nvir_d, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, LDA_R,  result + ptr_L, SIZE_L );
                   matmat( 'T', SIZE_R, nvir_d, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, LDA_R  );
@@ -1445,18 +2172,19 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FCF triplet: < C(dxyz) E_wc TF_atbu > = ( delta_ac delta_bd - delta_ad delta_bc ) * FCF_triplet[ Id ][ Ia x Ib ][ w ][ (xyz),(tu) ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Id == Ix x Iy x Iz
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_C[ IL ];
       const int nvir_d = indices->getNVIRT( IL );
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It x Iu == Ia x Ib
          const int SIZE_R = size_F_triplet[ IR ];
          const int Iw = Irreps::directProd( IL, IR ); // Iw == Ic
-         const int shift = (( Iw < IL ) ? shift_F_nonactive( indices, Iw, IL, -1 ) : shift_F_nonactive( indices, IL, Iw, -1 ));
+         const long long shift = (( Iw < IL ) ? shift_F_nonactive( indices, Iw, IL, -1 ) : shift_F_nonactive( indices, IL, Iw, -1 ));
          const int nocc_w = indices->getNOCC( Iw );
          const int nact_w = indices->getNDMRG( Iw );
          const int n_oa_w = nocc_w + nact_w;
          const int nvir_w = indices->getNVIRT( Iw );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nvir_d * nact_w * nvir_w > 0 ){
+         if (( total_size > 0 ) && ( nvir_d > 0 ) && ( nact_w > 0 ) && ( nvir_w > 0 )){
             for ( int c = 0; c < nvir_w; c++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1466,22 +2194,22 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                }
                if ( IR == 0 ){ // Ia == Ib  and  Ic == Id
                   if ( c > 0 ){ // ( c > d  --->  - delta_ad delta_bc )
-                     const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_C         ];
-                     const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE_R * ( shift + ( c * ( c - 1 ) ) / 2 );
+                     const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_C         ];
+                     const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE_R * ( shift + ( c * ( c - 1 ) ) / 2 );
                      matmat( 'N', SIZE_L, c, SIZE_R, -1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                      matmat( 'T', SIZE_R, c, SIZE_L, -1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                   }
                   #pragma omp parallel for schedule(static)
                   for ( int d = c+1; d < nvir_d; d++ ){
-                     const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_C         ] + SIZE_L * d;
-                     const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE_R * ( shift + c + ( d * ( d - 1 ) ) / 2 );
+                     const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_C         ] + SIZE_L * d;
+                     const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE_R * ( shift + c + ( d * ( d - 1 ) ) / 2 );
                      matmat( 'N', SIZE_L, 1, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L ); // ( c < d  --->  + delta_ac delta_bd )
                      matmat( 'T', SIZE_R, 1, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                   }
                } else {
                   const double factor = (( Iw < IL ) ? 1.0 : -1.0 ); // ( c < d  --->  + delta_ac delta_bd ) and ( c > d  --->  - delta_ad delta_bc )
-                  const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_C         ];
-                  const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE_R * ( shift + (( Iw < IL ) ? c : nvir_d * c ));
+                  const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_C         ];
+                  const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE_R * ( shift + (( Iw < IL ) ? c : nvir_d * c ));
                   const int LDA_R = (( Iw < IL ) ? SIZE_R * nvir_w : SIZE_R );
                   matmat( 'N', SIZE_L, nvir_d, SIZE_R, factor, workspace, SIZE_L, vector + ptr_R, LDA_R,  result + ptr_L, SIZE_L );
                   matmat( 'T', SIZE_R, nvir_d, SIZE_L, factor, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, LDA_R  );
@@ -1493,6 +2221,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FBE singlet: < SB_xkyl E_wc SE_tiaj > = 2 delta_ac delta_ik delta_jl FBE_singlet[ Ik x Il ][ It ][ w ][ xy, t ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Iik x Ijl == Ix x Iy
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_B_singlet[ IL ];
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It == Iik x Ijl x Iac
          const int SIZE_R = size_E[ IR ];
@@ -1511,8 +2240,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
          }
          const int size_ij = linsize;
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nact_w * nvir_w * size_ij > 0 ){
-            const int shift_E = shift_E_nonactive( indices, Iw, 0, IL, +1 );
+         if (( total_size > 0 ) && ( nact_w > 0 ) && ( nvir_w > 0 ) && ( size_ij > 0 )){
+            const long long shift_E = shift_E_nonactive( indices, Iw, 0, IL, +1 );
             for ( int ac = 0; ac < nvir_w; ac++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1520,8 +2249,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   int inc1 = 1;
                   daxpy_( &total_size, &f_wc, FBE_singlet[ IL ][ IR ][ w ], &inc1, workspace, &inc1 );
                }
-               const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_B_SINGLET ];
-               const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE_R * ( shift_E + ac );
+               const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_B_SINGLET ];
+               const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE_R * ( shift_E + ac );
                const int LDA_R = SIZE_R * nvir_w;
                matmat( 'N', SIZE_L, size_ij, SIZE_R, 2.0, workspace, SIZE_L, vector + ptr_R, LDA_R,  result + ptr_L, SIZE_L );
                matmat( 'T', SIZE_R, size_ij, SIZE_L, 2.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, LDA_R  );
@@ -1532,6 +2261,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FBE triplet: < TB_xkyl E_wc TE_tiaj > = 2 delta_ac delta_ik delta_jl FBE_triplet[ Ik x Il ][ It ][ w ][ xy, t ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Iik x Ijl == Ix x Iy
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_B_triplet[ IL ];
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It == Iik x Ijl x Iac
          const int SIZE_R = size_E[ IR ];
@@ -1550,8 +2280,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
          }
          const int size_ij = linsize;
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nact_w * nvir_w * size_ij > 0 ){
-            const int shift_E = shift_E_nonactive( indices, Iw, 0, IL, -1 );
+         if (( total_size > 0 ) && ( nact_w > 0 ) && ( nvir_w > 0 ) && ( size_ij > 0 )){
+            const long long shift_E = shift_E_nonactive( indices, Iw, 0, IL, -1 );
             for ( int ac = 0; ac < nvir_w; ac++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1559,8 +2289,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   int inc1 = 1;
                   daxpy_( &total_size, &f_wc, FBE_triplet[ IL ][ IR ][ w ], &inc1, workspace, &inc1 );
                }
-               const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ];
-               const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE_R * ( shift_E + ac );
+               const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ];
+               const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE_R * ( shift_E + ac );
                const int LDA_R = SIZE_R * nvir_w;
                matmat( 'N', SIZE_L, size_ij, SIZE_R, 2.0, workspace, SIZE_L, vector + ptr_R, LDA_R,  result + ptr_L, SIZE_L );
                matmat( 'T', SIZE_R, size_ij, SIZE_L, 2.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, LDA_R  );
@@ -1571,6 +2301,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FFG singlet: < SF_cxdy E_kw SG_aibt > = 2 delta_ac delta_bd delta_ik FFG_singlet[ Ic x Id ][ It ][ w ][ xy, t ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Iac x Ibd == Ix x Iy
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_F_singlet[ IL ];
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It == Iac x Ibd x Iik
          const int SIZE_R = size_G[ IR ];
@@ -1587,8 +2318,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
          }
          const int size_ab = linsize;
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nact_w * nocc_w * size_ab > 0 ){
-            const int shift_G = shift_G_nonactive( indices, Iw, 0, IL, +1 );
+         if (( total_size > 0 ) && ( nact_w > 0 ) && ( nocc_w > 0 ) && ( size_ab > 0 )){
+            const long long shift_G = shift_G_nonactive( indices, Iw, 0, IL, +1 );
             for ( int ik = 0; ik < nocc_w; ik++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1596,8 +2327,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   int inc1 = 1;
                   daxpy_( &total_size, &f_kw, FFG_singlet[ IL ][ IR ][ w ], &inc1, workspace, &inc1 );
                }
-               const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_F_SINGLET ];
-               const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE_R * ( shift_G + ik );
+               const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_F_SINGLET ];
+               const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE_R * ( shift_G + ik );
                const int LDA_R = SIZE_R * nocc_w;
                matmat( 'N', SIZE_L, size_ab, SIZE_R, 2.0, workspace, SIZE_L, vector + ptr_R, LDA_R,  result + ptr_L, SIZE_L );
                matmat( 'T', SIZE_R, size_ab, SIZE_L, 2.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, LDA_R  );
@@ -1608,6 +2339,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FFG triplet: < TF_cxdy E_kw TG_aibt > = 2 delta_ac delta_bd delta_ik FFG_triplet[ Ic x Id ][ It ][ w ][ xy, t ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Iac x Ibd == Ix x Iy
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_F_triplet[ IL ];
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR == It == Iac x Ibd x Iik
          const int SIZE_R = size_G[ IR ];
@@ -1624,8 +2356,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
          }
          const int size_ab = linsize;
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nact_w * nocc_w * size_ab > 0 ){
-            const int shift_G = shift_G_nonactive( indices, Iw, 0, IL, -1 );
+         if (( total_size > 0 ) && ( nact_w > 0 ) && ( nocc_w > 0 ) && ( size_ab > 0 )){
+            const long long shift_G = shift_G_nonactive( indices, Iw, 0, IL, -1 );
             for ( int ik = 0; ik < nocc_w; ik++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_w; w++ ){
@@ -1633,8 +2365,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   int inc1 = 1;
                   daxpy_( &total_size, &f_kw, FFG_triplet[ IL ][ IR ][ w ], &inc1, workspace, &inc1 );
                }
-               const int ptr_L = jump[ IL + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ];
-               const int ptr_R = jump[ IR + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE_R * ( shift_G + ik );
+               const long long ptr_L = jumps[ IL + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ];
+               const long long ptr_R = jumps[ IR + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE_R * ( shift_G + ik );
                const int LDA_R = SIZE_R * nocc_w;
                matmat( 'N', SIZE_L, size_ab, SIZE_R, 2.0, workspace, SIZE_L, vector + ptr_R, LDA_R,  result + ptr_L, SIZE_L );
                matmat( 'T', SIZE_R, size_ab, SIZE_L, 2.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, LDA_R  );
@@ -1645,6 +2377,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FEH singlet: < SE_xkdl E_wc SH_aibj > = 2 delta_ik delta_jl ( delta_ac delta_bd + delta_ad delta_bc ) / sqrt( 1 + delta_ab ) FEH[ Ix ][ w ][ x ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ixw == Ic == Iik x Ijl x Id
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       int SIZE = size_E[ IL ];
       const int nocc_w = indices->getNOCC( IL );
       const int nact_w = indices->getNDMRG( IL );
@@ -1671,13 +2404,13 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   for ( int Ii = 0; Ii < num_irreps; Ii++ ){
                      const int Ij = Irreps::directProd( Ii, Icenter );
                      if ( Ii < Ij ){
-                        const int jump_E = jump[ IL + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * shift_E_nonactive( indices, Id, Ii, Ij, +1 );
-                        const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, Ii, Ij, IL, Id, +1 );
+                        const long long jump_E = jumps[ IL + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * shift_E_nonactive( indices, Id, Ii, Ij, +1 );
+                        const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, Ii, Ij, IL, Id, +1 );
                         const int size_ij = indices->getNOCC( Ii ) * indices->getNOCC( Ij );
                         #pragma omp parallel for schedule(static)
                         for ( int d = 0; d < nvir_d; d++ ){
-                           const int ptr_H = jump_H + size_ij * ( c + nvir_w * d );
-                           const int ptr_E = jump_E + SIZE * d;
+                           const long long ptr_H = jump_H + ( ( long long ) size_ij ) * ( c + nvir_w * d );
+                           const long long ptr_E = jump_E + SIZE * d;
                            matmat( 'N', SIZE, size_ij, 1,    2.0, workspace, SIZE, vector + ptr_H, 1,     result + ptr_E, LDA_E );
                            matmat( 'T', 1,    size_ij, SIZE, 2.0, workspace, SIZE, vector + ptr_E, LDA_E, result + ptr_H, 1     );
                         }
@@ -1687,20 +2420,20 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
                if ( IL == Id ){ // Ic == Id == Ia == Ib --> Iik == Ijl
                   for ( int Iij = 0; Iij < num_irreps; Iij++ ){
-                     const int jump_E = jump[ IL + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * shift_E_nonactive( indices, Id,  Iij, Iij, +1 );
-                     const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, Iij, Iij, IL,  Id, +1 );
+                     const long long jump_E = jumps[ IL + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * shift_E_nonactive( indices, Id,  Iij, Iij, +1 );
+                     const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, Iij, Iij, IL,  Id, +1 );
                      const int size_ij = ( indices->getNOCC( Iij ) * ( indices->getNOCC( Iij ) + 1 ) ) / 2;
                      #pragma omp parallel for schedule(static)
                      for ( int d = 0; d < c; d++ ){
-                        const int ptr_H = jump_H + size_ij * ( d + ( c * ( c + 1 ) ) / 2 );
-                        const int ptr_E = jump_E + SIZE * d;
+                        const long long ptr_H = jump_H + ( ( long long ) size_ij ) * ( d + ( c * ( c + 1 ) ) / 2 );
+                        const long long ptr_E = jump_E + SIZE * d;
                         matmat( 'N', SIZE, size_ij, 1,    2.0, workspace, SIZE, vector + ptr_H, 1,     result + ptr_E, LDA_E );
                         matmat( 'T', 1,    size_ij, SIZE, 2.0, workspace, SIZE, vector + ptr_E, LDA_E, result + ptr_H, 1     );
                      }
                      #pragma omp parallel for schedule(static)
                      for ( int d = c; d < nvir_d; d++ ){
-                        const int ptr_H = jump_H + size_ij * ( c + ( d * ( d + 1 ) ) / 2 );
-                        const int ptr_E = jump_E + SIZE * d;
+                        const long long ptr_H = jump_H + ( ( long long ) size_ij ) * ( c + ( d * ( d + 1 ) ) / 2 );
+                        const long long ptr_E = jump_E + SIZE * d;
                         const double factor = 2 * (( c == d ) ? SQRT2 : 1.0 );
                         matmat( 'N', SIZE, size_ij, 1,    factor, workspace, SIZE, vector + ptr_H, 1,     result + ptr_E, LDA_E );
                         matmat( 'T', 1,    size_ij, SIZE, factor, workspace, SIZE, vector + ptr_E, LDA_E, result + ptr_H, 1     );
@@ -1712,13 +2445,13 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   for ( int Ii = 0; Ii < num_irreps; Ii++ ){
                      const int Ij = Irreps::directProd( Ii, Icenter );
                      if ( Ii < Ij ){
-                        const int jump_E = jump[ IL + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * shift_E_nonactive( indices, Id, Ii, Ij, +1 );
-                        const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, Ii, Ij, Id, IL, +1 );
+                        const long long jump_E = jumps[ IL + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * shift_E_nonactive( indices, Id, Ii, Ij, +1 );
+                        const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, Ii, Ij, Id, IL, +1 );
                         const int size_ij = indices->getNOCC( Ii ) * indices->getNOCC( Ij );
                         #pragma omp parallel for schedule(static)
                         for ( int d = 0; d < nvir_d; d++ ){
-                           const int ptr_H = jump_H + size_ij * ( d + nvir_d * c );
-                           const int ptr_E = jump_E + SIZE * d;
+                           const long long ptr_H = jump_H + ( ( long long ) size_ij ) * ( d + nvir_d * c );
+                           const long long ptr_E = jump_E + SIZE * d;
                            matmat( 'N', SIZE, size_ij, 1,    2.0, workspace, SIZE, vector + ptr_H, 1,     result + ptr_E, LDA_E );
                            matmat( 'T', 1,    size_ij, SIZE, 2.0, workspace, SIZE, vector + ptr_E, LDA_E, result + ptr_H, 1     );
                         }
@@ -1732,6 +2465,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FEH triplet: < TE_xkdl E_wc TH_aibj > = 6 delta_ik delta_jl ( delta_ac delta_bd - delta_ad delta_bc ) / sqrt( 1 + delta_ab ) FEH[ Ix ][ w ][ x ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ixw == Ic == Iik x Ijl x Id
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       int SIZE = size_E[ IL ];
       const int nocc_w = indices->getNOCC( IL );
       const int nact_w = indices->getNDMRG( IL );
@@ -1758,13 +2492,13 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   for ( int Ii = 0; Ii < num_irreps; Ii++ ){
                      const int Ij = Irreps::directProd( Ii, Icenter );
                      if ( Ii < Ij ){
-                        const int jump_E = jump[ IL + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * shift_E_nonactive( indices, Id, Ii, Ij, -1 );
-                        const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, Ii, Ij, IL, Id, -1 );
+                        const long long jump_E = jumps[ IL + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * shift_E_nonactive( indices, Id, Ii, Ij, -1 );
+                        const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, Ii, Ij, IL, Id, -1 );
                         const int size_ij = indices->getNOCC( Ii ) * indices->getNOCC( Ij );
                         #pragma omp parallel for schedule(static)
                         for ( int d = 0; d < nvir_d; d++ ){
-                           const int ptr_H = jump_H + size_ij * ( c + nvir_w * d );
-                           const int ptr_E = jump_E + SIZE * d;
+                           const long long ptr_H = jump_H + ( ( long long ) size_ij ) * ( c + nvir_w * d );
+                           const long long ptr_E = jump_E + SIZE * d;
                            matmat( 'N', SIZE, size_ij, 1,    6.0, workspace, SIZE, vector + ptr_H, 1,     result + ptr_E, LDA_E );
                            matmat( 'T', 1,    size_ij, SIZE, 6.0, workspace, SIZE, vector + ptr_E, LDA_E, result + ptr_H, 1     );
                         }
@@ -1774,20 +2508,20 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
                if ( IL == Id ){ // Ic == Id == Ia == Ib --> Iik == Ijl
                   for ( int Iij = 0; Iij < num_irreps; Iij++ ){
-                     const int jump_E = jump[ IL + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * shift_E_nonactive( indices, Id,  Iij, Iij, -1 );
-                     const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, Iij, Iij, IL,  Id, -1 );
+                     const long long jump_E = jumps[ IL + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * shift_E_nonactive( indices, Id,  Iij, Iij, -1 );
+                     const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, Iij, Iij, IL,  Id, -1 );
                      const int size_ij = ( indices->getNOCC( Iij ) * ( indices->getNOCC( Iij ) - 1 ) ) / 2;
                      #pragma omp parallel for schedule(static)
                      for ( int d = 0; d < c; d++ ){
-                        const int ptr_H = jump_H + size_ij * ( d + ( c * ( c - 1 ) ) / 2 );
-                        const int ptr_E = jump_E + SIZE * d;
+                        const long long ptr_H = jump_H + ( ( long long ) size_ij ) * ( d + ( c * ( c - 1 ) ) / 2 );
+                        const long long ptr_E = jump_E + SIZE * d;
                         matmat( 'N', SIZE, size_ij, 1,    -6.0, workspace, SIZE, vector + ptr_H, 1,     result + ptr_E, LDA_E );
                         matmat( 'T', 1,    size_ij, SIZE, -6.0, workspace, SIZE, vector + ptr_E, LDA_E, result + ptr_H, 1     );
                      }
                      #pragma omp parallel for schedule(static)
                      for ( int d = c+1; d < nvir_d; d++ ){
-                        const int ptr_H = jump_H + size_ij * ( c + ( d * ( d - 1 ) ) / 2 );
-                        const int ptr_E = jump_E + SIZE * d;
+                        const long long ptr_H = jump_H + ( ( long long ) size_ij ) * ( c + ( d * ( d - 1 ) ) / 2 );
+                        const long long ptr_E = jump_E + SIZE * d;
                         matmat( 'N', SIZE, size_ij, 1,    6.0, workspace, SIZE, vector + ptr_H, 1,     result + ptr_E, LDA_E );
                         matmat( 'T', 1,    size_ij, SIZE, 6.0, workspace, SIZE, vector + ptr_E, LDA_E, result + ptr_H, 1     );
                      }
@@ -1798,13 +2532,13 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   for ( int Ii = 0; Ii < num_irreps; Ii++ ){
                      const int Ij = Irreps::directProd( Ii, Icenter );
                      if ( Ii < Ij ){
-                        const int jump_E = jump[ IL + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * shift_E_nonactive( indices, Id, Ii, Ij, -1 );
-                        const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, Ii, Ij, Id, IL, -1 );
+                        const long long jump_E = jumps[ IL + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * shift_E_nonactive( indices, Id, Ii, Ij, -1 );
+                        const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, Ii, Ij, Id, IL, -1 );
                         const int size_ij = indices->getNOCC( Ii ) * indices->getNOCC( Ij );
                         #pragma omp parallel for schedule(static)
                         for ( int d = 0; d < nvir_d; d++ ){
-                           const int ptr_H = jump_H + size_ij * ( d + nvir_d * c );
-                           const int ptr_E = jump_E + SIZE * d;
+                           const long long ptr_H = jump_H + ( ( long long ) size_ij ) * ( d + nvir_d * c );
+                           const long long ptr_E = jump_E + SIZE * d;
                            matmat( 'N', SIZE, size_ij, 1,    -6.0, workspace, SIZE, vector + ptr_H, 1,     result + ptr_E, LDA_E );
                            matmat( 'T', 1,    size_ij, SIZE, -6.0, workspace, SIZE, vector + ptr_E, LDA_E, result + ptr_H, 1     );
                         }
@@ -1818,6 +2552,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FGH singlet: < SG_cldx E_kw SH_aibj > = 2 delta_ac delta_bd ( delta_il delta_jk + delta_ik delta_jl ) / sqrt( 1 + delta_ij ) FGH[ Ix ][ w ][ x ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ixw == Ik == Iac x Ibd x Il
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       int SIZE = size_G[ IL ];
       const int nocc_w = indices->getNOCC( IL );
       const int nact_w = indices->getNDMRG( IL );
@@ -1843,8 +2578,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                      if ( Ia < Ib ){
                         const int colsize = nocc_l * indices->getNVIRT( Ia ) * indices->getNVIRT( Ib );
                         if ( colsize > 0 ){
-                           const int jump_G = jump[ IL + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * shift_G_nonactive( indices, Il, Ia, Ib, +1 );
-                           const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, IL, Il, Ia, Ib, +1 ) + k;
+                           const long long jump_G = jumps[ IL + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * shift_G_nonactive( indices, Il, Ia, Ib, +1 );
+                           const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, IL, Il, Ia, Ib, +1 ) + k;
                            matmat( 'N', SIZE, colsize, 1,    2.0, workspace, SIZE, vector + jump_H, nocc_w, result + jump_G, SIZE   );
                            matmat( 'T', 1,    colsize, SIZE, 2.0, workspace, SIZE, vector + jump_G, SIZE,   result + jump_H, nocc_w );
                         }
@@ -1854,22 +2589,22 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
                if ( IL == Il ){ // Ik == Il == Ii == Ij --> Iac == Ibd   and   nocc_l == nocc_w
                   for ( int Iab = 0; Iab < num_irreps; Iab++ ){
-                     const int jump_G = jump[ IL + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * shift_G_nonactive( indices, Il, Iab, Iab, +1 );
-                     const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, IL, Il, Iab, Iab, +1 );
+                     const long long jump_G = jumps[ IL + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * shift_G_nonactive( indices, Il, Iab, Iab, +1 );
+                     const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, IL, Il, Iab, Iab, +1 );
                      const int size_ij = ( nocc_w * ( nocc_w + 1 ) ) / 2;
                      const int size_ab = ( indices->getNVIRT( Iab ) * ( indices->getNVIRT( Iab ) + 1 ) ) / 2;
                      const int LDA_G = SIZE * nocc_l;
                      #pragma omp parallel for schedule(static)
                      for ( int l = 0; l < k; l++ ){
-                        const int ptr_H = jump_H + ( l + ( k * ( k + 1 ) ) / 2 );
-                        const int ptr_G = jump_G + SIZE * l;
+                        const long long ptr_H = jump_H + ( l + ( k * ( k + 1 ) ) / 2 );
+                        const long long ptr_G = jump_G + SIZE * l;
                         matmat( 'N', SIZE, size_ab, 1,    2.0, workspace, SIZE, vector + ptr_H, size_ij, result + ptr_G, LDA_G   );
                         matmat( 'T', 1,    size_ab, SIZE, 2.0, workspace, SIZE, vector + ptr_G, LDA_G,   result + ptr_H, size_ij );
                      }
                      #pragma omp parallel for schedule(static)
                      for ( int l = k; l < nocc_l; l++ ){
-                        const int ptr_H = jump_H + ( k + ( l * ( l + 1 ) ) / 2 );
-                        const int ptr_G = jump_G + SIZE * l;
+                        const long long ptr_H = jump_H + ( k + ( l * ( l + 1 ) ) / 2 );
+                        const long long ptr_G = jump_G + SIZE * l;
                         const double factor = 2 * (( k == l ) ? SQRT2 : 1.0 );
                         matmat( 'N', SIZE, size_ab, 1,    factor, workspace, SIZE, vector + ptr_H, size_ij, result + ptr_G, LDA_G   );
                         matmat( 'T', 1,    size_ab, SIZE, factor, workspace, SIZE, vector + ptr_G, LDA_G,   result + ptr_H, size_ij );
@@ -1881,13 +2616,13 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   for ( int Ia = 0; Ia < num_irreps; Ia++ ){
                      const int Ib = Irreps::directProd( Ia, Icenter );
                      if ( Ia < Ib ){
-                        const int jump_G = jump[ IL + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * shift_G_nonactive( indices, Il, Ia, Ib, +1 );
-                        const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, Il, IL, Ia, Ib, +1 );
+                        const long long jump_G = jumps[ IL + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * shift_G_nonactive( indices, Il, Ia, Ib, +1 );
+                        const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift_H_nonactive( indices, Il, IL, Ia, Ib, +1 );
                         const int size_ab = indices->getNVIRT( Ia ) * indices->getNVIRT( Ib );
                         #pragma omp parallel for schedule(static)
                         for ( int ab = 0; ab < size_ab; ab++ ){
-                           const int ptr_H = jump_H + nocc_l * ( k + nocc_w * ab );
-                           const int ptr_G = jump_G + SIZE * nocc_l * ab;
+                           const long long ptr_H = jump_H + ( ( long long ) nocc_l ) * ( k + nocc_w * ab );
+                           const long long ptr_G = jump_G + ( ( long long ) SIZE ) * nocc_l * ab;
                            matmat( 'N', SIZE, nocc_l, 1,    2.0, workspace, SIZE, vector + ptr_H, 1,    result + ptr_G, SIZE );
                            matmat( 'T', 1,    nocc_l, SIZE, 2.0, workspace, SIZE, vector + ptr_G, SIZE, result + ptr_H, 1    );
                         }
@@ -1901,6 +2636,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FGH triplet: < TG_cldx E_kw TH_aibj > = 6 delta_ac delta_bd ( delta_il delta_jk - delta_ik delta_jl ) / sqrt( 1 + delta_ij ) FGH[ Ix ][ w ][ x ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ixw == Ik == Iac x Ibd x Il
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       int SIZE = size_G[ IL ];
       const int nocc_w = indices->getNOCC( IL );
       const int nact_w = indices->getNDMRG( IL );
@@ -1926,8 +2662,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                      if ( Ia < Ib ){
                         const int colsize = nocc_l * indices->getNVIRT( Ia ) * indices->getNVIRT( Ib );
                         if ( colsize > 0 ){
-                           const int jump_G = jump[ IL + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * shift_G_nonactive( indices, Il, Ia, Ib, -1 );
-                           const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, IL, Il, Ia, Ib, -1 ) + k;
+                           const long long jump_G = jumps[ IL + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * shift_G_nonactive( indices, Il, Ia, Ib, -1 );
+                           const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, IL, Il, Ia, Ib, -1 ) + k;
                            matmat( 'N', SIZE, colsize, 1,    -6.0, workspace, SIZE, vector + jump_H, nocc_w, result + jump_G, SIZE   );
                            matmat( 'T', 1,    colsize, SIZE, -6.0, workspace, SIZE, vector + jump_G, SIZE,   result + jump_H, nocc_w );
                         }
@@ -1937,22 +2673,22 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
                if ( IL == Il ){ // Ik == Il == Ii == Ij --> Iac == Ibd   and   nocc_l == nocc_w
                   for ( int Iab = 0; Iab < num_irreps; Iab++ ){
-                     const int jump_G = jump[ IL + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * shift_G_nonactive( indices, Il, Iab, Iab, -1 );
-                     const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, IL, Il, Iab, Iab, -1 );
+                     const long long jump_G = jumps[ IL + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * shift_G_nonactive( indices, Il, Iab, Iab, -1 );
+                     const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, IL, Il, Iab, Iab, -1 );
                      const int size_ij = ( nocc_w * ( nocc_w - 1 ) ) / 2;
                      const int size_ab = ( indices->getNVIRT( Iab ) * ( indices->getNVIRT( Iab ) - 1 ) ) / 2;
                      const int LDA_G = SIZE * nocc_l;
                      #pragma omp parallel for schedule(static)
                      for ( int l = 0; l < k; l++ ){
-                        const int ptr_H = jump_H + ( l + ( k * ( k - 1 ) ) / 2 );
-                        const int ptr_G = jump_G + SIZE * l;
+                        const long long ptr_H = jump_H + ( l + ( k * ( k - 1 ) ) / 2 );
+                        const long long ptr_G = jump_G + SIZE * l;
                         matmat( 'N', SIZE, size_ab, 1,    6.0, workspace, SIZE, vector + ptr_H, size_ij, result + ptr_G, LDA_G   );
                         matmat( 'T', 1,    size_ab, SIZE, 6.0, workspace, SIZE, vector + ptr_G, LDA_G,   result + ptr_H, size_ij );
                      }
                      #pragma omp parallel for schedule(static)
                      for ( int l = k+1; l < nocc_l; l++ ){
-                        const int ptr_H = jump_H + ( k + ( l * ( l - 1 ) ) / 2 );
-                        const int ptr_G = jump_G + SIZE * l;
+                        const long long ptr_H = jump_H + ( k + ( l * ( l - 1 ) ) / 2 );
+                        const long long ptr_G = jump_G + SIZE * l;
                         matmat( 'N', SIZE, size_ab, 1,    -6.0, workspace, SIZE, vector + ptr_H, size_ij, result + ptr_G, LDA_G   );
                         matmat( 'T', 1,    size_ab, SIZE, -6.0, workspace, SIZE, vector + ptr_G, LDA_G,   result + ptr_H, size_ij );
                      }
@@ -1963,13 +2699,13 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   for ( int Ia = 0; Ia < num_irreps; Ia++ ){
                      const int Ib = Irreps::directProd( Ia, Icenter );
                      if ( Ia < Ib ){
-                        const int jump_G = jump[ IL + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * shift_G_nonactive( indices, Il, Ia, Ib, -1 );
-                        const int jump_H = jump[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, Il, IL, Ia, Ib, -1 );
+                        const long long jump_G = jumps[ IL + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * shift_G_nonactive( indices, Il, Ia, Ib, -1 );
+                        const long long jump_H = jumps[ Icenter + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift_H_nonactive( indices, Il, IL, Ia, Ib, -1 );
                         const int size_ab = indices->getNVIRT( Ia ) * indices->getNVIRT( Ib );
                         #pragma omp parallel for schedule(static)
                         for ( int ab = 0; ab < size_ab; ab++ ){
-                           const int ptr_H = jump_H + nocc_l * ( k + nocc_w * ab );
-                           const int ptr_G = jump_G + SIZE * nocc_l * ab;
+                           const long long ptr_H = jump_H + ( ( long long ) nocc_l ) * ( k + nocc_w * ab );
+                           const long long ptr_G = jump_G + ( ( long long ) SIZE ) * nocc_l * ab;
                            matmat( 'N', SIZE, nocc_l, 1,    6.0, workspace, SIZE, vector + ptr_H, 1,    result + ptr_G, SIZE );
                            matmat( 'T', 1,    nocc_l, SIZE, 6.0, workspace, SIZE, vector + ptr_G, SIZE, result + ptr_H, 1    );
                         }
@@ -1983,6 +2719,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FDE singlet: < D(blxy) E_kw SE_tiaj > = 1 delta_ab ( delta_ik delta_jl + delta_il delta_jk ) / sqrt( 1 + delta_ij ) FDE_singlet[ Ib x Il ][ It ][ w ][ xy, t ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ix x Iy == Ib x Il
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_D[ IL ];
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR = It = Ia x Ii x Ij
          const int SIZE_R = size_E[ IR ];
@@ -1990,7 +2727,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
          const int nocc_kw = indices->getNOCC( Ikw );
          const int nact_kw = indices->getNDMRG( Ikw );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nocc_kw * nact_kw > 0 ){
+         if (( total_size > 0 ) && ( nocc_kw > 0 ) && ( nact_kw > 0 )){
             for ( int k = 0; k < nocc_kw; k++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_kw; w++ ){
@@ -2003,15 +2740,15 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   const int Il = Irreps::directProd( Iab, IL );
                   const int nocc_l = indices->getNOCC( Il );
                   if ( nvir_ab * nocc_l > 0 ){
-                     const int jump_D = jump[ IL + num_irreps * CHEMPS2_CASPT2_D         ] + SIZE_L * shift_D_nonactive( indices, Il, Iab );
-                     const int jump_E = jump[ IR + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE_R * (( Ikw <= Il ) ? shift_E_nonactive( indices, Iab, Ikw, Il,  +1 )
+                     const long long jump_D = jumps[ IL + num_irreps * CHEMPS2_CASPT2_D         ] + SIZE_L * shift_D_nonactive( indices, Il, Iab );
+                     const long long jump_E = jumps[ IR + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE_R * (( Ikw <= Il ) ? shift_E_nonactive( indices, Iab, Ikw, Il,  +1 )
                                                                                                                      : shift_E_nonactive( indices, Iab, Il,  Ikw, +1 ));
                      if ( Ikw == Il ){ // irrep_k == irrep_l
                         #pragma omp parallel for schedule(static)
                         for ( int l = 0; l < nocc_l; l++ ){
                            const double factor = (( k == l ) ? SQRT2 : 1.0 );
-                           const int ptr_L = jump_D + SIZE_L * l;
-                           const int ptr_R = jump_E + SIZE_R * nvir_ab * (( k < l ) ? ( k + ( l * ( l + 1 ) ) / 2 ) : ( l + ( k * ( k + 1 ) ) / 2 ));
+                           const long long ptr_L = jump_D + SIZE_L * l;
+                           const long long ptr_R = jump_E + ( ( long long ) SIZE_R ) * nvir_ab * (( k < l ) ? ( k + ( l * ( l + 1 ) ) / 2 ) : ( l + ( k * ( k + 1 ) ) / 2 ));
                            const int LDA_L = SIZE_L * nocc_l;
                            matmat( 'N', SIZE_L, nvir_ab, SIZE_R, factor, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, LDA_L  );
                            matmat( 'T', SIZE_R, nvir_ab, SIZE_L, factor, workspace, SIZE_L, vector + ptr_L, LDA_L,  result + ptr_R, SIZE_R );
@@ -2019,8 +2756,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                      } else { // irrep_k != irrep_l
                         #pragma omp parallel for schedule(static)
                         for ( int l = 0; l < nocc_l; l++ ){
-                           const int ptr_L = jump_D + SIZE_L * l;
-                           const int ptr_R = jump_E + SIZE_R * nvir_ab * (( Ikw < Il ) ? ( k + nocc_kw * l ) : ( l + nocc_l * k ));
+                           const long long ptr_L = jump_D + SIZE_L * l;
+                           const long long ptr_R = jump_E + ( ( long long ) SIZE_R ) * nvir_ab * (( Ikw < Il ) ? ( k + nocc_kw * l ) : ( l + nocc_l * k ));
                            const int LDA_L = SIZE_L * nocc_l;
                            matmat( 'N', SIZE_L, nvir_ab, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, LDA_L  );
                            matmat( 'T', SIZE_R, nvir_ab, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, LDA_L,  result + ptr_R, SIZE_R );
@@ -2035,6 +2772,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FDE triplet: < D(blxy) E_kw TE_tiaj > = 3 delta_ab ( delta_ik delta_jl - delta_il delta_jk ) / sqrt( 1 + delta_ij ) FDE_triplet[ Ib x Il ][ It ][ w ][ xy, t ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ix x Iy == Ib x Il
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_D[ IL ];
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR = It = Ia x Ii x Ij
          const int SIZE_R = size_E[ IR ];
@@ -2042,7 +2780,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
          const int nocc_kw = indices->getNOCC( Ikw );
          const int nact_kw = indices->getNDMRG( Ikw );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nocc_kw * nact_kw > 0 ){
+         if (( total_size > 0 ) && ( nocc_kw > 0 ) && ( nact_kw > 0 )){
             for ( int k = 0; k < nocc_kw; k++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_kw; w++ ){
@@ -2055,22 +2793,22 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   const int Il = Irreps::directProd( Iab, IL );
                   const int nocc_l = indices->getNOCC( Il );
                   if ( nvir_ab * nocc_l > 0 ){
-                     const int jump_D = jump[ IL + num_irreps * CHEMPS2_CASPT2_D         ] + SIZE_L * shift_D_nonactive( indices, Il, Iab );
-                     const int jump_E = jump[ IR + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE_R * (( Ikw <= Il ) ? shift_E_nonactive( indices, Iab, Ikw, Il,  -1 )
+                     const long long jump_D = jumps[ IL + num_irreps * CHEMPS2_CASPT2_D         ] + SIZE_L * shift_D_nonactive( indices, Il, Iab );
+                     const long long jump_E = jumps[ IR + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE_R * (( Ikw <= Il ) ? shift_E_nonactive( indices, Iab, Ikw, Il,  -1 )
                                                                                                                      : shift_E_nonactive( indices, Iab, Il,  Ikw, -1 ));
                      if ( Ikw == Il ){ // irrep_k == irrep_l
                         #pragma omp parallel for schedule(static)
                         for ( int l = 0; l < k; l++ ){
-                           const int ptr_L = jump_D + SIZE_L * l;
-                           const int ptr_R = jump_E + SIZE_R * nvir_ab * ( l + ( k * ( k - 1 ) ) / 2 );
+                           const long long ptr_L = jump_D + SIZE_L * l;
+                           const long long ptr_R = jump_E + ( ( long long ) SIZE_R ) * nvir_ab * ( l + ( k * ( k - 1 ) ) / 2 );
                            const int LDA_L = SIZE_L * nocc_l;
                            matmat( 'N', SIZE_L, nvir_ab, SIZE_R, -3.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, LDA_L  );
                            matmat( 'T', SIZE_R, nvir_ab, SIZE_L, -3.0, workspace, SIZE_L, vector + ptr_L, LDA_L,  result + ptr_R, SIZE_R );
                         }
                         #pragma omp parallel for schedule(static)
                         for ( int l = k+1; l < nocc_l; l++ ){
-                           const int ptr_L = jump_D + SIZE_L * l;
-                           const int ptr_R = jump_E + SIZE_R * nvir_ab * ( k + ( l * ( l - 1 ) ) / 2 );
+                           const long long ptr_L = jump_D + SIZE_L * l;
+                           const long long ptr_R = jump_E + ( ( long long ) SIZE_R ) * nvir_ab * ( k + ( l * ( l - 1 ) ) / 2 );
                            const int LDA_L = SIZE_L * nocc_l;
                            matmat( 'N', SIZE_L, nvir_ab, SIZE_R, 3.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, LDA_L  );
                            matmat( 'T', SIZE_R, nvir_ab, SIZE_L, 3.0, workspace, SIZE_L, vector + ptr_L, LDA_L,  result + ptr_R, SIZE_R );
@@ -2079,8 +2817,8 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                         #pragma omp parallel for schedule(static)
                         for ( int l = 0; l < nocc_l; l++ ){
                            const double factor = (( Ikw < Il ) ? 3.0 : -3.0 );
-                           const int ptr_L = jump_D + SIZE_L * l;
-                           const int ptr_R = jump_E + SIZE_R * nvir_ab * (( Ikw < Il ) ? ( k + nocc_kw * l ) : ( l + nocc_l * k ));
+                           const long long ptr_L = jump_D + SIZE_L * l;
+                           const long long ptr_R = jump_E + ( ( long long ) SIZE_R ) * nvir_ab * (( Ikw < Il ) ? ( k + nocc_kw * l ) : ( l + nocc_l * k ));
                            const int LDA_L = SIZE_L * nocc_l;
                            matmat( 'N', SIZE_L, nvir_ab, SIZE_R, factor, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, LDA_L  );
                            matmat( 'T', SIZE_R, nvir_ab, SIZE_L, factor, workspace, SIZE_L, vector + ptr_L, LDA_L,  result + ptr_R, SIZE_R );
@@ -2095,6 +2833,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FDG singlet: < D(djxy) E_wc SG_aibt > = 1 delta_ij ( delta_ac delta_bd + delta_ad delta_bc ) / sqrt( 1 + delta_ab ) FDG_singlet[ Ij x Id ][ It ][ w ][ xy, t ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ix x Iy == Id x Ij
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_D[ IL ];
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR = It = Ia x Ib x Ii
          const int SIZE_R = size_E[ IR ];
@@ -2104,7 +2843,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
          const int n_oa_wc = nocc_wc + nact_wc;
          const int nvir_wc = indices->getNVIRT( Iwc );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nvir_wc * nact_wc > 0 ){
+         if (( total_size > 0 ) && ( nvir_wc > 0 ) && ( nact_wc > 0 )){
             for ( int c = 0; c < nvir_wc; c++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_wc; w++ ){
@@ -2117,21 +2856,21 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   const int Id = Irreps::directProd( Iij, IL );
                   const int nvir_d = indices->getNVIRT( Id );
                   if ( nvir_d * nocc_ij > 0 ){
-                     const int jump_D = jump[ IL + num_irreps * CHEMPS2_CASPT2_D ] + SIZE_L * shift_D_nonactive( indices, Iij, Id );
-                     const int jump_G = jump[ IR + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE_R * (( Iwc <= Id ) ? shift_G_nonactive( indices, Iij, Iwc, Id,  +1 )
+                     const long long jump_D = jumps[ IL + num_irreps * CHEMPS2_CASPT2_D ] + SIZE_L * shift_D_nonactive( indices, Iij, Id );
+                     const long long jump_G = jumps[ IR + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE_R * (( Iwc <= Id ) ? shift_G_nonactive( indices, Iij, Iwc, Id,  +1 )
                                                                                                                      : shift_G_nonactive( indices, Iij, Id,  Iwc, +1 ));
                      if ( Iwc == Id ){ // irrep_c == irrep_d
                         if ( c > 0 ){
-                           const int ptr_L = jump_D;
-                           const int ptr_R = jump_G + SIZE_R * nocc_ij * ( c * ( c + 1 ) ) / 2;
+                           const long long ptr_L = jump_D;
+                           const long long ptr_R = jump_G + ( ( long long ) SIZE_R ) * nocc_ij * ( c * ( c + 1 ) ) / 2;
                            matmat( 'N', SIZE_L, c * nocc_ij, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                            matmat( 'T', SIZE_R, c * nocc_ij, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                         }
                         #pragma omp parallel for schedule(static)
                         for ( int d = c; d < nvir_d; d++ ){
                            const double factor = (( c == d ) ? SQRT2 : 1.0 );
-                           const int ptr_L = jump_D + SIZE_L * nocc_ij * d;
-                           const int ptr_R = jump_G + SIZE_R * nocc_ij * ( c + ( d * ( d + 1 ) ) / 2 );
+                           const long long ptr_L = jump_D + ( ( long long ) SIZE_L ) * nocc_ij * d;
+                           const long long ptr_R = jump_G + ( ( long long ) SIZE_R ) * nocc_ij * ( c + ( d * ( d + 1 ) ) / 2 );
                            matmat( 'N', SIZE_L, nocc_ij, SIZE_R, factor, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                            matmat( 'T', SIZE_R, nocc_ij, SIZE_L, factor, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                         }
@@ -2139,14 +2878,14 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                         if ( Iwc < Id ){
                            #pragma omp parallel for schedule(static)
                            for ( int d = 0; d < nvir_d; d++ ){
-                              const int ptr_L = jump_D + SIZE_L * nocc_ij * d;
-                              const int ptr_R = jump_G + SIZE_R * nocc_ij * ( c + nvir_wc * d );
+                              const long long ptr_L = jump_D + ( ( long long ) SIZE_L ) * nocc_ij * d;
+                              const long long ptr_R = jump_G + ( ( long long ) SIZE_R ) * nocc_ij * ( c + nvir_wc * d );
                               matmat( 'N', SIZE_L, nocc_ij, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                               matmat( 'T', SIZE_R, nocc_ij, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                            }
                         } else {
-                           const int ptr_L = jump_D;
-                           const int ptr_R = jump_G + SIZE_R * nocc_ij * nvir_d * c;
+                           const long long ptr_L = jump_D;
+                           const long long ptr_R = jump_G + ( ( long long ) SIZE_R ) * nocc_ij * nvir_d * c;
                            matmat( 'N', SIZE_L, nvir_d * nocc_ij, SIZE_R, 1.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                            matmat( 'T', SIZE_R, nvir_d * nocc_ij, SIZE_L, 1.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                         }
@@ -2160,6 +2899,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
    // FDG triplet: < D(djxy) E_wc TG_aibt > = 3 delta_ij ( delta_ac delta_bd - delta_ad delta_bc ) / sqrt( 1 + delta_ab ) FDG_triplet[ Ij x Id ][ It ][ w ][ xy, t ]
    for ( int IL = 0; IL < num_irreps; IL++ ){ // IL == Ix x Iy == Id x Ij
+      if ( skip_unit( work_unit++, distributed ) ){ continue; }
       const int SIZE_L = size_D[ IL ];
       for ( int IR = 0; IR < num_irreps; IR++ ){ // IR = It = Ia x Ib x Ii
          const int SIZE_R = size_E[ IR ];
@@ -2169,7 +2909,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
          const int n_oa_wc = nocc_wc + nact_wc;
          const int nvir_wc = indices->getNVIRT( Iwc );
          int total_size = SIZE_L * SIZE_R;
-         if ( total_size * nvir_wc * nact_wc > 0 ){
+         if (( total_size > 0 ) && ( nvir_wc > 0 ) && ( nact_wc > 0 )){
             for ( int c = 0; c < nvir_wc; c++ ){
                for ( int cnt = 0; cnt < total_size; cnt++ ){ workspace[ cnt ] = 0.0; }
                for ( int w = 0; w < nact_wc; w++ ){
@@ -2182,20 +2922,20 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                   const int Id = Irreps::directProd( Iij, IL );
                   const int nvir_d = indices->getNVIRT( Id );
                   if ( nvir_d * nocc_ij > 0 ){
-                     const int jump_D = jump[ IL + num_irreps * CHEMPS2_CASPT2_D ] + SIZE_L * shift_D_nonactive( indices, Iij, Id );
-                     const int jump_G = jump[ IR + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE_R * (( Iwc <= Id ) ? shift_G_nonactive( indices, Iij, Iwc, Id,  -1 )
+                     const long long jump_D = jumps[ IL + num_irreps * CHEMPS2_CASPT2_D ] + SIZE_L * shift_D_nonactive( indices, Iij, Id );
+                     const long long jump_G = jumps[ IR + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE_R * (( Iwc <= Id ) ? shift_G_nonactive( indices, Iij, Iwc, Id,  -1 )
                                                                                                                      : shift_G_nonactive( indices, Iij, Id,  Iwc, -1 ));
                      if ( Iwc == Id ){ // irrep_c == irrep_d
                         if ( c > 0 ){
-                           const int ptr_L = jump_D;
-                           const int ptr_R = jump_G + SIZE_R * nocc_ij * ( c * ( c - 1 ) ) / 2;
+                           const long long ptr_L = jump_D;
+                           const long long ptr_R = jump_G + ( ( long long ) SIZE_R ) * nocc_ij * ( c * ( c - 1 ) ) / 2;
                            matmat( 'N', SIZE_L, c * nocc_ij, SIZE_R, -3.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                            matmat( 'T', SIZE_R, c * nocc_ij, SIZE_L, -3.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                         }
                         #pragma omp parallel for schedule(static)
                         for ( int d = c+1; d < nvir_d; d++ ){
-                           const int ptr_L = jump_D + SIZE_L * nocc_ij * d;
-                           const int ptr_R = jump_G + SIZE_R * nocc_ij * ( c + ( d * ( d - 1 ) ) / 2 );
+                           const long long ptr_L = jump_D + ( ( long long ) SIZE_L ) * nocc_ij * d;
+                           const long long ptr_R = jump_G + ( ( long long ) SIZE_R ) * nocc_ij * ( c + ( d * ( d - 1 ) ) / 2 );
                            matmat( 'N', SIZE_L, nocc_ij, SIZE_R, 3.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                            matmat( 'T', SIZE_R, nocc_ij, SIZE_L, 3.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                         }
@@ -2203,14 +2943,14 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
                         if ( Iwc < Id ){
                            #pragma omp parallel for schedule(static)
                            for ( int d = 0; d < nvir_d; d++ ){
-                              const int ptr_L = jump_D + SIZE_L * nocc_ij * d;
-                              const int ptr_R = jump_G + SIZE_R * nocc_ij * ( c + nvir_wc * d );
+                              const long long ptr_L = jump_D + ( ( long long ) SIZE_L ) * nocc_ij * d;
+                              const long long ptr_R = jump_G + ( ( long long ) SIZE_R ) * nocc_ij * ( c + nvir_wc * d );
                               matmat( 'N', SIZE_L, nocc_ij, SIZE_R, 3.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                               matmat( 'T', SIZE_R, nocc_ij, SIZE_L, 3.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                            }
                         } else {
-                           const int ptr_L = jump_D;
-                           const int ptr_R = jump_G + SIZE_R * nocc_ij * nvir_d * c;
+                           const long long ptr_L = jump_D;
+                           const long long ptr_R = jump_G + ( ( long long ) SIZE_R ) * nocc_ij * nvir_d * c;
                            matmat( 'N', SIZE_L, nvir_d * nocc_ij, SIZE_R, -3.0, workspace, SIZE_L, vector + ptr_R, SIZE_R, result + ptr_L, SIZE_L );
                            matmat( 'T', SIZE_R, nvir_d * nocc_ij, SIZE_L, -3.0, workspace, SIZE_L, vector + ptr_L, SIZE_L, result + ptr_R, SIZE_R );
                         }
@@ -2226,7 +2966,7 @@ void CheMPS2::CASPT2::matvec( double * vector, double * result, double * diag_fo
 
 }
 
-int CheMPS2::CASPT2::shift_H_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_j, const int irrep_a, const int irrep_b, const int ST ){
+long long CheMPS2::CASPT2::shift_H_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_j, const int irrep_a, const int irrep_b, const int ST ){
 
    assert( irrep_i <= irrep_j );
    assert( irrep_a <= irrep_b );
@@ -2235,7 +2975,7 @@ int CheMPS2::CASPT2::shift_H_nonactive( const DMRGSCFindices * idx, const int ir
    assert( irrep_prod == irrep_virt );
    const int n_irreps = idx->getNirreps();
 
-   int shift = 0;
+   long long shift = 0;
    if ( irrep_prod == 0 ){
       for ( int Iij = 0; Iij < n_irreps; Iij++ ){
          for ( int Iab = 0; Iab < n_irreps; Iab++ ){
@@ -2243,7 +2983,7 @@ int CheMPS2::CASPT2::shift_H_nonactive( const DMRGSCFindices * idx, const int ir
                Iij = n_irreps;
                Iab = n_irreps;
             } else {
-               shift += ( idx->getNOCC( Iij ) * ( idx->getNOCC( Iij ) + ST ) * idx->getNVIRT( Iab ) * ( idx->getNVIRT( Iab ) + ST ) ) / 4;
+               shift += ( ( ( long long ) idx->getNOCC( Iij ) ) * ( idx->getNOCC( Iij ) + ST ) * idx->getNVIRT( Iab ) * ( idx->getNVIRT( Iab ) + ST ) ) / 4;
             }
          }
       }
@@ -2258,7 +2998,7 @@ int CheMPS2::CASPT2::shift_H_nonactive( const DMRGSCFindices * idx, const int ir
                      Ii = n_irreps;
                      Ia = n_irreps;
                   } else {
-                     shift += idx->getNOCC( Ii ) * idx->getNOCC( Ij ) * idx->getNVIRT( Ia ) * idx->getNVIRT( Ib );
+                     shift += ( ( long long ) idx->getNOCC( Ii ) ) * idx->getNOCC( Ij ) * idx->getNVIRT( Ia ) * idx->getNVIRT( Ib );
                   }
                }
             }
@@ -2269,14 +3009,14 @@ int CheMPS2::CASPT2::shift_H_nonactive( const DMRGSCFindices * idx, const int ir
 
 }
 
-int CheMPS2::CASPT2::shift_G_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_a, const int irrep_b, const int ST ){
+long long CheMPS2::CASPT2::shift_G_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_a, const int irrep_b, const int ST ){
 
    assert( irrep_a <= irrep_b );
    const int irrep_virt = Irreps::directProd( irrep_a,    irrep_b );
    const int irrep_prod = Irreps::directProd( irrep_virt, irrep_i );
    const int n_irreps = idx->getNirreps();
 
-   int shift = 0;
+   long long shift = 0;
    for ( int Ii = 0; Ii < n_irreps; Ii++ ){
       const int Ivirt = Irreps::directProd( Ii, irrep_prod );
       if ( Ivirt == 0 ){
@@ -2285,7 +3025,7 @@ int CheMPS2::CASPT2::shift_G_nonactive( const DMRGSCFindices * idx, const int ir
                Ii  = n_irreps;
                Iab = n_irreps;
             } else {
-               shift += ( idx->getNOCC( Ii ) * idx->getNVIRT( Iab ) * ( idx->getNVIRT( Iab ) + ST ) ) / 2;
+               shift += ( ( ( long long ) idx->getNOCC( Ii ) ) * idx->getNVIRT( Iab ) * ( idx->getNVIRT( Iab ) + ST ) ) / 2;
             }
          }
       } else {
@@ -2296,7 +3036,7 @@ int CheMPS2::CASPT2::shift_G_nonactive( const DMRGSCFindices * idx, const int ir
                   Ii = n_irreps;
                   Ia = n_irreps;
                } else {
-                  shift += idx->getNOCC( Ii ) * idx->getNVIRT( Ia ) * idx->getNVIRT( Ib );
+                  shift += ( ( long long ) idx->getNOCC( Ii ) ) * idx->getNVIRT( Ia ) * idx->getNVIRT( Ib );
                }
             }
          }
@@ -2306,14 +3046,14 @@ int CheMPS2::CASPT2::shift_G_nonactive( const DMRGSCFindices * idx, const int ir
 
 }
 
-int CheMPS2::CASPT2::shift_E_nonactive( const DMRGSCFindices * idx, const int irrep_a, const int irrep_i, const int irrep_j, const int ST ){
+long long CheMPS2::CASPT2::shift_E_nonactive( const DMRGSCFindices * idx, const int irrep_a, const int irrep_i, const int irrep_j, const int ST ){
 
    assert( irrep_i <= irrep_j );
    const int irrep_occ  = Irreps::directProd( irrep_i,   irrep_j );
    const int irrep_prod = Irreps::directProd( irrep_occ, irrep_a );
    const int n_irreps = idx->getNirreps();
 
-   int shift = 0;
+   long long shift = 0;
    for ( int Ia = 0; Ia < n_irreps; Ia++ ){
       const int Iocc = Irreps::directProd( Ia, irrep_prod );
       if ( Iocc == 0 ){
@@ -2322,7 +3062,7 @@ int CheMPS2::CASPT2::shift_E_nonactive( const DMRGSCFindices * idx, const int ir
                Ia  = n_irreps;
                Iij = n_irreps;
             } else {
-               shift += ( idx->getNVIRT( Ia ) * idx->getNOCC( Iij ) * ( idx->getNOCC( Iij ) + ST ) ) / 2;
+               shift += ( ( ( long long ) idx->getNVIRT( Ia ) ) * idx->getNOCC( Iij ) * ( idx->getNOCC( Iij ) + ST ) ) / 2;
             }
          }
       } else {
@@ -2333,7 +3073,7 @@ int CheMPS2::CASPT2::shift_E_nonactive( const DMRGSCFindices * idx, const int ir
                   Ia = n_irreps;
                   Ii = n_irreps;
                } else {
-                  shift += idx->getNVIRT( Ia ) * idx->getNOCC( Ii ) * idx->getNOCC( Ij );
+                  shift += ( ( long long ) idx->getNVIRT( Ia ) ) * idx->getNOCC( Ii ) * idx->getNOCC( Ij );
                }
             }
          }
@@ -2343,13 +3083,13 @@ int CheMPS2::CASPT2::shift_E_nonactive( const DMRGSCFindices * idx, const int ir
 
 }
 
-int CheMPS2::CASPT2::shift_F_nonactive( const DMRGSCFindices * idx, const int irrep_a, const int irrep_b, const int ST ){
+long long CheMPS2::CASPT2::shift_F_nonactive( const DMRGSCFindices * idx, const int irrep_a, const int irrep_b, const int ST ){
 
    assert( irrep_a <= irrep_b );
    const int irr_prod = Irreps::directProd( irrep_a, irrep_b );
    const int n_irreps = idx->getNirreps();
 
-   int shift = 0;
+   long long shift = 0;
    if ( irr_prod == 0 ){
       for ( int Iab = 0; Iab < n_irreps; Iab++ ){
          if (( irrep_a == Iab ) && ( irrep_b == Iab )){
@@ -2374,13 +3114,13 @@ int CheMPS2::CASPT2::shift_F_nonactive( const DMRGSCFindices * idx, const int ir
 
 }
 
-int CheMPS2::CASPT2::shift_B_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_j, const int ST ){
+long long CheMPS2::CASPT2::shift_B_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_j, const int ST ){
 
    assert( irrep_i <= irrep_j );
    const int irr_prod = Irreps::directProd( irrep_i, irrep_j );
    const int n_irreps = idx->getNirreps();
 
-   int shift = 0;
+   long long shift = 0;
    if ( irr_prod == 0 ){
       for ( int Iij = 0; Iij < n_irreps; Iij++ ){
          if (( Iij == irrep_i ) && ( Iij == irrep_j )){
@@ -2405,12 +3145,12 @@ int CheMPS2::CASPT2::shift_B_nonactive( const DMRGSCFindices * idx, const int ir
 
 }
 
-int CheMPS2::CASPT2::shift_D_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_a ){
+long long CheMPS2::CASPT2::shift_D_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_a ){
 
    const int irrep_ia = Irreps::directProd( irrep_i, irrep_a );
    const int n_irreps = idx->getNirreps();
    
-   int shift = 0;
+   long long shift = 0;
    for ( int Ii = 0; Ii < n_irreps; Ii++ ){
       const int Ia = Irreps::directProd( irrep_ia, Ii );
       if (( Ii == irrep_i ) && ( Ia == irrep_a )){
@@ -2423,7 +3163,10 @@ int CheMPS2::CASPT2::shift_D_nonactive( const DMRGSCFindices * idx, const int ir
 
 }
 
-void CheMPS2::CASPT2::diagonal( double * result ) const{
+void CheMPS2::CASPT2::diagonal( double * result, const long long * offsets ) const{
+
+   // With offsets, the blocks which are not in the segment are empty and skipped
+   const long long * jumps = (( offsets == NULL ) ? jump : offsets );
 
    #pragma omp parallel
    {
@@ -2431,12 +3174,12 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FAA: < E_zy E_jx | F | E_ti E_uv > = delta_ij * ( FAA[ Ii ][ xyztuv ] + ( 2 sum_k f_kk - f_ii ) SAA[ Ii ][ xyztuv ] )
       for ( int irrep = 0; irrep < num_irreps; irrep++ ){
          const int SIZE = size_A[ irrep ];
-         if ( SIZE > 0 ){
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_A + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_A ] )){
             const int NOCC = indices->getNOCC( irrep );
             #pragma omp for schedule(static)
             for ( int count = 0; count < NOCC; count++ ){
                const double beta = - f_dot_1dm - fock->get( irrep, count, count );
-               double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_A ] + SIZE * count;
+               double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_A ] + SIZE * count;
                #pragma omp simd
                for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = FAA[ irrep ][ elem ] + beta; }
             }
@@ -2446,13 +3189,13 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FCC: < E_zy E_xb | F | E_at E_uv > = delta_ab * ( FCC[ Ia ][ xyztuv ] + ( 2 sum_k f_kk + f_aa ) SCC[ Ia ][ xyztuv ] )
       for ( int irrep = 0; irrep < num_irreps; irrep++ ){
          const int SIZE = size_C[ irrep ];
-         if ( SIZE > 0 ){
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_C + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_C ] )){
             const int NVIR = indices->getNVIRT( irrep );
             const int N_OA = indices->getNOCC( irrep ) + indices->getNDMRG( irrep );
             #pragma omp for schedule(static)
             for ( int count = 0; count < NVIR; count++ ){
                const double beta = - f_dot_1dm + fock->get( irrep, N_OA + count, N_OA + count );
-               double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_C ] + SIZE * count;
+               double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_C ] + SIZE * count;
                #pragma omp simd
                for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = FCC[ irrep ][ elem ] + beta; }
             }
@@ -2462,8 +3205,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FDD: < E_yx E_jb | F | E_ai E_tu > = delta_ab delta_ij ( FDD[ xytu] + ( 2 sum_k f_kk + f_aa - f_ii ) SDD[ xytu ] )
       for ( int irrep = 0; irrep < num_irreps; irrep++ ){
          const int SIZE = size_D[ irrep ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_D + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_D ] )){
+            long long shift = 0;
             for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
                const int irrep_a = Irreps::directProd( irrep_i, irrep );
                const int NOCC_i  = indices->getNOCC( irrep_i );
@@ -2476,7 +3219,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                   const double f_ii = fock->get( irrep_i, i, i );
                   const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                   const double beta = - f_dot_1dm + f_aa - f_ii;
-                  double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_D ] + SIZE * ( shift + combined );
+                  double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_D ] + SIZE * ( shift + combined );
                   #pragma omp simd
                   for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = FDD[ irrep ][ elem ] + beta; }
                }
@@ -2490,8 +3233,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FBB singlet: < SB_xkyl | F | SB_tiuj > = 2 delta_ik delta_jl ( FBB_singlet[ Iij ][ xytu ] + ( 2 sum_n f_nn - f_ii - f_jj ) * SBB_singlet[ Iij ][ xytu ] )
       {
          const int SIZE = size_B_singlet[ 0 ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ num_irreps * CHEMPS2_CASPT2_B_SINGLET + 1 ] > jumps[ num_irreps * CHEMPS2_CASPT2_B_SINGLET ] )){
+            long long shift = 0;
             for ( int irrep_ij = 0; irrep_ij < num_irreps; irrep_ij++ ){
                const int nocc_ij = indices->getNOCC( irrep_ij );
                const int size_ij = ( nocc_ij * ( nocc_ij + 1 ) ) / 2;
@@ -2503,7 +3246,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                   const double f_ii = fock->get( irrep_ij, i, i );
                   const double f_jj = fock->get( irrep_ij, j, j );
                   const double beta = - f_dot_1dm - f_ii - f_jj;
-                  double * target = result + jump[ num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE * ( shift + combined );
+                  double * target = result + jumps[ num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE * ( shift + combined );
                   #pragma omp simd
                   for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FBB_singlet[ 0 ][ elem ] + beta ); }
                }
@@ -2513,8 +3256,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       }
       for ( int irrep = 1; irrep < num_irreps; irrep++ ){
          const int SIZE = size_B_singlet[ irrep ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_B_SINGLET + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] )){
+            long long shift = 0;
             for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
                const int irrep_j = Irreps::directProd( irrep, irrep_i );
                if ( irrep_i < irrep_j ){
@@ -2527,7 +3270,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                      const double f_ii = fock->get( irrep_i, i, i );
                      const double f_jj = fock->get( irrep_j, j, j );
                      const double beta = - f_dot_1dm - f_ii - f_jj;
-                     double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE * ( shift + combined );
+                     double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] + SIZE * ( shift + combined );
                      #pragma omp simd
                      for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FBB_singlet[ irrep ][ elem ] + beta ); }
                   }
@@ -2540,8 +3283,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FBB triplet: < TB_xkyl | F | TB_tiuj > = 2 delta_ik delta_jl ( FBB_triplet[ Iij ][ xytu ] + ( 2 sum_n f_nn - f_ii - f_jj ) * SBB_triplet[ Iij ][ xytu ] )
       {
          const int SIZE = size_B_triplet[ 0 ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ num_irreps * CHEMPS2_CASPT2_B_TRIPLET + 1 ] > jumps[ num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] )){
+            long long shift = 0;
             for ( int irrep_ij = 0; irrep_ij < num_irreps; irrep_ij++ ){
                const int nocc_ij = indices->getNOCC( irrep_ij );
                const int size_ij = ( nocc_ij * ( nocc_ij - 1 ) ) / 2;
@@ -2553,7 +3296,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                   const double f_ii = fock->get( irrep_ij, i, i );
                   const double f_jj = fock->get( irrep_ij, j, j );
                   const double beta = - f_dot_1dm - f_ii - f_jj;
-                  double * target = result + jump[ num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE * ( shift + combined );
+                  double * target = result + jumps[ num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE * ( shift + combined );
                   #pragma omp simd
                   for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FBB_triplet[ 0 ][ elem ] + beta ); }
                }
@@ -2563,8 +3306,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       }
       for ( int irrep = 1; irrep < num_irreps; irrep++ ){
          const int SIZE = size_B_triplet[ irrep ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_B_TRIPLET + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] )){
+            long long shift = 0;
             for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
                const int irrep_j = Irreps::directProd( irrep, irrep_i );
                if ( irrep_i < irrep_j ){
@@ -2577,7 +3320,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                      const double f_ii = fock->get( irrep_i, i, i );
                      const double f_jj = fock->get( irrep_j, j, j );
                      const double beta = - f_dot_1dm - f_ii - f_jj;
-                     double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE * ( shift + combined );
+                     double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_B_TRIPLET ] + SIZE * ( shift + combined );
                      #pragma omp simd
                      for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FBB_triplet[ irrep ][ elem ] + beta ); }
                   }
@@ -2590,8 +3333,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FFF singlet: < SF_cxdy | F | SF_atbu > = 2 delta_ac delta_bd ( FFF_singlet[ Iab ][ xytu ] + ( 2 sum_n f_nn + f_aa + f_bb ) * SFF_singlet[ Iab ][ xytu ] )
       {
          const int SIZE = size_F_singlet[ 0 ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ num_irreps * CHEMPS2_CASPT2_F_SINGLET + 1 ] > jumps[ num_irreps * CHEMPS2_CASPT2_F_SINGLET ] )){
+            long long shift = 0;
             for ( int irrep_ab = 0; irrep_ab < num_irreps; irrep_ab++ ){
                const int NVIR_ab = indices->getNVIRT( irrep_ab );
                const int N_OA_ab = indices->getNOCC( irrep_ab ) + indices->getNDMRG( irrep_ab );
@@ -2604,7 +3347,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                   const double f_aa = fock->get( irrep_ab, N_OA_ab + a, N_OA_ab + a );
                   const double f_bb = fock->get( irrep_ab, N_OA_ab + b, N_OA_ab + b );
                   const double beta = - f_dot_1dm + f_aa + f_bb;
-                  double * target = result + jump[ num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE * ( shift + combined );
+                  double * target = result + jumps[ num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE * ( shift + combined );
                   #pragma omp simd
                   for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FFF_singlet[ 0 ][ elem ] + beta ); }
                }
@@ -2614,8 +3357,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       }
       for ( int irrep = 1; irrep < num_irreps; irrep++ ){
          const int SIZE = size_F_singlet[ irrep ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_F_SINGLET + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] )){
+            long long shift = 0;
             for ( int irrep_a = 0; irrep_a < num_irreps; irrep_a++ ){
                const int irrep_b = Irreps::directProd( irrep, irrep_a );
                if ( irrep_a < irrep_b ){
@@ -2630,7 +3373,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                      const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                      const double f_bb = fock->get( irrep_b, N_OA_b + b, N_OA_b + b );
                      const double beta = - f_dot_1dm + f_aa + f_bb;
-                     double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE * ( shift + combined );
+                     double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] + SIZE * ( shift + combined );
                      #pragma omp simd
                      for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FFF_singlet[ irrep ][ elem ] + beta ); }
                   }
@@ -2643,8 +3386,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FFF triplet: < TF_cxdy | F | TF_atbu > = 2 delta_ac delta_bd ( FFF_triplet[ Iab ][ xytu ] + ( 2 sum_n f_nn + f_aa + f_bb ) * SFF_triplet[ Iab ][ xytu ] )
       {
          const int SIZE = size_F_triplet[ 0 ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ num_irreps * CHEMPS2_CASPT2_F_TRIPLET + 1 ] > jumps[ num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] )){
+            long long shift = 0;
             for ( int irrep_ab = 0; irrep_ab < num_irreps; irrep_ab++ ){
                const int NVIR_ab = indices->getNVIRT( irrep_ab );
                const int N_OA_ab = indices->getNOCC( irrep_ab ) + indices->getNDMRG( irrep_ab );
@@ -2657,7 +3400,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                   const double f_aa = fock->get( irrep_ab, N_OA_ab + a, N_OA_ab + a );
                   const double f_bb = fock->get( irrep_ab, N_OA_ab + b, N_OA_ab + b );
                   const double beta = - f_dot_1dm + f_aa + f_bb;
-                  double * target = result + jump[ num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE * ( shift + combined );
+                  double * target = result + jumps[ num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE * ( shift + combined );
                   #pragma omp simd
                   for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FFF_triplet[ 0 ][ elem ] + beta ); }
                }
@@ -2667,8 +3410,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       }
       for ( int irrep = 1; irrep < num_irreps; irrep++ ){
          const int SIZE = size_F_triplet[ irrep ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_F_TRIPLET + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] )){
+            long long shift = 0;
             for ( int irrep_a = 0; irrep_a < num_irreps; irrep_a++ ){
                const int irrep_b = Irreps::directProd( irrep, irrep_a );
                if ( irrep_a < irrep_b ){
@@ -2683,7 +3426,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                      const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                      const double f_bb = fock->get( irrep_b, N_OA_b + b, N_OA_b + b );
                      const double beta = - f_dot_1dm + f_aa + f_bb;
-                     double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE * ( shift + combined );
+                     double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_F_TRIPLET ] + SIZE * ( shift + combined );
                      #pragma omp simd
                      for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FFF_triplet[ irrep ][ elem ] + beta ); }
                   }
@@ -2696,8 +3439,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FEE singlet: < SE_ukbl | F | SE_tiaj > = 2 delta_ab delta_ik delta_jl ( FEE[ It ][ ut ] + ( 2 sum_k f_kk + f_aa - f_ii - f_jj ) SEE[ It ][ ut ] )
       for ( int irrep = 0; irrep < num_irreps; irrep++ ){
          const int SIZE = size_E[ irrep ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_E_SINGLET + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] )){
+            long long shift = 0;
             for ( int irrep_a = 0; irrep_a < num_irreps; irrep_a++ ){
                const int NVIR_a = indices->getNVIRT( irrep_a );
                const int N_OA_a = indices->getNOCC( irrep_a ) + indices->getNDMRG( irrep_a );
@@ -2717,7 +3460,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                         const double f_jj = fock->get( irrep_j, j, j );
                         const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                         const double beta = - f_dot_1dm + f_aa - f_ii - f_jj;
-                        double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * ( shift + combined );
+                        double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * ( shift + combined );
                         #pragma omp simd
                         for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FEE[ irrep ][ elem ] + beta ); }
                      }
@@ -2735,7 +3478,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                         const double f_jj = fock->get( irrep_j, j, j );
                         const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                         const double beta = - f_dot_1dm + f_aa - f_ii - f_jj;
-                        double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * ( shift + combined );
+                        double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_E_SINGLET ] + SIZE * ( shift + combined );
                         #pragma omp simd
                         for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FEE[ irrep ][ elem ] + beta ); }
                      }
@@ -2749,8 +3492,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FEE triplet: < TE_ukbl | F | TE_tiaj > = 6 delta_ab delta_ik delta_jl ( FEE[ It ][ ut ] + ( 2 sum_k f_kk + f_aa - f_ii - f_jj ) SEE[ It ][ ut ] )
       for ( int irrep = 0; irrep < num_irreps; irrep++ ){
          const int SIZE = size_E[ irrep ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_E_TRIPLET + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] )){
+            long long shift = 0;
             for ( int irrep_a = 0; irrep_a < num_irreps; irrep_a++ ){
                const int NVIR_a = indices->getNVIRT( irrep_a );
                const int N_OA_a = indices->getNOCC( irrep_a ) + indices->getNDMRG( irrep_a );
@@ -2770,7 +3513,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                         const double f_jj = fock->get( irrep_j, j, j );
                         const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                         const double beta = - f_dot_1dm + f_aa - f_ii - f_jj;
-                        double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * ( shift + combined );
+                        double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * ( shift + combined );
                         #pragma omp simd
                         for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 6 * ( FEE[ irrep ][ elem ] + beta ); }
                      }
@@ -2788,7 +3531,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                         const double f_jj = fock->get( irrep_j, j, j );
                         const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                         const double beta = - f_dot_1dm + f_aa - f_ii - f_jj;
-                        double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * ( shift + combined );
+                        double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ] + SIZE * ( shift + combined );
                         #pragma omp simd
                         for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 6 * ( FEE[ irrep ][ elem ] + beta ); }
                      }
@@ -2802,8 +3545,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FGG singlet: < SG_cjdu | F | SG_aibt > = 2 delta_ij delta_ac delta_bd ( FGG[ It ][ ut ] + ( 2 sum_k f_kk + f_aa + f_bb - f_ii ) SGG[ It ][ ut ] )
       for ( int irrep = 0; irrep < num_irreps; irrep++ ){
          const int SIZE = size_G[ irrep ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_G_SINGLET + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] )){
+            long long shift = 0;
             for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
                const int NOCC_i = indices->getNOCC( irrep_i );
                const int irrep_vir = Irreps::directProd( irrep_i, irrep );
@@ -2823,7 +3566,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                         const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                         const double f_bb = fock->get( irrep_b, N_OA_a + b, N_OA_a + b );
                         const double beta = - f_dot_1dm + f_aa + f_bb - f_ii;
-                        double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * ( shift + combined );
+                        double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * ( shift + combined );
                         #pragma omp simd
                         for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FGG[ irrep ][ elem ] + beta ); }
                      }
@@ -2842,7 +3585,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                         const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                         const double f_bb = fock->get( irrep_b, N_OA_b + b, N_OA_b + b );
                         const double beta = - f_dot_1dm + f_aa + f_bb - f_ii;
-                        double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * ( shift + combined );
+                        double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_G_SINGLET ] + SIZE * ( shift + combined );
                         #pragma omp simd
                         for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 2 * ( FGG[ irrep ][ elem ] + beta ); }
                      }
@@ -2856,8 +3599,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       // FGG triplet: < TG_cjdu | F | TG_aibt > = 6 delta_ij delta_ac delta_bd ( FGG[ It ][ ut ] + ( 2 sum_k f_kk + f_aa + f_bb - f_ii ) SGG[ It ][ ut ] )
       for ( int irrep = 0; irrep < num_irreps; irrep++ ){
          const int SIZE = size_G[ irrep ];
-         if ( SIZE > 0 ){
-            int shift = 0;
+         if (( SIZE > 0 ) && ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_G_TRIPLET + 1 ] > jumps[ irrep + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] )){
+            long long shift = 0;
             for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
                const int NOCC_i = indices->getNOCC( irrep_i );
                const int irrep_vir = Irreps::directProd( irrep_i, irrep );
@@ -2877,7 +3620,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                         const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                         const double f_bb = fock->get( irrep_b, N_OA_a + b, N_OA_a + b );
                         const double beta = - f_dot_1dm + f_aa + f_bb - f_ii;
-                        double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * ( shift + combined );
+                        double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * ( shift + combined );
                         #pragma omp simd
                         for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 6 * ( FGG[ irrep ][ elem ] + beta ); }
                      }
@@ -2896,7 +3639,7 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                         const double f_aa = fock->get( irrep_a, N_OA_a + a, N_OA_a + a );
                         const double f_bb = fock->get( irrep_b, N_OA_b + b, N_OA_b + b );
                         const double beta = - f_dot_1dm + f_aa + f_bb - f_ii;
-                        double * target = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * ( shift + combined );
+                        double * target = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ] + SIZE * ( shift + combined );
                         #pragma omp simd
                         for ( int elem = 0; elem < SIZE; elem++ ){ target[ elem ] = 6 * ( FGG[ irrep ][ elem ] + beta ); }
                      }
@@ -2908,18 +3651,18 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
       }
 
       // FHH singlet and triplet
-      {
-         int shift = 0;
+      if ( jumps[ num_irreps * CHEMPS2_CASPT2_H_SINGLET + 1 ] > jumps[ num_irreps * CHEMPS2_CASPT2_H_SINGLET ] ){
+         long long shift = 0;
          for ( int irrep_ij = 0; irrep_ij < num_irreps; irrep_ij++ ){
             const int NOCC_ij = indices->getNOCC( irrep_ij );
             const int size_ij = ( NOCC_ij * ( NOCC_ij + 1 ) ) / 2;
             for ( int irrep_ab = 0; irrep_ab < num_irreps; irrep_ab++ ){
                const int NVIR_ab = indices->getNVIRT( irrep_ab );
                const int N_OA_ab = indices->getNOCC( irrep_ab ) + indices->getNDMRG( irrep_ab );
-               double * target = result + jump[ num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift;
-               const int size_ijab = ( size_ij * NVIR_ab * ( NVIR_ab + 1 ) ) / 2;
+               double * target = result + jumps[ num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift;
+               const long long size_ijab = ( ( ( long long ) size_ij ) * NVIR_ab * ( NVIR_ab + 1 ) ) / 2;
                #pragma omp for schedule(static)
-               for ( int combined = 0; combined < size_ijab; combined++ ){
+               for ( long long combined = 0; combined < size_ijab; combined++ ){
                   Special::invert_triangle_two( combined % size_ij, triangle_idx );
                   const int i = triangle_idx[ 0 ];
                   const int j = triangle_idx[ 1 ];
@@ -2937,18 +3680,18 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
             }
          }
       }
-      {
-         int shift = 0;
+      if ( jumps[ num_irreps * CHEMPS2_CASPT2_H_TRIPLET + 1 ] > jumps[ num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] ){
+         long long shift = 0;
          for ( int irrep_ij = 0; irrep_ij < num_irreps; irrep_ij++ ){
             const int NOCC_ij = indices->getNOCC( irrep_ij );
             const int size_ij = ( NOCC_ij * ( NOCC_ij - 1 ) ) / 2;
             for ( int irrep_ab = 0; irrep_ab < num_irreps; irrep_ab++ ){
                const int NVIR_ab = indices->getNVIRT( irrep_ab );
                const int N_OA_ab = indices->getNOCC( irrep_ab ) + indices->getNDMRG( irrep_ab );
-               double * target = result + jump[ num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift;
-               const int size_ijab = ( size_ij * NVIR_ab * ( NVIR_ab - 1 ) ) / 2;
+               double * target = result + jumps[ num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift;
+               const long long size_ijab = ( ( ( long long ) size_ij ) * NVIR_ab * ( NVIR_ab - 1 ) ) / 2;
                #pragma omp for schedule(static)
-               for ( int combined = 0; combined < size_ijab; combined++ ){
+               for ( long long combined = 0; combined < size_ijab; combined++ ){
                   Special::invert_lower_triangle_two( combined % size_ij, triangle_idx );
                   const int i = triangle_idx[ 0 ];
                   const int j = triangle_idx[ 1 ];
@@ -2967,7 +3710,8 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
          }
       }
       for ( int irrep = 1; irrep < num_irreps; irrep++ ){
-         int shift = 0;
+         if ( jumps[ irrep + num_irreps * CHEMPS2_CASPT2_H_SINGLET + 1 ] == jumps[ irrep + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] ){ continue; } // Same owner for singlet and triplet
+         long long shift = 0;
          for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
             const int irrep_j = Irreps::directProd( irrep, irrep_i );
             if ( irrep_i < irrep_j ){
@@ -2979,11 +3723,11 @@ void CheMPS2::CASPT2::diagonal( double * result ) const{
                      const int NVIR_a = indices->getNVIRT( irrep_a );
                      const int N_OA_a = indices->getNOCC( irrep_a ) + indices->getNDMRG( irrep_a );
                      const int N_OA_b = indices->getNOCC( irrep_b ) + indices->getNDMRG( irrep_b );
-                     double * target_singlet = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift;
-                     double * target_triplet = result + jump[ irrep + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift;
-                     const int size_ijab = NOCC_i * NOCC_j * NVIR_a * indices->getNVIRT( irrep_b );
+                     double * target_singlet = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_H_SINGLET ] + shift;
+                     double * target_triplet = result + jumps[ irrep + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ] + shift;
+                     const long long size_ijab = ( ( long long ) NOCC_i ) * NOCC_j * NVIR_a * indices->getNVIRT( irrep_b );
                      #pragma omp for schedule(static)
-                     for ( int combined = 0; combined < size_ijab; combined++ ){
+                     for ( long long combined = 0; combined < size_ijab; combined++ ){
                         const int i = combined % NOCC_i;
                         const int temp1 = combined / NOCC_i;
                         const int j = temp1 % NOCC_j;
@@ -3101,7 +3845,10 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
       }
    }
 
-   vector_rhs = new double[ jump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ] ];
+   // The RHS and its copy in the basis of the diagonalized overlap coexist in recreate()
+   rhs_on_disk = exceeds_memory( 2.0, jump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ] );
+   if ( rhs_on_disk ){ cout << "CASPT2 : The RHS is stored in a memory-mapped file in " << scratch_folder << "." << endl; }
+   vector_rhs = allocate_vector( jump[ num_irreps * CHEMPS2_CASPT2_NUM_CASES ], rhs_on_disk );
 
    #pragma omp parallel
    {
@@ -3283,7 +4030,7 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
       // VD1 and VD2
       for ( int irrep = 0; irrep < num_irreps; irrep++ ){
          if ( size_D[ irrep ] > 0 ){
-            int shift = 0;
+            long long shift = 0;
             const int D2JUMP = size_D[ irrep ] / 2;
             for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
                const int irrep_a = Irreps::directProd( irrep_i, irrep );
@@ -3376,7 +4123,7 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
 
       // VB singlet and triplet
       if ( size_B_singlet[ 0 ] > 0 ){ // First do irrep == Ii x Ij == Ix x Iy == It x Iu == 0
-         int shift = 0; // First do SINGLET
+         long long shift = 0; // First do SINGLET
          for ( int irrep_ij = 0; irrep_ij < num_irreps; irrep_ij++ ){
             assert( shift == shift_B_nonactive( indices, irrep_ij, irrep_ij, +1 ) );
             const int NOCC_ij = indices->getNOCC( irrep_ij );
@@ -3419,7 +4166,7 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
          assert( shift * size_B_singlet[ 0 ] == jump[ 1 + num_irreps * CHEMPS2_CASPT2_B_SINGLET ] - jump[ num_irreps * CHEMPS2_CASPT2_B_SINGLET ] );
       }
       if ( size_B_triplet[ 0 ] > 0 ){ // Then do TRIPLET
-         int shift = 0;
+         long long shift = 0;
          for ( int irrep_ij = 0; irrep_ij < num_irreps; irrep_ij++ ){
             assert( shift == shift_B_nonactive( indices, irrep_ij, irrep_ij, -1 ) );
             const int NOCC_ij = indices->getNOCC( irrep_ij );
@@ -3464,7 +4211,7 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
       for ( int irrep = 1; irrep < num_irreps; irrep++ ){
          assert( size_B_singlet[ irrep ] == size_B_triplet[ irrep ] );
          if ( size_B_singlet[ irrep ] > 0 ){
-            int shift = 0;
+            long long shift = 0;
             for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
                const int irrep_j = Irreps::directProd( irrep, irrep_i );
                if ( irrep_i < irrep_j ){
@@ -3544,7 +4291,7 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
 
       // VF singlet and triplet
       if ( size_F_singlet[ 0 ] > 0 ){ // First do irrep == Ii x Ij == Ix x Iy == It x Iu == 0
-         int shift = 0; // First do SINGLET
+         long long shift = 0; // First do SINGLET
          for ( int irrep_ab = 0; irrep_ab < num_irreps; irrep_ab++ ){
             assert( shift == shift_F_nonactive( indices, irrep_ab, irrep_ab, +1 ) );
             const int N_OA_ab = indices->getNOCC( irrep_ab ) + indices->getNDMRG( irrep_ab );
@@ -3588,7 +4335,7 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
          assert( shift * size_F_singlet[ 0 ] == jump[ 1 + num_irreps * CHEMPS2_CASPT2_F_SINGLET ] - jump[ num_irreps * CHEMPS2_CASPT2_F_SINGLET ] );
       }
       if ( size_F_triplet[ 0 ] > 0 ){ // Then do TRIPLET
-         int shift = 0;
+         long long shift = 0;
          for ( int irrep_ab = 0; irrep_ab < num_irreps; irrep_ab++ ){
             assert( shift == shift_F_nonactive( indices, irrep_ab, irrep_ab, -1 ) );
             const int N_OA_ab = indices->getNOCC( irrep_ab ) + indices->getNDMRG( irrep_ab );
@@ -3634,7 +4381,7 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
       for ( int irrep = 1; irrep < num_irreps; irrep++ ){
          assert( size_F_singlet[ irrep ] == size_F_triplet[ irrep ] );
          if ( size_F_singlet[ irrep ] > 0 ){
-            int shift = 0;
+            long long shift = 0;
             for ( int irrep_a = 0; irrep_a < num_irreps; irrep_a++ ){
                const int irrep_b = Irreps::directProd( irrep, irrep_a );
                if ( irrep_a < irrep_b ){
@@ -3722,8 +4469,8 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
          if ( num_t > 0 ){
             double * target_singlet = vector_rhs + jump[ irrep + num_irreps * CHEMPS2_CASPT2_E_SINGLET ];
             double * target_triplet = vector_rhs + jump[ irrep + num_irreps * CHEMPS2_CASPT2_E_TRIPLET ];
-            int shift_singlet = 0;
-            int shift_triplet = 0;
+            long long shift_singlet = 0;
+            long long shift_triplet = 0;
             for ( int irrep_a = 0; irrep_a < num_irreps; irrep_a++ ){
                const int NVIR_a = indices->getNVIRT( irrep_a );
                const int N_OA_a = indices->getNOCC( irrep_a ) + indices->getNDMRG( irrep_a );
@@ -3816,8 +4563,8 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
          if ( num_t > 0 ){
             double * target_singlet = vector_rhs + jump[ irrep + num_irreps * CHEMPS2_CASPT2_G_SINGLET ];
             double * target_triplet = vector_rhs + jump[ irrep + num_irreps * CHEMPS2_CASPT2_G_TRIPLET ];
-            int shift_singlet = 0;
-            int shift_triplet = 0;
+            long long shift_singlet = 0;
+            long long shift_triplet = 0;
             for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
                const int NOCC_i = indices->getNOCC( irrep_i );
                const int irrep_virt = Irreps::directProd( irrep_i, irrep );
@@ -3907,8 +4654,8 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
 
       // VH singlet and triplet
       for ( int irrep = 0; irrep < num_irreps; irrep++ ){
-         int shift_singlet = 0;
-         int shift_triplet = 0;
+         long long shift_singlet = 0;
+         long long shift_triplet = 0;
          double * target_singlet = vector_rhs + jump[ irrep + num_irreps * CHEMPS2_CASPT2_H_SINGLET ];
          double * target_triplet = vector_rhs + jump[ irrep + num_irreps * CHEMPS2_CASPT2_H_TRIPLET ];
          if ( irrep == 0 ){ // irrep_i == irrep_j  and  irrep_a == irrep_b
@@ -3935,8 +4682,8 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
                      for ( int i = 0; i < nocc_ij; i++ ){
                         for ( int j = i; j < nocc_ij; j++ ){
                            const double ij_factor = (( i == j ) ? SQRT_0p5 : 1.0 );
-                           const int counter_singlet = shift_singlet + i + ( j * ( j + 1 ) ) / 2 + linsize_ij_singlet * combined_ab_singlet;
-                           const int counter_triplet = shift_triplet + i + ( j * ( j - 1 ) ) / 2 + linsize_ij_triplet * combined_ab_triplet;
+                           const long long counter_singlet = shift_singlet + i + ( j * ( j + 1 ) ) / 2 + ( ( long long ) linsize_ij_singlet ) * combined_ab_singlet;
+                           const long long counter_triplet = shift_triplet + i + ( j * ( j - 1 ) ) / 2 + ( ( long long ) linsize_ij_triplet ) * combined_ab_triplet;
 
                            const double ai_bj = integrals->get_exchange( irrep_ij, irrep_ij, irrep_ab, irrep_ab, i, j, noa_ab + a, noa_ab + b );
                            const double aj_bi = integrals->get_exchange( irrep_ij, irrep_ij, irrep_ab, irrep_ab, j, i, noa_ab + a, noa_ab + b );
@@ -3945,8 +4692,8 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
                         }
                      }
                   }
-                  shift_singlet += linsize_ij_singlet * linsize_ab_singlet;
-                  shift_triplet += linsize_ij_triplet * linsize_ab_triplet;
+                  shift_singlet += ( ( long long ) linsize_ij_singlet ) * linsize_ab_singlet;
+                  shift_triplet += ( ( long long ) linsize_ij_triplet ) * linsize_ab_triplet;
                }
             }
          } else { // irrep_i < irrep_j = irrep_i x irrep   and   irrep_a < irrep_b = irrep_a x irrep
@@ -3974,8 +4721,8 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
 
                            for ( int j = 0; j < nocc_j; j++ ){
                               for ( int i = 0; i < nocc_i; i++ ){
-                                 const int count_singlet = shift_singlet + i + nocc_i * ( j + nocc_j * combined_ab );
-                                 const int count_triplet = shift_triplet + i + nocc_i * ( j + nocc_j * combined_ab );
+                                 const long long count_singlet = shift_singlet + i + nocc_i * ( j + ( ( long long ) nocc_j ) * combined_ab );
+                                 const long long count_triplet = shift_triplet + i + nocc_i * ( j + ( ( long long ) nocc_j ) * combined_ab );
                                  const double ai_bj = integrals->get_exchange( irrep_i, irrep_j, irrep_a, irrep_b, i, j, noa_a + a, noa_b + b );
                                  const double aj_bi = integrals->get_exchange( irrep_j, irrep_i, irrep_a, irrep_b, j, i, noa_a + a, noa_b + b );
                                  target_singlet[ count_singlet ] = 2 * ( ai_bj + aj_bi );
@@ -3983,8 +4730,8 @@ void CheMPS2::CASPT2::construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFint
                               }
                            }
                         }
-                        shift_singlet += linsize_ij * linsize_ab;
-                        shift_triplet += linsize_ij * linsize_ab;
+                        shift_singlet += ( ( long long ) linsize_ij ) * linsize_ab;
+                        shift_triplet += ( ( long long ) linsize_ij ) * linsize_ab;
                      }
                   }
                }
@@ -5413,7 +6160,9 @@ void CheMPS2::CASPT2::make_AA_CC( const bool OVLP, const double IPEA ){
    if ( OVLP ){ SAA = new double*[ num_irreps ];
                 SCC = new double*[ num_irreps ]; }
    else {       FAA = new double*[ num_irreps ];
-                FCC = new double*[ num_irreps ]; }
+                FCC = new double*[ num_irreps ];
+                IAA = new double*[ num_irreps ];
+                ICC = new double*[ num_irreps ]; }
 
    const int LAS = indices->getDMRGcumulative( num_irreps );
 
@@ -5424,7 +6173,10 @@ void CheMPS2::CASPT2::make_AA_CC( const bool OVLP, const double IPEA ){
       if ( OVLP ){ SAA[ irrep ] = new double[ SIZE * SIZE ];
                    SCC[ irrep ] = new double[ SIZE * SIZE ]; }
       else {       FAA[ irrep ] = new double[ SIZE * SIZE ];
-                   FCC[ irrep ] = new double[ SIZE * SIZE ]; }
+                   FCC[ irrep ] = new double[ SIZE * SIZE ];
+                   IAA[ irrep ] = new double[ SIZE ];
+                   ICC[ irrep ] = new double[ SIZE ]; }
+      if (( OVLP == false ) && ( skip_block( CHEMPS2_CASPT2_A, irrep ) )){ continue; } // Only the owner diagonalizes the block, see recreatebatch
 
       int jump_col = 0;
       for ( int irrep_t = 0; irrep_t < num_irreps; irrep_t++ ){
@@ -5881,7 +6633,7 @@ void CheMPS2::CASPT2::make_AA_CC( const bool OVLP, const double IPEA ){
                   jump_row += num_x * num_y * num_z;
                }
             }
-            if (( OVLP == false ) && ( fabs( IPEA ) > 0.0 )){
+            if ( OVLP == false ){ // Keep the IPEA shift operator for CASPT2::change_ipea
                // A: E_ti E_uv | 0 >   --->   t: excitation into,   u: excitation into, v: excitation out of
                // C: E_at E_uv | 0 >   --->   t: excitation out of, u: excitation into, v: excitation out of
                #pragma omp parallel for schedule(static)
@@ -5891,11 +6643,14 @@ void CheMPS2::CASPT2::make_AA_CC( const bool OVLP, const double IPEA ){
                      const double gamma_uu = one_rdm[ ( d_u + u ) * ( 1 + LAS ) ];
                      for ( int t = 0; t < num_t; t++ ){
                         const double gamma_tt = one_rdm[ ( d_t + t ) * ( 1 + LAS ) ];
-                        const double ipea_A_tuv = 0.5 * IPEA * ( 2.0 + gamma_tt + gamma_uu - gamma_vv );
-                        const double ipea_C_tuv = 0.5 * IPEA * ( 4.0 - gamma_tt + gamma_uu - gamma_vv );
-                        const int ptr = ( jump_col + t + num_t * ( u + num_u * v ) ) * ( 1 + SIZE );
-                        FAA[ irrep ][ ptr ] += ipea_A_tuv * SAA[ irrep ][ ptr ];
-                        FCC[ irrep ][ ptr ] += ipea_C_tuv * SCC[ irrep ][ ptr ];
+                        const double ipea_A_tuv = 0.5 * ( 2.0 + gamma_tt + gamma_uu - gamma_vv );
+                        const double ipea_C_tuv = 0.5 * ( 4.0 - gamma_tt + gamma_uu - gamma_vv );
+                        const int diag = jump_col + t + num_t * ( u + num_u * v );
+                        const int ptr = diag * ( 1 + SIZE );
+                        IAA[ irrep ][ diag ] = ipea_A_tuv * SAA[ irrep ][ ptr ];
+                        FAA[ irrep ][ ptr ] += IPEA * IAA[ irrep ][ diag ];
+                        ICC[ irrep ][ diag ] = ipea_C_tuv * SCC[ irrep ][ ptr ];
+                        FCC[ irrep ][ ptr ] += IPEA * ICC[ irrep ][ diag ];
                      }
                   }
                }
@@ -5947,7 +6702,8 @@ void CheMPS2::CASPT2::make_DD( const bool OVLP, const double IPEA ){
    */
 
    if ( OVLP ){ SDD = new double*[ num_irreps ]; }
-   else {       FDD = new double*[ num_irreps ]; }
+   else {       FDD = new double*[ num_irreps ];
+                IDD = new double*[ num_irreps ]; }
 
    const int LAS = indices->getDMRGcumulative( num_irreps );
 
@@ -5956,7 +6712,9 @@ void CheMPS2::CASPT2::make_DD( const bool OVLP, const double IPEA ){
       const int SIZE   = size_D[ irrep ];
       const int D2JUMP = SIZE / 2;
       if ( OVLP ){ SDD[ irrep ] = new double[ SIZE * SIZE ]; }
-      else {       FDD[ irrep ] = new double[ SIZE * SIZE ]; }
+      else {       FDD[ irrep ] = new double[ SIZE * SIZE ];
+                   IDD[ irrep ] = new double[ SIZE ]; }
+      if (( OVLP == false ) && ( skip_block( CHEMPS2_CASPT2_D, irrep ) )){ continue; } // Only the owner diagonalizes the block, see recreatebatch
 
       int jump_col = 0;
       for ( int irrep_t = 0; irrep_t < num_irreps; irrep_t++ ){
@@ -6048,7 +6806,7 @@ void CheMPS2::CASPT2::make_DD( const bool OVLP, const double IPEA ){
             }
             jump_row += num_x * num_y;
          }
-         if (( OVLP == false ) && ( fabs( IPEA ) > 0.0 )){
+         if ( OVLP == false ){ // Keep the IPEA shift operator for CASPT2::change_ipea
             // D1: E_ai E_tu | 0 >   --->   t: excitation into, u excitation out of
             // D2: E_ti E_au | 0 >   --->   t: excitation into, u excitation out of
             #pragma omp parallel for schedule(static)
@@ -6056,11 +6814,15 @@ void CheMPS2::CASPT2::make_DD( const bool OVLP, const double IPEA ){
                const double gamma_uu = one_rdm[ ( d_u + u ) * ( 1 + LAS ) ];
                for ( int t = 0; t < num_t; t++ ){
                   const double gamma_tt = one_rdm[ ( d_t + t ) * ( 1 + LAS ) ];
-                  const double ipea_tu = 0.5 * IPEA * ( 2.0 + gamma_tt - gamma_uu );
-                  const int ptr1 = (          jump_col + t + num_t * u ) * ( 1 + SIZE );
-                  const int ptr2 = ( D2JUMP + jump_col + t + num_t * u ) * ( 1 + SIZE );
-                  FDD[ irrep ][ ptr1 ] += ipea_tu * SDD[ irrep ][ ptr1 ];
-                  FDD[ irrep ][ ptr2 ] += ipea_tu * SDD[ irrep ][ ptr2 ];
+                  const double ipea_tu = 0.5 * ( 2.0 + gamma_tt - gamma_uu );
+                  const int diag1 =          jump_col + t + num_t * u;
+                  const int ptr1 = diag1 * ( 1 + SIZE );
+                  const int diag2 = D2JUMP + jump_col + t + num_t * u;
+                  const int ptr2 = diag2 * ( 1 + SIZE );
+                  IDD[ irrep ][ diag1 ] = ipea_tu * SDD[ irrep ][ ptr1 ];
+                  FDD[ irrep ][ ptr1 ] += IPEA * IDD[ irrep ][ diag1 ];
+                  IDD[ irrep ][ diag2 ] = ipea_tu * SDD[ irrep ][ ptr2 ];
+                  FDD[ irrep ][ ptr2 ] += IPEA * IDD[ irrep ][ diag2 ];
                }
             }
          }
@@ -6114,7 +6876,9 @@ void CheMPS2::CASPT2::make_BB_FF_singlet( const bool OVLP, const double IPEA ){
    if ( OVLP ){ SBB_singlet = new double*[ num_irreps ];
                 SFF_singlet = new double*[ num_irreps ]; }
    else {       FBB_singlet = new double*[ num_irreps ];
-                FFF_singlet = new double*[ num_irreps ]; }
+                FFF_singlet = new double*[ num_irreps ];
+                IBB_singlet = new double*[ num_irreps ];
+                IFF_singlet = new double*[ num_irreps ]; }
 
    const int LAS = indices->getDMRGcumulative( num_irreps );
 
@@ -6124,10 +6888,13 @@ void CheMPS2::CASPT2::make_BB_FF_singlet( const bool OVLP, const double IPEA ){
       if ( OVLP ){ SBB_singlet[ 0 ] = new double[ SIZE * SIZE ];
                    SFF_singlet[ 0 ] = new double[ SIZE * SIZE ]; }
       else {       FBB_singlet[ 0 ] = new double[ SIZE * SIZE ];
-                   FFF_singlet[ 0 ] = new double[ SIZE * SIZE ]; }
+                   FFF_singlet[ 0 ] = new double[ SIZE * SIZE ];
+                   IBB_singlet[ 0 ] = new double[ SIZE ];
+                   IFF_singlet[ 0 ] = new double[ SIZE ]; }
+      const bool build = (( OVLP ) || ( skip_block( CHEMPS2_CASPT2_B_SINGLET, 0 ) == false )); // Only the owner diagonalizes the block, see recreatebatch
 
       int jump_col = 0;
-      for ( int irrep_ut = 0; irrep_ut < num_irreps; irrep_ut++ ){
+      for ( int irrep_ut = 0; ( build ) && ( irrep_ut < num_irreps ); irrep_ut++ ){
          const int d_ut    = indices->getDMRGcumulative( irrep_ut );
          const int num_ut  = indices->getNDMRG( irrep_ut );
          const int nocc_ut = indices->getNOCC( irrep_ut );
@@ -6296,18 +7063,21 @@ void CheMPS2::CASPT2::make_BB_FF_singlet( const bool OVLP, const double IPEA ){
             }
             jump_row += ( num_xy * ( num_xy + 1 ) ) / 2;
          }
-         if (( OVLP == false ) && ( fabs( IPEA ) > 0.0 )){
+         if ( OVLP == false ){ // Keep the IPEA shift operator for CASPT2::change_ipea
             // B: E_ti E_uj | 0 >   --->   tu: excitation into
             // F: E_at E_bu | 0 >   --->   tu: excitation out of
             for ( int u = 0; u < num_ut; u++ ){
                const double gamma_uu = one_rdm[ ( d_ut + u ) * ( 1 + LAS ) ];
                for ( int t = 0; t <= u; t++ ){ // 0 <= t <= u < num_ut
                   const double gamma_tt = one_rdm[ ( d_ut + t ) * ( 1 + LAS ) ];
-                  const double ipea_B_tu = 0.5 * IPEA * ( gamma_tt + gamma_uu );
-                  const double ipea_F_tu = 0.5 * IPEA * ( 4.0 - gamma_tt - gamma_uu );
-                  const int ptr = ( jump_col + t + ( u * ( u + 1 ) ) / 2 ) * ( 1 + SIZE );
-                  FBB_singlet[ 0 ][ ptr ] += ipea_B_tu * SBB_singlet[ 0 ][ ptr ];
-                  FFF_singlet[ 0 ][ ptr ] += ipea_F_tu * SFF_singlet[ 0 ][ ptr ];
+                  const double ipea_B_tu = 0.5 * ( gamma_tt + gamma_uu );
+                  const double ipea_F_tu = 0.5 * ( 4.0 - gamma_tt - gamma_uu );
+                  const int diag = jump_col + t + ( u * ( u + 1 ) ) / 2;
+                  const int ptr = diag * ( 1 + SIZE );
+                  IBB_singlet[ 0 ][ diag ] = ipea_B_tu * SBB_singlet[ 0 ][ ptr ];
+                  FBB_singlet[ 0 ][ ptr ] += IPEA * IBB_singlet[ 0 ][ diag ];
+                  IFF_singlet[ 0 ][ diag ] = ipea_F_tu * SFF_singlet[ 0 ][ ptr ];
+                  FFF_singlet[ 0 ][ ptr ] += IPEA * IFF_singlet[ 0 ][ diag ];
                }
             }
          }
@@ -6322,7 +7092,10 @@ void CheMPS2::CASPT2::make_BB_FF_singlet( const bool OVLP, const double IPEA ){
       if ( OVLP ){ SBB_singlet[ irrep ] = new double[ SIZE * SIZE ];
                    SFF_singlet[ irrep ] = new double[ SIZE * SIZE ]; }
       else {       FBB_singlet[ irrep ] = new double[ SIZE * SIZE ];
-                   FFF_singlet[ irrep ] = new double[ SIZE * SIZE ]; }
+                   FFF_singlet[ irrep ] = new double[ SIZE * SIZE ];
+                   IBB_singlet[ irrep ] = new double[ SIZE ];
+                   IFF_singlet[ irrep ] = new double[ SIZE ]; }
+      if (( OVLP == false ) && ( skip_block( CHEMPS2_CASPT2_B_SINGLET, irrep ) )){ continue; } // Only the owner diagonalizes the block, see recreatebatch
 
       int jump_col = 0;
       for ( int irrep_t = 0; irrep_t < num_irreps; irrep_t++ ){
@@ -6455,18 +7228,21 @@ void CheMPS2::CASPT2::make_BB_FF_singlet( const bool OVLP, const double IPEA ){
                   jump_row += num_x * num_y;
                }
             }
-            if (( OVLP == false ) && ( fabs( IPEA ) > 0.0 )){
+            if ( OVLP == false ){ // Keep the IPEA shift operator for CASPT2::change_ipea
                // B: E_ti E_uj | 0 >   --->   tu: excitation into
                // F: E_at E_bu | 0 >   --->   tu: excitation out of
                for ( int u = 0; u < num_u; u++ ){
                   const double gamma_uu = one_rdm[ ( d_u + u ) * ( 1 + LAS ) ];
                   for ( int t = 0; t < num_t; t++ ){
                      const double gamma_tt = one_rdm[ ( d_t + t ) * ( 1 + LAS ) ];
-                     const double ipea_B_tu = 0.5 * IPEA * ( gamma_tt + gamma_uu );
-                     const double ipea_F_tu = 0.5 * IPEA * ( 4.0 - gamma_tt - gamma_uu );
-                     const int ptr = ( jump_col + t + num_t * u ) * ( 1 + SIZE );
-                     FBB_singlet[ irrep ][ ptr ] += ipea_B_tu * SBB_singlet[ irrep ][ ptr ];
-                     FFF_singlet[ irrep ][ ptr ] += ipea_F_tu * SFF_singlet[ irrep ][ ptr ];
+                     const double ipea_B_tu = 0.5 * ( gamma_tt + gamma_uu );
+                     const double ipea_F_tu = 0.5 * ( 4.0 - gamma_tt - gamma_uu );
+                     const int diag = jump_col + t + num_t * u;
+                     const int ptr = diag * ( 1 + SIZE );
+                     IBB_singlet[ irrep ][ diag ] = ipea_B_tu * SBB_singlet[ irrep ][ ptr ];
+                     FBB_singlet[ irrep ][ ptr ] += IPEA * IBB_singlet[ irrep ][ diag ];
+                     IFF_singlet[ irrep ][ diag ] = ipea_F_tu * SFF_singlet[ irrep ][ ptr ];
+                     FFF_singlet[ irrep ][ ptr ] += IPEA * IFF_singlet[ irrep ][ diag ];
                   }
                }
             }
@@ -6523,7 +7299,9 @@ void CheMPS2::CASPT2::make_BB_FF_triplet( const bool OVLP, const double IPEA ){
    if ( OVLP ){ SBB_triplet = new double*[ num_irreps ];
                 SFF_triplet = new double*[ num_irreps ]; }
    else {       FBB_triplet = new double*[ num_irreps ];
-                FFF_triplet = new double*[ num_irreps ]; }
+                FFF_triplet = new double*[ num_irreps ];
+                IBB_triplet = new double*[ num_irreps ];
+                IFF_triplet = new double*[ num_irreps ]; }
 
    const int LAS = indices->getDMRGcumulative( num_irreps );
 
@@ -6533,10 +7311,13 @@ void CheMPS2::CASPT2::make_BB_FF_triplet( const bool OVLP, const double IPEA ){
       if ( OVLP ){ SBB_triplet[ 0 ] = new double[ SIZE * SIZE ];
                    SFF_triplet[ 0 ] = new double[ SIZE * SIZE ]; }
       else {       FBB_triplet[ 0 ] = new double[ SIZE * SIZE ];
-                   FFF_triplet[ 0 ] = new double[ SIZE * SIZE ]; }
+                   FFF_triplet[ 0 ] = new double[ SIZE * SIZE ];
+                   IBB_triplet[ 0 ] = new double[ SIZE ];
+                   IFF_triplet[ 0 ] = new double[ SIZE ]; }
+      const bool build = (( OVLP ) || ( skip_block( CHEMPS2_CASPT2_B_TRIPLET, 0 ) == false )); // Only the owner diagonalizes the block, see recreatebatch
 
       int jump_col = 0;
-      for ( int irrep_ut = 0; irrep_ut < num_irreps; irrep_ut++ ){
+      for ( int irrep_ut = 0; ( build ) && ( irrep_ut < num_irreps ); irrep_ut++ ){
          const int d_ut    = indices->getDMRGcumulative( irrep_ut );
          const int num_ut  = indices->getNDMRG( irrep_ut );
          const int nocc_ut = indices->getNOCC( irrep_ut );
@@ -6703,18 +7484,21 @@ void CheMPS2::CASPT2::make_BB_FF_triplet( const bool OVLP, const double IPEA ){
             }
             jump_row += ( num_xy * ( num_xy - 1 ) ) / 2;
          }
-         if (( OVLP == false ) && ( fabs( IPEA ) > 0.0 )){
+         if ( OVLP == false ){ // Keep the IPEA shift operator for CASPT2::change_ipea
             // B: E_ti E_uj | 0 >   --->   tu: excitation into
             // F: E_at E_bu | 0 >   --->   tu: excitation out of
             for ( int u = 0; u < num_ut; u++ ){
                const double gamma_uu = one_rdm[ ( d_ut + u ) * ( 1 + LAS ) ];
                for ( int t = 0; t < u; t++ ){ // 0 <= t < u < num_ut
                   const double gamma_tt = one_rdm[ ( d_ut + t ) * ( 1 + LAS ) ];
-                  const double ipea_B_tu = 0.5 * IPEA * ( gamma_tt + gamma_uu );
-                  const double ipea_F_tu = 0.5 * IPEA * ( 4.0 - gamma_tt - gamma_uu );
-                  const int ptr = ( jump_col + t + ( u * ( u - 1 ) ) / 2 ) * ( 1 + SIZE );
-                  FBB_triplet[ 0 ][ ptr ] += ipea_B_tu * SBB_triplet[ 0 ][ ptr ];
-                  FFF_triplet[ 0 ][ ptr ] += ipea_F_tu * SFF_triplet[ 0 ][ ptr ];
+                  const double ipea_B_tu = 0.5 * ( gamma_tt + gamma_uu );
+                  const double ipea_F_tu = 0.5 * ( 4.0 - gamma_tt - gamma_uu );
+                  const int diag = jump_col + t + ( u * ( u - 1 ) ) / 2;
+                  const int ptr = diag * ( 1 + SIZE );
+                  IBB_triplet[ 0 ][ diag ] = ipea_B_tu * SBB_triplet[ 0 ][ ptr ];
+                  FBB_triplet[ 0 ][ ptr ] += IPEA * IBB_triplet[ 0 ][ diag ];
+                  IFF_triplet[ 0 ][ diag ] = ipea_F_tu * SFF_triplet[ 0 ][ ptr ];
+                  FFF_triplet[ 0 ][ ptr ] += IPEA * IFF_triplet[ 0 ][ diag ];
                }
             }
          }
@@ -6729,7 +7513,10 @@ void CheMPS2::CASPT2::make_BB_FF_triplet( const bool OVLP, const double IPEA ){
       if ( OVLP ){ SBB_triplet[ irrep ] = new double[ SIZE * SIZE ];
                    SFF_triplet[ irrep ] = new double[ SIZE * SIZE ]; }
       else {       FBB_triplet[ irrep ] = new double[ SIZE * SIZE ];
-                   FFF_triplet[ irrep ] = new double[ SIZE * SIZE ]; }
+                   FFF_triplet[ irrep ] = new double[ SIZE * SIZE ];
+                   IBB_triplet[ irrep ] = new double[ SIZE ];
+                   IFF_triplet[ irrep ] = new double[ SIZE ]; }
+      if (( OVLP == false ) && ( skip_block( CHEMPS2_CASPT2_B_TRIPLET, irrep ) )){ continue; } // Only the owner diagonalizes the block, see recreatebatch
 
       int jump_col = 0;
       for ( int irrep_t = 0; irrep_t < num_irreps; irrep_t++ ){
@@ -6862,18 +7649,21 @@ void CheMPS2::CASPT2::make_BB_FF_triplet( const bool OVLP, const double IPEA ){
                   jump_row += num_x * num_y;
                }
             }
-            if (( OVLP == false ) && ( fabs( IPEA ) > 0.0 )){
+            if ( OVLP == false ){ // Keep the IPEA shift operator for CASPT2::change_ipea
                // B: E_ti E_uj | 0 >   --->   tu: excitation into
                // F: E_at E_bu | 0 >   --->   tu: excitation out of
                for ( int u = 0; u < num_u; u++ ){
                   const double gamma_uu = one_rdm[ ( d_u + u ) * ( 1 + LAS ) ];
                   for ( int t = 0; t < num_t; t++ ){
                      const double gamma_tt = one_rdm[ ( d_t + t ) * ( 1 + LAS ) ];
-                     const double ipea_B_tu = 0.5 * IPEA * ( gamma_tt + gamma_uu );
-                     const double ipea_F_tu = 0.5 * IPEA * ( 4.0 - gamma_tt - gamma_uu );
-                     const int ptr = ( jump_col + t + num_t * u ) * ( 1 + SIZE );
-                     FBB_triplet[ irrep ][ ptr ] += ipea_B_tu * SBB_triplet[ irrep ][ ptr ];
-                     FFF_triplet[ irrep ][ ptr ] += ipea_F_tu * SFF_triplet[ irrep ][ ptr ];
+                     const double ipea_B_tu = 0.5 * ( gamma_tt + gamma_uu );
+                     const double ipea_F_tu = 0.5 * ( 4.0 - gamma_tt - gamma_uu );
+                     const int diag = jump_col + t + num_t * u;
+                     const int ptr = diag * ( 1 + SIZE );
+                     IBB_triplet[ irrep ][ diag ] = ipea_B_tu * SBB_triplet[ irrep ][ ptr ];
+                     FBB_triplet[ irrep ][ ptr ] += IPEA * IBB_triplet[ irrep ][ diag ];
+                     IFF_triplet[ irrep ][ diag ] = ipea_F_tu * SFF_triplet[ irrep ][ ptr ];
+                     FFF_triplet[ irrep ][ ptr ] += IPEA * IFF_triplet[ irrep ][ diag ];
                   }
                }
             }
@@ -6921,7 +7711,9 @@ void CheMPS2::CASPT2::make_EE_GG( const bool OVLP, const double IPEA ){
    if ( OVLP ){ SEE = new double*[ num_irreps ];
                 SGG = new double*[ num_irreps ]; }
    else {       FEE = new double*[ num_irreps ];
-                FGG = new double*[ num_irreps ]; }
+                FGG = new double*[ num_irreps ];
+                IEE = new double*[ num_irreps ];
+                IGG = new double*[ num_irreps ]; }
 
    const int LAS = indices->getDMRGcumulative( num_irreps );
 
@@ -6943,6 +7735,8 @@ void CheMPS2::CASPT2::make_EE_GG( const bool OVLP, const double IPEA ){
       } else {
          FEE[ irrep_ut ] = new double[ SIZE * SIZE ];
          FGG[ irrep_ut ] = new double[ SIZE * SIZE ];
+         IEE[ irrep_ut ] = new double[ SIZE ];
+         IGG[ irrep_ut ] = new double[ SIZE ];
          for ( int t = 0; t < SIZE; t++ ){
             const double f_tt = fock->get( irrep_ut, NOCC + t, NOCC + t );
             for ( int u = 0; u < SIZE; u++ ){
@@ -6954,16 +7748,19 @@ void CheMPS2::CASPT2::make_EE_GG( const bool OVLP, const double IPEA ){
             }
             FEE[ irrep_ut ][ t + SIZE * t ] += 2 * ( f_dot_1dm + f_tt );
          }
-         if ( fabs( IPEA ) > 0.0 ){
+         { // Keep the IPEA shift operator for CASPT2::change_ipea
             // E: E_ti E_aj | 0 >   --->   t: excitation into
             // G: E_ai E_bt | 0 >   --->   t: excitation out of
             for ( int t = 0; t < SIZE; t++ ){
                const double gamma_tt = one_rdm[ ( d_ut + t ) * ( 1 + LAS ) ];
-               const double ipea_E_t = 0.5 * IPEA * ( gamma_tt );
-               const double ipea_G_t = 0.5 * IPEA * ( 2.0 - gamma_tt );
-               const int ptr = t * ( 1 + SIZE );
-               FEE[ irrep_ut ][ ptr ] += ipea_E_t * SEE[ irrep_ut ][ ptr ];
-               FGG[ irrep_ut ][ ptr ] += ipea_G_t * SGG[ irrep_ut ][ ptr ];
+               const double ipea_E_t = 0.5 * ( gamma_tt );
+               const double ipea_G_t = 0.5 * ( 2.0 - gamma_tt );
+               const int diag = t;
+               const int ptr = diag * ( 1 + SIZE );
+               IEE[ irrep_ut ][ diag ] = ipea_E_t * SEE[ irrep_ut ][ ptr ];
+               FEE[ irrep_ut ][ ptr ] += IPEA * IEE[ irrep_ut ][ diag ];
+               IGG[ irrep_ut ][ diag ] = ipea_G_t * SGG[ irrep_ut ][ ptr ];
+               FGG[ irrep_ut ][ ptr ] += IPEA * IGG[ irrep_ut ][ diag ];
             }
          }
       }
@@ -28,6 +28,7 @@
 #include "CASSCF.h"
 #include "Lapack.h"
 #include "Special.h"
+#include "DMRGSCFrotations.h"
 #include "MPIchemps2.h"
 
 using std::string;
@@ -38,18 +39,39 @@ using std::max;
 
 CheMPS2::CASSCF::CASSCF( Hamiltonian * ham_in, int * docc, int * socc, int * nocc, int * ndmrg, int * nvirt, const string new_tmp_folder ){
 
-   #ifdef CHEMPS2_MPI_COMPILATION
-      const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
-   #else
-      const bool am_i_master = true;
-   #endif
-
    NUCL_ORIG = ham_in->getEconst();
    TMAT_ORIG = ham_in->getTmat();
    VMAT_ORIG = ham_in->getVmat();
+   CHOL_ORIG = NULL;
 
    L = ham_in->getL();
    SymmInfo.setGroup( ham_in->getNGroup() );
+   setup( docc, socc, nocc, ndmrg, nvirt, new_tmp_folder );
+
+}
+
+CheMPS2::CASSCF::CASSCF( const double econst, const TwoIndex * tmat, const ThreeIndex * vchol, int * nocc, int * ndmrg, int * nvirt, const string new_tmp_folder ){
+
+   NUCL_ORIG = econst;
+   TMAT_ORIG = tmat;
+   VMAT_ORIG = NULL;
+   CHOL_ORIG = vchol;
+
+   SymmInfo.setGroup( vchol->getNGroup() );
+   L = 0;
+   for ( int irrep = 0; irrep < SymmInfo.getNumberOfIrreps(); irrep++ ){ L += vchol->get_irrep_size( irrep ); }
+   setup( NULL, NULL, nocc, ndmrg, nvirt, new_tmp_folder );
+
+}
+
+void CheMPS2::CASSCF::setup( int * docc, int * socc, int * nocc, int * ndmrg, int * nvirt, const string new_tmp_folder ){
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+      const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
+   #else
+      const bool am_i_master = true;
+   #endif
+
    num_irreps = SymmInfo.getNumberOfIrreps();
    successful_solve = false;
 
@@ -64,7 +86,7 @@ CheMPS2::CASSCF::CASSCF( Hamiltonian * ham_in, int * docc, int * socc, int * noc
 
    for ( int irrep = 0; irrep < num_irreps; irrep++ ){
       const int norb_in  = nocc[ irrep ] + ndmrg[ irrep ] + nvirt[ irrep ];
-      const int norb_ham = VMAT_ORIG->get_irrep_size( irrep );
+      const int norb_ham = (( VMAT_ORIG != NULL ) ? VMAT_ORIG->get_irrep_size( irrep ) : CHOL_ORIG->get_irrep_size( irrep ));
       if (( norb_ham != norb_in ) && ( am_i_master )){
          cout << "CASSCF::CASSCF : nocc[" << irrep << "] + ndmrg[" << irrep << "] + nvirt[" << irrep << "] = " << norb_in
               << " and in the Hamiltonian norb[" << irrep << "] = " << norb_ham << "." << endl;
@@ -207,8 +229,78 @@ void CheMPS2::CASSCF::rotateOldToNew( DMRGSCFmatrix * myMatrix ){
 
 }
 
+void CheMPS2::CASSCF::rotate_eri( FourIndex * NEW_VMAT, DMRGSCFintegrals * ROT_TEI, const char space1, const char space2, const char space3, const char space4, double * mem1, double * mem2, const int mem_size, const string filename ){
+
+   if ( CHOL_ORIG != NULL ){
+      DMRGSCFrotations::rotate( CHOL_ORIG, NEW_VMAT, ROT_TEI, space1, space2, space3, space4, iHandler, unitary, mem1, mem_size );
+   } else {
+      DMRGSCFrotations::rotate( VMAT_ORIG, NEW_VMAT, ROT_TEI, space1, space2, space3, space4, iHandler, unitary, mem1, mem2, mem_size, filename );
+   }
+
+}
+
+void CheMPS2::CASSCF::constructCoulombAndExchangeMatrixFromThreeIndex( DMRGSCFmatrix * density, DMRGSCFmatrix * result ){
+
+   /* result_pq = sum_rs density_rs [ ( p q | r s ) - 0.5 * ( p r | q s ) ] with ( p q | r s ) = sum_P B^P_pq B^P_rs
+         Coulomb  : gamma_P = sum_rs B^P_rs density_rs  and  J_pq = sum_P B^P_pq gamma_P ( totally symmetric P only )
+         Exchange : K_pq = sum_P sum_rs B^P_pr density_rs B^P_qs */
+
+   char trans   = 'T';
+   char notrans = 'N';
+   double one   = 1.0;
+   double set   = 0.0;
+   int inc1     = 1;
+
+   int NAUX0 = CHOL_ORIG->get_num_vectors( 0 );
+   double * gamma = new double[ NAUX0 + 1 ];
+   for ( int vec = 0; vec < NAUX0; vec++ ){ gamma[ vec ] = 0.0; }
+   for ( int irrepN = 0; irrepN < num_irreps; irrepN++ ){
+      int SIZE = iHandler->getNORB( irrepN ) * iHandler->getNORB( irrepN );
+      if (( SIZE > 0 ) && ( NAUX0 > 0 )){
+         dgemv_( &trans, &SIZE, &NAUX0, &one, CHOL_ORIG->getBlock( irrepN, irrepN ), &SIZE, density->getBlock( irrepN ), &inc1, &one, gamma, &inc1 );
+      }
+   }
+
+   for ( int irrepQ = 0; irrepQ < num_irreps; irrepQ++ ){
+      int NORBQ = iHandler->getNORB( irrepQ );
+      if ( NORBQ > 0 ){
+         int SIZE = NORBQ * NORBQ;
+         double * block = result->getBlock( irrepQ );
+         for ( int elem = 0; elem < SIZE; elem++ ){ block[ elem ] = 0.0; }
+         if ( NAUX0 > 0 ){
+            dgemv_( &notrans, &SIZE, &NAUX0, &one, CHOL_ORIG->getBlock( irrepQ, irrepQ ), &SIZE, gamma, &inc1, &set, block, &inc1 );
+         }
+         for ( int irrepN = 0; irrepN < num_irreps; irrepN++ ){
+            int NORBN = iHandler->getNORB( irrepN );
+            const int NAUX = CHOL_ORIG->get_num_vectors( Irreps::directProd( irrepQ, irrepN ) );
+            if (( NORBN > 0 ) && ( NAUX > 0 )){
+               // temp[ p, ( s, P ) ] = sum_r B^P_pr density_rs  and  result -= 0.5 * temp[ p, ( s, P ) ] B[ q, ( s, P ) ]
+               double * chol = CHOL_ORIG->getBlock( irrepQ, irrepN );
+               double * temp = new double[ NORBQ * NORBN * NAUX ];
+               #pragma omp parallel for schedule(static)
+               for ( int vec = 0; vec < NAUX; vec++ ){
+                  dgemm_( &notrans, &notrans, &NORBQ, &NORBN, &NORBN, &one, chol + NORBQ * NORBN * vec, &NORBQ, density->getBlock( irrepN ), &NORBN, &set, temp + NORBQ * NORBN * vec, &NORBQ );
+               }
+               int sum_dim = NORBN * NAUX;
+               double alpha = -0.5;
+               dgemm_( &notrans, &trans, &NORBQ, &NORBQ, &sum_dim, &alpha, temp, &NORBQ, chol, &NORBQ, &one, block, &NORBQ );
+               delete [] temp;
+            }
+         }
+      }
+   }
+
+   delete [] gamma;
+
+}
+
 void CheMPS2::CASSCF::constructCoulombAndExchangeMatrixInOrigIndices( DMRGSCFmatrix * density, DMRGSCFmatrix * result ){
 
+  if ( CHOL_ORIG != NULL ){
+      constructCoulombAndExchangeMatrixFromThreeIndex( density, result );
+      return;
+  }
+
   for ( int irrepQ = 0; irrepQ < num_irreps; irrepQ++ ){
 
       const int linearsizeQ = iHandler->getNORB( irrepQ );
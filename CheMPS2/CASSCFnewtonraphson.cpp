@@ -32,12 +32,14 @@
 #include "Davidson.h"
 #include "FCI.h"
 #include "MPIchemps2.h"
+#include "Tracer.h"
 
 using std::string;
 using std::ifstream;
 using std::cout;
 using std::endl;
 using std::max;
+using std::min;
 
 void CheMPS2::CASSCF::delete_file( const string filename ){
 
@@ -63,7 +65,6 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
 
    const int num_elec = Nelectrons - 2 * iHandler->getNOCCsum();
    assert( num_elec >= 0 );
-   assert(( OptScheme != NULL ) || ( rootNum == 1 ));
 
    // Convergence variables
    double gradNorm = 1.0;
@@ -83,12 +84,12 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
 
    // Determine the maximum NORB( irrep ) and the max_block_size for the ERI orbital rotation
    const int maxlinsize      = iHandler->getNORBmax();
-   const long long fullsize  = ((long long) maxlinsize ) * ((long long) maxlinsize ) * ((long long) maxlinsize ) * ((long long) maxlinsize );
+   const long long fullsize  = ((long long) maxlinsize ) * ((long long) maxlinsize ) * ((long long) maxlinsize ) * (( CHOL_ORIG != NULL ) ? 1 : ((long long) maxlinsize )); // Three-index ERI are assembled in blocks of rows
    const string tmp_filename = tmp_folder + "/" + CheMPS2::DMRGSCF_eri_storage_name;
    const int dmrgsize_power4 = nOrbDMRG * nOrbDMRG * nOrbDMRG * nOrbDMRG;
    // For ( ERI rotation, update unitary, block diagonalize, orbital localization )
    DMRGSCFintegrals * theRotatedTEI = new DMRGSCFintegrals( iHandler );
-   DMRGSCFwtilde * wmattilde = new DMRGSCFwtilde( iHandler );
+   DMRGSCFwtilde * wmattilde = new DMRGSCFwtilde( iHandler, scf_options->getStoreWtilde() );
    const int temp_work_size = (( fullsize > CheMPS2::DMRGSCF_max_mem_eri_tfo ) ? CheMPS2::DMRGSCF_max_mem_eri_tfo : fullsize );
    const int work_mem_size = max( max( temp_work_size , maxlinsize * maxlinsize * 4 ) , dmrgsize_power4 );
    double * mem1 = new double[ work_mem_size ];
@@ -128,9 +129,12 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
    /*******************************
    ***   Actual DMRGSCF loops   ***
    *******************************/
-   while (( gradNorm > scf_options->getGradientThreshold() ) && ( nIterations < scf_options->getMaxIterations() )){
+   bool loosened_dmrg  = false; // Whether the last DMRG calculation used a loosened convergence scheme
+   bool gradient_known = false; // Whether gradNorm is an actual orbital gradient 2-norm instead of the initial value
+   while ((( gradNorm > scf_options->getGradientThreshold() ) || ( loosened_dmrg )) && ( nIterations < scf_options->getMaxIterations() )){
 
       nIterations++;
+      Tracer::Scope macro_iteration( "DMRGSCF iteration", "dmrgscf" );
 
       // Update the unitary transformation
       if (( unitary->getNumVariablesX() > 0 ) && ( am_i_master )){
@@ -172,7 +176,7 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
       buildQmatOCC();
       fillConstAndTmatDMRG( HamDMRG );
       if ( am_i_master ){
-         DMRGSCFrotations::rotate( VMAT_ORIG, HamDMRG->getVmat(), NULL, 'A', 'A', 'A', 'A', iHandler, unitary, mem1, mem2, work_mem_size, tmp_filename );
+         rotate_eri( HamDMRG->getVmat(), NULL, 'A', 'A', 'A', 'A', mem1, mem2, work_mem_size, tmp_filename );
       }
       #ifdef CHEMPS2_MPI_COMPILATION
       HamDMRG->getVmat()->broadcast( MPI_CHEMPS2_MASTER );
@@ -193,7 +197,7 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
          buildQmatOCC();
          fillConstAndTmatDMRG( HamDMRG );
          if ( am_i_master ){
-            DMRGSCFrotations::rotate( VMAT_ORIG, HamDMRG->getVmat(), NULL, 'A', 'A', 'A', 'A', iHandler, unitary, mem1, mem2, work_mem_size, tmp_filename );
+            rotate_eri( HamDMRG->getVmat(), NULL, 'A', 'A', 'A', 'A', mem1, mem2, work_mem_size, tmp_filename );
             cout << "DMRGSCF::solve : Rotated the active space to localized orbitals, sorted according to the exchange matrix." << endl;
          }
          #ifdef CHEMPS2_MPI_COMPILATION
@@ -214,21 +218,41 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
          delete [] dmrg2ham;
       }
 
-      if (( OptScheme == NULL ) && ( rootNum == 1 )){ // Do FCI, and calculate the 2DM
+      if ( OptScheme == NULL ){ // Do FCI, and calculate the 2DM
 
-         if ( am_i_master ){
+         Tracer::Scope active_space( "FCI active space", "dmrgscf" );
+         { // All MPI processes take part in the matrix-vector products; the master process calculates the 2DM
             const int nalpha = ( num_elec + TwoS ) / 2;
             const int nbeta  = ( num_elec - TwoS ) / 2;
             const double workmem = 1000.0; // 1GB
-            const int verbose = 2;
-            CheMPS2::FCI * theFCI = new CheMPS2::FCI( HamDMRG, nalpha, nbeta, Irrep, workmem, verbose );
-            double * inoutput = new double[ theFCI->getVecLength(0) ];
-            theFCI->ClearVector( theFCI->getVecLength(0), inoutput );
-            inoutput[ theFCI->LowestEnergyDeterminant() ] = 1.0;
-            Energy = theFCI->GSDavidson( inoutput );
-            theFCI->Fill2RDM( inoutput, DMRG2DM );
+            const int verbose = (( am_i_master ) ? 2 : 0 );
+            CheMPS2::FCI * theFCI = new CheMPS2::FCI( HamDMRG, nalpha, nbeta, Irrep, workmem, verbose, true );
+            if ( rootNum == 1 ){
+               double * inoutput = new double[ theFCI->getVecLength(0) ];
+               theFCI->ClearVector( theFCI->getVecLength(0), inoutput );
+               inoutput[ theFCI->LowestEnergyDeterminant() ] = 1.0;
+               if ( scf_options->getSpinAdaptFCI() ){ theFCI->SpinAdapt( TwoS ); } // Davidson in the basis of configuration state functions with spin TwoS / 2
+               Energy = theFCI->GSDavidson( inoutput );
+               if ( am_i_master ){ theFCI->Fill2RDM( inoutput, DMRG2DM ); }
+               delete [] inoutput;
+            } else { // The spin penalty keeps the roots in the spin sector TwoS, like the spin-adapted DMRG roots
+               double ** roots = new double*[ rootNum ];
+               double * energies = new double[ rootNum ];
+               double * weights  = new double[ rootNum * rootNum ];
+               for ( int state = 0; state < rootNum; state++ ){ roots[ state ] = new double[ theFCI->getVecLength(0) ]; }
+               theFCI->MultiRootDavidson( rootNum, roots, energies, false, CheMPS2::FCI_SPIN_PENALTY );
+               for ( int cnt = 0; cnt < rootNum * rootNum; cnt++ ){ weights[ cnt ] = 0.0; }
+               for ( int state = 0; state < rootNum; state++ ){ // SA-DMRGSCF: average 2DM; SS-DMRGSCF: 2DM of the last root
+                  weights[ state * ( rootNum + 1 ) ] = (( scf_options->getStateAveraging() ) ? 1.0 / rootNum : (( state == rootNum - 1 ) ? 1.0 : 0.0 ));
+               }
+               if ( am_i_master ){ theFCI->Fill2RDM( roots, rootNum, weights, DMRG2DM ); }
+               Energy = energies[ rootNum - 1 ];
+               for ( int state = 0; state < rootNum; state++ ){ delete [] roots[ state ]; }
+               delete [] roots;
+               delete [] energies;
+               delete [] weights;
+            }
             delete theFCI;
-            delete [] inoutput;
          }
          #ifdef CHEMPS2_MPI_COMPILATION
          MPIchemps2::broadcast_array_double( &Energy, 1, MPI_CHEMPS2_MASTER );
@@ -238,8 +262,14 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
       } else { // Do the DMRG sweeps, and calculate the 2DM
 
          assert( OptScheme != NULL );
+         Tracer::Scope active_space( "DMRG active space", "dmrgscf" );
          for ( int cnt = 0; cnt < dmrgsize_power4; cnt++ ){ DMRG2DM[ cnt ] = 0.0; } // Clear the 2-RDM ( to allow for state-averaged calculations )
-         DMRG * theDMRG = new DMRG( Prob, OptScheme, CheMPS2::DMRG_storeMpsOnDisk, tmp_folder );
+         ConvergenceScheme * LooseScheme = ((( scf_options->getAdaptiveDMRG() ) && ( gradient_known )) ? adaptive_scheme( OptScheme, gradNorm, scf_options->getAdaptiveGradient(), scf_options->getAdaptiveMinD() ) : NULL );
+         loosened_dmrg = ( LooseScheme != NULL );
+         if (( loosened_dmrg ) && ( am_i_master )){
+            cout << "DMRGSCF::solve : Loosened DMRG convergence scheme for the orbital gradient 2-norm " << gradNorm << " with D = " << LooseScheme->get_D( LooseScheme->get_number() - 1 ) << "." << endl;
+         }
+         DMRG * theDMRG = new DMRG( Prob, (( loosened_dmrg ) ? LooseScheme : OptScheme ), CheMPS2::DMRG_storeMpsOnDisk, tmp_folder );
          for ( int state = 0; state < rootNum; state++ ){
             if ( state > 0 ){ theDMRG->newExcitation( fabs( Energy ) ); }
             Energy = theDMRG->Solve();
@@ -257,6 +287,7 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
          if (CheMPS2::DMRG_storeMpsOnDisk){        theDMRG->deleteStoredMPS();       }
          if (CheMPS2::DMRG_storeRenormOptrOnDisk){ theDMRG->deleteStoredOperators(); }
          delete theDMRG;
+         if ( LooseScheme != NULL ){ delete LooseScheme; }
          if (( scf_options->getStateAveraging() ) && ( rootNum > 1 )){
             const double averagingfactor = 1.0 / rootNum;
             for ( int cnt = 0; cnt < dmrgsize_power4; cnt++ ){ DMRG2DM[ cnt ] *= averagingfactor; }
@@ -282,16 +313,19 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
       // Calculate the matrix elements needed to calculate the gradient and hessian
       buildQmatACT();
       if ( am_i_master ){
-         DMRGSCFrotations::rotate( VMAT_ORIG, NULL, theRotatedTEI, 'C', 'C', 'F', 'F', iHandler, unitary, mem1, mem2, work_mem_size, tmp_filename );
-         DMRGSCFrotations::rotate( VMAT_ORIG, NULL, theRotatedTEI, 'C', 'V', 'C', 'V', iHandler, unitary, mem1, mem2, work_mem_size, tmp_filename );
+         rotate_eri( NULL, theRotatedTEI, 'C', 'C', 'F', 'F', mem1, mem2, work_mem_size, tmp_filename );
+         rotate_eri( NULL, theRotatedTEI, 'C', 'V', 'C', 'V', mem1, mem2, work_mem_size, tmp_filename );
          buildFmat(  theFmatrix, theTmatrix, theQmatOCC, theQmatACT, iHandler, theRotatedTEI, DMRG2DM, DMRG1DM );
-         buildWtilde( wmattilde, theTmatrix, theQmatOCC, theQmatACT, iHandler, theRotatedTEI, DMRG2DM, DMRG1DM );
+         buildWtilde( wmattilde, theTmatrix, theQmatOCC, theQmatACT, theRotatedTEI, DMRG2DM, DMRG1DM );
+         Tracer::begin( "augmented Hessian NR", "dmrgscf" );
          augmentedHessianNR( theFmatrix, wmattilde, iHandler, unitary, gradient, &updateNorm, &gradNorm ); // On return the gradient contains the update
+         Tracer::end( "augmented Hessian NR", "dmrgscf" );
       }
       #ifdef CHEMPS2_MPI_COMPILATION
       MPIchemps2::broadcast_array_double( &updateNorm, 1, MPI_CHEMPS2_MASTER );
       MPIchemps2::broadcast_array_double( &gradNorm,   1, MPI_CHEMPS2_MASTER );
       #endif
+      gradient_known = true;
 
    }
 
@@ -313,6 +347,27 @@ double CheMPS2::CASSCF::solve( const int Nelectrons, const int TwoS, const int I
 
 }
 
+CheMPS2::ConvergenceScheme * CheMPS2::CASSCF::adaptive_scheme( const ConvergenceScheme * OptScheme, const double gradNorm, const double adaptiveGradient, const int adaptiveMinD ){
+
+   const double ratio = min( gradNorm / adaptiveGradient, CheMPS2::DMRGSCF_adaptiveMaxLoosening );
+   if ( ratio <= 1.0 ){ return NULL; }
+
+   // Bond dimensions scale with the square root, and thresholds linearly with the orbital gradient 2-norm
+   const double shrink = sqrt( ratio );
+   ConvergenceScheme * LooseScheme = new ConvergenceScheme( OptScheme->get_number() );
+   for ( int inst = 0; inst < OptScheme->get_number(); inst++ ){
+      const int D_full  = OptScheme->get_D( inst );
+      const int D_loose = max( min( D_full, adaptiveMinD ), (int)( D_full / shrink ) );
+      LooseScheme->set_instruction( inst, D_loose,
+                                          OptScheme->get_energy_conv( inst ) * ratio,
+                                          OptScheme->get_max_sweeps( inst ),
+                                          OptScheme->get_noise_prefactor( inst ),
+                                          OptScheme->get_dvdson_rtol( inst ) * ratio );
+   }
+   return LooseScheme;
+
+}
+
 void CheMPS2::CASSCF::augmentedHessianNR( DMRGSCFmatrix * localFmat, DMRGSCFwtilde * localwtilde, const DMRGSCFindices * localIdx, const DMRGSCFunitary * localUmat, double * theupdate, double * updateNorm, double * gradNorm ){
 
    /* A good read to understand
@@ -429,6 +484,7 @@ void CheMPS2::CASSCF::augmented_hessian( DMRGSCFmatrix * Fmatrix, DMRGSCFwtilde
 void CheMPS2::CASSCF::diag_hessian( DMRGSCFmatrix * Fmatrix, const DMRGSCFwtilde * Wtilde, const DMRGSCFindices * idx, double * diagonal ){
 
    const int n_irreps = idx->getNirreps();
+   const int max_norb = idx->getNORBmax();
 
    int jump = 0;
    for ( int irrep = 0; irrep < n_irreps; irrep++ ){
@@ -439,36 +495,54 @@ void CheMPS2::CASSCF::diag_hessian( DMRGSCFmatrix * Fmatrix, const DMRGSCFwtilde
       const int NVIR = idx->getNVIRT( irrep );
       const int N_OA = NOCC + NACT;
       double * FMAT = Fmatrix->getBlock( irrep );
-
-      for ( int occ = 0; occ < NOCC; occ++ ){
-         const double F_occ = FMAT[ occ * ( NORB + 1 ) ];
+      double * diagAO = diagonal + jump;
+      double * diagVA = diagAO + NACT * NOCC;
+      double * diagVO = diagVA + NVIR * NACT;
+
+      #pragma omp parallel
+      {
+         double * work1 = (( Wtilde->isStored() ) ? NULL : new double[ max_norb * max_norb ] );
+         double * work2 = (( Wtilde->isStored() ) ? NULL : new double[ max_norb * max_norb ] );
+         double * work3 = (( Wtilde->isStored() ) ? NULL : new double[ max_norb * max_norb ] );
+
+         // The ( act, act ) subblocks: w_tilde[ act, occ, act, occ ] is temporarily stored in diagAO
+         #pragma omp for schedule(dynamic)
          for ( int act = 0; act < NACT; act++ ){
             const double F_act = FMAT[ ( NOCC + act ) * ( NORB + 1 ) ];
-            diagonal[ jump + act + NACT * occ ] = - 2 * ( F_occ + F_act ) + ( Wtilde->get( irrep, irrep, NOCC + act, occ, NOCC + act, occ )
-                                                                            - Wtilde->get( irrep, irrep, NOCC + act, occ, occ, NOCC + act )
-                                                                            - Wtilde->get( irrep, irrep, occ, NOCC + act, NOCC + act, occ ) 
-                                                                            + Wtilde->get( irrep, irrep, occ, NOCC + act, occ, NOCC + act ) );
+            const double * W_aa = Wtilde->fetchBlock( irrep, irrep, NOCC + act, NOCC + act, work1 );
+            for ( int occ = 0; occ < NOCC; occ++ ){
+               diagAO[ act + NACT * occ ] = W_aa[ occ * ( NORB + 1 ) ];
+            }
+            for ( int vir = 0; vir < NVIR; vir++ ){
+               const double F_vir = FMAT[ ( N_OA + vir ) * ( NORB + 1 ) ];
+               diagVA[ vir + NVIR * act ] = - 2 * ( F_act + F_vir ) + W_aa[ ( N_OA + vir ) * ( NORB + 1 ) ];
+            }
          }
-      }
-      jump += NOCC * NACT;
 
-      for ( int act = 0; act < NACT; act++ ){
-         const double F_act = FMAT[ ( NOCC + act ) * ( NORB + 1 ) ];
-         for ( int vir = 0; vir < NVIR; vir++ ){
-            const double F_vir = FMAT[ ( N_OA + vir ) * ( NORB + 1 ) ];
-            diagonal[ jump + vir + NVIR * act ] = - 2 * ( F_act + F_vir ) + Wtilde->get( irrep, irrep, NOCC + act, N_OA + vir, NOCC + act, N_OA + vir );
+         #pragma omp for schedule(dynamic)
+         for ( int occ = 0; occ < NOCC; occ++ ){
+            const double F_occ = FMAT[ occ * ( NORB + 1 ) ];
+            const double * W_oo = Wtilde->fetchBlock( irrep, irrep, occ, occ, work1 );
+            for ( int act = 0; act < NACT; act++ ){
+               const double F_act = FMAT[ ( NOCC + act ) * ( NORB + 1 ) ];
+               const double * W_ao = Wtilde->fetchBlock( irrep, irrep, NOCC + act, occ, work2 );
+               const double * W_oa = Wtilde->fetchBlock( irrep, irrep, occ, NOCC + act, work3 );
+               diagAO[ act + NACT * occ ] = - 2 * ( F_occ + F_act ) + ( diagAO[ act + NACT * occ ]
+                                                                      - W_ao[ occ + NORB * ( NOCC + act ) ]
+                                                                      - W_oa[ ( NOCC + act ) + NORB * occ ]
+                                                                      + W_oo[ ( NOCC + act ) * ( NORB + 1 ) ] );
+            }
+            for ( int vir = 0; vir < NVIR; vir++ ){
+               const double F_vir = FMAT[ ( N_OA + vir ) * ( NORB + 1 ) ];
+               diagVO[ vir + NVIR * occ ] = - 2 * ( F_occ + F_vir ) + W_oo[ ( N_OA + vir ) * ( NORB + 1 ) ];
+            }
          }
-      }
-      jump += NACT * NVIR;
 
-      for ( int occ = 0; occ < NOCC; occ++ ){
-         const double F_occ = FMAT[ occ * ( NORB + 1 ) ];
-         for ( int vir = 0; vir < NVIR; vir++ ){
-            const double F_vir = FMAT[ ( N_OA + vir ) * ( NORB + 1 ) ];
-            diagonal[ jump + vir + NVIR * occ ] = - 2 * ( F_occ + F_vir ) + Wtilde->get( irrep, irrep, occ, N_OA + vir, occ, N_OA + vir );
-         }
+         if ( work1 != NULL ){ delete [] work1; }
+         if ( work2 != NULL ){ delete [] work2; }
+         if ( work3 != NULL ){ delete [] work3; }
       }
-      jump += NOCC * NVIR;
+      jump += NOCC * NACT + NVIR * NACT + NVIR * NOCC;
    }
 
 }
@@ -525,6 +599,9 @@ void CheMPS2::CASSCF::add_hessian( DMRGSCFmatrix * Fmatrix, DMRGSCFwtilde * Wtil
    #pragma omp parallel
    {
 
+      // Without stored w_tilde, each thread computes the subblocks it needs in work
+      double * work = (( Wtilde->isStored() ) ? NULL : new double[ idx->getNORBmax() * idx->getNORBmax() ] );
+
       int jump_row = 0;
       for ( int irrep_row = 0; irrep_row < n_irreps; irrep_row++ ){
 
@@ -551,14 +628,14 @@ void CheMPS2::CASSCF::add_hessian( DMRGSCFmatrix * Fmatrix, DMRGSCFwtilde * Wtil
             #pragma omp for schedule(static)
             for ( int act_row = 0; act_row < NACT_row; act_row++ ){
                for ( int occ_col = 0; occ_col < NOCC_col; occ_col++ ){
-                  double * mat = Wtilde->getBlock( irrep_row, irrep_col, NOCC_row + act_row, occ_col );
+                  double * mat = Wtilde->fetchBlock( irrep_row, irrep_col, NOCC_row + act_row, occ_col, work );
                   DGEMV_WRAP( -1.0, mat +            NORB_row * NOCC_col, resAO + act_row,            vecAO + NACT_col * occ_col, NOCC_row, NACT_col, NORB_row, NACT_row, 1 );
                   DGEMV_WRAP( -1.0, mat +            NORB_row * N_OA_col, resAO + act_row,            vecVO + NVIR_col * occ_col, NOCC_row, NVIR_col, NORB_row, NACT_row, 1 );
                   DGEMV_WRAP(  1.0, mat + N_OA_row + NORB_row * NOCC_col, resVA + NVIR_row * act_row, vecAO + NACT_col * occ_col, NVIR_row, NACT_col, NORB_row, 1,        1 );
                   DGEMV_WRAP(  1.0, mat + N_OA_row + NORB_row * N_OA_col, resVA + NVIR_row * act_row, vecVO + NVIR_col * occ_col, NVIR_row, NVIR_col, NORB_row, 1,        1 );
                }
                for ( int act_col = 0; act_col < NACT_col; act_col++ ){
-                  double * mat = Wtilde->getBlock( irrep_row, irrep_col, NOCC_row + act_row, NOCC_col + act_col );
+                  double * mat = Wtilde->fetchBlock( irrep_row, irrep_col, NOCC_row + act_row, NOCC_col + act_col, work );
                   DGEMV_WRAP(  1.0, mat,                                  resAO + act_row,            vecAO + act_col,            NOCC_row, NOCC_col, NORB_row, NACT_row, NACT_col );
                   DGEMV_WRAP( -1.0, mat            + NORB_row * N_OA_col, resAO + act_row,            vecVA + NVIR_col * act_col, NOCC_row, NVIR_col, NORB_row, NACT_row, 1        );
                   DGEMV_WRAP( -1.0, mat + N_OA_row,                       resVA + NVIR_row * act_row, vecAO + act_col,            NVIR_row, NOCC_col, NORB_row, 1,        NACT_col );
@@ -569,14 +646,14 @@ void CheMPS2::CASSCF::add_hessian( DMRGSCFmatrix * Fmatrix, DMRGSCFwtilde * Wtil
             #pragma omp for schedule(static)
             for ( int occ_row = 0; occ_row < NOCC_row; occ_row++ ){
                for ( int occ_col = 0; occ_col < NOCC_col; occ_col++ ){
-                  double * mat = Wtilde->getBlock( irrep_row, irrep_col, occ_row, occ_col );
+                  double * mat = Wtilde->fetchBlock( irrep_row, irrep_col, occ_row, occ_col, work );
                   DGEMV_WRAP( 1.0, mat + NOCC_row + NORB_row * NOCC_col, resAO + NACT_row * occ_row, vecAO + NACT_col * occ_col, NACT_row, NACT_col, NORB_row, 1, 1 );
                   DGEMV_WRAP( 1.0, mat + NOCC_row + NORB_row * N_OA_col, resAO + NACT_row * occ_row, vecVO + NVIR_col * occ_col, NACT_row, NVIR_col, NORB_row, 1, 1 );
                   DGEMV_WRAP( 1.0, mat + N_OA_row + NORB_row * NOCC_col, resVO + NVIR_row * occ_row, vecAO + NACT_col * occ_col, NVIR_row, NACT_col, NORB_row, 1, 1 );
                   DGEMV_WRAP( 1.0, mat + N_OA_row + NORB_row * N_OA_col, resVO + NVIR_row * occ_row, vecVO + NVIR_col * occ_col, NVIR_row, NVIR_col, NORB_row, 1, 1 );
                }
                for ( int act_col = 0; act_col < NACT_col; act_col++ ){
-                  double * mat = Wtilde->getBlock( irrep_row, irrep_col, occ_row, NOCC_col + act_col );
+                  double * mat = Wtilde->fetchBlock( irrep_row, irrep_col, occ_row, NOCC_col + act_col, work );
                   DGEMV_WRAP( -1.0, mat + NOCC_row,                       resAO + NACT_row * occ_row, vecAO + act_col,            NACT_row, NOCC_col, NORB_row, 1, NACT_col );
                   DGEMV_WRAP(  1.0, mat + NOCC_row + NORB_row * N_OA_col, resAO + NACT_row * occ_row, vecVA + NVIR_col * act_col, NACT_row, NVIR_col, NORB_row, 1, 1        );
                   DGEMV_WRAP( -1.0, mat + N_OA_row,                       resVO + NVIR_row * occ_row, vecAO + act_col,            NVIR_row, NOCC_col, NORB_row, 1, NACT_col );
@@ -587,6 +664,8 @@ void CheMPS2::CASSCF::add_hessian( DMRGSCFmatrix * Fmatrix, DMRGSCFwtilde * Wtil
          }
          jump_row += NACT_row * NOCC_row + NVIR_row * NACT_row + NVIR_row * NOCC_row;
       }
+
+      if ( work != NULL ){ delete [] work; }
    }
 
 }
@@ -608,215 +687,9 @@ void CheMPS2::CASSCF::DGEMV_WRAP( double prefactor, double * matrix, double * re
 
 }
 
-void CheMPS2::CASSCF::buildWtilde(DMRGSCFwtilde * localwtilde, const DMRGSCFmatrix * localTmat, const DMRGSCFmatrix * localJKocc, const DMRGSCFmatrix * localJKact, const DMRGSCFindices * localIdx, const DMRGSCFintegrals * theInts, double * local2DM, double * local1DM){
+void CheMPS2::CASSCF::buildWtilde(DMRGSCFwtilde * localwtilde, const DMRGSCFmatrix * localTmat, const DMRGSCFmatrix * localJKocc, const DMRGSCFmatrix * localJKact, const DMRGSCFintegrals * theInts, double * local2DM, double * local1DM){
 
-   localwtilde->clear();
-   const int numIrreps  = localIdx->getNirreps();
-   const int totOrbDMRG = localIdx->getDMRGcumulative( numIrreps );
-   for (int irrep_pq = 0; irrep_pq < numIrreps; irrep_pq++){
-   
-      const int NumOCCpq  = localIdx->getNOCC(  irrep_pq );
-      const int NumDMRGpq = localIdx->getNDMRG( irrep_pq );
-      const int NumORBpq  = localIdx->getNORB(  irrep_pq );
-      const int NumCOREpq = NumOCCpq + NumDMRGpq;
-      
-      //If irrep_pq == irrep_rs and P == R occupied --> QS only active or virtual
-      #pragma omp parallel for schedule(static)
-      for (int relindexP = 0; relindexP < NumOCCpq; relindexP++){
-         double * subblock = localwtilde->getBlock( irrep_pq, irrep_pq, relindexP, relindexP);
-         for (int relindexS = NumOCCpq; relindexS < NumORBpq; relindexS++){
-            for (int relindexQ = NumOCCpq; relindexQ < NumORBpq; relindexQ++){
-               subblock[ relindexQ + NumORBpq * relindexS ] += 4 * ( localTmat->get( irrep_pq, relindexQ, relindexS)
-                                                                   + localJKocc->get(irrep_pq, relindexQ, relindexS)
-                                                                   + localJKact->get(irrep_pq, relindexQ, relindexS) );
-            }
-         }
-      }
-      
-      //If irrep_pq == irrep_rs and P,R active --> QS only occupied or virtual
-      #pragma omp parallel for schedule(static)
-      for (int combined = 0; combined < NumDMRGpq*NumDMRGpq; combined++){
-         
-         const int relindexP  = NumOCCpq + ( combined % NumDMRGpq );
-         const int relindexR  = NumOCCpq + ( combined / NumDMRGpq );
-         double * subblock    = localwtilde->getBlock( irrep_pq, irrep_pq, relindexP, relindexR );
-         const int DMRGindexP = relindexP - NumOCCpq + localIdx->getDMRGcumulative( irrep_pq );
-         const int DMRGindexR = relindexR - NumOCCpq + localIdx->getDMRGcumulative( irrep_pq );
-         const double OneDMvalue = local1DM[ DMRGindexP + totOrbDMRG * DMRGindexR ];
-         
-         for (int relindexS = 0; relindexS < NumOCCpq; relindexS++){
-            for (int relindexQ = 0; relindexQ < NumOCCpq; relindexQ++){
-               subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue * ( localTmat->get( irrep_pq, relindexQ, relindexS)
-                                                                                + localJKocc->get(irrep_pq, relindexQ, relindexS) );
-            }
-            for (int relindexQ = NumCOREpq; relindexQ < NumORBpq; relindexQ++){
-               subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue * ( localTmat->get( irrep_pq, relindexQ, relindexS)
-                                                                                + localJKocc->get(irrep_pq, relindexQ, relindexS) );
-            }
-         }
-         for (int relindexS = NumCOREpq; relindexS < NumORBpq; relindexS++){
-            for (int relindexQ = 0; relindexQ < NumOCCpq; relindexQ++){
-               subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue * ( localTmat->get( irrep_pq, relindexQ, relindexS)
-                                                                                + localJKocc->get(irrep_pq, relindexQ, relindexS) );
-            }
-            for (int relindexQ = NumCOREpq; relindexQ < NumORBpq; relindexQ++){
-               subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue * ( localTmat->get( irrep_pq, relindexQ, relindexS)
-                                                                                + localJKocc->get(irrep_pq, relindexQ, relindexS) );
-            }
-         }
-      }
-   
-      for (int irrep_rs = 0; irrep_rs < numIrreps; irrep_rs++){
-      
-         const int NumOCCrs  = localIdx->getNOCC(  irrep_rs );
-         const int NumDMRGrs = localIdx->getNDMRG( irrep_rs );
-         const int NumORBrs  = localIdx->getNORB(  irrep_rs );
-         const int NumCORErs = NumOCCrs + NumDMRGrs;
-         const int productirrep = Irreps::directProd( irrep_pq, irrep_rs );
-      
-         // P and R occupied --> QS only active or virtual
-         #pragma omp parallel for schedule(static)
-         for (int combined = 0; combined < NumOCCpq*NumOCCrs; combined++){
-         
-            const int relindexP = combined % NumOCCpq;
-            const int relindexR = combined / NumOCCpq;
-            double * subblock   = localwtilde->getBlock( irrep_pq, irrep_rs, relindexP, relindexR);
-            
-            for (int relindexS = NumOCCrs; relindexS < NumORBrs; relindexS++){
-               for (int relindexQ = NumOCCpq; relindexQ < NumORBpq; relindexQ++){
-                  subblock[ relindexQ + NumORBpq * relindexS ] +=  
-                      4 * ( 4 * theInts->FourIndexAPI(irrep_pq, irrep_rs, irrep_pq, irrep_rs, relindexQ, relindexS, relindexP, relindexR)
-                              - theInts->FourIndexAPI(irrep_pq, irrep_pq, irrep_rs, irrep_rs, relindexQ, relindexP, relindexS, relindexR)
-                              - theInts->FourIndexAPI(irrep_pq, irrep_rs, irrep_rs, irrep_pq, relindexQ, relindexS, relindexR, relindexP) );
-               }
-            }
-         } // End combined P and R occupied
-         
-         // P and R active --> QS only occupied or virtual
-         #pragma omp parallel for schedule(static)
-         for (int combined = 0; combined < NumDMRGpq*NumDMRGrs; combined++){
-         
-            const int relindexP  = NumOCCpq + ( combined % NumDMRGpq );
-            const int relindexR  = NumOCCrs + ( combined / NumDMRGpq );
-            double * subblock    = localwtilde->getBlock( irrep_pq, irrep_rs, relindexP, relindexR );
-            const int DMRGindexP = relindexP - NumOCCpq + localIdx->getDMRGcumulative( irrep_pq );
-            const int DMRGindexR = relindexR - NumOCCrs + localIdx->getDMRGcumulative( irrep_rs );
-            
-            for (int irrep_alpha = 0; irrep_alpha < numIrreps; irrep_alpha++){
-               
-               const int irrep_beta   = Irreps::directProd( irrep_alpha, productirrep );
-               const int NumDMRGalpha = localIdx->getNDMRG( irrep_alpha );
-               const int NumDMRGbeta  = localIdx->getNDMRG( irrep_beta  );
-               
-               for (int alpha = 0; alpha < NumDMRGalpha; alpha++){
-               
-                  const int DMRGalpha = localIdx->getDMRGcumulative( irrep_alpha ) + alpha;
-                  const int relalpha  = localIdx->getNOCC( irrep_alpha ) + alpha;
-                  
-                  for (int beta = 0; beta < NumDMRGbeta; beta++){
-                  
-                     const int DMRGbeta = localIdx->getDMRGcumulative( irrep_beta ) + beta;
-                     const int relbeta  = localIdx->getNOCC( irrep_beta ) + beta;
-                     
-                     const double TwoDMvalue1  = local2DM[ DMRGindexR + totOrbDMRG * ( DMRGalpha + totOrbDMRG * ( DMRGindexP + totOrbDMRG * DMRGbeta ) ) ];
-                     const double TwoDMvalue23 = local2DM[ DMRGindexR + totOrbDMRG * ( DMRGalpha + totOrbDMRG * ( DMRGbeta + totOrbDMRG * DMRGindexP ) ) ]
-                                               + local2DM[ DMRGindexR + totOrbDMRG * ( DMRGindexP + totOrbDMRG * ( DMRGbeta + totOrbDMRG * DMRGalpha ) ) ];
-                     
-                     for (int relindexS = 0; relindexS < NumOCCrs; relindexS++){
-                        for (int relindexQ = 0; relindexQ < NumOCCpq; relindexQ++){
-                           subblock[ relindexQ + NumORBpq * relindexS ] +=
-                              2 * ( TwoDMvalue1  * theInts->FourIndexAPI( irrep_pq, irrep_alpha, irrep_rs, irrep_beta, relindexQ, relalpha, relindexS, relbeta)
-                                  + TwoDMvalue23 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_alpha, irrep_beta, relindexQ, relindexS, relalpha, relbeta) );
-                        }
-                        for (int relindexQ = NumCOREpq; relindexQ < NumORBpq; relindexQ++){
-                           subblock[ relindexQ + NumORBpq * relindexS ] +=
-                              2 * ( TwoDMvalue1  * theInts->FourIndexAPI( irrep_pq, irrep_alpha, irrep_rs, irrep_beta, relindexQ, relalpha, relindexS, relbeta)
-                                  + TwoDMvalue23 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_alpha, irrep_beta, relindexQ, relindexS, relalpha, relbeta) );
-                        }
-                     }
-                     for (int relindexS = NumCORErs; relindexS < NumORBrs; relindexS++){
-                        for (int relindexQ = 0; relindexQ < NumOCCpq; relindexQ++){
-                           subblock[ relindexQ + NumORBpq * relindexS ] +=
-                              2 * ( TwoDMvalue1  * theInts->FourIndexAPI( irrep_pq, irrep_alpha, irrep_rs, irrep_beta, relindexQ, relalpha, relindexS, relbeta)
-                                  + TwoDMvalue23 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_alpha, irrep_beta, relindexQ, relindexS, relalpha, relbeta) );
-                        }
-                        for (int relindexQ = NumCOREpq; relindexQ < NumORBpq; relindexQ++){
-                           subblock[ relindexQ + NumORBpq * relindexS ] +=
-                              2 * ( TwoDMvalue1  * theInts->FourIndexAPI( irrep_pq, irrep_alpha, irrep_rs, irrep_beta, relindexQ, relalpha, relindexS, relbeta)
-                                  + TwoDMvalue23 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_alpha, irrep_beta, relindexQ, relindexS, relalpha, relbeta) );
-                        }
-                     }
-                  }
-               }
-            }
-         } // End combined P and R active
-         
-         // P active and R occupied  -->  Q occupied or virtual  //  S active or virtual
-         #pragma omp parallel for schedule(static)
-         for (int combined = 0; combined < NumDMRGpq*NumOCCrs; combined++){
-            
-            const int relindexP  = NumOCCpq + ( combined % NumDMRGpq );
-            const int relindexR  = combined / NumDMRGpq;
-            double * subblock    = localwtilde->getBlock( irrep_pq, irrep_rs, relindexP, relindexR );
-            const int DMRGindexP = relindexP - NumOCCpq + localIdx->getDMRGcumulative( irrep_pq );
-            
-            for (int alpha = 0; alpha < NumDMRGpq; alpha++){
-            
-               const int DMRGalpha     = localIdx->getDMRGcumulative( irrep_pq ) + alpha;
-               const int relalpha      = localIdx->getNOCC( irrep_pq ) + alpha;
-               const double OneDMvalue = local1DM[ DMRGalpha + totOrbDMRG * DMRGindexP ];
-               
-               for (int relindexS = NumOCCrs; relindexS < NumORBrs; relindexS++){
-                  for (int relindexQ = 0; relindexQ < NumOCCpq; relindexQ++){
-                     subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue *
-                         ( 4 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_pq, irrep_rs, relindexQ, relindexS, relalpha, relindexR)
-                             - theInts->FourIndexAPI( irrep_pq, irrep_pq, irrep_rs, irrep_rs, relindexQ, relalpha, relindexS, relindexR)
-                             - theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_rs, irrep_pq, relindexQ, relindexS, relindexR, relalpha) );
-                  }
-                  for (int relindexQ = NumCOREpq; relindexQ < NumORBpq; relindexQ++){
-                     subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue *
-                         ( 4 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_pq, irrep_rs, relindexQ, relindexS, relalpha, relindexR)
-                             - theInts->FourIndexAPI( irrep_pq, irrep_pq, irrep_rs, irrep_rs, relindexQ, relalpha, relindexS, relindexR)
-                             - theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_rs, irrep_pq, relindexQ, relindexS, relindexR, relalpha) );
-                  }
-               }
-            }
-         } // End combined P active and R occupied
-         
-         // P occupied and R active  -->  Q active or virtual  //  S occupied or virtual
-         #pragma omp parallel for schedule(static)
-         for (int combined = 0; combined < NumOCCpq*NumDMRGrs; combined++){
-            
-            const int relindexP  = combined % NumOCCpq;
-            const int relindexR  = NumOCCrs + ( combined / NumOCCpq );
-            double * subblock    = localwtilde->getBlock( irrep_pq, irrep_rs, relindexP, relindexR );
-            const int DMRGindexR = relindexR - NumOCCrs + localIdx->getDMRGcumulative( irrep_rs );
-            
-            for (int beta = 0; beta < NumDMRGrs; beta++){
-            
-               const int DMRGbeta      = localIdx->getDMRGcumulative( irrep_rs ) + beta;
-               const int relbeta       = localIdx->getNOCC( irrep_rs ) + beta;
-               const double OneDMvalue = local1DM[ DMRGindexR + totOrbDMRG * DMRGbeta ];
-               
-               for (int relindexQ = NumOCCpq; relindexQ < NumORBpq; relindexQ++){
-                  for (int relindexS = 0; relindexS < NumOCCrs; relindexS++){
-                     subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue *
-                         ( 4 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_pq, irrep_rs, relindexQ, relindexS, relindexP, relbeta)
-                             - theInts->FourIndexAPI( irrep_pq, irrep_pq, irrep_rs, irrep_rs, relindexQ, relindexP, relindexS, relbeta)
-                             - theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_rs, irrep_pq, relindexQ, relindexS, relbeta, relindexP) );
-                  }
-                  for (int relindexS = NumCORErs; relindexS < NumORBrs; relindexS++){
-                     subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue *
-                         ( 4 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_pq, irrep_rs, relindexQ, relindexS, relindexP, relbeta)
-                             - theInts->FourIndexAPI( irrep_pq, irrep_pq, irrep_rs, irrep_rs, relindexQ, relindexP, relindexS, relbeta)
-                             - theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_rs, irrep_pq, relindexQ, relindexS, relbeta, relindexP) );
-                  }
-               }
-            }
-         } // End combined P occupied and R active
-         
-      }
-   }
+   localwtilde->build( localTmat, localJKocc, localJKact, theInts, local2DM, local1DM ); // Computes all subblocks if the tensor is stored
 
 }
 
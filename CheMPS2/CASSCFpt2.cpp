@@ -24,6 +24,8 @@
 #include <algorithm>
 #include <sys/stat.h>
 #include <assert.h>
+#include <stdio.h>
+#include <sstream>
 
 #include "CASSCF.h"
 #include "DMRG.h"
@@ -40,8 +42,17 @@ using std::ifstream;
 using std::cout;
 using std::endl;
 using std::max;
+using std::min;
 
-void CheMPS2::CASSCF::write_f4rdm_checkpoint( const string f4rdm_file, int * hamorb1, int * hamorb2, const int tot_dmrg_power6, double * contract ){
+int CheMPS2::CASSCF::f4rdm_pair_index( const int LAS, const int orb1, const int orb2 ){
+
+   // The LAS diagonal pairs ( orb, orb ) come first, followed by the off-diagonal pairs orb1 < orb2 in lexicographic order
+   if ( orb1 == orb2 ){ return orb1; }
+   return LAS + ( orb1 * ( 2 * LAS - orb1 - 1 ) ) / 2 + ( orb2 - orb1 - 1 );
+
+}
+
+void CheMPS2::CASSCF::write_f4rdm_checkpoint( const string f4rdm_file, const int num_pairs, int * done, const int tot_dmrg_power6, double * contract ){
 
    #ifdef CHEMPS2_MPI_COMPILATION
       const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
@@ -54,20 +65,13 @@ void CheMPS2::CASSCF::write_f4rdm_checkpoint( const string f4rdm_file, int * ham
       hid_t file_id  = H5Fcreate( f4rdm_file.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
       hid_t group_id = H5Gcreate( file_id, "/F4RDM", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
 
-      hsize_t dimarray1   = 1;
+      hsize_t dimarray1   = num_pairs;
       hid_t dataspace1_id = H5Screate_simple( 1, &dimarray1, NULL );
-      hid_t dataset1_id   = H5Dcreate( group_id, "hamorb1", H5T_NATIVE_INT, dataspace1_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-      H5Dwrite( dataset1_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, hamorb1 );
+      hid_t dataset1_id   = H5Dcreate( group_id, "done", H5T_NATIVE_INT, dataspace1_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+      H5Dwrite( dataset1_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, done );
       H5Dclose( dataset1_id );
       H5Sclose( dataspace1_id );
 
-      hsize_t dimarray2   = 1;
-      hid_t dataspace2_id = H5Screate_simple( 1, &dimarray2, NULL );
-      hid_t dataset2_id   = H5Dcreate( group_id, "hamorb2", H5T_NATIVE_INT, dataspace2_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-      H5Dwrite( dataset2_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, hamorb2 );
-      H5Dclose( dataset2_id );
-      H5Sclose( dataspace2_id );
-
       hsize_t dimarray3   = tot_dmrg_power6;
       hid_t dataspace3_id = H5Screate_simple( 1, &dimarray3, NULL );
       hid_t dataset3_id   = H5Dcreate( group_id, "contract", H5T_NATIVE_DOUBLE, dataspace3_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
@@ -78,13 +82,15 @@ void CheMPS2::CASSCF::write_f4rdm_checkpoint( const string f4rdm_file, int * ham
       H5Gclose( group_id );
       H5Fclose( file_id );
 
-      cout << "Created F.4-RDM checkpoint file " << f4rdm_file << " at next orbitals ( " << hamorb1[ 0 ] << " , " << hamorb2[ 0 ] << " )." << endl;
+      int num_done = 0;
+      for ( int pair = 0; pair < num_pairs; pair++ ){ num_done += done[ pair ]; }
+      cout << "Created F.4-RDM checkpoint file " << f4rdm_file << " with " << num_done << " of " << num_pairs << " orbital pairs completed." << endl;
 
    }
 
 }
 
-bool CheMPS2::CASSCF::read_f4rdm_checkpoint( const string f4rdm_file, int * hamorb1, int * hamorb2, const int tot_dmrg_power6, double * contract ){
+bool CheMPS2::CASSCF::read_f4rdm_checkpoint( const string f4rdm_file, const int LAS, int * done, const int tot_dmrg_power6, double * contract ){
 
    #ifdef CHEMPS2_MPI_COMPILATION
       const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
@@ -92,6 +98,8 @@ bool CheMPS2::CASSCF::read_f4rdm_checkpoint( const string f4rdm_file, int * hamo
       const bool am_i_master = true;
    #endif
 
+   const int num_pairs = ( LAS * ( LAS + 1 ) ) / 2;
+
    // Check whether the file exists
    int exists = 0;
    if ( am_i_master ){
@@ -108,86 +116,234 @@ bool CheMPS2::CASSCF::read_f4rdm_checkpoint( const string f4rdm_file, int * hamo
 
    if ( am_i_master ){
 
-      hid_t file_id  = H5Fopen( f4rdm_file.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
-      hid_t group_id = H5Gopen( file_id, "/F4RDM", H5P_DEFAULT );
+      load_f4rdm_file( f4rdm_file, LAS, done, contract );
+
+      // Add the partial files of the MPI process groups of an interrupted fock_dot_4rdm, which contain other orbital pairs
+      int num_groups = 1;
+      struct stat file_info;
+      while ( stat( f4rdm_group_file( f4rdm_file, num_groups ).c_str(), &file_info ) == 0 ){ num_groups++; }
+      if ( num_groups > 1 ){
+         int * group_done = new int[ num_pairs ];
+         double * group_contract = new double[ tot_dmrg_power6 ];
+         for ( int group = 1; group < num_groups; group++ ){
+            load_f4rdm_file( f4rdm_group_file( f4rdm_file, group ), LAS, group_done, group_contract );
+            for ( int pair = 0; pair < num_pairs; pair++ ){
+               assert(( done[ pair ] == 0 ) || ( group_done[ pair ] == 0 ));
+               done[ pair ] += group_done[ pair ];
+            }
+            for ( int elem = 0; elem < tot_dmrg_power6; elem++ ){ contract[ elem ] += group_contract[ elem ]; }
+         }
+         delete [] group_done;
+         delete [] group_contract;
+         merge_f4rdm_checkpoint( f4rdm_file, num_pairs, done, tot_dmrg_power6, contract );
+      }
+
+   }
+   #ifdef CHEMPS2_MPI_COMPILATION
+   MPIchemps2::broadcast_array_int( done, num_pairs, MPI_CHEMPS2_MASTER );
+   MPIchemps2::broadcast_array_double( contract, tot_dmrg_power6, MPI_CHEMPS2_MASTER );
+   #endif
+
+   return true; // Loaded
+
+}
+
+void CheMPS2::CASSCF::load_f4rdm_file( const string f4rdm_file, const int LAS, int * done, double * contract ){
+
+   const int num_pairs = ( LAS * ( LAS + 1 ) ) / 2;
 
+   hid_t file_id  = H5Fopen( f4rdm_file.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+   hid_t group_id = H5Gopen( file_id, "/F4RDM", H5P_DEFAULT );
+
+   if ( H5Lexists( group_id, "done", H5P_DEFAULT ) > 0 ){
+      hid_t dataset1_id = H5Dopen( group_id, "done", H5P_DEFAULT );
+      H5Dread( dataset1_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, done );
+      H5Dclose( dataset1_id );
+   } else { // Older checkpoint files contain the next pair ( hamorb1, hamorb2 ); all pairs before it are done
+      int hamorb1 = 0;
+      int hamorb2 = 0;
       hid_t dataset1_id = H5Dopen( group_id, "hamorb1", H5P_DEFAULT );
-      H5Dread( dataset1_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, hamorb1 );
+      H5Dread( dataset1_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &hamorb1 );
       H5Dclose( dataset1_id );
-
       hid_t dataset2_id = H5Dopen( group_id, "hamorb2", H5P_DEFAULT );
-      H5Dread( dataset2_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, hamorb2 );
+      H5Dread( dataset2_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &hamorb2 );
       H5Dclose( dataset2_id );
+      const int next = f4rdm_pair_index( LAS, hamorb1, hamorb2 );
+      for ( int pair = 0; pair < num_pairs; pair++ ){ done[ pair ] = (( pair < next ) ? 1 : 0 ); }
+   }
 
-      hid_t dataset3_id = H5Dopen( group_id, "contract", H5P_DEFAULT );
-      H5Dread( dataset3_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, contract );
-      H5Dclose( dataset3_id );
+   hid_t dataset3_id = H5Dopen( group_id, "contract", H5P_DEFAULT );
+   H5Dread( dataset3_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, contract );
+   H5Dclose( dataset3_id );
 
-      H5Gclose( group_id );
-      H5Fclose( file_id );
+   H5Gclose( group_id );
+   H5Fclose( file_id );
+
+}
+
+string CheMPS2::CASSCF::f4rdm_group_file( const string f4rdm_file, const int group ){
+
+   std::stringstream filename;
+   filename << f4rdm_file << ".group" << group;
+   return filename.str();
+
+}
+
+void CheMPS2::CASSCF::merge_f4rdm_checkpoint( const string f4rdm_file, const int num_pairs, int * done, const int tot_dmrg_power6, double * contract ){
 
-   }
    #ifdef CHEMPS2_MPI_COMPILATION
-   MPIchemps2::broadcast_array_int( hamorb1, 1, MPI_CHEMPS2_MASTER );
-   MPIchemps2::broadcast_array_int( hamorb2, 1, MPI_CHEMPS2_MASTER );
-   MPIchemps2::broadcast_array_double( contract, tot_dmrg_power6, MPI_CHEMPS2_MASTER );
+      const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
+   #else
+      const bool am_i_master = true;
    #endif
 
-   return true; // Loaded
+   if ( am_i_master ){
 
-}
+      /* The old checkpoint file and the partial files contain disjoint sets of orbital pairs. The partial files are removed from the last
+         one on, so that they remain numbered from 1, and the new checkpoint file only replaces the old one after all of them are gone. */
+      const string temp_file = f4rdm_file + ".tmp";
+      write_f4rdm_checkpoint( temp_file, num_pairs, done, tot_dmrg_power6, contract );
+      int num_groups = 1;
+      struct stat file_info;
+      while ( stat( f4rdm_group_file( f4rdm_file, num_groups ).c_str(), &file_info ) == 0 ){ num_groups++; }
+      for ( int group = num_groups - 1; group > 0; group-- ){ remove( f4rdm_group_file( f4rdm_file, group ).c_str() ); }
+      rename( temp_file.c_str(), f4rdm_file.c_str() );
 
-void CheMPS2::CASSCF::fock_dot_4rdm( double * fockmx, CheMPS2::DMRG * dmrgsolver, CheMPS2::Hamiltonian * ham, int next_orb1, int next_orb2, double * work, double * result, const bool CHECKPOINT, const bool PSEUDOCANONICAL ){
+   }
 
-   const int LAS = ham->getL();
-   int size      = LAS * LAS * LAS * LAS * LAS * LAS;
-   int inc1      = 1;
+}
 
-   for ( int diag = 0; diag < LAS; diag++ ){
-      if (( next_orb1 == diag ) && ( next_orb2 == diag )){
-         double prefactor = 0.5 * fockmx[ diag + LAS * diag ];
-         if ( fabs( prefactor ) > 0.0 ){
-            dmrgsolver->Symm4RDM( work, diag, diag, false );
-            daxpy_( &size, &prefactor, work, &inc1, result, &inc1 );
-         }
-         if ( diag == LAS - 1 ){
-            next_orb1 = 0;
-            next_orb2 = 1;
-         } else {
-            next_orb1 = diag + 1;
-            next_orb2 = diag + 1;
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::CASSCF::fock_dot_4rdm( double * fockmx, CheMPS2::DMRG * dmrgsolver, CheMPS2::Hamiltonian * ham, int * done, double * work, double * result, const bool CHECKPOINT, const bool PSEUDOCANONICAL, const int num_groups ){
+#else
+void CheMPS2::CASSCF::fock_dot_4rdm( double * fockmx, CheMPS2::DMRG * dmrgsolver, CheMPS2::Hamiltonian * ham, int * done, double * work, double * result, const bool CHECKPOINT, const bool PSEUDOCANONICAL, const int ){
+#endif
+
+   const int LAS       = ham->getL();
+   const int num_pairs = ( LAS * ( LAS + 1 ) ) / 2;
+   int size            = LAS * LAS * LAS * LAS * LAS * LAS;
+   int inc1            = 1;
+
+   int * completed = new int[ num_pairs ];
+   for ( int pair = 0; pair < num_pairs; pair++ ){ completed[ pair ] = (( done == NULL ) ? 0 : done[ pair ] ); }
+
+   // The diagonal pairs are contracted together, with a single Fock-applied MPS
+   double * diag_fock = new double[ LAS ];
+   bool diag_todo = false;
+   for ( int orb = 0; orb < LAS; orb++ ){
+      const int pair = f4rdm_pair_index( LAS, orb, orb );
+      diag_fock[ orb ] = (( completed[ pair ] == 0 ) ? 0.5 * fockmx[ orb + LAS * orb ] : 0.0 );
+      if ( fabs( diag_fock[ orb ] ) > 0.0 ){ diag_todo = true; }
+      completed[ pair ] = 1;
+   }
+   if ( diag_todo ){
+      double one = 1.0;
+      dmrgsolver->DiagFock4RDM( work, diag_fock, false );
+      daxpy_( &size, &one, work, &inc1, result, &inc1 );
+      if ( CHECKPOINT ){ write_f4rdm_checkpoint( CheMPS2::DMRGSCF_f4rdm_name, num_pairs, completed, size, result ); }
+   }
+   delete [] diag_fock;
+
+   // Each off-diagonal orbital pair ( orb1 < orb2 ) with a contribution is an independent task; the completed pairs are recorded, so that a checkpoint does not depend on the order of the pairs
+   int num_tasks = 0;
+   int * tasks = new int[ num_pairs ];
+   for ( int orb1 = 0; orb1 < LAS; orb1++ ){
+      for ( int orb2 = orb1 + 1; orb2 < LAS; orb2++ ){
+         const int pair = f4rdm_pair_index( LAS, orb1, orb2 );
+         if ( completed[ pair ] == 0 ){
+            const double prefactor = 0.5 * ( fockmx[ orb1 + LAS * orb2 ] + fockmx[ orb2 + LAS * orb1 ] );
+            const bool calculate = (( ham->getOrbitalIrrep( orb1 ) == ham->getOrbitalIrrep( orb2 ) ) && ( fabs( prefactor ) > 0.0 ) && ( PSEUDOCANONICAL == false ));
+            if ( calculate ){
+               tasks[ num_tasks ] = orb1 + LAS * orb2;
+               num_tasks++;
+            } else {
+               completed[ pair ] = 1;
+            }
          }
-         if ( CHECKPOINT ){ write_f4rdm_checkpoint( CheMPS2::DMRGSCF_f4rdm_name, &next_orb1, &next_orb2, size, result ); }
       }
    }
 
-   if ( PSEUDOCANONICAL == false ){
-      for ( int orb1 = 0; orb1 < LAS; orb1++ ){
-         for ( int orb2 = orb1 + 1; orb2 < LAS; orb2++ ){
-            if (( next_orb1 == orb1 ) && ( next_orb2 == orb2 )){
-               double prefactor = 0.5 * ( fockmx[ orb1 + LAS * orb2 ] + fockmx[ orb2 + LAS * orb1 ] );
-               if (( ham->getOrbitalIrrep( orb1 ) == ham->getOrbitalIrrep( orb2 ) ) && ( fabs( prefactor ) > 0.0 )){
-                  dmrgsolver->Symm4RDM( work, orb1, orb2, false );
-                  daxpy_( &size, &prefactor, work, &inc1, result, &inc1 );
-               }
-               if ( orb2 == LAS - 1 ){
-                  next_orb1 = next_orb1 + 1;
-                  next_orb2 = next_orb1 + 1;
-               } else {
-                  next_orb2 = next_orb2 + 1;
-               }
-               if (( ham->getOrbitalIrrep( orb1 ) == ham->getOrbitalIrrep( orb2 ) ) && ( CHECKPOINT )){
-                  write_f4rdm_checkpoint( CheMPS2::DMRGSCF_f4rdm_name, &next_orb1, &next_orb2, size, result );
-               }
-            }
-         }
+   /* With MPI, the tasks can be distributed over groups of processes, each of which works on its own copy of the DMRG wavefunction. The groups fetch
+      the next task from a counter at the master process. Only the first process of a group adds the contributions to result, which starts from zero
+      except on the master process. Group 0 updates the checkpoint file, and the other groups store their own pairs in partial files until the end. */
+   int group = 0;
+   int * group_done = NULL;
+   bool accumulate = true;
+   #ifdef CHEMPS2_MPI_COMPILATION
+   const int groups = max( 1, min( num_groups, min( MPIchemps2::mpi_size(), num_tasks ) ) );
+   MPI_Win queue;
+   if ( groups > 1 ){
+      if ( CHECKPOINT ){ write_f4rdm_checkpoint( CheMPS2::DMRGSCF_f4rdm_name, num_pairs, completed, size, result ); } // Exists before the partial files
+      group = MPIchemps2::mpi_split_groups( groups );
+      accumulate = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
+      if (( group > 0 ) || ( accumulate == false )){
+         for ( int elem = 0; elem < size; elem++ ){ result[ elem ] = 0.0; }
       }
+      if ( group > 0 ){
+         group_done = new int[ num_pairs ];
+         for ( int pair = 0; pair < num_pairs; pair++ ){ group_done[ pair ] = 0; }
+         if ( CHECKPOINT ){ write_f4rdm_checkpoint( f4rdm_group_file( CheMPS2::DMRGSCF_f4rdm_name, group ), num_pairs, group_done, size, result ); }
+      }
+      queue = MPIchemps2::task_counter_create(); // After all partial files exist
+   }
+   #endif
+
+   for ( int next = 0; next <= num_tasks; next++ ){
+      int task = next;
+      #ifdef CHEMPS2_MPI_COMPILATION
+      if ( groups > 1 ){
+         if ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER ){ task = MPIchemps2::task_counter_next( queue ); }
+         MPIchemps2::broadcast_array_int( &task, 1, MPI_CHEMPS2_MASTER );
+      }
+      #endif
+      if ( task >= num_tasks ){ break; }
+      const int orb1 = tasks[ task ] % LAS;
+      const int orb2 = tasks[ task ] / LAS;
+      const int pair = f4rdm_pair_index( LAS, orb1, orb2 );
+      double prefactor = 0.5 * ( fockmx[ orb1 + LAS * orb2 ] + fockmx[ orb2 + LAS * orb1 ] );
+      dmrgsolver->Symm4RDM( work, orb1, orb2, false );
+      if ( accumulate ){ daxpy_( &size, &prefactor, work, &inc1, result, &inc1 ); }
+      completed[ pair ] = 1;
+      if ( group_done != NULL ){ group_done[ pair ] = 1; }
+      if ( CHECKPOINT ){
+         if ( group == 0 ){ write_f4rdm_checkpoint( CheMPS2::DMRGSCF_f4rdm_name, num_pairs, completed, size, result ); }
+         else { write_f4rdm_checkpoint( f4rdm_group_file( CheMPS2::DMRGSCF_f4rdm_name, group ), num_pairs, group_done, size, result ); }
+      }
+   }
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( groups > 1 ){ // All tasks have been fetched and completed: add the partial contractions of the groups
+      MPIchemps2::task_counter_free( queue );
+      MPIchemps2::mpi_merge_groups();
+      MPIchemps2::reduce_array_double( result, work, size, MPI_CHEMPS2_MASTER );
+      if ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER ){ dcopy_( &size, work, &inc1, result, &inc1 ); }
+      MPIchemps2::broadcast_array_double( result, size, MPI_CHEMPS2_MASTER );
+      for ( int task = 0; task < num_tasks; task++ ){ completed[ f4rdm_pair_index( LAS, tasks[ task ] % LAS, tasks[ task ] / LAS ) ] = 1; }
+      if ( CHECKPOINT ){ merge_f4rdm_checkpoint( CheMPS2::DMRGSCF_f4rdm_name, num_pairs, completed, size, result ); }
    }
+   #endif
+   if ( group_done != NULL ){ delete [] group_done; }
+   delete [] tasks;
+
+   if ( done != NULL ){
+      for ( int pair = 0; pair < num_pairs; pair++ ){ done[ pair ] = completed[ pair ]; }
+   }
+   delete [] completed;
 
 }
 
 double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int Irrep, ConvergenceScheme * OptScheme, const int rootNum, DMRGSCFoptions * scf_options, const double IPEA, const double IMAG, const bool PSEUDOCANONICAL, const bool CHECKPOINT, const bool CUMULANT ){
 
+   double E_CASPT2 = 0.0;
+   caspt2( Nelectrons, TwoS, Irrep, OptScheme, rootNum, scf_options, 1, &IPEA, &IMAG, &E_CASPT2, PSEUDOCANONICAL, CHECKPOINT, CUMULANT );
+   return E_CASPT2;
+
+}
+
+void CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int Irrep, ConvergenceScheme * OptScheme, const int rootNum, DMRGSCFoptions * scf_options, const int num_shifts, const double * IPEA, const double * IMAG, double * E_CASPT2, const bool PSEUDOCANONICAL, const bool CHECKPOINT, const bool CUMULANT ){
+
+   assert( num_shifts >= 1 );
+
    #ifdef CHEMPS2_MPI_COMPILATION
       const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
    #else
@@ -201,12 +357,13 @@ double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int
       if ( am_i_master ){
          cout << "CheMPS2::CASSCF::caspt2 : There are no CASPT2 excitations between the CORE, ACTIVE, and VIRTUAL orbital spaces." << endl;
       }
-      return 0.0;
+      for ( int shift = 0; shift < num_shifts; shift++ ){ E_CASPT2[ shift ] = 0.0; }
+      return;
    }
 
    //Determine the maximum NORB(irrep) and the max_block_size for the ERI orbital rotation
    const int maxlinsize      = iHandler->getNORBmax();
-   const long long fullsize  = ((long long) maxlinsize ) * ((long long) maxlinsize ) * ((long long) maxlinsize ) * ((long long) maxlinsize );
+   const long long fullsize  = ((long long) maxlinsize ) * ((long long) maxlinsize ) * ((long long) maxlinsize ) * (( CHOL_ORIG != NULL ) ? 1 : ((long long) maxlinsize )); // Three-index ERI are assembled in blocks of rows
    const string tmp_filename = tmp_folder + "/" + CheMPS2::DMRGSCF_eri_storage_name;
    const int dmrgsize_power4 = nOrbDMRG * nOrbDMRG * nOrbDMRG * nOrbDMRG;
    //For (ERI rotation, update unitary, block diagonalize, orbital localization)
@@ -251,7 +408,7 @@ double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int
    buildQmatOCC();
    fillConstAndTmatDMRG( HamAS );
    if ( am_i_master ){
-      DMRGSCFrotations::rotate( VMAT_ORIG, HamAS->getVmat(), NULL, 'A', 'A', 'A', 'A', iHandler, unitary, mem1, mem2, work_mem_size, tmp_filename );
+      rotate_eri( HamAS->getVmat(), NULL, 'A', 'A', 'A', 'A', mem1, mem2, work_mem_size, tmp_filename );
    }
    #ifdef CHEMPS2_MPI_COMPILATION
    HamAS->getVmat()->broadcast( MPI_CHEMPS2_MASTER );
@@ -277,45 +434,54 @@ double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int
    double * contract = new double[ tot_dmrg_power6 ];
    for ( int cnt = 0; cnt < tot_dmrg_power6; cnt++ ){ contract[ cnt ] = 0.0; }
 
-   int next_hamorb1 = 0;
-   int next_hamorb2 = 0;
+   const int num_f4rdm_pairs = ( nOrbDMRG * ( nOrbDMRG + 1 ) ) / 2;
+   int * f4rdm_done = new int[ num_f4rdm_pairs ];
+   for ( int pair = 0; pair < num_f4rdm_pairs; pair++ ){ f4rdm_done[ pair ] = 0; }
    const bool make_checkpt = (( CUMULANT == false ) && ( CHECKPOINT ));
    bool checkpt_loaded = false;
    if ( make_checkpt ){
       assert(( OptScheme != NULL ) || ( rootNum > 1 ));
-      checkpt_loaded = read_f4rdm_checkpoint( CheMPS2::DMRGSCF_f4rdm_name, &next_hamorb1, &next_hamorb2, tot_dmrg_power6, contract );
+      checkpt_loaded = read_f4rdm_checkpoint( CheMPS2::DMRGSCF_f4rdm_name, nOrbDMRG, f4rdm_done, tot_dmrg_power6, contract );
    }
 
    // Solve the active space problem
-   if (( OptScheme == NULL ) && ( rootNum == 1 )){ // Do FCI
+   if ( OptScheme == NULL ){ // Do FCI
 
-      if ( am_i_master ){
+      { // All MPI processes take part in the matrix-vector products and in the 3-RDM and F.4-RDM; the master process calculates the 2-RDM
          const int nalpha = ( num_elec + TwoS ) / 2;
          const int nbeta  = ( num_elec - TwoS ) / 2;
          const double workmem = 1000.0; // 1GB
-         const int verbose = 2;
-         CheMPS2::FCI * theFCI = new CheMPS2::FCI( HamAS, nalpha, nbeta, Irrep, workmem, verbose );
+         const int verbose = (( am_i_master ) ? 2 : 0 );
+         CheMPS2::FCI * theFCI = new CheMPS2::FCI( HamAS, nalpha, nbeta, Irrep, workmem, verbose, true );
          double * inoutput = new double[ theFCI->getVecLength(0) ];
-         theFCI->ClearVector( theFCI->getVecLength(0), inoutput );
-         inoutput[ theFCI->LowestEnergyDeterminant() ] = 1.0;
-         E_CASSCF = theFCI->GSDavidson( inoutput );
-         theFCI->Fill2RDM( inoutput, DMRG2DM );                     // 2-RDM
-         theFCI->Fill3RDM( inoutput, three_dm );                    // 3-RDM
-         setDMRG1DM( num_elec, nOrbDMRG, DMRG1DM, DMRG2DM );        // 1-RDM
+         if ( rootNum == 1 ){
+            theFCI->ClearVector( theFCI->getVecLength(0), inoutput );
+            inoutput[ theFCI->LowestEnergyDeterminant() ] = 1.0;
+            if ( scf_options->getSpinAdaptFCI() ){ theFCI->SpinAdapt( TwoS ); } // Davidson in the basis of configuration state functions with spin TwoS / 2
+            E_CASSCF = theFCI->GSDavidson( inoutput );
+         } else { // The last root, in the spin sector TwoS
+            double ** roots = new double*[ rootNum ];
+            double * energies = new double[ rootNum ];
+            for ( int state = 0; state < rootNum - 1; state++ ){ roots[ state ] = new double[ theFCI->getVecLength(0) ]; }
+            roots[ rootNum - 1 ] = inoutput;
+            theFCI->MultiRootDavidson( rootNum, roots, energies, false, CheMPS2::FCI_SPIN_PENALTY );
+            E_CASSCF = energies[ rootNum - 1 ];
+            for ( int state = 0; state < rootNum - 1; state++ ){ delete [] roots[ state ]; }
+            delete [] roots;
+            delete [] energies;
+         }
+         if ( am_i_master ){ theFCI->Fill2RDM( inoutput, DMRG2DM ); }  // 2-RDM
+         #ifdef CHEMPS2_MPI_COMPILATION
+         MPIchemps2::broadcast_array_double( DMRG2DM, dmrgsize_power4, MPI_CHEMPS2_MASTER );
+         #endif
+         setDMRG1DM( num_elec, nOrbDMRG, DMRG1DM, DMRG2DM );           // 1-RDM
          buildQmatACT();
          construct_fock( theFmatrix, theTmatrix, theQmatOCC, theQmatACT, iHandler );
-         copy_active( theFmatrix, mem2, iHandler );                 // Fock
-         theFCI->Fock4RDM( inoutput, three_dm, mem2, contract );    // trace( Fock * 4-RDM )
+         copy_active( theFmatrix, mem2, iHandler );                    // Fock
+         theFCI->Fill3RDMFock4RDM( inoutput, mem2, three_dm, contract ); // 3-RDM and trace( Fock * 4-RDM )
          delete theFCI;
          delete [] inoutput;
       }
-      #ifdef CHEMPS2_MPI_COMPILATION
-      MPIchemps2::broadcast_array_double( &E_CASSCF, 1, MPI_CHEMPS2_MASTER );
-      MPIchemps2::broadcast_array_double(  DMRG2DM, dmrgsize_power4, MPI_CHEMPS2_MASTER );
-      MPIchemps2::broadcast_array_double( three_dm, tot_dmrg_power6, MPI_CHEMPS2_MASTER );
-      MPIchemps2::broadcast_array_double( contract, tot_dmrg_power6, MPI_CHEMPS2_MASTER );
-      setDMRG1DM( num_elec, nOrbDMRG, DMRG1DM, DMRG2DM );
-      #endif
 
    } else { // Do the DMRG sweeps
 
@@ -336,7 +502,7 @@ double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int
       if ( CUMULANT ){
          CheMPS2::Cumulant::gamma4_fock_contract_ham( Prob, theDMRG->get3DM(), theDMRG->get2DM(), mem2, contract );
       } else {
-         fock_dot_4rdm( mem2, theDMRG, HamAS, next_hamorb1, next_hamorb2, three_dm, contract, make_checkpt, PSEUDOCANONICAL );
+         fock_dot_4rdm( mem2, theDMRG, HamAS, f4rdm_done, three_dm, contract, make_checkpt, PSEUDOCANONICAL, scf_options->getF4RDMGroups() );
       }
       theDMRG->get3DM()->fill_ham_index( 1.0, false, three_dm, 0, nOrbDMRG );
       if (( CheMPS2::DMRG_storeMpsOnDisk ) && ( make_checkpt == false )){ theDMRG->deleteStoredMPS(); }
@@ -344,6 +510,7 @@ double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int
       delete theDMRG;
 
    }
+   delete [] f4rdm_done;
 
    delete Prob;
    delete HamAS;
@@ -362,33 +529,37 @@ double CheMPS2::CASSCF::caspt2( const int Nelectrons, const int TwoS, const int
 
    // Calculate the matrix elements needed to calculate the CASPT2 V-vector
    if ( am_i_master ){
-      DMRGSCFrotations::rotate( VMAT_ORIG, NULL, theRotatedTEI, 'C', 'C', 'F', 'F', iHandler, unitary, mem1, mem2, work_mem_size, tmp_filename );
-      DMRGSCFrotations::rotate( VMAT_ORIG, NULL, theRotatedTEI, 'C', 'V', 'C', 'V', iHandler, unitary, mem1, mem2, work_mem_size, tmp_filename );
+      rotate_eri( NULL, theRotatedTEI, 'C', 'C', 'F', 'F', mem1, mem2, work_mem_size, tmp_filename );
+      rotate_eri( NULL, theRotatedTEI, 'C', 'V', 'C', 'V', mem1, mem2, work_mem_size, tmp_filename );
       delete_file( tmp_filename );
    }
 
    delete [] mem1;
    delete [] mem2;
 
-   double E_CASPT2 = 0.0;
-   if ( am_i_master ){
-      cout << "CASPT2 : Deviation from pseudocanonical = " << deviation_from_blockdiag( theFmatrix, iHandler ) << endl;
-      CheMPS2::CASPT2 * myCASPT2 = new CheMPS2::CASPT2( iHandler, theRotatedTEI, theTmatrix, theFmatrix, DMRG1DM, DMRG2DM, three_dm, contract, IPEA );
-      delete theRotatedTEI;
-      delete [] three_dm;
-      delete [] contract;
-      E_CASPT2 = myCASPT2->solve( IMAG );
-      delete myCASPT2;
-   } else {
-      delete theRotatedTEI;
-      delete [] three_dm;
-      delete [] contract;
+   #ifdef CHEMPS2_MPI_COMPILATION // All processes build the CASPT2 tensors from the RDMs and the Fock matrix of the master process
+   MPIchemps2::broadcast_array_double( DMRG1DM,  nOrbDMRG * nOrbDMRG, MPI_CHEMPS2_MASTER );
+   MPIchemps2::broadcast_array_double( DMRG2DM,  dmrgsize_power4, MPI_CHEMPS2_MASTER );
+   MPIchemps2::broadcast_array_double( three_dm, tot_dmrg_power6, MPI_CHEMPS2_MASTER );
+   MPIchemps2::broadcast_array_double( contract, tot_dmrg_power6, MPI_CHEMPS2_MASTER );
+   for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+      const int NORB = iHandler->getNORB( irrep );
+      MPIchemps2::broadcast_array_double( theFmatrix->getBlock( irrep ), NORB * NORB, MPI_CHEMPS2_MASTER );
    }
-   #ifdef CHEMPS2_MPI_COMPILATION
-   MPIchemps2::broadcast_array_double( &E_CASPT2, 1, MPI_CHEMPS2_MASTER );
    #endif
 
-   return E_CASPT2;
+   // The integrals are only used on the master process, which builds the RHS; the blocks and the vector segments are distributed over all processes
+   if ( am_i_master ){ cout << "CASPT2 : Deviation from pseudocanonical = " << deviation_from_blockdiag( theFmatrix, iHandler ) << endl; }
+   CheMPS2::CASPT2 * myCASPT2 = new CheMPS2::CASPT2( iHandler, theRotatedTEI, theTmatrix, theFmatrix, DMRG1DM, DMRG2DM, three_dm, contract, IPEA[ 0 ], scf_options->getCASPT2MaxMemMB(), tmp_folder, true );
+   delete theRotatedTEI;
+   delete [] three_dm;
+   delete [] contract;
+   if ( num_shifts == 1 ){
+      E_CASPT2[ 0 ] = myCASPT2->solve( IMAG[ 0 ] );
+   } else {
+      myCASPT2->solve_shifts( num_shifts, IPEA, IMAG, E_CASPT2 );
+   }
+   delete myCASPT2;
 
 }
 
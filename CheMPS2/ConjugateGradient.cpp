@@ -20,41 +20,92 @@
 #include <math.h>
 #include <stdlib.h>
 #include <iostream>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "ConjugateGradient.h"
+#include "MPIchemps2.h"
 
 using std::cout;
 using std::endl;
 
-CheMPS2::ConjugateGradient::ConjugateGradient( const int veclength_in, const double RTOL_in, const double DIAG_CUTOFF_in, const bool print_in ){
+CheMPS2::ConjugateGradient::ConjugateGradient( const long long veclength_in, const double RTOL_in, const double DIAG_CUTOFF_in, const bool print_in ){
 
    veclength = veclength_in;
    RTOL = RTOL_in;
    DIAG_CUTOFF = DIAG_CUTOFF_in;
    print = print_in;
+   distributed = false;
 
    state = 'I';
    num_matvec = 0;
 
-   XVEC   = new double[ veclength ];
-   PRECON = new double[ veclength ];
-   RHS    = new double[ veclength ];
-   WORK   = new double[ veclength ];
-   RESID  = new double[ veclength ];
-   PVEC   = new double[ veclength ];
-   OPVEC  = new double[ veclength ];
+   // The helper arrays are allocated in the first step, unless StoreVectorsOnDisk is called
+   XVEC   = NULL;
+   PRECON = NULL;
+   RHS    = NULL;
+   WORK   = NULL;
+   RESID  = NULL;
+   PVEC   = NULL;
+   OPVEC  = NULL;
+
+   disk_storage = NULL;
+   disk_bytes   = 0;
 
 }
 
 CheMPS2::ConjugateGradient::~ConjugateGradient(){
 
-   delete [] XVEC;
-   delete [] PRECON;
-   delete [] RHS;
-   delete [] WORK;
-   delete [] RESID;
-   delete [] PVEC;
-   delete [] OPVEC;
+   if ( disk_storage != NULL ){
+      munmap( disk_storage, disk_bytes ); // Contains all helper arrays
+   } else {
+      if ( XVEC   != NULL ){ delete [] XVEC;   }
+      if ( PRECON != NULL ){ delete [] PRECON; }
+      if ( RHS    != NULL ){ delete [] RHS;    }
+      if ( WORK   != NULL ){ delete [] WORK;   }
+      if ( RESID  != NULL ){ delete [] RESID;  }
+      if ( PVEC   != NULL ){ delete [] PVEC;   }
+      if ( OPVEC  != NULL ){ delete [] OPVEC;  }
+   }
+
+}
+
+bool CheMPS2::ConjugateGradient::StoreVectorsOnDisk( const std::string filename ){
+
+   assert( state == 'I' );
+   if ( disk_storage != NULL ){ return true; }
+
+   const size_t num_bytes = ( ( size_t ) veclength ) * 7 * sizeof( double );
+   const int fd = open( filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600 );
+   if ( fd < 0 ){ return false; }
+   unlink( filename.c_str() );
+   if ( ftruncate( fd, num_bytes ) != 0 ){ close( fd ); return false; }
+   void * mapping = mmap( NULL, num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+   close( fd );
+   if ( mapping == MAP_FAILED ){ return false; }
+
+   disk_storage = ( double * ) mapping;
+   disk_bytes   = num_bytes;
+   XVEC   = disk_storage;
+   PRECON = disk_storage + veclength;
+   RHS    = disk_storage + veclength * 2;
+   WORK   = disk_storage + veclength * 3;
+   RESID  = disk_storage + veclength * 4;
+   PVEC   = disk_storage + veclength * 5;
+   OPVEC  = disk_storage + veclength * 6;
+   if ( print ){ cout << "ConjugateGradient : The work vectors are stored in a memory-mapped file of " << num_bytes / 1048576.0 << " MB." << endl; }
+   return true;
+
+}
+
+void CheMPS2::ConjugateGradient::DistributeVectors(){
+
+   assert( state == 'I' );
+   #ifdef CHEMPS2_MPI_COMPILATION
+   distributed = ( MPIchemps2::mpi_size() > 1 );
+   #endif
 
 }
 
@@ -81,6 +132,15 @@ char CheMPS2::ConjugateGradient::step( double ** pointers ){
    */
 
    if ( state == 'I' ){
+      if ( disk_storage == NULL ){
+         XVEC   = new double[ veclength ];
+         PRECON = new double[ veclength ];
+         RHS    = new double[ veclength ];
+         WORK   = new double[ (( veclength > 0 ) ? veclength : 1 ) ]; // Also returns the residual norm, when a process owns an empty segment
+         RESID  = new double[ veclength ];
+         PVEC   = new double[ veclength ];
+         OPVEC  = new double[ veclength ];
+      }
       pointers[0] = XVEC;
       pointers[1] = PRECON;
       pointers[2] = RHS;
@@ -145,15 +205,15 @@ void CheMPS2::ConjugateGradient::stepL2K(){
 
    apply_precon( OPVEC );                                    // OPVEC_old = ( PRECON * operator * PRECON ) * PVEC_old
    const double alpha = rdotr / inprod( PVEC, OPVEC );       // alpha = RESID_old^T * RESID_old / ( PVEC_old^T * ( PRECON * operator * PRECON ) * PVEC_old )
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       XVEC[ elem ] = XVEC[ elem ] + alpha * PVEC[ elem ];    // XVEC_new <-- XVEC_old + alpha * PVEC_old
    }
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       RESID[ elem ] = RESID[ elem ] - alpha * OPVEC[ elem ]; // RESID_new <-- RESID_old - alpha * ( PRECON * operator * PRECON ) * PVEC_old
    }
    const double new_rdotr = inprod( RESID );
    const double beta = new_rdotr / rdotr;                    // beta = RESID_new^T * RESID_new / ( RESID_old^T * RESID_old )
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       PVEC[ elem ] = RESID[ elem ] + beta * PVEC[ elem ];    // PVEC_new = RESID_new + beta * PVEC_old
    }
    rdotr = new_rdotr;
@@ -165,10 +225,11 @@ void CheMPS2::ConjugateGradient::stepL2K(){
 void CheMPS2::ConjugateGradient::stepY2Z(){
 
    rnorm = 0.0;
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       const double diff = OPVEC[ elem ] - RHS[ elem ];
       rnorm += diff * diff;
    }
+   sum_over_processes( rnorm );
    rnorm = sqrt( rnorm );
    if ( print ){ cout << "ConjugateGradient : At convergence the residual of O * x = RHS is " << rnorm << endl; }
 
@@ -177,10 +238,10 @@ void CheMPS2::ConjugateGradient::stepY2Z(){
 void CheMPS2::ConjugateGradient::stepJ2K(){
 
    apply_precon( OPVEC );                            // OPVEC = ( PRECON * operator * PRECON ) * XVEC
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       RESID[ elem ] = RESID[ elem ] - OPVEC[ elem ]; // RESID = ( precon * RHS ) - ( precon * operator * precon ) * XVEC
    }
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       PVEC[ elem ] = RESID[ elem ];                  // PVEC = RESID
    }
    rdotr = inprod( RESID );
@@ -191,7 +252,7 @@ void CheMPS2::ConjugateGradient::stepJ2K(){
 void CheMPS2::ConjugateGradient::stepG2H(){
 
    // PRECON = 1 / sqrt( diag ( operator ) )
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       if ( PRECON[ elem ] < DIAG_CUTOFF ){ PRECON[ elem ] = DIAG_CUTOFF; }
       PRECON[ elem ] = 1.0 / sqrt( PRECON[ elem ] );
    }
@@ -200,7 +261,7 @@ void CheMPS2::ConjugateGradient::stepG2H(){
    apply_precon( RHS, RESID );
 
    // XVEC = guess / PRECON
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       XVEC[ elem ] = XVEC[ elem ] / PRECON[ elem ];
    }
 
@@ -209,9 +270,10 @@ void CheMPS2::ConjugateGradient::stepG2H(){
 double CheMPS2::ConjugateGradient::inprod( double * vector ){
 
    double inproduct = 0.0;
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       inproduct += vector[ elem ] * vector[ elem ];
    }
+   sum_over_processes( inproduct );
    return inproduct;
 
 }
@@ -219,16 +281,33 @@ double CheMPS2::ConjugateGradient::inprod( double * vector ){
 double CheMPS2::ConjugateGradient::inprod( double * vector, double * othervector ){
 
    double inproduct = 0.0;
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       inproduct += vector[ elem ] * othervector[ elem ];
    }
+   sum_over_processes( inproduct );
    return inproduct;
 
 }
 
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::ConjugateGradient::sum_over_processes( double & value ) const{
+#else
+void CheMPS2::ConjugateGradient::sum_over_processes( double & ) const{
+#endif
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( distributed ){
+      double total = 0.0;
+      MPIchemps2::allreduce_array_double( &value, &total, 1 );
+      value = total;
+   }
+   #endif
+
+}
+
 void CheMPS2::ConjugateGradient::apply_precon( double * vector ){
 
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       vector[ elem ] = PRECON[ elem ] * vector[ elem ];
    }
 
@@ -236,7 +315,7 @@ void CheMPS2::ConjugateGradient::apply_precon( double * vector ){
 
 void CheMPS2::ConjugateGradient::apply_precon( double * vector, double * result ){
 
-   for ( int elem = 0; elem < veclength; elem++ ){
+   for ( long long elem = 0; elem < veclength; elem++ ){
       result[ elem ] = PRECON[ elem ] * vector[ elem ];
    }
 
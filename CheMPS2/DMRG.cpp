@@ -28,7 +28,9 @@
 #include <unistd.h>
 
 #include "DMRG.h"
+#include "HeffProfiler.h"
 #include "MPIchemps2.h"
+#include "Tracer.h"
 
 using std::cout;
 using std::endl;
@@ -89,6 +91,9 @@ CheMPS2::DMRG::DMRG( Problem * ProbIn, ConvergenceScheme * OptSchemeIn, const bo
    the2DM  = NULL;
    the3DM  = NULL;
    theCorr = NULL;
+   sweep_log = NULL;
+   log_instruction = 0;
+   log_sweep = 0;
    Exc_activated = false;
    makecheckpoints = makechkpt;
    tempfolder = tmpfolder;
@@ -220,8 +225,12 @@ double CheMPS2::DMRG::Solve(){
          num_double_read_disk  = 0;
          struct timeval start, end;
          EnergyPrevious = Energy;
+         log_instruction = instruction;
+         log_sweep = nIterations;
          gettimeofday( &start, NULL );
+         Tracer::begin( "left sweep", "dmrg" );
          Energy = sweepleft( change, instruction, am_i_master ); // Only relevant call in this block of code
+         Tracer::end( "left sweep", "dmrg" );
          gettimeofday( &end, NULL );
          double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
          if ( am_i_master ){
@@ -234,7 +243,9 @@ double CheMPS2::DMRG::Solve(){
             print_tensor_update_performance();
             cout << "***     Minimum energy           = " << LastMinEnergy << endl;
             cout << "***     Maximum discarded weight = " << MaxDiscWeightLastSweep << endl;
+            log_sweep_record( false, elapsed );
          }
+         HeffProfiler::print_sweep_summary();
          if ( Exc_activated ){ calc_overlaps( false ); }
          if ( am_i_master ){
             cout << "******************************************************************" << endl;
@@ -244,7 +255,9 @@ double CheMPS2::DMRG::Solve(){
          num_double_write_disk = 0;
          num_double_read_disk  = 0;
          gettimeofday( &start, NULL );
+         Tracer::begin( "right sweep", "dmrg" );
          Energy = sweepright( change, instruction, am_i_master ); // Only relevant call in this block of code
+         Tracer::end( "right sweep", "dmrg" );
          gettimeofday( &end, NULL );
          elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
          if ( am_i_master ){
@@ -258,7 +271,9 @@ double CheMPS2::DMRG::Solve(){
             cout << "***     Minimum energy           = " << LastMinEnergy << endl;
             cout << "***     Maximum discarded weight = " << MaxDiscWeightLastSweep << endl;
             cout << "***     Energy difference with respect to previous leftright sweep = " << fabs(Energy-EnergyPrevious) << endl;
+            log_sweep_record( true, elapsed );
          }
+         HeffProfiler::print_sweep_summary();
          if ( Exc_activated ){ calc_overlaps( true ); }
          if ( am_i_master ){
             cout << "******************************************************************" << endl;
@@ -276,6 +291,18 @@ double CheMPS2::DMRG::Solve(){
          cout << "***     Minimum energy encountered during the last sweep   = " << LastMinEnergy << endl;
          cout << "***     Maximum discarded weight during the last sweep     = " << MaxDiscWeightLastSweep << endl;
          cout << "******************************************************************" << endl;
+         if ( sweep_log != NULL ){
+            sweep_log->start( "instruction" );
+            sweep_log->add( "instruction", instruction );
+            sweep_log->add( "sweeps", nIterations );
+            sweep_log->add( "D", OptScheme->get_D( instruction ) );
+            sweep_log->add( "total_min_energy", TotalMinEnergy );
+            sweep_log->add( "last_min_energy", LastMinEnergy );
+            sweep_log->add( "max_discarded_weight", MaxDiscWeightLastSweep );
+            sweep_log->add( "energy_change", fabs( Energy - EnergyPrevious ) );
+            sweep_log->add_boolean( "converged", ( fabs( Energy - EnergyPrevious ) <= OptScheme->get_energy_conv( instruction ) ) );
+            sweep_log->write();
+         }
       }
 
    }
@@ -302,13 +329,6 @@ double CheMPS2::DMRG::sweepleft( const bool change, const int instruction, const
          cout << "Energy at sites (" << index << ", " << index + 1 << ") is " << Energy << endl;
       }
 
-      // Prepare for next step
-      struct timeval start, end;
-      gettimeofday( &start, NULL );
-      updateMovingLeftSafe( index );
-      gettimeofday( &end, NULL );
-      timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
-
    }
 
    return Energy;
@@ -333,13 +353,6 @@ double CheMPS2::DMRG::sweepright( const bool change, const int instruction, cons
          cout << "Energy at sites (" << index << ", " << index + 1 << ") is " << Energy << endl;
       }
 
-      // Prepare for next step
-      struct timeval start, end;
-      gettimeofday( &start, NULL );
-      updateMovingRightSafe( index );
-      gettimeofday( &end, NULL );
-      timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
-
    }
 
    return Energy;
@@ -349,38 +362,117 @@ double CheMPS2::DMRG::sweepright( const bool change, const int instruction, cons
 double CheMPS2::DMRG::solve_site( const int index, const double dvdson_rtol, const double noise_level, const int virtual_dimension, const bool am_i_master, const bool moving_right, const bool change ){
 
    struct timeval start, end;
+   double timings_prev[ CHEMPS2_TIME_VECLENGTH ];
+   for ( int cnt = 0; cnt < CHEMPS2_TIME_VECLENGTH; cnt++ ){ timings_prev[ cnt ] = timings[ cnt ]; }
+   const long long num_double_write_prev = num_double_write_disk;
+   const long long num_double_read_prev  = num_double_read_disk;
 
    // Construct two-site object S. Each MPI process joins the MPS tensors. Before a matrix-vector multiplication the vector is broadcasted anyway.
    gettimeofday( &start, NULL );
+   Tracer::begin( "S.join", "dmrg" );
    Sobject * denS = new Sobject( index, denBK );
    denS->Join( MPS[ index ], MPS[ index + 1 ] );
+   Tracer::end( "S.join", "dmrg" );
    gettimeofday( &end, NULL );
    timings[ CHEMPS2_TIME_S_JOIN ] += ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
 
    // Feed everything to the solver. Each MPI process returns the correct energy. Only MPI_CHEMPS2_MASTER has the correct denS solution.
    gettimeofday( &start, NULL );
+   Tracer::begin( "S.solve", "dmrg" );
    Heff Solver( denBK, Prob, dvdson_rtol );
    double ** VeffTilde = NULL;
    if ( Exc_activated ){ VeffTilde = prepare_excitations( denS ); }
-   double Energy = Solver.SolveDAVIDSON( denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nStates - 1, VeffTilde );
+   int num_matvec = 0;
+   double Energy = Solver.SolveDAVIDSON( denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nStates - 1, VeffTilde, &num_matvec );
    Energy += Prob->gEconst();
    if ( Exc_activated ){ cleanup_excitations( VeffTilde ); }
+   Tracer::end( "S.solve", "dmrg" );
    gettimeofday( &end, NULL );
    timings[ CHEMPS2_TIME_S_SOLVE ] += ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
 
    // Decompose the S-object. MPI_CHEMPS2_MASTER decomposes denS. Each MPI process returns the correct discWeight. Each MPI process has the new MPS tensors set.
    gettimeofday( &start, NULL );
+   Tracer::begin( "S.split", "dmrg" );
    if (( noise_level > 0.0 ) && ( am_i_master )){ denS->addNoise( noise_level ); }
+   const int num_blocks = denS->gNKappa();
+   const int vector_length = denS->gKappa2index( num_blocks );
    const double discWeight = denS->Split( MPS[ index ], MPS[ index + 1 ], virtual_dimension, moving_right, change );
    delete denS;
    if ( discWeight > MaxDiscWeightLastSweep ){ MaxDiscWeightLastSweep = discWeight; }
+   Tracer::end( "S.split", "dmrg" );
    gettimeofday( &end, NULL );
    timings[ CHEMPS2_TIME_S_SPLIT ] += ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
 
+   // Prepare for next step
+   gettimeofday( &start, NULL );
+   Tracer::begin( "tensor update", "dmrg" );
+   if ( moving_right ){ updateMovingRightSafe( index ); }
+   else {              updateMovingLeftSafe(  index ); }
+   Tracer::end( "tensor update", "dmrg" );
+   gettimeofday( &end, NULL );
+   timings[ CHEMPS2_TIME_TENS_TOTAL ] += ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+
+   if (( sweep_log != NULL ) && ( am_i_master )){
+      const int bond_dims[] = { denBK->gTotDimAtBound( index ), denBK->gTotDimAtBound( index + 1 ), denBK->gTotDimAtBound( index + 2 ) };
+      sweep_log->start( "site" );
+      sweep_log->add( "instruction", log_instruction );
+      sweep_log->add( "sweep", log_sweep );
+      sweep_log->add( "direction", std::string( moving_right ? "right" : "left" ) );
+      sweep_log->add( "site", index );
+      sweep_log->add( "blocks", num_blocks );
+      sweep_log->add( "vector_length", vector_length );
+      sweep_log->add( "bond_dimensions", bond_dims, 3 );
+      sweep_log->add( "davidson_matvecs", num_matvec );
+      sweep_log->add( "energy", Energy );
+      sweep_log->add( "discarded_weight", discWeight );
+      sweep_log->add( "time_join",  timings[ CHEMPS2_TIME_S_JOIN  ] - timings_prev[ CHEMPS2_TIME_S_JOIN  ] );
+      sweep_log->add( "time_solve", timings[ CHEMPS2_TIME_S_SOLVE ] - timings_prev[ CHEMPS2_TIME_S_SOLVE ] );
+      sweep_log->add( "time_split", timings[ CHEMPS2_TIME_S_SPLIT ] - timings_prev[ CHEMPS2_TIME_S_SPLIT ] );
+      sweep_log->add( "time_tensor_update", timings[ CHEMPS2_TIME_TENS_TOTAL ] - timings_prev[ CHEMPS2_TIME_TENS_TOTAL ] );
+      sweep_log->add( "time_tensor_alloc",  timings[ CHEMPS2_TIME_TENS_ALLOC ] - timings_prev[ CHEMPS2_TIME_TENS_ALLOC ] );
+      sweep_log->add( "time_tensor_free",   timings[ CHEMPS2_TIME_TENS_FREE  ] - timings_prev[ CHEMPS2_TIME_TENS_FREE  ] );
+      sweep_log->add( "time_disk_write",    timings[ CHEMPS2_TIME_DISK_WRITE ] - timings_prev[ CHEMPS2_TIME_DISK_WRITE ] );
+      sweep_log->add( "time_disk_read",     timings[ CHEMPS2_TIME_DISK_READ  ] - timings_prev[ CHEMPS2_TIME_DISK_READ  ] );
+      sweep_log->add( "time_tensor_calc",   timings[ CHEMPS2_TIME_TENS_CALC  ] - timings_prev[ CHEMPS2_TIME_TENS_CALC  ] );
+      sweep_log->add( "bytes_written", ( long long )(( num_double_write_disk - num_double_write_prev ) * sizeof( double )) );
+      sweep_log->add( "bytes_read",    ( long long )(( num_double_read_disk  - num_double_read_prev  ) * sizeof( double )) );
+      sweep_log->add( "rss_kb", SweepLog::rss_kb() );
+      sweep_log->write();
+   }
+
    return Energy;
 
 }
 
+void CheMPS2::DMRG::log_sweep_record( const bool moving_right, const double elapsed ) const{
+
+   if ( sweep_log == NULL ){ return; }
+
+   sweep_log->start( "sweep" );
+   sweep_log->add( "instruction", log_instruction );
+   sweep_log->add( "sweep", log_sweep );
+   sweep_log->add( "direction", std::string( moving_right ? "right" : "left" ) );
+   sweep_log->add( "D", OptScheme->get_D( log_instruction ) );
+   sweep_log->add( "min_energy", LastMinEnergy );
+   sweep_log->add( "max_discarded_weight", MaxDiscWeightLastSweep );
+   sweep_log->add( "time_total", elapsed );
+   sweep_log->add( "time_join",  timings[ CHEMPS2_TIME_S_JOIN  ] );
+   sweep_log->add( "time_solve", timings[ CHEMPS2_TIME_S_SOLVE ] );
+   sweep_log->add( "time_split", timings[ CHEMPS2_TIME_S_SPLIT ] );
+   sweep_log->add( "time_tensor_update", timings[ CHEMPS2_TIME_TENS_TOTAL ] );
+   sweep_log->add( "time_tensor_alloc",  timings[ CHEMPS2_TIME_TENS_ALLOC ] );
+   sweep_log->add( "time_tensor_free",   timings[ CHEMPS2_TIME_TENS_FREE  ] );
+   sweep_log->add( "time_disk_write",    timings[ CHEMPS2_TIME_DISK_WRITE ] );
+   sweep_log->add( "time_disk_read",     timings[ CHEMPS2_TIME_DISK_READ  ] );
+   sweep_log->add( "time_tensor_calc",   timings[ CHEMPS2_TIME_TENS_CALC  ] );
+   sweep_log->add( "bytes_written", ( long long )( num_double_write_disk * sizeof( double ) ) );
+   sweep_log->add( "bytes_read",    ( long long )( num_double_read_disk  * sizeof( double ) ) );
+   sweep_log->add( "rss_kb", SweepLog::rss_kb() );
+   sweep_log->add( "peak_rss_kb", SweepLog::peak_rss_kb() );
+   sweep_log->write();
+
+}
+
 void CheMPS2::DMRG::activateExcitations( const int maxExcIn ){
 
    Exc_activated = true;
@@ -36,6 +36,17 @@ CheMPS2::DMRGSCFoptions::DMRGSCFoptions(){
    WhichActiveSpace   = CheMPS2::DMRGSCF_whichActiveSpace;
    DumpCorrelations   = CheMPS2::DMRGSCF_dumpCorrelations;
    StartLocRandom     = CheMPS2::DMRGSCF_startLocRandom;
+   
+   CASPT2MaxMemMB     = CheMPS2::CASPT2_max_mem_MB;
+   F4RDMGroups        = CheMPS2::CASPT2_f4rdm_groups;
+   
+   StoreWtilde        = CheMPS2::DMRGSCF_storeWtilde;
+   
+   AdaptiveDMRG       = CheMPS2::DMRGSCF_adaptiveDMRG;
+   AdaptiveGradient   = CheMPS2::DMRGSCF_adaptiveGradient;
+   AdaptiveMinD       = CheMPS2::DMRGSCF_adaptiveMinD;
+   
+   SpinAdaptFCI       = CheMPS2::DMRGSCF_spinAdaptFCI;
 
 }
 
@@ -54,6 +65,13 @@ bool   CheMPS2::DMRGSCFoptions::getStateAveraging() const{     return StateAvera
 int    CheMPS2::DMRGSCFoptions::getWhichActiveSpace() const{   return WhichActiveSpace;   }
 bool   CheMPS2::DMRGSCFoptions::getDumpCorrelations() const{   return DumpCorrelations;   }
 bool   CheMPS2::DMRGSCFoptions::getStartLocRandom() const{     return StartLocRandom;     }
+double CheMPS2::DMRGSCFoptions::getCASPT2MaxMemMB() const{     return CASPT2MaxMemMB;     }
+int    CheMPS2::DMRGSCFoptions::getF4RDMGroups() const{        return F4RDMGroups;        }
+bool   CheMPS2::DMRGSCFoptions::getStoreWtilde() const{        return StoreWtilde;        }
+bool   CheMPS2::DMRGSCFoptions::getAdaptiveDMRG() const{       return AdaptiveDMRG;       }
+double CheMPS2::DMRGSCFoptions::getAdaptiveGradient() const{   return AdaptiveGradient;   }
+int    CheMPS2::DMRGSCFoptions::getAdaptiveMinD() const{       return AdaptiveMinD;       }
+bool   CheMPS2::DMRGSCFoptions::getSpinAdaptFCI() const{       return SpinAdaptFCI;       }
 
 void CheMPS2::DMRGSCFoptions::setDoDIIS(const bool DoDIIS_in){                           DoDIIS             = DoDIIS_in;             }
 void CheMPS2::DMRGSCFoptions::setDIISGradientBranch(const double DIISGradientBranch_in){ DIISGradientBranch = DIISGradientBranch_in; }
@@ -68,6 +86,13 @@ void CheMPS2::DMRGSCFoptions::setStateAveraging(const bool StateAveraging_in){
 void CheMPS2::DMRGSCFoptions::setWhichActiveSpace(const int WhichActiveSpace_in){        WhichActiveSpace   = WhichActiveSpace_in;   }
 void CheMPS2::DMRGSCFoptions::setDumpCorrelations(const bool DumpCorrelations_in){       DumpCorrelations   = DumpCorrelations_in;   }
 void CheMPS2::DMRGSCFoptions::setStartLocRandom(const bool StartLocRandom_in){           StartLocRandom     = StartLocRandom_in;     }
+void CheMPS2::DMRGSCFoptions::setCASPT2MaxMemMB(const double CASPT2MaxMemMB_in){         CASPT2MaxMemMB     = CASPT2MaxMemMB_in;     }
+void CheMPS2::DMRGSCFoptions::setF4RDMGroups(const int F4RDMGroups_in){                 F4RDMGroups        = F4RDMGroups_in;        }
+void CheMPS2::DMRGSCFoptions::setStoreWtilde(const bool StoreWtilde_in){                 StoreWtilde        = StoreWtilde_in;        }
+void CheMPS2::DMRGSCFoptions::setAdaptiveDMRG(const bool AdaptiveDMRG_in){               AdaptiveDMRG       = AdaptiveDMRG_in;       }
+void CheMPS2::DMRGSCFoptions::setAdaptiveGradient(const double AdaptiveGradient_in){     AdaptiveGradient   = AdaptiveGradient_in;   }
+void CheMPS2::DMRGSCFoptions::setAdaptiveMinD(const int AdaptiveMinD_in){               AdaptiveMinD       = AdaptiveMinD_in;       }
+void CheMPS2::DMRGSCFoptions::setSpinAdaptFCI(const bool SpinAdaptFCI_in){               SpinAdaptFCI       = SpinAdaptFCI_in;       }
 
 
 
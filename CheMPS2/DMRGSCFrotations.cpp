@@ -23,8 +23,13 @@
 #include <assert.h>
 #include <string>
 
+#ifdef _OPENMP
+   #include <omp.h>
+#endif
+
 #include "DMRGSCFrotations.h"
 #include "Lapack.h"
+#include "Tracer.h"
 
 using std::min;
 using std::max;
@@ -390,6 +395,7 @@ void CheMPS2::DMRGSCFrotations::rotate( const FourIndex * ORIG_VMAT, FourIndex *
 
    /* Matrix elements ( 1 2 | 3 4 ) */
 
+   Tracer::Scope scope( "DMRGSCFrotations::rotate", "dmrgscf" );
    assert(( space1 == 'O' ) || ( space1 == 'A' ) || ( space1 == 'V' ) || ( space1 == 'C' ) || ( space1 == 'F' ));
    assert(( space2 == 'O' ) || ( space2 == 'A' ) || ( space2 == 'V' ) || ( space2 == 'C' ) || ( space2 == 'F' ));
    assert(( space3 == 'O' ) || ( space3 == 'A' ) || ( space3 == 'V' ) || ( space3 == 'C' ) || ( space3 == 'F' ));
@@ -400,6 +406,15 @@ void CheMPS2::DMRGSCFrotations::rotate( const FourIndex * ORIG_VMAT, FourIndex *
    const bool equal34 = ( space3 == space4 );
    const bool eightfold = (( space1 == space3 ) && ( space2 == space4 ));
 
+   // The tiles are distributed over the threads; the lapack and blas calls within a tile are not nested
+   #ifdef _OPENMP
+   const int max_threads = omp_get_max_threads();
+   const int max_levels  = omp_get_max_active_levels();
+   omp_set_max_active_levels( 1 );
+   #else
+   const int max_threads = 1;
+   #endif
+
    for ( int irrep1 = 0; irrep1 < num_irreps; irrep1++ ){
       for ( int irrep2 = (( equal12 ) ? irrep1 : 0 ); irrep2 < num_irreps; irrep2++ ){ // irrep2 >= irrep1 if space1 == space2
          const int product_symm = Irreps::directProd( irrep1, irrep2 );
@@ -424,62 +439,193 @@ void CheMPS2::DMRGSCFrotations::rotate( const FourIndex * ORIG_VMAT, FourIndex *
                   double * umat3 = umat->getBlock( irrep3 ) + jump( idx, irrep3, space3 );
                   double * umat4 = umat->getBlock( irrep4 ) + jump( idx, irrep4, space4 );
 
-                  const int block_size1 = mem_size / ( ORIG1 * ORIG2 ); // Floor of amount of times orig( first  ) fits in mem_size
-                  const int block_size2 = mem_size / ( ORIG3 * ORIG4 ); // Floor of amount of times orig( second ) fits in mem_size
-                  assert( block_size1 > 0 );
-                  assert( block_size2 > 0 );
-
                   const bool pack_first  = (( equal12 ) && ( irrep1 == irrep2 ));
                   const bool pack_second = (( equal34 ) && ( irrep3 == irrep4 ));
                   const int   first_size = (( pack_first  ) ? (  NEW1 * (  NEW1 + 1 )) / 2 :  NEW1 * NEW2  );
                   const int  second_size = (( pack_second ) ? ( ORIG3 * ( ORIG3 + 1 )) / 2 : ORIG3 * ORIG4 );
 
-                  const bool io_free = (( block_size1 >= second_size ) && ( block_size2 >= first_size ));
-                  hid_t file_id, dspc_id, dset_id;
+                  /* The half-transformed integrals [ first_size x second_size ] are kept in mem1 if they fit and if mem2 can hold
+                     two work arrays of at least one column and one row; otherwise they are spilled to disk and mem1 and mem2 are
+                     both used as work arrays. Every thread gets its own part of the work arrays, in which it transforms tiles. */
+                  const int largest = max( ORIG1 * ORIG2, ORIG3 * ORIG4 );
+                  const bool io_free = (( ((long long) first_size ) * second_size <= mem_size ) && ( mem_size / 2 >= largest ));
+                  const int capacity = (( io_free ) ? mem_size / 2 : mem_size );
+                  int num_threads = max_threads;
+                  while (( num_threads > 1 ) && ( capacity / num_threads < largest )){ num_threads--; }
+                  const int piece = capacity / num_threads;
+                  assert( piece >= largest );
+
+                  // Tiles are bounded by the work array per thread and by DMRGSCF_eri_tile_doubles, and spread the work over the threads
+                  const int tile1 = max( 1, min( min( piece, max( DMRGSCF_eri_tile_doubles, largest ) ) / ( ORIG1 * ORIG2 ), ( second_size + num_threads - 1 ) / num_threads ) );
+                  const int tile2 = max( 1, min( min( piece, max( DMRGSCF_eri_tile_doubles, largest ) ) / ( ORIG3 * ORIG4 ), (  first_size + num_threads - 1 ) / num_threads ) );
+                  const int num_tiles1 = ( second_size + tile1 - 1 ) / tile1;
+                  const int num_tiles2 = (  first_size + tile2 - 1 ) / tile2;
 
+                  hid_t file_id, dspc_id, dset_id;
                   if ( io_free == false ){
                      assert( filename.compare( "edmistonruedenberg" ) != 0 );
                      open_file( &file_id, &dspc_id, &dset_id, first_size, second_size, filename );
                   }
 
-                  // First half transformation
-                  int start = 0;
-                  while ( start < second_size ){
-                     const int stop = min( start + block_size1, second_size );
-                     const int size = stop - start;
-                     fetch( mem1, ORIG_VMAT, irrep1, irrep2, irrep3, irrep4, idx, start, stop, pack_second );
-                     blockwise_first(  mem1, mem2, ORIG1, ORIG2, size, umat1, NEW1, ORIG1 );
-                     blockwise_second( mem2, mem1, NEW1,  ORIG2, size, umat2, NEW2, ORIG2 );
-                     if ( pack_first ){
-                        package_first( mem1, mem2, NEW1, first_size, size );
-                        double * temp = mem1;
-                        mem1 = mem2;
-                        mem2 = temp;
+                  #pragma omp parallel num_threads( num_threads )
+                  {
+                     #ifdef _OPENMP
+                     const int thread = omp_get_thread_num();
+                     #else
+                     const int thread = 0;
+                     #endif
+                     double * work1 = (( io_free ) ? mem2 + ( 2 * thread     ) * piece : mem1 + thread * piece );
+                     double * work2 = (( io_free ) ? mem2 + ( 2 * thread + 1 ) * piece : mem2 + thread * piece );
+
+                     // First half transformation: tiles of columns of the half-transformed integrals
+                     #pragma omp for schedule(dynamic)
+                     for ( int tile = 0; tile < num_tiles1; tile++ ){
+                        const int start = tile * tile1;
+                        const int size  = min( start + tile1, second_size ) - start;
+                        double * result = (( io_free ) ? mem1 + first_size * start : work1 );
+                        fetch( work1, ORIG_VMAT, irrep1, irrep2, irrep3, irrep4, idx, start, start + size, pack_second );
+                        blockwise_first( work1, work2, ORIG1, ORIG2, size, umat1, NEW1, ORIG1 );
+                        if ( pack_first ){
+                           blockwise_second( work2, work1, NEW1, ORIG2, size, umat2, NEW2, ORIG2 );
+                           if ( io_free == false ){ result = work2; }
+                           package_first( work1, result, NEW1, first_size, size );
+                        } else {
+                           blockwise_second( work2, result, NEW1, ORIG2, size, umat2, NEW2, ORIG2 );
+                        }
+                        if ( io_free == false ){
+                           #pragma omp critical
+                           write_file( dspc_id, dset_id, result, start, size, first_size );
+                        }
+                     }
+
+                     // Second half transformation: tiles of rows of the half-transformed integrals, written in order
+                     #pragma omp for schedule(dynamic) ordered
+                     for ( int tile = 0; tile < num_tiles2; tile++ ){
+                        const int start = tile * tile2;
+                        const int size  = min( start + tile2, first_size ) - start;
+                        if ( io_free ){
+                           for ( int col = 0; col < second_size; col++ ){
+                              for ( int row = 0; row < size; row++ ){
+                                 work1[ row + size * col ] = mem1[ start + row + first_size * col ];
+                              }
+                           }
+                        } else {
+                           #pragma omp critical
+                           read_file( dspc_id, dset_id, work1, start, size, second_size );
+                        }
+                        double * origin = work1;
+                        double * target = work2;
+                        if ( pack_second ){
+                           unpackage_second( work1, work2, size, ORIG3 );
+                           origin = work2;
+                           target = work1;
+                        }
+                        blockwise_fourth( origin, target, size, ORIG3, ORIG4, umat4, NEW4, ORIG4 );
+                        blockwise_third(  target, origin, size, ORIG3, NEW4,  umat3, NEW3, ORIG3 );
+                        #pragma omp ordered
+                        write( origin, NEW_VMAT, ROT_TEI, space1, space2, space3, space4, irrep1, irrep2, irrep3, irrep4, idx, start, start + size, pack_first );
                      }
-                     if ( io_free == false ){ write_file( dspc_id, dset_id, mem1, start, size, first_size ); }
-                     start += size;
                   }
-                  assert( start == second_size );
 
-                  // Do the second half transformation
-                  start = 0;
+                  if ( io_free == false ){ close_file( file_id, dspc_id, dset_id ); }
+               }
+            }
+         }
+      }
+   }
+
+   #ifdef _OPENMP
+   omp_set_max_active_levels( max_levels );
+   #endif
+
+}
+
+double * CheMPS2::DMRGSCFrotations::rotate_vectors( const ThreeIndex * ORIG_VMAT, const int irrep1, const int irrep2, const char space1, const char space2, DMRGSCFindices * idx, DMRGSCFunitary * umat, const bool pack ){
+
+   const int NAUX  = ORIG_VMAT->get_num_vectors( Irreps::directProd( irrep1, irrep2 ) );
+   const int ORIG1 = idx->getNORB( irrep1 );
+   const int ORIG2 = idx->getNORB( irrep2 );
+   const int NEW1  = dimension( idx, irrep1, space1 );
+   const int NEW2  = dimension( idx, irrep2, space2 );
+
+   double * umat1  = umat->getBlock( irrep1 ) + jump( idx, irrep1, space1 );
+   double * umat2  = umat->getBlock( irrep2 ) + jump( idx, irrep2, space2 );
+   double * work   = new double[ NEW1 * ORIG2 * NAUX ];
+   double * result = new double[ NEW1 * NEW2 * NAUX ];
+   if ( NAUX > 0 ){
+      blockwise_first(  ORIG_VMAT->getBlock( irrep1, irrep2 ), work, ORIG1, ORIG2, NAUX, umat1, NEW1, ORIG1 );
+      blockwise_second( work, result, NEW1, ORIG2, NAUX, umat2, NEW2, ORIG2 );
+      if ( pack ){
+         package_first( result, work, NEW1, ( NEW1 * ( NEW1 + 1 ) ) / 2, NAUX );
+         double * temp = result;
+         result = work;
+         work = temp;
+      }
+   }
+   delete [] work;
+   return result;
+
+}
+
+void CheMPS2::DMRGSCFrotations::rotate( const ThreeIndex * ORIG_VMAT, FourIndex * NEW_VMAT, DMRGSCFintegrals * ROT_TEI, const char space1, const char space2, const char space3, const char space4, DMRGSCFindices * idx, DMRGSCFunitary * umat, double * mem1, const int mem_size ){
+
+   /* Matrix elements ( 1 2 | 3 4 ) = sum_P B^P_12 B^P_34 */
+
+   Tracer::Scope scope( "DMRGSCFrotations::rotate", "dmrgscf" );
+   assert(( space1 == 'O' ) || ( space1 == 'A' ) || ( space1 == 'V' ) || ( space1 == 'C' ) || ( space1 == 'F' ));
+   assert(( space2 == 'O' ) || ( space2 == 'A' ) || ( space2 == 'V' ) || ( space2 == 'C' ) || ( space2 == 'F' ));
+   assert(( space3 == 'O' ) || ( space3 == 'A' ) || ( space3 == 'V' ) || ( space3 == 'C' ) || ( space3 == 'F' ));
+   assert(( space4 == 'O' ) || ( space4 == 'A' ) || ( space4 == 'V' ) || ( space4 == 'C' ) || ( space4 == 'F' ));
+
+   const int num_irreps = idx->getNirreps();
+   const bool equal12 = ( space1 == space2 );
+   const bool equal34 = ( space3 == space4 );
+   const bool eightfold = (( space1 == space3 ) && ( space2 == space4 ));
+
+   for ( int irrep1 = 0; irrep1 < num_irreps; irrep1++ ){
+      for ( int irrep2 = (( equal12 ) ? irrep1 : 0 ); irrep2 < num_irreps; irrep2++ ){ // irrep2 >= irrep1 if space1 == space2
+         const int product_symm = Irreps::directProd( irrep1, irrep2 );
+         for ( int irrep3 = (( eightfold ) ? irrep1 : 0 ); irrep3 < num_irreps; irrep3++ ){
+            const int irrep4 = Irreps::directProd( product_symm, irrep3 );
+            if ( irrep4 >= (( equal34 ) ? irrep3 : 0 ) ){ // irrep4 >= irrep3 if space3 == space4
+
+               const int NEW1 = dimension( idx, irrep1, space1 );
+               const int NEW2 = dimension( idx, irrep2, space2 );
+               const int NEW3 = dimension( idx, irrep3, space3 );
+               const int NEW4 = dimension( idx, irrep4, space4 );
+
+               if (( NEW1 > 0 ) && ( NEW2 > 0 ) && ( NEW3 > 0 ) && ( NEW4 > 0 )){
+
+                  int NAUX = ORIG_VMAT->get_num_vectors( product_symm );
+                  const bool pack_first = (( equal12 ) && ( irrep1 == irrep2 ));
+                  int  first_size = (( pack_first ) ? ( NEW1 * ( NEW1 + 1 )) / 2 : NEW1 * NEW2 );
+                  int second_size = NEW3 * NEW4;
+                  const int block_size = mem_size / second_size; // Floor of amount of times new( second ) fits in mem_size
+                  assert( block_size > 0 );
+
+                  double * left  = rotate_vectors( ORIG_VMAT, irrep1, irrep2, space1, space2, idx, umat, pack_first );
+                  double * right = rotate_vectors( ORIG_VMAT, irrep3, irrep4, space3, space4, idx, umat, false );
+
+                  int start = 0;
                   while ( start < first_size ){
-                     const int stop = min( start + block_size2, first_size );
-                     const int size = stop - start;
-                     if ( io_free == false ){ read_file( dspc_id, dset_id, mem1, start, size, second_size ); }
-                     if ( pack_second ){
-                        unpackage_second( mem1, mem2, size, ORIG3 );
-                        double * temp = mem1;
-                        mem1 = mem2;
-                        mem2 = temp;
+                     const int stop = min( start + block_size, first_size );
+                     int size = stop - start;
+                     if ( NAUX > 0 ){
+                        char trans   = 'T';
+                        char notrans = 'N';
+                        double one   = 1.0;
+                        double set   = 0.0;
+                        dgemm_( &notrans, &trans, &size, &second_size, &NAUX, &one, left + start, &first_size, right, &second_size, &set, mem1, &size );
+                     } else {
+                        for ( int elem = 0; elem < size * second_size; elem++ ){ mem1[ elem ] = 0.0; }
                      }
-                     blockwise_fourth( mem1, mem2, size, ORIG3, ORIG4, umat4, NEW4, ORIG4 );
-                     blockwise_third(  mem2, mem1, size, ORIG3, NEW4,  umat3, NEW3, ORIG3 );
                      write( mem1, NEW_VMAT, ROT_TEI, space1, space2, space3, space4, irrep1, irrep2, irrep3, irrep4, idx, start, stop, pack_first );
                      start += size;
                   }
                   assert( start == first_size );
-                  if ( io_free == false ){ close_file( file_id, dspc_id, dset_id ); }
+
+                  delete [] left;
+                  delete [] right;
                }
             }
          }
@@ -487,5 +633,3 @@ void CheMPS2::DMRGSCFrotations::rotate( const FourIndex * ORIG_VMAT, FourIndex *
    }
 
 }
-
-
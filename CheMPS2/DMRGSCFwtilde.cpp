@@ -17,17 +17,30 @@
    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 */
 
+#include <assert.h>
+
 #include "DMRGSCFwtilde.h"
 
-CheMPS2::DMRGSCFwtilde::DMRGSCFwtilde(DMRGSCFindices * iHandler_in){
+CheMPS2::DMRGSCFwtilde::DMRGSCFwtilde(DMRGSCFindices * iHandler_in, const bool store_in){
 
    iHandler = iHandler_in;
+   store    = store_in;
    
    Nocc_dmrg = new int[ iHandler->getNirreps() ];
    for (int irrep = 0; irrep < iHandler->getNirreps(); irrep++){
       Nocc_dmrg[ irrep ] = iHandler->getNOCC( irrep ) + iHandler->getNDMRG( irrep );
    }
    
+   Tmat    = NULL;
+   JKocc   = NULL;
+   JKact   = NULL;
+   theInts = NULL;
+   two_dm  = NULL;
+   one_dm  = NULL;
+   
+   wmattilde = NULL;
+   if ( store == false ){ return; }
+   
    wmattilde = new double***[ iHandler->getNirreps() ];
    for (int irrep_pq = 0; irrep_pq < iHandler->getNirreps(); irrep_pq++){
       wmattilde[ irrep_pq ] = new double**[ iHandler->getNirreps() ];
@@ -45,6 +58,11 @@ CheMPS2::DMRGSCFwtilde::DMRGSCFwtilde(DMRGSCFindices * iHandler_in){
 
 CheMPS2::DMRGSCFwtilde::~DMRGSCFwtilde(){
 
+   if ( store == false ){
+      delete [] Nocc_dmrg;
+      return;
+   }
+
    for (int irrep_pq = 0; irrep_pq < iHandler->getNirreps(); irrep_pq++){
       for (int irrep_rs = 0; irrep_rs < iHandler->getNirreps(); irrep_rs++){
          const unsigned int sizeblock_pr = Nocc_dmrg[ irrep_pq ] * Nocc_dmrg[ irrep_rs ];
@@ -63,6 +81,8 @@ CheMPS2::DMRGSCFwtilde::~DMRGSCFwtilde(){
 
 void CheMPS2::DMRGSCFwtilde::clear(){
 
+   if ( store == false ){ return; }
+
    for (int irrep_pq = 0; irrep_pq < iHandler->getNirreps(); irrep_pq++){
       for (int irrep_rs = 0; irrep_rs < iHandler->getNirreps(); irrep_rs++){
          const unsigned int sizeblock_pr = Nocc_dmrg[ irrep_pq ] * Nocc_dmrg[ irrep_rs ];
@@ -79,19 +99,189 @@ void CheMPS2::DMRGSCFwtilde::clear(){
 
 void CheMPS2::DMRGSCFwtilde::set(const int irrep_pq, const int irrep_rs, const int p, const int q, const int r, const int s, const double val){
 
+   assert( store );
    wmattilde[ irrep_pq ][ irrep_rs ][ p + Nocc_dmrg[ irrep_pq ] * r ][ q + iHandler->getNORB(irrep_pq) * s ] = val;
 
 }
 
 double CheMPS2::DMRGSCFwtilde::get(const int irrep_pq, const int irrep_rs, const int p, const int q, const int r, const int s) const{
 
+   assert( store );
    return wmattilde[ irrep_pq ][ irrep_rs ][ p + Nocc_dmrg[ irrep_pq ] * r ][ q + iHandler->getNORB(irrep_pq) * s ];
 
 }
 
 double * CheMPS2::DMRGSCFwtilde::getBlock(const int irrep_pq, const int irrep_rs, const int p, const int r){
 
+   assert( store );
    return wmattilde[ irrep_pq ][ irrep_rs ][ p + Nocc_dmrg[ irrep_pq ] * r ];
 
 }
 
+bool CheMPS2::DMRGSCFwtilde::isStored() const{ return store; }
+
+double * CheMPS2::DMRGSCFwtilde::fetchBlock(const int irrep_pq, const int irrep_rs, const int p, const int r, double * work) const{
+
+   if ( store ){ return wmattilde[ irrep_pq ][ irrep_rs ][ p + Nocc_dmrg[ irrep_pq ] * r ]; }
+   fillBlock( irrep_pq, irrep_rs, p, r, work );
+   return work;
+
+}
+
+void CheMPS2::DMRGSCFwtilde::build(const DMRGSCFmatrix * Tmat_in, const DMRGSCFmatrix * JKocc_in, const DMRGSCFmatrix * JKact_in, const DMRGSCFintegrals * theInts_in, double * two_dm_in, double * one_dm_in){
+
+   Tmat    = Tmat_in;
+   JKocc   = JKocc_in;
+   JKact   = JKact_in;
+   theInts = theInts_in;
+   two_dm  = two_dm_in;
+   one_dm  = one_dm_in;
+
+   if ( store == false ){ return; }
+
+   for (int irrep_pq = 0; irrep_pq < iHandler->getNirreps(); irrep_pq++){
+      for (int irrep_rs = 0; irrep_rs < iHandler->getNirreps(); irrep_rs++){
+         const int sizeblock_pr = Nocc_dmrg[ irrep_pq ] * Nocc_dmrg[ irrep_rs ];
+         #pragma omp parallel for schedule(dynamic)
+         for (int combined_pr = 0; combined_pr < sizeblock_pr; combined_pr++){
+            const int p = combined_pr % Nocc_dmrg[ irrep_pq ];
+            const int r = combined_pr / Nocc_dmrg[ irrep_pq ];
+            fillBlock( irrep_pq, irrep_rs, p, r, wmattilde[ irrep_pq ][ irrep_rs ][ combined_pr ] );
+         }
+      }
+   }
+
+}
+
+void CheMPS2::DMRGSCFwtilde::fillBlock(const int irrep_pq, const int irrep_rs, const int relindexP, const int relindexR, double * subblock) const{
+
+   assert( Tmat != NULL );
+
+   const int totOrbDMRG = iHandler->getDMRGcumulative( iHandler->getNirreps() );
+   const int NumOCCpq   = iHandler->getNOCC(  irrep_pq );
+   const int NumDMRGpq  = iHandler->getNDMRG( irrep_pq );
+   const int NumORBpq   = iHandler->getNORB(  irrep_pq );
+   const int NumCOREpq  = NumOCCpq + NumDMRGpq;
+   const int NumOCCrs   = iHandler->getNOCC(  irrep_rs );
+   const int NumORBrs   = iHandler->getNORB(  irrep_rs );
+   const int NumCORErs  = NumOCCrs + iHandler->getNDMRG( irrep_rs );
+   const int productirrep = Irreps::directProd( irrep_pq, irrep_rs );
+   const bool occP = ( relindexP < NumOCCpq );
+   const bool occR = ( relindexR < NumOCCrs );
+
+   for (int combined_qs = 0; combined_qs < NumORBpq * NumORBrs; combined_qs++){ subblock[ combined_qs ] = 0.0; }
+
+   //If irrep_pq == irrep_rs and P == R occupied --> QS only active or virtual
+   if (( irrep_pq == irrep_rs ) && ( relindexP == relindexR ) && ( occP )){
+      for (int relindexS = NumOCCpq; relindexS < NumORBpq; relindexS++){
+         for (int relindexQ = NumOCCpq; relindexQ < NumORBpq; relindexQ++){
+            subblock[ relindexQ + NumORBpq * relindexS ] += 4 * ( Tmat->get( irrep_pq, relindexQ, relindexS)
+                                                                + JKocc->get(irrep_pq, relindexQ, relindexS)
+                                                                + JKact->get(irrep_pq, relindexQ, relindexS) );
+         }
+      }
+   }
+
+   //If irrep_pq == irrep_rs and P,R active --> QS only occupied or virtual
+   if (( irrep_pq == irrep_rs ) && ( occP == false ) && ( occR == false )){
+      const int DMRGindexP = relindexP - NumOCCpq + iHandler->getDMRGcumulative( irrep_pq );
+      const int DMRGindexR = relindexR - NumOCCpq + iHandler->getDMRGcumulative( irrep_pq );
+      const double OneDMvalue = one_dm[ DMRGindexP + totOrbDMRG * DMRGindexR ];
+      for (int relindexS = 0; relindexS < NumORBpq; relindexS++){
+         if (( relindexS < NumOCCpq ) || ( relindexS >= NumCOREpq )){
+            for (int relindexQ = 0; relindexQ < NumORBpq; relindexQ++){
+               if (( relindexQ < NumOCCpq ) || ( relindexQ >= NumCOREpq )){
+                  subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue * ( Tmat->get( irrep_pq, relindexQ, relindexS)
+                                                                                   + JKocc->get(irrep_pq, relindexQ, relindexS) );
+               }
+            }
+         }
+      }
+   }
+
+   // P and R occupied --> QS only active or virtual
+   if (( occP ) && ( occR )){
+      for (int relindexS = NumOCCrs; relindexS < NumORBrs; relindexS++){
+         for (int relindexQ = NumOCCpq; relindexQ < NumORBpq; relindexQ++){
+            subblock[ relindexQ + NumORBpq * relindexS ] +=
+                4 * ( 4 * theInts->FourIndexAPI(irrep_pq, irrep_rs, irrep_pq, irrep_rs, relindexQ, relindexS, relindexP, relindexR)
+                        - theInts->FourIndexAPI(irrep_pq, irrep_pq, irrep_rs, irrep_rs, relindexQ, relindexP, relindexS, relindexR)
+                        - theInts->FourIndexAPI(irrep_pq, irrep_rs, irrep_rs, irrep_pq, relindexQ, relindexS, relindexR, relindexP) );
+         }
+      }
+   }
+
+   // P and R active --> QS only occupied or virtual
+   if (( occP == false ) && ( occR == false )){
+      const int DMRGindexP = relindexP - NumOCCpq + iHandler->getDMRGcumulative( irrep_pq );
+      const int DMRGindexR = relindexR - NumOCCrs + iHandler->getDMRGcumulative( irrep_rs );
+      for (int irrep_alpha = 0; irrep_alpha < iHandler->getNirreps(); irrep_alpha++){
+         const int irrep_beta   = Irreps::directProd( irrep_alpha, productirrep );
+         const int NumDMRGalpha = iHandler->getNDMRG( irrep_alpha );
+         const int NumDMRGbeta  = iHandler->getNDMRG( irrep_beta  );
+         for (int alpha = 0; alpha < NumDMRGalpha; alpha++){
+            const int DMRGalpha = iHandler->getDMRGcumulative( irrep_alpha ) + alpha;
+            const int relalpha  = iHandler->getNOCC( irrep_alpha ) + alpha;
+            for (int beta = 0; beta < NumDMRGbeta; beta++){
+               const int DMRGbeta = iHandler->getDMRGcumulative( irrep_beta ) + beta;
+               const int relbeta  = iHandler->getNOCC( irrep_beta ) + beta;
+               const double TwoDMvalue1  = two_dm[ DMRGindexR + totOrbDMRG * ( DMRGalpha + totOrbDMRG * ( DMRGindexP + totOrbDMRG * DMRGbeta ) ) ];
+               const double TwoDMvalue23 = two_dm[ DMRGindexR + totOrbDMRG * ( DMRGalpha + totOrbDMRG * ( DMRGbeta + totOrbDMRG * DMRGindexP ) ) ]
+                                         + two_dm[ DMRGindexR + totOrbDMRG * ( DMRGindexP + totOrbDMRG * ( DMRGbeta + totOrbDMRG * DMRGalpha ) ) ];
+               for (int relindexS = 0; relindexS < NumORBrs; relindexS++){
+                  if (( relindexS < NumOCCrs ) || ( relindexS >= NumCORErs )){
+                     for (int relindexQ = 0; relindexQ < NumORBpq; relindexQ++){
+                        if (( relindexQ < NumOCCpq ) || ( relindexQ >= NumCOREpq )){
+                           subblock[ relindexQ + NumORBpq * relindexS ] +=
+                              2 * ( TwoDMvalue1  * theInts->FourIndexAPI( irrep_pq, irrep_alpha, irrep_rs, irrep_beta, relindexQ, relalpha, relindexS, relbeta)
+                                  + TwoDMvalue23 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_alpha, irrep_beta, relindexQ, relindexS, relalpha, relbeta) );
+                        }
+                     }
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   // P active and R occupied  -->  Q occupied or virtual  //  S active or virtual
+   if (( occP == false ) && ( occR )){
+      const int DMRGindexP = relindexP - NumOCCpq + iHandler->getDMRGcumulative( irrep_pq );
+      for (int alpha = 0; alpha < NumDMRGpq; alpha++){
+         const int DMRGalpha     = iHandler->getDMRGcumulative( irrep_pq ) + alpha;
+         const int relalpha      = NumOCCpq + alpha;
+         const double OneDMvalue = one_dm[ DMRGalpha + totOrbDMRG * DMRGindexP ];
+         for (int relindexS = NumOCCrs; relindexS < NumORBrs; relindexS++){
+            for (int relindexQ = 0; relindexQ < NumORBpq; relindexQ++){
+               if (( relindexQ < NumOCCpq ) || ( relindexQ >= NumCOREpq )){
+                  subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue *
+                      ( 4 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_pq, irrep_rs, relindexQ, relindexS, relalpha, relindexR)
+                          - theInts->FourIndexAPI( irrep_pq, irrep_pq, irrep_rs, irrep_rs, relindexQ, relalpha, relindexS, relindexR)
+                          - theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_rs, irrep_pq, relindexQ, relindexS, relindexR, relalpha) );
+               }
+            }
+         }
+      }
+   }
+
+   // P occupied and R active  -->  Q active or virtual  //  S occupied or virtual
+   if (( occP ) && ( occR == false )){
+      const int DMRGindexR = relindexR - NumOCCrs + iHandler->getDMRGcumulative( irrep_rs );
+      for (int beta = 0; beta < iHandler->getNDMRG( irrep_rs ); beta++){
+         const int DMRGbeta      = iHandler->getDMRGcumulative( irrep_rs ) + beta;
+         const int relbeta       = NumOCCrs + beta;
+         const double OneDMvalue = one_dm[ DMRGindexR + totOrbDMRG * DMRGbeta ];
+         for (int relindexQ = NumOCCpq; relindexQ < NumORBpq; relindexQ++){
+            for (int relindexS = 0; relindexS < NumORBrs; relindexS++){
+               if (( relindexS < NumOCCrs ) || ( relindexS >= NumCORErs )){
+                  subblock[ relindexQ + NumORBpq * relindexS ] += 2 * OneDMvalue *
+                      ( 4 * theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_pq, irrep_rs, relindexQ, relindexS, relindexP, relbeta)
+                          - theInts->FourIndexAPI( irrep_pq, irrep_pq, irrep_rs, irrep_rs, relindexQ, relindexP, relindexS, relbeta)
+                          - theInts->FourIndexAPI( irrep_pq, irrep_rs, irrep_rs, irrep_pq, relindexQ, relindexS, relbeta, relindexP) );
+               }
+            }
+         }
+      }
+   }
+
+}
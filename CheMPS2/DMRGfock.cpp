@@ -85,6 +85,112 @@ void CheMPS2::DMRG::Symm4RDM( double * output, const int Y, const int Z, const b
 
 }
 
+void CheMPS2::DMRG::DiagFock4RDM( double * output, const double * diag_fock, const bool last_case ){
+
+   struct timeval start, end;
+   gettimeofday( &start, NULL );
+
+   assert( the3DM != NULL );
+
+   /* With X = 2 sum_z diag_fock[ z ] n_z and the bilinear 3rdm[ . ], sum_z diag_fock[ z ] * Symm4RDM( z, z ) = 0.5 * ( 3rdm[ ( 1 + X ) | 0 > ] - 3rdm[ X | 0 > ] - 3DM ) - corrections
+      The first term is linear in X and equals 0.25 * ( 3rdm[ ( 1 + X ) | 0 > ] - 3rdm[ ( 1 - X ) | 0 > ] ). X is scaled to have unit maximal coefficient. */
+   double scale = 0.0;
+   for ( int orb = 0; orb < L; orb++ ){ scale = max( scale, fabs( diag_fock[ orb ] ) ); }
+   const int size = L * L * L * L * L * L;
+   for ( int cnt = 0; cnt < size; cnt++ ){ output[ cnt ] = 0.0; }
+
+   if ( scale > 0.0 ){
+      double * dmrg_fock = new double[ L ];
+      for ( int dmrg_orb = 0; dmrg_orb < L; dmrg_orb++ ){
+         const int ham_orb = (( Prob->gReorder() ) ? Prob->gf2( dmrg_orb ) : dmrg_orb );
+         dmrg_fock[ dmrg_orb ] = diag_fock[ ham_orb ] / scale;
+      }
+      diag_fock_helper( output, dmrg_fock,  1.0, 1.0, false,  0.5 * scale ); // output = 0.5 * scale *   3rdm[ ( 1 + X / ( 2 scale ) ) | 0 > ]
+      diag_fock_helper( output, dmrg_fock, -1.0, 1.0, true,  -0.5 * scale ); // output = 0.5 * scale * ( 3rdm[ ( 1 + X / ( 2 scale ) ) | 0 > ] - 3rdm[ ( 1 - X / ( 2 scale ) ) | 0 > ] )
+      delete [] dmrg_fock;
+
+      for ( int z = 0; z < L; z++ ){
+         const double weight = diag_fock[ z ];
+         if ( weight != 0.0 ){
+            for ( int r = 0; r < L; r++ ){
+               for ( int q = 0; q < L; q++ ){
+                  for ( int p = 0; p < L; p++ ){
+                     for ( int k = 0; k < L; k++ ){
+                        for ( int j = 0; j < L; j++ ){
+                           output[ z + L * ( j + L * ( k + L * ( p + L * ( q + L * r )))) ] -= weight * the3DM->get_ham_index( z, j, k, p, q, r );
+                           output[ j + L * ( z + L * ( k + L * ( p + L * ( q + L * r )))) ] -= weight * the3DM->get_ham_index( j, z, k, p, q, r );
+                           output[ j + L * ( k + L * ( z + L * ( p + L * ( q + L * r )))) ] -= weight * the3DM->get_ham_index( j, k, z, p, q, r );
+                           output[ j + L * ( k + L * ( p + L * ( z + L * ( q + L * r )))) ] -= weight * the3DM->get_ham_index( j, k, p, z, q, r );
+                           output[ j + L * ( k + L * ( p + L * ( q + L * ( z + L * r )))) ] -= weight * the3DM->get_ham_index( k, j, p, z, q, r );
+                           output[ j + L * ( k + L * ( p + L * ( q + L * ( r + L * z )))) ] -= weight * the3DM->get_ham_index( p, j, k, z, q, r );
+                        }
+                     }
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   if ( last_case ){ PreSolve(); } // Need to set up the renormalized operators again to continue sweeping
+
+   gettimeofday( &end, NULL );
+   const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER )
+   #endif
+   { cout << "CheMPS2::DMRG::DiagFock4RDM : Elapsed wall time = " << elapsed << " seconds." << endl; }
+
+}
+
+void CheMPS2::DMRG::diag_fock_helper( double * output, const double * dmrg_fock, const double alpha, const double beta, const bool add, const double factor ){
+
+   // The block upper-triangular MPS of ( alpha * sum_k dmrg_fock[ k ] n_k + beta ) | 0 > has twice the virtual dimensions of | 0 >
+   SyBookkeeper * oldBK = denBK;
+   denBK = new SyBookkeeper( *oldBK );
+   for ( int bound = 1; bound < L; bound++ ){
+      for ( int N = denBK->gNmin( bound ); N <= denBK->gNmax( bound ); N++ ){
+         for ( int TwoS = denBK->gTwoSmin( bound, N ); TwoS <= denBK->gTwoSmax( bound, N ); TwoS += 2 ){
+            for ( int irrep = 0; irrep < denBK->getNumberOfIrreps(); irrep++ ){
+               denBK->SetDim( bound, N, TwoS, irrep, 2 * oldBK->gCurrentDim( bound, N, TwoS, irrep ) );
+            }
+         }
+      }
+   }
+
+   // Make a back-up of the entirely left-normalized MPS
+   TensorT ** backup_mps = new TensorT * [ L ];
+   for ( int orbital = 0; orbital < L; orbital++ ){
+      backup_mps[ orbital ] = MPS[ orbital ];
+      MPS[ orbital ] = new TensorT( orbital, denBK );
+      MPS[ orbital ]->number_operator_sum( backup_mps[ orbital ], dmrg_fock[ orbital ], alpha, beta );
+   }
+   deleteAllBoundaryOperators();
+
+   // Compress the MPS without loss: the Schmidt rank at each boundary is at most twice the original one
+   for ( int index = 0; index < L - 1; index++ ){
+      Sobject * denS = new Sobject( index, denBK );
+      denS->Join( MPS[ index ], MPS[ index + 1 ] );
+      // MPI_CHEMPS2_MASTER decomposes denS. Each MPI process has the new MPS tensors set.
+      denS->Split( MPS[ index ], MPS[ index + 1 ], 2 * oldBK->gTotDimAtBound( index + 1 ), true, true );
+      delete denS;
+   }
+
+   // Add the 3-RDM of the new wavefunction to output
+   helper_3rdm( output, L - 1, add, factor );
+
+   // Throw out the changed MPS and place back the original left-normalized MPS
+   for ( int orbital = 0; orbital < L; orbital++ ){
+      delete MPS[ orbital ];
+      MPS[ orbital ] = backup_mps[ orbital ];
+   }
+   delete [] backup_mps;
+   delete denBK;
+   denBK = oldBK;
+   deleteAllBoundaryOperators();
+
+}
+
 void CheMPS2::DMRG::symm_4rdm_helper( double * output, const int ham_orb1, const int ham_orb2, const double alpha, const double beta, const bool add, const double factor ){
 
    // Figure out the DMRG orbitals, in order
@@ -110,6 +216,10 @@ void CheMPS2::DMRG::symm_4rdm_helper( double * output, const int ham_orb1, const
    }
    deleteAllBoundaryOperators();
 
+   // The overlaps with the excited states are not needed; their owners are processes of MPI_COMM_WORLD, while the orbital pairs can be distributed over groups of processes
+   const bool excitations = Exc_activated;
+   Exc_activated = false;
+
    // Change the gauge so that the non-orthonormal MPS tensor is on site dmrg_orb2
    for ( int siteindex = L - 1; siteindex > dmrg_orb2; siteindex-- ){
       right_normalize( MPS[ siteindex - 1 ], MPS[ siteindex ] );
@@ -119,8 +229,28 @@ void CheMPS2::DMRG::symm_4rdm_helper( double * output, const int ham_orb1, const
    // Solve
    solve_fock( dmrg_orb1, dmrg_orb2, alpha, beta );
 
+   // Add the 3-RDM of the new wavefunction to output
+   helper_3rdm( output, dmrg_orb2, add, factor );
+
+   // Throw out the changed MPS and place back the original left-normalized MPS
+   for ( int orbital = 0; orbital < L; orbital++ ){
+      delete MPS[ orbital ];
+      MPS[ orbital ] = backup_mps[ orbital ];
+   }
+   delete [] backup_mps;
+   if ( dmrg_orb1 != dmrg_orb2 ){
+      delete denBK;
+      denBK = oldBK;
+   }
+   deleteAllBoundaryOperators();
+   Exc_activated = excitations;
+
+}
+
+void CheMPS2::DMRG::helper_3rdm( double * output, const int first_site, const bool add, const double factor ){
+
    // Further right normalize the wavefunction except for the first MPS tensor ( contains the norm )
-   for ( int siteindex = dmrg_orb2; siteindex > 0; siteindex-- ){
+   for ( int siteindex = first_site; siteindex > 0; siteindex-- ){
       right_normalize( MPS[ siteindex - 1 ], MPS[ siteindex ] );
       updateMovingLeftSafeFirstTime( siteindex - 1 );
    }
@@ -182,19 +312,7 @@ void CheMPS2::DMRG::symm_4rdm_helper( double * output, const int ham_orb1, const
    delete [] tensor_3rdm_d_J1_doublet;
    delete [] tensor_3rdm_d_J1_quartet;
    helper3rdm->fill_ham_index( factor, add, output, 0, L );
-
-   // Throw out the changed MPS and place back the original left-normalized MPS
-   for ( int orbital = 0; orbital < L; orbital++ ){
-      delete MPS[ orbital ];
-      MPS[ orbital ] = backup_mps[ orbital ];
-   }
-   delete [] backup_mps;
-   if ( dmrg_orb1 != dmrg_orb2 ){
-      delete denBK;
-      denBK = oldBK;
-   }
    delete helper3rdm;
-   deleteAllBoundaryOperators();
 
 }
 
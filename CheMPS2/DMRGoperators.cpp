@@ -29,6 +29,7 @@
 #include "Lapack.h"
 #include "MPIchemps2.h"
 #include "Special.h"
+#include "Tracer.h"
 
 void CheMPS2::DMRG::updateMovingRightSafeFirstTime(const int cnt){
 
@@ -1146,6 +1147,7 @@ void CheMPS2::DMRG::allocateTensors(const int index, const bool movingRight){
 
 void CheMPS2::DMRG::MY_HDF5_READ_BATCH( const hid_t file_id, const int number, Tensor ** batch, const long long totalsize, const std::string tag ){
 
+   Tracer::Scope scope( "HDF5 read", "io" );
    const hid_t   group_id     = H5Gopen(file_id, tag.c_str(), H5P_DEFAULT);
    const hsize_t dimarray     = totalsize;
    const hid_t   dataspace_id = H5Screate_simple(1, &dimarray, NULL);
@@ -1178,6 +1180,7 @@ void CheMPS2::DMRG::MY_HDF5_READ_BATCH( const hid_t file_id, const int number, T
 
 void CheMPS2::DMRG::MY_HDF5_WRITE_BATCH( const hid_t file_id, const int number, Tensor ** batch, const long long totalsize, const std::string tag ){
 
+   Tracer::Scope scope( "HDF5 write", "io" );
    const hid_t   group_id     = H5Gcreate(file_id, tag.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
    const hsize_t dimarray     = totalsize;
    const hid_t   dataspace_id = H5Screate_simple(1, &dimarray, NULL);
@@ -21,9 +21,13 @@
 #include <stdlib.h>
 #include <iostream>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "Davidson.h"
 #include "Lapack.h"
+#include "MPIchemps2.h"
 
 using std::cout;
 using std::endl;
@@ -39,6 +43,7 @@ CheMPS2::Davidson::Davidson( const int veclength, const int MAX_NUM_VEC, const i
    this->NUM_VEC_KEEP = NUM_VEC_KEEP;
    this->DIAG_CUTOFF  = DIAG_CUTOFF;
    this->RTOL         = RTOL;
+   distributed        = false;
 
    state = 'I'; // <I>nitialized Davidson
    nMultiplications = 0;
@@ -48,6 +53,8 @@ CheMPS2::Davidson::Davidson( const int veclength, const int MAX_NUM_VEC, const i
    vecs  = new double*[ MAX_NUM_VEC ];
    Hvecs = new double*[ MAX_NUM_VEC ];
    num_allocated = 0;
+   disk_storage  = NULL;
+   disk_bytes    = 0;
 
    // The projected problem
    mxM       = new double[ MAX_NUM_VEC * MAX_NUM_VEC ];
@@ -61,7 +68,7 @@ CheMPS2::Davidson::Davidson( const int veclength, const int MAX_NUM_VEC, const i
    diag     = new double[ veclength ];
    t_vec    = new double[ veclength ];
    u_vec    = new double[ veclength ];
-   work_vec = new double[ veclength ];
+   work_vec = new double[ (( veclength > 0 ) ? veclength : 1 ) ]; // Also returns the converged eigenvalue or residual norm, when a process owns an empty segment
    RHS      = (( problem_type == 'L' ) ? new double[ veclength ] : NULL );
 
    // For the deflation
@@ -72,11 +79,21 @@ CheMPS2::Davidson::Davidson( const int veclength, const int MAX_NUM_VEC, const i
 
 }
 
+long long CheMPS2::Davidson::total_multiplications = 0;
+
 CheMPS2::Davidson::~Davidson(){
 
-   for (int cnt = 0; cnt < num_allocated; cnt++){
-      delete [] vecs[cnt];
-      delete [] Hvecs[cnt];
+   #pragma omp atomic
+   total_multiplications += nMultiplications;
+
+   if ( disk_storage != NULL ){
+      munmap( disk_storage, disk_bytes ); // Contains vecs, Hvecs and Reortho_Eigenvecs
+      Reortho_Eigenvecs = NULL;
+   } else {
+      for (int cnt = 0; cnt < num_allocated; cnt++){
+         delete [] vecs[cnt];
+         delete [] Hvecs[cnt];
+      }
    }
    delete [] vecs;
    delete [] Hvecs;
@@ -102,6 +119,46 @@ CheMPS2::Davidson::~Davidson(){
 
 int CheMPS2::Davidson::GetNumMultiplications() const{ return nMultiplications; }
 
+long long CheMPS2::Davidson::GetTotalMultiplications(){ return total_multiplications; }
+
+bool CheMPS2::Davidson::StoreVectorsOnDisk( const std::string filename ){
+
+   assert( state == 'I' );
+   if ( disk_storage != NULL ){ return true; }
+
+   // vecs[ 0 : MAX_NUM_VEC ], Hvecs[ 0 : MAX_NUM_VEC ] and Reortho_Eigenvecs[ 0 : NUM_VEC_KEEP ] are consecutive in the file
+   const size_t num_doubles = ( ( size_t ) veclength ) * ( 2 * MAX_NUM_VEC + (( NUM_VEC_KEEP > 1 ) ? NUM_VEC_KEEP : 0 ) );
+   const size_t num_bytes   = num_doubles * sizeof( double );
+   const int fd = open( filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600 );
+   if ( fd < 0 ){ return false; }
+   unlink( filename.c_str() );
+   if ( ftruncate( fd, num_bytes ) != 0 ){ close( fd ); return false; }
+   void * mapping = mmap( NULL, num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+   close( fd );
+   if ( mapping == MAP_FAILED ){ return false; }
+
+   disk_storage = ( double * ) mapping;
+   disk_bytes   = num_bytes;
+   for ( int cnt = 0; cnt < MAX_NUM_VEC; cnt++ ){
+      vecs [ cnt ] = disk_storage + ( ( size_t ) veclength ) * cnt;
+      Hvecs[ cnt ] = disk_storage + ( ( size_t ) veclength ) * ( MAX_NUM_VEC + cnt );
+   }
+   if ( NUM_VEC_KEEP > 1 ){ Reortho_Eigenvecs = disk_storage + ( ( size_t ) veclength ) * 2 * MAX_NUM_VEC; }
+   num_allocated = MAX_NUM_VEC;
+   if ( debug_print ){ cout << "Davidson : The subspace vectors are stored in a memory-mapped file of " << num_bytes / 1048576.0 << " MB." << endl; }
+   return true;
+
+}
+
+void CheMPS2::Davidson::DistributeVectors(){
+
+   assert( state == 'I' );
+   #ifdef CHEMPS2_MPI_COMPILATION
+   distributed = ( MPIchemps2::mpi_size() > 1 );
+   #endif
+
+}
+
 char CheMPS2::Davidson::FetchInstruction( double ** pointers ){
 
    /* 
@@ -190,8 +247,49 @@ char CheMPS2::Davidson::FetchInstruction( double ** pointers ){
 
 }
 
+double CheMPS2::Davidson::InnerProduct( double * vector1, double * vector2 ){
+
+   int inc1 = 1;
+   double result = ddot_( &veclength, vector1, &inc1, vector2, &inc1 );
+   SumOverProcesses( &result, 1 );
+   return result;
+
+}
+
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::Davidson::SumOverProcesses( double * array, const int size ){
+#else
+void CheMPS2::Davidson::SumOverProcesses( double *, const int ){
+#endif
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( distributed ){
+      double * total = new double[ size ];
+      MPIchemps2::allreduce_array_double( array, total, size );
+      for ( int cnt = 0; cnt < size; cnt++ ){ array[ cnt ] = total[ cnt ]; }
+      delete [] total;
+   }
+   #endif
+
+}
+
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::Davidson::BroadcastFromMaster( double * array, const int size ){
+#else
+void CheMPS2::Davidson::BroadcastFromMaster( double *, const int ){
+#endif
+
+   // The small problems are solved by all processes; the solution of the master process is used, so that all processes take the same decisions
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( distributed ){ MPIchemps2::broadcast_array_double( array, size, MPI_CHEMPS2_MASTER ); }
+   #endif
+
+}
+
 double CheMPS2::Davidson::FrobeniusNorm( double * current_vector ){
 
+   if ( distributed ){ return sqrt( InnerProduct( current_vector, current_vector ) ); }
+
    char frobenius = 'F';
    int inc1 = 1;
    const double twonorm = dlange_( &frobenius, &veclength, &inc1, current_vector, &veclength, NULL ); // Work is not referenced for Frobenius norm
@@ -217,7 +315,7 @@ void CheMPS2::Davidson::AddNewVec(){
 
    // Orthogonalize the new vector w.r.t. the old basis
    for ( int cnt = 0; cnt < num_vec; cnt++ ){
-      double minus_overlap = - ddot_( &veclength, t_vec, &inc1, vecs[ cnt ], &inc1 );
+      double minus_overlap = - InnerProduct( t_vec, vecs[ cnt ] );
       daxpy_( &veclength, &minus_overlap, vecs[ cnt ], &inc1, t_vec, &inc1 );
    }
 
@@ -226,7 +324,9 @@ void CheMPS2::Davidson::AddNewVec(){
    dscal_( &veclength, &alpha, t_vec, &inc1 );
 
    // The new vector becomes part of vecs
-   if ( num_vec < num_allocated ){
+   if ( disk_storage != NULL ){
+      dcopy_( &veclength, t_vec, &inc1, vecs[ num_vec ], &inc1 );
+   } else if ( num_vec < num_allocated ){
       double * temp = vecs[ num_vec ];
       vecs[ num_vec ] = t_vec;
       t_vec = temp;
@@ -243,23 +343,20 @@ double CheMPS2::Davidson::DiagonalizeSmallMatrixAndCalcResidual(){
 
    int inc1 = 1;
 
+   // The new column of mxM is summed over the MPI processes at once if distributed
+   double * column = mxM + MAX_NUM_VEC * num_vec;
    if ( problem_type == 'E' ){ // EIGENVALUE PROBLEM
       // mxM contains V^T . A . V
-      for ( int cnt = 0; cnt < num_vec; cnt++ ){
-         mxM[ cnt + MAX_NUM_VEC * num_vec ] = ddot_( &veclength, vecs[ num_vec ], &inc1, Hvecs[ cnt ], &inc1 );
-         mxM[ num_vec + MAX_NUM_VEC * cnt ] = mxM[ cnt + MAX_NUM_VEC * num_vec ];
-      }
-      mxM[ num_vec + MAX_NUM_VEC * num_vec ] = ddot_( &veclength, vecs[ num_vec ], &inc1, Hvecs[ num_vec ], &inc1 );
+      for ( int cnt = 0; cnt <= num_vec; cnt++ ){ column[ cnt ] = ddot_( &veclength, vecs[ num_vec ], &inc1, Hvecs[ cnt ], &inc1 ); }
+      SumOverProcesses( column, num_vec + 1 );
    } else { // LINEAR PROBLEM
       // mxM contains V^T . A^T . A . V
-      for ( int cnt = 0; cnt < num_vec; cnt++ ){
-         mxM[ cnt + MAX_NUM_VEC * num_vec ] = ddot_( &veclength, Hvecs[ num_vec ], &inc1, Hvecs[ cnt ], &inc1 );
-         mxM[ num_vec + MAX_NUM_VEC * cnt ] = mxM[ cnt + MAX_NUM_VEC * num_vec ];
-      }
-      mxM[ num_vec + MAX_NUM_VEC * num_vec ] = ddot_( &veclength, Hvecs[ num_vec ], &inc1, Hvecs[ num_vec ], &inc1 );
+      for ( int cnt = 0; cnt <= num_vec; cnt++ ){ column[ cnt ] = ddot_( &veclength, Hvecs[ num_vec ], &inc1, Hvecs[ cnt ], &inc1 ); }
+      SumOverProcesses( column, num_vec + 1 );
       // mxM_rhs contains V^T . A^T . RHS
-      mxM_rhs[ num_vec ] = ddot_( &veclength, Hvecs[ num_vec ], &inc1, RHS, &inc1 );
+      mxM_rhs[ num_vec ] = InnerProduct( Hvecs[ num_vec ], RHS );
    }
+   for ( int cnt = 0; cnt < num_vec; cnt++ ){ mxM[ num_vec + MAX_NUM_VEC * cnt ] = column[ cnt ]; }
 
    // When t-vec was added to vecs, the number of vecs was actually increased by one. Now the number is incremented.
    num_vec++;
@@ -295,6 +392,8 @@ double CheMPS2::Davidson::DiagonalizeSmallMatrixAndCalcResidual(){
       dgemm_( &notra, &notra, &num_vec, &inc1, &num_vec, &one, mxM_vecs, &MAX_NUM_VEC, mxM_work, &MAX_NUM_VEC, &set, mxM_work + MAX_NUM_VEC, &MAX_NUM_VEC );
       for ( int cnt = 0; cnt < num_vec; cnt++ ){ mxM_vecs[ cnt ] = mxM_work[ MAX_NUM_VEC + cnt ]; } // mxM_vecs = U * eigs^{-1} * U^T * RHS
    }
+   BroadcastFromMaster( mxM_vecs, MAX_NUM_VEC * num_vec );
+   BroadcastFromMaster( mxM_eigs, num_vec );
 
    // Calculate u and r. r is stored in t_vec, u in u_vec.
    for ( int cnt = 0; cnt < veclength; cnt++ ){ t_vec[ cnt ] = 0.0; }
@@ -335,7 +434,7 @@ void CheMPS2::Davidson::CalculateNewVec(){
          if ( debug_print ){ cout << "WARNING AT DAVIDSON : fabs( precon[" << cnt << "] ) = " << fabsdiff << endl; }
       }
    }
-   double alpha = - ddot_( &veclength, work_vec, &inc1, t_vec, &inc1 ) / ddot_( &veclength, work_vec, &inc1, u_vec, &inc1 ); // alpha = - (u^T K^(-1) r) / (u^T K^(-1) u)
+   double alpha = - InnerProduct( work_vec, t_vec ) / InnerProduct( work_vec, u_vec ); // alpha = - (u^T K^(-1) r) / (u^T K^(-1) u)
    daxpy_( &veclength, &alpha, u_vec, &inc1, t_vec, &inc1 ); // t_vec = r - (u^T K^(-1) r) / (u^T K^(-1) u) u
    for ( int cnt = 0; cnt < veclength; cnt++ ){
       const double difference = diag[ cnt ] - shift;
@@ -369,14 +468,13 @@ void CheMPS2::Davidson::Deflation(){
       if ( Reortho_Overlap_eigs == NULL ){ Reortho_Overlap_eigs = new double[ NUM_VEC_KEEP                ]; }
       if ( Reortho_Lowdin       == NULL ){ Reortho_Lowdin       = new double[ NUM_VEC_KEEP * NUM_VEC_KEEP ]; }
    
-      // Construct the lowest NUM_VEC_KEEP eigenvectors
+      // Construct the lowest NUM_VEC_KEEP eigenvectors; the vectors are streamed one by one, which matters when they are on disk
       dcopy_( &veclength, u_vec, &inc1, Reortho_Eigenvecs, &inc1 );
       for ( int cnt = 1; cnt < NUM_VEC_KEEP; cnt++ ){
-         for ( int irow = 0; irow < veclength; irow++ ){
-            Reortho_Eigenvecs[ irow + veclength * cnt ] = 0.0;
-            for ( int ivec = 0; ivec < MAX_NUM_VEC; ivec++ ){
-               Reortho_Eigenvecs[ irow + veclength * cnt ] += vecs[ ivec ][ irow ] * mxM_vecs[ ivec + MAX_NUM_VEC * cnt ];
-            }
+         double * eigenvec = Reortho_Eigenvecs + ( ( size_t ) veclength ) * cnt;
+         for ( int irow = 0; irow < veclength; irow++ ){ eigenvec[ irow ] = 0.0; }
+         for ( int ivec = 0; ivec < MAX_NUM_VEC; ivec++ ){
+            daxpy_( &veclength, mxM_vecs + ivec + MAX_NUM_VEC * cnt, vecs[ ivec ], &inc1, eigenvec, &inc1 );
          }
       }
 
@@ -385,7 +483,9 @@ void CheMPS2::Davidson::Deflation(){
       char notr   = 'N';
       double one  = 1.0;
       double zero = 0.0; //set
-      dgemm_( &trans, &notr, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &veclength, &one, Reortho_Eigenvecs, &veclength, Reortho_Eigenvecs, &veclength, &zero, Reortho_Overlap, &NUM_VEC_KEEP );
+      int ld_eigenvecs = (( veclength > 0 ) ? veclength : 1 ); // A process can own an empty segment if distributed
+      dgemm_( &trans, &notr, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &veclength, &one, Reortho_Eigenvecs, &ld_eigenvecs, Reortho_Eigenvecs, &ld_eigenvecs, &zero, Reortho_Overlap, &NUM_VEC_KEEP );
+      SumOverProcesses( Reortho_Overlap, NUM_VEC_KEEP * NUM_VEC_KEEP );
 
       // Calculate the Lowdin tfo
       char jobz = 'V';
@@ -397,6 +497,7 @@ void CheMPS2::Davidson::Deflation(){
          dscal_( &NUM_VEC_KEEP, Reortho_Overlap_eigs + icnt, Reortho_Overlap + NUM_VEC_KEEP * icnt, &inc1 );
       }
       dgemm_( &notr, &trans, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &NUM_VEC_KEEP, &one, Reortho_Overlap, &NUM_VEC_KEEP, Reortho_Overlap, &NUM_VEC_KEEP, &zero, Reortho_Lowdin, &NUM_VEC_KEEP );
+      BroadcastFromMaster( Reortho_Lowdin, NUM_VEC_KEEP * NUM_VEC_KEEP );
 
       // Reortho: Put the Lowdin tfo eigenvecs in vecs
       for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){
@@ -500,6 +601,7 @@ void CheMPS2::Davidson::SolveLinearSystemDeflation( const int NUM_SOLUTIONS ){
       int size = MAX_NUM_VEC * NUM_SOLUTIONS;
       dcopy_( &size, work2, &inc1, mxM_vecs, &inc1 );
    }
+   BroadcastFromMaster( mxM_vecs, MAX_NUM_VEC * NUM_SOLUTIONS );
 
    delete [] work1;
    delete [] work2;
@@ -511,27 +613,35 @@ void CheMPS2::Davidson::MxMafterDeflation(){
 
    int inc1 = 1;
 
-   if ( problem_type == 'E' ){ // EIGENVALUE PROBLEM
-      // mxM contains V^T . A . V
-      for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){
-         for ( int ivec2 = ivec; ivec2 < NUM_VEC_KEEP; ivec2++ ){
-            mxM[ ivec + MAX_NUM_VEC * ivec2 ] = ddot_( &veclength, vecs[ ivec ], &inc1, Hvecs[ ivec2 ], &inc1 );
-            mxM[ ivec2 + MAX_NUM_VEC * ivec ] = mxM[ ivec + MAX_NUM_VEC * ivec2 ];
-         }
-      }
-   } else { // LINEAR PROBLEM
-      // mxM contains V^T . A^T . A . V
-      for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){
-         for ( int ivec2 = ivec; ivec2 < NUM_VEC_KEEP; ivec2++ ){
-            mxM[ ivec + MAX_NUM_VEC * ivec2 ] = ddot_( &veclength, Hvecs[ ivec ], &inc1, Hvecs[ ivec2 ], &inc1 );
-            mxM[ ivec2 + MAX_NUM_VEC * ivec ] = mxM[ ivec + MAX_NUM_VEC * ivec2 ];
+   // The upper triangle of mxM is summed over the MPI processes at once if distributed
+   const int num_elem = ( NUM_VEC_KEEP * ( NUM_VEC_KEEP + 1 ) ) / 2;
+   double * triangle = new double[ num_elem ];
+   int elem = 0;
+   for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){
+      for ( int ivec2 = ivec; ivec2 < NUM_VEC_KEEP; ivec2++ ){
+         if ( problem_type == 'E' ){ // EIGENVALUE PROBLEM: mxM contains V^T . A . V
+            triangle[ elem ] = ddot_( &veclength,  vecs[ ivec ], &inc1, Hvecs[ ivec2 ], &inc1 );
+         } else {                    // LINEAR PROBLEM: mxM contains V^T . A^T . A . V
+            triangle[ elem ] = ddot_( &veclength, Hvecs[ ivec ], &inc1, Hvecs[ ivec2 ], &inc1 );
          }
+         elem++;
       }
-      // mxM_rhs contains V^T . A^T . RHS
-      for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){
-         mxM_rhs[ ivec ] = ddot_( &veclength, Hvecs[ ivec ], &inc1, RHS, &inc1 );
+   }
+   SumOverProcesses( triangle, num_elem );
+   elem = 0;
+   for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){
+      for ( int ivec2 = ivec; ivec2 < NUM_VEC_KEEP; ivec2++ ){
+         mxM[ ivec + MAX_NUM_VEC * ivec2 ] = triangle[ elem ];
+         mxM[ ivec2 + MAX_NUM_VEC * ivec ] = triangle[ elem ];
+         elem++;
       }
    }
+   delete [] triangle;
+
+   if ( problem_type == 'L' ){ // mxM_rhs contains V^T . A^T . RHS
+      for ( int ivec = 0; ivec < NUM_VEC_KEEP; ivec++ ){ mxM_rhs[ ivec ] = ddot_( &veclength, Hvecs[ ivec ], &inc1, RHS, &inc1 ); }
+      SumOverProcesses( mxM_rhs, NUM_VEC_KEEP );
+   }
 
 }
 
@@ -23,6 +23,8 @@
 #include <math.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <unistd.h>
+#include <sstream>
 #include <algorithm>
 
 using std::cout;
@@ -32,13 +34,27 @@ using std::endl;
 #include "Irreps.h"
 #include "Lapack.h"
 #include "Davidson.h"
-#include "ConjugateGradient.h"
+#include "MPIchemps2.h"
 
-CheMPS2::FCI::FCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsigned int theNel_down, const int TargetIrrep_in, const double maxMemWorkMB_in, const int FCIverbose_in){
+// Number of set bits in a bit string
+static inline unsigned int bitcount( const unsigned int bitstring ){
+
+   #ifdef __GNUC__
+      return __builtin_popcount( bitstring );
+   #else
+      unsigned int number = 0;
+      for ( unsigned int remainder = bitstring; remainder != 0; remainder &= ( remainder - 1 ) ){ number++; }
+      return number;
+   #endif
+
+}
+
+CheMPS2::FCI::FCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsigned int theNel_down, const int TargetIrrep_in, const double maxMemWorkMB_in, const int FCIverbose_in, const bool distributed){
 
    // Copy the basic information
    FCIverbose   = FCIverbose_in;
    maxMemWorkMB = maxMemWorkMB_in;
+   mpi_distributed = (( distributed ) && ( MPIchemps2::mpi_size() > 1 ));
    L = Ham->getL();
    assert( theNel_up    <= L );
    assert( theNel_down  <= L );
@@ -77,10 +93,50 @@ CheMPS2::FCI::FCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsigne
    StartupLookupTables();
    StartupIrrepCenter();
 
+   // The alpha string irrep blocks of the target irrep go to the MPI process with the fewest determinants so far, largest blocks first
+   mpi_block_owner = new int[ num_irreps ];
+   {
+      const int num_procs = MPIchemps2::mpi_size();
+      unsigned long long * load = new unsigned long long[ num_procs ];
+      bool * assigned = new bool[ num_irreps ];
+      for ( int rank = 0; rank < num_procs; rank++ ){ load[ rank ] = 0; }
+      for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){ assigned[ irrep_up ] = false; }
+      for ( unsigned int count = 0; count < num_irreps; count++ ){
+         int largest = -1;
+         for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+            const unsigned int size = irrep_center_jumps[ 0 ][ irrep_up + 1 ] - irrep_center_jumps[ 0 ][ irrep_up ];
+            if (( !assigned[ irrep_up ] ) && (( largest == -1 ) || ( size > irrep_center_jumps[ 0 ][ largest + 1 ] - irrep_center_jumps[ 0 ][ largest ] ))){ largest = irrep_up; }
+         }
+         int lightest = 0;
+         for ( int rank = 1; rank < num_procs; rank++ ){ if ( load[ rank ] < load[ lightest ] ){ lightest = rank; } }
+         mpi_block_owner[ largest ] = lightest;
+         load[ lightest ] += irrep_center_jumps[ 0 ][ largest + 1 ] - irrep_center_jumps[ 0 ][ largest ];
+         assigned[ largest ] = true;
+      }
+      delete [] load;
+      delete [] assigned;
+   }
+
+   // No limit on the total memory until setMaxMemTotalMB is called
+   maxMemTotalMB = 0.0;
+
+   // Determinant basis in GSDavidson until SpinAdapt is called
+   csf_TwoS      = -1;
+   csf_num       = 0;
+   csf_num_conf  = 0;
+   csf_conf_open = NULL;
+   csf_conf_det  = NULL;
+   csf_det       = NULL;
+   csf_conf_fun  = NULL;
+   csf_coeff     = NULL;
+
 }
 
 CheMPS2::FCI::~FCI(){
    
+   // FCI::SpinAdapt
+   DeleteCSF();
+   
    // FCI::FCI
    delete [] orb2irrep;
    delete [] Gmat;
@@ -103,20 +159,18 @@ CheMPS2::FCI::~FCI(){
    // FCI::StartupLookupTables
    for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
       for ( unsigned int ij = 0; ij < L * L; ij++ ){
-         delete [] lookup_cnt_alpha[irrep][ij];
-         delete [] lookup_cnt_beta[irrep][ij];
-         delete [] lookup_sign_alpha[irrep][ij];
-         delete [] lookup_sign_beta[irrep][ij];
+         delete [] lookup_alpha[irrep][ij];
+         delete [] lookup_beta[irrep][ij];
       }
-      delete [] lookup_cnt_alpha[irrep];
-      delete [] lookup_cnt_beta[irrep];
-      delete [] lookup_sign_alpha[irrep];
-      delete [] lookup_sign_beta[irrep];
+      delete [] lookup_alpha[irrep];
+      delete [] lookup_beta[irrep];
+      delete [] lookup_num_alpha[irrep];
+      delete [] lookup_num_beta[irrep];
    }
-   delete [] lookup_cnt_alpha;
-   delete [] lookup_cnt_beta;
-   delete [] lookup_sign_alpha;
-   delete [] lookup_sign_beta;
+   delete [] lookup_alpha;
+   delete [] lookup_beta;
+   delete [] lookup_num_alpha;
+   delete [] lookup_num_beta;
 
    // FCI::StartupIrrepCenter
    for ( unsigned int irrep=0; irrep<num_irreps; irrep++ ){
@@ -131,6 +185,7 @@ CheMPS2::FCI::~FCI(){
    delete [] HXVworksmall;
    delete [] HXVworkbig1;
    delete [] HXVworkbig2;
+   delete [] mpi_block_owner;
 
 }
 
@@ -214,112 +269,108 @@ void CheMPS2::FCI::StartupCountersVsBitstrings(){
 void CheMPS2::FCI::StartupLookupTables(){
 
    // Create a bunch of stuff
-   lookup_cnt_alpha  = new int**[ num_irreps ];
-   lookup_cnt_beta   = new int**[ num_irreps ];
-   lookup_sign_alpha = new int**[ num_irreps ];
-   lookup_sign_beta  = new int**[ num_irreps ];
-
-   int * bits = new int[ L ]; // Temporary helper array
-
-   // Quick lookup tables for " sign | new > = E^spinproj_{ij} | old >
+   lookup_num_alpha = new int* [ num_irreps ];
+   lookup_num_beta  = new int* [ num_irreps ];
+   lookup_alpha     = new int**[ num_irreps ];
+   lookup_beta      = new int**[ num_irreps ];
+
+   /* Quick lookup lists for " sign | new > = E^spinproj_{ij} | old >
+      Only the nonzero excitations are stored, in order of increasing new counter, as the pair ( new , sign * ( old + 1 ) ).
+      The first sweep over the strings counts them, and the second sweep fills them. */
    for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
 
-      const unsigned int num_up   = numPerIrrep_up  [ irrep ];
-      const unsigned int num_down = numPerIrrep_down[ irrep ];
-
-      lookup_cnt_alpha [ irrep ] = new int*[ L * L ];
-      lookup_cnt_beta  [ irrep ] = new int*[ L * L ];
-      lookup_sign_alpha[ irrep ] = new int*[ L * L ];
-      lookup_sign_beta [ irrep ] = new int*[ L * L ];
+      lookup_num_alpha[ irrep ] = new int [ L * L ];
+      lookup_num_beta [ irrep ] = new int [ L * L ];
+      lookup_alpha    [ irrep ] = new int*[ L * L ];
+      lookup_beta     [ irrep ] = new int*[ L * L ];
 
-      for ( unsigned int ij = 0; ij < L * L; ij++ ){
-
-         lookup_cnt_alpha [ irrep ][ ij ] = new int[ num_up ];
-         lookup_cnt_beta  [ irrep ][ ij ] = new int[ num_down ];
-         lookup_sign_alpha[ irrep ][ ij ] = new int[ num_up ];
-         lookup_sign_beta [ irrep ][ ij ] = new int[ num_down ];
+      for ( int sweep = 0; sweep < 2; sweep++ ){
 
-         for ( unsigned int cnt_new_alpha = 0; cnt_new_alpha < num_up; cnt_new_alpha++ ){
-            // Check for the sign. If no check for sign, you multiply with sign 0 and everything should be OK...
-            lookup_cnt_alpha [ irrep ][ ij ][ cnt_new_alpha ] = 0;
-            lookup_sign_alpha[ irrep ][ ij ][ cnt_new_alpha ] = 0;
+         if ( sweep == 1 ){
+            for ( unsigned int ij = 0; ij < L * L; ij++ ){
+               lookup_alpha[ irrep ][ ij ] = new int[ 2 * lookup_num_alpha[ irrep ][ ij ] ];
+               lookup_beta [ irrep ][ ij ] = new int[ 2 * lookup_num_beta [ irrep ][ ij ] ];
+            }
          }
-         for ( unsigned int cnt_new_beta = 0; cnt_new_beta < num_down; cnt_new_beta++ ){
-            // Check for the sign. If no check for sign, you multiply with sign and everything should be OK...
-            lookup_cnt_beta [ irrep ][ ij ][ cnt_new_beta ] = 0;
-            lookup_sign_beta[ irrep ][ ij ][ cnt_new_beta ] = 0;
+         for ( unsigned int ij = 0; ij < L * L; ij++ ){
+            lookup_num_alpha[ irrep ][ ij ] = 0;
+            lookup_num_beta [ irrep ][ ij ] = 0;
          }
-      }
-
-      for ( unsigned int cnt_new_alpha = 0; cnt_new_alpha < num_up; cnt_new_alpha++ ){
-
-         str2bits( L , cnt2str_up[ irrep ][ cnt_new_alpha ] , bits );
-
-         int phase_crea = 1;
-         for ( unsigned int crea = 0; crea < L; crea++ ){
-            if ( bits[ crea ] ){
-               bits[ crea ] = 0;
 
-               int phase_anni = 1;
+         for ( unsigned int cnt_new_alpha = 0; cnt_new_alpha < numPerIrrep_up[ irrep ]; cnt_new_alpha++ ){
+            for ( unsigned int crea = 0; crea < L; crea++ ){
                for ( unsigned int anni = 0; anni < L; anni++ ){
-                  if ( !(bits[ anni ]) ){
-                     bits[ anni ] = 1;
-
-                     const int irrep_old = Irreps::directProd( irrep , Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) ) );
-                     const int cnt_old = str2cnt_up[ irrep_old ][ bits2str( L , bits ) ];
-                     const int phase = phase_crea * phase_anni;
-
-                     lookup_cnt_alpha [ irrep ][ crea + L * anni ][ cnt_new_alpha ] = cnt_old;
-                     lookup_sign_alpha[ irrep ][ crea + L * anni ][ cnt_new_alpha ] = phase;
-
-                     bits[ anni ] = 0;
-                  } else {
-                     phase_anni *= -1;
+                  unsigned int string_old;
+                  const int phase = excite_string( cnt2str_up[ irrep ][ cnt_new_alpha ], crea, anni, string_old );
+                  if ( phase != 0 ){
+                     int * entry = lookup_num_alpha[ irrep ] + crea + L * anni;
+                     if ( sweep == 1 ){
+                        const int irrep_old = Irreps::directProd( irrep , Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) ) );
+                        lookup_alpha[ irrep ][ crea + L * anni ][ 2 * (*entry)     ] = cnt_new_alpha;
+                        lookup_alpha[ irrep ][ crea + L * anni ][ 2 * (*entry) + 1 ] = phase * ( str2cnt_up[ irrep_old ][ string_old ] + 1 );
+                     }
+                     (*entry)++;
                   }
                }
+            }
+         }
 
-               bits[ crea ] = 1;
-               phase_crea *= -1;
+         for ( unsigned int cnt_new_beta = 0; cnt_new_beta < numPerIrrep_down[ irrep ]; cnt_new_beta++ ){
+            for ( unsigned int crea = 0; crea < L; crea++ ){
+               for ( unsigned int anni = 0; anni < L; anni++ ){
+                  unsigned int string_old;
+                  const int phase = excite_string( cnt2str_down[ irrep ][ cnt_new_beta ], crea, anni, string_old );
+                  if ( phase != 0 ){
+                     int * entry = lookup_num_beta[ irrep ] + crea + L * anni;
+                     if ( sweep == 1 ){
+                        const int irrep_old = Irreps::directProd( irrep , Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) ) );
+                        lookup_beta[ irrep ][ crea + L * anni ][ 2 * (*entry)     ] = cnt_new_beta;
+                        lookup_beta[ irrep ][ crea + L * anni ][ 2 * (*entry) + 1 ] = phase * ( str2cnt_down[ irrep_old ][ string_old ] + 1 );
+                     }
+                     (*entry)++;
+                  }
+               }
             }
          }
       }
+   }
 
-      for ( unsigned int cnt_new_beta = 0; cnt_new_beta < num_down; cnt_new_beta++ ){
-
-         str2bits( L , cnt2str_down[ irrep ][ cnt_new_beta ] , bits );
+   if ( FCIverbose > 0 ){
+      unsigned long long num_entries = 0;
+      for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+         for ( unsigned int ij = 0; ij < L * L; ij++ ){
+            num_entries += lookup_num_alpha[ irrep ][ ij ] + lookup_num_beta[ irrep ][ ij ];
+         }
+      }
+      cout << "FCI::Startup : The single excitation lookup lists require " << ( 2.0 * sizeof(int) * num_entries ) / 1048576 << " MB memory." << endl;
+   }
 
-         int phase_crea = 1;
-         for ( unsigned int crea = 0; crea < L; crea++ ){
-            if ( bits[ crea ] ){
-               bits[ crea ] = 0;
+}
 
-               int phase_anni = 1;
-               for ( unsigned int anni = 0; anni < L; anni++ ){
-                  if ( !(bits[ anni ]) ){
-                     bits[ anni ] = 1;
+int CheMPS2::FCI::excite_string( const unsigned int string_result, const unsigned int crea, const unsigned int anni, unsigned int & string_origin ){
 
-                     const int irrep_old = Irreps::directProd( irrep , Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) ) );
-                     const int cnt_old = str2cnt_down[ irrep_old ][ bits2str( L , bits ) ];
-                     const int phase = phase_crea * phase_anni;
+   // The creator should be occupied in | result >, and the annihilator should be occupied in | origin >
+   if ( ( string_result & ( 1U << crea ) ) == 0 ){ return 0; }
+   const unsigned int string_removed = string_result ^ ( 1U << crea );
+   if ( ( string_removed & ( 1U << anni ) ) != 0 ){ return 0; }
+   string_origin = string_removed | ( 1U << anni );
 
-                     lookup_cnt_beta  [ irrep ][ crea + L * anni ][ cnt_new_beta ] = cnt_old;
-                     lookup_sign_beta [ irrep ][ crea + L * anni ][ cnt_new_beta ] = phase;
+   // The phase is determined by the number of occupied orbitals in front of crea in | result > and in front of anni in | origin > without anni
+   const unsigned int num_swaps = bitcount( string_result & ( ( 1U << crea ) - 1 ) ) + bitcount( string_removed & ( ( 1U << anni ) - 1 ) );
+   return (( num_swaps & 1U ) ? -1 : 1 );
 
-                     bits[ anni ] = 0;
-                  } else {
-                     phase_anni *= -1;
-                  }
-               }
+}
 
-               bits[ crea ] = 1;
-               phase_crea *= -1;
-            }
-         }
-      }
+int CheMPS2::FCI::lookup_first( const int num_exc, const int * exc, const unsigned int value ){
 
+   int lower = 0;
+   int upper = num_exc;
+   while ( lower < upper ){
+      const int middle = ( lower + upper ) / 2;
+      if ( ( unsigned int )( exc[ 2 * middle ] ) < value ){ lower = middle + 1; }
+      else { upper = middle; }
    }
-
-   delete [] bits; // Delete temporary helper array
+   return lower;
 
 }
 
@@ -372,17 +423,17 @@ void CheMPS2::FCI::StartupIrrepCenter(){
       }
       assert( check <= ((unsigned int) INT_MAX ) ); // Length of FCI vectors should be less then the SIGNED integer size (to be able to call lapack)
    }
+   double num_megabytes = ( 2.0 * sizeof(double) * HXVsizeWorkspace ) / 1048576;
    if ( FCIverbose > 0 ){
       cout << "FCI::Startup : Number of variables in the FCI vector = " << getVecLength( 0 ) << endl;
-      double num_megabytes = ( 2.0 * sizeof(double) * HXVsizeWorkspace ) / 1048576;
       cout << "FCI::Startup : Without additional loops the FCI matrix-vector product requires a workspace of " << num_megabytes << " MB memory." << endl;
-      if ( maxMemWorkMB < num_megabytes ){
-         HXVsizeWorkspace = (unsigned int) ceil( ( maxMemWorkMB * 1048576 ) / ( 2 * sizeof(double) ) );
-         num_megabytes = ( 2.0 * sizeof(double) * HXVsizeWorkspace ) / 1048576;
-         cout << "               For practical purposes, the workspace is constrained to " << num_megabytes << " MB memory." << endl;
-      }
    }
-   HXVworksmall = new double[ L * L * L * L ];
+   if ( maxMemWorkMB < num_megabytes ){
+      HXVsizeWorkspace = (unsigned int) ceil( ( maxMemWorkMB * 1048576 ) / ( 2 * sizeof(double) ) );
+      num_megabytes = ( 2.0 * sizeof(double) * HXVsizeWorkspace ) / 1048576;
+      if ( FCIverbose > 0 ){ cout << "               For practical purposes, the workspace is constrained to " << num_megabytes << " MB memory." << endl; }
+   }
+   HXVworksmall = new double[ L * L * L * L + L * L ];
    HXVworkbig1  = new double[ HXVsizeWorkspace ];
    HXVworkbig2  = new double[ HXVsizeWorkspace ];
 
@@ -527,89 +578,94 @@ double CheMPS2::FCI::getFCIcoeff(int * bits_up, int * bits_down, double * vector
 
 }*/
 
-void CheMPS2::FCI::excite_alpha_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int dim_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_alpha_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int dim_down, double * origin, double * result, const int num_exc, const int * exc ){
 
    #pragma omp parallel for schedule(static)
-   for ( unsigned int cnt_new_up = 0; cnt_new_up < dim_new_up; cnt_new_up++ ){
-      const int sign_up = signmap[ cnt_new_up ];
-      if ( sign_up != 0 ){
-         const int cnt_old_up = countmap[ cnt_new_up ];
-         for ( unsigned int cnt_down = 0; cnt_down < dim_down; cnt_down++ ){
-            result[ cnt_new_up + dim_new_up * cnt_down ] += sign_up * origin[ cnt_old_up + dim_old_up * cnt_down ];
-         }
+   for ( int entry = 0; entry < num_exc; entry++ ){
+      const int cnt_new_up = exc[ 2 * entry ];
+      const int packed     = exc[ 2 * entry + 1 ];
+      const int sign_up    = (( packed > 0 ) ? 1 : -1 );
+      const int cnt_old_up = sign_up * packed - 1;
+      for ( unsigned int cnt_down = 0; cnt_down < dim_down; cnt_down++ ){
+         result[ cnt_new_up + dim_new_up * cnt_down ] += sign_up * origin[ cnt_old_up + dim_old_up * cnt_down ];
       }
    }
 
 }
 
-void CheMPS2::FCI::excite_beta_omp( const unsigned int dim_up, const unsigned int dim_new_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_beta_omp( const unsigned int dim_up, double * origin, double * result, const int num_exc, const int * exc ){
 
    #pragma omp parallel for schedule(static)
-   for ( unsigned int cnt_new_down = 0; cnt_new_down < dim_new_down; cnt_new_down++ ){
-      const int sign_down = signmap[ cnt_new_down ];
-      if ( sign_down != 0 ){
-         const int cnt_old_down = countmap[ cnt_new_down ];
-         for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
-            result[ cnt_up + dim_up * cnt_new_down ] += sign_down * origin[ cnt_up + dim_up * cnt_old_down ];
-         }
+   for ( int entry = 0; entry < num_exc; entry++ ){
+      const int cnt_new_down = exc[ 2 * entry ];
+      const int packed       = exc[ 2 * entry + 1 ];
+      const int sign_down    = (( packed > 0 ) ? 1 : -1 );
+      const int cnt_old_down = sign_down * packed - 1;
+      for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
+         result[ cnt_up + dim_up * cnt_new_down ] += sign_down * origin[ cnt_up + dim_up * cnt_old_down ];
       }
    }
 
 }
 
-void CheMPS2::FCI::excite_alpha_first( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_alpha_first( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, const int num_exc, const int * exc ){
 
-   for ( unsigned int cnt_new_up = 0; cnt_new_up < dim_new_up; cnt_new_up++ ){
-      const int sign_up = signmap[ cnt_new_up ];
-      if ( sign_up != 0 ){
-         const int cnt_old_up = countmap[ cnt_new_up ];
-         for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
-            result[ cnt_new_up + dim_new_up * ( cnt_down - start_down ) ] += sign_up * origin[ cnt_old_up + dim_old_up * cnt_down ];
-         }
+   for ( int entry = 0; entry < num_exc; entry++ ){
+      const int cnt_new_up = exc[ 2 * entry ];
+      const int packed     = exc[ 2 * entry + 1 ];
+      const int sign_up    = (( packed > 0 ) ? 1 : -1 );
+      const int cnt_old_up = sign_up * packed - 1;
+      for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
+         result[ cnt_new_up + dim_new_up * ( cnt_down - start_down ) ] += sign_up * origin[ cnt_old_up + dim_old_up * cnt_down ];
       }
    }
 
 }
 
-void CheMPS2::FCI::excite_beta_first( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_beta_first( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, const int num_exc, const int * exc ){
 
-   for ( unsigned int cnt_new_down = start_down; cnt_new_down < stop_down; cnt_new_down++ ){
-      const int sign_down = signmap[ cnt_new_down ];
-      if ( sign_down != 0 ){
-         const int cnt_old_down = countmap[ cnt_new_down ];
-         for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
-            result[ cnt_up + dim_up * ( cnt_new_down - start_down ) ] += sign_down * origin[ cnt_up + dim_up * cnt_old_down ];
-         }
+   const int stop_entry = lookup_first( num_exc, exc, stop_down );
+   for ( int entry = lookup_first( num_exc, exc, start_down ); entry < stop_entry; entry++ ){
+      const unsigned int cnt_new_down = exc[ 2 * entry ];
+      const int packed       = exc[ 2 * entry + 1 ];
+      const int sign_down    = (( packed > 0 ) ? 1 : -1 );
+      const int cnt_old_down = sign_down * packed - 1;
+      for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
+         result[ cnt_up + dim_up * ( cnt_new_down - start_down ) ] += sign_down * origin[ cnt_up + dim_up * cnt_old_down ];
       }
    }
 
 }
 
-void CheMPS2::FCI::excite_alpha_second_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_alpha_second_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, const int num_exc, const int * exc ){
 
+   // Different entries have different cnt_old_up and cnt_new_up, which is required for thread safety
    #pragma omp parallel for schedule(static)
-   for ( unsigned int cnt_old_up = 0; cnt_old_up < dim_old_up; cnt_old_up++ ){
-      const int sign_up = signmap[ cnt_old_up ];
-      if ( sign_up != 0 ){ // Required for thread safety
-         const int cnt_new_up = countmap[ cnt_old_up ];
-         for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
-            result[ cnt_new_up + dim_new_up * cnt_down ] += sign_up * origin[ cnt_old_up + dim_old_up * ( cnt_down - start_down ) ];
-         }
+   for ( int entry = 0; entry < num_exc; entry++ ){
+      const int cnt_old_up = exc[ 2 * entry ];
+      const int packed     = exc[ 2 * entry + 1 ];
+      const int sign_up    = (( packed > 0 ) ? 1 : -1 );
+      const int cnt_new_up = sign_up * packed - 1;
+      for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
+         result[ cnt_new_up + dim_new_up * cnt_down ] += sign_up * origin[ cnt_old_up + dim_old_up * ( cnt_down - start_down ) ];
       }
    }
 
 }
 
-void CheMPS2::FCI::excite_beta_second_omp( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap ){
+void CheMPS2::FCI::excite_beta_second_omp( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, const int num_exc, const int * exc ){
 
+   // Different entries have different cnt_old_down and cnt_new_down, which is required for thread safety
+   const int start_entry = lookup_first( num_exc, exc, start_down );
+   const int  stop_entry = lookup_first( num_exc, exc, stop_down );
    #pragma omp parallel for schedule(static)
-   for ( unsigned int cnt_old_down = start_down; cnt_old_down < stop_down; cnt_old_down++ ){
-      const int sign_down = signmap[ cnt_old_down ];
-      if ( sign_down != 0 ){ // Required for thread safety
-         const int cnt_new_down = countmap[ cnt_old_down ];
-         for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
-            result[ cnt_up + dim_up * cnt_new_down ] += sign_down * origin[ cnt_up + dim_up * ( cnt_old_down - start_down ) ];
-         }
+   for ( int entry = start_entry; entry < stop_entry; entry++ ){
+      const unsigned int cnt_old_down = exc[ 2 * entry ];
+      const int packed       = exc[ 2 * entry + 1 ];
+      const int sign_down    = (( packed > 0 ) ? 1 : -1 );
+      const int cnt_new_down = sign_down * packed - 1;
+      for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
+         result[ cnt_up + dim_up * cnt_new_down ] += sign_down * origin[ cnt_up + dim_up * ( cnt_old_down - start_down ) ];
       }
    }
 
@@ -617,12 +673,51 @@ void CheMPS2::FCI::excite_beta_second_omp( const unsigned int dim_up, const unsi
 
 void CheMPS2::FCI::matvec( double * input, double * output ) const{
 
+   matvec( &input, &output, 1 );
+
+}
+
+unsigned int CheMPS2::FCI::MatvecMaxVec() const{
+
+   // At least one full column for each of the vectors should fit in the workspaces
+   unsigned long long max_column = 1;
+   for ( unsigned int irrep_center = 0; irrep_center < num_irreps; irrep_center++ ){
+      for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+         max_column = std::max( max_column, ( unsigned long long ) numPerIrrep_up[ irrep_up ] * irrep_center_num[ irrep_center ] );
+      }
+   }
+   return std::max( ( unsigned long long ) 1, HXVsizeWorkspace / max_column );
+
+}
+
+void CheMPS2::FCI::matvec( double ** input, double ** output, const unsigned int num_vec, const bool distributed, const unsigned int * jumps ) const{
+
+   // The vectors share the persistent workspaces, so that maxMemWorkMB is respected: the beta blocks become smaller when num_vec grows
+   const unsigned long long size_work = HXVsizeWorkspace;
+   const unsigned int max_vec = MatvecMaxVec();
+   if ( num_vec > max_vec ){
+      for ( unsigned int first = 0; first < num_vec; first += max_vec ){
+         matvec( input + first, output + first, std::min( max_vec, num_vec - first ), distributed, jumps );
+      }
+      return;
+   }
+   if ( jumps == NULL ){ jumps = irrep_center_jumps[ 0 ]; }
+
    struct timeval start, end;
    gettimeofday( &start, NULL );
 
-   ClearVector( getVecLength( 0 ), output );
+   double * workbig1 = HXVworkbig1;
+   double * workbig2 = HXVworkbig2;
+
+   for ( unsigned int vec = 0; vec < num_vec; vec++ ){ ClearVector( jumps[ num_irreps ], output[ vec ] ); }
 
    // P.J. Knowles and N.C. Handy, A new determinant-based full configuration interaction method, Chemical Physics Letters 111 (4-5), 315-321 (1984)
+   // The num_vec vectors are handled together, so that the two-body part is a single dgemm_ with num_vec times more rows
+   // A work unit is one beta block of one ( irrep_center, irrep_center_up ) combination; if distributed, each MPI rank only does the units it owns
+   int work_unit = 0;
+   #ifdef CHEMPS2_MPI_COMPILATION
+      const int MPIRANK = MPIchemps2::mpi_rank();
+   #endif
 
    // irrep_center is the center irrep of the ERI : (ij|kl) --> irrep_center = I_i x I_j = I_k x I_l
    for ( unsigned int irrep_center = 0; irrep_center < num_irreps; irrep_center++ ){
@@ -631,14 +726,30 @@ void CheMPS2::FCI::matvec( double * input, double * output ) const{
       const unsigned int num_pairs  = irrep_center_num[ irrep_center ];
       const unsigned int * center_crea_orb = irrep_center_crea_orb[ irrep_center ];
       const unsigned int * center_anni_orb = irrep_center_anni_orb[ irrep_center ];
-      const unsigned int * zero_jumps = irrep_center_jumps[ 0 ];
+      const unsigned int * zero_jumps = jumps;
+
+      // HXVworksmall[ pair1 + num_pairs * pair2 ] = 0.5 * ( pair1 | pair2 ) and, if irrep_center == 0, HXVworksmall[ num_pairs * num_pairs + pair ] = Gmat[ pair ]
+      double * eri_pairs = HXVworksmall;
+      double * one_pairs = HXVworksmall + num_pairs * num_pairs;
+      for ( unsigned int pair1 = 0; pair1 < num_pairs; pair1++ ){
+         for ( unsigned int pair2 = 0; pair2 < num_pairs; pair2++ ){
+            eri_pairs[ pair1 + num_pairs * pair2 ]
+               = 0.5 * getERI( center_crea_orb[ pair1 ], center_anni_orb[ pair1 ] ,
+                               center_crea_orb[ pair2 ], center_anni_orb[ pair2 ] );
+         }
+      }
+      if ( irrep_center == 0 ){
+         for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
+            one_pairs[ pair ] = getGmat( center_crea_orb[ pair ], center_anni_orb[ pair ] );
+         }
+      }
 
       for ( unsigned int irrep_center_up = 0; irrep_center_up < num_irreps; irrep_center_up++ ){
          const int irrep_center_down = Irreps::directProd( irrep_target_center, irrep_center_up );
          const unsigned int dim_center_up   = numPerIrrep_up  [ irrep_center_up   ];
          const unsigned int dim_center_down = numPerIrrep_down[ irrep_center_down ];
          if ( dim_center_up * dim_center_down > 0 ){
-            const unsigned int blocksize_beta  = HXVsizeWorkspace / std::max( (unsigned int) 1, dim_center_up * num_pairs );
+            const unsigned int blocksize_beta  = size_work / std::max( (unsigned int) 1, dim_center_up * num_pairs * num_vec );
             assert( blocksize_beta > 0 ); // At least one full column should fit in the workspaces...
             unsigned int num_block_beta = dim_center_down / blocksize_beta;
             while ( blocksize_beta * num_block_beta < dim_center_down ){ num_block_beta++; }
@@ -646,115 +757,117 @@ void CheMPS2::FCI::matvec( double * input, double * output ) const{
                const unsigned int start_center_down = block * blocksize_beta;
                const unsigned int  stop_center_down = std::min( ( block + 1 ) * blocksize_beta, dim_center_down );
                const unsigned int size_center = dim_center_up * ( stop_center_down - start_center_down );
-               if ( size_center > 0 ){
-
-                  // First build workbig1[ veccounter + size_center * pair ] = E_{i<=j} + ( 1 - delta_i==j ) E_{j>i} (irrep_center) | input >  */
+               bool do_unit = ( size_center > 0 );
+               #ifdef CHEMPS2_MPI_COMPILATION
+                  if (( distributed ) && ( MPIchemps2::owner_fci_unit( work_unit ) != MPIRANK )){ do_unit = false; }
+               #endif
+               work_unit++;
+               if ( do_unit ){
+
+                  // First build workbig1[ veccounter + size_center * ( vec + num_vec * pair ) ] = E_{i<=j} + ( 1 - delta_i==j ) E_{j>i} (irrep_center) | input[ vec ] >  */
                   #pragma omp parallel for schedule(static)
                   for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
-                     double * target_space   = HXVworkbig1 + size_center * pair;
-                     const unsigned int crea = center_crea_orb[ pair ];
-                     const unsigned int anni = center_anni_orb[ pair ];
-                     const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
-                     const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
-                     const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
-                     for ( unsigned int count = 0; count < size_center; count++ ){ target_space[ count ] = 0.0; }
-
-                     excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down,
-                                         input + zero_jumps[ irrep_zero_up ],
-                                         target_space,
-                                         lookup_sign_alpha[ irrep_center_up ][ crea + L * anni ],
-                                         lookup_cnt_alpha [ irrep_center_up ][ crea + L * anni ] );
-
-                     excite_beta_first( dim_center_up, start_center_down, stop_center_down,
-                                        input + zero_jumps[ irrep_center_up ],
-                                        target_space,
-                                        lookup_sign_beta[ irrep_center_down ][ crea + L * anni ],
-                                        lookup_cnt_beta [ irrep_center_down ][ crea + L * anni ] );
-
-                     if ( anni > crea ){
+                     for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+                        double * target_space   = workbig1 + size_center * ( vec + num_vec * pair );
+                        const unsigned int crea = center_crea_orb[ pair ];
+                        const unsigned int anni = center_anni_orb[ pair ];
+                        const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
+                        const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
+                        const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
+                        for ( unsigned int count = 0; count < size_center; count++ ){ target_space[ count ] = 0.0; }
 
                         excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down,
-                                            input + zero_jumps[ irrep_zero_up ],
+                                            input[ vec ] + zero_jumps[ irrep_zero_up ],
                                             target_space,
-                                            lookup_sign_alpha[ irrep_center_up ][ anni + L * crea ],
-                                            lookup_cnt_alpha [ irrep_center_up ][ anni + L * crea ] );
+                                            lookup_num_alpha[ irrep_center_up ][ crea + L * anni ],
+                                            lookup_alpha    [ irrep_center_up ][ crea + L * anni ] );
 
                         excite_beta_first( dim_center_up, start_center_down, stop_center_down,
-                                           input + zero_jumps[ irrep_center_up ],
+                                           input[ vec ] + zero_jumps[ irrep_center_up ],
                                            target_space,
-                                           lookup_sign_beta[ irrep_center_down ][ anni + L * crea ],
-                                           lookup_cnt_beta [ irrep_center_down ][ anni + L * crea ] );
+                                           lookup_num_beta[ irrep_center_down ][ crea + L * anni ],
+                                           lookup_beta    [ irrep_center_down ][ crea + L * anni ] );
+
+                        if ( anni > crea ){
+
+                           excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down,
+                                               input[ vec ] + zero_jumps[ irrep_zero_up ],
+                                               target_space,
+                                               lookup_num_alpha[ irrep_center_up ][ anni + L * crea ],
+                                               lookup_alpha    [ irrep_center_up ][ anni + L * crea ] );
+
+                           excite_beta_first( dim_center_up, start_center_down, stop_center_down,
+                                              input[ vec ] + zero_jumps[ irrep_center_up ],
+                                              target_space,
+                                              lookup_num_beta[ irrep_center_down ][ anni + L * crea ],
+                                              lookup_beta    [ irrep_center_down ][ anni + L * crea ] );
 
+                        }
                      }
                   }
 
                   // If irrep_center == 0, do the one-body terms
                   if ( irrep_center == 0 ){
-                     for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
-                        HXVworksmall[ pair ] = getGmat( center_crea_orb[ pair ], center_anni_orb[ pair ] );
-                     }
                      char notrans = 'N';
                      double one = 1.0;
                      int mdim = size_center;
                      int kdim = num_pairs;
                      int ndim = 1;
-                     double * target = output + zero_jumps[ irrep_center_up ] + dim_center_up * start_center_down;
-                     dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, HXVworkbig1, &mdim, HXVworksmall, &kdim, &one, target, &mdim );
+                     int lda  = size_center * num_vec;
+                     for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+                        double * target = output[ vec ] + zero_jumps[ irrep_center_up ] + dim_center_up * start_center_down;
+                        dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, workbig1 + size_center * vec, &lda, one_pairs, &kdim, &one, target, &mdim );
+                     }
                   }
 
-                  // Now build workbig2[ veccounter + size_center * new_pair ] = 0.5 * ( new_pair | old_pair ) * workbig1[ veccounter + size_center * old_pair ]
+                  // Now build workbig2[ veccounter + size_center * ( vec + num_vec * new_pair ) ] = 0.5 * ( new_pair | old_pair ) * workbig1[ veccounter + size_center * ( vec + num_vec * old_pair ) ]
                   {
-                     for ( unsigned int pair1 = 0; pair1 < num_pairs; pair1++ ){
-                        for ( unsigned int pair2 = 0; pair2 < num_pairs; pair2++ ){
-                           HXVworksmall[ pair1 + num_pairs * pair2 ]
-                              = 0.5 * getERI( center_crea_orb[ pair1 ], center_anni_orb[ pair1 ] ,
-                                              center_crea_orb[ pair2 ], center_anni_orb[ pair2 ] );
-                        }
-                     }
                      char notrans = 'N';
                      double one = 1.0;
                      double set = 0.0;
-                     int mdim = size_center;
+                     int mdim = size_center * num_vec;
                      int kdim = num_pairs;
                      int ndim = num_pairs;
-                     dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, HXVworkbig1, &mdim, HXVworksmall, &kdim, &set, HXVworkbig2, &mdim );
+                     dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, workbig1, &mdim, eri_pairs, &kdim, &set, workbig2, &mdim );
                   }
 
-                  // Finally do output <-- E_{i<=j} + (1 - delta_{i==j}) E_{j>i} workbig2[ veccounter + size_center * pair ]
+                  // Finally do output[ vec ] <-- E_{i<=j} + (1 - delta_{i==j}) E_{j>i} workbig2[ veccounter + size_center * ( vec + num_vec * pair ) ]
                   for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
-                     double * origin_space   = HXVworkbig2 + size_center * pair;
-                     const unsigned int crea = center_crea_orb[ pair ];
-                     const unsigned int anni = center_anni_orb[ pair ];
-                     const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
-                     const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
-                     const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
-
-                     excite_alpha_second_omp( dim_zero_up, dim_center_up, start_center_down, stop_center_down,
-                                              origin_space,
-                                              output + zero_jumps[ irrep_zero_up ],
-                                              lookup_sign_alpha[ irrep_center_up ][ anni + L * crea ],
-                                              lookup_cnt_alpha [ irrep_center_up ][ anni + L * crea ] );
-
-                     excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down,
-                                             origin_space,
-                                             output + zero_jumps[ irrep_center_up ],
-                                             lookup_sign_beta[ irrep_center_down ][ anni + L * crea ],
-                                             lookup_cnt_beta [ irrep_center_down ][ anni + L * crea ] );
-
-                     if ( anni > crea ){
+                     for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+                        double * origin_space   = workbig2 + size_center * ( vec + num_vec * pair );
+                        const unsigned int crea = center_crea_orb[ pair ];
+                        const unsigned int anni = center_anni_orb[ pair ];
+                        const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
+                        const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
+                        const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
 
                         excite_alpha_second_omp( dim_zero_up, dim_center_up, start_center_down, stop_center_down,
                                                  origin_space,
-                                                 output + zero_jumps[ irrep_zero_up ],
-                                                 lookup_sign_alpha[ irrep_center_up ][ crea + L * anni ],
-                                                 lookup_cnt_alpha [ irrep_center_up ][ crea + L * anni ] );
+                                                 output[ vec ] + zero_jumps[ irrep_zero_up ],
+                                                 lookup_num_alpha[ irrep_center_up ][ anni + L * crea ],
+                                                 lookup_alpha    [ irrep_center_up ][ anni + L * crea ] );
 
                         excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down,
                                                 origin_space,
-                                                output + zero_jumps[ irrep_center_up ],
-                                                lookup_sign_beta[ irrep_center_down ][ crea + L * anni ],
-                                                lookup_cnt_beta [ irrep_center_down ][ crea + L * anni ] );
+                                                output[ vec ] + zero_jumps[ irrep_center_up ],
+                                                lookup_num_beta[ irrep_center_down ][ anni + L * crea ],
+                                                lookup_beta    [ irrep_center_down ][ anni + L * crea ] );
+
+                        if ( anni > crea ){
+
+                           excite_alpha_second_omp( dim_zero_up, dim_center_up, start_center_down, stop_center_down,
+                                                    origin_space,
+                                                    output[ vec ] + zero_jumps[ irrep_zero_up ],
+                                                    lookup_num_alpha[ irrep_center_up ][ crea + L * anni ],
+                                                    lookup_alpha    [ irrep_center_up ][ crea + L * anni ] );
 
+                           excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down,
+                                                   origin_space,
+                                                   output[ vec ] + zero_jumps[ irrep_center_up ],
+                                                   lookup_num_beta[ irrep_center_down ][ crea + L * anni ],
+                                                   lookup_beta    [ irrep_center_down ][ crea + L * anni ] );
+
+                        }
                      }
                   }
                }
@@ -765,7 +878,7 @@ void CheMPS2::FCI::matvec( double * input, double * output ) const{
 
    gettimeofday( &end, NULL );
    const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
-   if ( FCIverbose >= 1 ){ cout << "FCI::matvec : Wall time = " << elapsed << " seconds" << endl; }
+   if ( FCIverbose >= 1 ){ cout << "FCI::matvec : Number of vectors = " << num_vec << " ; Wall time = " << elapsed << " seconds" << endl; }
 
 }
 
@@ -788,22 +901,137 @@ void CheMPS2::FCI::apply_excitation( double * orig_vector, double * result_vecto
                         numPerIrrep_down[ result_irrep_down ], // dim_down
                         orig_vector   + irrep_center_jumps[   orig_irrep_center ][   orig_irrep_up ], // origin
                         result_vector + irrep_center_jumps[ result_irrep_center ][ result_irrep_up ], // result
-                        lookup_sign_alpha[ result_irrep_up ][ crea + L * anni ],   // signmap
-                        lookup_cnt_alpha [ result_irrep_up ][ crea + L * anni ] ); // countmap
+                        lookup_num_alpha[ result_irrep_up ][ crea + L * anni ], // num_exc
+                        lookup_alpha    [ result_irrep_up ][ crea + L * anni ] ); // exc
 
       excite_beta_omp( numPerIrrep_up  [ result_irrep_up   ], // dim_up
-                       numPerIrrep_down[ result_irrep_down ], // dim_new_down
                        orig_vector   + irrep_center_jumps[   orig_irrep_center ][ result_irrep_up ], // origin
                        result_vector + irrep_center_jumps[ result_irrep_center ][ result_irrep_up ], // result
-                       lookup_sign_beta[ result_irrep_down ][ crea + L * anni ],   // signmap
-                       lookup_cnt_beta [ result_irrep_down ][ crea + L * anni ] ); // countmap
+                       lookup_num_beta[ result_irrep_down ][ crea + L * anni ], // num_exc
+                       lookup_beta    [ result_irrep_down ][ crea + L * anni ] ); // exc
+
+   }
+
+}
+
+void CheMPS2::FCI::transpose_blocks( double * origin, double * result, const int irrep_center, const int num_vecs ) const{
+
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+
+      const int irrep_down = Irreps::directProd( Irreps::directProd( irrep_up, TargetIrrep ), irrep_center );
+      const unsigned int dim_up   = numPerIrrep_up  [ irrep_up   ];
+      const unsigned int dim_down = numPerIrrep_down[ irrep_down ];
+      const double * origin_block = origin + num_vecs * irrep_center_jumps[ irrep_center ][ irrep_up ];
+            double * result_block = result + num_vecs * irrep_center_jumps[ irrep_center ][ irrep_up ];
+
+      for ( unsigned int cnt_down = 0; cnt_down < dim_down; cnt_down++ ){
+         for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
+            for ( int vec = 0; vec < num_vecs; vec++ ){
+               result_block[ vec + num_vecs * ( cnt_down + dim_down * cnt_up ) ] = origin_block[ vec + num_vecs * ( cnt_up + dim_up * cnt_down ) ];
+            }
+         }
+      }
+   }
+
+}
+
+void CheMPS2::FCI::transition_excitations( double * bra, double * bra_trans, const int num_bras, double * ket, double * ket_trans, const int ket_target_irrep, const unsigned int crea_min, const unsigned int anni_min, double * result ) const{
+
+   assert(( num_bras == 1 ) || ( num_bras == 2 ));
+   const int excitation_irrep = Irreps::directProd( TargetIrrep, ket_target_irrep );
+   const int ket_irrep_center = excitation_irrep;
+   const int num_pairs = L * L;
+
+   /* < bra | E_{crea,anni} | ket > is a sum of dot products between the rows or columns of bra and ket which are connected by an
+      alpha or beta excitation; no intermediate E_{crea,anni} | ket > is formed. Different pairs write to different result elements.
+      The dot products over the down strings of the alpha excitations use the transposed blocks, so that all dot products are over
+      contiguous elements. With two interleaved bras, each element of ket is read once for both bras. */
+   #pragma omp parallel for schedule(dynamic)
+   for ( int pair = 0; pair < num_pairs; pair++ ){
+
+      const unsigned int crea = pair % L;
+      const unsigned int anni = pair / L;
+
+      if (( crea >= crea_min ) && ( anni >= anni_min ) && ( Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) ) == excitation_irrep )){
+
+         double value  = 0.0;
+         double value2 = 0.0;
+         for ( unsigned int bra_irrep_up = 0; bra_irrep_up < num_irreps; bra_irrep_up++ ){
+
+            const int bra_irrep_down = Irreps::directProd( bra_irrep_up, TargetIrrep );
+            const int ket_irrep_up   = Irreps::directProd( excitation_irrep, bra_irrep_up );
+            const unsigned int dim_bra_up = numPerIrrep_up  [ bra_irrep_up   ];
+            const unsigned int dim_down   = numPerIrrep_down[ bra_irrep_down ];
+
+            // Alpha excitations: bra[ new_up, down ] * sign * ket[ old_up, down ], with the transposed blocks
+            const double * bra_alpha = bra_trans + num_bras * irrep_center_jumps[ 0 ][ bra_irrep_up ];
+            const double * ket_alpha = ket_trans + irrep_center_jumps[ ket_irrep_center ][ ket_irrep_up ];
+            const int   num_alpha = lookup_num_alpha[ bra_irrep_up ][ pair ];
+            const int * exc_alpha = lookup_alpha    [ bra_irrep_up ][ pair ];
+            for ( int entry = 0; entry < num_alpha; entry++ ){
+               const int cnt_new_up = exc_alpha[ 2 * entry ];
+               const int packed     = exc_alpha[ 2 * entry + 1 ];
+               const int sign_up    = (( packed > 0 ) ? 1 : -1 );
+               const int cnt_old_up = sign_up * packed - 1;
+               const double * bra_row = bra_alpha + num_bras * dim_down * cnt_new_up;
+               const double * ket_row = ket_alpha + dim_down * cnt_old_up;
+               double partial = 0.0;
+               if ( num_bras == 1 ){
+                  for ( unsigned int cnt_down = 0; cnt_down < dim_down; cnt_down++ ){ partial += bra_row[ cnt_down ] * ket_row[ cnt_down ]; }
+               } else {
+                  double partial2 = 0.0;
+                  for ( unsigned int cnt_down = 0; cnt_down < dim_down; cnt_down++ ){
+                     partial  += bra_row[ 2 * cnt_down     ] * ket_row[ cnt_down ];
+                     partial2 += bra_row[ 2 * cnt_down + 1 ] * ket_row[ cnt_down ];
+                  }
+                  value2 += sign_up * partial2;
+               }
+               value += sign_up * partial;
+            }
+
+            // Beta excitations: bra[ up, new_down ] * sign * ket[ up, old_down ]
+            const double * bra_beta = bra + num_bras * irrep_center_jumps[ 0 ][ bra_irrep_up ];
+            const double * ket_beta = ket + irrep_center_jumps[ ket_irrep_center ][ bra_irrep_up ];
+            const int   num_beta = lookup_num_beta[ bra_irrep_down ][ pair ];
+            const int * exc_beta = lookup_beta    [ bra_irrep_down ][ pair ];
+            for ( int entry = 0; entry < num_beta; entry++ ){
+               const int cnt_new_down = exc_beta[ 2 * entry ];
+               const int packed       = exc_beta[ 2 * entry + 1 ];
+               const int sign_down    = (( packed > 0 ) ? 1 : -1 );
+               const int cnt_old_down = sign_down * packed - 1;
+               const double * bra_col = bra_beta + num_bras * dim_bra_up * cnt_new_down;
+               const double * ket_col = ket_beta + dim_bra_up * cnt_old_down;
+               double partial = 0.0;
+               if ( num_bras == 1 ){
+                  for ( unsigned int cnt_up = 0; cnt_up < dim_bra_up; cnt_up++ ){ partial += bra_col[ cnt_up ] * ket_col[ cnt_up ]; }
+               } else {
+                  double partial2 = 0.0;
+                  for ( unsigned int cnt_up = 0; cnt_up < dim_bra_up; cnt_up++ ){
+                     partial  += bra_col[ 2 * cnt_up     ] * ket_col[ cnt_up ];
+                     partial2 += bra_col[ 2 * cnt_up + 1 ] * ket_col[ cnt_up ];
+                  }
+                  value2 += sign_down * partial2;
+               }
+               value += sign_down * partial;
+            }
+         }
+         result[ pair ] = value;
+         if ( num_bras == 2 ){ result[ pair + num_pairs ] = value2; }
 
+      }
    }
 
 }
 
 double CheMPS2::FCI::Fill2RDM(double * vector, double * two_rdm) const{
 
+   const double weight = 1.0;
+   return Fill2RDM( &vector, 1, &weight, two_rdm );
+
+}
+
+double CheMPS2::FCI::Fill2RDM(double ** vectors, const int num_vectors, const double * weights, double * two_rdm) const{
+
    assert( Nel_up + Nel_down >= 2 );
 
    struct timeval start, end;
@@ -818,31 +1046,62 @@ double CheMPS2::FCI::Fill2RDM(double * vector, double * two_rdm) const{
    double * workspace1 = new double[ max_length  ];
    double * workspace2 = new double[ orig_length ];
    
+   /* sum_{r,s} w_rs < r | O | s > = sum_s bra_scale[ s ] < bra[ s ] | O | s > with bra[ s ] = sum_r w_rs | r >.
+      When the weights are diagonal (state-averaging), bra[ s ] = | s > and bra_scale[ s ] = w_ss, so that no extra vectors are needed. */
+   bool diagonal = true;
+   double trace = 0.0;
+   for ( int ket = 0; ket < num_vectors; ket++ ){
+      trace += weights[ ket + num_vectors * ket ];
+      for ( int bra = 0; bra < num_vectors; bra++ ){
+         if (( bra != ket ) && ( weights[ bra + num_vectors * ket ] != 0.0 )){ diagonal = false; }
+      }
+   }
+   double ** bra_vectors = new double*[ num_vectors ];
+   double * bra_scale = new double[ num_vectors ];
+   for ( int ket = 0; ket < num_vectors; ket++ ){
+      if ( diagonal ){
+         bra_vectors[ ket ] = vectors[ ket ];
+         bra_scale[ ket ]   = weights[ ket + num_vectors * ket ];
+      } else {
+         bra_vectors[ ket ] = new double[ orig_length ];
+         bra_scale[ ket ]   = 1.0;
+         ClearVector( orig_length, bra_vectors[ ket ] );
+         for ( int bra = 0; bra < num_vectors; bra++ ){
+            FCIdaxpy( orig_length, weights[ bra + num_vectors * ket ], vectors[ bra ], bra_vectors[ ket ] );
+         }
+      }
+   }
+   
    // Gamma_{ijkl} = < E_ik E_jl > - delta_jk < E_il >
    for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){ // anni1 = l
       for ( unsigned int crea1 = anni1; crea1 < L; crea1++ ){ // crea1 = j >= l
       
          const int irrep_center1 = Irreps::directProd( getOrb2Irrep( crea1 ), getOrb2Irrep( anni1 ) );
          const int target_irrep1 = Irreps::directProd( TargetIrrep, irrep_center1 );
-         apply_excitation( vector, workspace1, crea1, anni1, TargetIrrep );
          
-         if ( irrep_center1 == 0 ){
-            const double value = FCIddot( orig_length, workspace1, vector ); // < E_{crea1,anni1} >
-            for ( unsigned int jk = anni1; jk < L; jk++ ){
-               two_rdm[ crea1 + L * ( jk + L * ( jk + L * anni1 ) ) ] -= value;
+         for ( int ket = 0; ket < num_vectors; ket++ ){
+            if ( bra_scale[ ket ] == 0.0 ){ continue; }
+            
+            apply_excitation( vectors[ ket ], workspace1, crea1, anni1, TargetIrrep );
+            
+            if ( irrep_center1 == 0 ){
+               const double value = bra_scale[ ket ] * FCIddot( orig_length, workspace1, bra_vectors[ ket ] ); // < E_{crea1,anni1} >
+               for ( unsigned int jk = anni1; jk < L; jk++ ){
+                  two_rdm[ crea1 + L * ( jk + L * ( jk + L * anni1 ) ) ] -= value;
+               }
             }
-         }
-         
-         for ( unsigned int crea2 = anni1; crea2 < L; crea2++ ){ // crea2 = i >= l
-            for ( unsigned int anni2 = anni1; anni2 < L; anni2++ ){ // anni2 = k >= l
             
-               const int irrep_center2 = Irreps::directProd( getOrb2Irrep( crea2 ), getOrb2Irrep( anni2 ) );
-               if ( irrep_center2 == irrep_center1 ){
+            for ( unsigned int crea2 = anni1; crea2 < L; crea2++ ){ // crea2 = i >= l
+               for ( unsigned int anni2 = anni1; anni2 < L; anni2++ ){ // anni2 = k >= l
                
-                  apply_excitation( workspace1, workspace2, crea2, anni2, target_irrep1 );
-                  const double value = FCIddot( orig_length, workspace2, vector ); // < E_{crea2,anni2} E_{crea1,anni1} >
-                  two_rdm[ crea2 + L * ( crea1 + L * ( anni2 + L * anni1 ) ) ] += value;
+                  const int irrep_center2 = Irreps::directProd( getOrb2Irrep( crea2 ), getOrb2Irrep( anni2 ) );
+                  if ( irrep_center2 == irrep_center1 ){
                   
+                     apply_excitation( workspace1, workspace2, crea2, anni2, target_irrep1 );
+                     const double value = bra_scale[ ket ] * FCIddot( orig_length, workspace2, bra_vectors[ ket ] ); // < E_{crea2,anni2} E_{crea1,anni1} >
+                     two_rdm[ crea2 + L * ( crea1 + L * ( anni2 + L * anni1 ) ) ] += value;
+                     
+                  }
                }
             }
          }
@@ -850,6 +1109,11 @@ double CheMPS2::FCI::Fill2RDM(double * vector, double * two_rdm) const{
    }
    delete [] workspace1;
    delete [] workspace2;
+   if ( !diagonal ){
+      for ( int ket = 0; ket < num_vectors; ket++ ){ delete [] bra_vectors[ ket ]; }
+   }
+   delete [] bra_vectors;
+   delete [] bra_scale;
    
    for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){
       for ( unsigned int crea1 = anni1; crea1 < L; crea1++ ){
@@ -869,7 +1133,7 @@ double CheMPS2::FCI::Fill2RDM(double * vector, double * two_rdm) const{
    }
    
    // Calculate the FCI energy
-   double FCIenergy = getEconst();
+   double FCIenergy = trace * getEconst();
    for ( unsigned int orb1 = 0; orb1 < L; orb1++ ){
       for ( unsigned int orb2 = 0; orb2 < L; orb2++ ){
          double tempvar = 0.0;
@@ -936,7 +1200,10 @@ void CheMPS2::FCI::Fill4RDM(double * vector, double * four_rdm) const{
    double * workspace1 = new double[ max_length  ];
    double * workspace2 = new double[ max_length  ];
    double * workspace3 = new double[ max_length  ];
-   double * workspace4 = new double[ orig_length ];
+   double * workspace4 = new double[ L * L ];
+   double * workspace5 = new double[ max_length  ];
+   double * vector_trans = new double[ orig_length ];
+   transpose_blocks( vector, vector_trans, 0, 1 );
 
    for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){ // anni1 = t
       for ( unsigned int crea1 = anni1; crea1 < L; crea1++ ){ // crea1 = l >= t
@@ -1021,17 +1288,22 @@ void CheMPS2::FCI::Fill4RDM(double * vector, double * four_rdm) const{
 
                      if ( crea3 >= (( crea1 == crea2 ) ? crea2 + 1 : crea2 ) ){ // crea3 = j >= k = crea2 >= t = anni1
 
-                        for ( unsigned int crea4 = (( crea2 == crea3 ) ? crea3 + 1 : crea3 ); crea4 < L; crea4++ ){ // crea4 = i >= j = crea3 >= k = crea2 >= t = anni1
-                           for ( unsigned int anni4 = (( anni1 == anni2 ) ? anni1 + 1 : anni1 ); anni4 < L; anni4++ ){ // anni4 = p >= t
+                        const unsigned int crea4_min = (( crea2 == crea3 ) ? crea3 + 1 : crea3 );
+                        const unsigned int anni4_min = (( anni1 == anni2 ) ? anni1 + 1 : anni1 );
+
+                        // workspace4[ crea4 + L * anni4 ] = < E_{crea4,anni4} E_{crea3,anni3} E_{crea2,anni2} E_{crea1,anni1} >
+                        transpose_blocks( workspace3, workspace5, Irreps::directProd( TargetIrrep, target_irrep3 ), 1 );
+                        transition_excitations( vector, vector_trans, 1, workspace3, workspace5, target_irrep3, crea4_min, anni4_min, workspace4 );
+
+                        for ( unsigned int crea4 = crea4_min; crea4 < L; crea4++ ){ // crea4 = i >= j = crea3 >= k = crea2 >= t = anni1
+                           for ( unsigned int anni4 = anni4_min; anni4 < L; anni4++ ){ // anni4 = p >= t
 
                               if ( (( anni2 == anni3 ) && ( anni3 == anni4 )) == false ){
 
                                  const int irrep_product4 = Irreps::directProd( getOrb2Irrep( crea4 ), getOrb2Irrep( anni4 ) );
                                  if ( irrep_product4 == irrep_center4 ){
 
-                                    apply_excitation( workspace3, workspace4, crea4, anni4, target_irrep3 );
-                                    // value = < E_{crea4,anni4} E_{crea3,anni3} E_{crea2,anni2} E_{crea1,anni1} >
-                                    const double value = FCIddot( orig_length, workspace4, vector );
+                                    const double value = workspace4[ crea4 + L * anni4 ];
                                     four_rdm[ crea4 + L*( crea3 + L*( crea2 + L*( crea1 + L*( anni4 + L*( anni3 + L*( anni2 + L * anni1 ))))))] += value;
 
                                  }
@@ -1049,6 +1321,8 @@ void CheMPS2::FCI::Fill4RDM(double * vector, double * four_rdm) const{
    delete [] workspace2;
    delete [] workspace3;
    delete [] workspace4;
+   delete [] workspace5;
+   delete [] vector_trans;
    
    // Make 48-fold permutation symmetric
    for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){ // anni1 = t
@@ -1160,15 +1434,42 @@ void CheMPS2::FCI::Fill4RDM(double * vector, double * four_rdm) const{
 void CheMPS2::FCI::Fock4RDM( double * vector, double * three_rdm, double * fock, double * output ) const{
 
    assert( Nel_up + Nel_down >= 4 );
-   const double elapsed = Driver3RDM( vector, output, three_rdm, fock, L + 1 );
+   const double elapsed = Driver3RDM( vector, three_rdm, false, output, fock, L + 1 );
    if ( FCIverbose > 0 ){ cout << "FCI::Fock4RDM : Wall time = " << elapsed << " seconds" << endl; }
 
 }
 
+void CheMPS2::FCI::Fock4RDM( double * vector, double * three_rdm, double * fock, const unsigned int orbz, double * output ) const{
+
+   assert( Nel_up + Nel_down >= 4 );
+   assert( orbz < L );
+
+   /* Only row and column z of the Fock operator are kept, with the off-diagonal elements halved:
+      the sum over z of fock_z is then the full Fock operator, and the sum over z of the outputs is the full contraction. */
+   double * fock_z = new double[ L * L ];
+   ClearVector( L * L, fock_z );
+   for ( unsigned int orb = 0; orb < L; orb++ ){
+      fock_z[ orbz + L * orb  ] += 0.5 * fock[ orbz + L * orb  ];
+      fock_z[ orb  + L * orbz ] += 0.5 * fock[ orb  + L * orbz ];
+   }
+   const double elapsed = Driver3RDM( vector, three_rdm, false, output, fock_z, L + 1 );
+   delete [] fock_z;
+   if ( FCIverbose > 0 ){ cout << "FCI::Fock4RDM : Wall time for orbital " << orbz << " = " << elapsed << " seconds" << endl; }
+
+}
+
+void CheMPS2::FCI::Fill3RDMFock4RDM( double * vector, double * fock, double * three_rdm, double * output ) const{
+
+   assert( Nel_up + Nel_down >= 4 );
+   const double elapsed = Driver3RDM( vector, three_rdm, true, output, fock, L + 1 );
+   if ( FCIverbose > 0 ){ cout << "FCI::Fill3RDMFock4RDM : Wall time = " << elapsed << " seconds" << endl; }
+
+}
+
 void CheMPS2::FCI::Fill3RDM( double * vector, double * output ) const{
 
    assert( Nel_up + Nel_down >= 3 );
-   const double elapsed = Driver3RDM( vector, output, NULL, NULL, L + 1 );
+   const double elapsed = Driver3RDM( vector, output, true, NULL, NULL, L + 1 );
    if ( FCIverbose > 0 ){ cout << "FCI::Fill3RDM : Wall time = " << elapsed << " seconds" << endl; }
 
 }
@@ -1176,109 +1477,136 @@ void CheMPS2::FCI::Fill3RDM( double * vector, double * output ) const{
 void CheMPS2::FCI::Diag4RDM( double * vector, double * three_rdm, const unsigned int orbz, double * output ) const{
 
    assert( Nel_up + Nel_down >= 4 );
-   const double elapsed = Driver3RDM( vector, output, three_rdm, NULL, orbz );
+   const double elapsed = Driver3RDM( vector, three_rdm, false, output, NULL, orbz );
    if ( FCIverbose > 0 ){ cout << "FCI::Diag4RDM : Wall time = " << elapsed << " seconds" << endl; }
 
 }
 
-double CheMPS2::FCI::Driver3RDM( double * vector, double * output, double * three_rdm, double * fock, const unsigned int orbz ) const{
+double CheMPS2::FCI::Driver3RDM( double * vector, double * three_rdm, const bool fill_3rdm, double * output, double * fock, const unsigned int orbz ) const{
 
    struct timeval start, end;
    gettimeofday(&start, NULL);
 
-   ClearVector( L*L*L*L*L*L, output );
+   const int L6 = L*L*L*L*L*L;
    const unsigned int orig_length = getVecLength( 0 );
+   const bool task_4rdm = ( output != NULL );
+   const bool task_fock = (( task_4rdm ) && ( fock != NULL ));
+   const bool task_E_zz = (( task_4rdm ) && ( fock == NULL ));
+   assert(( fill_3rdm ) || ( task_4rdm ));
+   assert( task_E_zz == ( orbz < L ));
+
+   if ( fill_3rdm ){ ClearVector( L6, three_rdm ); }
+   if ( task_4rdm ){ ClearVector( L6, output    ); }
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){ // All processes work with the vector, the 3-RDM and the Fock operator of the master process
+      MPIchemps2::broadcast_array_double( vector, orig_length, MPI_CHEMPS2_MASTER );
+      if ( fill_3rdm == false ){ MPIchemps2::broadcast_array_double( three_rdm, L6, MPI_CHEMPS2_MASTER ); }
+      if ( task_fock ){ MPIchemps2::broadcast_array_double( fock, L * L, MPI_CHEMPS2_MASTER ); }
+   }
+   #endif
    unsigned int max_length = getVecLength( 0 );
    for ( unsigned int irrep = 1; irrep < num_irreps; irrep++ ){
       if ( getVecLength( irrep ) > max_length ){ max_length = getVecLength( irrep ); }
    }
-   double * workspace1 = new double[ max_length  ];
-   double * workspace2 = new double[ max_length  ];
-   double * workspace3 = new double[ orig_length ];
 
+   /* The 3-RDM and the 4-RDM contractions are calculated from the same chain of excitations, with different bras | Chi >:
+         Gamma_{ijk,pqr} = < 0 | E_ip E_jq E_kr | Chi >
+                         - delta_kq < 0 | E_ip E_jr | Chi >
+                         - delta_kp < 0 | E_ir E_jq | Chi >
+                         - delta_jp < 0 | E_iq E_kr | Chi >
+                         + delta_kq delta_jp < 0 | E_ir | Chi >
+                         + delta_kp delta_jr < 0 | E_iq | Chi >
+                         - correction
+      with | Chi > = | 0 > and no correction for the 3-RDM,
+
+      with | Chi > = E_zz | 0 > and correction ( delta_pz + delta_qz + delta_rz ) Gamma_{ijk,pqr} for the 4-RDM elements Gamma_{ijkz,pqrz},
+
+      and with | Chi > = sum_{l,t} fock[l,t] E_lt | 0 > and correction sum_{t} ( fock[r,t] Gamma_{ijk,pqt} + fock[q,t] Gamma_{ijk,ptr} + fock[p,t] Gamma_{ijk,tqr} )
+      for the contraction sum_{l,t} fock[l,t] Gamma_{ijkl,pqrt}. The corrections are added after the 3-RDM is complete. */
+   int num_out = 0;
+   double * bra[ 2 ];
+   double * out[ 2 ];
    double * chi = NULL;
-   const bool task_fock =  ( fock != NULL );
-   const bool task_E_zz = (( fock == NULL ) && ( three_rdm != NULL ));
-   const bool task_3rdm = (( fock == NULL ) && ( three_rdm == NULL ));
-
-   if ( task_3rdm ){
-
-      assert( orbz == L + 1 );
-      chi = vector; // | Chi > = | 0 >
-
-      /* Calculate the 3-RDM:
-            Gamma_{ijk,pqr} = < 0 | E_ip E_jq E_kr | Chi >
-                            - delta_kq < 0 | E_ip E_jr | Chi >
-                            - delta_kp < 0 | E_ir E_jq | Chi >
-                            - delta_jp < 0 | E_iq E_kr | Chi >
-                            + delta_kq delta_jp < 0 | E_ir | Chi >
-                            + delta_kp delta_jr < 0 | E_iq | Chi >
-      */
+   if ( fill_3rdm ){
+      bra[ num_out ] = vector;
+      out[ num_out ] = three_rdm;
+      num_out++;
    }
-
    if ( task_E_zz ){
-
-      assert( orbz < L );
       chi = new double[ orig_length ];
-      apply_excitation( vector, chi, orbz, orbz, TargetIrrep ); // | Chi > = E_zz | 0 >
-
-      /* Calculate the 4-RDM elements with orbital z fixed:
-            Gamma_{ijkz,pqrz} = < 0 | E_ip E_jq E_kr | Chi >
-                              - delta_kq < 0 | E_ip E_jr | Chi >
-                              - delta_kp < 0 | E_ir E_jq | Chi >
-                              - delta_jp < 0 | E_iq E_kr | Chi >
-                              + delta_kq delta_jp < 0 | E_ir | Chi >
-                              + delta_kp delta_jr < 0 | E_iq | Chi >
-                              - ( delta_pz + delta_qz + delta_rz ) Gamma_{ijk,pqr}
-      */
+      apply_excitation( vector, chi, orbz, orbz, TargetIrrep );
    }
-
    if ( task_fock ){
-
-      assert( orbz == L + 1 );
       chi = new double[ orig_length ];
+      double * workspace = new double[ orig_length ];
       ClearVector( orig_length, chi );
       for ( unsigned int anni = 0; anni < L; anni++ ){
          for ( unsigned int crea = 0; crea < L; crea++ ){
-            if ( getOrb2Irrep( crea ) == getOrb2Irrep( anni ) ){
-               apply_excitation( vector, workspace1, crea, anni, TargetIrrep );
-               FCIdaxpy( orig_length, fock[ crea + L * anni ], workspace1, chi ); // | Chi > = sum_{l,t} fock[l,t] E_lt | 0 >
+            if (( getOrb2Irrep( crea ) == getOrb2Irrep( anni ) ) && ( fock[ crea + L * anni ] != 0.0 )){
+               apply_excitation( vector, workspace, crea, anni, TargetIrrep );
+               FCIdaxpy( orig_length, fock[ crea + L * anni ], workspace, chi );
             }
          }
       }
+      delete [] workspace;
+   }
+   if ( task_4rdm ){
+      bra[ num_out ] = chi;
+      out[ num_out ] = output;
+      num_out++;
+   }
+   // For transition_excitations, the bras are interleaved, and also stored with transposed blocks
+   double * bra_all   = new double[ num_out * orig_length ];
+   double * bra_trans = new double[ num_out * orig_length ];
+   for ( unsigned int elem = 0; elem < orig_length; elem++ ){
+      for ( int task = 0; task < num_out; task++ ){ bra_all[ task + num_out * elem ] = bra[ task ][ elem ]; }
+   }
+   transpose_blocks( bra_all, bra_trans, 0, num_out );
 
-      /* Calculate the 4-RDM contracted with the Fock operator:
-            sum_{l,t} fock[l,t] Gamma_{ijkl,pqrt} = < 0 | E_ip E_jq E_kr | Chi >
-                                                  - delta_kq < 0 | E_ip E_jr | Chi >
-                                                  - delta_kp < 0 | E_ir E_jq | Chi >
-                                                  - delta_jp < 0 | E_iq E_kr | Chi >
-                                                  + delta_kq delta_jp < 0 | E_ir | Chi >
-                                                  + delta_kp delta_jr < 0 | E_iq | Chi >
-                                                  - sum_{t} ( fock[r,t] Gamma_{ijk,pqt}
-                                                            + fock[q,t] Gamma_{ijk,ptr}
-                                                            + fock[p,t] Gamma_{ijk,tqr} )
-      */
+   /* The ( anni1, crea1 ) pairs are distributed over the OpenMP threads, and with MPI over the processes. All output elements which are
+      set in the innermost loop have anni1 and crea1 as their i and p indices, so that different pairs write to different elements. The
+      delta terms are collected in the small arrays single and double_exc, and added to the output afterwards. */
+   int num_pairs1 = 0;
+   int * pairs1 = new int[ L * L ];
+   for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){
+      for ( unsigned int crea1 = 0; crea1 < L; crea1++ ){
+         #ifdef CHEMPS2_MPI_COMPILATION
+         // Each process accumulates the ( anni1, crea1 ) pairs it owns in its own output; all contributions are summed below
+         if (( mpi_distributed ) && ( MPIchemps2::owner_fci_unit( crea1 + L * anni1 ) != MPIchemps2::mpi_rank() )){ continue; }
+         #endif
+         pairs1[ num_pairs1 ] = crea1 + L * anni1;
+         num_pairs1++;
+      }
    }
+   double * single     = new double[ num_out * L * L ];
+   double * double_exc = new double[ num_out * L * L * L * L ];
+   ClearVector( num_out * L * L, single );
+   ClearVector( num_out * L * L * L * L, double_exc );
 
-   for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){ // anni1 = i ( works in on the bra ) ( smaller than j, k )
-      for ( unsigned int crea1 = 0; crea1 < L; crea1++ ){ // crea1 = p ( can be anything )
+   #pragma omp parallel
+   {
+
+      double * workspace1 = new double[ max_length  ];
+      double * workspace2 = new double[ max_length  ];
+      double * workspace3 = new double[ num_out * L * L ];
+      double * workspace4 = new double[ max_length ];
+
+      #pragma omp for schedule(dynamic)
+      for ( int index = 0; index < num_pairs1; index++ ){
+
+         const unsigned int crea1 = pairs1[ index ] % L; // crea1 = p ( can be anything )
+         const unsigned int anni1 = pairs1[ index ] / L; // anni1 = i ( works in on the bra ) ( smaller than j, k )
 
          const int irrep_center1 = Irreps::directProd( getOrb2Irrep( crea1 ), getOrb2Irrep( anni1 ) );
          const int target_irrep1 = Irreps::directProd( TargetIrrep, irrep_center1 );
          apply_excitation( vector, workspace1, crea1, anni1, TargetIrrep );
 
          if ( irrep_center1 == 0 ){
-
-            // value = < Chi | E_{crea1,anni1} | 0 >
-            const double value = FCIddot( orig_length, workspace1, chi );
-            for ( unsigned int j = anni1; j < L; j++ ){
-               for ( unsigned int k = anni1; k < L; k++ ){
-                  //      i           j       k       p       q       r
-                  output[ anni1 + L*( j + L*( k + L*( j + L*( k     + L * crea1 )))) ] += value; // + delta_kq delta_jp < 0 | E_ir | Chi >
-                  output[ anni1 + L*( j + L*( k + L*( k + L*( crea1 + L * j     )))) ] += value; // + delta_kp delta_jr < 0 | E_iq | Chi >
-               }
+            for ( int task = 0; task < num_out; task++ ){
+               // single[ crea1 + L * anni1 ] = < Chi | E_{crea1,anni1} | 0 >
+               single[ crea1 + L * ( anni1 + L * task ) ] = FCIddot( orig_length, workspace1, bra[ task ] );
             }
-
          }
 
          for ( unsigned int crea2 = 0; crea2 < L; crea2++ ){ // crea2 = q
@@ -1290,50 +1618,126 @@ double CheMPS2::FCI::Driver3RDM( double * vector, double * output, double * thre
                apply_excitation( workspace1, workspace2, crea2, anni2, target_irrep1 );
 
                if ( irrep_center1 == irrep_center2 ){
-
-                  // value = < Chi | E_{crea2,anni2} E_{crea1,anni1} | 0 >
-                  const double value = FCIddot( orig_length, workspace2, chi );
-                  for ( unsigned int orb = anni1; orb < L; orb++ ){
-                     //      i           j           k           p           q           r
-                     output[ anni1 + L*( anni2 + L*( orb   + L*( crea1 + L*( orb   + L * crea2 )))) ] -= value; // - delta_kq < 0 | E_ip E_jr | Chi >
-                     output[ anni1 + L*( anni2 + L*( orb   + L*( orb   + L*( crea2 + L * crea1 )))) ] -= value; // - delta_kp < 0 | E_ir E_jq | Chi >
-                     output[ anni1 + L*( orb   + L*( anni2 + L*( orb   + L*( crea1 + L * crea2 )))) ] -= value; // - delta_jp < 0 | E_iq E_kr | Chi >
+                  for ( int task = 0; task < num_out; task++ ){
+                     // double_exc[ crea1 + L * ( anni1 + L * ( crea2 + L * anni2 ) ) ] = < Chi | E_{crea2,anni2} E_{crea1,anni1} | 0 >
+                     double_exc[ crea1 + L * ( anni1 + L * ( crea2 + L * ( anni2 + L * task ) ) ) ] = FCIddot( orig_length, workspace2, bra[ task ] );
                   }
-
                }
 
                if (( crea1 >= anni1 ) && ( crea2 >= anni1 )){
 
-                  for ( unsigned int crea3 = (( crea1 == crea2 ) ? crea2 + 1 : crea2 ); crea3 < L; crea3++ ){ // crea3 = r >= ( q = crea2 ) >= ( i = anni1 )
-                     for ( unsigned int anni3 = (( anni1 == anni2 ) ? anni1 + 1 : anni1 ); anni3 < L; anni3++ ){ // anni3 = k >= ( i = anni1 )
+                  const unsigned int crea3_min = (( crea1 == crea2 ) ? crea2 + 1 : crea2 );
+                  const unsigned int anni3_min = (( anni1 == anni2 ) ? anni1 + 1 : anni1 );
+
+                  // workspace3[ crea3 + L * ( anni3 + L * task ) ] = < Chi | E_{crea3,anni3} E_{crea2,anni2} E_{crea1,anni1} | 0 >
+                  transpose_blocks( workspace2, workspace4, irrep_center3, 1 );
+                  transition_excitations( bra_all, bra_trans, num_out, workspace2, workspace4, target_irrep2, crea3_min, anni3_min, workspace3 );
+
+                  for ( unsigned int crea3 = crea3_min; crea3 < L; crea3++ ){ // crea3 = r >= ( q = crea2 ) >= ( i = anni1 )
+                     for ( unsigned int anni3 = anni3_min; anni3 < L; anni3++ ){ // anni3 = k >= ( i = anni1 )
 
                         const int irrep_product3 = Irreps::directProd( getOrb2Irrep( crea3 ), getOrb2Irrep( anni3 ) );
 
                         if ( irrep_center3 == irrep_product3 ){ // I1 x I2 x I3 = Itrivial
+                           for ( int task = 0; task < num_out; task++ ){
+                              out[ task ][ anni1 + L*( anni2 + L*( anni3 + L*( crea1 + L*( crea2 + L * crea3 )))) ] += workspace3[ crea3 + L * ( anni3 + L * task ) ];
+                           }
+                        }
+                     }
+                  }
+               }
+            }
+         }
+      }
 
-                           apply_excitation( workspace2, workspace3, crea3, anni3, target_irrep2 );
+      delete [] workspace1;
+      delete [] workspace2;
+      delete [] workspace3;
+      delete [] workspace4;
 
-                           // value = < Chi | E_{crea3,anni3} E_{crea2,anni2} E_{crea1,anni1} | 0 >
-                           double value = FCIddot( orig_length, workspace3, chi );
+   }
+   delete [] pairs1;
+
+   for ( int task = 0; task < num_out; task++ ){
+      double * result = out[ task ];
+      for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){
+         for ( unsigned int crea1 = 0; crea1 < L; crea1++ ){
+
+            const double value = single[ crea1 + L * ( anni1 + L * task ) ]; // Zero if ( anni1, crea1 ) is not owned or not symmetric
+            if ( value != 0.0 ){
+               for ( unsigned int j = anni1; j < L; j++ ){
+                  for ( unsigned int k = anni1; k < L; k++ ){
+                     //      i           j       k       p       q       r
+                     result[ anni1 + L*( j + L*( k + L*( j + L*( k     + L * crea1 )))) ] += value; // + delta_kq delta_jp < 0 | E_ir | Chi >
+                     result[ anni1 + L*( j + L*( k + L*( k + L*( crea1 + L * j     )))) ] += value; // + delta_kp delta_jr < 0 | E_iq | Chi >
+                  }
+               }
+            }
 
-                           if ( task_fock ){
-                              for ( unsigned int t = 0; t < L; t++ ){
-                                 // Irrep diagonality of fock is checked by three_rdm values being zero
-                                 value -= ( fock[ crea3 + L * t ] * three_rdm[ anni1 + L*( anni2 + L*( anni3 + L*( crea1 + L*( crea2 + L * t     )))) ]
-                                          + fock[ crea2 + L * t ] * three_rdm[ anni1 + L*( anni2 + L*( anni3 + L*( crea1 + L*( t     + L * crea3 )))) ]
-                                          + fock[ crea1 + L * t ] * three_rdm[ anni1 + L*( anni2 + L*( anni3 + L*( t     + L*( crea2 + L * crea3 )))) ] );
+            for ( unsigned int crea2 = 0; crea2 < L; crea2++ ){
+               for ( unsigned int anni2 = anni1; anni2 < L; anni2++ ){
+                  const double value2 = double_exc[ crea1 + L * ( anni1 + L * ( crea2 + L * ( anni2 + L * task ) ) ) ];
+                  if ( value2 != 0.0 ){
+                     for ( unsigned int orb = anni1; orb < L; orb++ ){
+                        //      i           j           k           p           q           r
+                        result[ anni1 + L*( anni2 + L*( orb   + L*( crea1 + L*( orb   + L * crea2 )))) ] -= value2; // - delta_kq < 0 | E_ip E_jr | Chi >
+                        result[ anni1 + L*( anni2 + L*( orb   + L*( orb   + L*( crea2 + L * crea1 )))) ] -= value2; // - delta_kp < 0 | E_ir E_jq | Chi >
+                        result[ anni1 + L*( orb   + L*( anni2 + L*( orb   + L*( crea1 + L * crea2 )))) ] -= value2; // - delta_jp < 0 | E_iq E_kr | Chi >
+                     }
+                  }
+               }
+            }
+         }
+      }
+   }
+   delete [] single;
+   delete [] double_exc;
+   if ( task_4rdm ){ delete [] chi; }
+   delete [] bra_all;
+   delete [] bra_trans;
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){ // Sum the contributions of all processes, so that every process has the full result
+      double * partial = new double[ L6 ];
+      for ( int task = 0; task < num_out; task++ ){
+         FCIdcopy( L6, out[ task ], partial );
+         MPIchemps2::allreduce_array_double( partial, out[ task ], L6 );
+      }
+      delete [] partial;
+   }
+   #endif
+
+   for ( int task = 0; task < num_out; task++ ){
+      double * result = out[ task ];
+
+      if ( result == output ){ // The 3-RDM is complete: add the corrections to the unique elements of the 4-RDM contraction
+         #pragma omp parallel for schedule(dynamic)
+         for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){
+            for ( unsigned int crea1 = anni1; crea1 < L; crea1++ ){
+               const int irrep_prod1 = Irreps::directProd( getOrb2Irrep( crea1 ) , getOrb2Irrep( anni1 ) );
+               for ( unsigned int crea2 = anni1; crea2 < L; crea2++ ){
+                  const int irrep_prod2 = Irreps::directProd( irrep_prod1 , getOrb2Irrep( crea2 ) );
+                  for ( unsigned int anni2 = anni1; anni2 < L; anni2++ ){
+                     const int irrep_prod3 = Irreps::directProd( irrep_prod2 , getOrb2Irrep( anni2 ) );
+                     for ( unsigned int crea3 = crea2; crea3 < L; crea3++ ){
+                        const int irrep_prod4 = Irreps::directProd( irrep_prod3 , getOrb2Irrep( crea3 ) );
+                        for ( unsigned int anni3 = anni1; anni3 < L; anni3++ ){
+                           if ( irrep_prod4 == getOrb2Irrep( anni3 )){
+                              double value = 0.0;
+                              if ( task_fock ){
+                                 for ( unsigned int t = 0; t < L; t++ ){
+                                    // Irrep diagonality of fock is checked by three_rdm values being zero
+                                    value += ( fock[ crea3 + L * t ] * three_rdm[ anni1 + L*( anni2 + L*( anni3 + L*( crea1 + L*( crea2 + L * t     )))) ]
+                                             + fock[ crea2 + L * t ] * three_rdm[ anni1 + L*( anni2 + L*( anni3 + L*( crea1 + L*( t     + L * crea3 )))) ]
+                                             + fock[ crea1 + L * t ] * three_rdm[ anni1 + L*( anni2 + L*( anni3 + L*( t     + L*( crea2 + L * crea3 )))) ] );
+                                 }
                               }
-                           }
-
-                           if ( task_E_zz ){
-                              const int number = (( orbz == crea1 ) ? 1 : 0 ) + (( orbz == crea2 ) ? 1 : 0 ) + (( orbz == crea3 ) ? 1 : 0 );
-                              if ( number > 0 ){
-                                 value -= number * three_rdm[ anni1 + L*( anni2 + L*( anni3 + L*( crea1 + L*( crea2 + L * crea3 )))) ];
+                              if ( task_E_zz ){
+                                 const int number = (( orbz == crea1 ) ? 1 : 0 ) + (( orbz == crea2 ) ? 1 : 0 ) + (( orbz == crea3 ) ? 1 : 0 );
+                                 value = number * three_rdm[ anni1 + L*( anni2 + L*( anni3 + L*( crea1 + L*( crea2 + L * crea3 )))) ];
                               }
+                              result[ anni1 + L*( anni2 + L*( anni3 + L*( crea1 + L*( crea2 + L * crea3 )))) ] -= value;
                            }
-
-                           output[ anni1 + L*( anni2 + L*( anni3 + L*( crea1 + L*( crea2 + L * crea3 )))) ] += value;
-
                         }
                      }
                   }
@@ -1341,61 +1745,57 @@ double CheMPS2::FCI::Driver3RDM( double * vector, double * output, double * thre
             }
          }
       }
-   }
-   delete [] workspace1;
-   delete [] workspace2;
-   delete [] workspace3;
-   if (( task_fock ) || ( task_E_zz )){ delete [] chi; }
 
-   // Make 12-fold permutation symmetric
-   for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){
-      for ( unsigned int crea1 = anni1; crea1 < L; crea1++ ){
-         const int irrep_prod1 = Irreps::directProd( getOrb2Irrep( crea1 ) , getOrb2Irrep( anni1 ) ); // Ic1 x Ia1
-         for ( unsigned int crea2 = anni1; crea2 < L; crea2++ ){
-            const int irrep_prod2 = Irreps::directProd( irrep_prod1 , getOrb2Irrep( crea2 ) ); // Ic1 x Ia1 x Ic2
-            for ( unsigned int anni2 = anni1; anni2 < L; anni2++ ){
-               const int irrep_prod3 = Irreps::directProd( irrep_prod2 , getOrb2Irrep( anni2 ) ); // Ic1 x Ia1 x Ic2 x Ia2
-               for ( unsigned int crea3 = crea2; crea3 < L; crea3++ ){
-                  const int irrep_prod4 = Irreps::directProd( irrep_prod3 , getOrb2Irrep( crea3 ) ); // Ic1 x Ia1 x Ic2 x Ia2 x Ic3
-                  for ( unsigned int anni3 = anni1; anni3 < L; anni3++ ){
-                     if ( irrep_prod4 == getOrb2Irrep( anni3 )){ // Ic1 x Ia1 x Ic2 x Ia2 x Ic3 == Ia3
-                     
-                        /*      crea3 >= crea2 >= anni1
-                           crea1, anni3, anni2 >= anni1  */
-                  
-   const double value = output[ anni1 + L * ( anni2 + L * ( anni3 + L * ( crea1 + L * ( crea2 + L * crea3 ) ) ) ) ];
-                        output[ anni1 + L * ( anni3 + L * ( anni2 + L * ( crea1 + L * ( crea3 + L * crea2 ) ) ) ) ] = value;
-                        
-                        output[ anni3 + L * ( anni2 + L * ( anni1 + L * ( crea3 + L * ( crea2 + L * crea1 ) ) ) ) ] = value;
-                        output[ anni2 + L * ( anni3 + L * ( anni1 + L * ( crea2 + L * ( crea3 + L * crea1 ) ) ) ) ] = value;
-                        
-                        output[ anni2 + L * ( anni1 + L * ( anni3 + L * ( crea2 + L * ( crea1 + L * crea3 ) ) ) ) ] = value;
-                        output[ anni3 + L * ( anni1 + L * ( anni2 + L * ( crea3 + L * ( crea1 + L * crea2 ) ) ) ) ] = value;
-                  
-                        output[ crea3 + L * ( crea2 + L * ( crea1 + L * ( anni3 + L * ( anni2 + L * anni1 ) ) ) ) ] = value;
-                        output[ crea2 + L * ( crea3 + L * ( crea1 + L * ( anni2 + L * ( anni3 + L * anni1 ) ) ) ) ] = value;
-                        
-                        output[ crea2 + L * ( crea1 + L * ( crea3 + L * ( anni2 + L * ( anni1 + L * anni3 ) ) ) ) ] = value;
-                        output[ crea3 + L * ( crea1 + L * ( crea2 + L * ( anni3 + L * ( anni1 + L * anni2 ) ) ) ) ] = value;
-                        
-                        output[ crea1 + L * ( crea3 + L * ( crea2 + L * ( anni1 + L * ( anni3 + L * anni2 ) ) ) ) ] = value;
-                        output[ crea1 + L * ( crea2 + L * ( crea3 + L * ( anni1 + L * ( anni2 + L * anni3 ) ) ) ) ] = value;
-                        
+      // Make 12-fold permutation symmetric
+      for ( unsigned int anni1 = 0; anni1 < L; anni1++ ){
+         for ( unsigned int crea1 = anni1; crea1 < L; crea1++ ){
+            const int irrep_prod1 = Irreps::directProd( getOrb2Irrep( crea1 ) , getOrb2Irrep( anni1 ) ); // Ic1 x Ia1
+            for ( unsigned int crea2 = anni1; crea2 < L; crea2++ ){
+               const int irrep_prod2 = Irreps::directProd( irrep_prod1 , getOrb2Irrep( crea2 ) ); // Ic1 x Ia1 x Ic2
+               for ( unsigned int anni2 = anni1; anni2 < L; anni2++ ){
+                  const int irrep_prod3 = Irreps::directProd( irrep_prod2 , getOrb2Irrep( anni2 ) ); // Ic1 x Ia1 x Ic2 x Ia2
+                  for ( unsigned int crea3 = crea2; crea3 < L; crea3++ ){
+                     const int irrep_prod4 = Irreps::directProd( irrep_prod3 , getOrb2Irrep( crea3 ) ); // Ic1 x Ia1 x Ic2 x Ia2 x Ic3
+                     for ( unsigned int anni3 = anni1; anni3 < L; anni3++ ){
+                        if ( irrep_prod4 == getOrb2Irrep( anni3 )){ // Ic1 x Ia1 x Ic2 x Ia2 x Ic3 == Ia3
+
+                           /*      crea3 >= crea2 >= anni1
+                              crea1, anni3, anni2 >= anni1  */
+
+   const double value = result[ anni1 + L * ( anni2 + L * ( anni3 + L * ( crea1 + L * ( crea2 + L * crea3 ) ) ) ) ];
+                           result[ anni1 + L * ( anni3 + L * ( anni2 + L * ( crea1 + L * ( crea3 + L * crea2 ) ) ) ) ] = value;
+
+                           result[ anni3 + L * ( anni2 + L * ( anni1 + L * ( crea3 + L * ( crea2 + L * crea1 ) ) ) ) ] = value;
+                           result[ anni2 + L * ( anni3 + L * ( anni1 + L * ( crea2 + L * ( crea3 + L * crea1 ) ) ) ) ] = value;
+
+                           result[ anni2 + L * ( anni1 + L * ( anni3 + L * ( crea2 + L * ( crea1 + L * crea3 ) ) ) ) ] = value;
+                           result[ anni3 + L * ( anni1 + L * ( anni2 + L * ( crea3 + L * ( crea1 + L * crea2 ) ) ) ) ] = value;
+
+                           result[ crea3 + L * ( crea2 + L * ( crea1 + L * ( anni3 + L * ( anni2 + L * anni1 ) ) ) ) ] = value;
+                           result[ crea2 + L * ( crea3 + L * ( crea1 + L * ( anni2 + L * ( anni3 + L * anni1 ) ) ) ) ] = value;
+
+                           result[ crea2 + L * ( crea1 + L * ( crea3 + L * ( anni2 + L * ( anni1 + L * anni3 ) ) ) ) ] = value;
+                           result[ crea3 + L * ( crea1 + L * ( crea2 + L * ( anni3 + L * ( anni1 + L * anni2 ) ) ) ) ] = value;
+
+                           result[ crea1 + L * ( crea3 + L * ( crea2 + L * ( anni1 + L * ( anni3 + L * anni2 ) ) ) ) ] = value;
+                           result[ crea1 + L * ( crea2 + L * ( crea3 + L * ( anni1 + L * ( anni2 + L * anni3 ) ) ) ) ] = value;
+
+                        }
                      }
                   }
                }
             }
          }
       }
-   }
-   
-   for ( unsigned int anni = 0; anni < L; anni++ ){
-      for ( unsigned int combo = 0; combo < L*L*L; combo++ ){
-         output[ combo + L * L * L * anni * ( 1 + L + L * L ) ] = 0.0;
-         output[ anni * ( 1 + L + L * L ) + L * L * L * combo ] = 0.0;
+
+      for ( unsigned int anni = 0; anni < L; anni++ ){
+         for ( unsigned int combo = 0; combo < L*L*L; combo++ ){
+            result[ combo + L * L * L * anni * ( 1 + L + L * L ) ] = 0.0;
+            result[ anni * ( 1 + L + L * L ) + L * L * L * combo ] = 0.0;
+         }
       }
    }
-   
+
    gettimeofday(&end, NULL);
    const double elapsed = (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
    return elapsed;
@@ -1409,45 +1809,49 @@ double CheMPS2::FCI::CalcSpinSquared(double * vector) const{
       
    #pragma omp parallel for schedule(static) reduction(+:result)
    for ( unsigned int counter = 0; counter < vecLength; counter++ ){
+
+      const int irrep_up     = getUpIrrepOfCounter( 0 , counter );
+      const int irrep_down   = Irreps::directProd( irrep_up , TargetIrrep );
+      const int count_up     = ( counter - irrep_center_jumps[ 0 ][ irrep_up ] ) % numPerIrrep_up[ irrep_up ];
+      const int count_down   = ( counter - irrep_center_jumps[ 0 ][ irrep_up ] ) / numPerIrrep_up[ irrep_up ];
+      const unsigned int string_up   = cnt2str_up  [ irrep_up   ][ count_up   ];
+      const unsigned int string_down = cnt2str_down[ irrep_down ][ count_down ];
+      const double vector_at_counter_squared = vector[ counter ] * vector[ counter ];
+
       for ( unsigned int orbi = 0; orbi < L; orbi++ ){
          
-         const int irrep_up     = getUpIrrepOfCounter( 0 , counter );
-         const int irrep_down   = Irreps::directProd( irrep_up , TargetIrrep );
-         const int count_up     = ( counter - irrep_center_jumps[ 0 ][ irrep_up ] ) % numPerIrrep_up[ irrep_up ];
-         const int count_down   = ( counter - irrep_center_jumps[ 0 ][ irrep_up ] ) / numPerIrrep_up[ irrep_up ];
-         
          // Diagonal terms
-         const int diff_ii = lookup_sign_alpha[ irrep_up   ][ orbi + L * orbi ][ count_up   ]
-                           - lookup_sign_beta [ irrep_down ][ orbi + L * orbi ][ count_down ]; //Signed integers so subtracting is OK
-         const double vector_at_counter_squared = vector[ counter ] * vector[ counter ];
+         const int diff_ii = (int)(( string_up >> orbi ) & 1U ) - (int)(( string_down >> orbi ) & 1U ); //Signed integers so subtracting is OK
          result += 0.75 * diff_ii * diff_ii * vector_at_counter_squared;
          
          for ( unsigned int orbj = orbi+1; orbj < L; orbj++ ){
          
             // Sz Sz
-            const int diff_jj = lookup_sign_alpha[ irrep_up   ][ orbj + L * orbj ][ count_up   ]
-                              - lookup_sign_beta [ irrep_down ][ orbj + L * orbj ][ count_down ]; //Signed integers so subtracting is OK
+            const int diff_jj = (int)(( string_up >> orbj ) & 1U ) - (int)(( string_down >> orbj ) & 1U ); //Signed integers so subtracting is OK
             result += 0.5 * diff_ii * diff_jj * vector_at_counter_squared;
             
-            const int irrep_up_bis = Irreps::directProd( irrep_up , Irreps::directProd( getOrb2Irrep( orbi ) , getOrb2Irrep( orbj ) ) );
+            const int irrep_excitation = Irreps::directProd( getOrb2Irrep( orbi ) , getOrb2Irrep( orbj ) );
+            const int irrep_up_bis     = Irreps::directProd( irrep_up   , irrep_excitation );
+            const int irrep_down_bis   = Irreps::directProd( irrep_down , irrep_excitation );
+            unsigned int string_up_bis, string_down_bis;
             
             // - ( a_i,up^+ a_j,up )( a_j,down^+ a_i,down )
-            const int sign_down_ji  = lookup_sign_beta [ irrep_down ][ orbj + L * orbi ][ count_down ];
-            const int sign_up_ij    = lookup_sign_alpha[ irrep_up   ][ orbi + L * orbj ][ count_up ];
+            const int sign_down_ji  = excite_string( string_down, orbj, orbi, string_down_bis );
+            const int sign_up_ij    = (( sign_down_ji == 0 ) ? 0 : excite_string( string_up, orbi, orbj, string_up_bis ));
             const int sign_product1 = sign_up_ij * sign_down_ji;
             if ( sign_product1 != 0 ){
-               const int cnt_down_ji = lookup_cnt_beta [ irrep_down ][ orbj + L * orbi ][ count_down ];
-               const int cnt_up_ij   = lookup_cnt_alpha[ irrep_up   ][ orbi + L * orbj ][ count_up ];
+               const int cnt_down_ji = str2cnt_down[ irrep_down_bis ][ string_down_bis ];
+               const int cnt_up_ij   = str2cnt_up  [ irrep_up_bis   ][ string_up_bis   ];
                result -= sign_product1 * vector[ irrep_center_jumps[ 0 ][ irrep_up_bis ] + cnt_up_ij + numPerIrrep_up[ irrep_up_bis ] * cnt_down_ji ] * vector[ counter ];
             }
 
             // - ( a_j,up^+ a_i,up )( a_i,down^+ a_j,down )
-            const int sign_down_ij  = lookup_sign_beta [ irrep_down ][ orbi + L * orbj ][ count_down ];
-            const int sign_up_ji    = lookup_sign_alpha[ irrep_up   ][ orbj + L * orbi ][ count_up ];
+            const int sign_down_ij  = excite_string( string_down, orbi, orbj, string_down_bis );
+            const int sign_up_ji    = (( sign_down_ij == 0 ) ? 0 : excite_string( string_up, orbj, orbi, string_up_bis ));
             const int sign_product2 = sign_up_ji * sign_down_ij;
             if ( sign_product2 != 0 ){
-               const int cnt_down_ij = lookup_cnt_beta [ irrep_down ][ orbi + L * orbj ][ count_down ];
-               const int cnt_up_ji   = lookup_cnt_alpha[ irrep_up   ][ orbj + L * orbi ][ count_up ];
+               const int cnt_down_ij = str2cnt_down[ irrep_down_bis ][ string_down_bis ];
+               const int cnt_up_ji   = str2cnt_up  [ irrep_up_bis   ][ string_up_bis   ];
                result -= sign_product2 * vector[ irrep_center_jumps[ 0 ][ irrep_up_bis ] + cnt_up_ji + numPerIrrep_up[ irrep_up_bis ] * cnt_down_ij ] * vector[ counter ];
             }
          
@@ -1464,9 +1868,10 @@ double CheMPS2::FCI::CalcSpinSquared(double * vector) const{
 
 }
 
-void CheMPS2::FCI::DiagHam(double * diag) const{
+void CheMPS2::FCI::DiagHam(double * diag, const unsigned int * jumps) const{
 
-   const unsigned int vecLength = getVecLength( 0 );
+   const unsigned int * zero_jumps = irrep_center_jumps[ 0 ];
+   if ( jumps == NULL ){ jumps = zero_jumps; }
 
    #pragma omp parallel
    {
@@ -1474,23 +1879,29 @@ void CheMPS2::FCI::DiagHam(double * diag) const{
       int * bits_up   = new int[ L ];
       int * bits_down = new int[ L ];
       
-      #pragma omp for schedule(static)
-      for ( unsigned int counter = 0; counter < vecLength; counter++ ){
+      for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
       
-         double myResult = 0.0;
-         getBitsOfCounter( 0 , counter , bits_up , bits_down ); // Fetch the corresponding bits
+         const unsigned int num_local = jumps[ irrep_up + 1 ] - jumps[ irrep_up ]; // Zero for the blocks which are not requested
+      
+         #pragma omp for schedule(static)
+         for ( unsigned int local = 0; local < num_local; local++ ){
          
-         for ( unsigned int orb1 = 0; orb1 < L; orb1++ ){
-            const int n_tot_orb1 = bits_up[ orb1 ] + bits_down[ orb1 ];
-            myResult += n_tot_orb1 * getGmat( orb1 , orb1 );
-            for ( unsigned int orb2 = 0; orb2 < L; orb2++ ){
-               myResult += 0.5 * n_tot_orb1 * ( bits_up[ orb2 ] + bits_down[ orb2 ] ) * getERI( orb1 , orb1 , orb2 , orb2 );
-               myResult += 0.5 * ( n_tot_orb1 - bits_up[ orb1 ] * bits_up[ orb2 ] - bits_down[ orb1 ] * bits_down[ orb2 ] ) * getERI( orb1 , orb2 , orb2 , orb1 );
+            const unsigned int counter = zero_jumps[ irrep_up ] + local;
+            double myResult = 0.0;
+            getBitsOfCounter( 0 , counter , bits_up , bits_down ); // Fetch the corresponding bits
+            
+            for ( unsigned int orb1 = 0; orb1 < L; orb1++ ){
+               const int n_tot_orb1 = bits_up[ orb1 ] + bits_down[ orb1 ];
+               myResult += n_tot_orb1 * getGmat( orb1 , orb1 );
+               for ( unsigned int orb2 = 0; orb2 < L; orb2++ ){
+                  myResult += 0.5 * n_tot_orb1 * ( bits_up[ orb2 ] + bits_down[ orb2 ] ) * getERI( orb1 , orb1 , orb2 , orb2 );
+                  myResult += 0.5 * ( n_tot_orb1 - bits_up[ orb1 ] * bits_up[ orb2 ] - bits_down[ orb1 ] * bits_down[ orb2 ] ) * getERI( orb1 , orb2 , orb2 , orb1 );
+               }
             }
+            
+            diag[ jumps[ irrep_up ] + local ] = myResult;
+            
          }
-         
-         diag[ counter ] = myResult;
-         
       }
       
       delete [] bits_up;
@@ -1506,8 +1917,6 @@ void CheMPS2::FCI::DiagHamSquared(double * output) const{
    struct timeval start, end;
    gettimeofday(&start, NULL);
 
-   const unsigned int vecLength = getVecLength( 0 );
-   
    //
    //   Wick's theorem to evaluate the Hamiltonian squared:
    //
@@ -1533,169 +1942,274 @@ void CheMPS2::FCI::DiagHamSquared(double * output) const{
    //          
    //          g_ij g_kl E_ij E_kl = g_ii g_kk num(i,s1) num(k,s2) + g_ik g_ki num(i,s1) [1-num(k,s2)] delta(s1,s2)
    //
+   //   The four-index part of diag( H^2 ) is
+   //
+   //       0.5 * (ak|ci) * (ak|ci) * [ n_a,up * (1-n_k,up) + n_a,down * (1-n_k,down) ] * [ n_c,up * (1-n_i,up) + n_c,down * (1-n_i,down) ]
+   //     - 0.5 * (ak|ci) * (ai|ck) * [ n_a,up * n_c,up * (1-n_i,up) * (1-n_k,up) + n_a,down * n_c,down * (1-n_i,down) * (1-n_k,down) ]
+   //
+   //   With the pair vectors u_ak = n_a,up * (1-n_k,up) and d_ak = n_a,down * (1-n_k,down), and the pair matrices
+   //   A[ ak, ci ] = (ak|ci) * (ak|ci) and B[ ak, ci ] = (ak|ci) * (ai|ck), this becomes
+   //
+   //       0.5 * u^T ( A - B ) u + 0.5 * d^T ( A - B ) d + u^T A d
+   //
+   //   The first two terms only depend on the up resp. down string, and the last term is a matrix product between
+   //   the pair vectors of a block of up strings and A times the pair vectors of a block of down strings. The pair
+   //   matrices are block diagonal in the irrep of the pair. Similarly, the Coulomb and exchange matrices
+   //   J_ij = (ij|kk) * ( n_k,up + n_k,down ) and K_ij = (ik|kj) * n_k are obtained per string block with dgemm_.
+   //
    
-   #pragma omp parallel
-   {
-
-      int * bits_up   = new int[ L ];
-      int * bits_down = new int[ L ];
-      
-      double * Jmat       = new double[ L * L ]; // (ij|kk)( n_k,up + n_k,down )
-      double * K_reg_up   = new double[ L * L ]; // (ik|kj)( n_k,up )
-      double * K_reg_down = new double[ L * L ]; // (ik|kj)( n_k,down )
-      double * K_bar_up   = new double[ L * L ]; // (ik|kj)( 1 - n_k,up )
-      double * K_bar_down = new double[ L * L ]; // (ik|kj)( 1 - n_k,down )
-      
-      int * specific_orbs_irrep = new int[ num_irreps * ( L + 1 ) ];
-      for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
-         int count = 0;
-         for ( unsigned int orb = 0; orb < L; orb++){
-            specific_orbs_irrep[ orb + ( L + 1 ) * irrep ] = 0;
-            if ( getOrb2Irrep(orb) == irrep ){
-               specific_orbs_irrep[ count + ( L + 1 ) * irrep ] = orb;
+   const int size_pair = L * L;
+   const int block     = 64; // Number of strings per block
+   
+   // Order the orbital pairs ( a, k ) by the irrep of a x k
+   int * pair_jumps = new int[ num_irreps + 1 ];
+   int * pair_orb1  = new int[ size_pair ];
+   int * pair_orb2  = new int[ size_pair ];
+   int * mat_jumps  = new int[ num_irreps + 1 ];
+   pair_jumps[ 0 ] = 0;
+   mat_jumps [ 0 ] = 0;
+   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+      int count = pair_jumps[ irrep ];
+      for ( unsigned int orb2 = 0; orb2 < L; orb2++ ){
+         for ( unsigned int orb1 = 0; orb1 < L; orb1++ ){
+            if ( Irreps::directProd( getOrb2Irrep( orb1 ), getOrb2Irrep( orb2 ) ) == (int) irrep ){
+               pair_orb1[ count ] = orb1;
+               pair_orb2[ count ] = orb2;
                count++;
             }
          }
-         specific_orbs_irrep[ L + ( L + 1 ) * irrep ] = count;
       }
+      pair_jumps[ irrep + 1 ] = count;
+      mat_jumps [ irrep + 1 ] = mat_jumps[ irrep ] + ( count - pair_jumps[ irrep ] ) * ( count - pair_jumps[ irrep ] );
+   }
+   
+   // The block diagonal pair matrices A and ( A - B )
+   double * pair_A     = new double[ mat_jumps[ num_irreps ] ];
+   double * pair_AminB = new double[ mat_jumps[ num_irreps ] ];
+   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+      const int num = pair_jumps[ irrep + 1 ] - pair_jumps[ irrep ];
+      for ( int col = 0; col < num; col++ ){
+         const int c = pair_orb1[ pair_jumps[ irrep ] + col ];
+         const int i = pair_orb2[ pair_jumps[ irrep ] + col ];
+         for ( int row = 0; row < num; row++ ){
+            const int a = pair_orb1[ pair_jumps[ irrep ] + row ];
+            const int k = pair_orb2[ pair_jumps[ irrep ] + row ];
+            const double eri_akci = getERI( a, k, c, i );
+            const double eri_aick = getERI( a, i, c, k );
+            pair_A    [ mat_jumps[ irrep ] + row + num * col ] = eri_akci * eri_akci;
+            pair_AminB[ mat_jumps[ irrep ] + row + num * col ] = eri_akci * ( eri_akci - eri_aick );
+         }
+      }
+   }
+   
+   // Coulomb and exchange tensors: J_eri[ i + L * j + L * L * k ] = (ij|kk) and K_eri[ i + L * j + L * L * k ] = (ik|kj)
+   double * J_eri = new double[ size_pair * L ];
+   double * K_eri = new double[ size_pair * L ];
+   double * K_tot = new double[ size_pair ];
+   for ( unsigned int i = 0; i < L; i++ ){
+      for ( unsigned int j = 0; j < L; j++ ){
+         double value = 0.0;
+         for ( unsigned int k = 0; k < L; k++ ){
+            J_eri[ i + L * j + size_pair * k ] = getERI( i, j, k, k );
+            K_eri[ i + L * j + size_pair * k ] = getERI( i, k, k, j );
+            value += getERI( i, k, k, j );
+         }
+         K_tot[ i + L * j ] = value;
+      }
+   }
+   
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+   
+      const int irrep_down        = Irreps::directProd( irrep_up, TargetIrrep );
+      const unsigned int num_up   = numPerIrrep_up  [ irrep_up   ];
+      const unsigned int num_down = numPerIrrep_down[ irrep_down ];
+      if ( num_up * num_down == 0 ){ continue; }
       
-      #pragma omp for schedule(static)
-      for (unsigned int counter = 0; counter < vecLength; counter++){
+      double * target    = output + irrep_center_jumps[ 0 ][ irrep_up ];
+      double * diag_up   = new double[ num_up ];
+      double * diag_down = new double[ num_down ];
+      const int num_blocks_up   = ( num_up   + block - 1 ) / block;
+      const int num_blocks_down = ( num_down + block - 1 ) / block;
+      
+      #pragma omp parallel
+      {
       
-         getBitsOfCounter( 0 , counter , bits_up , bits_down ); // Fetch the corresponding bits
+         int    * bits       = new int   [ L ];
+         double * occ_up     = new double[ L * block ];
+         double * occ_down   = new double[ L * block ];
+         double * pairs_up   = new double[ size_pair * block ];
+         double * pairs_down = new double[ size_pair * block ];
+         double * work       = new double[ size_pair * block ];
+         double * J_up       = new double[ size_pair * block ];
+         double * J_down     = new double[ size_pair * block ];
+         double * K_up       = new double[ size_pair * block ];
+         double * K_down     = new double[ size_pair * block ];
          
-         // Construct the J and K matrices properly
-         for ( unsigned int i = 0; i < L; i++ ){
-            for ( unsigned int j = i; j < L; j++ ){
-               
-               double val_J        = 0.0;
-               double val_KregUP   = 0.0;
-               double val_KregDOWN = 0.0;
-               double val_KbarUP   = 0.0;
-               double val_KbarDOWN = 0.0;
-               
-               if ( getOrb2Irrep(i) == getOrb2Irrep(j) ){
-                  for ( unsigned int k = 0; k < L; k++ ){
-                     const double temp = getERI(i,k,k,j);
-                     val_J        += getERI(i,j,k,k) * ( bits_up[k] + bits_down[k] );
-                     val_KregUP   += temp * bits_up[k];
-                     val_KregDOWN += temp * bits_down[k];
-                     val_KbarUP   += temp * ( 1 - bits_up[k] );
-                     val_KbarDOWN += temp * ( 1 - bits_down[k] );
+         // The single-string terms 0.5 * u^T ( A - B ) u and 0.5 * d^T ( A - B ) d
+         for ( int spin = 0; spin < 2; spin++ ){
+         
+            const int num_blocks  = (( spin == 0 ) ? num_blocks_up : num_blocks_down );
+            const unsigned int num_str = (( spin == 0 ) ? num_up : num_down );
+            unsigned int * cnt2str     = (( spin == 0 ) ? cnt2str_up[ irrep_up ] : cnt2str_down[ irrep_down ] );
+            double * diag_str          = (( spin == 0 ) ? diag_up : diag_down );
+            
+            #pragma omp for schedule(dynamic)
+            for ( int index = 0; index < num_blocks; index++ ){
+               const unsigned int first = index * block;
+               const int num = std::min( (unsigned int) block, num_str - first );
+               DiagHamSquaredStrings( cnt2str + first, num, bits, occ_up, pairs_up, pair_orb1, pair_orb2 );
+               for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+                  int dim = pair_jumps[ irrep + 1 ] - pair_jumps[ irrep ];
+                  if ( dim > 0 ){
+                     char notrans = 'N';
+                     double one = 1.0;
+                     double set = 0.0;
+                     int ldp = size_pair;
+                     int ncol = num;
+                     dgemm_( &notrans, &notrans, &dim, &ncol, &dim, &one, pair_AminB + mat_jumps[ irrep ], &dim, pairs_up + pair_jumps[ irrep ], &ldp, &set, work + pair_jumps[ irrep ], &ldp );
                   }
                }
-               
-               Jmat[ i + L * j ] = val_J;
-               Jmat[ j + L * i ] = val_J;
-               K_reg_up[ i + L * j ] = val_KregUP;
-               K_reg_up[ j + L * i ] = val_KregUP;
-               K_reg_down[ i + L * j ] = val_KregDOWN;
-               K_reg_down[ j + L * i ] = val_KregDOWN;
-               K_bar_up[ i + L * j ] = val_KbarUP;
-               K_bar_up[ j + L * i ] = val_KbarUP;
-               K_bar_down[ i + L * j ] = val_KbarDOWN;
-               K_bar_down[ j + L * i ] = val_KbarDOWN;
-               
+               for ( int str = 0; str < num; str++ ){
+                  double value = 0.0;
+                  for ( int pair = 0; pair < size_pair; pair++ ){ value += pairs_up[ pair + size_pair * str ] * work[ pair + size_pair * str ]; }
+                  diag_str[ first + str ] = 0.5 * value;
+               }
             }
          }
          
-         double temp = 0.0;
-         // G[i,i] (n_i,up + n_i,down) + 0.5 * ( J[i,i] (n_i,up + n_i,down) + K_bar_up[i,i] * n_i,up + K_bar_down[i,i] * n_i,down )
-         for ( unsigned int i = 0; i < L; i++ ){
-            const int num_i = bits_up[i] + bits_down[i];
-            temp += getGmat(i, i) * num_i + 0.5 * ( Jmat[ i + L * i ] * num_i + K_bar_up[ i + L * i ]   * bits_up[i]
-                                                                              + K_bar_down[ i + L * i ] * bits_down[i] );
-         }
-         double myResult = temp*temp;
+         // The cross term u^T A d and the Coulomb and exchange terms, per block of down strings
+         #pragma omp for schedule(dynamic)
+         for ( int index_down = 0; index_down < num_blocks_down; index_down++ ){
          
-         for ( unsigned int p = 0; p < L; p++ ){
-            for ( unsigned int q = 0; q < L; q++ ){
-               if ( getOrb2Irrep(p) == getOrb2Irrep(q) ){
+            const unsigned int first_down = index_down * block;
+            const int num_d = std::min( (unsigned int) block, num_down - first_down );
+            DiagHamSquaredStrings( cnt2str_down[ irrep_down ] + first_down, num_d, bits, occ_down, pairs_down, pair_orb1, pair_orb2 );
             
-                  const int special_pq         = bits_up[p] * ( 1 - bits_up[q] ) + bits_down[p] * ( 1 - bits_down[q] );
-                  const double GplusJ_pq       = getGmat(p, q) + Jmat[ p + L * q ];
-                  const double K_cross_pq_up   = ( K_bar_up[ p + L * q ] - K_reg_up[ p + L * q ]     ) * bits_up[p]   * ( 1 - bits_up[q]   );
-                  const double K_cross_pq_down = ( K_bar_down[ p + L * q ] - K_reg_down[ p + L * q ] ) * bits_down[p] * ( 1 - bits_down[q] );
-                  
-                  myResult += ( GplusJ_pq * ( special_pq * GplusJ_pq + K_cross_pq_up + K_cross_pq_down )
-                              + 0.25 * ( K_cross_pq_up * K_cross_pq_up + K_cross_pq_down * K_cross_pq_down ) );
-                  
+            char notrans = 'N';
+            char trans   = 'T';
+            double one   = 1.0;
+            double set   = 0.0;
+            int ldp      = size_pair;
+            int ldt      = num_up;
+            int Lvalue   = L;
+            int ncol_d   = num_d;
+            for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+               int dim = pair_jumps[ irrep + 1 ] - pair_jumps[ irrep ];
+               if ( dim > 0 ){
+                  dgemm_( &notrans, &notrans, &dim, &ncol_d, &dim, &one, pair_A + mat_jumps[ irrep ], &dim, pairs_down + pair_jumps[ irrep ], &ldp, &set, work + pair_jumps[ irrep ], &ldp );
                }
             }
-         }
-         
-         /*
-         
-            Part which can be optimized most still --> For H2O/6-31G takes 82.8 % of time with Intel compiler
-            Optimization can in principle be done with lookup tables + dgemm_ as matvec product --> bit of work :-(
-         
-            For future reference: the quantity which is computed here:
+            dgemm_( &notrans, &notrans, &ldp, &ncol_d, &Lvalue, &one, J_eri, &ldp, occ_down, &Lvalue, &set, J_down, &ldp );
+            dgemm_( &notrans, &notrans, &ldp, &ncol_d, &Lvalue, &one, K_eri, &ldp, occ_down, &Lvalue, &set, K_down, &ldp );
             
-               0.5 * (ak|ci) * (ak|ci) * [ n_a,up * (1-n_k,up) + n_a,down * (1-n_k,down) ] * [ n_c,up * (1-n_i,up) + n_c,down * (1-n_i,down) ]
-             - 0.5 * (ak|ci) * (ai|ck) * [ n_a,up * n_c,up * (1-n_i,up) * (1-n_k,up) + n_a,down * n_c,down * (1-n_i,down) * (1-n_k,down) ]
-         
-         */
-         for ( unsigned int k = 0; k < L; k++ ){
-            if ( bits_up[k] + bits_down[k] < 2 ){
-               for ( unsigned int a = 0; a < L; a++ ){
+            for ( int index_up = 0; index_up < num_blocks_up; index_up++ ){
+            
+               const unsigned int first_up = index_up * block;
+               const int num_u = std::min( (unsigned int) block, num_up - first_up );
+               DiagHamSquaredStrings( cnt2str_up[ irrep_up ] + first_up, num_u, bits, occ_up, pairs_up, pair_orb1, pair_orb2 );
+               int ncol_u = num_u;
+               dgemm_( &notrans, &notrans, &ldp, &ncol_u, &Lvalue, &one, J_eri, &ldp, occ_up, &Lvalue, &set, J_up, &ldp );
+               dgemm_( &notrans, &notrans, &ldp, &ncol_u, &Lvalue, &one, K_eri, &ldp, occ_up, &Lvalue, &set, K_up, &ldp );
                
-                  const int special_ak    = ( bits_up[a]   * ( 1 - bits_up[k]   )
-                                            + bits_down[a] * ( 1 - bits_down[k] ) );
-                  const int local_ak_up   = bits_up[a]   * ( 1 - bits_up[k]   );
-                  const int local_ak_down = bits_down[a] * ( 1 - bits_down[k] );
+               double * result = target + first_up + num_up * first_down;
+               for ( int str_d = 0; str_d < num_d; str_d++ ){
+                  for ( int str_u = 0; str_u < num_u; str_u++ ){ result[ str_u + num_up * str_d ] = 0.0; }
+               }
+               for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+                  int dim = pair_jumps[ irrep + 1 ] - pair_jumps[ irrep ];
+                  if ( dim > 0 ){
+                     dgemm_( &trans, &notrans, &ncol_u, &ncol_d, &dim, &one, pairs_up + pair_jumps[ irrep ], &ldp, work + pair_jumps[ irrep ], &ldp, &one, result, &ldt );
+                  }
+               }
                
-                  if ( ( special_ak > 0 ) || ( local_ak_up > 0 ) || ( local_ak_down > 0 ) ){
-                  
-                     const int irrep_ak = Irreps::directProd( getOrb2Irrep(a), getOrb2Irrep(k) );
-                        
+               for ( int str_d = 0; str_d < num_d; str_d++ ){
+                  const double * n_down = occ_down + L * str_d;
+                  const double * Jd     = J_down + size_pair * str_d;
+                  const double * Kd     = K_down + size_pair * str_d;
+                  for ( int str_u = 0; str_u < num_u; str_u++ ){
+                     const double * n_up = occ_up + L * str_u;
+                     const double * Ju   = J_up + size_pair * str_u;
+                     const double * Ku   = K_up + size_pair * str_u;
+                     
+                     // G[i,i] (n_i,up + n_i,down) + 0.5 * ( J[i,i] (n_i,up + n_i,down) + K_bar_up[i,i] * n_i,up + K_bar_down[i,i] * n_i,down )
+                     double temp = 0.0;
                      for ( unsigned int i = 0; i < L; i++ ){
-                        if ( bits_up[i] + bits_down[i] < 2 ){
-                  
-                           const int offset     = Irreps::directProd( irrep_ak, getOrb2Irrep(i) ) * ( L + 1 );
-                           const int bar_i_up   = 1 - bits_up[i];
-                           const int bar_i_down = 1 - bits_down[i];
-                           const int max_c_cnt  = specific_orbs_irrep[ L + offset ];
-                              
-                           for ( int c_cnt = 0; c_cnt < max_c_cnt; c_cnt++ ){
-                              const int c            = specific_orbs_irrep[ c_cnt + offset ];
-                              const int fact_ic_up   = bits_up[c]   * bar_i_up;
-                              const int fact_ic_down = bits_down[c] * bar_i_down;
-                              const int prefactor1   = ( fact_ic_up + fact_ic_down ) * special_ak;
-                              const int prefactor2   = local_ak_up * fact_ic_up + local_ak_down * fact_ic_down;
-                              const double eri_akci  = getERI(a, k, c, i);
-                              const double eri_aick  = getERI(a, i, c, k);
-                              myResult += 0.5 * eri_akci * ( prefactor1 * eri_akci - prefactor2 * eri_aick );
-                           }
-                        }
+                        const int ii = i * ( L + 1 );
+                        const double num_i = n_up[ i ] + n_down[ i ];
+                        temp += getGmat( i, i ) * num_i + 0.5 * ( ( Ju[ ii ] + Jd[ ii ] ) * num_i + ( K_tot[ ii ] - Ku[ ii ] ) * n_up[ i ]
+                                                                                             + ( K_tot[ ii ] - Kd[ ii ] ) * n_down[ i ] );
+                     }
+                     double myResult = temp * temp + diag_up[ first_up + str_u ] + diag_down[ first_down + str_d ];
+                     
+                     // The orbital pairs with p and q in the same irrep
+                     for ( int pair = 0; pair < pair_jumps[ 1 ]; pair++ ){
+                        const int p  = pair_orb1[ pair ];
+                        const int q  = pair_orb2[ pair ];
+                        const int pq = p + L * q;
+                        const double ex_up           = n_up  [ p ] * ( 1 - n_up  [ q ] );
+                        const double ex_down         = n_down[ p ] * ( 1 - n_down[ q ] );
+                        const double GplusJ_pq       = getGmat( p, q ) + Ju[ pq ] + Jd[ pq ];
+                        const double K_cross_pq_up   = ( K_tot[ pq ] - 2 * Ku[ pq ] ) * ex_up;   // K_bar_up - K_reg_up
+                        const double K_cross_pq_down = ( K_tot[ pq ] - 2 * Kd[ pq ] ) * ex_down; // K_bar_down - K_reg_down
+                        myResult += ( GplusJ_pq * ( ( ex_up + ex_down ) * GplusJ_pq + K_cross_pq_up + K_cross_pq_down )
+                                    + 0.25 * ( K_cross_pq_up * K_cross_pq_up + K_cross_pq_down * K_cross_pq_down ) );
                      }
+                     
+                     result[ str_u + num_up * str_d ] += myResult;
                   }
                }
             }
          }
          
-         output[ counter ] = myResult;
+         delete [] bits;
+         delete [] occ_up;
+         delete [] occ_down;
+         delete [] pairs_up;
+         delete [] pairs_down;
+         delete [] work;
+         delete [] J_up;
+         delete [] J_down;
+         delete [] K_up;
+         delete [] K_down;
       
       }
       
-      delete [] bits_up;
-      delete [] bits_down;
-      
-      delete [] Jmat;
-      delete [] K_reg_up;
-      delete [] K_reg_down;
-      delete [] K_bar_up;
-      delete [] K_bar_down;
-      
-      delete [] specific_orbs_irrep;
+      delete [] diag_up;
+      delete [] diag_down;
    
    }
    
+   delete [] pair_jumps;
+   delete [] pair_orb1;
+   delete [] pair_orb2;
+   delete [] mat_jumps;
+   delete [] pair_A;
+   delete [] pair_AminB;
+   delete [] J_eri;
+   delete [] K_eri;
+   delete [] K_tot;
+   
    gettimeofday(&end, NULL);
    const double elapsed = (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
    if ( FCIverbose > 0 ){ cout << "FCI::DiagHamSquared : Wall time = " << elapsed << " seconds" << endl; }
 
 }
 
+void CheMPS2::FCI::DiagHamSquaredStrings( const unsigned int * strings, const int num, int * bits, double * occupations, double * pairs, const int * pair_orb1, const int * pair_orb2 ) const{
+
+   const int size_pair = L * L;
+   for ( int str = 0; str < num; str++ ){
+      str2bits( L, strings[ str ], bits );
+      double * occ = occupations + L * str;
+      for ( unsigned int orb = 0; orb < L; orb++ ){ occ[ orb ] = bits[ orb ]; }
+      double * pair_vec = pairs + size_pair * str;
+      for ( int pair = 0; pair < size_pair; pair++ ){
+         pair_vec[ pair ] = bits[ pair_orb1[ pair ] ] * ( 1 - bits[ pair_orb2[ pair ] ] );
+      }
+   }
+
+}
+
 
 unsigned int CheMPS2::FCI::LowestEnergyDeterminant() const{
 
@@ -1905,6 +2419,31 @@ void CheMPS2::FCI::FCIdscal(const unsigned int vecLength, const double alpha, do
 
 }
 
+unsigned int CheMPS2::FCI::FCIorthonormalize(const unsigned int vecLength, const unsigned int num_in, double * input, double * output){
+
+   unsigned int num_out = 0;
+   for ( unsigned int vec = 0; vec < num_in; vec++ ){
+      double * target = output + ( unsigned long long ) vecLength * num_out;
+      FCIdcopy( vecLength, input + ( unsigned long long ) vecLength * vec, target );
+      const double norm_orig = FCIfrobeniusnorm( vecLength, target );
+      if ( norm_orig > 0.0 ){
+         for ( int pass = 0; pass < 2; pass++ ){
+            for ( unsigned int prev = 0; prev < num_out; prev++ ){
+               double * previous = output + ( unsigned long long ) vecLength * prev;
+               FCIdaxpy( vecLength, - FCIddot( vecLength, previous, target ), previous, target );
+            }
+         }
+         const double norm_new = FCIfrobeniusnorm( vecLength, target );
+         if ( norm_new > CheMPS2::CONJ_GRADIENT_BLOCK_DROP * norm_orig ){
+            FCIdscal( vecLength, 1.0 / norm_new, target );
+            num_out++;
+         }
+      }
+   }
+   return num_out;
+
+}
+
 void CheMPS2::FCI::ClearVector(const unsigned int vecLength, double * vec){
 
    for ( unsigned int cnt = 0; cnt < vecLength; cnt++ ){ vec[cnt] = 0.0; }
@@ -1919,11 +2458,36 @@ void CheMPS2::FCI::FillRandom(const unsigned int vecLength, double * vec){
 
 double CheMPS2::FCI::GSDavidson(double * inoutput, const int DVDSN_NUM_VEC) const{
 
+   if ( csf_TwoS >= 0 ){
+      #ifdef CHEMPS2_MPI_COMPILATION
+      if (( mpi_distributed ) && ( MPIchemps2::mpi_rank() != MPI_CHEMPS2_MASTER )){
+         DistributedMatvecHelp();
+         double FCIenergy = 0.0;
+         MPIchemps2::broadcast_array_double( &FCIenergy, 1, MPI_CHEMPS2_MASTER );
+         return FCIenergy;
+      }
+      #endif
+      double FCIenergy = GSDavidsonCSF( inoutput, DVDSN_NUM_VEC );
+      #ifdef CHEMPS2_MPI_COMPILATION
+      if ( mpi_distributed ){
+         int mpi_instruction = 0; // Stop the helpers
+         MPIchemps2::broadcast_array_int( &mpi_instruction, 1, MPI_CHEMPS2_MASTER );
+         MPIchemps2::broadcast_array_double( &FCIenergy, 1, MPI_CHEMPS2_MASTER );
+      }
+      #endif
+      return FCIenergy;
+   }
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){ return GSDavidsonDistributed( inoutput, DVDSN_NUM_VEC ); }
+   #endif
+
    const int veclength = getVecLength( 0 ); // Checked "assert( max_integer >= maxVecLength );" at FCI::StartupIrrepCenter()
    Davidson deBoskabouter( veclength, DVDSN_NUM_VEC,
                                       CheMPS2::DAVIDSON_NUM_VEC_KEEP,
                                       CheMPS2::DAVIDSON_FCI_RTOL,
                                       CheMPS2::DAVIDSON_PRECOND_CUTOFF, false ); // No debug printing for FCI
+   SetupDavidsonStorage( deBoskabouter, veclength, DVDSN_NUM_VEC, (( inoutput != NULL ) ? veclength : 0 ) );
    double ** whichpointers = new double*[2];
 
    char instruction = deBoskabouter.FetchInstruction( whichpointers );
@@ -1934,13 +2498,13 @@ double CheMPS2::FCI::GSDavidson(double * inoutput, const int DVDSN_NUM_VEC) cons
 
    instruction = deBoskabouter.FetchInstruction( whichpointers );
    while ( instruction == 'B' ){
-      matvec( whichpointers[0], whichpointers[1] );
+      DistributedMatvec( whichpointers, whichpointers + 1, 1 );
       instruction = deBoskabouter.FetchInstruction( whichpointers );
    }
 
    assert( instruction == 'C' );
    if ( inoutput != NULL ){ FCIdcopy( veclength, whichpointers[0], inoutput ); }
-   const double FCIenergy = whichpointers[1][0] + getEconst();
+   double FCIenergy = whichpointers[1][0] + getEconst();
    if ( FCIverbose > 1 ){ cout << "FCI::GSDavidson : Required number of matrix-vector multiplications = " << deBoskabouter.GetNumMultiplications() << endl; }
    if ( FCIverbose > 0 ){ cout << "FCI::GSDavidson : Converged ground state energy = " << FCIenergy << endl; }
    delete [] whichpointers;
@@ -1948,216 +2512,1222 @@ double CheMPS2::FCI::GSDavidson(double * inoutput, const int DVDSN_NUM_VEC) cons
 
 }
 
-/*********************************************************************************
- *                                                                               *
- *   Below this block all functions are for the Green's function calculations.   *
- *                                                                               *
- *********************************************************************************/
+#ifdef CHEMPS2_MPI_COMPILATION
+double CheMPS2::FCI::GSDavidsonDistributed(double * inoutput, const int DVDSN_NUM_VEC) const{
 
-void CheMPS2::FCI::ActWithNumberOperator(const unsigned int orbIndex, double * resultVector, double * sourceVector) const{
+   const int MPIRANK = MPIchemps2::mpi_rank();
+   unsigned int * jumps = new unsigned int[ num_irreps + 1 ];
+   const int seglength = SegmentJumps( mpi_block_owner, MPIRANK, jumps ); // Can be zero when there are more processes than blocks
+   int use_guess = (( inoutput != NULL ) ? 1 : 0 );
+   MPIchemps2::broadcast_array_int( &use_guess, 1, MPI_CHEMPS2_MASTER ); // Only inoutput of the master process is used
 
-   assert( orbIndex<L );
+   Davidson deBoskabouter( seglength, DVDSN_NUM_VEC,
+                                      CheMPS2::DAVIDSON_NUM_VEC_KEEP,
+                                      CheMPS2::DAVIDSON_FCI_RTOL,
+                                      CheMPS2::DAVIDSON_PRECOND_CUTOFF, false ); // No debug printing for FCI
+   deBoskabouter.DistributeVectors();
+   SetupDavidsonStorage( deBoskabouter, seglength, DVDSN_NUM_VEC, (( use_guess == 1 ) ? seglength : 0 ) );
+   double ** whichpointers = new double*[2];
 
-   int * bits_up    = new int[ L ];
-   int * bits_down  = new int[ L ];
+   char instruction = deBoskabouter.FetchInstruction( whichpointers );
+   assert( instruction == 'A' );
+   if ( use_guess == 1 ){ ScatterGatherBlocks( inoutput, whichpointers[0], jumps, true ); }
+   else { FillRandom( seglength, whichpointers[0] ); }
+   DiagHam( whichpointers[1], jumps );
 
-   const unsigned int vecLength = getVecLength( 0 );
-   for (unsigned int counter = 0; counter < vecLength; counter++){
-      getBitsOfCounter( 0 , counter , bits_up , bits_down );
-      resultVector[ counter ] = ( bits_up[ orbIndex ] + bits_down[ orbIndex ] ) * sourceVector[ counter ];
+   instruction = deBoskabouter.FetchInstruction( whichpointers );
+   while ( instruction == 'B' ){
+      BlockMatvec( whichpointers, whichpointers + 1, 1, mpi_block_owner, jumps );
+      instruction = deBoskabouter.FetchInstruction( whichpointers );
    }
-   
-   delete [] bits_up;
-   delete [] bits_down;
-
-}
-
-void CheMPS2::FCI::ActWithSecondQuantizedOperator(const char whichOperator, const bool isUp, const unsigned int orbIndex, double * thisVector, const FCI * otherFCI, double * otherVector) const{
-
-   assert( ( whichOperator=='C' ) || ( whichOperator=='A' ) ); //Operator should be a (C) Creator, or (A) Annihilator
-   assert( orbIndex<L  );
-   assert( L==otherFCI->getL() );
-
-   const unsigned int vecLength = getVecLength( 0 );
 
-   if ( getTargetIrrep() != Irreps::directProd( otherFCI->getTargetIrrep() , getOrb2Irrep( orbIndex ) )){
-      ClearVector( vecLength , thisVector );
-      return;
-   }
+   assert( instruction == 'C' );
+   if ( use_guess == 1 ){ ScatterGatherBlocks( inoutput, whichpointers[0], jumps, false ); }
+   const double FCIenergy = whichpointers[1][0] + getEconst(); // The same on all processes
+   if ( FCIverbose > 1 ){ cout << "FCI::GSDavidson : Required number of matrix-vector multiplications = " << deBoskabouter.GetNumMultiplications() << endl; }
+   if ( FCIverbose > 0 ){ cout << "FCI::GSDavidson : Converged ground state energy = " << FCIenergy << endl; }
+   delete [] whichpointers;
+   delete [] jumps;
+   return FCIenergy;
 
-   int * bits_up    = new int[ L ];
-   int * bits_down  = new int[ L ];
-   
-   if (( whichOperator=='C') && ( isUp )){
-      for (unsigned int counter = 0; counter < vecLength; counter++){
-         
-         getBitsOfCounter( 0 , counter , bits_up , bits_down );
-         
-         if ( bits_up[ orbIndex ] == 1 ){ // Operator = creator_up
-            bits_up[ orbIndex ] = 0;
-            int phase = 1;
-            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_up[ cnt ] ){ phase *= -1; } }
-            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
-         } else {
-            thisVector[ counter ] = 0.0;
+}
+#endif
+
+unsigned int CheMPS2::FCI::SpinAdapt(const int TwoS){
+
+   DeleteCSF();
+   if ( TwoS < 0 ){ return 0; }
+
+   const int TwoSz = Nel_up - Nel_down;
+   assert( TwoS >= abs( TwoSz ) );
+   assert( ( TwoS - TwoSz ) % 2 == 0 );
+   csf_TwoS = TwoS;
+
+   /* For num_open singly occupied orbitals, S^2 only couples the determinants of a spatial configuration which differ in the spin
+      pattern of the open orbitals. The doubly occupied orbitals give the same phase for the alpha and beta excitations of S^2,
+      so that the CSF coefficients of a spatial configuration only depend on num_open. They are constructed genealogically, with
+      the open orbitals coupled one by one in increasing order [R. Pauncz, Spin Eigenfunctions (Plenum Press, New York, 1979)].
+      A CSF is a path of intermediate spins S_k = S_{k-1} +- 1/2 from S_0 = 0 to S_{num_open} = S, and the coefficient of a spin
+      pattern is the product of the Clebsch-Gordan coefficients < S_{k-1} M_{k-1} ; 1/2 m_k | S_k M_k >, times the sign to reorder
+      the open orbitals from orbital order to the order of the determinants, where the alpha electrons precede the beta electrons.
+      Unlike a diagonalization of S^2 in the C( num_open, num_alpha ) spin patterns, this requires no storage beyond the CSFs. */
+   csf_coeff = new double*[ L + 1 ];
+   unsigned int * num_patterns  = new unsigned int[ L + 1 ];
+   unsigned int * num_functions = new unsigned int[ L + 1 ];
+   for ( unsigned int num_open = 0; num_open <= L; num_open++ ){
+      csf_coeff    [ num_open ] = NULL;
+      num_patterns [ num_open ] = 0;
+      num_functions[ num_open ] = 0;
+      const int twice_alpha = num_open + TwoSz;
+      if (( twice_alpha < 0 ) || ( twice_alpha % 2 != 0 ) || ( twice_alpha / 2 > ( int ) num_open ) || ( TwoS > ( int ) num_open ) || (( num_open - TwoS ) % 2 != 0 )){ continue; }
+      const unsigned int num_alpha = twice_alpha / 2;
+      const unsigned int num_up    = ( num_open + TwoS ) / 2; // Number of couplings S_k = S_{k-1} + 1/2 in a path
+      const unsigned int all_open  = ( 1U << num_open ) - 1;
+
+      // The spin patterns have num_alpha bits set; a path has bit k set if S_{k+1} = S_k + 1/2 and never goes below zero
+      for ( unsigned int pattern = 0; pattern <= all_open; pattern++ ){
+         if ( bitcount( pattern ) == num_alpha ){ num_patterns[ num_open ]++; }
+      }
+      for ( unsigned int path = 0; path <= all_open; path++ ){
+         if ( bitcount( path ) != num_up ){ continue; }
+         bool valid = true;
+         int twice_spin = 0;
+         for ( unsigned int orb = 0; ( orb < num_open ) && ( valid ); orb++ ){
+            twice_spin += ((( path >> orb ) & 1U ) ? 1 : -1 );
+            valid = ( twice_spin >= 0 );
          }
-         
+         if ( valid ){ num_functions[ num_open ]++; }
       }
-   }
-   
-   if (( whichOperator=='C') && ( !(isUp) )){
-      const int startphase = (( Nel_up % 2 ) == 0) ? 1 : -1;
-      for (unsigned int counter = 0; counter < vecLength; counter++){
-
-         getBitsOfCounter( 0 , counter , bits_up , bits_down );
-
-         if ( bits_down[ orbIndex ] == 1 ){ // Operator = creator_down
-            bits_down[ orbIndex ] = 0;
-            int phase = startphase;
-            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_down[ cnt ] ){ phase *= -1; } }
-            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
-         } else {
-            thisVector[ counter ] = 0.0;
+      if ( num_functions[ num_open ] == 0 ){ continue; }
+
+      const unsigned int num = num_patterns[ num_open ];
+      csf_coeff[ num_open ] = new double[ ( unsigned long long ) num * num_functions[ num_open ] ];
+      unsigned int function = 0;
+      for ( unsigned int path = 0; path <= all_open; path++ ){
+         if ( bitcount( path ) != num_up ){ continue; }
+         bool valid = true;
+         int twice_spin = 0;
+         for ( unsigned int orb = 0; ( orb < num_open ) && ( valid ); orb++ ){
+            twice_spin += ((( path >> orb ) & 1U ) ? 1 : -1 );
+            valid = ( twice_spin >= 0 );
          }
-
+         if ( valid == false ){ continue; }
+         double * coeff = csf_coeff[ num_open ] + ( unsigned long long ) num * function;
+         unsigned int index = 0;
+         for ( unsigned int pattern = 0; pattern <= all_open; pattern++ ){
+            if ( bitcount( pattern ) != num_alpha ){ continue; }
+            double value = 1.0;
+            int twice_S = 0;
+            int twice_M = 0;
+            int num_swaps = 0;
+            for ( unsigned int orb = 0; ( orb < num_open ) && ( value != 0.0 ); orb++ ){
+               const bool spin_up = ((( pattern >> orb ) & 1U ) == 1U );
+               twice_S += ((( path >> orb ) & 1U ) ? 1 : -1 );
+               twice_M += (( spin_up ) ? 1 : -1 );
+               if ( abs( twice_M ) > twice_S ){ value = 0.0; }
+               else if (( path >> orb ) & 1U ){ // S_k = S_{k-1} + 1/2
+                  value *= sqrt( ( twice_S + (( spin_up ) ? twice_M : -twice_M ) ) / ( 2.0 * twice_S ) );
+               } else { // S_k = S_{k-1} - 1/2
+                  value *= (( spin_up ) ? -1 : 1 ) * sqrt( ( twice_S + (( spin_up ) ? -twice_M : twice_M ) + 2 ) / ( 2.0 * twice_S + 4 ) );
+               }
+               if ( spin_up ){ num_swaps += bitcount( ( ~pattern ) & (( 1U << orb ) - 1 ) ); } // Beta electrons in front of this alpha electron
+            }
+            coeff[ index ] = (( num_swaps % 2 == 1 ) ? -value : value );
+            index++;
+         }
+         function++;
       }
    }
-   
-   if (( whichOperator=='A') && ( isUp )){
-      for (unsigned int counter = 0; counter < vecLength; counter++){
 
-         getBitsOfCounter( 0 , counter , bits_up , bits_down );
-         
-         if ( bits_up[ orbIndex ] == 0 ){ // Operator = annihilator_up
-            bits_up[ orbIndex ] = 1;
-            int phase = 1;
-            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_up[ cnt ] ){ phase *= -1; } }
-            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
-         } else {
-            thisVector[ counter ] = 0.0;
+   /* A spatial configuration is found from its determinant in which the alpha electrons occupy the lowest open orbitals.
+      The first sweep counts the spatial configurations, and the second sweep fills the determinant counters. */
+   const unsigned int vecLength = getVecLength( 0 );
+   for ( int sweep = 0; sweep < 2; sweep++ ){
+      unsigned int num_conf = 0;
+      unsigned int num_det  = 0;
+      unsigned int num_fun  = 0;
+      for ( unsigned int counter = 0; counter < vecLength; counter++ ){
+         const int irrep_up   = getUpIrrepOfCounter( 0 , counter );
+         const int count_up   = ( counter - irrep_center_jumps[ 0 ][ irrep_up ] ) % numPerIrrep_up[ irrep_up ];
+         const int count_down = ( counter - irrep_center_jumps[ 0 ][ irrep_up ] ) / numPerIrrep_up[ irrep_up ];
+         const unsigned int string_up   = cnt2str_up  [ irrep_up ][ count_up ];
+         const unsigned int string_down = cnt2str_down[ Irreps::directProd( irrep_up, TargetIrrep ) ][ count_down ];
+         const unsigned int string_open = string_up ^ string_down;
+         const unsigned int num_open    = bitcount( string_open );
+         if ( num_functions[ num_open ] == 0 ){ continue; }
+
+         // Is it the determinant with the alpha electrons in the lowest open orbitals?
+         const unsigned int open_alpha = bitcount( string_up & string_open );
+         unsigned int lowest_open = 0;
+         unsigned int num_lowest  = 0;
+         for ( unsigned int orb = 0; ( orb < L ) && ( num_lowest < open_alpha ); orb++ ){
+            if (( string_open >> orb ) & 1U ){ lowest_open |= ( 1U << orb ); num_lowest++; }
          }
-
+         if ( ( string_up & string_open ) != lowest_open ){ continue; }
+
+         if ( sweep == 1 ){
+            csf_conf_open[ num_conf ] = num_open;
+            csf_conf_det [ num_conf ] = num_det;
+            csf_conf_fun [ num_conf ] = num_fun;
+            const unsigned int string_double = string_up & string_down;
+            unsigned int index = 0;
+            for ( unsigned int pattern = 0; pattern < ( 1U << num_open ); pattern++ ){
+               if ( bitcount( pattern ) != open_alpha ){ continue; }
+               // Deposit the bits of the spin pattern in the open orbitals
+               unsigned int pattern_up = 0;
+               unsigned int position   = 0;
+               for ( unsigned int orb = 0; orb < L; orb++ ){
+                  if (( string_open >> orb ) & 1U ){
+                     if (( pattern >> position ) & 1U ){ pattern_up |= ( 1U << orb ); }
+                     position++;
+                  }
+               }
+               const unsigned int new_up   = string_double | pattern_up;
+               const unsigned int new_down = string_double | ( string_open ^ pattern_up );
+               int new_irrep_up = 0;
+               for ( unsigned int orb = 0; orb < L; orb++ ){
+                  if (( new_up >> orb ) & 1U ){ new_irrep_up = Irreps::directProd( new_irrep_up, getOrb2Irrep( orb ) ); }
+               }
+               const int new_irrep_down = Irreps::directProd( new_irrep_up, TargetIrrep );
+               csf_det[ num_det + index ] = irrep_center_jumps[ 0 ][ new_irrep_up ] + str2cnt_up[ new_irrep_up ][ new_up ]
+                                          + numPerIrrep_up[ new_irrep_up ] * str2cnt_down[ new_irrep_down ][ new_down ];
+               index++;
+            }
+         }
+         num_conf++;
+         num_det += num_patterns[ num_open ];
+         num_fun += num_functions[ num_open ];
       }
-   }
-   
-   if (( whichOperator=='A') && ( !(isUp) )){
-      const int startphase = (( Nel_up % 2 ) == 0) ? 1 : -1;
-      for (unsigned int counter = 0; counter < vecLength; counter++){
 
-         getBitsOfCounter( 0 , counter , bits_up , bits_down );
-         
-         if ( bits_down[ orbIndex ] == 0 ){ // Operator = annihilator_down
-            bits_down[ orbIndex ] = 1;
-            int phase = startphase;
-            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_down[ cnt ] ){ phase *= -1; } }
-            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
-         } else {
-            thisVector[ counter ] = 0.0;
-         }
-         
+      if ( sweep == 0 ){
+         csf_num_conf  = num_conf;
+         csf_conf_open = new unsigned int[ num_conf ];
+         csf_conf_det  = new unsigned int[ num_conf + 1 ];
+         csf_conf_fun  = new unsigned int[ num_conf + 1 ];
+         csf_det       = new unsigned int[ num_det ];
+      } else {
+         csf_conf_det[ num_conf ] = num_det;
+         csf_conf_fun[ num_conf ] = num_fun;
+         csf_num = num_fun;
       }
    }
-   
-   delete [] bits_up;
-   delete [] bits_down;
-
-}
-
-void CheMPS2::FCI::CGSolveSystem(const double alpha, const double beta, const double eta, double * RHS, double * RealSol, double * ImagSol, const bool checkError) const{
-
-   const unsigned int vecLength = getVecLength( 0 );
 
-   // Calculate the diagonal of the CG operator
-   double * temp = new double[ vecLength ];
-   double * diag = new double[ vecLength ];
-   CGdiagonal( alpha, beta, eta, diag, temp );
+   delete [] num_patterns;
+   delete [] num_functions;
 
-   assert( RealSol != NULL );
-   assert( ImagSol != NULL );
-   assert( fabs( eta ) > 0.0 );
+   if ( FCIverbose > 0 ){
+      cout << "FCI::SpinAdapt : Number of CSFs with 2S = " << TwoS << " in " << csf_num_conf << " spatial configurations = " << csf_num
+           << " ; number of determinants = " << vecLength << endl;
+   }
+   return csf_num;
 
-   /* 
-         ( alpha + beta H + I eta ) Solution = RHS
+}
 
-      is solved with the conjugate gradient (CG) method. Solution = RealSol + I * ImagSol.
-      CG requires a symmetric positive definite operator. Therefore:
+void CheMPS2::FCI::DeleteCSF(){
 
-         [ ( alpha + beta H )^2 + eta^2 ] * Solution = ( alpha + beta H - I eta ) * RHS
+   if ( csf_TwoS < 0 ){ return; }
+   for ( unsigned int num_open = 0; num_open <= L; num_open++ ){
+      if ( csf_coeff[ num_open ] != NULL ){ delete [] csf_coeff[ num_open ]; }
+   }
+   delete [] csf_coeff;
+   delete [] csf_conf_open;
+   delete [] csf_conf_det;
+   delete [] csf_conf_fun;
+   delete [] csf_det;
+   csf_TwoS      = -1;
+   csf_num       = 0;
+   csf_num_conf  = 0;
+   csf_conf_open = NULL;
+   csf_conf_det  = NULL;
+   csf_det       = NULL;
+   csf_conf_fun  = NULL;
+   csf_coeff     = NULL;
 
-      Clue: Solve for ImagSol first. RealSol is then simply
+}
 
-         RealSol = - ( alpha + beta H ) / eta * ImagSol
-   */
+void CheMPS2::FCI::CSFtoDet(double * csf_vector, double * det_vector) const{
 
-   /**** Solve for ImagSol ****/
-   double ** pointers = new double*[ 3 ];
-   double RMSerror = 0.0;
-   {
-      ConjugateGradient CG( vecLength, CheMPS2::CONJ_GRADIENT_RTOL, CheMPS2::CONJ_GRADIENT_PRECOND_CUTOFF, false );
-      char instruction = CG.step( pointers );
-      assert( instruction == 'A' );
-      for (unsigned int cnt = 0; cnt < vecLength; cnt++){ pointers[ 0 ][ cnt ] = - eta * RHS[ cnt ] / diag[ cnt ]; } // Initial guess
-      for (unsigned int cnt = 0; cnt < vecLength; cnt++){ pointers[ 1 ][ cnt ] = diag[ cnt ]; }                      // Diagonal of the operator
-      for (unsigned int cnt = 0; cnt < vecLength; cnt++){ pointers[ 2 ][ cnt ] = - eta * RHS[ cnt ]; }               // RHS of the problem
-      instruction = CG.step( pointers );
-      assert( instruction == 'B' );
-      while ( instruction == 'B' ){
-         CGoperator( alpha, beta, eta, pointers[ 0 ], temp, pointers[ 1 ] );
-         instruction = CG.step( pointers );
-      }
-      assert( instruction == 'C' );
-      FCIdcopy( vecLength, pointers[ 0 ], ImagSol );
-      RMSerror += pointers[ 1 ][ 0 ] * pointers[ 1 ][ 0 ];
-   }
-
-   /**** Solve for RealSol ****/
-   {
-      ConjugateGradient CG( vecLength, CheMPS2::CONJ_GRADIENT_RTOL, CheMPS2::CONJ_GRADIENT_PRECOND_CUTOFF, false );
-      char instruction = CG.step( pointers );
-      assert( instruction == 'A' );
-      CGAlphaPlusBetaHAM( - alpha / eta, - beta / eta, ImagSol, pointers[ 0 ] );                      // Initial guess real part can be obtained from the imaginary part
-      for (unsigned int cnt = 0; cnt < vecLength; cnt++){ pointers[ 1 ][ cnt ] = diag[ cnt ]; } // Diagonal of the operator
-      CGAlphaPlusBetaHAM( alpha, beta, RHS, pointers[ 2 ] );                                          // RHS of the problem
-      instruction = CG.step( pointers );
-      assert( instruction == 'B' );
-      while ( instruction == 'B' ){
-         CGoperator( alpha, beta, eta, pointers[ 0 ], temp, pointers[ 1 ] );
-         instruction = CG.step( pointers );
-      }
-      assert( instruction == 'C' );
-      FCIdcopy( vecLength, pointers[ 0 ], RealSol );
-      RMSerror += pointers[ 1 ][ 0 ] * pointers[ 1 ][ 0 ];
-   }
-   RMSerror = sqrt( RMSerror );
-   delete [] pointers;
-   delete [] temp;
-   delete [] diag;
+   ClearVector( getVecLength( 0 ), det_vector );
 
-   if (( checkError ) && ( FCIverbose > 0 )){
-      cout << "FCI::CGSolveSystem : RMS error when checking the solution = " << RMSerror << endl;
+   #pragma omp parallel for schedule(static)
+   for ( unsigned int conf = 0; conf < csf_num_conf; conf++ ){
+      const unsigned int num_pat = csf_conf_det[ conf + 1 ] - csf_conf_det[ conf ];
+      const unsigned int num_fun = csf_conf_fun[ conf + 1 ] - csf_conf_fun[ conf ];
+      const double * coeff = csf_coeff[ csf_conf_open[ conf ] ];
+      const unsigned int * dets = csf_det + csf_conf_det[ conf ];
+      const double * csf = csf_vector + csf_conf_fun[ conf ];
+      for ( unsigned int pat = 0; pat < num_pat; pat++ ){
+         double value = 0.0;
+         for ( unsigned int fun = 0; fun < num_fun; fun++ ){ value += coeff[ pat + num_pat * fun ] * csf[ fun ]; }
+         det_vector[ dets[ pat ] ] = value;
+      }
    }
 
 }
 
-void CheMPS2::FCI::CGAlphaPlusBetaHAM(const double alpha, const double beta, double * in, double * out) const{
+void CheMPS2::FCI::DetToCSF(double * det_vector, double * csf_vector) const{
 
-   matvec( in , out );
-   const unsigned int vecLength = getVecLength( 0 );
-   const double prefactor = alpha + beta * getEconst(); // matvec does only the parts with second quantized operators
-   for (unsigned int cnt = 0; cnt < vecLength; cnt++){
-      out[ cnt ] = prefactor * in[ cnt ] + beta * out[ cnt ]; // out = ( alpha + beta * H ) * in
+   #pragma omp parallel for schedule(static)
+   for ( unsigned int conf = 0; conf < csf_num_conf; conf++ ){
+      const unsigned int num_pat = csf_conf_det[ conf + 1 ] - csf_conf_det[ conf ];
+      const unsigned int num_fun = csf_conf_fun[ conf + 1 ] - csf_conf_fun[ conf ];
+      const double * coeff = csf_coeff[ csf_conf_open[ conf ] ];
+      const unsigned int * dets = csf_det + csf_conf_det[ conf ];
+      double * csf = csf_vector + csf_conf_fun[ conf ];
+      for ( unsigned int fun = 0; fun < num_fun; fun++ ){
+         double value = 0.0;
+         for ( unsigned int pat = 0; pat < num_pat; pat++ ){ value += coeff[ pat + num_pat * fun ] * det_vector[ dets[ pat ] ]; }
+         csf[ fun ] = value;
+      }
    }
 
 }
 
-void CheMPS2::FCI::CGoperator(const double alpha, const double beta, const double eta, double * in, double * temp, double * out) const{
+double CheMPS2::FCI::GSDavidsonCSF(double * inoutput, const int DVDSN_NUM_VEC) const{
 
-   const unsigned int vecLength = getVecLength( 0 );
-   CGAlphaPlusBetaHAM( alpha, beta, in,   temp ); // temp  = ( alpha + beta * H )   * in
-   CGAlphaPlusBetaHAM( alpha, beta, temp, out  ); // out   = ( alpha + beta * H )^2 * in
-   FCIdaxpy( vecLength, eta*eta, in, out );       // out   = [ ( alpha + beta * H )^2 + eta*eta ] * in
+   assert( csf_num > 0 ); // There should be CSFs with spin csf_TwoS / 2 in the symmetry sector
+   const int veclength = csf_num;
+   const unsigned int detlength = getVecLength( 0 );
+   Davidson deBoskabouter( veclength, DVDSN_NUM_VEC,
+                                      CheMPS2::DAVIDSON_NUM_VEC_KEEP,
+                                      CheMPS2::DAVIDSON_FCI_RTOL,
+                                      CheMPS2::DAVIDSON_PRECOND_CUTOFF, false ); // No debug printing for FCI
+   SetupDavidsonStorage( deBoskabouter, veclength, DVDSN_NUM_VEC, ( 2 + (( inoutput != NULL ) ? 1 : 0 ) ) * detlength );
+   double ** whichpointers = new double*[ 2 ];
+   double ** detpointers   = new double*[ 2 ];
+   detpointers[ 0 ] = new double[ detlength ];
+   detpointers[ 1 ] = new double[ detlength ];
 
-}
+   char instruction = deBoskabouter.FetchInstruction( whichpointers );
+   assert( instruction == 'A' );
+
+   // The diagonal of the Hamiltonian in the CSF basis, without the exchange couplings within a spatial configuration, as preconditioner
+   DiagHam( detpointers[ 0 ] );
+   for ( unsigned int conf = 0; conf < csf_num_conf; conf++ ){
+      const unsigned int num_pat = csf_conf_det[ conf + 1 ] - csf_conf_det[ conf ];
+      const unsigned int num_fun = csf_conf_fun[ conf + 1 ] - csf_conf_fun[ conf ];
+      const double * coeff = csf_coeff[ csf_conf_open[ conf ] ];
+      for ( unsigned int fun = 0; fun < num_fun; fun++ ){
+         double value = 0.0;
+         for ( unsigned int pat = 0; pat < num_pat; pat++ ){
+            value += coeff[ pat + num_pat * fun ] * coeff[ pat + num_pat * fun ] * detpointers[ 0 ][ csf_det[ csf_conf_det[ conf ] + pat ] ];
+         }
+         whichpointers[ 1 ][ csf_conf_fun[ conf ] + fun ] = value;
+      }
+   }
+
+   // Without initial guess, or when it has no component with spin csf_TwoS / 2, start from the CSF with the lowest diagonal element
+   if ( inoutput != NULL ){ DetToCSF( inoutput, whichpointers[ 0 ] ); }
+   if (( inoutput == NULL ) || ( FCIfrobeniusnorm( veclength, whichpointers[ 0 ] ) < 1e-8 )){
+      int lowest = 0;
+      for ( int csf = 0; csf < veclength; csf++ ){
+         whichpointers[ 0 ][ csf ] = 0.0;
+         if ( whichpointers[ 1 ][ csf ] < whichpointers[ 1 ][ lowest ] ){ lowest = csf; }
+      }
+      whichpointers[ 0 ][ lowest ] = 1.0;
+   }
+
+   instruction = deBoskabouter.FetchInstruction( whichpointers );
+   while ( instruction == 'B' ){
+      CSFtoDet( whichpointers[ 0 ], detpointers[ 0 ] );
+      DistributedMatvec( detpointers, detpointers + 1, 1 );
+      DetToCSF( detpointers[ 1 ], whichpointers[ 1 ] );
+      instruction = deBoskabouter.FetchInstruction( whichpointers );
+   }
+
+   assert( instruction == 'C' );
+   if ( inoutput != NULL ){ CSFtoDet( whichpointers[ 0 ], inoutput ); }
+   const double FCIenergy = whichpointers[ 1 ][ 0 ] + getEconst();
+   if ( FCIverbose > 1 ){ cout << "FCI::GSDavidson : Required number of matrix-vector multiplications = " << deBoskabouter.GetNumMultiplications() << endl; }
+   if ( FCIverbose > 0 ){ cout << "FCI::GSDavidson : Converged ground state energy with 2S = " << csf_TwoS << " = " << FCIenergy << endl; }
+   delete [] detpointers[ 0 ];
+   delete [] detpointers[ 1 ];
+   delete [] detpointers;
+   delete [] whichpointers;
+   return FCIenergy;
+
+}
+
+void CheMPS2::FCI::setMaxMemTotalMB(const double maxMemTotalMB_in){
+
+   maxMemTotalMB = maxMemTotalMB_in;
+
+}
+
+void CheMPS2::FCI::SetupDavidsonStorage( Davidson & solver, const unsigned int veclength, const int DVDSN_NUM_VEC, const unsigned long long num_extra ) const{
+
+   if ( maxMemTotalMB <= 0.0 ){ return; }
+
+   // Davidson keeps 2 * DVDSN_NUM_VEC subspace vectors, DAVIDSON_NUM_VEC_KEEP vectors for the deflation and 4 work vectors
+   const double subspace_MB = ( sizeof(double) * ( 2.0 * DVDSN_NUM_VEC + CheMPS2::DAVIDSON_NUM_VEC_KEEP ) * veclength ) / 1048576;
+   const double others_MB   = ( sizeof(double) * ( 4.0 * veclength + num_extra + 2.0 * HXVsizeWorkspace + L * L * L * L + L * L ) ) / 1048576;
+   if ( subspace_MB + others_MB <= maxMemTotalMB ){ return; }
+
+   std::stringstream filename;
+   filename << CheMPS2::defaultTMPpath << "/CheMPS2_FCI_Davidson_" << getpid() << ".bin";
+   const bool on_disk = solver.StoreVectorsOnDisk( filename.str() );
+   if ( FCIverbose > 0 ){
+      cout << "FCI::GSDavidson : The Davidson vectors ( " << subspace_MB << " MB ) and the other arrays ( " << others_MB << " MB ) exceed " << maxMemTotalMB << " MB; ";
+      if ( on_disk ){ cout << "the subspace vectors are stored in a memory-mapped file in " << CheMPS2::defaultTMPpath << "." << endl; }
+      else { cout << "WARNING : the memory-mapped file could not be created, and the subspace vectors are kept in RAM." << endl; }
+   }
+
+}
+
+void CheMPS2::FCI::DistributedMatvec( double ** input, double ** output, const int num_vec ) const{
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){ // The master process owns all blocks
+      int mpi_instruction = num_vec;
+      MPIchemps2::broadcast_array_int( &mpi_instruction, 1, MPI_CHEMPS2_MASTER );
+      int * owners = new int[ num_irreps ];
+      for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){ owners[ irrep_up ] = MPI_CHEMPS2_MASTER; }
+      BlockMatvec( input, output, num_vec, owners, irrep_center_jumps[ 0 ] );
+      delete [] owners;
+      return;
+   }
+   #endif
+
+   matvec( input, output, num_vec );
+
+}
+
+#ifdef CHEMPS2_MPI_COMPILATION
+void CheMPS2::FCI::DistributedMatvecHelp() const{
+
+   // The helpers own no blocks: they only hold the blocks which their work units need during BlockMatvec
+   int * owners = new int[ num_irreps ];
+   unsigned int * jumps = new unsigned int[ num_irreps + 1 ];
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){ owners[ irrep_up ] = MPI_CHEMPS2_MASTER; }
+   SegmentJumps( owners, MPIchemps2::mpi_rank(), jumps );
+
+   int num_vec = 0;
+   MPIchemps2::broadcast_array_int( &num_vec, 1, MPI_CHEMPS2_MASTER );
+   while ( num_vec > 0 ){ // Mat Vec with num_vec vectors
+      double ** vecin  = new double*[ num_vec ];
+      double ** vecout = new double*[ num_vec ];
+      for ( int vec = 0; vec < num_vec; vec++ ){
+         vecin [ vec ] = NULL;
+         vecout[ vec ] = NULL;
+      }
+      BlockMatvec( vecin, vecout, num_vec, owners, jumps );
+      delete [] vecin;
+      delete [] vecout;
+      MPIchemps2::broadcast_array_int( &num_vec, 1, MPI_CHEMPS2_MASTER );
+   }
+
+   delete [] owners;
+   delete [] jumps;
+
+}
+
+void CheMPS2::FCI::MatvecNeededBlocks( const unsigned int num_vec, const int rank, bool * needed ) const{
+
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){ needed[ irrep_up ] = false; }
+
+   // The same work units as in matvec, which handles at most MatvecMaxVec() vectors at once and numbers the units of each batch from zero
+   const unsigned int max_vec = MatvecMaxVec();
+   for ( unsigned int first = 0; first < num_vec; first += max_vec ){
+      const unsigned int batch = std::min( max_vec, num_vec - first );
+      int work_unit = 0;
+      for ( unsigned int irrep_center = 0; irrep_center < num_irreps; irrep_center++ ){
+         const int irrep_target_center = Irreps::directProd( TargetIrrep, irrep_center );
+         const unsigned int num_pairs  = irrep_center_num[ irrep_center ];
+         for ( unsigned int irrep_center_up = 0; irrep_center_up < num_irreps; irrep_center_up++ ){
+            const int irrep_center_down = Irreps::directProd( irrep_target_center, irrep_center_up );
+            const unsigned int dim_center_up   = numPerIrrep_up  [ irrep_center_up   ];
+            const unsigned int dim_center_down = numPerIrrep_down[ irrep_center_down ];
+            if ( dim_center_up * dim_center_down > 0 ){
+               const unsigned int blocksize_beta = HXVsizeWorkspace / std::max( (unsigned int) 1, dim_center_up * num_pairs * batch );
+               unsigned int num_block_beta = dim_center_down / blocksize_beta;
+               while ( blocksize_beta * num_block_beta < dim_center_down ){ num_block_beta++; }
+               for ( unsigned int block = 0; block < num_block_beta; block++ ){
+                  const unsigned int start_center_down = block * blocksize_beta;
+                  const unsigned int  stop_center_down = std::min( ( block + 1 ) * blocksize_beta, dim_center_down );
+                  if (( stop_center_down > start_center_down ) && ( MPIchemps2::owner_fci_unit( work_unit ) == rank )){
+                     // E_{ij} with I_i x I_j = irrep_center connects the blocks irrep_center_up and irrep_center x irrep_center_up
+                     needed[ irrep_center_up ] = true;
+                     needed[ Irreps::directProd( irrep_center, irrep_center_up ) ] = true;
+                  }
+                  work_unit++;
+               }
+            }
+         }
+      }
+   }
+
+}
+
+unsigned int CheMPS2::FCI::SegmentJumps( const int * owners, const int rank, unsigned int * jumps ) const{
+
+   const unsigned int * zero_jumps = irrep_center_jumps[ 0 ];
+   jumps[ 0 ] = 0;
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      jumps[ irrep_up + 1 ] = jumps[ irrep_up ] + (( owners[ irrep_up ] == rank ) ? zero_jumps[ irrep_up + 1 ] - zero_jumps[ irrep_up ] : 0 );
+   }
+   return jumps[ num_irreps ];
+
+}
+
+void CheMPS2::FCI::BlockMatvec( double ** input, double ** output, const int num_vec, const int * owners, const unsigned int * jumps ) const{
+
+   const int num_procs = MPIchemps2::mpi_size();
+   const int MPIRANK   = MPIchemps2::mpi_rank();
+   const unsigned int * zero_jumps = irrep_center_jumps[ 0 ];
+
+   // The blocks which the work units of each process read and write
+   bool * needed = new bool[ num_irreps * num_procs ];
+   for ( int rank = 0; rank < num_procs; rank++ ){ MatvecNeededBlocks( num_vec, rank, needed + num_irreps * rank ); }
+
+   // The needed blocks of this process are stored consecutively; if they are exactly the owned blocks, matvec works on input and output directly
+   unsigned int * work_jumps = new unsigned int[ num_irreps + 1 ];
+   work_jumps[ 0 ] = 0;
+   bool in_place = true;
+   unsigned int max_block = 0;
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      const unsigned int size = zero_jumps[ irrep_up + 1 ] - zero_jumps[ irrep_up ];
+      work_jumps[ irrep_up + 1 ] = work_jumps[ irrep_up ] + (( needed[ irrep_up + num_irreps * MPIRANK ] ) ? size : 0 );
+      if ( work_jumps[ irrep_up + 1 ] != jumps[ irrep_up + 1 ] ){ in_place = false; }
+      max_block = std::max( max_block, size );
+   }
+   double ** work_in  = input;
+   double ** work_out = output;
+   if ( !in_place ){
+      work_in  = new double*[ num_vec ];
+      work_out = new double*[ num_vec ];
+      for ( int vec = 0; vec < num_vec; vec++ ){
+         work_in [ vec ] = new double[ work_jumps[ num_irreps ] ];
+         work_out[ vec ] = new double[ work_jumps[ num_irreps ] ];
+      }
+   }
+
+   /* The point-to-point messages follow the same global order ( block, process, vector ) on all processes, so that the blocking
+      sends and receives cannot deadlock; MPI keeps the order of the messages between two processes with the same tag */
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      const int size  = zero_jumps[ irrep_up + 1 ] - zero_jumps[ irrep_up ];
+      const int owner = owners[ irrep_up ];
+      for ( int rank = 0; rank < num_procs; rank++ ){
+         if (( size > 0 ) && ( needed[ irrep_up + num_irreps * rank ] )){
+            for ( int vec = 0; vec < num_vec; vec++ ){
+               if ( rank == owner ){
+                  if (( rank == MPIRANK ) && ( !in_place )){ FCIdcopy( size, input[ vec ] + jumps[ irrep_up ], work_in[ vec ] + work_jumps[ irrep_up ] ); }
+               } else {
+                  if ( MPIRANK == owner ){ MPIchemps2::sendreceive_array_double( input  [ vec ] +      jumps[ irrep_up ], size, owner, rank, irrep_up ); }
+                  if ( MPIRANK == rank  ){ MPIchemps2::sendreceive_array_double( work_in[ vec ] + work_jumps[ irrep_up ], size, owner, rank, irrep_up ); }
+               }
+            }
+         }
+      }
+   }
+
+   matvec( work_in, work_out, num_vec, true, work_jumps );
+
+   // The owner of each block adds the parts of the other processes which wrote to it
+   double * received = NULL;
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      const int size  = zero_jumps[ irrep_up + 1 ] - zero_jumps[ irrep_up ];
+      const int owner = owners[ irrep_up ];
+      if ( size > 0 ){
+         for ( int vec = 0; vec < num_vec; vec++ ){
+            if ( MPIRANK == owner ){
+               double * target = output[ vec ] + jumps[ irrep_up ];
+               if ( !needed[ irrep_up + num_irreps * owner ] ){ ClearVector( size, target ); }
+               else if ( !in_place ){ FCIdcopy( size, work_out[ vec ] + work_jumps[ irrep_up ], target ); }
+            }
+            for ( int rank = 0; rank < num_procs; rank++ ){
+               if (( rank != owner ) && ( needed[ irrep_up + num_irreps * rank ] )){
+                  if ( MPIRANK == rank ){ MPIchemps2::sendreceive_array_double( work_out[ vec ] + work_jumps[ irrep_up ], size, rank, owner, irrep_up ); }
+                  if ( MPIRANK == owner ){
+                     if ( received == NULL ){ received = new double[ max_block ]; }
+                     MPIchemps2::sendreceive_array_double( received, size, rank, owner, irrep_up );
+                     FCIdaxpy( size, 1.0, received, output[ vec ] + jumps[ irrep_up ] );
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   if ( received != NULL ){ delete [] received; }
+   if ( !in_place ){
+      for ( int vec = 0; vec < num_vec; vec++ ){
+         delete [] work_in [ vec ];
+         delete [] work_out[ vec ];
+      }
+      delete [] work_in;
+      delete [] work_out;
+   }
+   delete [] work_jumps;
+   delete [] needed;
+
+}
+
+void CheMPS2::FCI::ScatterGatherBlocks( double * full, double * segment, const unsigned int * jumps, const bool scatter ) const{
+
+   const int MPIRANK = MPIchemps2::mpi_rank();
+   const unsigned int * zero_jumps = irrep_center_jumps[ 0 ];
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      const int size  = zero_jumps[ irrep_up + 1 ] - zero_jumps[ irrep_up ];
+      const int owner = mpi_block_owner[ irrep_up ];
+      if ( size > 0 ){
+         if ( owner == MPI_CHEMPS2_MASTER ){
+            if ( MPIRANK == MPI_CHEMPS2_MASTER ){
+               if ( scatter ){ FCIdcopy( size, full + zero_jumps[ irrep_up ], segment + jumps[ irrep_up ] ); }
+               else          { FCIdcopy( size, segment + jumps[ irrep_up ], full + zero_jumps[ irrep_up ] ); }
+            }
+         } else {
+            const int sender   = (( scatter ) ? MPI_CHEMPS2_MASTER : owner );
+            const int receiver = (( scatter ) ? owner : MPI_CHEMPS2_MASTER );
+            if ( MPIRANK == MPI_CHEMPS2_MASTER ){ MPIchemps2::sendreceive_array_double( full + zero_jumps[ irrep_up ], size, sender, receiver, irrep_up ); }
+            if ( MPIRANK == owner ){ MPIchemps2::sendreceive_array_double( segment + jumps[ irrep_up ], size, sender, receiver, irrep_up ); }
+         }
+      }
+   }
+
+}
+#endif
+
+double CheMPS2::FCI::MultiRootDavidson(const int num_roots, double ** vectors, double * energies, const bool use_guess, const double spin_penalty, const int DVDSN_NUM_VEC) const{
+
+   int veclength = getVecLength( 0 ); // Checked "assert( max_integer >= maxVecLength );" at FCI::StartupIrrepCenter()
+   assert( num_roots >= 1 );
+   assert( num_roots <= veclength );
+   const int num_keep = std::min( veclength, num_roots + CheMPS2::DAVIDSON_NUM_VEC_KEEP );
+   const int max_vec  = std::min( veclength, std::max( DVDSN_NUM_VEC, num_keep + num_roots ) );
+   const double spin  = fabs( 0.5 * Nel_up - 0.5 * Nel_down ); // Be careful with subtracting unsigned integers...
+   const double spin_shift = spin_penalty * spin * ( spin + 1.0 );
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if (( mpi_distributed ) && ( MPIchemps2::mpi_rank() != MPI_CHEMPS2_MASTER )){
+      DistributedMatvecHelp();
+      MPIchemps2::broadcast_array_double( energies, num_roots, MPI_CHEMPS2_MASTER );
+      return energies[ 0 ];
+   }
+   #endif
+
+   struct timeval start, end;
+   gettimeofday( &start, NULL );
+
+   double * space     = new double[ ( ( size_t ) veclength ) * max_vec ];  // Orthonormal basis V
+   double * hspace    = new double[ ( ( size_t ) veclength ) * max_vec ];  // H V
+   double * restart   = new double[ ( ( size_t ) veclength ) * num_keep ];
+   double * diag      = new double[ veclength ];
+   double * spin_work = (( spin_penalty > 0.0 ) ? new double[ veclength ] : NULL );
+   double * hsub      = new double[ max_vec * max_vec ]; // V^T H V with leading dimension max_vec
+   double * evecs     = new double[ max_vec * max_vec ]; // Eigenvectors of V^T H V with leading dimension num
+   double * evals     = new double[ max_vec ];
+   double * coeff     = new double[ max_vec ];
+   int lwork = 3 * max_vec;
+   double * dsyev_work = new double[ lwork ];
+   double ** new_vecs  = new double*[ num_roots ];
+   double ** new_hvecs = new double*[ num_roots ];
+   DiagHam( diag );
+
+   // The initial guesses are the first candidates
+   for ( int root = 0; root < num_roots; root++ ){
+      double * guess = space + ( ( size_t ) veclength ) * root;
+      if ( use_guess ){
+         FCIdcopy( veclength, vectors[ root ], guess );
+      } else { // The determinant with the lowest diagonal element which has not been used yet
+         int lowest = -1;
+         for ( int counter = 0; counter < veclength; counter++ ){
+            bool used = false;
+            for ( int previous = 0; previous < root; previous++ ){
+               if ( space[ ( ( size_t ) veclength ) * previous + counter ] != 0.0 ){ used = true; }
+            }
+            if (( !used ) && (( lowest == -1 ) || ( diag[ counter ] < diag[ lowest ] ))){ lowest = counter; }
+         }
+         ClearVector( veclength, guess );
+         guess[ lowest ] = 1.0;
+      }
+   }
+
+   int num = 0;
+   int num_new = num_roots;
+   int num_matvec = 0;
+   while ( true ){
+
+      // Orthonormalize the candidates against the basis and each other, twice for stability
+      int num_added = 0;
+      for ( int cand = 0; cand < num_new; cand++ ){
+         double * vec = space + ( ( size_t ) veclength ) * ( num + cand );
+         const double norm_before = FCIfrobeniusnorm( veclength, vec );
+         int num_prev = num + num_added;
+         if (( norm_before > 0.0 ) && ( num_prev > 0 )){
+            char trans   = 'T';
+            char notrans = 'N';
+            int inc = 1;
+            double one = 1.0;
+            double minus_one = -1.0;
+            double set = 0.0;
+            for ( int pass = 0; pass < 2; pass++ ){
+               dgemv_( &trans,   &veclength, &num_prev, &one,       space, &veclength, vec,   &inc, &set, coeff, &inc );
+               dgemv_( &notrans, &veclength, &num_prev, &minus_one, space, &veclength, coeff, &inc, &one, vec,   &inc );
+            }
+         }
+         const double norm = FCIfrobeniusnorm( veclength, vec );
+         if (( norm_before > 0.0 ) && ( norm > 1e-6 * norm_before )){
+            double * target = space + ( ( size_t ) veclength ) * ( num + num_added );
+            if ( target != vec ){ FCIdcopy( veclength, vec, target ); }
+            FCIdscal( veclength, 1.0 / norm, target );
+            num_added++;
+         }
+      }
+      if ( num_added == 0 ){ break; } // The basis cannot be extended anymore
+
+      // Multiply all new basis vectors with the Hamiltonian at once
+      for ( int cnt = 0; cnt < num_added; cnt++ ){
+         new_vecs [ cnt ] =  space + ( ( size_t ) veclength ) * ( num + cnt );
+         new_hvecs[ cnt ] = hspace + ( ( size_t ) veclength ) * ( num + cnt );
+      }
+      DistributedMatvec( new_vecs, new_hvecs, num_added );
+      if ( spin_penalty > 0.0 ){
+         for ( int cnt = 0; cnt < num_added; cnt++ ){
+            ActWithSpinSquared( spin_work, new_vecs[ cnt ] );
+            FCIdaxpy( veclength,  spin_penalty, spin_work,       new_hvecs[ cnt ] );
+            FCIdaxpy( veclength, -spin_shift,   new_vecs[ cnt ], new_hvecs[ cnt ] );
+         }
+      }
+      num_matvec += num_added;
+
+      // Add the new columns to V^T H V
+      {
+         char trans   = 'T';
+         char notrans = 'N';
+         int mdim = num + num_added;
+         int ndim = num_added;
+         int ldc  = max_vec;
+         double one = 1.0;
+         double set = 0.0;
+         dgemm_( &trans, &notrans, &mdim, &ndim, &veclength, &one, space, &veclength, hspace + ( ( size_t ) veclength ) * num, &veclength, &set, hsub + max_vec * num, &ldc );
+      }
+      for ( int col = num; col < num + num_added; col++ ){
+         for ( int row = 0; row < col; row++ ){
+            const double value = (( row < num ) ? hsub[ row + max_vec * col ] : 0.5 * ( hsub[ row + max_vec * col ] + hsub[ col + max_vec * row ] ));
+            hsub[ row + max_vec * col ] = value;
+            hsub[ col + max_vec * row ] = value;
+         }
+      }
+      num += num_added;
+
+      // Rayleigh-Ritz
+      for ( int col = 0; col < num; col++ ){
+         for ( int row = 0; row < num; row++ ){ evecs[ row + num * col ] = hsub[ row + max_vec * col ]; }
+      }
+      {
+         char jobz = 'V';
+         char uplo = 'U';
+         int info;
+         dsyev_( &jobz, &uplo, &num, evecs, &num, evals, dsyev_work, &lwork, &info );
+         assert( info == 0 );
+      }
+
+      // Restart with the lowest num_keep Ritz vectors when there is no room for num_roots new vectors
+      if ( num + num_roots > max_vec ){
+         char notrans = 'N';
+         int ldu = num;
+         double one = 1.0;
+         double set = 0.0;
+         int kept = std::min( num_keep, num );
+         dgemm_( &notrans, &notrans, &veclength, &kept, &num, &one,  space, &veclength, evecs, &ldu, &set, restart, &veclength );
+         FCIdcopy( veclength * kept, restart,  space );
+         dgemm_( &notrans, &notrans, &veclength, &kept, &num, &one, hspace, &veclength, evecs, &ldu, &set, restart, &veclength );
+         FCIdcopy( veclength * kept, restart, hspace );
+         num = kept;
+         for ( int col = 0; col < num; col++ ){
+            for ( int row = 0; row < num; row++ ){
+               hsub [ row + max_vec * col ] = (( row == col ) ? evals[ row ] : 0.0 );
+               evecs[ row + num     * col ] = (( row == col ) ? 1.0 : 0.0 );
+            }
+         }
+      }
+
+      // Preconditioned residuals of the unconverged roots are the new candidates
+      num_new = 0;
+      for ( int root = 0; root < std::min( num_roots, num ); root++ ){
+         double * residual = space + ( ( size_t ) veclength ) * ( num + num_new );
+         char notrans = 'N';
+         int inc = 1;
+         double one = 1.0;
+         double set = 0.0;
+         double min_eig = -evals[ root ];
+         dgemv_( &notrans, &veclength, &num, &one,     hspace, &veclength, evecs + num * root, &inc, &set, residual, &inc );
+         dgemv_( &notrans, &veclength, &num, &min_eig,  space, &veclength, evecs + num * root, &inc, &one, residual, &inc );
+         const double rnorm = FCIfrobeniusnorm( veclength, residual );
+         if ( rnorm > CheMPS2::DAVIDSON_FCI_RTOL ){
+            for ( int counter = 0; counter < veclength; counter++ ){
+               const double denom = diag[ counter ] - evals[ root ];
+               residual[ counter ] = residual[ counter ] / (( fabs( denom ) > CheMPS2::DAVIDSON_PRECOND_CUTOFF ) ? denom : CheMPS2::DAVIDSON_PRECOND_CUTOFF );
+            }
+            num_new++;
+         }
+      }
+      if ( num_new == 0 ){ break; }
+
+   }
+
+   // Copy the Ritz vectors to the output
+   assert( num >= num_roots );
+   for ( int root = 0; root < num_roots; root++ ){
+      char notrans = 'N';
+      int inc = 1;
+      double one = 1.0;
+      double set = 0.0;
+      dgemv_( &notrans, &veclength, &num, &one, space, &veclength, evecs + num * root, &inc, &set, vectors[ root ], &inc );
+      energies[ root ] = evals[ root ] + getEconst();
+   }
+
+   delete [] space;
+   delete [] hspace;
+   delete [] restart;
+   delete [] diag;
+   if ( spin_work != NULL ){ delete [] spin_work; }
+   delete [] hsub;
+   delete [] evecs;
+   delete [] evals;
+   delete [] coeff;
+   delete [] dsyev_work;
+   delete [] new_vecs;
+   delete [] new_hvecs;
+   #ifdef CHEMPS2_MPI_COMPILATION
+   if ( mpi_distributed ){
+      int mpi_instruction = 0; // Stop the helpers
+      MPIchemps2::broadcast_array_int( &mpi_instruction, 1, MPI_CHEMPS2_MASTER );
+      MPIchemps2::broadcast_array_double( energies, num_roots, MPI_CHEMPS2_MASTER );
+   }
+   #endif
+
+   gettimeofday( &end, NULL );
+   const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+   if ( FCIverbose > 1 ){ cout << "FCI::MultiRootDavidson : Required number of matrix-vector multiplications = " << num_matvec << endl; }
+   if ( FCIverbose > 1 ){ cout << "FCI::MultiRootDavidson : Wall time = " << elapsed << " seconds" << endl; }
+   if ( FCIverbose > 0 ){
+      for ( int root = 0; root < num_roots; root++ ){
+         cout << "FCI::MultiRootDavidson : Converged energy of root " << root << " = " << energies[ root ] << endl;
+      }
+   }
+   return energies[ 0 ];
+
+}
+
+/*********************************************************************************
+ *                                                                               *
+ *   Below this block all functions are for the Green's function calculations.   *
+ *                                                                               *
+ *********************************************************************************/
+
+void CheMPS2::FCI::ActWithNumberOperator(const unsigned int orbIndex, double * resultVector, double * sourceVector) const{
+
+   assert( orbIndex<L );
+
+   int * bits_up    = new int[ L ];
+   int * bits_down  = new int[ L ];
+
+   const unsigned int vecLength = getVecLength( 0 );
+   for (unsigned int counter = 0; counter < vecLength; counter++){
+      getBitsOfCounter( 0 , counter , bits_up , bits_down );
+      resultVector[ counter ] = ( bits_up[ orbIndex ] + bits_down[ orbIndex ] ) * sourceVector[ counter ];
+   }
+   
+   delete [] bits_up;
+   delete [] bits_down;
+
+}
+
+void CheMPS2::FCI::ActWithSpinSquared(double * resultVector, double * sourceVector) const{
+
+   // Same terms as in CalcSpinSquared, which is < sourceVector | resultVector >
+   const unsigned int vecLength = getVecLength( 0 );
+
+   #pragma omp parallel for schedule(static)
+   for ( unsigned int counter = 0; counter < vecLength; counter++ ){
+
+      const int irrep_up   = getUpIrrepOfCounter( 0 , counter );
+      const int irrep_down = Irreps::directProd( irrep_up , TargetIrrep );
+      const int count_up   = ( counter - irrep_center_jumps[ 0 ][ irrep_up ] ) % numPerIrrep_up[ irrep_up ];
+      const int count_down = ( counter - irrep_center_jumps[ 0 ][ irrep_up ] ) / numPerIrrep_up[ irrep_up ];
+      const unsigned int string_up   = cnt2str_up  [ irrep_up   ][ count_up   ];
+      const unsigned int string_down = cnt2str_down[ irrep_down ][ count_down ];
+      double diagonal = 0.0;
+      double result   = 0.0;
+
+      for ( unsigned int orbi = 0; orbi < L; orbi++ ){
+
+         const int diff_ii = (int)(( string_up >> orbi ) & 1U ) - (int)(( string_down >> orbi ) & 1U ); //Signed integers so subtracting is OK
+         diagonal += 0.75 * diff_ii * diff_ii;
+
+         for ( unsigned int orbj = orbi+1; orbj < L; orbj++ ){
+
+            const int diff_jj = (int)(( string_up >> orbj ) & 1U ) - (int)(( string_down >> orbj ) & 1U ); //Signed integers so subtracting is OK
+            diagonal += 0.5 * diff_ii * diff_jj;
+
+            const int irrep_excitation = Irreps::directProd( getOrb2Irrep( orbi ) , getOrb2Irrep( orbj ) );
+            const int irrep_up_bis     = Irreps::directProd( irrep_up   , irrep_excitation );
+            const int irrep_down_bis   = Irreps::directProd( irrep_down , irrep_excitation );
+            unsigned int string_up_bis, string_down_bis;
+
+            const int sign_down_ji  = excite_string( string_down, orbj, orbi, string_down_bis );
+            const int sign_product1 = (( sign_down_ji == 0 ) ? 0 : sign_down_ji * excite_string( string_up, orbi, orbj, string_up_bis ));
+            if ( sign_product1 != 0 ){
+               const int cnt_down_ji = str2cnt_down[ irrep_down_bis ][ string_down_bis ];
+               const int cnt_up_ij   = str2cnt_up  [ irrep_up_bis   ][ string_up_bis   ];
+               result -= sign_product1 * sourceVector[ irrep_center_jumps[ 0 ][ irrep_up_bis ] + cnt_up_ij + numPerIrrep_up[ irrep_up_bis ] * cnt_down_ji ];
+            }
+
+            const int sign_down_ij  = excite_string( string_down, orbi, orbj, string_down_bis );
+            const int sign_product2 = (( sign_down_ij == 0 ) ? 0 : sign_down_ij * excite_string( string_up, orbj, orbi, string_up_bis ));
+            if ( sign_product2 != 0 ){
+               const int cnt_down_ij = str2cnt_down[ irrep_down_bis ][ string_down_bis ];
+               const int cnt_up_ji   = str2cnt_up  [ irrep_up_bis   ][ string_up_bis   ];
+               result -= sign_product2 * sourceVector[ irrep_center_jumps[ 0 ][ irrep_up_bis ] + cnt_up_ji + numPerIrrep_up[ irrep_up_bis ] * cnt_down_ij ];
+            }
+
+         }
+      }
+      resultVector[ counter ] = result + diagonal * sourceVector[ counter ];
+   }
+
+}
+
+void CheMPS2::FCI::ActWithSecondQuantizedOperator(const char whichOperator, const bool isUp, const unsigned int orbIndex, double * thisVector, const FCI * otherFCI, double * otherVector) const{
+
+   assert( ( whichOperator=='C' ) || ( whichOperator=='A' ) ); //Operator should be a (C) Creator, or (A) Annihilator
+   assert( orbIndex<L  );
+   assert( L==otherFCI->getL() );
+
+   const unsigned int vecLength = getVecLength( 0 );
+
+   if ( getTargetIrrep() != Irreps::directProd( otherFCI->getTargetIrrep() , getOrb2Irrep( orbIndex ) )){
+      ClearVector( vecLength , thisVector );
+      return;
+   }
+
+   int * bits_up    = new int[ L ];
+   int * bits_down  = new int[ L ];
+   
+   if (( whichOperator=='C') && ( isUp )){
+      for (unsigned int counter = 0; counter < vecLength; counter++){
+         
+         getBitsOfCounter( 0 , counter , bits_up , bits_down );
+         
+         if ( bits_up[ orbIndex ] == 1 ){ // Operator = creator_up
+            bits_up[ orbIndex ] = 0;
+            int phase = 1;
+            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_up[ cnt ] ){ phase *= -1; } }
+            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
+         } else {
+            thisVector[ counter ] = 0.0;
+         }
+         
+      }
+   }
+   
+   if (( whichOperator=='C') && ( !(isUp) )){
+      const int startphase = (( Nel_up % 2 ) == 0) ? 1 : -1;
+      for (unsigned int counter = 0; counter < vecLength; counter++){
+
+         getBitsOfCounter( 0 , counter , bits_up , bits_down );
+
+         if ( bits_down[ orbIndex ] == 1 ){ // Operator = creator_down
+            bits_down[ orbIndex ] = 0;
+            int phase = startphase;
+            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_down[ cnt ] ){ phase *= -1; } }
+            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
+         } else {
+            thisVector[ counter ] = 0.0;
+         }
+
+      }
+   }
+   
+   if (( whichOperator=='A') && ( isUp )){
+      for (unsigned int counter = 0; counter < vecLength; counter++){
+
+         getBitsOfCounter( 0 , counter , bits_up , bits_down );
+         
+         if ( bits_up[ orbIndex ] == 0 ){ // Operator = annihilator_up
+            bits_up[ orbIndex ] = 1;
+            int phase = 1;
+            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_up[ cnt ] ){ phase *= -1; } }
+            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
+         } else {
+            thisVector[ counter ] = 0.0;
+         }
+
+      }
+   }
+   
+   if (( whichOperator=='A') && ( !(isUp) )){
+      const int startphase = (( Nel_up % 2 ) == 0) ? 1 : -1;
+      for (unsigned int counter = 0; counter < vecLength; counter++){
+
+         getBitsOfCounter( 0 , counter , bits_up , bits_down );
+         
+         if ( bits_down[ orbIndex ] == 0 ){ // Operator = annihilator_down
+            bits_down[ orbIndex ] = 1;
+            int phase = startphase;
+            for (unsigned int cnt = 0; cnt < orbIndex; cnt++){ if ( bits_down[ cnt ] ){ phase *= -1; } }
+            thisVector[ counter ] = phase * otherFCI->getFCIcoeff( bits_up , bits_down , otherVector );
+         } else {
+            thisVector[ counter ] = 0.0;
+         }
+         
+      }
+   }
+   
+   delete [] bits_up;
+   delete [] bits_down;
+
+}
+
+void CheMPS2::FCI::CGSolveSystem(const double alpha, const double beta, const double eta, double * RHS, double * RealSol, double * ImagSol, const bool checkError) const{
+
+   CGSolveSystems( alpha, beta, eta, 1, &RHS, &RealSol, &ImagSol, checkError );
+
+}
+
+void CheMPS2::FCI::CGSolveSystems(const double alpha, const double beta, const double eta, const unsigned int num_rhs, double ** RHS, double ** RealSol, double ** ImagSol, const bool checkError) const{
+
+   assert( RealSol != NULL );
+   assert( ImagSol != NULL );
+   assert( fabs( eta ) > 0.0 );
+
+   const unsigned int vecLength = getVecLength( 0 );
+   const unsigned long long size = vecLength;
+
+   /* 
+         ( alpha + beta H + I eta ) Solution = RHS
+
+      is solved with the conjugate gradient (CG) method. Solution = RealSol + I * ImagSol.
+      CG requires a symmetric positive definite operator. Therefore:
+
+         [ ( alpha + beta H )^2 + eta^2 ] * Solution = ( alpha + beta H - I eta ) * RHS
+
+      Clue: Solve for ImagSol first. RealSol is then simply
+
+         RealSol = - ( alpha + beta H ) / eta * ImagSol
+
+      All right-hand sides are solved together with block CG [D.P. O'Leary, Linear Algebra and its Applications 29, 293-322 (1980)],
+      in the breakdown-free form where the block of search directions is orthonormalized and numerically dependent directions are
+      dropped [H. Ji and Y. Li, BIT Numerical Mathematics 57, 379-403 (2017)]. With operator A, solution X and residual R = B - A X:
+
+         alpha_blk = ( P^T A P )^{-1} P^T R        X += P alpha_blk        R -= A P alpha_blk
+         beta_blk  = ( P^T A P )^{-1} ( A P )^T R  P  = orth( R - P beta_blk )
+
+      Right-hand sides whose residual norm is below CONJ_GRADIENT_RTOL no longer contribute search directions, but their solutions
+      are still updated. As in ConjugateGradient, the operator is symmetrically preconditioned with its diagonal.
+   */
+
+   // Calculate the diagonal of the CG operator and the preconditioner 1 / sqrt( diag )
+   double * xvec   = new double[ size * num_rhs ]; // Preconditioned solutions
+   double * resid  = new double[ size * num_rhs ]; // Preconditioned residuals
+   double * search = new double[ size * num_rhs ]; // Orthonormal search directions P
+   double * opvec  = new double[ size * num_rhs ]; // A P
+   double * work   = new double[ size * num_rhs ];
+   double * temp   = new double[ size * num_rhs ];
+   double * precon = new double[ vecLength ];
+   CGdiagonal( alpha, beta, eta, precon, work );
+   for ( unsigned int cnt = 0; cnt < vecLength; cnt++ ){ precon[ cnt ] = 1.0 / sqrt( std::max( precon[ cnt ], CheMPS2::CONJ_GRADIENT_PRECOND_CUTOFF ) ); }
+
+   double ** ptr_work = new double*[ num_rhs ];
+   double ** ptr_temp = new double*[ num_rhs ];
+   double ** ptr_op   = new double*[ num_rhs ];
+   for ( unsigned int rhs = 0; rhs < num_rhs; rhs++ ){
+      ptr_work[ rhs ] = work  + size * rhs;
+      ptr_temp[ rhs ] = temp  + size * rhs;
+      ptr_op  [ rhs ] = opvec + size * rhs;
+   }
+
+   double * PtAP       = new double[ num_rhs * num_rhs ];
+   double * coeff      = new double[ num_rhs * num_rhs ];
+   unsigned int * open = new unsigned int[ num_rhs ];
+   const unsigned int max_iter = 2 * vecLength + 10; // In exact arithmetic, block CG converges in at most vecLength iterations
+   double RMSerror = 0.0;
+
+   for ( int part = 0; part < 2; part++ ){ // part 0 solves for ImagSol, part 1 for RealSol
+
+      // work = initial guess and resid = right-hand side of the problem, both without preconditioner
+      if ( part == 0 ){
+         for ( unsigned int rhs = 0; rhs < num_rhs; rhs++ ){
+            for ( unsigned int cnt = 0; cnt < vecLength; cnt++ ){
+               resid[ cnt + size * rhs ] = - eta * RHS[ rhs ][ cnt ];
+               work [ cnt + size * rhs ] = - eta * RHS[ rhs ][ cnt ] * precon[ cnt ] * precon[ cnt ];
+            }
+         }
+      } else {
+         double ** ptr_resid = new double*[ num_rhs ];
+         for ( unsigned int rhs = 0; rhs < num_rhs; rhs++ ){ ptr_resid[ rhs ] = resid + size * rhs; }
+         CGAlphaPlusBetaHAM( - alpha / eta, - beta / eta, num_rhs, ImagSol, ptr_work ); // Initial guess real part can be obtained from the imaginary part
+         CGAlphaPlusBetaHAM( alpha, beta, num_rhs, RHS, ptr_resid );                    // RHS of the problem
+         delete [] ptr_resid;
+      }
+
+      // Preconditioned variables: xvec = work / precon and resid = precon * ( RHS - A * work )
+      CGoperator( alpha, beta, eta, num_rhs, ptr_work, ptr_temp, ptr_op );
+      for ( unsigned int rhs = 0; rhs < num_rhs; rhs++ ){
+         for ( unsigned int cnt = 0; cnt < vecLength; cnt++ ){
+            xvec [ cnt + size * rhs ] = work[ cnt + size * rhs ] / precon[ cnt ];
+            resid[ cnt + size * rhs ] = precon[ cnt ] * ( resid[ cnt + size * rhs ] - opvec[ cnt + size * rhs ] );
+         }
+      }
+
+      unsigned int num_search = 0;
+      unsigned int num_iter = 0;
+      bool restart = true;
+      while ( num_iter < max_iter ){
+
+         // Right-hand sides which have not converged yet
+         unsigned int num_open = 0;
+         for ( unsigned int rhs = 0; rhs < num_rhs; rhs++ ){
+            if ( FCIfrobeniusnorm( vecLength, resid + size * rhs ) >= CheMPS2::CONJ_GRADIENT_RTOL ){ open[ num_open ] = rhs; num_open++; }
+         }
+         if ( num_open == 0 ){ break; }
+
+         if ( restart ){ // ( Re )start from the residuals of the open right-hand sides
+            for ( unsigned int col = 0; col < num_open; col++ ){ FCIdcopy( vecLength, resid + size * open[ col ], work + size * col ); }
+            num_search = FCIorthonormalize( vecLength, num_open, work, search );
+            restart = false;
+            if ( num_search == 0 ){ break; }
+         }
+
+         // opvec = precon * A * precon * search
+         for ( unsigned int col = 0; col < num_search; col++ ){
+            for ( unsigned int cnt = 0; cnt < vecLength; cnt++ ){ work[ cnt + size * col ] = precon[ cnt ] * search[ cnt + size * col ]; }
+         }
+         CGoperator( alpha, beta, eta, num_search, ptr_work, ptr_temp, ptr_op );
+         for ( unsigned int col = 0; col < num_search; col++ ){
+            for ( unsigned int cnt = 0; cnt < vecLength; cnt++ ){ opvec[ cnt + size * col ] *= precon[ cnt ]; }
+         }
+         num_iter++;
+
+         // PtAP = P^T A P = U^T U
+         char trans = 'T';
+         char notrans = 'N';
+         char uplo = 'U';
+         int dim_vec = vecLength;
+         int dim_srch = num_search;
+         int dim_rhs = num_rhs;
+         double one = 1.0;
+         double minus_one = -1.0;
+         double zero = 0.0;
+         int info = 0;
+         dgemm_( &trans, &notrans, &dim_srch, &dim_srch, &dim_vec, &one, search, &dim_vec, opvec, &dim_vec, &zero, PtAP, &dim_srch );
+         dpotrf_( &uplo, &dim_srch, PtAP, &dim_srch, &info );
+         if ( info != 0 ){ // A is positive definite, so this only happens when the search directions have become numerically dependent
+            restart = true;
+            continue;
+         }
+
+         // X += P ( P^T A P )^{-1} P^T R  and  R -= A P ( P^T A P )^{-1} P^T R
+         dgemm_( &trans, &notrans, &dim_srch, &dim_rhs, &dim_vec, &one, search, &dim_vec, resid, &dim_vec, &zero, coeff, &dim_srch );
+         dpotrs_( &uplo, &dim_srch, &dim_rhs, PtAP, &dim_srch, coeff, &dim_srch, &info );
+         dgemm_( &notrans, &notrans, &dim_vec, &dim_rhs, &dim_srch, &one,       search, &dim_vec, coeff, &dim_srch, &one, xvec,  &dim_vec );
+         dgemm_( &notrans, &notrans, &dim_vec, &dim_rhs, &dim_srch, &minus_one, opvec,  &dim_vec, coeff, &dim_srch, &one, resid, &dim_vec );
+
+         // The new search directions: orth( R - P ( P^T A P )^{-1} ( A P )^T R ) for the open right-hand sides
+         num_open = 0;
+         for ( unsigned int rhs = 0; rhs < num_rhs; rhs++ ){
+            if ( FCIfrobeniusnorm( vecLength, resid + size * rhs ) >= CheMPS2::CONJ_GRADIENT_RTOL ){
+               FCIdcopy( vecLength, resid + size * rhs, work + size * num_open );
+               open[ num_open ] = rhs;
+               num_open++;
+            }
+         }
+         if ( num_open == 0 ){ break; }
+         int dim_open = num_open;
+         dgemm_( &trans, &notrans, &dim_srch, &dim_open, &dim_vec, &one, opvec, &dim_vec, work, &dim_vec, &zero, coeff, &dim_srch );
+         dpotrs_( &uplo, &dim_srch, &dim_open, PtAP, &dim_srch, coeff, &dim_srch, &info );
+         dgemm_( &notrans, &notrans, &dim_vec, &dim_open, &dim_srch, &minus_one, search, &dim_vec, coeff, &dim_srch, &one, work, &dim_vec );
+         num_search = FCIorthonormalize( vecLength, num_open, work, search );
+         if ( num_search == 0 ){ restart = true; }
+
+      }
+
+      if (( FCIverbose > 1 ) && ( num_iter >= max_iter )){
+         cout << "FCI::CGSolveSystem : Block CG did not converge within " << max_iter << " iterations." << endl;
+      }
+      if ( FCIverbose > 1 ){ cout << "FCI::CGSolveSystem : Number of block CG iterations = " << num_iter << endl; }
+
+      // Remove the preconditioner from the solutions
+      for ( unsigned int rhs = 0; rhs < num_rhs; rhs++ ){
+         double * solution = (( part == 0 ) ? ImagSol[ rhs ] : RealSol[ rhs ] );
+         for ( unsigned int cnt = 0; cnt < vecLength; cnt++ ){ solution[ cnt ] = precon[ cnt ] * xvec[ cnt + size * rhs ]; }
+      }
+
+      // Residual without preconditioner: RMS of the norms of A * solution - RHS of the problem
+      if ( checkError ){
+         CGoperator( alpha, beta, eta, num_rhs, (( part == 0 ) ? ImagSol : RealSol ), ptr_temp, ptr_op );
+         if ( part == 0 ){
+            for ( unsigned int rhs = 0; rhs < num_rhs; rhs++ ){
+               for ( unsigned int cnt = 0; cnt < vecLength; cnt++ ){ work[ cnt + size * rhs ] = - eta * RHS[ rhs ][ cnt ]; }
+            }
+         } else {
+            CGAlphaPlusBetaHAM( alpha, beta, num_rhs, RHS, ptr_work );
+         }
+         for ( unsigned int rhs = 0; rhs < num_rhs; rhs++ ){
+            FCIdaxpy( vecLength, -1.0, work + size * rhs, opvec + size * rhs );
+            const double res_norm = FCIfrobeniusnorm( vecLength, opvec + size * rhs );
+            RMSerror += res_norm * res_norm;
+         }
+      }
+   }
+   RMSerror = sqrt( RMSerror );
+
+   delete [] xvec;
+   delete [] resid;
+   delete [] search;
+   delete [] opvec;
+   delete [] work;
+   delete [] temp;
+   delete [] precon;
+   delete [] ptr_work;
+   delete [] ptr_temp;
+   delete [] ptr_op;
+   delete [] PtAP;
+   delete [] coeff;
+   delete [] open;
+
+   if (( checkError ) && ( FCIverbose > 0 )){
+      cout << "FCI::CGSolveSystem : RMS error when checking the solution = " << RMSerror << endl;
+   }
+
+}
+
+void CheMPS2::FCI::CGAlphaPlusBetaHAM(const double alpha, const double beta, double * in, double * out) const{
+
+   CGAlphaPlusBetaHAM( alpha, beta, 1, &in, &out );
+
+}
+
+void CheMPS2::FCI::CGAlphaPlusBetaHAM(const double alpha, const double beta, const unsigned int num_vec, double ** in, double ** out) const{
+
+   matvec( in , out, num_vec );
+   const unsigned int vecLength = getVecLength( 0 );
+   const double prefactor = alpha + beta * getEconst(); // matvec does only the parts with second quantized operators
+   for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+      for (unsigned int cnt = 0; cnt < vecLength; cnt++){
+         out[ vec ][ cnt ] = prefactor * in[ vec ][ cnt ] + beta * out[ vec ][ cnt ]; // out = ( alpha + beta * H ) * in
+      }
+   }
+
+}
+
+void CheMPS2::FCI::CGoperator(const double alpha, const double beta, const double eta, double * in, double * temp, double * out) const{
+
+   CGoperator( alpha, beta, eta, 1, &in, &temp, &out );
+
+}
+
+void CheMPS2::FCI::CGoperator(const double alpha, const double beta, const double eta, const unsigned int num_vec, double ** in, double ** temp, double ** out) const{
+
+   const unsigned int vecLength = getVecLength( 0 );
+   CGAlphaPlusBetaHAM( alpha, beta, num_vec, in,   temp ); // temp  = ( alpha + beta * H )   * in
+   CGAlphaPlusBetaHAM( alpha, beta, num_vec, temp, out  ); // out   = ( alpha + beta * H )^2 * in
+   for ( unsigned int vec = 0; vec < num_vec; vec++ ){
+      FCIdaxpy( vecLength, eta*eta, in[ vec ], out[ vec ] ); // out   = [ ( alpha + beta * H )^2 + eta*eta ] * in
+   }
+
+}
 
 void CheMPS2::FCI::CGdiagonal(const double alpha, const double beta, const double eta, double * diagonal, double * workspace) const{
 
@@ -2239,48 +3809,75 @@ void CheMPS2::FCI::GFmatrix_addition(const double alpha, const double beta, cons
    }
    
    const bool isOK = ( isUp ) ? ( getNel_up() < L ) : ( getNel_down() < L ); // The electron can be added
-   for ( unsigned int cnt_right = 0; cnt_right < numRight; cnt_right++ ){
+   if ( !isOK ){ return; }
    
-      const int orbitalRight = orbsRight[ cnt_right ];
-      bool matchingIrrep = false;
-      for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
-         if ( getOrb2Irrep( orbsLeft[ cnt_left] ) == getOrb2Irrep( orbitalRight ) ){ matchingIrrep = true; }
+   // The right orbitals of the same irrep share the FCI space, and their linear systems are solved together
+   unsigned int * batch = new unsigned int[ numRight ];
+   for ( unsigned int irrep_right = 0; irrep_right < num_irreps; irrep_right++ ){
+   
+      unsigned int num_batch = 0;
+      for ( unsigned int cnt_right = 0; cnt_right < numRight; cnt_right++ ){
+         const int orbitalRight = orbsRight[ cnt_right ];
+         bool matchingIrrep = false;
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            if ( getOrb2Irrep( orbsLeft[ cnt_left] ) == getOrb2Irrep( orbitalRight ) ){ matchingIrrep = true; }
+         }
+         if (( matchingIrrep ) && ( getOrb2Irrep( orbitalRight ) == (int) irrep_right )){
+            batch[ num_batch ] = cnt_right;
+            num_batch++;
+         }
       }
       
-      if ( isOK && matchingIrrep ){
+      if ( num_batch > 0 ){
       
          const unsigned int addNelUP   = getNel_up()   + ((isUp) ? 1 : 0);
          const unsigned int addNelDOWN = getNel_down() + ((isUp) ? 0 : 1);
-         const int addIrrep = Irreps::directProd( getTargetIrrep(), getOrb2Irrep( orbitalRight ) );
+         const int addIrrep = Irreps::directProd( getTargetIrrep(), irrep_right );
          
          CheMPS2::FCI additionFCI( Ham, addNelUP, addNelDOWN, addIrrep, maxMemWorkMB, FCIverbose );
-         const unsigned int addVecLength = additionFCI.getVecLength( 0 );
-         double * addVector = new double[ addVecLength ];
-         additionFCI.ActWithSecondQuantizedOperator( 'C', isUp, orbitalRight, addVector, this, GSvector ); // | addVector > = a^+_right,spin | GSvector >
+         const unsigned int vecLength = additionFCI.getVecLength( 0 );
+         double ** addVectors       = new double*[ num_batch ];
+         double ** RealPartSolution = new double*[ num_batch ];
+         double ** ImagPartSolution = new double*[ num_batch ];
+         for ( unsigned int num = 0; num < num_batch; num++ ){
+            addVectors[ num ]       = new double[ vecLength ];
+            RealPartSolution[ num ] = new double[ vecLength ];
+            ImagPartSolution[ num ] = new double[ vecLength ];
+            additionFCI.ActWithSecondQuantizedOperator( 'C', isUp, orbsRight[ batch[ num ] ], addVectors[ num ], this, GSvector ); // | addVectors[ num ] > = a^+_right,spin | GSvector >
+         }
          
-         double * RealPartSolution = new double[ addVecLength ];
-         double * ImagPartSolution = new double[ addVecLength ];
-         additionFCI.CGSolveSystem( alpha, beta, eta, addVector, RealPartSolution, ImagPartSolution );
+         additionFCI.CGSolveSystems( alpha, beta, eta, num_batch, addVectors, RealPartSolution, ImagPartSolution );
          
-         if ( TwoRDMreal != NULL ){ additionFCI.Fill2RDM( RealPartSolution, TwoRDMreal[ cnt_right ] ); }
-         if ( TwoRDMimag != NULL ){ additionFCI.Fill2RDM( ImagPartSolution, TwoRDMimag[ cnt_right ] ); }
-         if ( TwoRDMadd  != NULL ){ additionFCI.Fill2RDM( addVector,         TwoRDMadd[ cnt_right ] ); }
+         for ( unsigned int num = 0; num < num_batch; num++ ){
+            if ( TwoRDMreal != NULL ){ additionFCI.Fill2RDM( RealPartSolution[ num ], TwoRDMreal[ batch[ num ] ] ); }
+            if ( TwoRDMimag != NULL ){ additionFCI.Fill2RDM( ImagPartSolution[ num ], TwoRDMimag[ batch[ num ] ] ); }
+            if ( TwoRDMadd  != NULL ){ additionFCI.Fill2RDM( addVectors[ num ], TwoRDMadd[ batch[ num ] ] ); }
+         }
          
+         double * leftVector = addVectors[ 0 ];
          for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
             const int orbitalLeft = orbsLeft[ cnt_left ];
-            if ( getOrb2Irrep( orbitalLeft ) == getOrb2Irrep( orbitalRight ) ){
-               additionFCI.ActWithSecondQuantizedOperator( 'C', isUp, orbitalLeft, addVector, this, GSvector ); // | addVector > = a^+_left,spin | GSvector >
-               RePartsGF[ cnt_left + numLeft * cnt_right ] = FCIddot( addVecLength, addVector, RealPartSolution );
-               ImPartsGF[ cnt_left + numLeft * cnt_right ] = FCIddot( addVecLength, addVector, ImagPartSolution );
+            if ( getOrb2Irrep( orbitalLeft ) == (int) irrep_right ){
+               additionFCI.ActWithSecondQuantizedOperator( 'C', isUp, orbitalLeft, leftVector, this, GSvector ); // | leftVector > = a^+_left,spin | GSvector >
+               for ( unsigned int num = 0; num < num_batch; num++ ){
+                  RePartsGF[ cnt_left + numLeft * batch[ num ] ] = FCIddot( vecLength, leftVector, RealPartSolution[ num ] );
+                  ImPartsGF[ cnt_left + numLeft * batch[ num ] ] = FCIddot( vecLength, leftVector, ImagPartSolution[ num ] );
+               }
             }
          }
          
+         for ( unsigned int num = 0; num < num_batch; num++ ){
+            delete [] addVectors[ num ];
+            delete [] RealPartSolution[ num ];
+            delete [] ImagPartSolution[ num ];
+         }
+         delete [] addVectors;
          delete [] RealPartSolution;
          delete [] ImagPartSolution;
-         delete [] addVector;
        
       }
    }
+   delete [] batch;
 
 }
 
@@ -2330,48 +3927,75 @@ void CheMPS2::FCI::GFmatrix_removal(const double alpha, const double beta, const
    }
    
    const bool isOK = ( isUp ) ? ( getNel_up() > 0 ) : ( getNel_down() > 0 ); // The electron can be removed
-   for ( unsigned int cnt_right = 0; cnt_right < numRight; cnt_right++ ){
+   if ( !isOK ){ return; }
    
-      const int orbitalRight = orbsRight[ cnt_right ];
-      bool matchingIrrep = false;
-      for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
-         if ( getOrb2Irrep( orbsLeft[ cnt_left] ) == getOrb2Irrep( orbitalRight ) ){ matchingIrrep = true; }
+   // The right orbitals of the same irrep share the FCI space, and their linear systems are solved together
+   unsigned int * batch = new unsigned int[ numRight ];
+   for ( unsigned int irrep_right = 0; irrep_right < num_irreps; irrep_right++ ){
+   
+      unsigned int num_batch = 0;
+      for ( unsigned int cnt_right = 0; cnt_right < numRight; cnt_right++ ){
+         const int orbitalRight = orbsRight[ cnt_right ];
+         bool matchingIrrep = false;
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            if ( getOrb2Irrep( orbsLeft[ cnt_left] ) == getOrb2Irrep( orbitalRight ) ){ matchingIrrep = true; }
+         }
+         if (( matchingIrrep ) && ( getOrb2Irrep( orbitalRight ) == (int) irrep_right )){
+            batch[ num_batch ] = cnt_right;
+            num_batch++;
+         }
       }
       
-      if ( isOK && matchingIrrep ){
+      if ( num_batch > 0 ){
       
          const unsigned int removeNelUP   = getNel_up()   - ((isUp) ? 1 : 0);
          const unsigned int removeNelDOWN = getNel_down() - ((isUp) ? 0 : 1);
-         const int removeIrrep = Irreps::directProd( getTargetIrrep(), getOrb2Irrep( orbitalRight ) );
+         const int removeIrrep = Irreps::directProd( getTargetIrrep(), irrep_right );
          
          CheMPS2::FCI removalFCI( Ham, removeNelUP, removeNelDOWN, removeIrrep, maxMemWorkMB, FCIverbose );
-         const unsigned int removeVecLength = removalFCI.getVecLength( 0 );
-         double * removeVector = new double[ removeVecLength ];
-         removalFCI.ActWithSecondQuantizedOperator( 'A', isUp, orbitalRight, removeVector, this, GSvector ); // | removeVector > = a_right,spin | GSvector >
+         const unsigned int vecLength = removalFCI.getVecLength( 0 );
+         double ** removeVectors       = new double*[ num_batch ];
+         double ** RealPartSolution = new double*[ num_batch ];
+         double ** ImagPartSolution = new double*[ num_batch ];
+         for ( unsigned int num = 0; num < num_batch; num++ ){
+            removeVectors[ num ]       = new double[ vecLength ];
+            RealPartSolution[ num ] = new double[ vecLength ];
+            ImagPartSolution[ num ] = new double[ vecLength ];
+            removalFCI.ActWithSecondQuantizedOperator( 'A', isUp, orbsRight[ batch[ num ] ], removeVectors[ num ], this, GSvector ); // | removeVectors[ num ] > = a_right,spin | GSvector >
+         }
          
-         double * RealPartSolution = new double[ removeVecLength ];
-         double * ImagPartSolution = new double[ removeVecLength ];
-         removalFCI.CGSolveSystem( alpha, beta, eta, removeVector, RealPartSolution, ImagPartSolution );
+         removalFCI.CGSolveSystems( alpha, beta, eta, num_batch, removeVectors, RealPartSolution, ImagPartSolution );
          
-         if ( TwoRDMreal != NULL ){ removalFCI.Fill2RDM( RealPartSolution, TwoRDMreal[ cnt_right ] ); }
-         if ( TwoRDMimag != NULL ){ removalFCI.Fill2RDM( ImagPartSolution, TwoRDMimag[ cnt_right ] ); }
-         if ( TwoRDMrem  != NULL ){ removalFCI.Fill2RDM( removeVector,      TwoRDMrem[ cnt_right ] ); }
+         for ( unsigned int num = 0; num < num_batch; num++ ){
+            if ( TwoRDMreal != NULL ){ removalFCI.Fill2RDM( RealPartSolution[ num ], TwoRDMreal[ batch[ num ] ] ); }
+            if ( TwoRDMimag != NULL ){ removalFCI.Fill2RDM( ImagPartSolution[ num ], TwoRDMimag[ batch[ num ] ] ); }
+            if ( TwoRDMrem  != NULL ){ removalFCI.Fill2RDM( removeVectors[ num ], TwoRDMrem[ batch[ num ] ] ); }
+         }
          
+         double * leftVector = removeVectors[ 0 ];
          for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
             const int orbitalLeft = orbsLeft[ cnt_left ];
-            if ( getOrb2Irrep( orbitalLeft ) == getOrb2Irrep( orbitalRight ) ){
-               removalFCI.ActWithSecondQuantizedOperator( 'A', isUp, orbitalLeft, removeVector, this, GSvector ); // | removeVector > = a_left,spin | GSvector >
-               RePartsGF[ cnt_left + numLeft * cnt_right ] = FCIddot( removeVecLength, removeVector, RealPartSolution );
-               ImPartsGF[ cnt_left + numLeft * cnt_right ] = FCIddot( removeVecLength, removeVector, ImagPartSolution );
+            if ( getOrb2Irrep( orbitalLeft ) == (int) irrep_right ){
+               removalFCI.ActWithSecondQuantizedOperator( 'A', isUp, orbitalLeft, leftVector, this, GSvector ); // | leftVector > = a_left,spin | GSvector >
+               for ( unsigned int num = 0; num < num_batch; num++ ){
+                  RePartsGF[ cnt_left + numLeft * batch[ num ] ] = FCIddot( vecLength, leftVector, RealPartSolution[ num ] );
+                  ImPartsGF[ cnt_left + numLeft * batch[ num ] ] = FCIddot( vecLength, leftVector, ImagPartSolution[ num ] );
+               }
             }
          }
          
+         for ( unsigned int num = 0; num < num_batch; num++ ){
+            delete [] removeVectors[ num ];
+            delete [] RealPartSolution[ num ];
+            delete [] ImagPartSolution[ num ];
+         }
+         delete [] removeVectors;
          delete [] RealPartSolution;
          delete [] ImagPartSolution;
-         delete [] removeVector;
        
       }
    }
+   delete [] batch;
 
 }
 
@@ -2395,6 +4019,318 @@ void CheMPS2::FCI::RetardedGF_removal(const double omega, const double eta, cons
 
 }
 
+void CheMPS2::FCI::GFmatrix_addition_lanczos(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, int * orbsLeft, const unsigned int numLeft, int * orbsRight, const unsigned int numRight, const bool isUp, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartsGF, double * ImPartsGF, const unsigned int maxKrylov, const double rtol, const bool * refine) const{
+
+   /*
+                                                                                     1
+       GF[i + numLeft * ( j + numRight * k )] = < 0 | a_{orbsLeft[i], spin} ------------------------------------ a^+_{orbsRight[j], spin} | 0 >
+                                                                            [ alphas[k] + beta * Ham + I*eta ]
+   */
+
+   assert( numLeft  > 0 );
+   assert( numRight > 0 );
+   assert( numAlpha > 0 );
+   for (unsigned int cnt = 0; cnt < numLeft;  cnt++){ int orbl = orbsLeft[  cnt ]; assert((orbl < L) && (orbl >= 0)); }
+   for (unsigned int cnt = 0; cnt < numRight; cnt++){ int orbr = orbsRight[ cnt ]; assert((orbr < L) && (orbr >= 0)); }
+   assert( RePartsGF != NULL );
+   assert( ImPartsGF != NULL );
+   for ( unsigned int counter = 0; counter < numLeft * numRight * numAlpha; counter++ ){
+       RePartsGF[ counter ] = 0.0;
+       ImPartsGF[ counter ] = 0.0;
+   }
+   
+   const bool isOK = ( isUp ) ? ( getNel_up() < L ) : ( getNel_down() < L ); // The electron can be added
+   for ( unsigned int cnt_right = 0; cnt_right < numRight; cnt_right++ ){
+   
+      const int orbitalRight = orbsRight[ cnt_right ];
+      bool matchingIrrep = false;
+      for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+         if ( getOrb2Irrep( orbsLeft[ cnt_left] ) == getOrb2Irrep( orbitalRight ) ){ matchingIrrep = true; }
+      }
+      
+      if ( isOK && matchingIrrep ){
+      
+         const unsigned int addNelUP   = getNel_up()   + ((isUp) ? 1 : 0);
+         const unsigned int addNelDOWN = getNel_down() + ((isUp) ? 0 : 1);
+         const int addIrrep = Irreps::directProd( getTargetIrrep(), getOrb2Irrep( orbitalRight ) );
+         
+         CheMPS2::FCI additionFCI( Ham, addNelUP, addNelDOWN, addIrrep, maxMemWorkMB, FCIverbose );
+         const unsigned int addVecLength = additionFCI.getVecLength( 0 );
+         double * addVector = new double[ addVecLength ];
+         additionFCI.ActWithSecondQuantizedOperator( 'C', isUp, orbitalRight, addVector, this, GSvector ); // | addVector > = a^+_right,spin | GSvector >
+         
+         double ** leftVectors = new double*[ numLeft ];
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            leftVectors[ cnt_left ] = NULL;
+            const int orbitalLeft = orbsLeft[ cnt_left ];
+            if ( getOrb2Irrep( orbitalLeft ) == getOrb2Irrep( orbitalRight ) ){
+               leftVectors[ cnt_left ] = new double[ addVecLength ];
+               additionFCI.ActWithSecondQuantizedOperator( 'C', isUp, orbitalLeft, leftVectors[ cnt_left ], this, GSvector ); // | leftVector > = a^+_left,spin | GSvector >
+            }
+         }
+         
+         additionFCI.LanczosSolveSystem( alphas, numAlpha, beta, eta, addVector, leftVectors, numLeft, numLeft * numRight,
+                                         RePartsGF + numLeft * cnt_right, ImPartsGF + numLeft * cnt_right, maxKrylov, rtol );
+         
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            if ( leftVectors[ cnt_left ] != NULL ){ delete [] leftVectors[ cnt_left ]; }
+         }
+         delete [] leftVectors;
+         delete [] addVector;
+       
+      }
+   }
+   
+   // Replace the Lanczos values by conjugate gradient solutions at the requested alphas
+   if ( refine != NULL ){
+      double * RePartsCG = new double[ numLeft * numRight ];
+      double * ImPartsCG = new double[ numLeft * numRight ];
+      for ( unsigned int cnt_alpha = 0; cnt_alpha < numAlpha; cnt_alpha++ ){
+         if ( refine[ cnt_alpha ] ){
+            GFmatrix_addition( alphas[ cnt_alpha ], beta, eta, orbsLeft, numLeft, orbsRight, numRight, isUp, GSvector, Ham, RePartsCG, ImPartsCG );
+            for ( unsigned int counter = 0; counter < numLeft * numRight; counter++ ){
+               RePartsGF[ counter + numLeft * numRight * cnt_alpha ] = RePartsCG[ counter ];
+               ImPartsGF[ counter + numLeft * numRight * cnt_alpha ] = ImPartsCG[ counter ];
+            }
+         }
+      }
+      delete [] RePartsCG;
+      delete [] ImPartsCG;
+   }
+
+}
+
+void CheMPS2::FCI::GFmatrix_removal_lanczos(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, int * orbsLeft, const unsigned int numLeft, int * orbsRight, const unsigned int numRight, const bool isUp, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartsGF, double * ImPartsGF, const unsigned int maxKrylov, const double rtol, const bool * refine) const{
+
+   /*
+                                                                                       1
+       GF[i + numLeft * ( j + numRight * k )] = < 0 | a^+_{orbsLeft[i], spin} ------------------------------------ a_{orbsRight[j], spin} | 0 >
+                                                                              [ alphas[k] + beta * Ham + I*eta ]
+   */
+
+   assert( numLeft  > 0 );
+   assert( numRight > 0 );
+   assert( numAlpha > 0 );
+   for (unsigned int cnt = 0; cnt < numLeft;  cnt++){ int orbl = orbsLeft [ cnt ]; assert((orbl < L) && (orbl >= 0)); }
+   for (unsigned int cnt = 0; cnt < numRight; cnt++){ int orbr = orbsRight[ cnt ]; assert((orbr < L) && (orbr >= 0)); }
+   assert( RePartsGF != NULL );
+   assert( ImPartsGF != NULL );
+   for ( unsigned int counter = 0; counter < numLeft * numRight * numAlpha; counter++ ){
+       RePartsGF[ counter ] = 0.0;
+       ImPartsGF[ counter ] = 0.0;
+   }
+   
+   const bool isOK = ( isUp ) ? ( getNel_up() > 0 ) : ( getNel_down() > 0 ); // The electron can be removed
+   for ( unsigned int cnt_right = 0; cnt_right < numRight; cnt_right++ ){
+   
+      const int orbitalRight = orbsRight[ cnt_right ];
+      bool matchingIrrep = false;
+      for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+         if ( getOrb2Irrep( orbsLeft[ cnt_left] ) == getOrb2Irrep( orbitalRight ) ){ matchingIrrep = true; }
+      }
+      
+      if ( isOK && matchingIrrep ){
+      
+         const unsigned int removeNelUP   = getNel_up()   - ((isUp) ? 1 : 0);
+         const unsigned int removeNelDOWN = getNel_down() - ((isUp) ? 0 : 1);
+         const int removeIrrep = Irreps::directProd( getTargetIrrep(), getOrb2Irrep( orbitalRight ) );
+         
+         CheMPS2::FCI removalFCI( Ham, removeNelUP, removeNelDOWN, removeIrrep, maxMemWorkMB, FCIverbose );
+         const unsigned int removeVecLength = removalFCI.getVecLength( 0 );
+         double * removeVector = new double[ removeVecLength ];
+         removalFCI.ActWithSecondQuantizedOperator( 'A', isUp, orbitalRight, removeVector, this, GSvector ); // | removeVector > = a_right,spin | GSvector >
+         
+         double ** leftVectors = new double*[ numLeft ];
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            leftVectors[ cnt_left ] = NULL;
+            const int orbitalLeft = orbsLeft[ cnt_left ];
+            if ( getOrb2Irrep( orbitalLeft ) == getOrb2Irrep( orbitalRight ) ){
+               leftVectors[ cnt_left ] = new double[ removeVecLength ];
+               removalFCI.ActWithSecondQuantizedOperator( 'A', isUp, orbitalLeft, leftVectors[ cnt_left ], this, GSvector ); // | leftVector > = a_left,spin | GSvector >
+            }
+         }
+         
+         removalFCI.LanczosSolveSystem( alphas, numAlpha, beta, eta, removeVector, leftVectors, numLeft, numLeft * numRight,
+                                        RePartsGF + numLeft * cnt_right, ImPartsGF + numLeft * cnt_right, maxKrylov, rtol );
+         
+         for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+            if ( leftVectors[ cnt_left ] != NULL ){ delete [] leftVectors[ cnt_left ]; }
+         }
+         delete [] leftVectors;
+         delete [] removeVector;
+       
+      }
+   }
+   
+   // Replace the Lanczos values by conjugate gradient solutions at the requested alphas
+   if ( refine != NULL ){
+      double * RePartsCG = new double[ numLeft * numRight ];
+      double * ImPartsCG = new double[ numLeft * numRight ];
+      for ( unsigned int cnt_alpha = 0; cnt_alpha < numAlpha; cnt_alpha++ ){
+         if ( refine[ cnt_alpha ] ){
+            GFmatrix_removal( alphas[ cnt_alpha ], beta, eta, orbsLeft, numLeft, orbsRight, numRight, isUp, GSvector, Ham, RePartsCG, ImPartsCG );
+            for ( unsigned int counter = 0; counter < numLeft * numRight; counter++ ){
+               RePartsGF[ counter + numLeft * numRight * cnt_alpha ] = RePartsCG[ counter ];
+               ImPartsGF[ counter + numLeft * numRight * cnt_alpha ] = ImPartsCG[ counter ];
+            }
+         }
+      }
+      delete [] RePartsCG;
+      delete [] ImPartsCG;
+   }
+
+}
+
+void CheMPS2::FCI::LanczosSolveSystem(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, double * RHS, double ** leftVectors, const unsigned int numLeft, const unsigned int stride, double * RePart, double * ImPart, const unsigned int maxKrylov, const double rtol) const{
+
+   /*
+      The Krylov space of H with starting vector | v_0 > = RHS / || RHS || is built with the Lanczos three-term recursion:
+
+         beta_k | v_{k+1} > = H | v_k > - a_k | v_k > - beta_{k-1} | v_{k-1} >
+
+      H is represented in this space by the tridiagonal matrix T = tridiag( beta_{k-1}, a_k, beta_k ). For each alpha:
+
+         < left | [ alpha + beta * H + I*eta ]^{-1} | RHS > = || RHS || * sum_k < left | v_k > x_k
+
+      where x = [ alpha + beta * T + I*eta ]^{-1} e_0 is obtained with a complex tridiagonal (Thomas) solve. Only the overlaps
+      < left | v_k > are stored, so that the cost for an additional alpha is negligible compared to a single matvec. The Krylov
+      space is extended until the results for all alphas change less than rtol (relative to the largest result), until an
+      invariant subspace is found, or until maxKrylov vectors have been built.
+   */
+
+   assert( eta > 0.0 ); // The Thomas algorithm does not pivot
+
+   struct timeval start, end;
+   gettimeofday(&start, NULL);
+
+   const unsigned int vecLength = getVecLength( 0 );
+   const unsigned int check_every = 10;
+   const unsigned int max_dim = std::min( maxKrylov, vecLength );
+   const double norm_rhs = sqrt( FCIddot( vecLength, RHS, RHS ) );
+   for ( unsigned int cnt_alpha = 0; cnt_alpha < numAlpha; cnt_alpha++ ){
+      for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+         RePart[ cnt_left + stride * cnt_alpha ] = 0.0;
+         ImPart[ cnt_left + stride * cnt_alpha ] = 0.0;
+      }
+   }
+   if ( norm_rhs == 0.0 ){ return; }
+
+   double * diag      = new double[ max_dim ];             // a_k
+   double * offdiag   = new double[ max_dim ];             // beta_k
+   double * overlaps  = new double[ numLeft * max_dim ];   // < left_i | v_k >
+   double * re_x      = new double[ max_dim ];
+   double * im_x      = new double[ max_dim ];
+   double * re_c      = new double[ max_dim ];             // Work arrays for the Thomas algorithm
+   double * im_c      = new double[ max_dim ];
+   double * vec_prev  = new double[ vecLength ];
+   double * vec_curr  = new double[ vecLength ];
+   double * vec_next  = new double[ vecLength ];
+
+   FCIdcopy( vecLength, RHS, vec_curr );
+   FCIdscal( vecLength, 1.0 / norm_rhs, vec_curr );
+   ClearVector( vecLength, vec_prev );
+
+   unsigned int dim = 0;
+   bool converged = false;
+   double max_change = 0.0;
+   while ( !converged ){
+
+      for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+         overlaps[ cnt_left + numLeft * dim ] = (( leftVectors[ cnt_left ] == NULL ) ? 0.0 : FCIddot( vecLength, leftVectors[ cnt_left ], vec_curr ));
+      }
+      matvec( vec_curr, vec_next );
+      FCIdaxpy( vecLength, getEconst(), vec_curr, vec_next ); // matvec does only the parts with second quantized operators
+      diag[ dim ] = FCIddot( vecLength, vec_curr, vec_next );
+      FCIdaxpy( vecLength, -diag[ dim ], vec_curr, vec_next );
+      if ( dim > 0 ){ FCIdaxpy( vecLength, -offdiag[ dim - 1 ], vec_prev, vec_next ); }
+      offdiag[ dim ] = sqrt( FCIddot( vecLength, vec_next, vec_next ) );
+      dim++;
+
+      const bool invariant = ( offdiag[ dim - 1 ] < CheMPS2::CONJ_GRADIENT_PRECOND_CUTOFF * fabs( diag[ dim - 1 ] ) + 1e-14 );
+      const bool last      = (( invariant ) || ( dim == max_dim ));
+
+      if (( dim % check_every == 0 ) || ( last )){
+         double max_value = 0.0;
+         max_change = 0.0;
+         for ( unsigned int cnt_alpha = 0; cnt_alpha < numAlpha; cnt_alpha++ ){
+
+            // Thomas algorithm for [ alpha + beta * T + I*eta ] x = e_0
+            for ( unsigned int k = 0; k < dim; k++ ){
+               double re_denom = alphas[ cnt_alpha ] + beta * diag[ k ];
+               double im_denom = eta;
+               double re_rhs   = (( k == 0 ) ? 1.0 : 0.0 );
+               double im_rhs   = 0.0;
+               if ( k > 0 ){
+                  const double off = beta * offdiag[ k - 1 ];
+                  re_denom -= off * re_c[ k - 1 ];
+                  im_denom -= off * im_c[ k - 1 ];
+                  re_rhs   -= off * re_x[ k - 1 ];
+                  im_rhs   -= off * im_x[ k - 1 ];
+               }
+               const double inv_norm = 1.0 / ( re_denom * re_denom + im_denom * im_denom );
+               const double re_inv   =   re_denom * inv_norm;
+               const double im_inv   = - im_denom * inv_norm;
+               const double off_next = (( k + 1 < dim ) ? beta * offdiag[ k ] : 0.0 );
+               re_c[ k ] = off_next * re_inv;
+               im_c[ k ] = off_next * im_inv;
+               re_x[ k ] = re_rhs * re_inv - im_rhs * im_inv;
+               im_x[ k ] = re_rhs * im_inv + im_rhs * re_inv;
+            }
+            for ( int k = dim - 2; k >= 0; k-- ){
+               const double re_temp = re_c[ k ] * re_x[ k + 1 ] - im_c[ k ] * im_x[ k + 1 ];
+               const double im_temp = re_c[ k ] * im_x[ k + 1 ] + im_c[ k ] * re_x[ k + 1 ];
+               re_x[ k ] -= re_temp;
+               im_x[ k ] -= im_temp;
+            }
+
+            for ( unsigned int cnt_left = 0; cnt_left < numLeft; cnt_left++ ){
+               double re_value = 0.0;
+               double im_value = 0.0;
+               for ( unsigned int k = 0; k < dim; k++ ){
+                  re_value += overlaps[ cnt_left + numLeft * k ] * re_x[ k ];
+                  im_value += overlaps[ cnt_left + numLeft * k ] * im_x[ k ];
+               }
+               re_value *= norm_rhs;
+               im_value *= norm_rhs;
+               const unsigned int index = cnt_left + stride * cnt_alpha;
+               const double change = sqrt( ( re_value - RePart[ index ] ) * ( re_value - RePart[ index ] ) + ( im_value - ImPart[ index ] ) * ( im_value - ImPart[ index ] ) );
+               max_change = std::max( max_change, change );
+               max_value  = std::max( max_value, sqrt( re_value * re_value + im_value * im_value ) );
+               RePart[ index ] = re_value;
+               ImPart[ index ] = im_value;
+            }
+         }
+         converged = (( last ) || (( dim > check_every ) && ( max_change <= rtol * max_value )));
+      }
+
+      if ( !converged ){
+         double * temp = vec_prev;
+         vec_prev = vec_curr;
+         vec_curr = vec_next;
+         vec_next = temp;
+         FCIdscal( vecLength, 1.0 / offdiag[ dim - 1 ], vec_curr );
+      }
+   }
+
+   delete [] diag;
+   delete [] offdiag;
+   delete [] overlaps;
+   delete [] re_x;
+   delete [] im_x;
+   delete [] re_c;
+   delete [] im_c;
+   delete [] vec_prev;
+   delete [] vec_curr;
+   delete [] vec_next;
+
+   gettimeofday(&end, NULL);
+   const double elapsed = (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
+   if ( FCIverbose > 0 ){
+      cout << "FCI::LanczosSolveSystem : Krylov dimension = " << dim << " ; last change = " << max_change << " ; number of alphas = " << numAlpha << " ; wall time = " << elapsed << " seconds" << endl;
+   }
+
+}
+
 void CheMPS2::FCI::DensityResponseGF(const double omega, const double eta, const unsigned int orb_alpha, const unsigned int orb_beta, const double GSenergy, double * GSvector, double * RePartGF, double * ImPartGF) const{
 
    assert( RePartGF != NULL );
@@ -24,9 +24,11 @@
 #include <assert.h>
 
 #include "Heff.h"
+#include "HeffProfiler.h"
 #include "Davidson.h"
 #include "Lapack.h"
 #include "MPIchemps2.h"
+#include "Tracer.h"
 
 CheMPS2::Heff::Heff(const SyBookkeeper * denBKIn, const Problem * ProbIn, const double dvdson_rtol_in){
 
@@ -56,8 +58,9 @@ void CheMPS2::Heff::makeHeff(double * memS, double * memHeff, const Sobject * de
    
       double * temp  = new double[DIM*DIM];
       double * temp2 = new double[DIM*DIM];
+      Tracer::begin( "Heff", "dmrg" ); // Per thread: the gaps up to the implicit barrier show the load imbalance
    
-      #pragma omp for schedule(dynamic)
+      #pragma omp for schedule(dynamic) nowait
       for (int ikappaBIS=0; ikappaBIS<denS->gNKappa(); ikappaBIS++){
       
          const int ikappa = denS->gReorder(ikappaBIS);
@@ -240,6 +243,7 @@ void CheMPS2::Heff::makeHeff(double * memS, double * memHeff, const Sobject * de
          
       }
       
+      Tracer::end( "Heff", "dmrg" );
       delete [] temp;
       delete [] temp2;
    
@@ -260,6 +264,7 @@ void CheMPS2::Heff::fillHeffDiag(double * memHeffDiag, const Sobject * denS, Ten
    #pragma omp parallel for schedule(dynamic)
    for (int ikappaBIS=0; ikappaBIS<denS->gNKappa(); ikappaBIS++){
    
+      HeffProfiler::Probe probe( CHEMPS2_HEFF_DIAGONAL );
       const int ikappa = denS->gReorder(ikappaBIS);
       for (int cnt=denS->gKappa2index(ikappa); cnt<denS->gKappa2index(ikappa+1); cnt++){ memHeffDiag[cnt] = 0.0; }
       
@@ -314,21 +319,21 @@ void CheMPS2::Heff::fillHeffDiag(double * memHeffDiag, const Sobject * denS, Ten
    
 }
 
-double CheMPS2::Heff::SolveDAVIDSON(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const{
+double CheMPS2::Heff::SolveDAVIDSON(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde, int * num_matvec) const{
 
    #ifdef CHEMPS2_MPI_COMPILATION
    if ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER ){
-      return SolveDAVIDSON_main(denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
+      return SolveDAVIDSON_main(denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde, num_matvec);
    } else {
       return SolveDAVIDSON_help(denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
    }
    #else
-      return SolveDAVIDSON_main(denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde);
+      return SolveDAVIDSON_main(denS, Ltensors, Atensors, Btensors, Ctensors, Dtensors, S0tensors, S1tensors, F0tensors, F1tensors, Qtensors, Xtensors, nLower, VeffTilde, num_matvec);
    #endif
 
 }
 
-double CheMPS2::Heff::SolveDAVIDSON_main(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const{
+double CheMPS2::Heff::SolveDAVIDSON_main(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde, int * num_matvec) const{
 
    int inc1 = 1;
    int veclength = denS->gKappa2index( denS->gNKappa() );
@@ -374,6 +379,7 @@ double CheMPS2::Heff::SolveDAVIDSON_main(Sobject * denS, TensorL *** Ltensors, T
    denS->symm2prog(); // Convert mem of Sobject to program conventions
    double eigenvalue = whichpointers[1][0];
    if (CheMPS2::HEFF_debugPrint){ std::cout << "   Stats: nIt(DAVIDSON) = " << deBoskabouter.GetNumMultiplications() << std::endl; }
+   if ( num_matvec != NULL ){ *num_matvec = deBoskabouter.GetNumMultiplications(); }
    delete [] whichpointers;
    #ifdef CHEMPS2_MPI_COMPILATION
       delete [] workspace;
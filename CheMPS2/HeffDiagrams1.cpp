@@ -20,20 +20,25 @@
 #include <math.h>
 
 #include "Heff.h"
+#include "HeffProfiler.h"
 #include "Lapack.h"
 #include "MPIchemps2.h"
 
 void CheMPS2::Heff::addDiagram1A(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorX * Xleft) const{
+
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_1A );
    int dimL = denBK->gCurrentDim(denS->gIndex(), denS->gNL(ikappa), denS->gTwoSL(ikappa), denS->gIL(ikappa));
    int dimR = denBK->gCurrentDim(denS->gIndex()+2, denS->gNR(ikappa), denS->gTwoSR(ikappa), denS->gIR(ikappa));
    double * BlockX = Xleft->gStorage( denS->gNL(ikappa), denS->gTwoSL(ikappa), denS->gIL(ikappa), denS->gNL(ikappa), denS->gTwoSL(ikappa), denS->gIL(ikappa) );
    
    double one = 1.0;
    char notr = 'N';
-   dgemm_(&notr,&notr,&dimL,&dimR,&dimL,&one,BlockX,&dimL,memS+denS->gKappa2index(ikappa),&dimL,&one,memHeff+denS->gKappa2index(ikappa),&dimL);
+   HeffProfiler::dgemm(&notr,&notr,&dimL,&dimR,&dimL,&one,BlockX,&dimL,memS+denS->gKappa2index(ikappa),&dimL,&one,memHeff+denS->gKappa2index(ikappa),&dimL);
 }
 
 void CheMPS2::Heff::addDiagram1B(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorX * Xright) const{
+
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_1B );
    int dimL = denBK->gCurrentDim(denS->gIndex(), denS->gNL(ikappa), denS->gTwoSL(ikappa), denS->gIL(ikappa));
    int dimR = denBK->gCurrentDim(denS->gIndex()+2, denS->gNR(ikappa), denS->gTwoSR(ikappa), denS->gIR(ikappa));
    double * BlockX = Xright->gStorage( denS->gNR(ikappa), denS->gTwoSR(ikappa), denS->gIR(ikappa), denS->gNR(ikappa), denS->gTwoSR(ikappa), denS->gIR(ikappa) );
@@ -41,10 +46,12 @@ void CheMPS2::Heff::addDiagram1B(const int ikappa, double * memS, double * memHe
    double one = 1.0;
    char notr = 'N';
    char trans = 'T';
-   dgemm_(&notr,&trans,&dimL,&dimR,&dimR,&one,memS+denS->gKappa2index(ikappa),&dimL,BlockX,&dimR,&one,memHeff+denS->gKappa2index(ikappa),&dimL);
+   HeffProfiler::dgemm(&notr,&trans,&dimL,&dimR,&dimR,&one,memS+denS->gKappa2index(ikappa),&dimL,BlockX,&dimR,&one,memHeff+denS->gKappa2index(ikappa),&dimL);
 }
 
 void CheMPS2::Heff::addDiagram1C(const int ikappa, double * memS, double * memHeff, const Sobject * denS, double Helem_links) const{
+
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_1C );
    if (denS->gN1(ikappa)==2){
       int inc = 1;
       int ptr = denS->gKappa2index(ikappa);
@@ -54,6 +61,8 @@ void CheMPS2::Heff::addDiagram1C(const int ikappa, double * memS, double * memHe
 }
 
 void CheMPS2::Heff::addDiagram1D(const int ikappa, double * memS, double * memHeff, const Sobject * denS, double Helem_rechts) const{
+
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_1D );
    if (denS->gN2(ikappa)==2){
       int inc = 1;
       int ptr = denS->gKappa2index(ikappa);
@@ -64,6 +73,8 @@ void CheMPS2::Heff::addDiagram1D(const int ikappa, double * memS, double * memHe
 
 void CheMPS2::Heff::addDiagramExcitations(const int ikappa, double * memS, double * memHeff, const Sobject * denS, int nLower, double ** VeffTilde) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_EXC );
+
    int dimTotal = denS->gKappa2index(denS->gNKappa());
    int ptr = denS->gKappa2index(ikappa);
    int dimBlock = denS->gKappa2index(ikappa+1) - ptr;
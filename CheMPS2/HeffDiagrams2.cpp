@@ -21,12 +21,15 @@
 #include <stdlib.h>
 
 #include "Heff.h"
+#include "HeffProfiler.h"
 #include "Lapack.h"
 #include "MPIchemps2.h"
 #include "Wigner.h"
 
 void CheMPS2::Heff::addDiagram2a1spin0(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator **** Atensors, TensorS0 **** S0tensors, double * workspace) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2A1S0 );
+
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
    #endif
@@ -75,11 +78,11 @@ void CheMPS2::Heff::addDiagram2a1spin0(const int ikappa, double * memS, double *
                   double alpha = 1.0;
                   double beta = 0.0;
                   
-                  dgemm_(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockS0,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                  HeffProfiler::dgemm(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockS0,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                   beta = 1.0;
                   
-                  dgemm_(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockA,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                  HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockA,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                }
             }
@@ -112,11 +115,11 @@ void CheMPS2::Heff::addDiagram2a1spin0(const int ikappa, double * memS, double *
                   double alpha = 1.0;
                   double beta = 0.0;
                   
-                  dgemm_(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockA,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                  HeffProfiler::dgemm(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockA,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                   beta = 1.0;
                   
-                  dgemm_(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockS0,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                  HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockS0,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                }
             }
@@ -128,6 +131,8 @@ void CheMPS2::Heff::addDiagram2a1spin0(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2a2spin0(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator **** Atensors, TensorS0 **** S0tensors, double * workspace) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2A2S0 );
+
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
    #endif
@@ -176,11 +181,11 @@ void CheMPS2::Heff::addDiagram2a2spin0(const int ikappa, double * memS, double *
                   double alpha = 1.0;
                   double beta = 0.0;
                   
-                  dgemm_(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockS0,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                  HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockS0,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                   beta = 1.0;
                   
-                  dgemm_(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockA,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                  HeffProfiler::dgemm(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockA,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                }
             }
@@ -213,11 +218,11 @@ void CheMPS2::Heff::addDiagram2a2spin0(const int ikappa, double * memS, double *
                   double alpha = 1.0;
                   double beta = 0.0;
                   
-                  dgemm_(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockA,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                  HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockA,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                   beta = 1.0;
                   
-                  dgemm_(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockS0,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                  HeffProfiler::dgemm(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockS0,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                }
             }
@@ -229,6 +234,8 @@ void CheMPS2::Heff::addDiagram2a2spin0(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2a1spin1(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator **** Btensors, TensorS1 **** S1tensors, double * workspace) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2A1S1 );
+
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
    #endif
@@ -285,11 +292,11 @@ void CheMPS2::Heff::addDiagram2a1spin1(const int ikappa, double * memS, double *
                            double alpha = thefactor;
                            double beta = 0.0;
                   
-                           dgemm_(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockS1,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                           HeffProfiler::dgemm(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockS1,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                            alpha = beta = 1.0;
                   
-                           dgemm_(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockB,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                           HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockB,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                         }
                      }
@@ -333,11 +340,11 @@ void CheMPS2::Heff::addDiagram2a1spin1(const int ikappa, double * memS, double *
                            double alpha = thefactor;
                            double beta = 0.0;
                         
-                           dgemm_(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockB,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                           HeffProfiler::dgemm(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockB,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                         
                            alpha = beta = 1.0;
                         
-                           dgemm_(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockS1,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                           HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockS1,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                         }
                      }
@@ -352,6 +359,8 @@ void CheMPS2::Heff::addDiagram2a1spin1(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2a2spin1(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator **** Btensors, TensorS1 **** S1tensors, double * workspace) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2A2S1 );
+
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
    #endif
@@ -408,11 +417,11 @@ void CheMPS2::Heff::addDiagram2a2spin1(const int ikappa, double * memS, double *
                            double alpha = thefactor;
                            double beta = 0.0;
                   
-                           dgemm_(&notr,&notr,&dimL,&dimRdown,&dimLdown,&alpha,BlockS1,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                           HeffProfiler::dgemm(&notr,&notr,&dimL,&dimRdown,&dimLdown,&alpha,BlockS1,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                            alpha = beta = 1.0;
                   
-                           dgemm_(&notr,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockB,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                           HeffProfiler::dgemm(&notr,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockB,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                         }
                      }
@@ -456,11 +465,11 @@ void CheMPS2::Heff::addDiagram2a2spin1(const int ikappa, double * memS, double *
                            double alpha = thefactor;
                            double beta = 0.0;
                   
-                           dgemm_(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockB,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                           HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockB,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                            alpha = beta = 1.0;
                   
-                           dgemm_(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockS1,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                           HeffProfiler::dgemm(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockS1,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                     
                         }
                      }
@@ -475,6 +484,8 @@ void CheMPS2::Heff::addDiagram2a2spin1(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2a3spin0(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator **** Ctensors, TensorF0 **** F0tensors, double * workspace) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2A3S0 );
+
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
    #endif
@@ -524,11 +535,11 @@ void CheMPS2::Heff::addDiagram2a3spin0(const int ikappa, double * memS, double *
                   double alpha = 1.0;
                   double beta = 0.0;
                   
-                  dgemm_(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockF0,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                  HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockF0,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                   beta = 1.0;
                   
-                  dgemm_(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,ptr,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                  HeffProfiler::dgemm(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,ptr,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                }
             }
@@ -560,11 +571,11 @@ void CheMPS2::Heff::addDiagram2a3spin0(const int ikappa, double * memS, double *
                   double alpha = 1.0;
                   double beta = 0.0;
                   
-                  dgemm_(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockF0,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                  HeffProfiler::dgemm(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,BlockF0,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                   beta = 1.0;
                   
-                  dgemm_(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,ptr,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                  HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,ptr,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                }
             }
@@ -598,11 +609,11 @@ void CheMPS2::Heff::addDiagram2a3spin0(const int ikappa, double * memS, double *
                   double alpha = 1.0;
                   double beta = 0.0;
                   
-                  dgemm_(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,ptr,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                  HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,ptr,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                   beta = 1.0;
                   
-                  dgemm_(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockF0,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                  HeffProfiler::dgemm(&notrans,&trans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockF0,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                }
             }
@@ -634,11 +645,11 @@ void CheMPS2::Heff::addDiagram2a3spin0(const int ikappa, double * memS, double *
                   double alpha = 1.0;
                   double beta = 0.0;
                   
-                  dgemm_(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,ptr,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                  HeffProfiler::dgemm(&trans,&notrans,&dimL,&dimRdown,&dimLdown,&alpha,ptr,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                   beta = 1.0;
                   
-                  dgemm_(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockF0,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                  HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimR,&dimRdown,&alpha,workspace,&dimL,BlockF0,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                }
             }
@@ -650,6 +661,8 @@ void CheMPS2::Heff::addDiagram2a3spin0(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2a3spin1(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator **** Dtensors, TensorF1 **** F1tensors, double * workspace) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2A3S1 );
+
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
    #endif
@@ -706,11 +719,11 @@ void CheMPS2::Heff::addDiagram2a3spin1(const int ikappa, double * memS, double *
                            char notr = 'N';
                            double beta = 0.0;
                   
-                           dgemm_(&notr,&notr,&dimL,&dimRdown,&dimLdown,&prefactor,BlockF1,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                           HeffProfiler::dgemm(&notr,&notr,&dimL,&dimRdown,&dimLdown,&prefactor,BlockF1,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                            beta = 1.0;
                   
-                           dgemm_(&notr,&trans,&dimL,&dimR,&dimRdown,&beta,workspace,&dimL,ptr,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                           HeffProfiler::dgemm(&notr,&trans,&dimL,&dimR,&dimRdown,&beta,workspace,&dimL,ptr,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                         }
                      }
@@ -744,11 +757,11 @@ void CheMPS2::Heff::addDiagram2a3spin1(const int ikappa, double * memS, double *
                            char notr = 'N';
                            double beta = 0.0;
                            
-                           dgemm_(&trans,&notr,&dimL,&dimRdown,&dimLdown,&prefactor,BlockF1,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                           HeffProfiler::dgemm(&trans,&notr,&dimL,&dimRdown,&dimLdown,&prefactor,BlockF1,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                            beta = 1.0;
                   
-                           dgemm_(&notr,&notr,&dimL,&dimR,&dimRdown,&beta,workspace,&dimL,ptr,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                           HeffProfiler::dgemm(&notr,&notr,&dimL,&dimR,&dimRdown,&beta,workspace,&dimL,ptr,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                         }
                      }
@@ -792,11 +805,11 @@ void CheMPS2::Heff::addDiagram2a3spin1(const int ikappa, double * memS, double *
                            char notr = 'N';
                            double beta = 0.0;
                   
-                           dgemm_(&notr,&notr,&dimL,&dimRdown,&dimLdown,&prefactor,ptr,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                           HeffProfiler::dgemm(&notr,&notr,&dimL,&dimRdown,&dimLdown,&prefactor,ptr,&dimL,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                            beta = 1.0;
                   
-                           dgemm_(&notr,&trans,&dimL,&dimR,&dimRdown,&beta,workspace,&dimL,BlockF1,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                           HeffProfiler::dgemm(&notr,&trans,&dimL,&dimR,&dimRdown,&beta,workspace,&dimL,BlockF1,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                         }
                      }
@@ -830,11 +843,11 @@ void CheMPS2::Heff::addDiagram2a3spin1(const int ikappa, double * memS, double *
                            char notr = 'N';
                            double beta = 0.0;
                   
-                           dgemm_(&trans,&notr,&dimL,&dimRdown,&dimLdown,&prefactor,ptr,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
+                           HeffProfiler::dgemm(&trans,&notr,&dimL,&dimRdown,&dimLdown,&prefactor,ptr,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,workspace,&dimL);
                   
                            beta = 1.0;
                   
-                           dgemm_(&notr,&notr,&dimL,&dimR,&dimRdown,&beta,workspace,&dimL,BlockF1,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                           HeffProfiler::dgemm(&notr,&notr,&dimL,&dimR,&dimRdown,&beta,workspace,&dimL,BlockF1,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   
                         }
                      }
@@ -849,6 +862,8 @@ void CheMPS2::Heff::addDiagram2a3spin1(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2b1and2b2(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Atensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2B1_2B2 );
+
    int N1 = denS->gN1(ikappa);
    
    if (N1==0){
@@ -879,7 +894,7 @@ void CheMPS2::Heff::addDiagram2b1and2b2(const int ikappa, double * memS, double
             double alpha = sqrt(2.0);
             double beta = 1.0;
             
-            dgemm_(&trans,&notrans,&dimLup,&dimR,&dimLdown,&alpha,BlockA,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+            HeffProfiler::dgemm(&trans,&notrans,&dimLup,&dimR,&dimLdown,&alpha,BlockA,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
          
          }
       }
@@ -912,7 +927,7 @@ void CheMPS2::Heff::addDiagram2b1and2b2(const int ikappa, double * memS, double
             double alpha = sqrt(2.0);
             double beta = 1.0;
             
-            dgemm_(&notrans,&notrans,&dimLup,&dimR,&dimLdown,&alpha,BlockA,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+            HeffProfiler::dgemm(&notrans,&notrans,&dimLup,&dimR,&dimLdown,&alpha,BlockA,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
          
          }
       }
@@ -922,6 +937,8 @@ void CheMPS2::Heff::addDiagram2b1and2b2(const int ikappa, double * memS, double
 
 void CheMPS2::Heff::addDiagram2c1and2c2(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Atensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2C1_2C2 );
+
    int N2 = denS->gN2(ikappa);
    
    if (N2==0){
@@ -952,7 +969,7 @@ void CheMPS2::Heff::addDiagram2c1and2c2(const int ikappa, double * memS, double
             double alpha = sqrt(2.0);
             double beta = 1.0;
             
-            dgemm_(&trans,&notrans,&dimLup,&dimR,&dimLdown,&alpha,BlockA,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+            HeffProfiler::dgemm(&trans,&notrans,&dimLup,&dimR,&dimLdown,&alpha,BlockA,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
          
          }
       }
@@ -985,7 +1002,7 @@ void CheMPS2::Heff::addDiagram2c1and2c2(const int ikappa, double * memS, double
             double alpha = sqrt(2.0);
             double beta = 1.0;
             
-            dgemm_(&notrans,&notrans,&dimLup,&dimR,&dimLdown,&alpha,BlockA,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+            HeffProfiler::dgemm(&notrans,&notrans,&dimLup,&dimR,&dimLdown,&alpha,BlockA,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
          
          }
       }
@@ -995,6 +1012,8 @@ void CheMPS2::Heff::addDiagram2c1and2c2(const int ikappa, double * memS, double
 
 void CheMPS2::Heff::addDiagram2dall(const int ikappa, double * memS, double * memHeff, const Sobject * denS) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2D );
+
    const int N1 = denS->gN1(ikappa);
    const int N2 = denS->gN2(ikappa);
    const int theindex = denS->gIndex();
@@ -1059,6 +1078,8 @@ void CheMPS2::Heff::addDiagram2dall(const int ikappa, double * memS, double * me
 
 void CheMPS2::Heff::addDiagram2e1and2e2(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Atensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2E1_2E2 );
+
    int N1 = denS->gN1(ikappa);
    
    if (N1==2){
@@ -1084,7 +1105,7 @@ void CheMPS2::Heff::addDiagram2e1and2e2(const int ikappa, double * memS, double
          double alpha = sqrt(2.0);
          double beta = 1.0;
             
-         dgemm_(&notrans,&notrans,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,BlockA,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+         HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,BlockA,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
 
       }
    }
@@ -1113,7 +1134,7 @@ void CheMPS2::Heff::addDiagram2e1and2e2(const int ikappa, double * memS, double
          double alpha = sqrt(2.0);
          double beta = 1.0;
             
-         dgemm_(&notrans,&trans,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,BlockA,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+         HeffProfiler::dgemm(&notrans,&trans,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,BlockA,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
 
       }
    }
@@ -1122,6 +1143,8 @@ void CheMPS2::Heff::addDiagram2e1and2e2(const int ikappa, double * memS, double
 
 void CheMPS2::Heff::addDiagram2f1and2f2(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Atensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2F1_2F2 );
+
    int N2 = denS->gN2(ikappa);
    
    if (N2==2){
@@ -1147,7 +1170,7 @@ void CheMPS2::Heff::addDiagram2f1and2f2(const int ikappa, double * memS, double
          double alpha = sqrt(2.0);
          double beta = 1.0;
             
-         dgemm_(&notrans,&notrans,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,BlockA,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+         HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,BlockA,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
 
       }
    }
@@ -1176,7 +1199,7 @@ void CheMPS2::Heff::addDiagram2f1and2f2(const int ikappa, double * memS, double
          double alpha = sqrt(2.0);
          double beta = 1.0;
             
-         dgemm_(&notrans,&trans,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,BlockA,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+         HeffProfiler::dgemm(&notrans,&trans,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,BlockA,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
 
       }
    }
@@ -1185,6 +1208,8 @@ void CheMPS2::Heff::addDiagram2f1and2f2(const int ikappa, double * memS, double
 
 void CheMPS2::Heff::addDiagram2b3spin0(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Ctensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2B3S0 );
+
    int N1 = denS->gN1(ikappa);
    
    if (N1!=0){
@@ -1205,7 +1230,7 @@ void CheMPS2::Heff::addDiagram2b3spin0(const int ikappa, double * memS, double *
       double alpha = ((N1==2)?1.0:0.5)*sqrt(2.0);
       double beta = 1.0;
             
-      dgemm_(&trans,&notrans,&dimL,&dimR,&dimL,&alpha,Cblock,&dimL,memS+denS->gKappa2index(ikappa),&dimL,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+      HeffProfiler::dgemm(&trans,&notrans,&dimL,&dimR,&dimL,&alpha,Cblock,&dimL,memS+denS->gKappa2index(ikappa),&dimL,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
 
    }
    
@@ -1213,6 +1238,8 @@ void CheMPS2::Heff::addDiagram2b3spin0(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2c3spin0(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Ctensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2C3S0 );
+
    int N2 = denS->gN2(ikappa);
    
    if (N2!=0){
@@ -1233,7 +1260,7 @@ void CheMPS2::Heff::addDiagram2c3spin0(const int ikappa, double * memS, double *
       double alpha = ((N2==2)?1.0:0.5)*sqrt(2.0);
       double beta = 1.0;
             
-      dgemm_(&trans,&notrans,&dimL,&dimR,&dimL,&alpha,Cblock,&dimL,memS+denS->gKappa2index(ikappa),&dimL,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+      HeffProfiler::dgemm(&trans,&notrans,&dimL,&dimR,&dimL,&alpha,Cblock,&dimL,memS+denS->gKappa2index(ikappa),&dimL,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
 
    }
    
@@ -1241,6 +1268,8 @@ void CheMPS2::Heff::addDiagram2c3spin0(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2e3spin0(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Ctensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2E3S0 );
+
    int N1 = denS->gN1(ikappa);
    
    if (N1!=0){
@@ -1260,7 +1289,7 @@ void CheMPS2::Heff::addDiagram2e3spin0(const int ikappa, double * memS, double *
       double alpha = ((N1==2)?1.0:0.5)*sqrt(2.0);
       double beta = 1.0;
             
-      dgemm_(&notrans,&notrans,&dimL,&dimR,&dimR,&alpha,memS+denS->gKappa2index(ikappa),&dimL,Cblock,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+      HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimR,&dimR,&alpha,memS+denS->gKappa2index(ikappa),&dimL,Cblock,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
 
    }
    
@@ -1268,6 +1297,8 @@ void CheMPS2::Heff::addDiagram2e3spin0(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2f3spin0(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Ctensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2F3S0 );
+
    int N2 = denS->gN2(ikappa);
    
    if (N2!=0){
@@ -1287,7 +1318,7 @@ void CheMPS2::Heff::addDiagram2f3spin0(const int ikappa, double * memS, double *
       double alpha = ((N2==2)?1.0:0.5)*sqrt(2.0);
       double beta = 1.0;
             
-      dgemm_(&notrans,&notrans,&dimL,&dimR,&dimR,&alpha,memS+denS->gKappa2index(ikappa),&dimL,Cblock,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+      HeffProfiler::dgemm(&notrans,&notrans,&dimL,&dimR,&dimR,&alpha,memS+denS->gKappa2index(ikappa),&dimL,Cblock,&dimR,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
 
    }
    
@@ -1295,6 +1326,8 @@ void CheMPS2::Heff::addDiagram2f3spin0(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2b3spin1(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Dtensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2B3S1 );
+
    int N1 = denS->gN1(ikappa);
    
    if (N1==1){
@@ -1336,7 +1369,7 @@ void CheMPS2::Heff::addDiagram2b3spin1(const int ikappa, double * memS, double *
                      char notra = 'N';
                      double beta = 1.0;
                
-                     dgemm_(&trans,&notra,&dimLup,&dimR,&dimLdown,&alpha,Dblock,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&trans,&notra,&dimLup,&dimR,&dimLdown,&alpha,Dblock,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
             
                   }
                }
@@ -1349,6 +1382,8 @@ void CheMPS2::Heff::addDiagram2b3spin1(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2c3spin1(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Dtensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2C3S1 );
+
    int N2 = denS->gN2(ikappa);
    
    if (N2==1){
@@ -1390,7 +1425,7 @@ void CheMPS2::Heff::addDiagram2c3spin1(const int ikappa, double * memS, double *
                      char notra = 'N';
                      double beta = 1.0;
                
-                     dgemm_(&trans,&notra,&dimLup,&dimR,&dimLdown,&alpha,Dblock,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&trans,&notra,&dimLup,&dimR,&dimLdown,&alpha,Dblock,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
                      
                   }
                }
@@ -1403,6 +1438,8 @@ void CheMPS2::Heff::addDiagram2c3spin1(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2e3spin1(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Dtensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2E3S1 );
+
    int N1 = denS->gN1(ikappa);
    
    if (N1==1){
@@ -1443,7 +1480,7 @@ void CheMPS2::Heff::addDiagram2e3spin1(const int ikappa, double * memS, double *
                      char notr = 'N';
                      double beta = 1.0;
                
-                     dgemm_(&notr,&notr,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,Dblock,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                     HeffProfiler::dgemm(&notr,&notr,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,Dblock,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                      
                   }
                }
@@ -1456,6 +1493,8 @@ void CheMPS2::Heff::addDiagram2e3spin1(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram2f3spin1(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorOperator * Dtensor) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_2F3S1 );
+
    int N2 = denS->gN2(ikappa);
    
    if (N2==1){
@@ -1496,7 +1535,7 @@ void CheMPS2::Heff::addDiagram2f3spin1(const int ikappa, double * memS, double *
                      char notr = 'N';
                      double beta = 1.0;
                
-                     dgemm_(&notr,&notr,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,Dblock,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                     HeffProfiler::dgemm(&notr,&notr,&dimL,&dimRup,&dimRdown,&alpha,memS+denS->gKappa2index(memSkappa),&dimL,Dblock,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                      
                   }
                }
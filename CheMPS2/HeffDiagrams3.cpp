@@ -21,12 +21,15 @@
 #include <stdlib.h>
 
 #include "Heff.h"
+#include "HeffProfiler.h"
 #include "Lapack.h"
 #include "MPIchemps2.h"
 #include "Wigner.h"
 
 void CheMPS2::Heff::addDiagram3Aand3D(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorQ * Qleft, TensorL ** Lleft, double * temp) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_3A_3D );
+
    int NL = denS->gNL(ikappa);
    int TwoSL = denS->gTwoSL(ikappa);
    int IL = denS->gIL(ikappa);
@@ -74,7 +77,7 @@ void CheMPS2::Heff::addDiagram3Aand3D(const int ikappa, double * memS, double *
                         }
                      }
                   
-                     dgemm_(&notr,&notr,&dimLup,&dimR,&dimLdown,&factor,temp,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&notr,&notr,&dimLup,&dimR,&dimLdown,&factor,temp,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
                   }
                }
             }
@@ -93,7 +96,7 @@ void CheMPS2::Heff::addDiagram3Aand3D(const int ikappa, double * memS, double *
                double beta = 1.0;
                char notr = 'N';
                double * BlockQ = Qleft->gStorage(NL,TwoSL,IL,NL+1,TwoSLdown,ILdown);
-               dgemm_(&notr,&notr,&dimLup,&dimR,&dimLdown,&factor,BlockQ,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+               HeffProfiler::dgemm(&notr,&notr,&dimLup,&dimR,&dimLdown,&factor,BlockQ,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
             }
          }
       }
@@ -117,7 +120,7 @@ void CheMPS2::Heff::addDiagram3Aand3D(const int ikappa, double * memS, double *
                      char notr = 'N';
                      char trans = 'T';
                      double * BlockQ = Qleft->gStorage(NL-1,TwoSLdown,ILdown,NL,TwoSL,IL);
-                     dgemm_(&trans,&notr,&dimLup,&dimR,&dimLdown,&factor,BlockQ,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&trans,&notr,&dimLup,&dimR,&dimLdown,&factor,BlockQ,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
                   }
                }
             }
@@ -150,7 +153,7 @@ void CheMPS2::Heff::addDiagram3Aand3D(const int ikappa, double * memS, double *
                   }
                }
                
-               dgemm_(&trans,&notr,&dimLup,&dimR,&dimLdown,&factor,temp,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+               HeffProfiler::dgemm(&trans,&notr,&dimLup,&dimR,&dimLdown,&factor,temp,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
             }
          }
       }
@@ -160,6 +163,8 @@ void CheMPS2::Heff::addDiagram3Aand3D(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram3Band3I(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorQ * Qleft, TensorL ** Lleft, double * temp) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_3B_3I );
+
    int NL = denS->gNL(ikappa);
    int TwoSL = denS->gTwoSL(ikappa);
    int IL = denS->gIL(ikappa);
@@ -207,7 +212,7 @@ void CheMPS2::Heff::addDiagram3Band3I(const int ikappa, double * memS, double *
                         }
                      }
                   
-                     dgemm_(&notr,&notr,&dimLup,&dimR,&dimLdown,&factor,temp,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&notr,&notr,&dimLup,&dimR,&dimLdown,&factor,temp,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
                   }
                }
             }
@@ -226,7 +231,7 @@ void CheMPS2::Heff::addDiagram3Band3I(const int ikappa, double * memS, double *
                double beta = 1.0;
                char notr = 'N';
                double * BlockQ = Qleft->gStorage(NL,TwoSL,IL,NL+1,TwoSLdown,ILdown);
-               dgemm_(&notr,&notr,&dimLup,&dimR,&dimLdown,&factor,BlockQ,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+               HeffProfiler::dgemm(&notr,&notr,&dimLup,&dimR,&dimLdown,&factor,BlockQ,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
             }
          }
       }
@@ -250,7 +255,7 @@ void CheMPS2::Heff::addDiagram3Band3I(const int ikappa, double * memS, double *
                      char notr = 'N';
                      char trans = 'T';
                      double * BlockQ = Qleft->gStorage(NL-1,TwoSLdown,ILdown,NL,TwoSL,IL);
-                     dgemm_(&trans,&notr,&dimLup,&dimR,&dimLdown,&factor,BlockQ,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&trans,&notr,&dimLup,&dimR,&dimLdown,&factor,BlockQ,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
                   }
                }
             }
@@ -283,7 +288,7 @@ void CheMPS2::Heff::addDiagram3Band3I(const int ikappa, double * memS, double *
                   }
                }
             
-               dgemm_(&trans,&notr,&dimLup,&dimR,&dimLdown,&factor,temp,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+               HeffProfiler::dgemm(&trans,&notr,&dimLup,&dimR,&dimLdown,&factor,temp,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
             }
          }
       }
@@ -293,6 +298,8 @@ void CheMPS2::Heff::addDiagram3Band3I(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram3C(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorQ ** Qleft, TensorL ** Lright, double * temp) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_3C );
+
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
    #endif
@@ -340,11 +347,11 @@ void CheMPS2::Heff::addDiagram3C(const int ikappa, double * memS, double * memHe
                      char notra = 'N';
                      double beta = 0.0; //set
                      double alpha = factor;
-                     dgemm_(&notra,&notra,&dimLup,&dimRdown,&dimLdown,&alpha,Qblock,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,temp,&dimLup);
+                     HeffProfiler::dgemm(&notra,&notra,&dimLup,&dimRdown,&dimLdown,&alpha,Qblock,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,temp,&dimLup);
                   
                      beta = 1.0; //add
                      alpha = 1.0;
-                     dgemm_(&notra,&trans,&dimLup,&dimRup,&dimRdown,&alpha,temp,&dimLup,Lblock,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&notra,&trans,&dimLup,&dimRup,&dimRdown,&alpha,temp,&dimLup,Lblock,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
                   
                   }
                }
@@ -381,11 +388,11 @@ void CheMPS2::Heff::addDiagram3C(const int ikappa, double * memS, double * memHe
                      char notra = 'N';
                      double beta = 0.0; //set
                      double alpha = factor;
-                     dgemm_(&trans,&notra,&dimLup,&dimRdown,&dimLdown,&alpha,Qblock,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,temp,&dimLup);
+                     HeffProfiler::dgemm(&trans,&notra,&dimLup,&dimRdown,&dimLdown,&alpha,Qblock,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,temp,&dimLup);
                   
                      beta = 1.0; //add
                      alpha = 1.0;
-                     dgemm_(&notra,&notra,&dimLup,&dimRup,&dimRdown,&alpha,temp,&dimLup,Lblock,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&notra,&notra,&dimLup,&dimRup,&dimRdown,&alpha,temp,&dimLup,Lblock,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
                   
                   }
                }
@@ -398,6 +405,8 @@ void CheMPS2::Heff::addDiagram3C(const int ikappa, double * memS, double * memHe
 
 void CheMPS2::Heff::addDiagram3Eand3H(const int ikappa, double * memS, double * memHeff, const Sobject * denS) const{ //TwoJ = TwoJdown
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_3E_3H );
+
    int theindex = denS->gIndex();
 
    if (denBK->gIrrep(theindex) != denBK->gIrrep(theindex+1)){ return; }
@@ -475,6 +484,8 @@ void CheMPS2::Heff::addDiagram3Eand3H(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram3Kand3F(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorQ * Qright, TensorL ** Lright, double * temp) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_3K_3F );
+
    int NL = denS->gNL(ikappa);
    int TwoSL = denS->gTwoSL(ikappa);
    int IL = denS->gIL(ikappa);
@@ -503,7 +514,7 @@ void CheMPS2::Heff::addDiagram3Kand3F(const int ikappa, double * memS, double *
                double beta = 1.0; //add
                char notr = 'N';
                double * BlockQ = Qright->gStorage(NR-1,TwoSRdown,IRdown,NR,TwoSR,IR);
-               dgemm_(&notr,&notr,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,BlockQ,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+               HeffProfiler::dgemm(&notr,&notr,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,BlockQ,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
             }
          }
       }
@@ -539,7 +550,7 @@ void CheMPS2::Heff::addDiagram3Kand3F(const int ikappa, double * memS, double *
                         }
                      }
                   
-                     dgemm_(&notr,&notr,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,temp,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                     HeffProfiler::dgemm(&notr,&notr,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,temp,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   }
                }
             }
@@ -565,7 +576,7 @@ void CheMPS2::Heff::addDiagram3Kand3F(const int ikappa, double * memS, double *
                      char notr = 'N';
                      char tran = 'T';
                      double * BlockQ = Qright->gStorage(NR,TwoSR,IR,NR+1,TwoSRdown,IRdown);
-                     dgemm_(&notr,&tran,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,BlockQ,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                     HeffProfiler::dgemm(&notr,&tran,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,BlockQ,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   }
                }
             }
@@ -598,7 +609,7 @@ void CheMPS2::Heff::addDiagram3Kand3F(const int ikappa, double * memS, double *
                   }
                }
             
-               dgemm_(&notr,&tran,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,temp,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+               HeffProfiler::dgemm(&notr,&tran,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,temp,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
             }
          }
       }
@@ -608,6 +619,8 @@ void CheMPS2::Heff::addDiagram3Kand3F(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram3Land3G(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorQ * Qright, TensorL ** Lright, double * temp) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_3L_3G );
+
    int NL = denS->gNL(ikappa);
    int TwoSL = denS->gTwoSL(ikappa);
    int IL = denS->gIL(ikappa);
@@ -636,7 +649,7 @@ void CheMPS2::Heff::addDiagram3Land3G(const int ikappa, double * memS, double *
                double beta = 1.0; //add
                char notr = 'N';
                double * BlockQ = Qright->gStorage(NR-1,TwoSRdown,IRdown,NR,TwoSR,IR);
-               dgemm_(&notr,&notr,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,BlockQ,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+               HeffProfiler::dgemm(&notr,&notr,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,BlockQ,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
             }
          }
       }
@@ -672,7 +685,7 @@ void CheMPS2::Heff::addDiagram3Land3G(const int ikappa, double * memS, double *
                         }
                      }
                   
-                     dgemm_(&notr,&notr,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,temp,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                     HeffProfiler::dgemm(&notr,&notr,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,temp,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   }
                }
             }
@@ -698,7 +711,7 @@ void CheMPS2::Heff::addDiagram3Land3G(const int ikappa, double * memS, double *
                      char notr = 'N';
                      char tran = 'T';
                      double * BlockQ = Qright->gStorage(NR,TwoSR,IR,NR+1,TwoSRdown,IRdown);
-                     dgemm_(&notr,&tran,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,BlockQ,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+                     HeffProfiler::dgemm(&notr,&tran,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,BlockQ,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
                   }
                }
             }
@@ -731,7 +744,7 @@ void CheMPS2::Heff::addDiagram3Land3G(const int ikappa, double * memS, double *
                   }
                }
             
-               dgemm_(&notr,&tran,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,temp,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
+               HeffProfiler::dgemm(&notr,&tran,&dimL,&dimRup,&dimRdown,&factor,memS+denS->gKappa2index(memSkappa),&dimL,temp,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimL);
             }
          }
       }
@@ -741,6 +754,8 @@ void CheMPS2::Heff::addDiagram3Land3G(const int ikappa, double * memS, double *
 
 void CheMPS2::Heff::addDiagram3J(const int ikappa, double * memS, double * memHeff, const Sobject * denS, TensorQ ** Qright, TensorL ** Lleft, double * temp) const{
 
+   HeffProfiler::Probe probe( CHEMPS2_HEFF_3J );
+
    #ifdef CHEMPS2_MPI_COMPILATION
    const int MPIRANK = MPIchemps2::mpi_rank();
    #endif
@@ -789,11 +804,11 @@ void CheMPS2::Heff::addDiagram3J(const int ikappa, double * memS, double * memHe
                      char notra = 'N';
                      double beta = 0.0; //set
                      double alpha = factor;
-                     dgemm_(&notra,&notra,&dimLup,&dimRdown,&dimLdown,&alpha,Lblock,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,temp,&dimLup);
+                     HeffProfiler::dgemm(&notra,&notra,&dimLup,&dimRdown,&dimLdown,&alpha,Lblock,&dimLup,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,temp,&dimLup);
                   
                      beta = 1.0; //add
                      alpha = 1.0;
-                     dgemm_(&notra,&trans,&dimLup,&dimRup,&dimRdown,&alpha,temp,&dimLup,Qblock,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&notra,&trans,&dimLup,&dimRup,&dimRdown,&alpha,temp,&dimLup,Qblock,&dimRup,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
                   
                   }
                }
@@ -830,11 +845,11 @@ void CheMPS2::Heff::addDiagram3J(const int ikappa, double * memS, double * memHe
                      char notra = 'N';
                      double beta = 0.0; //set
                      double alpha = factor;
-                     dgemm_(&trans,&notra,&dimLup,&dimRdown,&dimLdown,&alpha,Lblock,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,temp,&dimLup);
+                     HeffProfiler::dgemm(&trans,&notra,&dimLup,&dimRdown,&dimLdown,&alpha,Lblock,&dimLdown,memS+denS->gKappa2index(memSkappa),&dimLdown,&beta,temp,&dimLup);
                   
                      beta = 1.0; //add
                      alpha = 1.0;
-                     dgemm_(&notra,&notra,&dimLup,&dimRup,&dimRdown,&alpha,temp,&dimLup,Qblock,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
+                     HeffProfiler::dgemm(&notra,&notra,&dimLup,&dimRup,&dimRdown,&alpha,temp,&dimLup,Qblock,&dimRdown,&beta,memHeff+denS->gKappa2index(ikappa),&dimLup);
                   
                   }
                }
@@ -0,0 +1,265 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <assert.h>
+
+#ifdef _OPENMP
+   #include <omp.h>
+#endif
+
+#include "HeffProfiler.h"
+#include "MPIchemps2.h"
+
+using std::cout;
+using std::endl;
+
+bool        CheMPS2::HeffProfiler::active      = false;
+int         CheMPS2::HeffProfiler::num_threads = 0;
+int       * CheMPS2::HeffProfiler::current     = NULL;
+double    * CheMPS2::HeffProfiler::sweep_time  = NULL;
+double    * CheMPS2::HeffProfiler::sweep_flop  = NULL;
+long long * CheMPS2::HeffProfiler::sweep_call  = NULL;
+double    * CheMPS2::HeffProfiler::total_time  = NULL;
+double    * CheMPS2::HeffProfiler::total_flop  = NULL;
+long long * CheMPS2::HeffProfiler::total_call  = NULL;
+
+const char * CheMPS2::HeffProfiler::name( const int diagram ){
+
+   static const char * names[ CHEMPS2_HEFF_NUM_DIAGRAMS ] = { "1A", "1B", "1C", "1D", "Excitations",
+      "2a1spin0", "2a2spin0", "2a1spin1", "2a2spin1", "2a3spin0", "2a3spin1",
+      "2b1and2b2", "2c1and2c2", "2dall", "2e1and2e2", "2f1and2f2",
+      "2b3spin0", "2c3spin0", "2e3spin0", "2f3spin0", "2b3spin1", "2c3spin1", "2e3spin1", "2f3spin1",
+      "3Aand3D", "3Band3I", "3C", "3Eand3H", "3Kand3F", "3Land3G", "3J",
+      "4A1and4A2spin0", "4A1and4A2spin1", "4A3and4A4spin0", "4A3and4A4spin1",
+      "4B1and4B2spin0", "4B1and4B2spin1", "4B3and4B4spin0", "4B3and4B4spin1",
+      "4C1and4C2spin0", "4C1and4C2spin1", "4C3and4C4spin0", "4C3and4C4spin1",
+      "4D", "4E", "4F", "4G", "4H", "4I",
+      "4J1and4J2spin0", "4J1and4J2spin1", "4J3and4J4spin0", "4J3and4J4spin1",
+      "4K1and4K2spin0", "4L1and4L2spin0", "4K1and4K2spin1", "4L1and4L2spin1",
+      "4K3and4K4spin0", "4L3and4L4spin0", "4K3and4K4spin1", "4L3and4L4spin1",
+      "5A", "5B", "5C", "5D", "5E", "5F", "Diagonal" };
+
+   assert( ( diagram >= 0 ) && ( diagram < CHEMPS2_HEFF_NUM_DIAGRAMS ) );
+   return names[ diagram ];
+
+}
+
+void CheMPS2::HeffProfiler::deallocate(){
+
+   if ( current != NULL ){
+      delete [] current;
+      delete [] sweep_time;
+      delete [] sweep_flop;
+      delete [] sweep_call;
+      delete [] total_time;
+      delete [] total_flop;
+      delete [] total_call;
+   }
+   current     = NULL;
+   num_threads = 0;
+
+}
+
+void CheMPS2::HeffProfiler::enable( const bool on ){
+
+   active = false;
+   deallocate();
+   if ( on ){
+      #ifdef _OPENMP
+         num_threads = omp_get_max_threads();
+      #else
+         num_threads = 1;
+      #endif
+      const int size = num_threads * CHEMPS2_HEFF_NUM_DIAGRAMS;
+      current    = new int[ num_threads ];
+      sweep_time = new double[ size ];
+      sweep_flop = new double[ size ];
+      sweep_call = new long long[ size ];
+      total_time = new double[ size ];
+      total_flop = new double[ size ];
+      total_call = new long long[ size ];
+      reset();
+      active = true;
+   }
+
+}
+
+void CheMPS2::HeffProfiler::reset(){
+
+   for ( int thread = 0; thread < num_threads; thread++ ){ current[ thread ] = -1; }
+   for ( int cnt = 0; cnt < num_threads * CHEMPS2_HEFF_NUM_DIAGRAMS; cnt++ ){
+      sweep_time[ cnt ] = 0.0;
+      sweep_flop[ cnt ] = 0.0;
+      sweep_call[ cnt ] = 0;
+      total_time[ cnt ] = 0.0;
+      total_flop[ cnt ] = 0.0;
+      total_call[ cnt ] = 0;
+   }
+
+}
+
+int CheMPS2::HeffProfiler::thread_num(){
+
+   #ifdef _OPENMP
+      const int thread = omp_get_thread_num();
+      return (( thread < num_threads ) ? thread : -1 ); // Threads started after enable() are not profiled
+   #else
+      return 0;
+   #endif
+
+}
+
+void CheMPS2::HeffProfiler::start_probe( const int diagram ){
+
+   const int thread = thread_num();
+   if ( thread < 0 ){ return; }
+   current[ thread ] = diagram;
+
+}
+
+void CheMPS2::HeffProfiler::stop_probe( const int diagram, const double elapsed ){
+
+   const int thread = thread_num();
+   if ( thread < 0 ){ return; }
+   const int ptr = diagram + CHEMPS2_HEFF_NUM_DIAGRAMS * thread;
+   sweep_time[ ptr ] += elapsed;
+   sweep_call[ ptr ] += 1;
+   current[ thread ] = -1;
+
+}
+
+void CheMPS2::HeffProfiler::add_flops( const double flops ){
+
+   const int thread = thread_num();
+   if ( thread < 0 ){ return; }
+   if ( current[ thread ] >= 0 ){
+      sweep_flop[ current[ thread ] + CHEMPS2_HEFF_NUM_DIAGRAMS * thread ] += flops;
+   }
+
+}
+
+void CheMPS2::HeffProfiler::fold_sweep(){
+
+   for ( int cnt = 0; cnt < num_threads * CHEMPS2_HEFF_NUM_DIAGRAMS; cnt++ ){
+      total_time[ cnt ] += sweep_time[ cnt ];
+      total_flop[ cnt ] += sweep_flop[ cnt ];
+      total_call[ cnt ] += sweep_call[ cnt ];
+      sweep_time[ cnt ] = 0.0;
+      sweep_flop[ cnt ] = 0.0;
+      sweep_call[ cnt ] = 0;
+   }
+
+}
+
+void CheMPS2::HeffProfiler::print_sweep_summary(){
+
+   if ( !active ){ return; }
+
+   // Sum over the threads; the call counts are summed as doubles to use a single reduction
+   const int num_diag = CHEMPS2_HEFF_NUM_DIAGRAMS;
+   double * local = new double[ 3 * num_diag ];
+   double * summed = new double[ 3 * num_diag ];
+   for ( int cnt = 0; cnt < 3 * num_diag; cnt++ ){ local[ cnt ] = 0.0; }
+   for ( int thread = 0; thread < num_threads; thread++ ){
+      for ( int diagram = 0; diagram < num_diag; diagram++ ){
+         const int ptr = diagram + num_diag * thread;
+         local[ diagram                ] += sweep_time[ ptr ];
+         local[ diagram +     num_diag ] += sweep_flop[ ptr ];
+         local[ diagram + 2 * num_diag ] += sweep_call[ ptr ];
+      }
+   }
+   #ifdef CHEMPS2_MPI_COMPILATION
+      MPIchemps2::reduce_array_double( local, summed, 3 * num_diag, MPI_CHEMPS2_MASTER );
+      const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
+   #else
+      for ( int cnt = 0; cnt < 3 * num_diag; cnt++ ){ summed[ cnt ] = local[ cnt ]; }
+      const bool am_i_master = true;
+   #endif
+
+   if ( am_i_master ){
+      int * order = new int[ num_diag ];
+      double total = 0.0;
+      for ( int diagram = 0; diagram < num_diag; diagram++ ){
+         order[ diagram ] = diagram;
+         total += summed[ diagram ];
+      }
+      for ( int i = 1; i < num_diag; i++ ){ // Insertion sort on decreasing time
+         const int key = order[ i ];
+         int j = i - 1;
+         while (( j >= 0 ) && ( summed[ order[ j ] ] < summed[ key ] )){
+            order[ j + 1 ] = order[ j ];
+            j--;
+         }
+         order[ j + 1 ] = key;
+      }
+      cout << "***     Heff diagrams (summed over " << num_threads << " threads and " << MPIchemps2::mpi_size() << " processes):" << endl;
+      cout << "***       diagram           time (s)  time (%)         calls      GFLOP  GFLOP/s" << endl;
+      char buffer[ 256 ];
+      for ( int i = 0; i < num_diag; i++ ){
+         const int diagram = order[ i ];
+         if ( summed[ diagram + 2 * num_diag ] > 0.5 ){
+            const double gflop = 1e-9 * summed[ diagram + num_diag ];
+            snprintf( buffer, 256, "***       %-16s %9.3f %9.2f %13.0f %10.3f %8.3f", name( diagram ), summed[ diagram ],
+                      (( total > 0.0 ) ? 100 * summed[ diagram ] / total : 0.0 ), summed[ diagram + 2 * num_diag ], gflop,
+                      (( summed[ diagram ] > 0.0 ) ? gflop / summed[ diagram ] : 0.0 ));
+            cout << buffer << endl;
+         }
+      }
+      delete [] order;
+   }
+
+   delete [] local;
+   delete [] summed;
+   fold_sweep();
+
+}
+
+void CheMPS2::HeffProfiler::dump( const std::string filename ){
+
+   if ( !active ){ return; }
+
+   const int rank = MPIchemps2::mpi_rank();
+   std::stringstream thefilename;
+   thefilename << filename;
+   #ifdef CHEMPS2_MPI_COMPILATION
+      thefilename << "." << rank;
+   #endif
+
+   std::ofstream output( thefilename.str().c_str(), std::ios::out | std::ios::trunc );
+   output.precision( 12 );
+   output << "rank,thread,diagram,calls,seconds,flops" << endl;
+   for ( int thread = 0; thread < num_threads; thread++ ){
+      for ( int diagram = 0; diagram < CHEMPS2_HEFF_NUM_DIAGRAMS; diagram++ ){
+         const int ptr = diagram + CHEMPS2_HEFF_NUM_DIAGRAMS * thread;
+         const long long calls = total_call[ ptr ] + sweep_call[ ptr ];
+         if ( calls > 0 ){
+            output << rank << "," << thread << "," << name( diagram ) << "," << calls << ","
+                   << total_time[ ptr ] + sweep_time[ ptr ] << "," << total_flop[ ptr ] + sweep_flop[ ptr ] << endl;
+         }
+      }
+   }
+   output.close();
+
+}
@@ -0,0 +1,185 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/resource.h>
+
+#include "SweepLog.h"
+
+CheMPS2::SweepLog::SweepLog( const std::string filename, const bool append ){
+
+   output   = new std::ofstream( filename.c_str(), ( append ? std::ios::app : std::ios::trunc ) | std::ios::out );
+   callback = NULL;
+   userdata = NULL;
+   assert( output->is_open() );
+   record.precision( 15 );
+   gettimeofday( &creation, NULL );
+
+}
+
+CheMPS2::SweepLog::SweepLog( void (*callback)( const char * record, void * userdata ), void * userdata ){
+
+   assert( callback != NULL );
+   output         = NULL;
+   this->callback = callback;
+   this->userdata = userdata;
+   record.precision( 15 );
+   gettimeofday( &creation, NULL );
+
+}
+
+CheMPS2::SweepLog::~SweepLog(){
+
+   if ( output != NULL ){
+      output->close();
+      delete output;
+   }
+
+}
+
+void CheMPS2::SweepLog::start( const std::string event ){
+
+   struct timeval now;
+   gettimeofday( &now, NULL );
+   const double elapsed = ( now.tv_sec - creation.tv_sec ) + 1e-6 * ( now.tv_usec - creation.tv_usec );
+
+   record.str( "" );
+   record << "{\"event\":\"" << event << "\"";
+   add( "time", elapsed );
+
+}
+
+void CheMPS2::SweepLog::add_key( const std::string key ){
+
+   record << ",\"" << key << "\":";
+
+}
+
+void CheMPS2::SweepLog::add( const std::string key, const long long value ){
+
+   add_key( key );
+   record << value;
+
+}
+
+void CheMPS2::SweepLog::add( const std::string key, const double value ){
+
+   add_key( key );
+   if (( isnan( value ) ) || ( isinf( value ) )){
+      record << "null"; // JSON has no representation for nan and inf
+   } else {
+      record << value;
+   }
+
+}
+
+void CheMPS2::SweepLog::add( const std::string key, const std::string value ){
+
+   add_key( key );
+   record << "\"";
+   for ( unsigned int pos = 0; pos < value.length(); pos++ ){
+      const char letter = value[ pos ];
+      if (( letter == '"' ) || ( letter == '\\' )){ record << '\\' << letter; }
+      else if ( letter == '\n' ){ record << "\\n"; }
+      else if (( unsigned char )( letter ) >= 0x20 ){ record << letter; }
+   }
+   record << "\"";
+
+}
+
+void CheMPS2::SweepLog::add_boolean( const std::string key, const bool value ){
+
+   add_key( key );
+   record << (( value ) ? "true" : "false" );
+
+}
+
+void CheMPS2::SweepLog::add( const std::string key, const int * values, const int num ){
+
+   add_key( key );
+   record << "[";
+   for ( int cnt = 0; cnt < num; cnt++ ){
+      if ( cnt > 0 ){ record << ","; }
+      record << values[ cnt ];
+   }
+   record << "]";
+
+}
+
+void CheMPS2::SweepLog::write(){
+
+   record << "}";
+   if ( output != NULL ){
+      ( *output ) << record.str() << "\n";
+      output->flush();
+   } else {
+      const std::string result = record.str();
+      callback( result.c_str(), userdata );
+   }
+   record.str( "" );
+
+}
+
+long long CheMPS2::SweepLog::rss_kb(){
+
+   FILE * statm = fopen( "/proc/self/statm", "r" );
+   if ( statm == NULL ){ return -1; }
+   long long total_pages = 0;
+   long long resident_pages = 0;
+   const int num_read = fscanf( statm, "%lld %lld", &total_pages, &resident_pages );
+   fclose( statm );
+   if ( num_read != 2 ){ return -1; }
+   return ( resident_pages * sysconf( _SC_PAGESIZE ) ) / 1024;
+
+}
+
+long long CheMPS2::SweepLog::peak_rss_kb(){
+
+   struct rusage usage;
+   if ( getrusage( RUSAGE_SELF, &usage ) != 0 ){ return -1; }
+   #ifdef __APPLE__
+      return usage.ru_maxrss / 1024; // bytes on OS X
+   #else
+      return usage.ru_maxrss;        // kilobytes on Linux
+   #endif
+
+}
+
+long long CheMPS2::SweepLog::io_bytes(){
+
+   FILE * io = fopen( "/proc/self/io", "r" );
+   if ( io == NULL ){ return -1; }
+   long long rchar = -1;
+   long long wchar = -1;
+   char field[ 64 ];
+   long long value;
+   while ( fscanf( io, "%63s %lld", field, &value ) == 2 ){
+      if ( strcmp( field, "rchar:" ) == 0 ){ rchar = value; }
+      if ( strcmp( field, "wchar:" ) == 0 ){ wchar = value; }
+   }
+   fclose( io );
+   if (( rchar < 0 ) || ( wchar < 0 )){ return -1; }
+   return rchar + wchar;
+
+}
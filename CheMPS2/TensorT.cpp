@@ -20,6 +20,7 @@
 #include <stdlib.h> /*rand*/
 #include <algorithm>
 #include <math.h>
+#include <assert.h>
 
 #include "TensorT.h"
 #include "Lapack.h"
@@ -185,6 +186,49 @@ void CheMPS2::TensorT::number_operator( const double alpha, const double beta ){
 
 }
 
+void CheMPS2::TensorT::number_operator_sum( const TensorT * original, const double fock, const double alpha, const double beta ){
+
+   // The left and right virtual indices are ( l + dimL_orig * s ) and ( r + dimR_orig * t ), with s, t = 0 if the number operators have not been applied yet and 1 if they have
+   const bool first_site = ( index == 0 );
+   const bool last_site  = ( index == denBK->gL() - 1 );
+   const int num_left    = (( first_site ) ? 1 : 2 );
+   const int num_right   = (( last_site  ) ? 1 : 2 );
+
+   #pragma omp parallel for schedule(dynamic)
+   for ( int ikappa = 0; ikappa < nKappa; ikappa++ ){
+      double * block = storage + kappa2index[ ikappa ];
+      const int size = kappa2index[ ikappa + 1 ] - kappa2index[ ikappa ];
+      for ( int cnt = 0; cnt < size; cnt++ ){ block[ cnt ] = 0.0; }
+
+      const int kappa_orig = original->gKappa( sectorNL[ ikappa ], sectorTwoSL[ ikappa ], sectorIL[ ikappa ], sectorNR[ ikappa ], sectorTwoSR[ ikappa ], sectorIR[ ikappa ] );
+      if ( kappa_orig != -1 ){
+         const double * orig = original->storage + original->kappa2index[ kappa_orig ];
+         const int dimL      = denBK->gCurrentDim( index,     sectorNL[ ikappa ], sectorTwoSL[ ikappa ], sectorIL[ ikappa ] );
+         const int dimL_orig = original->denBK->gCurrentDim( index,     sectorNL[ ikappa ], sectorTwoSL[ ikappa ], sectorIL[ ikappa ] );
+         const int dimR_orig = original->denBK->gCurrentDim( index + 1, sectorNR[ ikappa ], sectorTwoSR[ ikappa ], sectorIR[ ikappa ] );
+         assert( dimL == num_left  * dimL_orig );
+         assert( denBK->gCurrentDim( index + 1, sectorNR[ ikappa ], sectorTwoSR[ ikappa ], sectorIR[ ikappa ] ) == num_right * dimR_orig );
+         const double number = fock * ( sectorNR[ ikappa ] - sectorNL[ ikappa ] );
+
+         for ( int s = 0; s < num_left; s++ ){
+            for ( int t = 0; t < num_right; t++ ){
+               double factor = 0.0;
+               if ( last_site ){ factor = (( s == 0 ) ? ( beta + alpha * number ) : alpha ); }
+               else { factor = (( s == t ) ? 1.0 : (( s == 0 ) ? number : 0.0 )); }
+               if ( factor != 0.0 ){
+                  for ( int r = 0; r < dimR_orig; r++ ){
+                     for ( int l = 0; l < dimL_orig; l++ ){
+                        block[ l + dimL_orig * s + dimL * ( r + dimR_orig * t ) ] = factor * orig[ l + dimL_orig * r ];
+                     }
+                  }
+               }
+            }
+         }
+      }
+   }
+
+}
+
 void CheMPS2::TensorT::QR(Tensor * Rstorage){
 
    //Left normalization occurs in T-convention: no pre or after multiplication
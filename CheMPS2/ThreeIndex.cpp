@@ -0,0 +1,365 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <iostream>
+#include <string>
+
+#include "ThreeIndex.h"
+#include "Lapack.h"
+#include "MyHDF5.h"
+#include "MPIchemps2.h"
+
+using namespace std;
+
+CheMPS2::ThreeIndex::ThreeIndex( const int nGroup, const int * IrrepSizes, const int * NumVectors ){
+
+   SymmInfo.setGroup( nGroup );
+
+   const int num_irreps = SymmInfo.getNumberOfIrreps();
+   Isizes   = new int[ num_irreps ];
+   Nvectors = new int[ num_irreps ];
+   for ( int irrep = 0; irrep < num_irreps; irrep++ ){
+      Isizes[ irrep ]   = IrrepSizes[ irrep ];
+      Nvectors[ irrep ] = NumVectors[ irrep ];
+   }
+
+   allocate();
+   Clear();
+
+}
+
+CheMPS2::ThreeIndex::ThreeIndex( const int nGroup, const FourIndex * VMAT, const double threshold ){
+
+   SymmInfo.setGroup( nGroup );
+
+   const int num_irreps = SymmInfo.getNumberOfIrreps();
+   Isizes   = new int[ num_irreps ];
+   Nvectors = new int[ num_irreps ];
+   for ( int irrep = 0; irrep < num_irreps; irrep++ ){ Isizes[ irrep ] = VMAT->get_irrep_size( irrep ); }
+
+   /* For each irrep I_P, the matrix ( i j | k l ) with I_i x I_j = I_k x I_l = I_P is decomposed
+      with a pivoted Cholesky decomposition; the pairs (ij) are ordered as in the storage blocks */
+   double *** vectors = new double**[ num_irreps ];
+   int * jumps = new int[ num_irreps + 1 ];
+   for ( int irrep_P = 0; irrep_P < num_irreps; irrep_P++ ){
+
+      jumps[ 0 ] = 0;
+      for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
+         jumps[ irrep_i + 1 ] = jumps[ irrep_i ] + Isizes[ irrep_i ] * Isizes[ Irreps::directProd( irrep_i, irrep_P ) ];
+      }
+      const int num_pairs = jumps[ num_irreps ];
+      int * pair_irrep = new int[ num_pairs ];
+      int * pair_i     = new int[ num_pairs ];
+      int * pair_j     = new int[ num_pairs ];
+      double * diag    = new double[ num_pairs ];
+      for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
+         const int irrep_j = Irreps::directProd( irrep_i, irrep_P );
+         for ( int j = 0; j < Isizes[ irrep_j ]; j++ ){
+            for ( int i = 0; i < Isizes[ irrep_i ]; i++ ){
+               const int pair = jumps[ irrep_i ] + i + Isizes[ irrep_i ] * j;
+               pair_irrep[ pair ] = irrep_i;
+               pair_i[ pair ] = i;
+               pair_j[ pair ] = j;
+               diag[ pair ] = VMAT->get( irrep_i, irrep_i, irrep_j, irrep_j, i, i, j, j ); // ( i j | i j )
+            }
+         }
+      }
+
+      vectors[ irrep_P ] = new double*[ num_pairs ];
+      int num_vectors = 0;
+      while ( num_vectors < num_pairs ){
+
+         int pivot = 0;
+         for ( int pair = 1; pair < num_pairs; pair++ ){
+            if ( diag[ pair ] > diag[ pivot ] ){ pivot = pair; }
+         }
+         if ( diag[ pivot ] < threshold ){ break; }
+
+         // column = ( ( . . | k l ) - sum_P B^P B^P_kl ) / sqrt( ( k l | k l ) - sum_P B^P_kl B^P_kl )
+         const int irrep_k = pair_irrep[ pivot ];
+         const int irrep_l = Irreps::directProd( irrep_k, irrep_P );
+         const int k = pair_i[ pivot ];
+         const int l = pair_j[ pivot ];
+         double * column = new double[ num_pairs ];
+         #pragma omp parallel for schedule(static)
+         for ( int pair = 0; pair < num_pairs; pair++ ){
+            const int irrep_i = pair_irrep[ pair ];
+            const int irrep_j = Irreps::directProd( irrep_i, irrep_P );
+            column[ pair ] = VMAT->get( irrep_i, irrep_k, irrep_j, irrep_l, pair_i[ pair ], k, pair_j[ pair ], l ); // ( i j | k l )
+         }
+         int inc1 = 1;
+         int num_pairs_copy = num_pairs;
+         for ( int vec = 0; vec < num_vectors; vec++ ){
+            double alpha = - vectors[ irrep_P ][ vec ][ pivot ];
+            daxpy_( &num_pairs_copy, &alpha, vectors[ irrep_P ][ vec ], &inc1, column, &inc1 );
+         }
+         double prefactor = 1.0 / sqrt( diag[ pivot ] );
+         dscal_( &num_pairs_copy, &prefactor, column, &inc1 );
+         for ( int pair = 0; pair < num_pairs; pair++ ){ diag[ pair ] -= column[ pair ] * column[ pair ]; }
+         diag[ pivot ] = 0.0;
+         vectors[ irrep_P ][ num_vectors ] = column;
+         num_vectors++;
+
+      }
+      Nvectors[ irrep_P ] = num_vectors;
+
+      delete [] pair_irrep;
+      delete [] pair_i;
+      delete [] pair_j;
+      delete [] diag;
+
+   }
+
+   allocate();
+
+   for ( int irrep_P = 0; irrep_P < num_irreps; irrep_P++ ){
+      jumps[ 0 ] = 0;
+      for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
+         const int irrep_j = Irreps::directProd( irrep_i, irrep_P );
+         const int size_ij = Isizes[ irrep_i ] * Isizes[ irrep_j ];
+         jumps[ irrep_i + 1 ] = jumps[ irrep_i ] + size_ij;
+         for ( int vec = 0; vec < Nvectors[ irrep_P ]; vec++ ){
+            for ( int ij = 0; ij < size_ij; ij++ ){
+               storage[ irrep_P ][ irrep_i ][ ij + size_ij * vec ] = vectors[ irrep_P ][ vec ][ jumps[ irrep_i ] + ij ];
+            }
+         }
+      }
+      for ( int vec = 0; vec < Nvectors[ irrep_P ]; vec++ ){ delete [] vectors[ irrep_P ][ vec ]; }
+      delete [] vectors[ irrep_P ];
+   }
+   delete [] vectors;
+   delete [] jumps;
+
+   int total = 0;
+   for ( int irrep_P = 0; irrep_P < num_irreps; irrep_P++ ){ total += Nvectors[ irrep_P ]; }
+   #ifdef CHEMPS2_MPI_COMPILATION
+      const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
+   #else
+      const bool am_i_master = true;
+   #endif
+   if ( am_i_master ){
+      cout << "ThreeIndex::ThreeIndex : Number of Cholesky vectors = " << total << " ; storage = " << arrayLength << " doubles." << endl;
+   }
+
+}
+
+void CheMPS2::ThreeIndex::allocate(){
+
+   const int num_irreps = SymmInfo.getNumberOfIrreps();
+
+   arrayLength = 0;
+   for ( int irrep_P = 0; irrep_P < num_irreps; irrep_P++ ){
+      for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
+         const int irrep_j = Irreps::directProd( irrep_i, irrep_P );
+         arrayLength += ((long long) Isizes[ irrep_i ] ) * Isizes[ irrep_j ] * Nvectors[ irrep_P ];
+      }
+   }
+   theElements = new double[ arrayLength ];
+
+   long long jump = 0;
+   storage = new double**[ num_irreps ];
+   for ( int irrep_P = 0; irrep_P < num_irreps; irrep_P++ ){
+      storage[ irrep_P ] = new double*[ num_irreps ];
+      for ( int irrep_i = 0; irrep_i < num_irreps; irrep_i++ ){
+         const int irrep_j = Irreps::directProd( irrep_i, irrep_P );
+         storage[ irrep_P ][ irrep_i ] = theElements + jump;
+         jump += ((long long) Isizes[ irrep_i ] ) * Isizes[ irrep_j ] * Nvectors[ irrep_P ];
+      }
+   }
+   assert( jump == arrayLength );
+
+}
+
+CheMPS2::ThreeIndex::~ThreeIndex(){
+
+   for ( int irrep_P = 0; irrep_P < SymmInfo.getNumberOfIrreps(); irrep_P++ ){ delete [] storage[ irrep_P ]; }
+   delete [] storage;
+   delete [] theElements;
+   delete [] Isizes;
+   delete [] Nvectors;
+
+}
+
+void CheMPS2::ThreeIndex::Clear(){
+
+   for ( long long count = 0; count < arrayLength; count++ ){ theElements[ count ] = 0.0; }
+
+}
+
+int CheMPS2::ThreeIndex::getNGroup() const{ return SymmInfo.getGroupNumber(); }
+
+int CheMPS2::ThreeIndex::get_irrep_size( const int irrep ) const{ return Isizes[ irrep ]; }
+
+int CheMPS2::ThreeIndex::get_num_vectors( const int irrep ) const{ return Nvectors[ irrep ]; }
+
+double * CheMPS2::ThreeIndex::getBlock( const int irrep_i, const int irrep_j ) const{
+
+   return storage[ Irreps::directProd( irrep_i, irrep_j ) ][ irrep_i ];
+
+}
+
+double CheMPS2::ThreeIndex::get( const int irrep_i, const int irrep_j, const int irrep_k, const int irrep_l, const int i, const int j, const int k, const int l ) const{
+
+   // V_ijkl = ( i k | j l )
+   const int irrep_P = Irreps::directProd( irrep_i, irrep_k );
+   if ( Irreps::directProd( irrep_j, irrep_l ) != irrep_P ){ return 0.0; }
+
+   const int size_ik = Isizes[ irrep_i ] * Isizes[ irrep_k ];
+   const int size_jl = Isizes[ irrep_j ] * Isizes[ irrep_l ];
+   const double * left  = storage[ irrep_P ][ irrep_i ] + i + Isizes[ irrep_i ] * k;
+   const double * right = storage[ irrep_P ][ irrep_j ] + j + Isizes[ irrep_j ] * l;
+   double value = 0.0;
+   for ( int vec = 0; vec < Nvectors[ irrep_P ]; vec++ ){
+      value += left[ size_ik * vec ] * right[ size_jl * vec ];
+   }
+   return value;
+
+}
+
+void CheMPS2::ThreeIndex::save( const std::string name ) const{
+
+   const int num_irreps = SymmInfo.getNumberOfIrreps();
+
+   //The hdf5 file
+   hid_t file_id = H5Fcreate( name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
+
+      //The metadata
+      hid_t group_id = H5Gcreate( file_id, "/MetaData", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+
+         //The IrrepSizes
+         hsize_t dimarray       = num_irreps;
+         hid_t dataspace_id     = H5Screate_simple( 1, &dimarray, NULL );
+         hid_t dataset_id       = H5Dcreate( group_id, "IrrepSizes", H5T_STD_I32LE, dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+         H5Dwrite( dataset_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, Isizes );
+
+            //Attributes
+            hid_t attribute_space_id1  = H5Screate( H5S_SCALAR );
+            hid_t attribute_id1        = H5Acreate( dataset_id, "nGroup", H5T_STD_I32LE, attribute_space_id1, H5P_DEFAULT, H5P_DEFAULT );
+            int nGroup                 = SymmInfo.getGroupNumber();
+            H5Awrite( attribute_id1, H5T_NATIVE_INT, &nGroup );
+
+            hid_t attribute_space_id2  = H5Screate( H5S_SCALAR );
+            hid_t attribute_id2        = H5Acreate( dataset_id, "nIrreps", H5T_STD_I32LE, attribute_space_id2, H5P_DEFAULT, H5P_DEFAULT );
+            int nIrreps                = num_irreps;
+            H5Awrite( attribute_id2, H5T_NATIVE_INT, &nIrreps );
+
+            H5Aclose( attribute_id1 );
+            H5Aclose( attribute_id2 );
+            H5Sclose( attribute_space_id1 );
+            H5Sclose( attribute_space_id2 );
+
+         H5Dclose( dataset_id );
+         H5Sclose( dataspace_id );
+
+         //The NumVectors
+         hid_t dataspace_id2    = H5Screate_simple( 1, &dimarray, NULL );
+         hid_t dataset_id2      = H5Dcreate( group_id, "NumVectors", H5T_STD_I32LE, dataspace_id2, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+         H5Dwrite( dataset_id2, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, Nvectors );
+         H5Dclose( dataset_id2 );
+         H5Sclose( dataspace_id2 );
+
+      H5Gclose( group_id );
+
+      //The object itself
+      hid_t group_id3 = H5Gcreate( file_id, "/ThreeIndexObject", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+
+         hsize_t dimarray3       = arrayLength;
+         hid_t dataspace_id3     = H5Screate_simple( 1, &dimarray3, NULL );
+         hid_t dataset_id3       = H5Dcreate( group_id3, "Vectors", H5T_IEEE_F64LE, dataspace_id3, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+         H5Dwrite( dataset_id3, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, theElements );
+
+         H5Dclose( dataset_id3 );
+         H5Sclose( dataspace_id3 );
+
+      H5Gclose( group_id3 );
+
+   H5Fclose( file_id );
+
+}
+
+void CheMPS2::ThreeIndex::read_num_vectors( const std::string name, int * NumVectors ){
+
+   hid_t file_id    = H5Fopen( name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+   hid_t group_id   = H5Gopen( file_id, "/MetaData", H5P_DEFAULT );
+   hid_t dataset_id = H5Dopen( group_id, "NumVectors", H5P_DEFAULT );
+   H5Dread( dataset_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, NumVectors );
+   H5Dclose( dataset_id );
+   H5Gclose( group_id );
+   H5Fclose( file_id );
+
+}
+
+void CheMPS2::ThreeIndex::read( const std::string name ){
+
+   const int num_irreps = SymmInfo.getNumberOfIrreps();
+
+   //The hdf5 file
+   hid_t file_id = H5Fopen( name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+
+      //The metadata
+      hid_t group_id = H5Gopen( file_id, "/MetaData", H5P_DEFAULT );
+
+         //The IrrepSizes
+         hid_t dataset_id = H5Dopen( group_id, "IrrepSizes", H5P_DEFAULT );
+
+            //Attributes
+            hid_t attribute_id1 = H5Aopen_by_name( group_id, "IrrepSizes", "nGroup", H5P_DEFAULT, H5P_DEFAULT );
+            int nGroup;
+            H5Aread( attribute_id1, H5T_NATIVE_INT, &nGroup );
+            assert( nGroup == SymmInfo.getGroupNumber() );
+
+            hid_t attribute_id2 = H5Aopen_by_name( group_id, "IrrepSizes", "nIrreps", H5P_DEFAULT, H5P_DEFAULT );
+            int nIrreps;
+            H5Aread( attribute_id2, H5T_NATIVE_INT, &nIrreps );
+            assert( nIrreps == num_irreps );
+
+            H5Aclose( attribute_id1 );
+            H5Aclose( attribute_id2 );
+
+         int * IsizesAgain = new int[ num_irreps ];
+         H5Dread( dataset_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, IsizesAgain );
+         for ( int irrep = 0; irrep < num_irreps; irrep++ ){ assert( IsizesAgain[ irrep ] == Isizes[ irrep ] ); }
+         H5Dclose( dataset_id );
+
+         //The NumVectors
+         hid_t dataset_id2 = H5Dopen( group_id, "NumVectors", H5P_DEFAULT );
+         H5Dread( dataset_id2, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, IsizesAgain );
+         for ( int irrep = 0; irrep < num_irreps; irrep++ ){ assert( IsizesAgain[ irrep ] == Nvectors[ irrep ] ); }
+         H5Dclose( dataset_id2 );
+         delete [] IsizesAgain;
+
+      H5Gclose( group_id );
+
+      std::cout << "ThreeIndex::read : loading " << arrayLength << " doubles." << std::endl;
+
+      //The object itself
+      hid_t group_id3 = H5Gopen( file_id, "/ThreeIndexObject", H5P_DEFAULT );
+
+         hid_t dataset_id3 = H5Dopen( group_id3, "Vectors", H5P_DEFAULT );
+         H5Dread( dataset_id3, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, theElements );
+         H5Dclose( dataset_id3 );
+
+      H5Gclose( group_id3 );
+
+   H5Fclose( file_id );
+
+}
@@ -0,0 +1,134 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <sys/time.h>
+
+#ifdef _OPENMP
+   #include <omp.h>
+#endif
+
+#include "Tracer.h"
+#include "MPIchemps2.h"
+
+bool                      CheMPS2::Tracer::active      = false;
+std::string               CheMPS2::Tracer::filename    = "";
+long long                 CheMPS2::Tracer::reference   = 0;
+int                       CheMPS2::Tracer::num_threads = 0;
+CheMPS2::Tracer::Event ** CheMPS2::Tracer::events      = NULL;
+int                     * CheMPS2::Tracer::num_events  = NULL;
+int                     * CheMPS2::Tracer::size_events = NULL;
+
+long long CheMPS2::Tracer::now(){
+
+   struct timeval current;
+   gettimeofday( &current, NULL );
+   return ( ( long long ) current.tv_sec ) * 1000000 + current.tv_usec;
+
+}
+
+void CheMPS2::Tracer::start( const std::string filename_in ){
+
+   if ( active ){ stop(); }
+
+   #ifdef _OPENMP
+      num_threads = omp_get_max_threads();
+   #else
+      num_threads = 1;
+   #endif
+
+   filename    = filename_in;
+   events      = new Event*[ num_threads ];
+   num_events  = new int[ num_threads ];
+   size_events = new int[ num_threads ];
+   for ( int thread = 0; thread < num_threads; thread++ ){
+      size_events[ thread ] = 4096;
+      num_events [ thread ] = 0;
+      events     [ thread ] = new Event[ size_events[ thread ] ];
+   }
+   reference = now();
+   active    = true;
+
+}
+
+void CheMPS2::Tracer::record( const char * name, const char * category, const char phase ){
+
+   #ifdef _OPENMP
+      const int thread = omp_get_thread_num();
+      if ( thread >= num_threads ){ return; } // Nested parallelism is not traced
+   #else
+      const int thread = 0;
+   #endif
+
+   if ( num_events[ thread ] == size_events[ thread ] ){
+      Event * larger = new Event[ 2 * size_events[ thread ] ];
+      memcpy( larger, events[ thread ], sizeof( Event ) * size_events[ thread ] );
+      delete [] events[ thread ];
+      events[ thread ] = larger;
+      size_events[ thread ] *= 2;
+   }
+
+   Event * current   = events[ thread ] + num_events[ thread ];
+   current->name     = name;
+   current->category = category;
+   current->phase    = phase;
+   current->time     = now() - reference;
+   num_events[ thread ] += 1;
+
+}
+
+void CheMPS2::Tracer::stop(){
+
+   if ( !active ){ return; }
+   active = false;
+
+   const int rank = MPIchemps2::mpi_rank();
+   std::stringstream thefilename;
+   thefilename << filename;
+   #ifdef CHEMPS2_MPI_COMPILATION
+      thefilename << "." << rank;
+   #endif
+
+   std::ofstream output( thefilename.str().c_str(), std::ios::out | std::ios::trunc );
+   output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+   output << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank << ",\"tid\":0,\"args\":{\"name\":\"MPI rank " << rank << "\"}}";
+   for ( int thread = 0; thread < num_threads; thread++ ){
+      output << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << rank << ",\"tid\":" << thread << ",\"args\":{\"name\":\"OpenMP thread " << thread << "\"}}";
+      for ( int cnt = 0; cnt < num_events[ thread ]; cnt++ ){
+         const Event * current = events[ thread ] + cnt;
+         output << ",\n{\"name\":\"" << current->name << "\",\"cat\":\"" << current->category << "\",\"ph\":\"" << current->phase
+                << "\",\"ts\":" << current->time << ",\"pid\":" << rank << ",\"tid\":" << thread << "}";
+      }
+      delete [] events[ thread ];
+   }
+   output << "\n]}" << std::endl;
+   output.close();
+
+   delete [] events;
+   delete [] num_events;
+   delete [] size_events;
+   events      = NULL;
+   num_events  = NULL;
+   size_events = NULL;
+   num_threads = 0;
+
+}
@@ -0,0 +1,731 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <assert.h>
+#include <sys/time.h>
+
+#ifdef _OPENMP
+   #include <omp.h>
+#endif
+
+#ifdef CHEMPS2_BENCH_COUNT_FLOPS
+   #include <dlfcn.h>
+#endif
+
+#include "Initialize.h"
+#include "Hamiltonian.h"
+#include "Problem.h"
+#include "ConvergenceScheme.h"
+#include "DMRG.h"
+#include "Heff.h"
+#include "Sobject.h"
+#include "TensorT.h"
+#include "TensorOperator.h"
+#include "FCI.h"
+#include "CASPT2.h"
+#include "DMRGSCFindices.h"
+#include "DMRGSCFintegrals.h"
+#include "DMRGSCFmatrix.h"
+#include "DMRGSCFunitary.h"
+#include "DMRGSCFrotations.h"
+#include "Irreps.h"
+#include "Lapack.h"
+#include "MPIchemps2.h"
+#include "Options.h"
+
+using namespace std;
+
+/*********************************************************************************
+*  All dgemm calls of the library are counted by interposing dgemm_, so that the *
+*  throughput of each kernel can be reported in GFLOP/s. Only available when the *
+*  library and BLAS are shared objects (see CheMPS2/CMakeLists.txt).             *
+*********************************************************************************/
+
+#ifdef CHEMPS2_BENCH_COUNT_FLOPS
+
+typedef void ( *dgemm_pointer )( char *, char *, int *, int *, int *, double *, double *, int *, double *, int *, double *, double *, int * );
+
+static dgemm_pointer blas_dgemm = NULL;
+static double dgemm_flops = 0.0;
+
+extern "C" void dgemm_( char * transA, char * transB, int * m, int * n, int * k, double * alpha, double * A, int * lda, double * B, int * ldb, double * beta, double * C, int * ldc ){
+
+   const double flops = 2.0 * ( *m ) * ( *n ) * ( *k );
+   #pragma omp atomic
+   dgemm_flops += flops;
+   blas_dgemm( transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc );
+
+}
+
+#endif
+
+double counted_flops(){
+
+   #ifdef CHEMPS2_BENCH_COUNT_FLOPS
+      return dgemm_flops;
+   #else
+      return 0.0;
+   #endif
+
+}
+
+double wall_time(){
+
+   struct timeval now;
+   gettimeofday( &now, NULL );
+   return now.tv_sec + 1e-6 * now.tv_usec;
+
+}
+
+namespace CheMPS2{
+/** Benchmark class.
+    \date October 18, 2026
+
+    The Benchmark class times the individual kernels of DMRG, FCI, DMRG-SCF and CASPT2 on synthetic Hamiltonians. It is a friend of DMRG, Heff and CASPT2 so that their private kernels can be called in isolation. */
+   class Benchmark{
+
+      public:
+
+         //! Constructor
+         /** \param repeat The number of times each kernel is timed
+             \param report The stream to which the timings are written */
+         Benchmark( const int repeat, ostream * report ){
+            this->repeat = repeat;
+            this->report = report;
+            num_calls = 0;
+            sum_time  = 0.0;
+            sum_flops = 0.0;
+         }
+
+         //! Time the DMRG kernels at the middle of the chain, after a few sweeps to grow the bond dimension
+         /** \param prob The problem to be solved
+             \param D The reduced virtual dimension
+             \param sweeps The maximum number of sweeps before the kernels are timed */
+         void dmrg( Problem * prob, const int D, const int sweeps );
+
+         //! Time the FCI, DMRG-SCF rotation, and CASPT2 kernels. The orbitals of each irrep are split into a quarter core, half active, and a quarter virtual orbitals.
+         /** \param ham The Hamiltonian
+             \param N The total number of electrons
+             \param TwoS Twice the spin
+             \param irrep The target irrep */
+         void caspt2( Hamiltonian * ham, const int N, const int TwoS, const int irrep );
+
+         //! Time dgemm on square matrices, as a reference for the other throughputs
+         /** \param dim The linear dimension of the matrices */
+         void reference( const int dim );
+
+         //! Print the header of the table
+         void header() const;
+
+      private:
+
+         int repeat;
+
+         ostream * report;
+
+         double start_time;
+
+         double start_flops;
+
+         double min_time;
+
+         double sum_time;
+
+         double sum_flops;
+
+         int num_calls;
+
+         void start();
+
+         void stop();
+
+         void print( const string name );
+
+   };
+}
+
+void CheMPS2::Benchmark::start(){
+
+   start_flops = counted_flops();
+   start_time  = wall_time();
+
+}
+
+void CheMPS2::Benchmark::stop(){
+
+   const double elapsed = wall_time() - start_time;
+   sum_flops += counted_flops() - start_flops;
+   sum_time  += elapsed;
+   min_time   = (( num_calls == 0 ) ? elapsed : min( min_time, elapsed ));
+   num_calls += 1;
+
+}
+
+void CheMPS2::Benchmark::header() const{
+
+   ( *report ) << "   kernel                        calls    min (s)    avg (s)    GFLOP/s" << endl;
+   ( *report ) << "   ---------------------------------------------------------------------" << endl;
+
+}
+
+void CheMPS2::Benchmark::print( const string name ){
+
+   char buffer[ 256 ];
+   const double avg = sum_time / num_calls;
+   #ifdef CHEMPS2_BENCH_COUNT_FLOPS
+      if ( sum_flops > 0.0 ){
+         snprintf( buffer, 256, "   %-28s %6d %10.4f %10.4f %10.3f", name.c_str(), num_calls, min_time, avg, 1e-9 * sum_flops / sum_time );
+      } else {
+         snprintf( buffer, 256, "   %-28s %6d %10.4f %10.4f %10s", name.c_str(), num_calls, min_time, avg, "-" );
+      }
+   #else
+      snprintf( buffer, 256, "   %-28s %6d %10.4f %10.4f %10s", name.c_str(), num_calls, min_time, avg, "n/a" );
+   #endif
+   ( *report ) << buffer << endl;
+   num_calls = 0;
+   sum_time  = 0.0;
+   sum_flops = 0.0;
+
+}
+
+void CheMPS2::Benchmark::reference( const int dim ){
+
+   double * A = new double[ dim * dim ];
+   double * B = new double[ dim * dim ];
+   double * C = new double[ dim * dim ];
+   for ( int elem = 0; elem < dim * dim; elem++ ){
+      A[ elem ] = (( double ) rand() ) / RAND_MAX;
+      B[ elem ] = (( double ) rand() ) / RAND_MAX;
+   }
+   char notrans = 'N';
+   int size = dim;
+   double one = 1.0;
+   double set = 0.0;
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      dgemm_( &notrans, &notrans, &size, &size, &size, &one, A, &size, B, &size, &set, C, &size );
+      stop();
+   }
+   stringstream name;
+   name << "dgemm " << dim << "x" << dim;
+   print( name.str() );
+   delete [] A;
+   delete [] B;
+   delete [] C;
+
+}
+
+void CheMPS2::Benchmark::dmrg( Problem * prob, const int D, const int sweeps ){
+
+   ConvergenceScheme * scheme = new ConvergenceScheme( 1 );
+   scheme->set_instruction( 0, D, 1e-10, sweeps, 0.0, CheMPS2::DAVIDSON_DMRG_RTOL );
+   DMRG * solver = new DMRG( prob, scheme, false );
+
+   start();
+   solver->Solve();
+   stop();
+   print( "DMRG sweeps" );
+
+   start();
+   solver->calc_rdms_and_correlations( false );
+   stop();
+   print( "DMRG 2-RDM" );
+
+   start();
+   solver->calc_rdms_and_correlations( true );
+   stop();
+   print( "DMRG 2-RDM and 3-RDM" );
+
+   // Move the renormalized operators to the middle of the chain
+   const int L   = solver->L;
+   const int mid = ( L - 2 ) / 2;
+   for ( int index = L - 2; index > mid; index-- ){ solver->updateMovingLeftSafe( index ); }
+
+   Sobject * denS = new Sobject( mid, solver->denBK );
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      denS->Join( solver->MPS[ mid ], solver->MPS[ mid + 1 ] );
+      stop();
+   }
+   print( "Sobject::Join" );
+
+   const int veclength = denS->gKappa2index( denS->gNKappa() );
+   double * result = new double[ veclength ];
+   Heff * heff = new Heff( solver->denBK, prob, CheMPS2::DAVIDSON_DMRG_RTOL );
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      heff->fillHeffDiag( result, denS, solver->Ctensors, solver->Dtensors, solver->F0tensors, solver->F1tensors, solver->Xtensors, 0, NULL );
+      stop();
+   }
+   print( "Heff::fillHeffDiag" );
+
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      heff->makeHeff( denS->gStorage(), result, denS, solver->Ltensors, solver->Atensors, solver->Btensors, solver->Ctensors, solver->Dtensors,
+                      solver->S0tensors, solver->S1tensors, solver->F0tensors, solver->F1tensors, solver->Qtensors, solver->Xtensors, 0, NULL );
+      stop();
+   }
+   print( "Heff::makeHeff" );
+   delete heff;
+   delete [] result;
+
+   for ( int rep = 0; rep < repeat; rep++ ){
+      denS->Join( solver->MPS[ mid ], solver->MPS[ mid + 1 ] );
+      start();
+      denS->Split( solver->MPS[ mid ], solver->MPS[ mid + 1 ], D, true, false );
+      stop();
+   }
+   print( "Sobject::Split" );
+   delete denS;
+
+   // (J,N,I) = (0,0,0) and (moving_right, prime_last, jw_phase) = (true, true, false), as in DMRG::left_normalize and DMRG::right_normalize
+   TensorOperator * factor = new TensorOperator( mid + 1, 0, 0, 0, true, true, false, solver->denBK, solver->denBK );
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      solver->MPS[ mid ]->QR( factor );
+      stop();
+   }
+   print( "TensorT::QR" );
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      solver->MPS[ mid + 1 ]->LQ( factor );
+      stop();
+   }
+   print( "TensorT::LQ" );
+   delete factor;
+
+   // The boundary mid is free: the operators on boundaries mid - 1 (left) and mid + 1 (right) are in memory
+   if ( solver->isAllocated[ mid ] == 2 ){ solver->deleteTensors( mid, false ); solver->isAllocated[ mid ] = 0; }
+   if ( solver->isAllocated[ mid ] == 0 ){ solver->allocateTensors( mid, true ); solver->isAllocated[ mid ] = 1; }
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      solver->updateMovingRight( mid );
+      stop();
+   }
+   print( "DMRG::updateMovingRight" );
+   solver->deleteTensors( mid, true );
+   solver->allocateTensors( mid, false );
+   solver->isAllocated[ mid ] = 2;
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      solver->updateMovingLeft( mid );
+      stop();
+   }
+   print( "DMRG::updateMovingLeft" );
+
+   if ( CheMPS2::DMRG_storeRenormOptrOnDisk ){ solver->deleteStoredOperators(); }
+   delete solver;
+   delete scheme;
+
+}
+
+void CheMPS2::Benchmark::caspt2( Hamiltonian * ham, const int N, const int TwoS, const int irrep ){
+
+   const int L     = ham->getL();
+   const int group = ham->getNGroup();
+   const int num_irreps = Irreps::getNumberOfIrreps( group );
+
+   int * nocc = new int[ num_irreps ];
+   int * nact = new int[ num_irreps ];
+   int * nvir = new int[ num_irreps ];
+   for ( int irr = 0; irr < num_irreps; irr++ ){ nocc[ irr ] = 0; }
+   for ( int orb = 0; orb < L; orb++ ){ nocc[ ham->getOrbitalIrrep( orb ) ] += 1; }
+   for ( int irr = 0; irr < num_irreps; irr++ ){
+      const int norb = nocc[ irr ];
+      nocc[ irr ] = norb / 4;
+      nvir[ irr ] = norb / 4;
+      nact[ irr ] = norb - nocc[ irr ] - nvir[ irr ];
+   }
+   DMRGSCFindices * idx = new DMRGSCFindices( L, group, nocc, nact, nvir );
+   delete [] nocc;
+   delete [] nact;
+   delete [] nvir;
+
+   const int LAS = idx->getDMRGcumulative( num_irreps );
+   const int num_elec = N - 2 * idx->getNOCCsum();
+   if (( num_elec < 0 ) || ( num_elec > 2 * LAS ) || ( TwoS > num_elec ) || ( TwoS > 2 * LAS - num_elec ) || ( CASPT2::vector_length( idx ) == 0 )){
+      ( *report ) << "   The system is too small to time the FCI and CASPT2 kernels." << endl;
+      delete idx;
+      return;
+   }
+
+   // Work memory as in CASSCF::caspt2
+   const int maxlinsize     = idx->getNORBmax();
+   const long long fullsize = (( long long ) maxlinsize ) * maxlinsize * maxlinsize * maxlinsize;
+   const int work_mem_size  = max( max( (( fullsize > CheMPS2::DMRGSCF_max_mem_eri_tfo ) ? CheMPS2::DMRGSCF_max_mem_eri_tfo : ( int ) fullsize ), maxlinsize * maxlinsize * 4 ), LAS * LAS * LAS * LAS );
+   double * mem1 = new double[ work_mem_size ];
+   double * mem2 = new double[ work_mem_size ];
+   const string tmp_filename = CheMPS2::defaultTMPpath + "/" + CheMPS2::DMRGSCF_eri_storage_name;
+   DMRGSCFunitary * umat = new DMRGSCFunitary( idx );
+
+   // Active space Hamiltonian
+   Hamiltonian * HamAS = new Hamiltonian( LAS, group, idx->getIrrepOfEachDMRGorbital() );
+   for ( int irr = 0; irr < num_irreps; irr++ ){
+      for ( int row = 0; row < idx->getNDMRG( irr ); row++ ){
+         for ( int col = 0; col < idx->getNDMRG( irr ); col++ ){
+            HamAS->setTmat( idx->getDMRGcumulative( irr ) + row, idx->getDMRGcumulative( irr ) + col,
+                       ham->getTmat( idx->getOrigNDMRGstart( irr ) + row, idx->getOrigNDMRGstart( irr ) + col ) );
+         }
+      }
+   }
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      DMRGSCFrotations::rotate( ham->getVmat(), HamAS->getVmat(), NULL, 'A', 'A', 'A', 'A', idx, umat, mem1, mem2, work_mem_size, tmp_filename );
+      stop();
+   }
+   print( "rotate (AA|AA)" );
+
+   DMRGSCFintegrals * ints = new DMRGSCFintegrals( idx );
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      DMRGSCFrotations::rotate( ham->getVmat(), NULL, ints, 'C', 'C', 'F', 'F', idx, umat, mem1, mem2, work_mem_size, tmp_filename );
+      stop();
+   }
+   print( "rotate (CC|FF)" );
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      DMRGSCFrotations::rotate( ham->getVmat(), NULL, ints, 'C', 'V', 'C', 'V', idx, umat, mem1, mem2, work_mem_size, tmp_filename );
+      stop();
+   }
+   print( "rotate (CV|CV)" );
+   unlink( tmp_filename.c_str() );
+   delete umat;
+   delete [] mem1;
+   delete [] mem2;
+
+   // FCI on the active space, with a random vector
+   FCI * fci = new FCI( HamAS, ( num_elec + TwoS ) / 2, ( num_elec - TwoS ) / 2, irrep, 1000.0, 0 );
+   const unsigned int fcilength = fci->getVecLength( 0 );
+   if ( fcilength == 0 ){
+      ( *report ) << "   The active space has no determinants of the target irrep." << endl;
+      delete fci;
+      delete HamAS;
+      delete ints;
+      delete idx;
+      return;
+   }
+   double * vector = new double[ fcilength ];
+   double * output = new double[ fcilength ];
+   FCI::FillRandom( fcilength, vector );
+   const double norm = FCI::FCIfrobeniusnorm( fcilength, vector );
+   for ( unsigned int elem = 0; elem < fcilength; elem++ ){ vector[ elem ] /= norm; }
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      fci->matvec( vector, output );
+      stop();
+   }
+   print( "FCI::matvec" );
+   delete [] output;
+
+   const int LAS2 = LAS * LAS;
+   const int LAS6 = LAS2 * LAS2 * LAS2;
+   double * one_rdm   = new double[ LAS2 ];
+   double * two_rdm   = new double[ LAS2 * LAS2 ];
+   double * three_rdm = new double[ LAS6 ];
+   double * contract  = new double[ LAS6 ];
+   double * fock_as   = new double[ LAS2 ];
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      fci->Fill2RDM( vector, two_rdm );
+      stop();
+   }
+   print( "FCI::Fill2RDM" );
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      fci->Fill3RDM( vector, three_rdm );
+      stop();
+   }
+   print( "FCI::Fill3RDM" );
+   for ( int row = 0; row < LAS; row++ ){
+      for ( int col = 0; col < LAS; col++ ){
+         fock_as[ row + LAS * col ] = HamAS->getTmat( row, col );
+      }
+   }
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      fci->Fock4RDM( vector, three_rdm, fock_as, contract );
+      stop();
+   }
+   print( "FCI::Fock4RDM" );
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      fci->Fill3RDMFock4RDM( vector, fock_as, three_rdm, contract );
+      stop();
+   }
+   print( "FCI::Fill3RDMFock4RDM" );
+   delete [] fock_as;
+   delete [] vector;
+   delete fci;
+   delete HamAS;
+
+   // 1-RDM from the 2-RDM, as in CASSCF::setDMRG1DM
+   for ( int row = 0; row < LAS; row++ ){
+      for ( int col = row; col < LAS; col++ ){
+         double value = 0.0;
+         for ( int sum = 0; sum < LAS; sum++ ){ value += two_rdm[ row + LAS * ( sum + LAS * ( col + LAS * sum ) ) ]; }
+         value = value / ( num_elec - 1 );
+         one_rdm[ row + LAS * col ] = value;
+         one_rdm[ col + LAS * row ] = value;
+      }
+   }
+
+   DMRGSCFmatrix * oei = new DMRGSCFmatrix( idx );
+   for ( int irr = 0; irr < num_irreps; irr++ ){
+      for ( int row = 0; row < idx->getNORB( irr ); row++ ){
+         for ( int col = 0; col < idx->getNORB( irr ); col++ ){
+            oei->set( irr, row, col, ham->getTmat( idx->getOrigNOCCstart( irr ) + row, idx->getOrigNOCCstart( irr ) + col ) );
+         }
+      }
+   }
+
+   start();
+   CASPT2 * pt2 = new CASPT2( idx, ints, oei, oei, one_rdm, two_rdm, three_rdm, contract, 0.0 );
+   stop();
+   print( "CASPT2 setup" );
+
+   const long long pt2length = pt2->jump[ CHEMPS2_CASPT2_NUM_CASES * pt2->num_irreps ];
+   double * diag_fock = new double[ pt2length ];
+   double * pt2vector = new double[ pt2length ];
+   double * pt2result = new double[ pt2length ];
+   pt2->diagonal( diag_fock );
+   for ( long long elem = 0; elem < pt2length; elem++ ){ pt2vector[ elem ] = (( double ) rand() ) / RAND_MAX - 0.5; }
+   for ( int rep = 0; rep < repeat; rep++ ){
+      start();
+      pt2->matvec( pt2vector, pt2result, diag_fock );
+      stop();
+   }
+   print( "CASPT2::matvec" );
+
+   delete [] diag_fock;
+   delete [] pt2vector;
+   delete [] pt2result;
+   delete pt2;
+   delete oei;
+   delete ints;
+   delete idx;
+   delete [] one_rdm;
+   delete [] two_rdm;
+   delete [] three_rdm;
+   delete [] contract;
+
+}
+
+void print_help(){
+
+cout << "\n"
+"chemps2-bench: microbenchmarks for the CheMPS2 kernels\n"
+"\n"
+"Usage: chemps2-bench [OPTIONS]\n"
+"\n"
+"   The kernels are timed on a synthetic Hamiltonian: a Hubbard chain with nearest-neighbour hopping t = -1 and on-site repulsion U = 4, or random integrals with the orbitals evenly distributed over the irreps of the chosen point group. The DMRG kernels (Heff::makeHeff, Heff::fillHeffDiag, DMRG::updateMovingRight/Left, Sobject::Join/Split, TensorT::QR/LQ) are timed at the middle of the chain, after a few sweeps at the chosen bond dimension. The FCI, orbital rotation and CASPT2 kernels use a quarter of the orbitals of each irrep as core and a quarter as virtual orbitals. The GFLOP/s are based on the counted dgemm calls; a dash means that the kernel performs no dgemm.\n"
+"\n"
+"   -s, --system=hubbard|random\n"
+"          The synthetic Hamiltonian (default hubbard).\n"
+"\n"
+"   -L, --orbitals=int\n"
+"          The number of orbitals (default 16).\n"
+"\n"
+"   -N, --electrons=int\n"
+"          The number of electrons (default the number of orbitals).\n"
+"\n"
+"   -g, --group=int\n"
+"          The point group for random integrals, in psi4 conventions: 0=c1, 1=ci, 2=c2, 3=cs, 4=d2, 5=c2v, 6=c2h, 7=d2h (default 0).\n"
+"\n"
+"   -D, --dimension=int\n"
+"          The reduced virtual dimension of the MPS (default 256).\n"
+"\n"
+"   -w, --sweeps=int\n"
+"          The maximum number of sweeps before the DMRG kernels are timed (default 2).\n"
+"\n"
+"   -r, --repeat=int\n"
+"          The number of times each kernel is timed (default 5).\n"
+"\n"
+"   -x, --seed=int\n"
+"          The seed of the random number generator (default 1).\n"
+"\n"
+"   -k, --skip=dmrg|caspt2\n"
+"          Skip the DMRG kernels, or the FCI, rotation, and CASPT2 kernels.\n"
+"\n"
+"   -V, --verbose\n"
+"          Do not suppress the output of the library.\n"
+"\n"
+"   -h, --help\n"
+"          Display this help.\n"
+"\n"
+" " << endl;
+
+}
+
+int main( int argc, char ** argv ){
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+      CheMPS2::MPIchemps2::mpi_init();
+      if ( CheMPS2::MPIchemps2::mpi_size() > 1 ){
+         if ( CheMPS2::MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER ){ cerr << "chemps2-bench should be run on a single MPI process!" << endl; }
+         CheMPS2::MPIchemps2::mpi_finalize();
+         return -1;
+      }
+   #endif
+
+   #ifdef CHEMPS2_BENCH_COUNT_FLOPS
+      blas_dgemm = ( dgemm_pointer ) dlsym( RTLD_NEXT, "dgemm_" );
+      if ( blas_dgemm == NULL ){
+         cerr << "chemps2-bench could not find the BLAS dgemm_ to count the flops!" << endl;
+         return -1;
+      }
+   #endif
+
+   string system  = "hubbard";
+   string skip    = "";
+   int L          = 16;
+   int N          = -1;
+   int group      = 0;
+   int D          = 256;
+   int sweeps     = 2;
+   int repeat     = 5;
+   int seed       = 1;
+   bool verbose   = false;
+
+   struct option long_options[] =
+   {
+      {"system",    required_argument, 0, 's'},
+      {"orbitals",  required_argument, 0, 'L'},
+      {"electrons", required_argument, 0, 'N'},
+      {"group",     required_argument, 0, 'g'},
+      {"dimension", required_argument, 0, 'D'},
+      {"sweeps",    required_argument, 0, 'w'},
+      {"repeat",    required_argument, 0, 'r'},
+      {"seed",      required_argument, 0, 'x'},
+      {"skip",      required_argument, 0, 'k'},
+      {"verbose",   no_argument,       0, 'V'},
+      {"help",      no_argument,       0, 'h'},
+      {0, 0, 0, 0}
+   };
+
+   int option_index = 0;
+   int c;
+   while (( c = getopt_long( argc, argv, "s:L:N:g:D:w:r:x:k:Vh", long_options, &option_index )) != -1 ){
+      switch( c ){
+         case 's': system  = optarg;         break;
+         case 'L': L       = atoi( optarg ); break;
+         case 'N': N       = atoi( optarg ); break;
+         case 'g': group   = atoi( optarg ); break;
+         case 'D': D       = atoi( optarg ); break;
+         case 'w': sweeps  = atoi( optarg ); break;
+         case 'r': repeat  = atoi( optarg ); break;
+         case 'x': seed    = atoi( optarg ); break;
+         case 'k': skip    = optarg;         break;
+         case 'V': verbose = true;           break;
+         case 'h':
+         case '?':
+            print_help();
+            return 0;
+      }
+   }
+   if ( N < 0 ){ N = L; }
+   if ( system == "hubbard" ){ group = 0; }
+
+   if (( system != "hubbard" ) && ( system != "random" )){ cerr << "Invalid option for --system!" << endl; return -1; }
+   if (( group < 0 ) || ( group > 7 )){ cerr << "Invalid option for --group!" << endl; return -1; }
+   if ( L < 4 ){ cerr << "The number of orbitals should be at least 4!" << endl; return -1; }
+   if (( N < 1 ) || ( N > 2 * L )){ cerr << "Invalid option for --electrons!" << endl; return -1; }
+   if (( D < 1 ) || ( sweeps < 1 ) || ( repeat < 1 )){ cerr << "The dimension, sweeps, and repeat should be positive!" << endl; return -1; }
+
+   CheMPS2::Initialize::Init();
+   srand( seed );
+
+   // The synthetic Hamiltonian, with the orbitals sorted per irrep
+   const int num_irreps = CheMPS2::Irreps::getNumberOfIrreps( group );
+   int * irreps = new int[ L ];
+   for ( int orb = 0; orb < L; orb++ ){ irreps[ orb ] = ( orb * num_irreps ) / L; }
+   CheMPS2::Hamiltonian * ham = new CheMPS2::Hamiltonian( L, group, irreps );
+   if ( system == "hubbard" ){
+      for ( int orb = 0; orb < L;     orb++ ){ ham->setVmat( orb, orb, orb, orb, 4.0 ); }
+      for ( int orb = 0; orb < L - 1; orb++ ){ ham->setTmat( orb, orb + 1, -1.0 ); }
+   } else {
+      for ( int i = 0; i < L; i++ ){
+         for ( int j = i; j < L; j++ ){
+            if ( irreps[ i ] == irreps[ j ] ){
+               ham->setTmat( i, j, (( i == j ) ? -2.0 : 0.0 ) + 0.2 * ((( double ) rand() ) / RAND_MAX - 0.5 ) );
+            }
+         }
+      }
+      for ( int i = 0; i < L; i++ ){
+         for ( int j = 0; j < L; j++ ){
+            for ( int k = 0; k < L; k++ ){
+               for ( int l = 0; l < L; l++ ){
+                  if ( CheMPS2::Irreps::directProd( irreps[ i ], irreps[ j ] ) == CheMPS2::Irreps::directProd( irreps[ k ], irreps[ l ] ) ){
+                     ham->setVmat( i, j, k, l, ((( i == k ) && ( j == l )) ? 0.5 : 0.0 ) + 0.02 * ((( double ) rand() ) / RAND_MAX - 0.5 ) );
+                  }
+               }
+            }
+         }
+      }
+   }
+   delete [] irreps;
+   const int TwoS = N % 2;
+
+   #ifdef _OPENMP
+      const int num_threads = omp_get_max_threads();
+   #else
+      const int num_threads = 1;
+   #endif
+
+   cout << "chemps2-bench: system = " << system << ", L = " << L << ", N = " << N << ", group = " << group << ", D = " << D
+        << ", sweeps = " << sweeps << ", repeat = " << repeat << ", seed = " << seed << ", OpenMP threads = " << num_threads << endl;
+
+   // The report is written to the original cout buffer; the output of the library is suppressed unless verbose
+   ostream report( cout.rdbuf() );
+   ofstream devnull( "/dev/null" );
+   streambuf * original = cout.rdbuf();
+   if ( verbose == false ){ cout.rdbuf( devnull.rdbuf() ); }
+
+   CheMPS2::Benchmark bench( repeat, &report );
+   bench.header();
+   bench.reference( min( D, 2048 ) );
+   if ( skip != "dmrg" ){
+      CheMPS2::Problem * prob = new CheMPS2::Problem( ham, TwoS, N, 0 );
+      bench.dmrg( prob, D, sweeps );
+      delete prob;
+   }
+   if ( skip != "caspt2" ){
+      bench.caspt2( ham, N, TwoS, 0 );
+   }
+
+   cout.rdbuf( original );
+   delete ham;
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+      CheMPS2::MPIchemps2::mpi_finalize();
+   #endif
+
+   return 0;
+
+}
+
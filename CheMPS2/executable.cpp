@@ -32,6 +32,8 @@
 #include "Molden.h"
 #include "MPIchemps2.h"
 #include "EdmistonRuedenberg.h"
+#include "HeffProfiler.h"
+#include "Tracer.h"
 
 using namespace std;
 
@@ -388,6 +390,15 @@ cout << "\n"
 "       TMP_FOLDER = /path/to/tmp/folder\n"
 "              Overwrite the tmp folder for the renormalized operators. With MPI, separate folders per process can (but do not have to) be used (default /tmp).\n"
 "\n"
+"       SWEEP_LOG = /path/to/sweeps.jsonl\n"
+"              Write a machine-readable record (JSON lines) for each two-site optimization, sweep, and instruction of the DMRG calculation: energies, discarded weights, Davidson iterations, sector dimensions, timings, disk traffic, and memory usage. Only for full active space calculations (when NOCC = NVIR = 0) (default none).\n"
+"\n"
+"       HEFF_PROFILE = /path/to/profile.csv\n"
+"              Record the wall time, number of calls, and dgemm flops of each effective Hamiltonian diagram family. A summary is printed after each sweep, and the totals per MPI process and thread are written to this file at the end. With MPI, the rank is appended to the filename (default none).\n"
+"\n"
+"       TRACE_FILE = /path/to/trace.json\n"
+"              Write a timeline of the DMRG sweeps, site optimizations, effective Hamiltonian threads, renormalized operator updates, disk I/O, MPI collectives, DMRG-SCF iterations, orbital rotations, and CASPT2 in the Chrome trace-event format, which can be opened in chrome://tracing or https://ui.perfetto.dev. With MPI, the rank is appended to the filename (default none).\n"
+"\n"
 "   EXAMPLE\n"
 "       $ cd /tmp\n"
 "       $ wget \'https://github.com/SebWouters/CheMPS2/raw/master/tests/matrixelements/N2.CCPVDZ.FCIDUMP\'\n"
@@ -457,6 +468,9 @@ int main( int argc, char ** argv ){
 
    bool   print_corr = false;
    string tmp_folder = "/tmp";
+   string sweep_log    = "";
+   string heff_profile = "";
+   string trace_file   = "";
 
    struct option long_options[] =
    {
@@ -543,6 +557,24 @@ int main( int argc, char ** argv ){
          if ( file_exists( tmp_folder, "TMP_FOLDER" ) == false ){ return clean_exit( -1 ); }
       }
 
+      if ( line.find( "SWEEP_LOG" ) != string::npos ){
+         const int pos = line.find( "=" ) + 1;
+         sweep_log = line.substr( pos, line.length() - pos );
+         sweep_log.erase( remove( sweep_log.begin(), sweep_log.end(), ' ' ), sweep_log.end() );
+      }
+
+      if ( line.find( "HEFF_PROFILE" ) != string::npos ){
+         const int pos = line.find( "=" ) + 1;
+         heff_profile = line.substr( pos, line.length() - pos );
+         heff_profile.erase( remove( heff_profile.begin(), heff_profile.end(), ' ' ), heff_profile.end() );
+      }
+
+      if ( line.find( "TRACE_FILE" ) != string::npos ){
+         const int pos = line.find( "=" ) + 1;
+         trace_file = line.substr( pos, line.length() - pos );
+         trace_file.erase( remove( trace_file.begin(), trace_file.end(), ' ' ), trace_file.end() );
+      }
+
       if ( find_integer( &group,        line, "GROUP",        true, 0, true,   7 ) == false ){ return clean_exit( -1 ); }
       if ( find_integer( &multiplicity, line, "MULTIPLICITY", true, 1, false, -1 ) == false ){ return clean_exit( -1 ); }
       if ( find_integer( &nelectrons,   line, "NELECTRONS",   true, 2, false, -1 ) == false ){ return clean_exit( -1 ); }
@@ -739,6 +771,11 @@ int main( int argc, char ** argv ){
       }
    }
 
+   if ( ( sweep_log.length() != 0 ) && ( full_active_space_calculation == false ) ){
+      if ( am_i_master ){ cerr << "The option SWEEP_LOG can only be specified for full active space calculations (when NOCC = NVIR = 0)!" << endl; }
+      return clean_exit( -1 );
+   }
+
    if ( ( molcas_f4rdm.length() != 0 ) && ( molcas_fock.length() == 0 ) ){
       if ( am_i_master ){ cerr << "When MOLCAS_F4RDM should be written, MOLCAS_FOCK should be specified as well!" << endl; }
       return clean_exit( -1 );
@@ -791,6 +828,7 @@ int main( int argc, char ** argv ){
    }
       cout << "   MOLCAS_MPS         = " << (( molcas_mps ) ? "TRUE" : "FALSE" ) << endl;
       cout << "   MOLCAS_STATE_AVG   = " << (( molcas_state_avg ) ? "TRUE" : "FALSE" ) << endl;
+      cout << "   SWEEP_LOG          = " << sweep_log << endl;
    } else {
       cout << "   SCF_STATE_AVG      = " << (( scf_state_avg ) ? "TRUE" : "FALSE" ) << endl;
       cout << "   SCF_DIIS_THR       = " << scf_diis_thr << endl;
@@ -809,6 +847,8 @@ int main( int argc, char ** argv ){
    }
       cout << "   PRINT_CORR         = " << (( print_corr     ) ? "TRUE" : "FALSE" ) << endl;
       cout << "   TMP_FOLDER         = " << tmp_folder << endl;
+      cout << "   HEFF_PROFILE       = " << heff_profile << endl;
+      cout << "   TRACE_FILE         = " << trace_file << endl;
       cout << " " << endl;
    }
 
@@ -817,6 +857,8 @@ int main( int argc, char ** argv ){
    ********************************/
 
    CheMPS2::Initialize::Init();
+   if ( heff_profile.length() > 0 ){ CheMPS2::HeffProfiler::enable( true ); }
+   if ( trace_file.length()   > 0 ){ CheMPS2::Tracer::start( trace_file ); }
    CheMPS2::Hamiltonian * ham = new CheMPS2::Hamiltonian( fcidump, group );
    CheMPS2::ConvergenceScheme * opt_scheme = new CheMPS2::ConvergenceScheme( ni_d );
    for ( int count = 0; count < ni_d; count++ ){
@@ -862,6 +904,11 @@ int main( int argc, char ** argv ){
       }
 
       CheMPS2::DMRG * dmrgsolver = new CheMPS2::DMRG( prob, opt_scheme, molcas_mps, tmp_folder );
+      CheMPS2::SweepLog * sweep_logger = NULL;
+      if (( sweep_log.length() > 0 ) && ( am_i_master )){
+         sweep_logger = new CheMPS2::SweepLog( sweep_log );
+         dmrgsolver->set_sweep_log( sweep_logger );
+      }
 
       // Solve for the correct root
       double DMRG_ENERGY;
@@ -903,7 +950,7 @@ int main( int argc, char ** argv ){
                   double * result = new double[ LAS_pow6  ];
                   for ( int cnt = 0; cnt < LAS_pow6; cnt++ ){ result[ cnt ] = 0.0; }
                   ham->readfock( molcas_fock, fockmx, true );
-                  CheMPS2::CASSCF::fock_dot_4rdm( fockmx, dmrgsolver, ham, 0, 0, work, result, false, false );
+                  CheMPS2::CASSCF::fock_dot_4rdm( fockmx, dmrgsolver, ham, NULL, work, result, false, false );
 
                   result_filename.str("");
                   result_filename << molcas_f4rdm << ".r" << state;
@@ -920,6 +967,7 @@ int main( int argc, char ** argv ){
       // Clean up
       if ( CheMPS2::DMRG_storeRenormOptrOnDisk ){ dmrgsolver->deleteStoredOperators(); }
       delete dmrgsolver;
+      if ( sweep_logger != NULL ){ delete sweep_logger; }
       delete prob;
 
    } else {
@@ -975,6 +1023,12 @@ int main( int argc, char ** argv ){
    delete opt_scheme;
    delete ham;
 
+   if ( heff_profile.length() > 0 ){
+      CheMPS2::HeffProfiler::dump( heff_profile );
+      CheMPS2::HeffProfiler::enable( false );
+   }
+   CheMPS2::Tracer::stop();
+
    return clean_exit( 0 );
 
 }
@@ -23,6 +23,7 @@
 #include "DMRGSCFindices.h"
 #include "DMRGSCFintegrals.h"
 #include "DMRGSCFmatrix.h"
+#include "Options.h"
 
 #define CHEMPS2_CASPT2_A         0
 #define CHEMPS2_CASPT2_B_SINGLET 1
@@ -72,18 +73,30 @@ namespace CheMPS2{
              \param two_dm   The spin-summed two-particle density matrix two_dm[i+L*(j+L*(k+L*l))] = sum_sigma,tau < a^+_i,sigma a^+_j,tau a_l,tau a_k,sigma > (with L the number DMRG orbitals), in pseudocanonical orbitals
              \param three_dm The spin-summed three-particle density matrix three_dm[i+L*(j+L*(k+L*(l+L*(m+L*n))))] = sum_z,tau,s < a^+_{i,z} a^+_{j,tau} a^+_{k,s} a_{n,s} a_{m,tau} a_{l,z} > (with L the number DMRG orbitals), in pseudocanonical orbitals
              \param contract The spin-summed four-particle density matrix contracted with the fock operator contract[i+L*(j+L*(k+L*(p+L*(q+L*r))))] = sum_{t,sigma,tau,s} fock(t,t) < a^+_{i,sigma} a^+_{j,tau} a^+_{k,s} E_{tt} a_{r,s} a_{q,tau} a_{p,sigma} > (with L the number DMRG orbitals), in pseudocanonical orbitals
-             \param IPEA     The CASPT2 IPEA shift from Ghigo, Roos and Malmqvist, Chemical Physics Letters 396, 142-149 (2004) */
-         CASPT2(DMRGSCFindices * idx, DMRGSCFintegrals * ints, DMRGSCFmatrix * oei, DMRGSCFmatrix * fock, double * one_dm, double * two_dm, double * three_dm, double * contract, const double IPEA);
+             \param IPEA     The CASPT2 IPEA shift from Ghigo, Roos and Malmqvist, Chemical Physics Letters 396, 142-149 (2004)
+             \param maxMemMB The maximum number of MB for the vectors of the length of the first order wavefunction, or zero for no limit. When the RHS or the vectors of the linear solver exceed it, they are stored in memory-mapped files in tmp_folder, which the operating system pages in and out as the excitation classes A-H are streamed through.
+             \param tmp_folder The folder for the memory-mapped scratch files
+             \param distributed If true and MPI is used, all processes should construct the object with the same RDMs and Fock matrix. The integrals are then only used on the master process, which solves the linear problem, while all processes share the matrix-vector products. */
+         CASPT2(DMRGSCFindices * idx, DMRGSCFintegrals * ints, DMRGSCFmatrix * oei, DMRGSCFmatrix * fock, double * one_dm, double * two_dm, double * three_dm, double * contract, const double IPEA, const double maxMemMB=0.0, const string tmp_folder=CheMPS2::defaultTMPpath, const bool distributed=false);
 
          //! Destructor
          virtual ~CASPT2();
 
          //! Solve for the CASPT2 energy (note that the IPEA shift has been set in the constructor)
          /** \param imag_shift The CASPT2 imaginary shift from Forsberg and Malmqvist, Chemical Physics Letters 274, 196-204 (1997)
-             \param CONJUGATE_GRADIENT If true (false), the conjugate gradient (Davidson) algorithm is used to solve the CASPT2 equation
-             \return The CASPT2 variational correction energy */
+             \param CONJUGATE_GRADIENT If true (false), the conjugate gradient (Davidson) algorithm is used to solve the CASPT2 equation; the conjugate gradient algorithm is always used when the vector length exceeds the range of int
+             \return The CASPT2 variational correction energy (on all processes when distributed) */
          double solve( const double imag_shift, const bool CONJUGATE_GRADIENT = false ) const;
 
+         //! Solve for the CASPT2 energies of a list of IPEA and imaginary shifts in one pass
+         /** The overlap diagonalization, the RHS and the coupling blocks of the constructor are reused. For a new IPEA shift, only the diagonal Fock blocks are rediagonalized in the orthonormal basis of the overlap, and the coupling blocks, the RHS and the previous solution are rotated to their new eigenbasis. The solution for each shift is the initial guess for the next one. Afterwards, the IPEA shift of the object is the last one in the list.
+             \param num_shifts The number of shifts
+             \param ipea_shifts Array of length num_shifts with the IPEA shifts
+             \param imag_shifts Array of length num_shifts with the imaginary shifts
+             \param energies Array of length num_shifts in which the CASPT2 variational correction energies are stored
+             \param CONJUGATE_GRADIENT If true (false), the conjugate gradient (Davidson) algorithm is used to solve the CASPT2 equations */
+         void solve_shifts( const int num_shifts, const double * ipea_shifts, const double * imag_shifts, double * energies, const bool CONJUGATE_GRADIENT = false );
+
          //! Return the vector length for the CASPT2 first order wavefunction (before diagonalization of the overlap matrix)
          /** \param idx The number of core, active, and virtual orbitals per irrep
              \return The vector length for the CASPT2 first order wavefunction (before diagonalization of the overlap matrix) */
@@ -91,6 +104,9 @@ namespace CheMPS2{
 
       private:
 
+         // The microbenchmarks of chemps2-bench (CheMPS2/benchmark.cpp) time the private kernels in isolation
+         friend class Benchmark;
+
          // The number of occupied, active, and virtual orbitals per irrep (externally allocated and deleted)
          const DMRGSCFindices * indices;
 
@@ -125,25 +141,77 @@ namespace CheMPS2{
          void create_f_dots();
 
          // Calculate the total vector length and the partitioning of the vector in blocks
-         int vector_helper();
+         long long vector_helper();
 
          // Once make_S**() has been calles, these overlap matrices can be used to contruct the RHS of the linear problem
          void construct_rhs( const DMRGSCFmatrix * oei, const DMRGSCFintegrals * integrals );
 
-         // Fill result with the diagonal elements of the Fock operator
-         void diagonal( double * result ) const;
+         // Fill result with the diagonal elements of the Fock operator; with offsets != NULL only the non-empty blocks of offsets are filled
+         void diagonal( double * result, const long long * offsets=NULL ) const;
+
+         // Fill result with Fock operator times vector; if distributed, only the work units of this MPI process are added, and the diagonal only if diag_fock != NULL
+         // With offsets != NULL, vector and result only contain the blocks of offsets, which should include all blocks of the work units of this process
+         void matvec( double * vector, double * result, double * diag_fock, const bool distributed=false, const long long * offsets=NULL ) const;
+         static bool skip_unit( const int unit, const bool distributed );
+
+         // Whether the CASPT2 blocks and vectors are distributed over the MPI processes, and whether this is the master process
+         bool mpi_distributed;
+         bool am_i_master;
+
+         // The owner process of each vector block [ irrep + num_irreps * sector ], which also builds and diagonalizes the diagonal Fock block of the sector
+         int * block_owner;
+         void distribute_blocks();
+         bool skip_block( const int sector, const int irrep ) const;
+
+         // Fill offsets with the partitioning of the segment of this process in blocks, and return the segment length (the full vector if not mpi_distributed)
+         long long segment_jumps( long long * offsets ) const;
+
+         // Copy the blocks from the full vector of the master process to the segments of their owners (scatter) or back (gather)
+         void scatter_gather( double * full, double * segment, const long long * offsets, const bool scatter ) const;
+
+         // Matrix-vector product for the linear solver on the segments of the processes, without the imaginary shift
+         void DistributedMatvec( double * vector, double * result, double * diag_fock, const long long * offsets ) const;
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         // Mark the blocks which the work units of process rank in matvec read and write
+         void needed_blocks( const int rank, bool * needed ) const;
+
+         // Exchange the needed blocks between the owners and the processes which use them, perform matvec, and add the parts of each block at its owner
+         void block_matvec( double * vector, double * result, double * diag_fock, const long long * offsets ) const;
+
+         // Send and receive an array whose length may exceed the range of int
+         static void sendreceive_vector( double * array, const long long length, const int sender, const int receiver, const int tag );
 
-         // Fill result with Fock operator times vector
-         void matvec( double * vector, double * result, double * diag_fock ) const;
+         // Broadcast the new size, the eigenvalues, the transformation, and the IPEA operator of a diagonalized block from its owner; if resize, IPEA_OP is reallocated as in recreatehelper4
+         static void broadcast_diagonal_block( double * FOCK, double * OVLP, double *& IPEA_OP, const int SIZE, int & NEWSIZE, const bool resize, const int owner );
+         #endif
          static void matmat( char totrans, int rowdim, int coldim, int sumdim, double alpha, double * matrix, int ldaM, double * origin, int ldaO, double * target, int ldaT );
 
+         // Memory limit in MB for the vectors of the first order wavefunction length (zero means no limit) and folder for the memory-mapped scratch files
+         double max_mem_MB;
+         string scratch_folder;
+
+         // Whether num_vectors vectors of the given length exceed max_mem_MB
+         bool exceeds_memory( const double num_vectors, const long long length ) const;
+
+         // Allocate a vector in RAM, or in a memory-mapped scratch file if on_disk; on_disk is reset to false if the file cannot be mapped
+         double * allocate_vector( const long long length, bool & on_disk ) const;
+         static void free_vector( double * vector, const long long length, const bool on_disk );
+
+         // Solve for the CASPT2 energy; if solution != NULL it is used as initial guess (if warm_start) and overwritten with the solution
+         double solve_linear( const double imag_shift, const bool CONJUGATE_GRADIENT, double * solution, const bool warm_start ) const;
+
          // Helper functions for solve
-         void add_shift( double * vector, double * result, double * diag_fock, const double shift, const int * normalizations ) const;
-         double inproduct_vectors( double * first, double * second, const int * normalizations ) const;
+         void add_shift( double * vector, double * result, double * diag_fock, const double shift, const int * normalizations, const long long * offsets ) const;
+         double inproduct_vectors( double * first, double * second, const int * normalizations, const long long * offsets ) const;
+         static double inproduct( const double * first, const double * second, const long long length );
+
+         // Sum a value over the MPI processes if mpi_distributed
+         void sum_over_processes( double & value ) const;
          void energy_per_sector( double * solution ) const;
 
          // Variables for the partitioning of the vector in blocks
-         int * jump;
+         long long * jump;
          int * size_A;
          int * size_C;
          int * size_D;
@@ -158,15 +226,16 @@ namespace CheMPS2{
          int get_maxsize() const;
          static int jump_AC_active( const DMRGSCFindices * idx, const int irrep_t, const int irrep_u, const int irrep_v );
          static int jump_BF_active( const DMRGSCFindices * idx, const int irrep_t, const int irrep_u, const int ST );
-         static int shift_D_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_a );
-         static int shift_B_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_j, const int ST );
-         static int shift_F_nonactive( const DMRGSCFindices * idx, const int irrep_a, const int irrep_b, const int ST );
-         static int shift_E_nonactive( const DMRGSCFindices * idx, const int irrep_a, const int irrep_i, const int irrep_j, const int ST );
-         static int shift_G_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_a, const int irrep_b, const int ST );
-         static int shift_H_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_j, const int irrep_a, const int irrep_b, const int ST );
-
-         // The RHS of the linear problem
+         static long long shift_D_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_a );
+         static long long shift_B_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_j, const int ST );
+         static long long shift_F_nonactive( const DMRGSCFindices * idx, const int irrep_a, const int irrep_b, const int ST );
+         static long long shift_E_nonactive( const DMRGSCFindices * idx, const int irrep_a, const int irrep_i, const int irrep_j, const int ST );
+         static long long shift_G_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_a, const int irrep_b, const int ST );
+         static long long shift_H_nonactive( const DMRGSCFindices * idx, const int irrep_i, const int irrep_j, const int irrep_a, const int irrep_b, const int ST );
+
+         // The RHS of the linear problem (NULL on the MPI helper processes), and whether it is stored in a memory-mapped scratch file
          double * vector_rhs;
+         bool rhs_on_disk;
 
          // Variables for the overlap (only allocated during creation of the CASPT2 object)
          double ** SAA;
@@ -208,6 +277,18 @@ namespace CheMPS2{
          double **** FDG_singlet;
          double **** FDG_triplet;
 
+         // The IPEA shift of the diagonal Fock blocks, and the operator which multiplies it: first the diagonal (at construction), then the matrix in the basis of the diagonal Fock blocks
+         double ipea_shift;
+         double ** IAA;
+         double ** ICC;
+         double ** IDD;
+         double ** IEE;
+         double ** IGG;
+         double ** IBB_singlet;
+         double ** IBB_triplet;
+         double ** IFF_singlet;
+         double ** IFF_triplet;
+
          // Fill overlap and Fock matrices
          void make_AA_CC( const bool OVLP, const double IPEA );
          void make_DD( const bool OVLP, const double IPEA );
@@ -225,9 +306,23 @@ namespace CheMPS2{
 
          // Diagonalize the overlap matrices and adjust jump, vector_rhs, and FXX accordingly
          void recreate();
-         static int  recreatehelper1( double * FOCK, double * OVLP, int SIZE, double * work, double * eigs, int lwork );
+         static int  recreatehelper1( double * FOCK, double * OVLP, int SIZE, double * work, double * eigs, int lwork, int * iwork, int liwork );
          static void recreatehelper2( double * LEFT, double * RIGHT, double ** matrix, double * work, int OLD_LEFT, int NEW_LEFT, int OLD_RIGHT, int NEW_RIGHT, const int number );
          static void recreatehelper3( double * OVLP, int OLDSIZE, int NEWSIZE, double * rhs_old, double * rhs_new, const int num_rhs );
+         static void recreatehelper4( double * OVLP, int OLDSIZE, int NEWSIZE, double *& IPEA_OP, double * work );
+
+         // Perform recreatehelper1 + recreatehelper4 (change_ipea_helper if IPEA_DELTA != 0) for all diagonal blocks: the large ones one by one, the small ones concurrently
+         void recreatebatch( int ** newsize, const double IPEA_DELTA );
+
+         // Diagonalize a symmetric matrix with dsyev, or dsyevd when SIZE >= CASPT2_LARGE_BLOCK; eigenvectors overwrite matrix
+         static void eigensolve( double * matrix, int SIZE, double * eigs, double * work, int lwork, int * iwork, int liwork );
+
+         // Rotate the coupling blocks, vector_rhs, and guess (if not NULL, with unchanged sizes) with the matrices SXX to the new sizes, and take ownership of the new sizes
+         void recreaterotate( int * newsize_A, int * newsize_C, int * newsize_D, int * newsize_E, int * newsize_G, int * newsize_B_singlet, int * newsize_B_triplet, int * newsize_F_singlet, int * newsize_F_triplet, double * guess );
+
+         // Change the IPEA shift: rediagonalize the diagonal Fock blocks and rotate the coupling blocks, vector_rhs, and guess (if not NULL) to their new eigenbasis
+         void change_ipea( const double IPEA, double * guess );
+         static void change_ipea_helper( double * FOCK, double * IPEA_OP, double * ROT, int SIZE, const double delta, double * work, double * eigs, int lwork, int * iwork, int liwork );
 
    };
 }
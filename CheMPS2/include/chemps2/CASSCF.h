@@ -36,6 +36,7 @@
 #include "DMRGSCFwtilde.h"
 #include "DMRGSCFmatrix.h"
 #include "DMRGSCFintegrals.h"
+#include "ThreeIndex.h"
 
 namespace CheMPS2{
 /** CASSCF class.
@@ -174,6 +175,16 @@ namespace CheMPS2{
              \param nvirt Array containing the number of virtual (secondary) orbitals per irrep
              \param tmp_folder Temporary work folder for the DMRG renormalized operators and the ERI rotations */
          CASSCF( Hamiltonian * ham_in, int * docc, int * socc, int * nocc, int * ndmrg, int * nvirt, const string tmp_folder=CheMPS2::defaultTMPpath );
+
+         //! Constructor with density-fitted or Cholesky-decomposed electron repulsion integrals: the four-index integrals are never stored for the full orbital space
+         /** \param econst The constant part of the Hamiltonian (nuclear repulsion energy)
+             \param tmat The one-body matrix elements of the Hamiltonian
+             \param vchol The three-index vectors of the electron repulsion integrals
+             \param nocc  Array containing the number of doubly occupied (inactive) orbitals per irrep
+             \param ndmrg Array containing the number of active orbitals per irrep
+             \param nvirt Array containing the number of virtual (secondary) orbitals per irrep
+             \param tmp_folder Temporary work folder for the DMRG renormalized operators */
+         CASSCF( const double econst, const TwoIndex * tmat, const ThreeIndex * vchol, int * nocc, int * ndmrg, int * nvirt, const string tmp_folder=CheMPS2::defaultTMPpath );
          
          //! Destructor
          virtual ~CASSCF();
@@ -186,7 +197,7 @@ namespace CheMPS2{
          /** \param Nelectrons Total number of electrons in the system: occupied HF orbitals + active space
              \param TwoS Twice the targeted spin
              \param Irrep Desired wave-function irrep
-             \param OptScheme The optimization scheme to run the inner DMRG loop. If NULL: use FCI instead of DMRG.
+             \param OptScheme The optimization scheme to run the inner DMRG loop. If NULL: use FCI instead of DMRG. With DMRGSCFoptions::getAdaptiveDMRG, it is loosened in the iterations with a large orbital gradient.
              \param rootNum Denotes the targeted state in state-specific CASSCF; 1 means ground state, 2 first excited state etc.
              \param scf_options Contains the DMRGSCF options
              \return The converged DMRGSCF energy */
@@ -207,6 +218,22 @@ namespace CheMPS2{
              \return The CASPT2 variational correction energy */
          double caspt2( const int Nelectrons, const int TwoS, const int Irrep, ConvergenceScheme * OptScheme, const int rootNum, DMRGSCFoptions * scf_options, const double IPEA, const double IMAG, const bool PSEUDOCANONICAL, const bool CHECKPOINT = false, const bool CUMULANT = false );
 
+         //! Calculate the caspt2 correction energies of several IPEA and imaginary shifts for a converged casscf wavefunction; the active space, the RDMs, the RHS and the overlap diagonalization are computed only once
+         /** \param Nelectrons Total number of electrons in the system: occupied HF orbitals + active space
+             \param TwoS Twice the targeted spin
+             \param Irrep Desired wave-function irrep
+             \param OptScheme The optimization scheme to run the inner DMRG loop. If NULL: use FCI instead of DMRG.
+             \param rootNum Denotes the targeted state in state-specific CASSCF; 1 means ground state, 2 first excited state etc.
+             \param scf_options Contains the DMRGSCF options
+             \param num_shifts The number of ( IPEA, IMAG ) shift pairs
+             \param IPEA Array of length num_shifts with the CASPT2 IPEA shifts
+             \param IMAG Array of length num_shifts with the CASPT2 imaginary shifts
+             \param E_CASPT2 Array of length num_shifts in which the CASPT2 variational correction energies are stored
+             \param PSEUDOCANONICAL If true, use the exact DMRG 4-RDM in the pseudocanonical basis. If false, use the cumulant approximated DMRG 4-RDM in the unrotated basis.
+             \param CHECKPOINT If true, write checkpoints to disk and read them back in again in order to perform the contraction of the generalized Fock operator with the 4-RDM in multiple runs.
+             \param CUMULANT If true, a cumulant approximation is used for the 4-RDM and CHECKPOINT is overwritten to false. If false, the full 4-RDM is used. */
+         void caspt2( const int Nelectrons, const int TwoS, const int Irrep, ConvergenceScheme * OptScheme, const int rootNum, DMRGSCFoptions * scf_options, const int num_shifts, const double * IPEA, const double * IMAG, double * E_CASPT2, const bool PSEUDOCANONICAL, const bool CHECKPOINT = false, const bool CUMULANT = false );
+
          //! CASSCF unitary rotation remove call
          /* \param filename File to delete */
          static void deleteStoredUnitary( const string filename=CheMPS2::DMRGSCF_unitary_storage_name ){ delete_file( filename ); }
@@ -231,11 +258,10 @@ namespace CheMPS2{
              \param localTmat Matrix which contains the one-electron integrals
              \param localJKocc Matrix which contains the Coulomb and exchange interaction due to the frozen core orbitals
              \param localJKact Matrix which contains the Coulomb and exchange interaction due to the active space
-             \param localIdx Orbital index bookkeeper for the CASSCF calculations
              \param theInts The rotated two-electron integrals (at most 2 virtual indices)
              \param local2DM The DMRG 2-RDM
              \param local1DM The DMRG 1-RDM */
-         static void buildWtilde( DMRGSCFwtilde * localwtilde, const DMRGSCFmatrix * localTmat, const DMRGSCFmatrix * localJKocc, const DMRGSCFmatrix * localJKact, const DMRGSCFindices * localIdx, const DMRGSCFintegrals * theInts, double * local2DM, double * local1DM );
+         static void buildWtilde( DMRGSCFwtilde * localwtilde, const DMRGSCFmatrix * localTmat, const DMRGSCFmatrix * localJKocc, const DMRGSCFmatrix * localJKact, const DMRGSCFintegrals * theInts, double * local2DM, double * local1DM );
 
          //! Calculate the augmented Hessian Newton-Raphson update for the orthogonal orbital rotation matrix
          /** \param localFmat Matrix which contains the Fock operator (Eq. (11) in the Siegbahn paper [CAS3])
@@ -306,34 +332,62 @@ namespace CheMPS2{
              \return RMS deviation from block-diagonal */
          static double deviation_from_blockdiag( DMRGSCFmatrix * matrix, const DMRGSCFindices * idx );
 
+         //! Return the index of an orbital pair for the contraction of the generalized Fock operator with the 4-RDM
+         /** \param LAS The number of active orbitals
+             \param orb1 The first orbital
+             \param orb2 The second orbital, with orb1 <= orb2
+             \return The index of the pair: the diagonal pairs ( orb, orb ) come first, followed by the off-diagonal pairs in lexicographic order */
+         static int f4rdm_pair_index( const int LAS, const int orb1, const int orb2 );
+
          //! Write the checkpoint file for the contraction of the generalized Fock operator with the 4-RDM to disk
          /** \param f4rdm_file The filename
-             \param hamorb1 The next hamiltonian orbital 1
-             \param hamorb2 The next hamiltonian orbital 2
+             \param num_pairs The number of orbital pairs LAS * ( LAS + 1 ) / 2
+             \param done Array of size num_pairs which contains for each orbital pair (see f4rdm_pair_index) whether it has been added to contract
              \param tot_dmrg_power6 The size of the array contract
              \param contract The current partial contraction */
-         static void write_f4rdm_checkpoint( const string f4rdm_file, int * hamorb1, int * hamorb2, const int tot_dmrg_power6, double * contract );
+         static void write_f4rdm_checkpoint( const string f4rdm_file, const int num_pairs, int * done, const int tot_dmrg_power6, double * contract );
 
-         //! Read the checkpoint file for the contraction of the generalized Fock operator with the 4-RDM from disk
+         //! Read the checkpoint file for the contraction of the generalized Fock operator with the 4-RDM from disk; the partial files of the MPI process groups (see fock_dot_4rdm) are added, and merged into the checkpoint file
          /** \param f4rdm_file The filename
-             \param hamorb1 The next hamiltonian orbital 1
-             \param hamorb2 The next hamiltonian orbital 2
+             \param LAS The number of active orbitals
+             \param done Array of size LAS * ( LAS + 1 ) / 2 to store for each orbital pair (see f4rdm_pair_index) whether it has been added to contract; files with only the next orbital pair are converted
              \param tot_dmrg_power6 The size of the array contract
              \param contract The current partial contraction
              \return Whether the file was found and read */
-         static bool read_f4rdm_checkpoint( const string f4rdm_file, int * hamorb1, int * hamorb2, const int tot_dmrg_power6, double * contract );
+         static bool read_f4rdm_checkpoint( const string f4rdm_file, const int LAS, int * done, const int tot_dmrg_power6, double * contract );
+
+         //! Get the filename of the partial F.4-RDM checkpoint of an MPI process group
+         /** \param f4rdm_file The filename of the checkpoint file
+             \param group The MPI process group, larger than zero; group 0 updates the checkpoint file itself
+             \return The filename of the partial checkpoint, which only contains the orbital pairs of the group */
+         static string f4rdm_group_file( const string f4rdm_file, const int group );
+
+         //! Replace the F.4-RDM checkpoint file and the partial files of the MPI process groups by a single checkpoint file; a crash in between leaves a consistent set of files
+         /** \param f4rdm_file The filename
+             \param num_pairs The number of orbital pairs LAS * ( LAS + 1 ) / 2
+             \param done Array of size num_pairs which contains for each orbital pair (see f4rdm_pair_index) whether it has been added to contract
+             \param tot_dmrg_power6 The size of the array contract
+             \param contract The partial contraction of all files together */
+         static void merge_f4rdm_checkpoint( const string f4rdm_file, const int num_pairs, int * done, const int tot_dmrg_power6, double * contract );
+
+         //! Read one F.4-RDM checkpoint file on this process
+         /** \param f4rdm_file The filename
+             \param LAS The number of active orbitals
+             \param done Array of size LAS * ( LAS + 1 ) / 2 to store the completed orbital pairs
+             \param contract Array to store the partial contraction */
+         static void load_f4rdm_file( const string f4rdm_file, const int LAS, int * done, double * contract );
 
          //! Build the contraction of the fock matrix with the 4-RDM
          /** \param fockmx Array of size ham->getL() x ham->getL() containing the Fock matrix elements
              \param dmrgsolver DMRG object which is solved, and for which the 2-RDM and 3-RDM have been calculated as well
              \param ham Active space Hamiltonian, which is needed for the size of the active space and the orbital irreps
-             \param next_orb1 The next first  orbital for which the contraction should be continued
-             \param next_orb2 The next second orbital for which the contraction should be continued
+             \param done Array of size L * ( L + 1 ) / 2 with the orbital pairs (see f4rdm_pair_index) which are already contained in result; these pairs are skipped. On exit, all pairs are marked as done. If NULL, no pairs are done on entry.
              \param work Work array of size ham->getL()**6
-             \param result On entry, contains the partial contraction corresponding to (next_orb1, next_orb2). On exit, contains the full contraction.
-             \param CHECKPOINT Whether or not the standard CheMPS2 F.4-RDM checkpoint should be created/updated to continue the contraction at later times 
-             \param PSEUDOCANONICAL Whether or not pseudocanonical orbitals are used in the active space */
-         static void fock_dot_4rdm( double * fockmx, CheMPS2::DMRG * dmrgsolver, CheMPS2::Hamiltonian * ham, int next_orb1, int next_orb2, double * work, double * result, const bool CHECKPOINT, const bool PSEUDOCANONICAL );
+             \param result On entry, contains the partial contraction corresponding to the pairs which are done. On exit, contains the full contraction.
+             \param CHECKPOINT Whether or not the standard CheMPS2 F.4-RDM checkpoint should be created/updated after the diagonal pairs, which are contracted together with DMRG::DiagFock4RDM, and after every off-diagonal orbital pair, to continue the contraction at later times. With several MPI process groups, the groups other than group 0 store their pairs in partial files (see f4rdm_group_file) until the end.
+             \param PSEUDOCANONICAL Whether or not pseudocanonical orbitals are used in the active space
+             \param num_groups The number of MPI process groups (see DMRGSCFoptions::setF4RDMGroups) which fetch the off-diagonal orbital pairs from a shared queue; the partial contractions of the groups are added at the end */
+         static void fock_dot_4rdm( double * fockmx, CheMPS2::DMRG * dmrgsolver, CheMPS2::Hamiltonian * ham, int * done, double * work, double * result, const bool CHECKPOINT, const bool PSEUDOCANONICAL, const int num_groups=1 );
 
       private:
 
@@ -353,6 +407,13 @@ namespace CheMPS2{
          double NUCL_ORIG;
          const TwoIndex  * TMAT_ORIG;
          const FourIndex * VMAT_ORIG;
+         const ThreeIndex * CHOL_ORIG; // Only one of VMAT_ORIG and CHOL_ORIG is not NULL
+
+         // The part of the constructor which is independent of the type of electron repulsion integrals
+         void setup( int * docc, int * socc, int * nocc, int * ndmrg, int * nvirt, const string new_tmp_folder );
+
+         // Rotate the electron repulsion integrals to NEW_VMAT or ROT_TEI with DMRGSCFrotations::rotate, from VMAT_ORIG or CHOL_ORIG
+         void rotate_eri( FourIndex * NEW_VMAT, DMRGSCFintegrals * ROT_TEI, const char space1, const char space2, const char space3, const char space4, double * mem1, double * mem2, const int mem_size, const string filename );
 
          // Irreps controller
          Irreps SymmInfo;
@@ -381,6 +442,9 @@ namespace CheMPS2{
          // Calculate the gradient, return function is the gradient 2-norm
          static double construct_gradient( DMRGSCFmatrix * Fmatrix, const DMRGSCFindices * idx, double * gradient );
 
+         // Return a new convergence scheme loosened according to the orbital gradient 2-norm, or NULL when the full scheme should be used
+         static ConvergenceScheme * adaptive_scheme( const ConvergenceScheme * OptScheme, const double gradNorm, const double adaptiveGradient, const int adaptiveMinD );
+
          // Add hessian * origin to target
          static void add_hessian( DMRGSCFmatrix * Fmatrix, DMRGSCFwtilde * Wtilde, const DMRGSCFindices * idx, double * origin, double * target );
 
@@ -406,6 +470,7 @@ namespace CheMPS2{
          void rotateOldToNew(DMRGSCFmatrix * myMatrix);
          void buildTmatrix();
          void constructCoulombAndExchangeMatrixInOrigIndices( DMRGSCFmatrix * density, DMRGSCFmatrix * result );
+         void constructCoulombAndExchangeMatrixFromThreeIndex( DMRGSCFmatrix * density, DMRGSCFmatrix * result );
          void buildQmatOCC();
          void buildQmatACT();
 
@@ -20,6 +20,9 @@
 #ifndef CONJUGATEGRADIENT_CHEMPS2_H
 #define CONJUGATEGRADIENT_CHEMPS2_H
 
+#include <string>
+#include <stddef.h>
+
 namespace CheMPS2{
 /** Conjugate gradient class.
     \author Sebastian Wouters <sebastianwouters@gmail.com>
@@ -43,7 +46,7 @@ namespace CheMPS2{
              \param RTOL_in The tolerance for the two-norm of the residual
              \param DIAG_CUTOFF_in The cutoff to truncate the diagonal elements of operator
              \param print_in Whether or not to print */
-         ConjugateGradient(const int veclength_in, const double RTOL_in, const double DIAG_CUTOFF_in, const bool print_in);
+         ConjugateGradient(const long long veclength_in, const double RTOL_in, const double DIAG_CUTOFF_in, const bool print_in);
 
          //! Destructor
          virtual ~ConjugateGradient();
@@ -53,16 +56,25 @@ namespace CheMPS2{
              \return Instruction character. 'A' means copy the initial guess to pointers[0], the diagonal of the symmetric matrix to pointers[1], and the right-hand side of the problem to pointers[2]. 'B' means calculate pointers[1] = symmetric matrix times pointers[0]. 'C' means that the converged solution can be copied back from pointers[0], and the residual norm from pointers[1][0]. 'D' means that an error has occurred. */
          char step( double ** pointers );
 
+         //! Store the seven work vectors in a memory-mapped scratch file instead of in RAM; should be called before the first step
+         /** \param filename The name of the scratch file; it is unlinked immediately, so that its disk space is freed with the mapping, also when the process is killed
+             \return Whether the scratch file could be mapped; if not, the vectors are allocated in RAM */
+         bool StoreVectorsOnDisk( const std::string filename );
+
+         //! Distribute the vectors over the MPI processes: each process passes its own segment of the vectors, of length veclength, and the inner products are summed over all processes; should be called by all processes before the first step, and without MPI this has no effect
+         void DistributeVectors();
+
          //! Get the number of matrix vector multiplications which have been performed
          /** \return The number of matrix vector multiplications which have been performed */
          int get_num_matvec() const;
 
       private:
 
-         int veclength;
+         long long veclength;
          double RTOL;
          double DIAG_CUTOFF;
          bool print;
+         bool distributed; // Whether the vectors are segments of vectors which are distributed over the MPI processes
 
          char state;     // Current state of the algorithm
          int num_matvec; // Current number of matvec multiplications
@@ -76,6 +88,10 @@ namespace CheMPS2{
          double * PVEC;
          double * OPVEC;
 
+         // If not NULL, the seven helper arrays are consecutive in this memory-mapped file
+         double * disk_storage;
+         size_t disk_bytes;
+
          // Helper variables
          double rnorm;
          double rdotr;
@@ -87,6 +103,7 @@ namespace CheMPS2{
          void stepG2H();
          double inprod( double * vector );
          double inprod( double * vector, double * othervector );
+         void sum_over_processes( double & value ) const;
          void apply_precon( double * vector );
          void apply_precon( double * vector, double * result );
 
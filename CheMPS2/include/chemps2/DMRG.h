@@ -44,6 +44,7 @@
 #include "Heff.h"
 #include "Sobject.h"
 #include "ConvergenceScheme.h"
+#include "SweepLog.h"
 #include "MyHDF5.h"
 
 //For the timings of the different parts of DMRG
@@ -123,6 +124,13 @@ namespace CheMPS2{
              \param last_case If true, everything will be set up to allow to continue sweeping. */
          void Symm4RDM( double * output, const int ham_orb1, const int ham_orb2, const bool last_case );
 
+         //! Obtain the contraction of the 4-RDM with a diagonal Fock operator sum_z fock_zz Gamma4_ijkz,pqrz, after the 3-RDM has been calculated.
+         /** The MPS of ( 1 +/- F ) | 0 >, with F = sum_z fock_zz n_z, is constructed exactly with twice the virtual dimension and compressed without loss, so that only two 3-RDM sweeps are needed instead of one Symm4RDM call per orbital.
+             \param output    Array to store the contraction in Hamiltonian index notation: output[ i + L * ( j + L * ( k + L * ( p + L * ( q + L * r )))) ] = sum_z diag_fock[ z ] * Gamma4_ijkz,pqrz.
+             \param diag_fock The diagonal Fock operator elements diag_fock[ z ] in Hamiltonian index notation.
+             \param last_case If true, everything will be set up to allow to continue sweeping. */
+         void DiagFock4RDM( double * output, const double * diag_fock, const bool last_case );
+
          //! Get the pointer to the Correlations
          /** \return The Correlations. Returns a NULL pointer if not yet calculated. */
          Correlations * getCorrelations(){ return theCorr; }
@@ -156,7 +164,14 @@ namespace CheMPS2{
          //! Print the license
          static void PrintLicense();
          
+         //! Write structured records of the sweeps to a SweepLog: one record per two-site optimization, per sweep, and per instruction
+         /** \param log The SweepLog (externally allocated and deleted), or NULL to stop logging */
+         void set_sweep_log( SweepLog * log ){ sweep_log = log; }
+         
       private:
+
+         // The microbenchmarks of chemps2-bench (CheMPS2/benchmark.cpp) time the private kernels in isolation
+         friend class Benchmark;
       
          //Setup the DMRG SyBK and MPS (in separate function to allow pushbacks and recreations for excited states)
          void setupBookkeeperAndMPS();
@@ -295,6 +310,8 @@ namespace CheMPS2{
          static void  left_normalize( TensorT * left_mps, TensorT * right_mps );
          static void right_normalize( TensorT * left_mps, TensorT * right_mps );
          void symm_4rdm_helper( double * output, const int ham_orb1, const int ham_orb2, const double alpha, const double beta, const bool add, const double factor );
+         void diag_fock_helper( double * output, const double * dmrg_fock, const double alpha, const double beta, const bool add, const double factor );
+         void helper_3rdm( double * output, const int first_site, const bool add, const double factor );
 
          //Helper functions for making the Correlations boundary operators
          void update_correlations_tensors(const int siteindex);
@@ -318,6 +335,12 @@ namespace CheMPS2{
          long long num_double_read_disk;
          void print_tensor_update_performance() const;
          
+         // Structured event log (externally allocated and deleted)
+         SweepLog * sweep_log;
+         int log_instruction;
+         int log_sweep;
+         void log_sweep_record( const bool moving_right, const double elapsed ) const;
+         
    };
 }
 
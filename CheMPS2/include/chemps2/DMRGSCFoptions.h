@@ -46,7 +46,22 @@ namespace CheMPS2{
     DMRG active space options: \n
     (11) WhichActiveSpace (int) : Determines which active space is used for the DMRG (FCI replacement) calculations. If 1: NO, sorted within each irrep by NOON. If 2: Localized Orbitals (Edmiston-Ruedenberg), sorted within each irrep by the exchange matrix (Fiedler vector). If 3: Not localized, but only sorted within each irrep by the Fiedler vector of the exchange matrix. If other value: No additional active space rotations (the ones from DMRGSCF are of course performed). \n
     (12) DumpCorrelations (bool) : Whether or not to print the correlation functions and two-orbital mutual information of the active space \n
-    (13) StartLocRandom (bool) : When localized orbitals are used, it is sometimes beneficial to start the localization procedure from a random unitary. A specific example is the reduction of the d2h point group of graphene nanoribbons to the cs point group, in order to make use of locality in the DMRG calculations. Since molecular orbitals will still belong to the full point group d2h, a random unitary helps in constructing localized orbitals which belong to the cs point group.
+    (13) StartLocRandom (bool) : When localized orbitals are used, it is sometimes beneficial to start the localization procedure from a random unitary. A specific example is the reduction of the d2h point group of graphene nanoribbons to the cs point group, in order to make use of locality in the DMRG calculations. Since molecular orbitals will still belong to the full point group d2h, a random unitary helps in constructing localized orbitals which belong to the cs point group. \n
+    
+    CASPT2 options: \n
+    (14) CASPT2MaxMemMB (double) : The maximum number of MB for the CASPT2 vectors of the length of the first order wavefunction, or zero for no limit. Beyond it, the RHS and the vectors of the linear solver are stored in memory-mapped files in the tmp_folder of CASSCF. \n
+    (15) F4RDMGroups (int) : With MPI, the number of process groups which contract the DMRG 4-RDM with the Fock operator (see CASSCF::caspt2) for different orbital pairs concurrently. The groups fetch the orbital pairs from a shared queue, and each group distributes the renormalized operators of its own copy of the DMRG wavefunction over its processes. It is at most the number of processes. \n
+    
+    Augmented Hessian Newton-Raphson options: \n
+    (16) StoreWtilde (bool) : Whether the tensor w_tilde of the orbital Hessian (see DMRGSCFwtilde.h) is stored. If false, the Hessian-vector products in the Davidson iterations recompute its subblocks on the fly, which avoids its storage of the order of (occupied + active)^2 (total orbitals)^2, at the cost of one w_tilde construction per Davidson iteration. \n
+    
+    Adaptive DMRG accuracy options: \n
+    (17) AdaptiveDMRG (bool) : Whether the DMRG convergence scheme is loosened in the DMRGSCF iterations with a large orbital gradient. The bond dimensions are divided by the square root, and the energy convergence thresholds and Davidson residual tolerances multiplied by, the ratio of the orbital gradient 2-norm of the previous iteration to AdaptiveGradient (at most CheMPS2::DMRGSCF_adaptiveMaxLoosening). The bond dimensions are not reduced below AdaptiveMinD. The first iteration, for which no orbital gradient is known yet, uses the full convergence scheme, and the DMRGSCF iterations only stop after an iteration with the full convergence scheme. \n
+    (18) AdaptiveGradient (double) : The orbital gradient 2-norm below which the full DMRG convergence scheme is used \n
+    (19) AdaptiveMinD (int) : The smallest bond dimension of a loosened DMRG convergence scheme \n
+    
+    FCI active space options: \n
+    (20) SpinAdaptFCI (bool) : Whether the FCI active space solver, used when no ConvergenceScheme is passed, finds the ground state in the basis of configuration state functions with spin TwoS/2 (see FCI::SpinAdapt) instead of in the determinant basis. The CSF coefficients of the configurations with n open orbitals take C(n, n_alpha) times the number of CSFs doubles.
 */
    class DMRGSCFoptions{
 
@@ -109,6 +124,34 @@ namespace CheMPS2{
          //! Get whether the localization procedure should start from a random unitary
          /** \return Whether the localization procedure should start from a random unitary */
          bool getStartLocRandom() const;
+         
+         //! Get the maximum number of MB for the CASPT2 vectors
+         /** \return The maximum number of MB for the CASPT2 vectors of the length of the first order wavefunction, or zero for no limit */
+         double getCASPT2MaxMemMB() const;
+         
+         //! Get the number of MPI process groups for the contraction of the DMRG 4-RDM with the Fock operator
+         /** \return The number of MPI process groups which contract the 4-RDM with the Fock operator for different orbital pairs */
+         int getF4RDMGroups() const;
+         
+         //! Get whether the tensor w_tilde of the orbital Hessian is stored
+         /** \return Whether the tensor w_tilde of the orbital Hessian is stored */
+         bool getStoreWtilde() const;
+         
+         //! Get whether the DMRG convergence scheme is loosened for large orbital gradients
+         /** \return Whether the DMRG convergence scheme is loosened for large orbital gradients */
+         bool getAdaptiveDMRG() const;
+         
+         //! Get the orbital gradient 2-norm below which the full DMRG convergence scheme is used
+         /** \return The orbital gradient 2-norm below which the full DMRG convergence scheme is used */
+         double getAdaptiveGradient() const;
+         
+         //! Get the smallest bond dimension of a loosened DMRG convergence scheme
+         /** \return The smallest bond dimension of a loosened DMRG convergence scheme */
+         int getAdaptiveMinD() const;
+         
+         //! Get whether the FCI active space solver works in the basis of configuration state functions
+         /** \return Whether the FCI active space solver works in the basis of configuration state functions */
+         bool getSpinAdaptFCI() const;
 
          //! Set whether DIIS should be performed
          /** \param DoDIIS_in Whether DIIS should be performed */
@@ -162,6 +205,34 @@ namespace CheMPS2{
          /** \param StartLocRandom_in Whether the localization procedure should start from a random unitary */
          void setStartLocRandom(const bool StartLocRandom_in);
          
+         //! Set the maximum number of MB for the CASPT2 vectors
+         /** \param CASPT2MaxMemMB_in The maximum number of MB for the CASPT2 vectors of the length of the first order wavefunction, or zero for no limit */
+         void setCASPT2MaxMemMB(const double CASPT2MaxMemMB_in);
+         
+         //! Set the number of MPI process groups for the contraction of the DMRG 4-RDM with the Fock operator
+         /** \param F4RDMGroups_in The number of MPI process groups which contract the 4-RDM with the Fock operator for different orbital pairs */
+         void setF4RDMGroups(const int F4RDMGroups_in);
+         
+         //! Set whether the tensor w_tilde of the orbital Hessian is stored
+         /** \param StoreWtilde_in Whether the tensor w_tilde of the orbital Hessian is stored, or recomputed on the fly in the Hessian-vector products */
+         void setStoreWtilde(const bool StoreWtilde_in);
+         
+         //! Set whether the DMRG convergence scheme is loosened for large orbital gradients
+         /** \param AdaptiveDMRG_in Whether the DMRG convergence scheme is loosened for large orbital gradients */
+         void setAdaptiveDMRG(const bool AdaptiveDMRG_in);
+         
+         //! Set the orbital gradient 2-norm below which the full DMRG convergence scheme is used
+         /** \param AdaptiveGradient_in The orbital gradient 2-norm below which the full DMRG convergence scheme is used */
+         void setAdaptiveGradient(const double AdaptiveGradient_in);
+         
+         //! Set the smallest bond dimension of a loosened DMRG convergence scheme
+         /** \param AdaptiveMinD_in The smallest bond dimension of a loosened DMRG convergence scheme */
+         void setAdaptiveMinD(const int AdaptiveMinD_in);
+         
+         //! Set whether the FCI active space solver works in the basis of configuration state functions
+         /** \param SpinAdaptFCI_in Whether the FCI active space solver works in the basis of configuration state functions */
+         void setSpinAdaptFCI(const bool SpinAdaptFCI_in);
+         
       private:
       
          //See class information
@@ -181,6 +252,17 @@ namespace CheMPS2{
          bool   DumpCorrelations;
          bool   StartLocRandom;
          
+         double CASPT2MaxMemMB;
+         int    F4RDMGroups;
+         
+         bool   StoreWtilde;
+         
+         bool   AdaptiveDMRG;
+         double AdaptiveGradient;
+         int    AdaptiveMinD;
+         
+         bool   SpinAdaptFCI;
+         
    };
 }
 
@@ -24,6 +24,7 @@
 #include "Hamiltonian.h"
 #include "DMRGSCFunitary.h"
 #include "DMRGSCFintegrals.h"
+#include "ThreeIndex.h"
 #include "MyHDF5.h"
 
 namespace CheMPS2{
@@ -37,7 +38,7 @@ namespace CheMPS2{
 
       public:
 
-         //! Fill the rotated two-body matrix elements for the space. If the blocks become too large, disk is used.
+         //! Fill the rotated two-body matrix elements for the space. Each symmetry block is transformed in tiles, which are distributed over the threads. If the half-transformed blocks become too large, disk is used while the other threads keep transforming.
          /** \param ORIG_VMAT The FourIndex object with the original ERI.
              \param NEW_VMAT The FourIndex object where the new ERI should be stored.
              \param ROT_TEI The rotated two-body matrix elements are stored here.
@@ -53,6 +54,20 @@ namespace CheMPS2{
              \param filename Where to store the temporary intermediate objects. */
          static void rotate( const FourIndex * ORIG_VMAT, FourIndex * NEW_VMAT, DMRGSCFintegrals * ROT_TEI, const char space1, const char space2, const char space3, const char space4, DMRGSCFindices * idx, DMRGSCFunitary * umat, double * mem1, double * mem2, const int mem_size, const string filename );
 
+         //! Fill the rotated two-body matrix elements for the space from three-index vectors. Only the three-index vectors are rotated; the two-body matrix elements are assembled block by block, so that no disk is needed.
+         /** \param ORIG_VMAT The ThreeIndex object with the original density-fitted or Cholesky-decomposed ERI.
+             \param NEW_VMAT The FourIndex object where the new ERI should be stored.
+             \param ROT_TEI The rotated two-body matrix elements are stored here.
+             \param space1 Orbital space 1 (O, A, V, C, or F).
+             \param space2 Orbital space 2 (O, A, V, C, or F).
+             \param space3 Orbital space 3 (O, A, V, C, or F).
+             \param space4 Orbital space 4 (O, A, V, C, or F).
+             \param idx The DMRGSCF indices.
+             \param umat The unitary matrix to rotate ORIG_VMAT to NEW_VMAT.
+             \param mem1 Work memory with at least the size max(linsize of irreps)^2.
+             \param mem_size Size of the work memory. */
+         static void rotate( const ThreeIndex * ORIG_VMAT, FourIndex * NEW_VMAT, DMRGSCFintegrals * ROT_TEI, const char space1, const char space2, const char space3, const char space4, DMRGSCFindices * idx, DMRGSCFunitary * umat, double * mem1, const int mem_size );
+
       private:
 
          // Blockwise rotations
@@ -61,6 +76,9 @@ namespace CheMPS2{
          static void blockwise_third(  double * origin, double * target, const int dim12, int orig3, const int dim4, double * umat3, int new3, int lda3 );
          static void blockwise_fourth( double * origin, double * target, const int dim12, int dim3, int orig4, double * umat4, int new4, int lda4 );
 
+         // Rotate the three-index vectors of the irreps ( irrep1, irrep2 ) to the spaces ( space1, space2 ): result[ new1 + NEW1 * new2 + size * P ], with ( new1 <= new2 ) packed if pack
+         static double * rotate_vectors( const ThreeIndex * ORIG_VMAT, const int irrep1, const int irrep2, const char space1, const char space2, DMRGSCFindices * idx, DMRGSCFunitary * umat, const bool pack );
+
          // Space sizes
          static int dimension( DMRGSCFindices * idx, const int irrep, const char space );
          static int      jump( DMRGSCFindices * idx, const int irrep, const char space );
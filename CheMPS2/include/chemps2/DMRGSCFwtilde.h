@@ -21,6 +21,8 @@
 #define DMRGSCFWTILDE_CHEMPS2_H
 
 #include "DMRGSCFindices.h"
+#include "DMRGSCFmatrix.h"
+#include "DMRGSCFintegrals.h"
 
 namespace CheMPS2{
 /** DMRGSCF w_tilde class.
@@ -39,14 +41,16 @@ namespace CheMPS2{
       (p,r) & \in & (occ,act) : \tilde{w}_{pqrs} \\
                           & = & 2 \sum\limits_{\beta \in act} \Gamma^{1,act}_{r \beta} \left[ 4 (q p | s \beta) -  (qs | p \beta) - (q \beta | sp) \right]
     \f}
+    The tensor requires \f$\mathcal{O}(N_{core}^2 N_{orb}^2)\f$ storage, with \f$N_{core}\f$ the number of occupied and active orbitals. When it is not stored, each (pr) subblock is recomputed from the Fock and Coulomb matrices, the rotated integrals and the RDMs when it is fetched.
 */
    class DMRGSCFwtilde{
 
       public:
       
          //! Constructor
-         /** \param iHandler_in The DMRGSCFindices which contain information on the occupied, active, and virtual spaces */
-         DMRGSCFwtilde(DMRGSCFindices * iHandler_in);
+         /** \param iHandler_in The DMRGSCFindices which contain information on the occupied, active, and virtual spaces
+             \param store_in Whether the tensor is stored, or whether its subblocks are computed on the fly in fetchBlock */
+         DMRGSCFwtilde(DMRGSCFindices * iHandler_in, const bool store_in=true);
          
          //! Destructor
          virtual ~DMRGSCFwtilde();
@@ -81,6 +85,28 @@ namespace CheMPS2{
              \param r The third index (within the symmetry block)
              \return Pointer to the requested subblock */
          double * getBlock(const int irrep_pq, const int irrep_rs, const int p, const int r);
+         
+         //! Set the quantities which define w_tilde_pqrs, and compute the tensor if it is stored
+         /** \param Tmat_in The one-electron integrals in the rotated basis
+             \param JKocc_in The Coulomb and exchange interaction with the occupied orbitals
+             \param JKact_in The Coulomb and exchange interaction with the active orbitals
+             \param theInts_in The rotated two-electron integrals (at most 2 virtual indices)
+             \param two_dm_in The DMRG 2-RDM
+             \param one_dm_in The DMRG 1-RDM */
+         void build(const DMRGSCFmatrix * Tmat_in, const DMRGSCFmatrix * JKocc_in, const DMRGSCFmatrix * JKact_in, const DMRGSCFintegrals * theInts_in, double * two_dm_in, double * one_dm_in);
+         
+         //! Get the (pr) subblock of w_tilde_pqrs: the stored subblock, or the subblock computed in work if the tensor is not stored
+         /** \param irrep_pq The irrep number of the first two indices pq
+             \param irrep_rs The irrep number of the last two indices rs
+             \param p The first index (within the symmetry block)
+             \param r The third index (within the symmetry block)
+             \param work Work memory of size Ntotal[I_pq] * Ntotal[I_rs]
+             \return Pointer to the requested subblock [ q + Ntotal[I_pq] * s ] */
+         double * fetchBlock(const int irrep_pq, const int irrep_rs, const int p, const int r, double * work) const;
+         
+         //! Whether the tensor is stored
+         /** \return Whether the tensor is stored */
+         bool isStored() const;
       
       private:
       
@@ -89,8 +115,20 @@ namespace CheMPS2{
          
          int * Nocc_dmrg;
          
-         // The elements: w_tilde[ I_pq ][ I_rs ][ p + ( Nocc[I_pq] + Ndmrg[I_pq] ) * r ][ q + Ntotal[I_pq] * s ]
+         // The elements: w_tilde[ I_pq ][ I_rs ][ p + ( Nocc[I_pq] + Ndmrg[I_pq] ) * r ][ q + Ntotal[I_pq] * s ]; NULL if not stored
+         bool store;
          double **** wmattilde;
+         
+         // The quantities which define w_tilde, set in build
+         const DMRGSCFmatrix * Tmat;
+         const DMRGSCFmatrix * JKocc;
+         const DMRGSCFmatrix * JKact;
+         const DMRGSCFintegrals * theInts;
+         double * two_dm;
+         double * one_dm;
+         
+         // Compute the (pr) subblock [ q + Ntotal[I_pq] * s ]
+         void fillBlock(const int irrep_pq, const int irrep_rs, const int p, const int r, double * subblock) const;
 
    };
 }
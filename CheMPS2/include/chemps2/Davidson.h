@@ -20,6 +20,9 @@
 #ifndef DAVIDSON_CHEMPS2_H
 #define DAVIDSON_CHEMPS2_H
 
+#include <string>
+#include <stddef.h>
+
 namespace CheMPS2{
 /** Davidson class.
     \author Sebastian Wouters <sebastianwouters@gmail.com>
@@ -53,17 +56,33 @@ namespace CheMPS2{
              \return Instruction character. 'A' means copy the initial guess to pointers[0] and the diagonal of the symmetric matrix to pointers[1]. If 'A' and problem_type=='E', the right-hand side of the problem should be copied to pointers[2]. 'B' means calculate pointers[1] as the result of multiplying the symmetric matrix with pointers[0]. 'C' means that the converged solution can be copied back from pointers[0], and pointers[1][0] contains the ground-state energy if problem_type=='E' or the residual norm if problem_type=='L'. 'D' means that an error has occurred. */
          char FetchInstruction( double ** pointers );
 
+         //! Store the subspace vectors and their matrix-vector products in a memory-mapped scratch file instead of in RAM; should be called before the first FetchInstruction
+         /** \param filename The name of the scratch file; it is unlinked immediately, so that its disk space is freed with the mapping, also when the process is killed
+             \return Whether the scratch file could be mapped; if not, the vectors remain in RAM */
+         bool StoreVectorsOnDisk( const std::string filename );
+
+         //! Distribute the vectors over the MPI processes: each process passes its own segment of the vectors, of length veclength, and the inner products are summed over all processes; should be called by all processes before the first FetchInstruction, and without MPI this has no effect
+         void DistributeVectors();
+
          //! Get the number of matrix vector multiplications which have been performed
          /** \return The number of matrix vector multiplications which have been performed */
          int GetNumMultiplications() const;
 
+         //! Get the number of matrix vector multiplications performed by all destroyed Davidson instances of this process
+         /** \return The accumulated number of matrix vector multiplications */
+         static long long GetTotalMultiplications();
+
       private:
 
+         // Accumulated number of matrix-vector multiplications of all destroyed instances
+         static long long total_multiplications;
+
          int veclength; // The vector length
          int nMultiplications; // Current number of requested matrix-vector multiplications
          char state; // Current state of the algorithm --> based on this parameter the next instruction is given
          bool debug_print;
          char problem_type;
+         bool distributed; // Whether the vectors are segments of vectors which are distributed over the MPI processes
 
          // Davidson parameters
          int MAX_NUM_VEC;
@@ -77,6 +96,10 @@ namespace CheMPS2{
          double ** Hvecs;
          int num_allocated;
 
+         // Memory-mapped scratch file which contains vecs, Hvecs and Reortho_Eigenvecs if StoreVectorsOnDisk was called, otherwise NULL
+         double * disk_storage;
+         size_t disk_bytes;
+
          // The effective diagonalization problem
          double * mxM;
          double * mxM_eigs;
@@ -99,6 +122,9 @@ namespace CheMPS2{
          double * Reortho_Eigenvecs;
 
          // Control script functions
+         double InnerProduct( double * vector1, double * vector2 );
+         void SumOverProcesses( double * array, const int size );
+         void BroadcastFromMaster( double * array, const int size );
          double FrobeniusNorm( double * current_vector );
          void SafetyCheckGuess();
          void AddNewVec();
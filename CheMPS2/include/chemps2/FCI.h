@@ -21,6 +21,7 @@
 #define FCI_CHEMPS2_H
 
 #include "Hamiltonian.h"
+#include "Davidson.h"
 
 namespace CheMPS2{
 /** FCI class.
@@ -39,8 +40,9 @@ namespace CheMPS2{
              \param Nel_down The number of down (beta) electrons
              \param TargetIrrep The targeted point group irrep
              \param maxMemWorkMB Maximum workspace size in MB to be used for matrix vector product (this does not include the FCI vectors as stored for example in GSDavidson!!)
-             \param FCIverbose The FCI verbose level: 0 print nothing, 1 print start and solution, 2 print everything */
-         FCI(CheMPS2::Hamiltonian * Ham, const unsigned int Nel_up, const unsigned int Nel_down, const int TargetIrrep, const double maxMemWorkMB=100.0, const int FCIverbose=2);
+             \param FCIverbose The FCI verbose level: 0 print nothing, 1 print start and solution, 2 print everything
+             \param distributed If true and there are several MPI processes, GSDavidson and MultiRootDavidson distribute the matrix-vector products, and Fill3RDM, Fock4RDM and Diag4RDM the excitation pairs, over all MPI processes, which should then call these functions together */
+         FCI(CheMPS2::Hamiltonian * Ham, const unsigned int Nel_up, const unsigned int Nel_down, const int TargetIrrep, const double maxMemWorkMB=100.0, const int FCIverbose=2, const bool distributed=false);
          
          //! Destructor
          virtual ~FCI();
@@ -96,9 +98,36 @@ namespace CheMPS2{
          //! Calculates the FCI ground state with Davidson's algorithm
          /** \param inoutput If inoutput!=NULL, vector with getVecLength(0) variables which contains the initial guess at the start, and on exit the solution of the FCI calculation
              \param DVDSN_NUM_VEC The maximum number of vectors to use in Davidson's algorithm; adjustable in case memory becomes an issue
-             \return The ground state energy */
+             \return The ground state energy
+             
+             If the FCI instance was constructed with distributed=true, all MPI processes should call this function: every process holds the alpha string irrep blocks of the Davidson vectors which it owns, the inner products are summed over all processes, and the matrix-vector products only exchange the blocks which the work units of each process need. Only inoutput of the master process is used as initial guess, and only it contains the solution on exit. After SpinAdapt, the Davidson vectors are expanded in configuration state functions on the master process, and the matrix-vector products are distributed over all processes. */
          double GSDavidson(double * inoutput=NULL, const int DVDSN_NUM_VEC=CheMPS2::DAVIDSON_NUM_VEC) const;
          
+         //! Calculates the lowest FCI eigenstates with a block Davidson algorithm; the correction vectors of all unconverged roots are multiplied with the Hamiltonian in one matvec call
+         /** \param num_roots The number of eigenstates to calculate
+             \param vectors Array of num_roots vectors with getVecLength(0) variables, which contain on exit the eigenvectors
+             \param energies Array of num_roots variables, which contains on exit the eigenvalues in ascending order
+             \param use_guess If true, vectors contains linearly independent initial guesses at the start; otherwise the Slater determinants with the lowest diagonal elements are used
+             \param spin_penalty If positive, the Hamiltonian is shifted by spin_penalty * ( S^2 - S(S+1) ) with S = | Nel_up - Nel_down | / 2, to push states with another spin out of the lowest roots; the eigenvalues of states with spin S are not affected
+             \param DVDSN_NUM_VEC The maximum number of vectors to use in Davidson's algorithm; it is increased when it cannot hold 2 * num_roots + DAVIDSON_NUM_VEC_KEEP vectors
+             \return The lowest energy
+             
+             If the FCI instance was constructed with distributed=true, all MPI processes should call this function, just like GSDavidson. Only the vectors of the master process then contain the eigenvectors on exit. */
+         double MultiRootDavidson(const int num_roots, double ** vectors, double * energies, const bool use_guess=false, const double spin_penalty=0.0, const int DVDSN_NUM_VEC=CheMPS2::DAVIDSON_NUM_VEC) const;
+         
+         //! Limit the total memory of GSDavidson
+         /** \param maxMemTotalMB The maximum number of MB for the Davidson vectors, the matrix-vector product workspaces and the vectors of the CSF basis together; zero or negative means no limit, which is the default
+             
+             If the estimate of these arrays exceeds maxMemTotalMB, the 2 * DVDSN_NUM_VEC subspace vectors of Davidson's algorithm are stored in a memory-mapped file in CheMPS2::defaultTMPpath, see Davidson::StoreVectorsOnDisk. Only a few full-length vectors then remain in RAM, and the operating system pages the subspace vectors in and out as they are streamed through. The matrix-vector product workspaces remain constrained by maxMemWorkMB. */
+         void setMaxMemTotalMB(const double maxMemTotalMB);
+         
+         //! Let GSDavidson work in the basis of configuration state functions (CSFs) with spin TwoS/2 instead of in the determinant basis
+         /** \param TwoS Twice the targeted spin; TwoS >= | Nel_up - Nel_down | and TwoS should have the same parity as Nel_up + Nel_down; a negative value switches back to the determinant basis
+             \return The number of CSFs, which is the length of the vectors in Davidson's algorithm
+             
+             The CSFs of a spatial configuration are the eigenvectors with eigenvalue S(S+1) of S^2 in the span of its determinants, constructed genealogically by coupling the open orbitals one by one. GSDavidson then only finds states with spin TwoS/2, and the Davidson vectors shrink by about the spin degeneracy. The matrix-vector products are still done in the determinant basis, and the vector inoutput of GSDavidson remains a vector of length getVecLength(0). */
+         unsigned int SpinAdapt(const int TwoS);
+         
          //! Return the global counter of the Slater determinant with the lowest energy
          /** \return The global counter of the Slater determinant with the lowest energy */
          unsigned int LowestEnergyDeterminant() const;
@@ -109,9 +138,18 @@ namespace CheMPS2{
              \return The energy of the given FCI vector, calculated by contraction of the 2-RDM with Gmat and ERI */
          double Fill2RDM(double * vector, double * TwoRDM) const;
          
+         //! Construct a weighted sum of (spin-summed) state and transition 2-RDMs in one pass: TwoRDM = sum_{r,s} weights[ r + num_vectors * s ] * Gamma^2_{rs}, with Gamma^2_{rs}(i,j,k,l) = sum_sigma,tau < r | a^+_i,sigma a^+_j,tau a_l,tau a_k,sigma | s >
+         /** \param vectors Array of num_vectors FCI vectors of length getVecLength(0)
+             \param num_vectors The number of FCI vectors
+             \param weights The symmetric weight matrix of size num_vectors * num_vectors; diagonal for a state-averaged 2-RDM
+             \param TwoRDM To store the weighted 2-RDM; needs to be of size getL()^4; point group symmetry shows in 2-RDM elements being zero
+             \return The weighted energy sum_{r,s} weights[ r + num_vectors * s ] < r | H | s >, calculated by contraction of the 2-RDM with Gmat and ERI */
+         double Fill2RDM(double ** vectors, const int num_vectors, const double * weights, double * TwoRDM) const;
+         
          //! Construct the (spin-summed) 3-RDM of a FCI vector: Gamma^3(i,j,k,l,m,n) = sum_sigma,tau,s < a^+_{i,sigma} a^+_{j,tau} a^+_{k,s} a_{n,s} a_{m,tau} a_{l,sigma} > = ThreeRDM[ i + L * ( j + L * ( k + L * ( l + L * ( m + L * n ) ) ) ) ]
          /** \param vector The FCI vector of length getVecLength(0)
-             \param ThreeRDM To store the 3-RDM; needs to be of size getL()^6; point group symmetry shows in 3-RDM elements being zero */
+             \param ThreeRDM To store the 3-RDM; needs to be of size getL()^6; point group symmetry shows in 3-RDM elements being zero
+             If the FCI instance was constructed with distributed=true, all MPI processes should call this function with the vector of the master process; all processes then obtain the 3-RDM. */
          void Fill3RDM(double * vector, double * ThreeRDM) const;
          
          //! Construct the (spin-summed) 4-RDM of a FCI vector: Gamma^4(i,j,k,l,p,q,r,t) = sum_sigma,tau,s,z < a^+_{i,sigma} a^+_{j,tau} a^+_{k,s} a^+_{l,z} a_{t,z} a_{r,s} a_{q,tau} a_{p,sigma} > = FourRDM[ i + L * ( j + L * ( k + L * ( l + L * ( p + L * ( q + L * ( r + L * t ) ) ) ) ) ) ]
@@ -119,18 +157,37 @@ namespace CheMPS2{
              \param FourRDM To store the 4-RDM; needs to be of size getL()^8; point group symmetry shows in 4-RDM elements being zero */
          void Fill4RDM(double * vector, double * FourRDM) const;
          
-         //! Construct the (spin-summed) contraction of the 4-RDM with the Fock operator: output(i,j,k,p,q,r) = sum_{l,t} Fock(l,t) * Gamma^4(i,j,k,l,p,q,r,t)
+         //! Construct the (spin-summed) contraction of the 4-RDM with the Fock operator: output(i,j,k,p,q,r) = sum_{l,t} Fock(l,t) * Gamma^4(i,j,k,l,p,q,r,t); the contraction is fused with the construction, so that the 4-RDM is never stored
          /** \param vector The FCI vector of length getVecLength(0)
              \param ThreeRDM The spin-summed 3-RDM as calculated by Fill3RDM
              \param Fock The symmetric Fock operator Fock(i,j) = Fock[ i + L * j ] = Fock[ j + L * i ]
-             \param output To store the contraction output(i,j,k,p,q,r) = output[ i + L * ( j + L * ( k + L * ( p + L * ( q + L * r ) ) ) ) ]; needs to be of size getL()^6; point group symmetry shows in elements being zero; has 12-fold permutation symmetry just like 3-RDM */
+             \param output To store the contraction output(i,j,k,p,q,r) = output[ i + L * ( j + L * ( k + L * ( p + L * ( q + L * r ) ) ) ) ]; needs to be of size getL()^6; point group symmetry shows in elements being zero; has 12-fold permutation symmetry just like 3-RDM
+             If the FCI instance was constructed with distributed=true, all MPI processes should call this function, just like Fill3RDM. */
          void Fock4RDM(double * vector, double * ThreeRDM, double * Fock, double * output) const;
          
+         //! Construct the part of Fock4RDM which belongs to orbital z: output(i,j,k,p,q,r) = sum_{l,t} Fock_z(l,t) * Gamma^4(i,j,k,l,p,q,r,t), with Fock_z(z,z) = Fock(z,z), Fock_z(z,t) = Fock(z,t) / 2 and Fock_z(t,z) = Fock(t,z) / 2 for t != z, and zero otherwise; the sum over z of the outputs is the output of Fock4RDM
+         /** \param vector The FCI vector of length getVecLength(0)
+             \param ThreeRDM The spin-summed 3-RDM as calculated by Fill3RDM
+             \param Fock The symmetric Fock operator Fock(i,j) = Fock[ i + L * j ] = Fock[ j + L * i ]
+             \param orbz The orbital z; different orbitals can be calculated independently, and the outputs accumulated, with memory getL()^6 per orbital
+             \param output To store the contraction; needs to be of size getL()^6; has 12-fold permutation symmetry just like 3-RDM
+             If the FCI instance was constructed with distributed=true, all MPI processes should call this function, just like Fill3RDM. */
+         void Fock4RDM(double * vector, double * ThreeRDM, double * Fock, const unsigned int orbz, double * output) const;
+         
+         //! Construct the (spin-summed) 3-RDM and the contraction of the 4-RDM with the Fock operator in one pass; the excitations of the vector are shared, and both are equal to the outputs of Fill3RDM and Fock4RDM
+         /** \param vector The FCI vector of length getVecLength(0)
+             \param Fock The symmetric Fock operator Fock(i,j) = Fock[ i + L * j ] = Fock[ j + L * i ]
+             \param ThreeRDM To store the 3-RDM; needs to be of size getL()^6
+             \param output To store the contraction of the 4-RDM with the Fock operator; needs to be of size getL()^6
+             If the FCI instance was constructed with distributed=true, all MPI processes should call this function, just like Fill3RDM. */
+         void Fill3RDMFock4RDM(double * vector, double * Fock, double * ThreeRDM, double * output) const;
+         
          //! Construct part of the 4-RDM: output(i,j,k,p,q,r) = Gamma^4(i,j,k,z,p,q,r,z)
          /** \param vector The FCI vector of length getVecLength(0)
              \param three_rdm The spin-summed 3-RDM as calculated by Fill3RDM
              \param orbz The orbital z which is fixed in Gamma^4(i,j,k,z,p,q,r,z)
-             \param output To store part of the 4-RDM output(i,j,k,p,q,r) = output[ i + L * ( j + L * ( k + L * ( p + L * ( q + L * r ) ) ) ) ]; needs to be of size getL()^6; point group symmetry shows in elements being zero; has 12-fold permutation symmetry just like 3-RDM */
+             \param output To store part of the 4-RDM output(i,j,k,p,q,r) = output[ i + L * ( j + L * ( k + L * ( p + L * ( q + L * r ) ) ) ) ]; needs to be of size getL()^6; point group symmetry shows in elements being zero; has 12-fold permutation symmetry just like 3-RDM
+             If the FCI instance was constructed with distributed=true, all MPI processes should call this function, just like Fill3RDM. */
          void Diag4RDM( double * vector, double * three_rdm, const unsigned int orbz, double * output ) const;
          
          //! Measure S(S+1) (spin squared)
@@ -231,6 +288,44 @@ namespace CheMPS2{
              \param TwoRDMrem If not NULL, TwoRDMrem[j] contains on exit the 2-RDM of a_{orbsRight[j], spin} | GSvector > */
          void GFmatrix_removal(const double alpha, const double beta, const double eta, int * orbsLeft, const unsigned int numLeft, int * orbsRight, const unsigned int numRight, const bool isUp, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartsGF, double * ImPartsGF, double ** TwoRDMreal=NULL, double ** TwoRDMimag=NULL, double ** TwoRDMrem=NULL) const;
          
+         //! Calculate the addition Green's function for many values of alpha with one Lanczos Krylov space per right orbital: GF[i+numLeft*(j+numRight*k)] = <GSvector| a_{orbsLeft[i], spin} [ alphas[k] + beta * Ham + I*eta ]^{-1} a^+_{orbsRight[j], spin} |GSvector>
+         /** \param alphas The real parts of the scalars in the operators, for example omega + GSenergy for a frequency scan
+             \param numAlpha The number of alphas
+             \param beta The real-valued prefactor of the Hamiltonian in the operator, for example -1.0
+             \param eta The imaginary part of the scalar in the operator, which should be strictly positive (see LanczosSolveSystem, the Lanczos vectors are not reorthogonalized either)
+             \param orbsLeft Array containing the left orbital indices
+             \param numLeft The number of left orbital indices
+             \param orbsRight Array containing the right orbital indices
+             \param numRight The number of right orbital indices
+             \param isUp Boolean which denotes if the added electron has spin projection up (alpha) or down (beta)
+             \param GSvector The ground state vector as calculated by GSDavidson
+             \param Ham The Hamiltonian, which contains the matrix elements
+             \param RePartsGF On exit RePartsGF[i+numLeft*(j+numRight*k)] contains the real part of the addition Green's function
+             \param ImPartsGF On exit ImPartsGF[i+numLeft*(j+numRight*k)] contains the imaginary part of the addition Green's function
+             \param maxKrylov The maximum dimension of each Krylov space
+             \param rtol The Krylov space is extended until the Green's function changes less than rtol relative to its largest element
+             \param refine If not NULL, the Green's function is recalculated with GFmatrix_addition for the alphas k with refine[k] true */
+         void GFmatrix_addition_lanczos(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, int * orbsLeft, const unsigned int numLeft, int * orbsRight, const unsigned int numRight, const bool isUp, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartsGF, double * ImPartsGF, const unsigned int maxKrylov=CheMPS2::FCI_LANCZOS_MAX_KRYLOV, const double rtol=CheMPS2::FCI_LANCZOS_RTOL, const bool * refine=NULL) const;
+         
+         //! Calculate the removal Green's function for many values of alpha with one Lanczos Krylov space per right orbital: GF[i+numLeft*(j+numRight*k)] = <GSvector| a^+_{orbsLeft[i], spin} [ alphas[k] + beta * Ham + I*eta ]^{-1} a_{orbsRight[j], spin} |GSvector>
+         /** \param alphas The real parts of the scalars in the operators, for example omega - GSenergy for a frequency scan
+             \param numAlpha The number of alphas
+             \param beta The real-valued prefactor of the Hamiltonian in the operator, for example 1.0
+             \param eta The imaginary part of the scalar in the operator, which should be strictly positive (see LanczosSolveSystem, the Lanczos vectors are not reorthogonalized either)
+             \param orbsLeft Array containing the left orbital indices
+             \param numLeft The number of left orbital indices
+             \param orbsRight Array containing the right orbital indices
+             \param numRight The number of right orbital indices
+             \param isUp Boolean which denotes if the removed electron has spin projection up (alpha) or down (beta)
+             \param GSvector The ground state vector as calculated by GSDavidson
+             \param Ham The Hamiltonian, which contains the matrix elements
+             \param RePartsGF On exit RePartsGF[i+numLeft*(j+numRight*k)] contains the real part of the removal Green's function
+             \param ImPartsGF On exit ImPartsGF[i+numLeft*(j+numRight*k)] contains the imaginary part of the removal Green's function
+             \param maxKrylov The maximum dimension of each Krylov space
+             \param rtol The Krylov space is extended until the Green's function changes less than rtol relative to its largest element
+             \param refine If not NULL, the Green's function is recalculated with GFmatrix_removal for the alphas k with refine[k] true */
+         void GFmatrix_removal_lanczos(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, int * orbsLeft, const unsigned int numLeft, int * orbsRight, const unsigned int numRight, const bool isUp, double * GSvector, CheMPS2::Hamiltonian * Ham, double * RePartsGF, double * ImPartsGF, const unsigned int maxKrylov=CheMPS2::FCI_LANCZOS_MAX_KRYLOV, const double rtol=CheMPS2::FCI_LANCZOS_RTOL, const bool * refine=NULL) const;
+         
          //! Calculate the density response Green's function (= forward - backward propagating part)
          /** \param omega The frequency value
              \param eta The regularization parameter (... + I*eta in the denominator)
@@ -280,6 +375,33 @@ namespace CheMPS2{
              \param checkError If true, the RMS error without preconditioner will be calculated and printed after convergence */
          void CGSolveSystem(const double alpha, const double beta, const double eta, double * RHS, double * RealSol, double * ImagSol, const bool checkError=true) const;
          
+         //! Calculate the solutions of the equations ( alpha + beta * Hamiltonian + I * eta ) Solution[i] = RHS[i] with block conjugate gradient, so that the right-hand sides share their search space and the Hamiltonian acts on several vectors at once
+         /** \param alpha The real part of the scalar in the operator
+             \param beta The real-valued prefactor of the Hamiltonian in the operator
+             \param eta The imaginary part of the scalar in the operator
+             \param num_rhs The number of right-hand sides
+             \param RHS Array of num_rhs real-valued right-hand sides with length getVecLength(0)
+             \param RealSol On exit RealSol[i] (length getVecLength(0)) contains the real part of the solution for RHS[i]
+             \param ImagSol On exit ImagSol[i] (length getVecLength(0)) contains the imaginary part of the solution for RHS[i]
+             \param checkError If true, the RMS error without preconditioner will be calculated and printed after convergence */
+         void CGSolveSystems(const double alpha, const double beta, const double eta, const unsigned int num_rhs, double ** RHS, double ** RealSol, double ** ImagSol, const bool checkError=true) const;
+         
+         //! Calculate < left_i | ( alphas[k] + beta * Hamiltonian + I * eta )^{-1} | RHS > for many alphas with a Lanczos continued fraction
+         /** The Lanczos vectors are not reorthogonalized. In finite precision, converged eigenvalues of the Hamiltonian then reappear as spurious copies in the tridiagonal matrix, which slows down the convergence for long Krylov spaces. The tridiagonal systems are solved without pivoting, which is only safe for eta > 0: with eta = 0 an alpha on a pole of the tridiagonal matrix gives a division by zero.
+             \param alphas The real parts of the scalars in the operators
+             \param numAlpha The number of alphas
+             \param beta The real-valued prefactor of the Hamiltonian in the operator
+             \param eta The imaginary part of the scalar in the operator, which should be strictly positive
+             \param RHS The real-valued right-hand side with length getVecLength(0)
+             \param leftVectors Array of numLeft vectors with length getVecLength(0); NULL entries give zero
+             \param numLeft The number of left vectors
+             \param stride The result for left vector i and alpha k is stored at index i + stride * k
+             \param RePart On exit contains the real parts of the results
+             \param ImPart On exit contains the imaginary parts of the results
+             \param maxKrylov The maximum dimension of the Krylov space
+             \param rtol The Krylov space is extended until the results change less than rtol relative to the largest result */
+         void LanczosSolveSystem(const double * alphas, const unsigned int numAlpha, const double beta, const double eta, double * RHS, double ** leftVectors, const unsigned int numLeft, const unsigned int stride, double * RePart, double * ImPart, const unsigned int maxKrylov=CheMPS2::FCI_LANCZOS_MAX_KRYLOV, const double rtol=CheMPS2::FCI_LANCZOS_RTOL) const;
+         
          //void CheckHamDEBUG() const;
          
          //! Function which returns a FCI coefficient
@@ -290,22 +412,44 @@ namespace CheMPS2{
          double getFCIcoeff(int * bits_up, int * bits_down, double * vector) const;
          
       protected:
+
+         // The microbenchmarks of chemps2-bench (CheMPS2/benchmark.cpp) time the protected kernels in isolation
+         friend class Benchmark;
       
 //==========> Functions involving Hamiltonian matrix elements
          
          //! Function which returns the diagonal elements of the FCI Hamiltonian (without Econstant!!) = Slater determinant energies
-         /** \param diag Vector with getVecLength(0) variables which contains on exit the diagonal elements of the FCI Hamiltonian */
-         void DiagHam(double * diag) const;
+         /** \param diag Vector with getVecLength(0) variables which contains on exit the diagonal elements of the FCI Hamiltonian
+             \param jumps If not NULL, only the alpha string irrep blocks with nonzero length in these num_irreps + 1 offsets are calculated, and stored at these offsets in diag */
+         void DiagHam(double * diag, const unsigned int * jumps=NULL) const;
          
          //! Function which returns the diagonal elements of the FCI Hamiltonian squared (without Econstant!!)
          /** \param output Vector with getVecLength(0) variables which contains on exit the diagonal elements of the FCI Hamiltonian squared */
          void DiagHamSquared(double * output) const;
+         
+         //! Helper function for DiagHamSquared: fill the occupations and the pair vectors n_a * ( 1 - n_k ) of a block of strings
+         /** \param strings The bit strings of the block
+             \param num The number of strings in the block
+             \param bits Work array of length L
+             \param occupations Array of size L * num to store the occupation numbers in
+             \param pairs Array of size L * L * num to store the pair vectors in, with the pairs ordered as in pair_orb1 and pair_orb2
+             \param pair_orb1 The first orbital of each pair
+             \param pair_orb2 The second orbital of each pair */
+         void DiagHamSquaredStrings( const unsigned int * strings, const int num, int * bits, double * occupations, double * pairs, const int * pair_orb1, const int * pair_orb2 ) const;
       
          //! Function which performs the Hamiltonian times Vector product (without Econstant!!) making use of the (ij|kl) = (ji|kl) = (ij|lk) = (ji|lk) symmetry of the electron repulsion integrals
          /** \param input The vector of length getVecLength(0) on which the Hamiltonian should act
              \param output Vector of length getVecLength(0) which contains on exit the Hamiltonian times input */
          void matvec( double * input, double * output ) const;
          
+         //! Function which performs the Hamiltonian times Vector product (without Econstant!!) for several vectors at once, so that the two-body part is a single matrix-matrix product
+         /** \param input Array of num_vec vectors of length getVecLength(0) on which the Hamiltonian should act
+             \param output Array of num_vec vectors of length getVecLength(0) which contain on exit the Hamiltonian times input
+             \param num_vec The number of vectors
+             \param distributed If true, only the work units owned by this MPI process are calculated, and output has to be summed over all processes; without MPI this has no effect
+             \param jumps If not NULL, the num_irreps + 1 offsets of the alpha string irrep blocks in input and output, which then only need to contain the blocks of MatvecNeededBlocks; otherwise the offsets of getVecLength(0) vectors */
+         void matvec( double ** input, double ** output, const unsigned int num_vec, const bool distributed=false, const unsigned int * jumps=NULL ) const;
+         
          //! Sandwich the Hamiltonian between two Slater determinants (return a specific element) (without Econstant!!)
          /** \param bits_bra_up Bit representation of the <bra| Slater determinant of the up (alpha) electrons (length L)
              \param bits_bra_down Bit representation of the <bra| Slater determinant of the down (beta) electrons (length L)
@@ -376,6 +520,14 @@ namespace CheMPS2{
              \param vec The vector which has to be rescaled */
          static void FCIdscal(const unsigned int vecLength, const double alpha, double * vec);
          
+         //! Orthonormalize a block of vectors with two passes of Gram-Schmidt, dropping the vectors which are numerically linearly dependent on the previous ones
+         /** \param vecLength The vector length
+             \param num_in The number of vectors in the input block
+             \param input The input block, vector i is stored at input + vecLength * i
+             \param output On exit the orthonormal block, vector i is stored at output + vecLength * i; it has space for num_in vectors
+             \return The number of orthonormal vectors in output */
+         static unsigned int FCIorthonormalize(const unsigned int vecLength, const unsigned int num_in, double * input, double * output);
+         
 //==========> Protected functions regarding the Green's functions
          
          //! Set thisVector to a creator/annihilator acting on otherVector
@@ -392,6 +544,11 @@ namespace CheMPS2{
              \param resultVector Vector with length getVecLength(0) where the result of the operation should be stored
              \param sourceVector Vector with length getVecLength(0) on which the number operator acts */
          void ActWithNumberOperator(const unsigned int orbIndex, double * resultVector, double * sourceVector) const;
+         
+         //! Set resultVector to the spin squared operator S^2 acting on sourceVector
+         /** \param resultVector Vector with length getVecLength(0) where the result of the operation should be stored
+             \param sourceVector Vector with length getVecLength(0) on which S^2 acts */
+         void ActWithSpinSquared(double * resultVector, double * sourceVector) const;
 
          //! Calculate the solution of the system Operator |Sol> = |RESID> with Operator = precon * [ ( alpha + beta * H )^2 + eta^2 ] * precon
          /** \param alpha The parameter alpha of the operator
@@ -413,6 +570,14 @@ namespace CheMPS2{
              \param out Array of size getVecLength(0), which contains on exit (alpha + beta * Hamiltonian) * in */
          void CGAlphaPlusBetaHAM(const double alpha, const double beta, double * in, double * out) const;
          
+         //! Calculate out[i] = (alpha + beta * Hamiltonian) * in[i] for several vectors at once (Econstant is taken into account!!)
+         /** \param alpha The parameter alpha of the operator
+             \param beta The parameter beta of the operator
+             \param num_vec The number of vectors
+             \param in Array of num_vec vectors of size getVecLength(0) on which the operator should be applied; unchanged on exit
+             \param out Array of num_vec vectors of size getVecLength(0), which contain on exit (alpha + beta * Hamiltonian) * in[i] */
+         void CGAlphaPlusBetaHAM(const double alpha, const double beta, const unsigned int num_vec, double ** in, double ** out) const;
+         
          //! Calculate out = [(alpha + beta * Hamiltonian)^2 + eta^2] * in (Econstant is taken into account!!)
          /** \param alpha The parameter alpha of the operator
              \param beta The parameter beta of the operator
@@ -422,6 +587,16 @@ namespace CheMPS2{
              \param temp Workspace of size getVecLength(0) */
          void CGoperator(const double alpha, const double beta, const double eta, double * in, double * temp, double * out) const;
          
+         //! Calculate out[i] = [(alpha + beta * Hamiltonian)^2 + eta^2] * in[i] for several vectors at once (Econstant is taken into account!!)
+         /** \param alpha The parameter alpha of the operator
+             \param beta The parameter beta of the operator
+             \param eta The parameter eta of the operator
+             \param num_vec The number of vectors
+             \param in Array of num_vec vectors of size getVecLength(0) on which the operator should be applied; unchanged on exit
+             \param temp Array of num_vec workspaces of size getVecLength(0)
+             \param out Array of num_vec vectors of size getVecLength(0), which contain on exit [(alpha + beta * Hamiltonian)^2 + eta^2] * in[i] */
+         void CGoperator(const double alpha, const double beta, const double eta, const unsigned int num_vec, double ** in, double ** temp, double ** out) const;
+         
          //! Calculate (without approximation) diagonal = diag[ (alpha + beta * Hamiltonian)^2 + eta^2 ] (Econstant is taken into account!!)
          /** \param alpha The parameter alpha of the operator
              \param beta The parameter beta of the operator
@@ -439,6 +614,25 @@ namespace CheMPS2{
              \param anni The orbital index of the annihilator
              \param orig_target_irrep The irrep of the orig_vector */
          void apply_excitation( double * orig_vector, double * result_vector, const int crea, const int anni, const int orig_target_irrep ) const;
+         
+         //! Calculate the transition elements < bra | E_{crea,anni} | ket > for all crea >= crea_min and anni >= anni_min in one pass over the excitation lists, without intermediate vectors
+         /** \param bra The bra vector, with target irrep TargetIrrep; or two interleaved bra vectors bra[ 2 * index + b ]
+             \param bra_trans The bra vectors with transposed blocks, see transpose_blocks
+             \param num_bras The number of bra vectors, 1 or 2
+             \param ket The ket vector
+             \param ket_trans The ket vector with transposed blocks, see transpose_blocks
+             \param ket_target_irrep The irrep of the ket vector
+             \param crea_min The smallest creator orbital index which is required
+             \param anni_min The smallest annihilator orbital index which is required
+             \param result To store result[ crea + L * ( anni + L * b ) ] = < bra_b | E_{crea,anni} | ket >; needs to be of size num_bras * getL()^2; the other elements are not set */
+         void transition_excitations( double * bra, double * bra_trans, const int num_bras, double * ket, double * ket_trans, const int ket_target_irrep, const unsigned int crea_min, const unsigned int anni_min, double * result ) const;
+         
+         //! Transpose the blocks of num_vecs interleaved vectors with a given irrep_center: result[ vec + num_vecs * ( jump + cnt_down + dim_down * cnt_up ) ] = origin[ vec + num_vecs * ( jump + cnt_up + dim_up * cnt_down ) ], with jump = irrep_center_jumps[ irrep_center ][ irrep_up ]
+         /** \param origin The vectors
+             \param result To store the vectors with transposed blocks
+             \param irrep_center The irrep_center of the vectors, see irrep_center_jumps
+             \param num_vecs The number of interleaved vectors */
+         void transpose_blocks( double * origin, double * result, const int irrep_center, const int num_vecs ) const;
       
       private:
       
@@ -448,6 +642,9 @@ namespace CheMPS2{
          //! The maximum number of MB which can be used to store both HXVworkbig1 and HXVworkbig2
          double maxMemWorkMB;
          
+         //! The maximum total number of MB for GSDavidson, or zero for no limit; see setMaxMemTotalMB
+         double maxMemTotalMB;
+         
          //! The constant term of the Hamiltonian
          double Econstant;
          
@@ -493,17 +690,17 @@ namespace CheMPS2{
          //! For irrep "irrep" and counter of the down (beta) Slater determinant "counter" (0 <= counter < numPerIrrep_down[ irrep ]) cnt2str_down[ irrep ][ counter ] returns the bitstring representation of the corresponding down (beta) Slater determinant
          unsigned int ** cnt2str_down;
          
-         //! For irrep "irrep_result" and up (alpha) Slater determinant counter "result" lookup_cnt_alpha[ irrep_result ][ i + L * ( j + L * result ) ] returns the counter "origin" which corresponds to | result > = +/- E^{alpha}_ij | origin > or | origin > = +/- E^{alpha}_ji | result >
-         int *** lookup_cnt_alpha;
+         //! For irrep "irrep_result" and excitation ij = i + L * j, lookup_num_alpha[ irrep_result ][ ij ] is the number of up (alpha) Slater determinants "result" for which | result > = +/- E^{alpha}_ij | origin > is nonzero
+         int ** lookup_num_alpha;
          
-         //! For irrep "irrep_result" and down (beta) Slater determinant counter "result" lookup_cnt_beta[ irrep_result ][ i + L * ( j + L * result ) ] returns the counter "origin" which corresponds to | result > = +/- E^{beta}_ij | origin > or | origin > = +/- E^{beta}_ji | result >
-         int *** lookup_cnt_beta;
+         //! For irrep "irrep_result" and excitation ij = i + L * j, lookup_num_beta[ irrep_result ][ ij ] is the number of down (beta) Slater determinants "result" for which | result > = +/- E^{beta}_ij | origin > is nonzero
+         int ** lookup_num_beta;
          
-         //! For irrep "irrep_result" and up (alpha) Slater determinant counter "result" lookup_sign_alpha[ irrep_result ][ i + L * ( j + L * result ) ] returns the sign s which corresponds to | result > = s * E^{alpha}_ij | origin >
-         int *** lookup_sign_alpha;
+         //! For irrep "irrep_result" and excitation ij = i + L * j, the nth (0 <= n < lookup_num_alpha[ irrep_result ][ ij ]) nonzero excitation | result > = s * E^{alpha}_ij | origin > is stored as lookup_alpha[ irrep_result ][ ij ][ 2 * n ] = result and lookup_alpha[ irrep_result ][ ij ][ 2 * n + 1 ] = s * ( origin + 1 ), with increasing result
+         int *** lookup_alpha;
          
-         //! For irrep "irrep_result" and down (beta) Slater determinant counter "result" lookup_sign_beta[ irrep_result ][ i + L * ( j + L * result ) ] returns the sign s which corresponds to | result > = s * E^{beta}_ij | origin >
-         int *** lookup_sign_beta;
+         //! For irrep "irrep_result" and excitation ij = i + L * j, the nth (0 <= n < lookup_num_beta[ irrep_result ][ ij ]) nonzero excitation | result > = s * E^{beta}_ij | origin > is stored as lookup_beta[ irrep_result ][ ij ][ 2 * n ] = result and lookup_beta[ irrep_result ][ ij ][ 2 * n + 1 ] = s * ( origin + 1 ), with increasing result
+         int *** lookup_beta;
          
          //! For irrep_center = irrep_creator x irrep_annihilator the number of corresponding excitation pairs E_{creator <= annihilator} is given by irrep_center_num[ irrep_center ]
          unsigned int * irrep_center_num;
@@ -520,7 +717,7 @@ namespace CheMPS2{
          //! Number of doubles in each of the HVXworkbig arrays
          unsigned long long HXVsizeWorkspace;
          
-         //! Work space of size L*L*L*L
+         //! Work space of size L*L*L*L + L*L
          double * HXVworksmall;
          
          //! Work space of size HXVsizeWorkspace
@@ -538,18 +735,133 @@ namespace CheMPS2{
          //! Initialize a part of the private variables
          void StartupIrrepCenter();
          
-         //! Actual routine used by Fill3RDM, Fock4RDM, Diag4RDM
-         double Driver3RDM(double * vector, double * output, double * three_rdm, double * fock, const unsigned int orbz) const;
+         //! Twice the spin of the configuration state functions (CSFs) used in GSDavidson, or -1 for the determinant basis
+         int csf_TwoS;
+         
+         //! The number of CSFs
+         unsigned int csf_num;
+         
+         //! The number of spatial configurations which have CSFs
+         unsigned int csf_num_conf;
+         
+         //! Spatial configuration conf has csf_conf_open[ conf ] singly occupied orbitals
+         unsigned int * csf_conf_open;
+         
+         //! The determinant with spin pattern p ( 0 <= p < csf_conf_det[ conf + 1 ] - csf_conf_det[ conf ] ) of spatial configuration conf has global counter csf_det[ csf_conf_det[ conf ] + p ]
+         unsigned int * csf_conf_det;
+         
+         //! Global counters of the determinants of the spatial configurations, see csf_conf_det
+         unsigned int * csf_det;
+         
+         //! The CSFs of spatial configuration conf have indices csf_conf_fun[ conf ] <= index < csf_conf_fun[ conf + 1 ]
+         unsigned int * csf_conf_fun;
+         
+         //! For num_open singly occupied orbitals, the coefficient of spin pattern p in the CSF f is csf_coeff[ num_open ][ p + num_patterns * f ]; the spin patterns are the alpha occupations of the open orbitals in increasing binary order
+         double ** csf_coeff;
+         
+         //! Delete the CSF basis of SpinAdapt
+         void DeleteCSF();
+         
+         //! Expand a vector in the CSF basis into the determinant basis
+         /** \param csf_vector The vector with csf_num CSF coefficients
+             \param det_vector The vector of length getVecLength(0) which contains the determinant coefficients on exit */
+         void CSFtoDet(double * csf_vector, double * det_vector) const;
+         
+         //! Project a vector in the determinant basis onto the CSF basis
+         /** \param det_vector The vector of length getVecLength(0) with determinant coefficients
+             \param csf_vector The vector which contains the csf_num CSF coefficients on exit */
+         void DetToCSF(double * det_vector, double * csf_vector) const;
+         
+         //! Store the subspace vectors of a Davidson instance of GSDavidson on disk if they do not fit in maxMemTotalMB
+         /** \param solver The Davidson instance
+             \param veclength The length of its vectors
+             \param DVDSN_NUM_VEC The maximum number of subspace vectors
+             \param num_extra The number of doubles in other full-length arrays of the caller */
+         void SetupDavidsonStorage(Davidson & solver, const unsigned int veclength, const int DVDSN_NUM_VEC, const unsigned long long num_extra) const;
+         
+         //! Davidson's algorithm of GSDavidson in the CSF basis
+         double GSDavidsonCSF(double * inoutput, const int DVDSN_NUM_VEC) const;
+         
+         //! Whether GSDavidson and MultiRootDavidson distribute the matrix-vector products over the MPI processes
+         bool mpi_distributed;
+         
+         //! The MPI process which owns each alpha string irrep block of the target irrep vectors of GSDavidson, if mpi_distributed
+         int * mpi_block_owner;
+         
+         //! Matrix-vector product for Davidson's algorithm: if mpi_distributed, the master process sends the blocks which the helpers need and sums the parts which they return; otherwise matvec
+         void DistributedMatvec( double ** input, double ** output, const int num_vec ) const;
+         
+         //! Loop of the MPI helper processes for DistributedMatvec; returns when the master process sends zero vectors
+         void DistributedMatvecHelp() const;
+         
+         //! The number of vectors which matvec handles together, so that at least one full column of each fits in the workspaces
+         unsigned int MatvecMaxVec() const;
+         
+         //! Mark the alpha string irrep blocks of the target irrep which the work units of one MPI process read and write in a distributed matvec
+         /** \param num_vec The number of vectors of the matvec call
+             \param rank The MPI process
+             \param needed Array of num_irreps booleans which contains on exit whether the work units of rank use each block */
+         void MatvecNeededBlocks( const unsigned int num_vec, const int rank, bool * needed ) const;
+         
+         //! Fill the offsets of the alpha string irrep blocks of the target irrep which are owned by one MPI process in its segment of the vectors
+         /** \param owners The owner of each block
+             \param rank The MPI process
+             \param jumps Array of num_irreps + 1 offsets; the blocks which are not owned by rank have zero length
+             \return The length of the segment */
+         unsigned int SegmentJumps( const int * owners, const int rank, unsigned int * jumps ) const;
+         
+         //! Matrix-vector product which all MPI processes call together; each process holds the blocks it owns, receives the other blocks which its work units read, and sends the parts of the blocks which they write to their owners
+         /** \param input Array of num_vec segments on which the Hamiltonian should act
+             \param output Array of num_vec segments which contain on exit the Hamiltonian times input
+             \param num_vec The number of vectors
+             \param owners The owner of each alpha string irrep block of the target irrep
+             \param jumps The offsets of SegmentJumps of this process */
+         void BlockMatvec( double ** input, double ** output, const int num_vec, const int * owners, const unsigned int * jumps ) const;
+         
+         //! Send the blocks of a vector between the full vector of the master process and the segments of their owners in mpi_block_owner
+         /** \param full The full vector of the master process
+             \param segment The segment of this process
+             \param jumps The offsets of SegmentJumps of this process
+             \param scatter If true, the blocks are copied from full to the segments; otherwise from the segments to full */
+         void ScatterGatherBlocks( double * full, double * segment, const unsigned int * jumps, const bool scatter ) const;
+         
+         //! Davidson's algorithm of GSDavidson if mpi_distributed: all MPI processes hold the segments of the vectors which they own, and the inner products are summed over the processes
+         double GSDavidsonDistributed(double * inoutput, const int DVDSN_NUM_VEC) const;
+         
+         //! Actual routine used by Fill3RDM, Fock4RDM, Fill3RDMFock4RDM, Diag4RDM; the first excitations E_{crea1,anni1} are distributed over the OpenMP threads, each of which needs three work vectors of length max( getVecLength(irrep) )
+         /** \param vector The FCI vector of length getVecLength(0)
+             \param three_rdm The 3-RDM, which is calculated if fill_3rdm, and is needed on entry otherwise
+             \param fill_3rdm Whether or not the 3-RDM is calculated
+             \param output To store the 4-RDM contraction; if NULL, only the 3-RDM is calculated
+             \param fock The Fock operator for the contraction; if NULL, the 4-RDM with orbital orbz fixed is calculated
+             \param orbz The fixed orbital z, or L + 1 if it is not used
+             \return The wall time in seconds */
+         double Driver3RDM(double * vector, double * three_rdm, const bool fill_3rdm, double * output, double * fock, const unsigned int orbz) const;
+
+         //! Alpha excitation kernels, which loop over the num_exc nonzero excitations in the list exc of lookup_alpha
+         static void excite_alpha_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int dim_down, double * origin, double * result, const int num_exc, const int * exc );
+         static void excite_alpha_first( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, const int num_exc, const int * exc );
+         static void excite_alpha_second_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, const int num_exc, const int * exc );
+
+         //! Beta excitation kernels, which loop over the num_exc nonzero excitations in the list exc of lookup_beta
+         static void excite_beta_omp( const unsigned int dim_up, double * origin, double * result, const int num_exc, const int * exc );
+         static void excite_beta_first( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, const int num_exc, const int * exc );
+         static void excite_beta_second_omp( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, const int num_exc, const int * exc );
 
-         //! Alpha excitation kernels
-         static void excite_alpha_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int dim_down, double * origin, double * result, int * signmap, int * countmap );
-         static void excite_alpha_first( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap );
-         static void excite_alpha_second_omp( const unsigned int dim_new_up, const unsigned int dim_old_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap );
+         //! Find the first entry of an excitation list with result counter larger than or equal to a given value
+         /** \param num_exc The number of excitations in the list
+             \param exc The excitation list of lookup_alpha or lookup_beta
+             \param value The result counter to look for
+             \return The first entry n with exc[ 2 * n ] >= value, or num_exc if there is none */
+         static int lookup_first( const int num_exc, const int * exc, const unsigned int value );
 
-         //! Beta excitation kernels
-         static void excite_beta_omp( const unsigned int dim_up, const unsigned int dim_new_down, double * origin, double * result, int * signmap, int * countmap );
-         static void excite_beta_first( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap );
-         static void excite_beta_second_omp( const unsigned int dim_up, const unsigned int start_down, const unsigned int stop_down, double * origin, double * result, int * signmap, int * countmap );
+         //! Excite a bit string on the fly: sign | result > = E_{crea,anni} | origin >
+         /** \param string_result The bit string of | result >
+             \param crea The creator orbital index
+             \param anni The annihilator orbital index
+             \param string_origin Contains on exit the bit string of | origin > if the sign is nonzero
+             \return The sign, or zero if | result > can not be reached */
+         static int excite_string( const unsigned int string_result, const unsigned int crea, const unsigned int anni, unsigned int & string_origin );
 
    };
 
@@ -66,8 +66,9 @@ namespace CheMPS2{
              \param Qtensors Complementary operators of three sandwiched 2nd quantized operators
              \param Xtensors Pointer to the completely contracted terms
              \param nLower Number of lower-lying states to project out
-             \param VeffTilde The projection operators to project the nLower lower-lying states out */
-         double SolveDAVIDSON(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower = 0, double ** VeffTilde = NULL) const;
+             \param VeffTilde The projection operators to project the nLower lower-lying states out
+             \param num_matvec If not NULL, the number of Davidson matrix-vector multiplications is stored here (only on MPI_CHEMPS2_MASTER) */
+         double SolveDAVIDSON(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower = 0, double ** VeffTilde = NULL, int * num_matvec = NULL) const;
          
          //! Phase function
          /** \param TwoTimesPower Twice the power of the phase (-1)^{power}
@@ -75,6 +76,9 @@ namespace CheMPS2{
          static int phase(const int TwoTimesPower){ return (((TwoTimesPower/2)%2)!=0)?-1:1; }
          
       private:
+
+         // The microbenchmarks of chemps2-bench (CheMPS2/benchmark.cpp) time the private kernels in isolation
+         friend class Benchmark;
       
          //The SyBookkeeper
          const SyBookkeeper * denBK;
@@ -92,7 +96,7 @@ namespace CheMPS2{
          void fillHeffDiag(double * memHeffDiag, const Sobject * denS, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const;
          
          //Solve Davidson for the MPI_CHEMPS2_MASTER process
-         double SolveDAVIDSON_main(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const;
+         double SolveDAVIDSON_main(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde, int * num_matvec) const;
          
          //Solve Davidson for the helper processes
          double SolveDAVIDSON_help(Sobject * denS, TensorL *** Ltensors, TensorOperator **** Atensors, TensorOperator **** Btensors, TensorOperator **** Ctensors, TensorOperator **** Dtensors, TensorS0 **** S0tensors, TensorS1 **** S1tensors, TensorF0 **** F0tensors, TensorF1 **** F1tensors, TensorQ *** Qtensors, TensorX ** Xtensors, int nLower, double ** VeffTilde) const;
@@ -0,0 +1,201 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef HEFFPROFILER_CHEMPS2_H
+#define HEFFPROFILER_CHEMPS2_H
+
+#include <string>
+#include <sys/time.h>
+
+#include "Lapack.h"
+
+//The diagram families of Heff::makeHeff and Heff::fillHeffDiag
+#define CHEMPS2_HEFF_1A             0
+#define CHEMPS2_HEFF_1B             1
+#define CHEMPS2_HEFF_1C             2
+#define CHEMPS2_HEFF_1D             3
+#define CHEMPS2_HEFF_EXC            4
+#define CHEMPS2_HEFF_2A1S0          5
+#define CHEMPS2_HEFF_2A2S0          6
+#define CHEMPS2_HEFF_2A1S1          7
+#define CHEMPS2_HEFF_2A2S1          8
+#define CHEMPS2_HEFF_2A3S0          9
+#define CHEMPS2_HEFF_2A3S1          10
+#define CHEMPS2_HEFF_2B1_2B2        11
+#define CHEMPS2_HEFF_2C1_2C2        12
+#define CHEMPS2_HEFF_2D             13
+#define CHEMPS2_HEFF_2E1_2E2        14
+#define CHEMPS2_HEFF_2F1_2F2        15
+#define CHEMPS2_HEFF_2B3S0          16
+#define CHEMPS2_HEFF_2C3S0          17
+#define CHEMPS2_HEFF_2E3S0          18
+#define CHEMPS2_HEFF_2F3S0          19
+#define CHEMPS2_HEFF_2B3S1          20
+#define CHEMPS2_HEFF_2C3S1          21
+#define CHEMPS2_HEFF_2E3S1          22
+#define CHEMPS2_HEFF_2F3S1          23
+#define CHEMPS2_HEFF_3A_3D          24
+#define CHEMPS2_HEFF_3B_3I          25
+#define CHEMPS2_HEFF_3C             26
+#define CHEMPS2_HEFF_3E_3H          27
+#define CHEMPS2_HEFF_3K_3F          28
+#define CHEMPS2_HEFF_3L_3G          29
+#define CHEMPS2_HEFF_3J             30
+#define CHEMPS2_HEFF_4A1_4A2S0      31
+#define CHEMPS2_HEFF_4A1_4A2S1      32
+#define CHEMPS2_HEFF_4A3_4A4S0      33
+#define CHEMPS2_HEFF_4A3_4A4S1      34
+#define CHEMPS2_HEFF_4B1_4B2S0      35
+#define CHEMPS2_HEFF_4B1_4B2S1      36
+#define CHEMPS2_HEFF_4B3_4B4S0      37
+#define CHEMPS2_HEFF_4B3_4B4S1      38
+#define CHEMPS2_HEFF_4C1_4C2S0      39
+#define CHEMPS2_HEFF_4C1_4C2S1      40
+#define CHEMPS2_HEFF_4C3_4C4S0      41
+#define CHEMPS2_HEFF_4C3_4C4S1      42
+#define CHEMPS2_HEFF_4D             43
+#define CHEMPS2_HEFF_4E             44
+#define CHEMPS2_HEFF_4F             45
+#define CHEMPS2_HEFF_4G             46
+#define CHEMPS2_HEFF_4H             47
+#define CHEMPS2_HEFF_4I             48
+#define CHEMPS2_HEFF_4J1_4J2S0      49
+#define CHEMPS2_HEFF_4J1_4J2S1      50
+#define CHEMPS2_HEFF_4J3_4J4S0      51
+#define CHEMPS2_HEFF_4J3_4J4S1      52
+#define CHEMPS2_HEFF_4K1_4K2S0      53
+#define CHEMPS2_HEFF_4L1_4L2S0      54
+#define CHEMPS2_HEFF_4K1_4K2S1      55
+#define CHEMPS2_HEFF_4L1_4L2S1      56
+#define CHEMPS2_HEFF_4K3_4K4S0      57
+#define CHEMPS2_HEFF_4L3_4L4S0      58
+#define CHEMPS2_HEFF_4K3_4K4S1      59
+#define CHEMPS2_HEFF_4L3_4L4S1      60
+#define CHEMPS2_HEFF_5A             61
+#define CHEMPS2_HEFF_5B             62
+#define CHEMPS2_HEFF_5C             63
+#define CHEMPS2_HEFF_5D             64
+#define CHEMPS2_HEFF_5E             65
+#define CHEMPS2_HEFF_5F             66
+#define CHEMPS2_HEFF_DIAGONAL       67
+#define CHEMPS2_HEFF_NUM_DIAGRAMS   68
+
+namespace CheMPS2{
+/** HeffProfiler class.
+    \date October 18, 2026
+
+    The HeffProfiler class contains the opt-in instrumentation of the effective Hamiltonian diagrams. When enabled, the wall time, the number of calls and the number of dgemm flops are recorded for each diagram family, per OpenMP thread. With MPI, each process records its own counters. The counters of the current sweep can be summarized with print_sweep_summary(), which also folds them into the totals, and the totals can be dumped to a machine-readable file with dump(). When the profiler is disabled, the probes only cost a single boolean check. */
+   class HeffProfiler{
+
+      public:
+
+         //! Enable or disable the profiler; enabling (re)allocates and clears all counters
+         /** \param on Whether or not to record the diagram counters */
+         static void enable( const bool on );
+
+         //! Whether or not the profiler is enabled
+         /** \return Whether or not the profiler is enabled */
+         static bool enabled(){ return active; }
+
+         //! Clear the counters of the current sweep and the totals
+         static void reset();
+
+         //! Get the name of a diagram family
+         /** \param diagram The diagram family number
+             \return The name of the diagram family */
+         static const char * name( const int diagram );
+
+         //! Print the counters of the current sweep (summed over all threads and MPI processes) on the master process, and fold them into the totals
+         static void print_sweep_summary();
+
+         //! Write the totals (including the current sweep) per MPI process, thread and diagram family to a text file in comma-separated format. With MPI, every process writes its own file, with the rank appended to the filename.
+         /** \param filename The name of the file */
+         static void dump( const std::string filename );
+
+         //! dgemm_ wrapper which attributes 2*m*n*k flops to the diagram family currently probed by the calling thread
+         static void dgemm( char * transA, char * transB, int * m, int * n, int * k, double * alpha, double * A, int * lda, double * B, int * ldb, double * beta, double * C, int * ldc ){
+            dgemm_( transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc );
+            if ( active ){ add_flops( 2.0 * ( *m ) * ( *n ) * ( *k ) ); }
+         }
+
+         /** Probe class.
+
+             Scoped timer for one call of a diagram family: place it at the start of the function body. */
+         class Probe{
+
+            public:
+
+               //! Constructor: starts the timer if the profiler is enabled
+               /** \param diagram The diagram family number */
+               Probe( const int diagram ){
+                  family = diagram;
+                  if ( active ){
+                     start_probe( family );
+                     gettimeofday( &start, NULL );
+                  }
+               }
+
+               //! Destructor: stops the timer and accumulates the counters if the profiler is enabled
+               ~Probe(){
+                  if ( active ){
+                     struct timeval end;
+                     gettimeofday( &end, NULL );
+                     stop_probe( family, ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec ) );
+                  }
+               }
+
+            private:
+
+               int family;
+               struct timeval start;
+
+         };
+
+      private:
+
+         // Whether or not the profiler is enabled
+         static bool active;
+
+         // The number of threads for which counters are allocated
+         static int num_threads;
+
+         // The diagram family currently probed per thread, -1 if none
+         static int * current;
+
+         // Counters of the current sweep: [ thread * CHEMPS2_HEFF_NUM_DIAGRAMS + diagram ]
+         static double * sweep_time;
+         static double * sweep_flop;
+         static long long * sweep_call;
+
+         // Accumulated counters of all previous sweeps
+         static double * total_time;
+         static double * total_flop;
+         static long long * total_call;
+
+         static int thread_num(); // -1 for threads which did not exist at enable()
+         static void start_probe( const int diagram );
+         static void stop_probe( const int diagram, const double elapsed );
+         static void add_flops( const double flops );
+         static void fold_sweep();
+         static void deallocate();
+
+   };
+}
+
+#endif
@@ -33,8 +33,11 @@ extern "C" {
    void dgemv_(char *trans, int *m, int *n, double *alpha, double *A, int *lda, double *X, int *incx, double *beta, double *Y, int *incy);
    double ddot_(int *n,double *x,int *incx,double *y,int *incy);
    void dsyev_(char *jobz,char *uplo,int *n,double *A,int *lda,double *W,double *work,int *lwork,int *info);
+   void dsyevd_(char *jobz,char *uplo,int *n,double *A,int *lda,double *W,double *work,int *lwork,int *iwork,int *liwork,int *info);
    void dgesdd_(char* JOBZ, int* M, int* N, double* A, int* LDA, double* S, double* U, int* LDU, double* VT, int* LDVT, double* WORK, int* LWORK, int* IWORK, int* INFO);
    void dlasrt_(char* id, int* n, double* vec, int* info);
+   void dpotrf_(char * uplo, int * n, double * A, int * lda, int * info);
+   void dpotrs_(char * uplo, int * n, int * nrhs, double * A, int * lda, double * B, int * ldb, int * info);
    double dlansy_(char * norm, char * uplo, int * dimR, double * mx, int * lda, double * work);
    double dlange_(char * norm, int * m, int * n, double * mx, int * lda, double * work);
 
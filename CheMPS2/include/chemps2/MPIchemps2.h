@@ -27,6 +27,7 @@
    #include <mpi.h>
    #include <assert.h>
    #include "Tensor.h"
+   #include "Tracer.h"
 
    #define MPI_CHEMPS2_MASTER   0
 
@@ -114,12 +115,21 @@ namespace CheMPS2{
          //! Destructor
          virtual ~MPIchemps2(){}
          
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Get the communicator of the MPI processes which work together
+         /** \return MPI_COMM_WORLD, or between mpi_split_groups and mpi_merge_groups the communicator of the group of this process */
+         static MPI_Comm & mpi_comm(){
+            static MPI_Comm comm = MPI_COMM_WORLD;
+            return comm;
+         }
+         #endif
+
          //! Get the number of MPI processes
          /** \return The number of MPI processes */
          static int mpi_size(){
             #ifdef CHEMPS2_MPI_COMPILATION
                int size;
-               MPI_Comm_size( MPI_COMM_WORLD, &size );
+               MPI_Comm_size( mpi_comm(), &size );
                return size;
             #else
                return 1;
@@ -131,7 +141,7 @@ namespace CheMPS2{
          static int mpi_rank(){
             #ifdef CHEMPS2_MPI_COMPILATION
                int rank;
-               MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+               MPI_Comm_rank( mpi_comm(), &rank );
                return rank;
             #else
                return 0;
@@ -153,6 +163,72 @@ namespace CheMPS2{
          }
          #endif
          
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Split MPI_COMM_WORLD in groups of consecutive ranks, which become the communicators of their processes (see mpi_comm)
+         /** \param num_groups The number of groups, at most the number of MPI processes
+             \return The group of this process; MPI_CHEMPS2_MASTER of MPI_COMM_WORLD is in group 0 */
+         static int mpi_split_groups(const int num_groups){
+            int world_rank, world_size;
+            MPI_Comm_rank( MPI_COMM_WORLD, &world_rank );
+            MPI_Comm_size( MPI_COMM_WORLD, &world_size );
+            assert(( num_groups >= 1 ) && ( num_groups <= world_size ));
+            const int group = ( world_rank * num_groups ) / world_size;
+            MPI_Comm_split( MPI_COMM_WORLD, group, world_rank, &mpi_comm() );
+            return group;
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Free the group communicators of mpi_split_groups, and let all processes work together on MPI_COMM_WORLD again
+         static void mpi_merge_groups(){
+            MPI_Comm_free( &mpi_comm() );
+            mpi_comm() = MPI_COMM_WORLD;
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Create a task counter at MPI_CHEMPS2_MASTER of MPI_COMM_WORLD, which starts at zero; should be called by all processes of MPI_COMM_WORLD
+         /** \return The window of the task counter */
+         static MPI_Win task_counter_create(){
+            int * counter = NULL;
+            MPI_Win window;
+            int world_rank;
+            MPI_Comm_rank( MPI_COMM_WORLD, &world_rank );
+            const MPI_Aint bytes = (( world_rank == MPI_CHEMPS2_MASTER ) ? sizeof( int ) : 0 );
+            MPI_Win_allocate( bytes, sizeof( int ), MPI_INFO_NULL, MPI_COMM_WORLD, &counter, &window );
+            if ( world_rank == MPI_CHEMPS2_MASTER ){
+               MPI_Win_lock( MPI_LOCK_EXCLUSIVE, MPI_CHEMPS2_MASTER, 0, window );
+               counter[ 0 ] = 0;
+               MPI_Win_unlock( MPI_CHEMPS2_MASTER, window );
+            }
+            MPI_Barrier( MPI_COMM_WORLD );
+            return window;
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Fetch the value of a task counter and increment it, without the participation of the other processes
+         /** \param window The window of the task counter
+             \return The value of the task counter before the increment */
+         static int task_counter_next(MPI_Win window){
+            Tracer::Scope scope( "MPI_Fetch_and_op", "mpi" );
+            int one = 1;
+            int task;
+            MPI_Win_lock( MPI_LOCK_SHARED, MPI_CHEMPS2_MASTER, 0, window );
+            MPI_Fetch_and_op( &one, &task, MPI_INT, MPI_CHEMPS2_MASTER, 0, MPI_SUM, window );
+            MPI_Win_unlock( MPI_CHEMPS2_MASTER, window );
+            return task;
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Free a task counter; should be called by all processes of MPI_COMM_WORLD
+         /** \param window The window of the task counter */
+         static void task_counter_free(MPI_Win & window){
+            MPI_Win_free( &window );
+         }
+         #endif
+
          #ifdef CHEMPS2_MPI_COMPILATION
          //! Get the owner of the X-tensors
          static int owner_x(){ return MPI_CHEMPS2_MASTER; }
@@ -231,13 +307,32 @@ namespace CheMPS2{
          }
          #endif
          
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Get the owner of a work unit of the distributed FCI matrix-vector product
+         /** \param unit The number of the work unit, as counted in FCI::matvec
+             \return The owner rank */
+         static int owner_fci_unit(const int unit){
+            return unit % mpi_size();
+         }
+         #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Get the owner of a work unit of the distributed CASPT2 matrix-vector product
+         /** \param unit The number of the work unit, as counted in CASPT2::matvec
+             \return The owner rank */
+         static int owner_caspt2_unit(const int unit){
+            return unit % mpi_size();
+         }
+         #endif
+         
          #ifdef CHEMPS2_MPI_COMPILATION
          //! Broadcast a tensor
          /** \param object The tensor to be broadcasted
              \param ROOT The MPI process which should broadcast */
          static void broadcast_tensor(Tensor * object, int ROOT){
+            Tracer::Scope scope( "MPI_Bcast", "mpi" );
             int arraysize = object->gKappa2index(object->gNKappa());
-            MPI_Bcast(object->gStorage(), arraysize, MPI_DOUBLE, ROOT, MPI_COMM_WORLD);
+            MPI_Bcast(object->gStorage(), arraysize, MPI_DOUBLE, ROOT, mpi_comm());
          }
          #endif
          
@@ -247,7 +342,8 @@ namespace CheMPS2{
              \param length The length of the array
              \param ROOT The MPI process which should broadcast */
          static void broadcast_array_double(double * array, int length, int ROOT){
-            MPI_Bcast(array, length, MPI_DOUBLE, ROOT, MPI_COMM_WORLD);
+            Tracer::Scope scope( "MPI_Bcast", "mpi" );
+            MPI_Bcast(array, length, MPI_DOUBLE, ROOT, mpi_comm());
          }
          #endif
          
@@ -257,7 +353,8 @@ namespace CheMPS2{
              \param length The length of the array
              \param ROOT The MPI process which should broadcast */
          static void broadcast_array_int(int * array, int length, int ROOT){
-            MPI_Bcast(array, length, MPI_INT, ROOT, MPI_COMM_WORLD);
+            Tracer::Scope scope( "MPI_Bcast", "mpi" );
+            MPI_Bcast(array, length, MPI_INT, ROOT, mpi_comm());
          }
          #endif
          
@@ -266,9 +363,10 @@ namespace CheMPS2{
          /** \param mybool The process's boolean
              \return Whether the booleans of all processes are equal */
          static bool all_booleans_equal(const bool mybool){
+            Tracer::Scope scope( "MPI_Allreduce", "mpi" );
             int my_value = ( mybool ) ? 1 : 0 ;
             int tot_value;
-            MPI_Allreduce(&my_value, &tot_value, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(&my_value, &tot_value, 1, MPI_INT, MPI_SUM, mpi_comm());
             return ( my_value * MPIchemps2::mpi_size() == tot_value ); // Only true if mybool is the same for all processes
          }
          #endif
@@ -281,19 +379,37 @@ namespace CheMPS2{
              \param tag A tag which should be the same for the sender and receiver to make sure that the communication is desired */
          static void sendreceive_tensor(Tensor * object, int SENDER, int RECEIVER, int tag){
             if ( SENDER != RECEIVER ){
+               Tracer::Scope scope( "MPI_Send/Recv", "mpi" );
                const int MPIRANK = mpi_rank();
                if ( SENDER == MPIRANK ){
                   int arraysize = object->gKappa2index(object->gNKappa());
-                  MPI_Send(object->gStorage(), arraysize, MPI_DOUBLE, RECEIVER, tag, MPI_COMM_WORLD);
+                  MPI_Send(object->gStorage(), arraysize, MPI_DOUBLE, RECEIVER, tag, mpi_comm());
                }
                if ( RECEIVER == MPIRANK ){
                   int arraysize = object->gKappa2index(object->gNKappa());
-                  MPI_Recv(object->gStorage(), arraysize, MPI_DOUBLE, SENDER, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                  MPI_Recv(object->gStorage(), arraysize, MPI_DOUBLE, SENDER, tag, mpi_comm(), MPI_STATUS_IGNORE);
                }
             }
          }
          #endif
          
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Send an array of doubles from one process to another
+         /** \param array On SENDER the array to be sent, on RECEIVER the array in which it should be stored
+             \param length The length of the array
+             \param SENDER The MPI process which should send the array
+             \param RECEIVER The MPI process which should receive the array
+             \param tag A tag which should be the same for the sender and receiver to make sure that the communication is desired */
+         static void sendreceive_array_double(double * array, int length, int SENDER, int RECEIVER, int tag){
+            if ( SENDER != RECEIVER ){
+               Tracer::Scope scope( "MPI_Send/Recv", "mpi" );
+               const int MPIRANK = mpi_rank();
+               if ( SENDER   == MPIRANK ){ MPI_Send(array, length, MPI_DOUBLE, RECEIVER, tag, mpi_comm()); }
+               if ( RECEIVER == MPIRANK ){ MPI_Recv(array, length, MPI_DOUBLE, SENDER,   tag, mpi_comm(), MPI_STATUS_IGNORE); }
+            }
+         }
+         #endif
+
          #ifdef CHEMPS2_MPI_COMPILATION
          //! Add arrays of all processes and give result to ROOT
          /** \param vec_in The array which should be added
@@ -301,7 +417,8 @@ namespace CheMPS2{
              \param size The size of the array
              \param ROOT The MPI process which should have the result vector */
          static void reduce_array_double(double * vec_in, double * vec_out, int size, int ROOT){
-            MPI_Reduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, ROOT, MPI_COMM_WORLD);
+            Tracer::Scope scope( "MPI_Reduce", "mpi" );
+            MPI_Reduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, ROOT, mpi_comm());
          }
          #endif
          
@@ -311,7 +428,8 @@ namespace CheMPS2{
              \param vec_out The array where the result should be stored
              \param size The size of the array */
          static void allreduce_array_double(double * vec_in, double * vec_out, int size){
-            MPI_Allreduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            Tracer::Scope scope( "MPI_Allreduce", "mpi" );
+            MPI_Allreduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, mpi_comm());
          }
          #endif
 
@@ -34,8 +34,10 @@ namespace CheMPS2{
    const string DMRGSCF_eri_storage_name      = "CheMPS2_eri_temp.h5";
    const string DMRGSCF_f4rdm_name            = "CheMPS2_f4rdm.h5";
    const int    DMRGSCF_max_mem_eri_tfo       = 100 * 100 * 100 * 100; // Measured in number of doubles
+   const int    DMRGSCF_eri_tile_doubles      = 128 * 128 * 16;        // Tiles of the four-index transformation per thread, measured in number of doubles
    const bool   DMRGSCF_debugPrint            = false;
    const bool   DMRGSCF_stateAveraged         = true;
+   const bool   DMRGSCF_storeWtilde           = true;
 
    const int    DMRGSCF_whichActiveSpace      = 0;
    const bool   DMRGSCF_dumpCorrelations      = false;
@@ -47,10 +49,27 @@ namespace CheMPS2{
    const bool   DMRGSCF_storeDIIS             = true;
    const string DMRGSCF_diis_storage_name     = "CheMPS2_DIIS.h5";
 
+   const bool   DMRGSCF_adaptiveDMRG          = false;
+   const double DMRGSCF_adaptiveGradient      = 1e-3;  // Orbital gradient 2-norm below which the full DMRG convergence scheme is used
+   const int    DMRGSCF_adaptiveMinD          = 250;   // Default smallest bond dimension of a loosened DMRG convergence scheme
+   const double DMRGSCF_adaptiveMaxLoosening  = 1e3;   // Largest factor by which the DMRG convergence thresholds are loosened
+
+   const bool   DMRGSCF_spinAdaptFCI          = false;
+
    const double CASPT2_OVLP_CUTOFF            = 1e-8;
+   const double CASPT2_max_mem_MB             = 0.0;   // Zero means no limit on the CASPT2 vectors
+   const int    CASPT2_f4rdm_groups           = 1;     // MPI process groups which contract the DMRG 4-RDM with the Fock operator for different orbital pairs
+   const int    CASPT2_LARGE_BLOCK            = 400;   // Blocks from this size on are diagonalized one by one with dsyevd and threaded lapack; smaller blocks concurrently with dsyev
+
+   const double THREEINDEX_CHOLESKY_CUTOFF    = 1e-10; // Pivoted Cholesky decomposition of the electron repulsion integrals stops below this diagonal element
 
    const double CONJ_GRADIENT_RTOL            = 1e-10;
    const double CONJ_GRADIENT_PRECOND_CUTOFF  = 1e-12;
+   const double CONJ_GRADIENT_BLOCK_DROP      = 1e-8;
+
+   const int    FCI_LANCZOS_MAX_KRYLOV        = 500;
+   const double FCI_LANCZOS_RTOL              = 1e-8;
+   const double FCI_SPIN_PENALTY              = 1.0;   // Shift per unit S(S+1) for states of the wrong spin in FCI::MultiRootDavidson
 
    const string defaultTMPpath                = "/tmp";
    const bool   DMRG_storeRenormOptrOnDisk    = true;
@@ -0,0 +1,120 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef SWEEPLOG_CHEMPS2_H
+#define SWEEPLOG_CHEMPS2_H
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <sys/time.h>
+
+namespace CheMPS2{
+/** SweepLog class.
+    \date October 18, 2026
+
+    The SweepLog class is a machine-readable event stream for the DMRG sweeps. Each event is a single-line JSON object (JSON lines), which is either appended to a file or passed to a user callback. Every record contains the fields "event" and "time" (wall time in seconds since the construction of the SweepLog); the other fields depend on the event. DMRG::Solve emits a "site" record for each two-site optimization, a "sweep" record for each sweep, and an "instruction" record for each completed instruction of the ConvergenceScheme. With MPI, only the master process writes records. */
+   class SweepLog{
+
+      public:
+
+         //! Constructor which writes the records to a file
+         /** \param filename The file to which the JSON lines are written
+             \param append   Whether to append to an existing file, or to truncate it */
+         SweepLog( const std::string filename, const bool append = false );
+
+         //! Constructor which passes the records to a callback
+         /** \param callback The function which is called with each record (a null-terminated JSON object without trailing newline) and the user data pointer
+             \param userdata The user data pointer which is passed to the callback */
+         SweepLog( void (*callback)( const char * record, void * userdata ), void * userdata );
+
+         //! Destructor
+         virtual ~SweepLog();
+
+         //! Start a new record
+         /** \param event The name of the event */
+         void start( const std::string event );
+
+         //! Add an integer field to the current record
+         /** \param key The name of the field
+             \param value The value of the field */
+         void add( const std::string key, const long long value );
+
+         //! Add an integer field to the current record
+         /** \param key The name of the field
+             \param value The value of the field */
+         void add( const std::string key, const int value ){ add( key, ( long long )( value ) ); }
+
+         //! Add a floating point field to the current record
+         /** \param key The name of the field
+             \param value The value of the field */
+         void add( const std::string key, const double value );
+
+         //! Add a string field to the current record
+         /** \param key The name of the field
+             \param value The value of the field */
+         void add( const std::string key, const std::string value );
+
+         //! Add a boolean field to the current record
+         /** \param key The name of the field
+             \param value The value of the field */
+         void add_boolean( const std::string key, const bool value );
+
+         //! Add an array of integers to the current record
+         /** \param key The name of the field
+             \param values The values of the field
+             \param num The number of values */
+         void add( const std::string key, const int * values, const int num );
+
+         //! Write the current record to the file or pass it to the callback
+         void write();
+
+         //! Get the current resident set size of this process
+         /** \return The current resident set size in kilobytes, or -1 if unknown */
+         static long long rss_kb();
+
+         //! Get the peak resident set size of this process
+         /** \return The peak resident set size in kilobytes, or -1 if unknown */
+         static long long peak_rss_kb();
+
+         //! Get the number of bytes read and written by this process
+         /** \return The sum of the rchar and wchar fields of /proc/self/io, or -1 if unknown */
+         static long long io_bytes();
+
+      private:
+
+         // The output file (NULL when a callback is used)
+         std::ofstream * output;
+
+         // The callback (NULL when a file is used)
+         void (*callback)( const char * record, void * userdata );
+         void * userdata;
+
+         // The record under construction
+         std::stringstream record;
+
+         // The reference time
+         struct timeval creation;
+
+         void add_key( const std::string key );
+
+   };
+}
+
+#endif
@@ -94,6 +94,13 @@ namespace CheMPS2{
              \param beta  Constant to be multiplied with the MPS tensor */
          void number_operator( const double alpha, const double beta );
 
+         //! Set the tensor to the site tensor of ( alpha * sum_k fock_k n_k + beta ) applied to an MPS, with the doubled virtual dimensions of the block upper-triangular representation
+         /** \param original The tensor of the MPS on the same site; its bookkeeper has half the virtual dimensions of the current bookkeeper, except at the outer boundaries of the chain
+             \param fock     The coefficient fock_k of the number operator n_k of this site
+             \param alpha    Prefactor of the sum of number operators
+             \param beta     Constant to be multiplied with the MPS */
+         void number_operator_sum( const TensorT * original, const double fock, const double alpha, const double beta );
+
          //! Left-normalization
          /** \param Rstorage Where the R-part of the QR-decomposition can be stored (diagonal TensorOperator). */
          void QR( Tensor * Rstorage );
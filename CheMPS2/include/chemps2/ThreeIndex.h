@@ -0,0 +1,132 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef THREEINDEX_CHEMPS2_H
+#define THREEINDEX_CHEMPS2_H
+
+#include <string>
+
+#include "Irreps.h"
+#include "FourIndex.h"
+#include "Options.h"
+
+namespace CheMPS2{
+/** ThreeIndex class.
+    \date October 19, 2026
+
+    Container class for three-index density-fitted or Cholesky-decomposed electron repulsion integrals with Abelian point group symmetry (real character table; see Irreps.h):
+    \f[
+       ( i j \mid k l ) = V_{ikjl} = \sum\limits_{P} B^{P}_{ij} B^{P}_{kl}.
+    \f]
+    The vector \f$B^{P}\f$ belongs to irrep \f$I_P\f$, and \f$B^{P}_{ij}\f$ is only nonzero when \f$I_i \otimes I_j = I_P\f$. The vectors of irrep \f$I_P\f$ are stored per block \f$I_i\f$ as B[ i + NORB( I_i ) * ( j + NORB( I_j ) * P ) ], with \f$I_j = I_i \otimes I_P\f$. The memory is \f$\mathcal{O}(N^2 N_{aux})\f$ instead of \f$\mathcal{O}(N^4)\f$ for the FourIndex class.
+
+    The vectors can be obtained from a pivoted Cholesky decomposition of a FourIndex object, or be read from an HDF5 file. In the latter case, the file contains the group /MetaData with the dataset IrrepSizes (attributes nGroup and nIrreps) and the dataset NumVectors, and the group /ThreeIndexObject with the dataset Vectors, in which the blocks are stored for increasing \f$I_P\f$ and, within \f$I_P\f$, for increasing \f$I_i\f$.
+*/
+   class ThreeIndex{
+
+      public:
+
+         //! Constructor
+         /** \param nGroup The symmetry group number (see Irreps.h)
+             \param IrrepSizes Array with length the number of irreps of the specified group, containing the number of orbitals of that irrep
+             \param NumVectors Array with length the number of irreps of the specified group, containing the number of three-index vectors of that irrep */
+         ThreeIndex( const int nGroup, const int * IrrepSizes, const int * NumVectors );
+
+         //! Constructor which performs a pivoted Cholesky decomposition of two-body matrix elements
+         /** \param nGroup The symmetry group number (see Irreps.h)
+             \param VMAT The two-body matrix elements
+             \param threshold The decomposition stops when the largest remaining diagonal element ( i j | i j ) is smaller than threshold */
+         ThreeIndex( const int nGroup, const FourIndex * VMAT, const double threshold=CheMPS2::THREEINDEX_CHOLESKY_CUTOFF );
+
+         //! Destructor
+         virtual ~ThreeIndex();
+
+         //! Set all three-index vectors to zero
+         void Clear();
+
+         //! Get the group number
+         /** \return The group number */
+         int getNGroup() const;
+
+         //! Get a given irrep size
+         /** \param irrep The irrep for which you want to know the irrep size
+             \return The corresponding irrep size */
+         int get_irrep_size( const int irrep ) const;
+
+         //! Get the number of three-index vectors of a given irrep
+         /** \param irrep The irrep of the three-index vectors
+             \return The corresponding number of three-index vectors */
+         int get_num_vectors( const int irrep ) const;
+
+         //! Get the three-index vectors B[ i + NORB( irrep_i ) * ( j + NORB( irrep_j ) * P ) ]
+         /** \param irrep_i The irrep of the first orbital
+             \param irrep_j The irrep of the second orbital
+             \return Pointer to the corresponding block */
+         double * getBlock( const int irrep_i, const int irrep_j ) const;
+
+         //! Get a two-body matrix element with the FourIndex convention V_ijkl = ( i k | j l )
+         /** \param irrep_i The irrep number of the first orbital (see Irreps.h)
+             \param irrep_j The irrep number of the second orbital
+             \param irrep_k The irrep number of the third orbital
+             \param irrep_l The irrep number of the fourth orbital
+             \param i The first index (within the symmetry block)
+             \param j The second index (within the symmetry block)
+             \param k The third index (within the symmetry block)
+             \param l The fourth index (within the symmetry block)
+             \return The two-body matrix element */
+         double get( const int irrep_i, const int irrep_j, const int irrep_k, const int irrep_l, const int i, const int j, const int k, const int l ) const;
+
+         //! Save the ThreeIndex object
+         /** \param name filename */
+         void save( const std::string name ) const;
+
+         //! Load the ThreeIndex object
+         /** \param name filename */
+         void read( const std::string name );
+
+         //! Read the number of three-index vectors per irrep from a file, in order to construct a ThreeIndex object which can load it
+         /** \param name filename
+             \param NumVectors Array with length the number of irreps, in which the number of three-index vectors per irrep is stored */
+         static void read_num_vectors( const std::string name, int * NumVectors );
+
+      private:
+
+         //Contains the group number, the number of irreps, and the multiplication table
+         Irreps SymmInfo;
+
+         //Array with length the number of irreps, containing the number of orbitals of that irrep
+         int * Isizes;
+
+         //Array with length the number of irreps, containing the number of three-index vectors of that irrep
+         int * Nvectors;
+
+         //storage[ I_P ][ I_i ] points to the block B[ i + NORB( I_i ) * ( j + NORB( I_j ) * P ) ] in theElements
+         double *** storage;
+
+         //The three-index vectors
+         long long arrayLength;
+         double * theElements;
+
+         //Allocate theElements and storage for the current Isizes and Nvectors
+         void allocate();
+
+   };
+}
+
+#endif
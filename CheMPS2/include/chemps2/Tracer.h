@@ -0,0 +1,113 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef TRACER_CHEMPS2_H
+#define TRACER_CHEMPS2_H
+
+#include <string>
+
+namespace CheMPS2{
+/** Tracer class.
+    \date October 18, 2026
+
+    The Tracer class records begin and end events of the stages of the DMRG, DMRG-SCF and CASPT2 pipeline, with the OpenMP thread number and the MPI rank, and writes them in the Chrome trace-event JSON format. The resulting file can be loaded in chrome://tracing or https://ui.perfetto.dev. Events are buffered in memory per OpenMP thread, and only written to disk by stop(). When the tracer is not started, a Scope only costs a single boolean check. With MPI, every process writes its own file, with the rank appended to the filename; the process id of the events is the MPI rank, so that the files can be merged. */
+   class Tracer{
+
+      public:
+
+         //! Start recording events
+         /** \param filename The file to which the trace will be written by stop() */
+         static void start( const std::string filename );
+
+         //! Write the recorded events to the file and stop recording
+         static void stop();
+
+         //! Whether or not events are being recorded
+         /** \return Whether or not events are being recorded */
+         static bool enabled(){ return active; }
+
+         //! Record a begin event on the calling thread
+         /** \param name The name of the event (should be a string literal)
+             \param category The category of the event (should be a string literal) */
+         static void begin( const char * name, const char * category ){ if ( active ){ record( name, category, 'B' ); } }
+
+         //! Record an end event on the calling thread
+         /** \param name The name of the event (should be a string literal)
+             \param category The category of the event (should be a string literal) */
+         static void end( const char * name, const char * category ){ if ( active ){ record( name, category, 'E' ); } }
+
+         /** Scope class.
+
+             Records a begin event on construction and the matching end event on destruction. */
+         class Scope{
+
+            public:
+
+               //! Constructor
+               /** \param name The name of the event (should be a string literal)
+                   \param category The category of the event (should be a string literal) */
+               Scope( const char * name, const char * category ){
+                  this->name     = name;
+                  this->category = category;
+                  begin( name, category );
+               }
+
+               //! Destructor
+               ~Scope(){ end( name, category ); }
+
+            private:
+
+               const char * name;
+               const char * category;
+
+         };
+
+      private:
+
+         struct Event{
+            const char * name;
+            const char * category;
+            char phase;
+            long long time; // Microseconds since start()
+         };
+
+         // Whether or not events are recorded
+         static bool active;
+
+         // The output file
+         static std::string filename;
+
+         // The reference time in microseconds
+         static long long reference;
+
+         // The number of threads for which buffers are allocated
+         static int num_threads;
+
+         // Per-thread event buffers
+         static Event ** events;
+         static int * num_events;
+         static int * size_events;
+
+         static void record( const char * name, const char * category, const char phase );
+         static long long now();
+
+   };
+}
+
+#endif